@@ -4913,6 +4913,10 @@ class LIB_API PlayerCommand {
         PlayerCommand& operator=(PlayerCommand&&) = default;
         ~PlayerCommand() = default;
 
+    public:
+        // Values of command(): 1 plays, 2 pauses, 3 seeks to seekTo(), 4 steps one Envelope forward, and 5 acknowledges an Envelope replayed with --lockstep.
+        enum : uint8_t { PLAY = 1, PAUSE = 2, SEEK_TO = 3, STEP = 4, LOCKSTEP_ACKNOWLEDGE = 5 };
+
     public:
         
         inline PlayerCommand& command(const uint8_t &v) noexcept {
@@ -6328,6 +6332,16 @@ class LIBCLUON_API UDPSender {
      */
     std::pair<ssize_t, int32_t> send(std::string &&data) const noexcept;
 
+    /**
+     * Send the given strings as separate UDP packets with as few system calls
+     * as possible (sendmmsg on Linux); strings that are too large for a UDP
+     * packet are skipped.
+     *
+     * @param datagrams Data to send.
+     * @return Pair: Number of bytes sent and errno of the first failure.
+     */
+    std::pair<ssize_t, int32_t> send(std::vector<std::string> &&datagrams) const noexcept;
+
    public:
     /**
      * @return Port that this UDP sender will use for sending or 0 if no information available.
@@ -6431,11 +6445,15 @@ class LIBCLUON_API UDPReceiver {
      * @param receiveFromPort Port to receive UDP packets from.
      * @param delegate Functional (noexcept) to handle received bytes; parameters are received data, sender, timestamp.
      * @param localSendFromPort Port that an application is using to send data. This port (> 0) is ignored when data is received.
+     * @param filter Optional functional (noexcept) called on the receiving thread before received bytes are copied for the
+     *        delegate; parameters are received data, its length, the sender's port, and whether the sender is on this host.
+     *        Bytes are only passed to the delegate if it returns true.
      */
     UDPReceiver(const std::string &receiveFromAddress,
                 uint16_t receiveFromPort,
                 std::function<void(std::string &&, std::string &&, std::chrono::system_clock::time_point &&)> delegate,
-                uint16_t localSendFromPort = 0) noexcept;
+                uint16_t localSendFromPort                                           = 0,
+                std::function<bool(const char *, std::size_t, uint16_t, bool)> filter = nullptr) noexcept;
     ~UDPReceiver() noexcept;
 
     /**
@@ -6467,6 +6485,7 @@ class LIBCLUON_API UDPReceiver {
 
    private:
     std::function<void(std::string &&, std::string &&, std::chrono::system_clock::time_point)> m_delegate{};
+    std::function<bool(const char *, std::size_t, uint16_t, bool)> m_filter{};
 
    private:
     class PipelineEntry {
@@ -6615,6 +6634,15 @@ class LIBCLUON_API TCPConnection {
      */
     std::pair<ssize_t, int32_t> send(std::string &&data) const noexcept;
 
+    /**
+     * This method limits how long send() blocks while the peer does not read;
+     * send() then returns the number of bytes sent so far or -1 with EAGAIN.
+     *
+     * @param timeout Maximum time to block; 0 to block until all data is sent.
+     * @return true if the timeout was set.
+     */
+    bool setSendTimeout(std::chrono::milliseconds timeout) noexcept;
+
    private:
     /**
      * This method closes the socket.
@@ -8118,6 +8146,85 @@ inline std::pair<bool, cluon::data::Envelope> extractEnvelope(std::istream &in)
     return std::make_pair(retVal, env);
 }
 
+/**
+ * This method reads only dataType and senderStamp from bytes in the format
+ * described for extractEnvelope, without decoding the Envelope or copying its
+ * payload; fields that are not present have their default value 0.
+ *
+ * @param data Bytes to read from.
+ * @param size Number of bytes.
+ * @param dataType Data type of the Envelope.
+ * @param senderStamp Sender stamp of the Envelope.
+ * @return true if the bytes hold a well-formed Envelope header.
+ */
+inline bool peekEnvelope(const char *data, std::size_t size, int32_t &dataType, uint32_t &senderStamp) noexcept {
+    constexpr uint8_t OD4_HEADER_SIZE{5};
+    dataType    = 0;
+    senderStamp = 0;
+    if ((nullptr == data) || (OD4_HEADER_SIZE > size) || (0x0D != static_cast<uint8_t>(data[0])) || (0xA4 != static_cast<uint8_t>(data[1]))) {
+        return false;
+    }
+    const std::size_t LENGTH{static_cast<std::size_t>(static_cast<uint8_t>(data[2])) | (static_cast<std::size_t>(static_cast<uint8_t>(data[3])) << 8)
+                             | (static_cast<std::size_t>(static_cast<uint8_t>(data[4])) << 16)};
+    if (OD4_HEADER_SIZE + LENGTH > size) {
+        return false;
+    }
+
+    const uint8_t *pos{reinterpret_cast<const uint8_t *>(data) + OD4_HEADER_SIZE};
+    const uint8_t *end{pos + LENGTH};
+    auto readVarInt = [&pos, end](uint64_t &value) {
+        value = 0;
+        for (uint8_t shift{0}; (pos < end) && (shift < 64); shift = static_cast<uint8_t>(shift + 7)) {
+            const uint8_t C{*pos++};
+            value |= static_cast<uint64_t>(C & 0x7f) << shift;
+            if (0 == (C & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Walk over the fields of the Envelope (1: dataType, 6: senderStamp), skipping all others.
+    constexpr uint8_t VARINT{0};
+    constexpr uint8_t EIGHT_BYTES{1};
+    constexpr uint8_t LENGTH_DELIMITED{2};
+    constexpr uint8_t FOUR_BYTES{5};
+    while (pos < end) {
+        uint64_t key{0};
+        uint64_t value{0};
+        if (!readVarInt(key)) {
+            return false;
+        }
+        const uint8_t TYPE{static_cast<uint8_t>(key & 0x7)};
+        const uint64_t FIELD{key >> 3};
+        if (VARINT == TYPE) {
+            if (!readVarInt(value)) {
+                return false;
+            }
+            if (1 == FIELD) {
+                const uint32_t ZIGZAG{static_cast<uint32_t>(value)};
+                dataType = static_cast<int32_t>((ZIGZAG >> 1) ^ (~(ZIGZAG & 1) + 1));
+            } else if (6 == FIELD) {
+                senderStamp = static_cast<uint32_t>(value);
+            }
+        } else if (LENGTH_DELIMITED == TYPE) {
+            if (!readVarInt(value) || (value > static_cast<uint64_t>(end - pos))) {
+                return false;
+            }
+            pos += value;
+        } else if ((EIGHT_BYTES == TYPE) || (FOUR_BYTES == TYPE)) {
+            const std::size_t BYTES{(EIGHT_BYTES == TYPE) ? 8u : 4u};
+            if (BYTES > static_cast<std::size_t>(end - pos)) {
+                return false;
+            }
+            pos += BYTES;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @return Extract a given Envelope's payload into the desired type.
  */
@@ -8846,577 +8953,667 @@ class LIBCLUON_API LCMToGenericMessage {
 } // namespace cluon
 #endif
 /*
- * Copyright (C) 2017-2018  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-#ifndef CLUON_OD4SESSION_HPP
-#define CLUON_OD4SESSION_HPP
+#ifndef CLUON_HISTOGRAM_HPP
+#define CLUON_HISTOGRAM_HPP
 
-//#include "cluon/Time.hpp"
-//#include "cluon/ToProtoVisitor.hpp"
-//#include "cluon/UDPReceiver.hpp"
-//#include "cluon/UDPSender.hpp"
 //#include "cluon/cluon.hpp"
-//#include "cluon/cluonDataStructures.hpp"
 
-#include <chrono>
+#include <atomic>
 #include <cstdint>
-#include <functional>
-#include <memory>
-#include <mutex>
-#include <string>
-#include <unordered_map>
-#include <utility>
 
 namespace cluon {
 /**
-This class provides an interface to an OpenDaVINCI v4 session. An OpenDaVINCI
-v4 session allows the automatic exchange of time-stamped Envelopes carrying
-user-defined messages usually using UDP multicast. A running OD4Session will not
-receive the bytes that itself has sent to other microservices.
-
-There are two ways to participate in an OpenDaVINCI session. Variant A is simply
-calling a user-supplied lambda whenever a new Envelope is received:
-
-\code{.cpp}
-cluon::OD4Session od4{111, [](cluon::data::Envelope &&envelope){ std::cout << "Received cluon::Envelope" << std::endl;}
-};
-
-// Do something in parallel.
-
-MyMessage msg;
-od4.send(msg);
-\endcode
-
-Variant B allows a more fine-grained setup where you specify the Envelopes of interest:
-
-\code{.cpp}
-cluon::OD4Session od4{111};
-
-od4.dataTrigger(cluon::data::TimeStamp::ID(), [](cluon::data::Envelope &&envelope){ std::cout << "Received cluon::data::TimeStamp" << std::endl;});
-od4.dataTrigger(MyMessage::ID(), [](cluon::data::Envelope &&envelope){ std::cout << "Received MyMessage" << std::endl;});
-
-// Do something in parallel.
-
-MyMessage msg;
-od4.send(msg);
-\endcode
-
-Next to receive Envelopes, OD4Session can call a user-supplied lambda in a time-triggered
-way. The lambda is executed as long as it does not return false or throws an exception
-that is then caught in the method timeTrigger and the method is exited:
+This class counts values in buckets that grow logarithmically and are
+subdivided linearly (as in HdrHistogram): values below 64 are counted
+exactly, larger values with a relative error below 1/32. Its size is
+fixed, recording neither allocates nor locks, and percentiles can be read
+from any thread while values are recorded. It is meant for latencies in
+nanoseconds or microseconds.
 
 \code{.cpp}
-cluon::OD4Session od4{111};
-
-const float FREQ{10}; // 10 Hz.
-od4.timeTrigger(FREQ, [](){
-  // Do something time-triggered.
-  return false;
-}); // This call blocks until the lambda returns false.
+cluon::Histogram h;
+h.record(1200);
+h.record(35000);
+std::cout << h.valueAtPercentile(99.0) << std::endl;
 \endcode
 */
-class LIBCLUON_API OD4Session {
+class LIBCLUON_API Histogram {
    private:
-    OD4Session(const OD4Session &) = delete;
-    OD4Session(OD4Session &&)      = delete;
-    OD4Session &operator=(const OD4Session &) = delete;
-    OD4Session &operator=(OD4Session &&) = delete;
+    enum : uint32_t {
+        SUB_BUCKET_BITS   = 5,
+        SUB_BUCKETS       = 1u << SUB_BUCKET_BITS,
+        NUMBER_OF_BUCKETS = 2 * SUB_BUCKETS + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKETS,
+    };
+
+   private:
+    Histogram(const Histogram &) = delete;
+    Histogram(Histogram &&)      = delete;
+    Histogram &operator=(const Histogram &) = delete;
+    Histogram &operator=(Histogram &&) = delete;
 
    public:
+    Histogram() noexcept;
+    ~Histogram() = default;
+
     /**
-     * Constructor.
+     * This method counts the given value.
      *
-     * @param CID OpenDaVINCI v4 session identifier [1 .. 254]
-     * @param delegate Function to call on newly arriving Envelopes ("catch-all");
-     *        if a nullptr is passed, the method dataTrigger can be used to set
-     *        message specific delegates. Please note that it is NOT possible
-     *        to have both: a delegate for "catch-all" and the data-triggered ones.
+     * @param value Value to count.
      */
-    OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate = nullptr) noexcept;
+    void record(uint64_t value) noexcept;
 
     /**
-     * This method will send a given Envelope to this OpenDaVINCI v4 session.
+     * This method adds all values counted by the other histogram.
      *
-     * @param envelope to be sent.
+     * @param other Histogram to add.
      */
-    void send(cluon::data::Envelope &&envelope) noexcept;
+    void merge(const Histogram &other) noexcept;
 
     /**
-     * This method sets a delegate to be called data-triggered on arrival
-     * of a new Envelope for a given message identifier.
-     *
-     * @param messageIdentifier Message identifier to assign a delegate.
-     * @param delegate Function to call on newly arriving Envelopes; setting it to nullptr will erase it.
-     * @return true if the given delegate could be successfully set or unset.
+     * This method removes all counted values; values recorded concurrently might get lost.
      */
-    bool dataTrigger(int32_t messageIdentifier, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept;
+    void reset() noexcept;
 
     /**
-     * This method sets a delegate to be called time-triggered using the
-     * specified frequency until the delegate returns false. This method
-     * blocks until the delegate has returned false or threw an exception.
-     * Thus, this method is typically called as last statement in a main
-     * function of a program.
-     *
-     * @param freq Frequency in Hertz to run the given delegate.
-     * @param delegate Function to call according to the given frequency.
+     * @return Number of counted values.
      */
-    void timeTrigger(float freq, std::function<bool()> delegate) noexcept;
+    uint64_t count() const noexcept;
 
     /**
-     * This method will send a given message to this OpenDaVINCI v4 session.
-     *
-     * @param message Message to be sent.
-     * @param sampleTimeStamp Time point when this sample to be sent was captured (default = sent time point).
-     * @param senderStamp Optional sender stamp (default = 0).
+     * @return Smallest counted value or 0.
      */
-    template <typename T>
-    void send(T &message, const cluon::data::TimeStamp &sampleTimeStamp = cluon::data::TimeStamp(), uint32_t senderStamp = 0) noexcept {
-        try {
-            std::lock_guard<std::mutex> lck(m_senderMutex);
-            cluon::ToProtoVisitor protoEncoder;
+    uint64_t minimum() const noexcept;
 
-            cluon::data::Envelope envelope;
-            {
-                envelope.dataType(static_cast<int32_t>(message.ID()));
-                message.accept(protoEncoder);
-                envelope.serializedData(protoEncoder.encodedData());
-                envelope.sent(cluon::time::now());
-                envelope.sampleTimeStamp((0 == (sampleTimeStamp.seconds() + sampleTimeStamp.microseconds())) ? envelope.sent() : sampleTimeStamp);
-                envelope.senderStamp(senderStamp);
-            }
+    /**
+     * @return Largest counted value or 0.
+     */
+    uint64_t maximum() const noexcept;
 
-            send(std::move(envelope));
-        } catch (...) {} // LCOV_EXCL_LINE
-    }
+    /**
+     * @return Mean of the counted values or 0.
+     */
+    double mean() const noexcept;
 
-   public:
-    bool isRunning() noexcept;
+    /**
+     * @param percentile Percentile between 0 and 100.
+     * @return Largest value that is equivalent to the bucket containing the given percentile.
+     */
+    uint64_t valueAtPercentile(double percentile) const noexcept;
 
    private:
-    void callback(std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) noexcept;
-    void sendInternal(std::string &&dataToSend) noexcept;
+    static uint32_t bucketOf(uint64_t value) noexcept;
+    static uint64_t highestValueOf(uint32_t bucket) noexcept;
 
    private:
-    std::unique_ptr<cluon::UDPReceiver> m_receiver;
-    cluon::UDPSender m_sender;
-
-    std::mutex m_senderMutex{};
-
-    std::function<void(cluon::data::Envelope &&envelope)> m_delegate{nullptr};
-
-    std::mutex m_mapOfDataTriggeredDelegatesMutex{};
-    std::unordered_map<int32_t, std::function<void(cluon::data::Envelope &&envelope)>, UseUInt32ValueAsHashKey> m_mapOfDataTriggeredDelegates{};
+    std::atomic<uint64_t> m_buckets[NUMBER_OF_BUCKETS];
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_minimum{UINT64_MAX};
+    std::atomic<uint64_t> m_maximum{0};
 };
-
 } // namespace cluon
+
 #endif
 /*
- * Copyright (C) 2017-2018  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-#ifndef CLUON_PLAYER_HPP
-#define CLUON_PLAYER_HPP
+#ifndef CLUON_PERIODICSCHEDULER_HPP
+#define CLUON_PERIODICSCHEDULER_HPP
 
 //#include "cluon/cluon.hpp"
-//#include "cluon/cluonDataStructures.hpp"
+//#include "cluon/Histogram.hpp"
 
+#include <atomic>
 #include <cstdint>
-#include <deque>
-#include <fstream>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
-#include <string>
-#include <thread>
-#include <utility>
+#include <vector>
 
 namespace cluon {
+/**
+This class runs periodic tasks on the calling thread. Every task has absolute
+deadlines on the monotonic clock (start + k * period), so periods that are no
+whole number of milliseconds or microseconds do not drift, and the thread
+sleeps until the earliest deadline of all tasks (clock_nanosleep with
+TIMER_ABSTIME on Linux). When a task runs late, its policy decides whether
+the missed activations are run back-to-back (CATCH_UP) or dropped (SKIP).
 
-class LIBCLUON_API IndexEntry {
-   public:
-    IndexEntry() = default;
-    IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition) noexcept;
-
-   public:
-    int64_t m_sampleTimeStamp{0};
-    uint64_t m_filePosition{0};
-    bool m_available{0};
-};
+For every task, the scheduler records the jitter (start of an activation
+after its deadline) and the overrun (end of an activation after the next
+deadline) in nanoseconds.
 
-class LIBCLUON_API Player {
+\code{.cpp}
+cluon::PeriodicScheduler scheduler;
+auto control = scheduler.add(2000.0f, [](){ return true; });
+auto logger = scheduler.add(1.5f, [](){ return true; }, cluon::PeriodicScheduler::CATCH_UP);
+scheduler.run(); // Blocks until all tasks returned false or stop() was called.
+std::cout << scheduler.jitter(control).valueAtPercentile(99.0) << std::endl;
+\endcode
+*/
+class LIBCLUON_API PeriodicScheduler {
    private:
-    enum {
-        ONE_MILLISECOND_IN_MICROSECONDS = 1000,
-        ONE_SECOND_IN_MICROSECONDS      = 1000 * ONE_MILLISECOND_IN_MICROSECONDS,
-        MAX_DELAY_IN_MICROSECONDS       = 1 * ONE_SECOND_IN_MICROSECONDS,
-        LOOK_AHEAD_IN_S                 = 30,
-        MIN_ENTRIES_FOR_LOOK_AHEAD      = 5000,
-    };
+    PeriodicScheduler(const PeriodicScheduler &) = delete;
+    PeriodicScheduler(PeriodicScheduler &&)      = delete;
+    PeriodicScheduler &operator=(const PeriodicScheduler &) = delete;
+    PeriodicScheduler &operator=(PeriodicScheduler &&) = delete;
 
-   private:
-    Player(const Player &) = delete;
-    Player(Player &&)      = delete;
-    Player &operator=(Player &&) = delete;
-    Player &operator=(const Player &other) = delete;
+   public:
+    enum OverrunPolicy {
+        CATCH_UP = 0, // Run missed activations back-to-back.
+        SKIP     = 1, // Continue with the next deadline in the future.
+    };
 
    public:
+    PeriodicScheduler() = default;
+    ~PeriodicScheduler() = default;
+
     /**
-     * Constructor.
+     * This method adds a periodic task; it can be called before run() or
+     * from a task. The task is removed when its delegate returns false or
+     * throws an exception.
      *
-     * @param file File to play.
-     * @param autoRewind True if the file should be rewind at EOF.
-     * @param threading If set to true, player will load new envelopes from the files in background.
+     * @param freq Frequency in Hertz.
+     * @param delegate Function to call periodically.
+     * @param policy What to do with activations missed while running late.
+     * @return Identifier of the task.
      */
-    Player(const std::string &file, const bool &autoRewind, const bool &threading) noexcept;
-    ~Player();
+    uint32_t add(float freq, std::function<bool()> delegate, OverrunPolicy policy = SKIP) noexcept;
 
     /**
-     * @return Pair of bool and next cluon::data::Envelope to be replayed;
-     *         if bool is false, no next Envelope is available.
+     * This method runs the tasks until all of them are removed, stop()
+     * is called, or the program is terminated.
      */
-    std::pair<bool, cluon::data::Envelope> getNextEnvelopeToBeReplayed() noexcept;
+    void run() noexcept;
 
     /**
-     * @return real delay in microseconds to be waited before the next cluon::data::Envelope should be delivered.
+     * This method lets run() return after the current activation.
      */
-    uint32_t delay() const noexcept;
+    void stop() noexcept;
 
     /**
-     * @return true if there is more data to replay.
+     * @param task Identifier of the task.
+     * @return Delays of the activations after their deadlines in nanoseconds.
      */
-    bool hasMoreData() const noexcept;
+    const Histogram &jitter(uint32_t task) const noexcept;
 
     /**
-     * This method rewinds the iterators.
+     * @param task Identifier of the task.
+     * @return How far activations ended after the next deadline in nanoseconds; only late activations are recorded.
      */
-    void rewind() noexcept;
-
-    void seekTo(float ratio) noexcept;
+    const Histogram &overrun(uint32_t task) const noexcept;
 
     /**
-     * @return total amount of cluon::data::Envelopes in the .rec file.
+     * @param task Identifier of the task.
+     * @return Number of activations dropped by the policy SKIP.
      */
-    uint32_t totalNumberOfEnvelopesInRecFile() const noexcept;
-
-   private:
-    // Internal methods without Lock.
-    bool hasMoreDataFromRecFile() const noexcept;
+    uint64_t skipped(uint32_t task) const noexcept;
 
     /**
-     * This method initializes the global index where the sample
-     * time stamps are sorted chronocally and mapped to the
-     * corresponding cluon::data::Envelope in the rec file.
+     * @return Current time of the monotonic clock used for the deadlines in nanoseconds.
      */
-    void initializeIndex() noexcept;
+    static int64_t now() noexcept;
 
-    /**
-     * This method computes the initially required amount of
-     * cluon::data::Envelope in the cache and fill the cache accordingly.
-     */
-    void computeInitialCacheLevelAndFillCache() noexcept;
+   private:
+    struct Task {
+        std::function<bool()> m_delegate{nullptr};
+        OverrunPolicy m_policy{SKIP};
+        double m_periodInNanoseconds{0};
+        bool m_started{false};
+        int64_t m_start{0};
+        uint64_t m_activation{0};
+        int64_t m_deadline{0};
+        bool m_running{true};
+        std::atomic<uint64_t> m_skipped{0};
+        Histogram m_jitter{};
+        Histogram m_overrun{};
+    };
 
-    /**
-     * This method clears all caches.
-     */
-    void resetCaches() noexcept;
+    static void sleepUntil(int64_t deadline) noexcept;
+    static int64_t deadlineOf(const Task &task, uint64_t activation) noexcept;
 
-    /**
-     * This method resets the iterators.
-     */
-    inline void resetIterators() noexcept;
+   private:
+    mutable std::mutex m_tasksMutex{};
+    std::vector<std::unique_ptr<Task>> m_tasks{};
+    std::atomic<bool> m_stop{false};
+    Histogram m_unknownTask{};
+};
+} // namespace cluon
 
+#endif
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_EXECUTIONLANE_HPP
+#define CLUON_EXECUTIONLANE_HPP
+
+//#include "cluon/cluon.hpp"
+//#include "cluon/Histogram.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace cluon {
+/**
+This class executes tasks in the order they were posted, either on a
+dedicated thread or directly on the posting thread. It measures how long
+tasks wait in its queue and how long they take, in nanoseconds.
+OD4Session uses lanes to run the delegates of different message
+identifiers independently of each other.
+*/
+class LIBCLUON_API ExecutionLane {
+   private:
+    ExecutionLane(const ExecutionLane &) = delete;
+    ExecutionLane(ExecutionLane &&)      = delete;
+    ExecutionLane &operator=(const ExecutionLane &) = delete;
+    ExecutionLane &operator=(ExecutionLane &&) = delete;
+
+   public:
     /**
-     * This method fills the cache by trying to read up
-     * to maxNumberOfEntriesToReadFromFile from the rec file.
+     * Constructor.
      *
-     * @param maxNumberOfEntriesToReadFromFile Maximum number of entries to be read from file.
-     * @return Number of entries read from file.
+     * @param dedicatedThread True to run the tasks on a thread of this lane;
+     *        false to run them directly in post.
      */
-    uint32_t fillEnvelopeCache(const uint32_t &maxNumberOfEntriesToReadFromFile) noexcept;
+    explicit ExecutionLane(bool dedicatedThread) noexcept;
 
     /**
-     * This method checks the availability of the next cluon::data::Envelope
-     * to be replayed from the cache.
+     * Destructor; tasks that have not started yet are discarded.
      */
-    inline void checkAvailabilityOfNextEnvelopeToBeReplayed() noexcept;
+    ~ExecutionLane() noexcept;
 
-   private: // Data for the Player.
-    bool m_threading;
+    /**
+     * This method runs the given task after all tasks posted before.
+     *
+     * @param task Task to run.
+     */
+    void post(std::function<void()> &&task) noexcept;
 
-    std::string m_file;
+    /**
+     * @return Number of tasks waiting to be run.
+     */
+    uint32_t queueDepth() const noexcept;
 
-    // Handle to .rec file.
-    std::fstream m_recFile;
-    bool m_recFileValid;
+    /**
+     * @return Largest number of tasks that were waiting at the same time.
+     */
+    uint32_t maxQueueDepth() const noexcept;
 
-   private: // Player states.
-    bool m_autoRewind;
+    /**
+     * @return Time between posting and starting the tasks in nanoseconds.
+     */
+    const Histogram &queueLatency() const noexcept;
 
-   private: // Index and cache management.
-    // Global index: Mapping SampleTimeStamp --> cache entry (holding the actual content from .rec file).
-    mutable std::mutex m_indexMutex;
-    std::multimap<int64_t, IndexEntry> m_index;
+    /**
+     * @return Time spent in the tasks in nanoseconds.
+     */
+    const Histogram &handlerLatency() const noexcept;
 
-    // Pointers to the current envelope to be replayed and the
-    // envelope that has be replayed from the global index.
-    std::multimap<int64_t, IndexEntry>::iterator m_previousPreviousEnvelopeAlreadyReplayed;
-    std::multimap<int64_t, IndexEntry>::iterator m_previousEnvelopeAlreadyReplayed;
-    std::multimap<int64_t, IndexEntry>::iterator m_currentEnvelopeToReplay;
+   private:
+    void run(std::function<void()> &task, int64_t posted) noexcept;
+    void processQueue() noexcept;
 
-    // Information about the index.
-    std::multimap<int64_t, IndexEntry>::iterator m_nextEntryToReadFromRecFile;
+   private:
+    const bool m_dedicatedThread;
+
+    std::mutex m_queueMutex{};
+    std::condition_variable m_queueCondition{};
+    std::deque<std::pair<std::function<void()>, int64_t>> m_queue{};
+    std::atomic<uint32_t> m_queueDepth{0};
+    std::atomic<uint32_t> m_maxQueueDepth{0};
+    bool m_running{true};
+    std::thread m_thread{};
+
+    Histogram m_queueLatency{};
+    Histogram m_handlerLatency{};
+};
+} // namespace cluon
 
-    uint32_t m_desiredInitialLevel;
+#endif
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-    // Fields to compute replay throughput for cache management.
-    cluon::data::TimeStamp m_firstTimePointReturningAEnvelope;
-    uint64_t m_numberOfReturnedEnvelopesInTotal;
+#ifndef CLUON_FRAGMENTATION_HPP
+#define CLUON_FRAGMENTATION_HPP
 
-    uint32_t m_delay;
+//#include "cluon/cluon.hpp"
+//#include "cluon/UDPPacketSizeConstraints.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cluon {
+/**
+Serialized Envelopes larger than a UDP packet are sent as fragments that
+start with a header different from the OD4 header so that receivers not
+knowing about fragments drop them. All numbers are little endian:
+
+    uint8 0x0D uint8 0xA5 uint32 message uint32 totalSize uint32 offset uint16 index uint16 numberOfFragments
+    bytes [offset, offset + fragment size) of the serialized Envelope
+
+The message number is counted per sender so that receivers can tell apart
+fragments of different messages from the same sender.
+*/
+class LIBCLUON_API Fragmentation {
+   public:
+    enum : uint32_t {
+        HEADER_SIZE = 18,
+        // Largest UDP payload minus the fragment header.
+        MAX_FRAGMENT_SIZE = static_cast<uint32_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
+                            - static_cast<uint32_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
+                            - static_cast<uint32_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER) - HEADER_SIZE,
+        // The OD4 header holds the length of an Envelope in 3 bytes.
+        MAX_MESSAGE_SIZE = 5 + 0xFFFFFF,
+    };
 
-   private:
     /**
-     * This method sets the state of the envelopeCacheFilling thread.
+     * @return true if the given bytes start with a fragment header.
+     */
+    static bool isFragment(const char *data, std::size_t size) noexcept;
+
+    /**
+     * This method splits a serialized Envelope into fragments.
      *
-     * @param running False if the thread to fill the Envelope cache shall be joined.
+     * @param data Serialized Envelope.
+     * @param message Message number of the sender.
+     * @return Fragments to be sent.
      */
-    void setEnvelopeCacheFillingRunning(const bool &running) noexcept;
-    bool isEnvelopeCacheFillingRunning() const noexcept;
+    static std::vector<std::string> split(const std::string &data, uint32_t message) noexcept;
+};
+
+/**
+This class reassembles fragmented Envelopes. Messages being reassembled
+occupy one of a fixed number of slots whose buffers are kept for the next
+message; a message that does not complete within the timeout or whose slot
+is needed for a newer message is counted as lost. This class is not
+thread-safe except for reading the statistics.
+*/
+class LIBCLUON_API FragmentAssembler {
+   private:
+    FragmentAssembler(const FragmentAssembler &) = delete;
+    FragmentAssembler(FragmentAssembler &&)      = delete;
+    FragmentAssembler &operator=(const FragmentAssembler &) = delete;
+    FragmentAssembler &operator=(FragmentAssembler &&) = delete;
+
+   public:
+    struct Statistics {
+        uint64_t m_fragments{0};   // Fragments received.
+        uint64_t m_reassembled{0}; // Messages completed.
+        uint64_t m_lost{0};        // Messages dropped incomplete.
+        uint64_t m_discarded{0};   // Malformed or duplicate fragments.
+    };
 
+   public:
     /**
-     * This method manages the cache.
+     * Constructor.
+     *
+     * @param numberOfSlots Number of messages that can be reassembled at the same time.
+     * @param timeout Time for a message to complete after its first fragment.
      */
-    void manageCache() noexcept;
+    FragmentAssembler(uint32_t numberOfSlots = 8, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) noexcept;
+    ~FragmentAssembler() = default;
 
     /**
-     * This method checks whether the cache needs to be refilled.
+     * This method adds a fragment.
      *
-     * @param numberOfEntries Number of entries in cache.
-     * @param refillMultiplicator Multiplicator to modify the amount of envelopes to be refilled.
-     * @return Modified refillMultiplicator recommedned to be used next time
+     * @param from Sender of the fragment.
+     * @param data Fragment including its header.
+     * @param size Size of the fragment.
+     * @return Completed serialized Envelope, valid until the next call, or nullptr.
      */
-    float checkRefillingCache(const uint32_t &numberOfEntries, float refillMultiplicator) noexcept;
+    const std::string *add(const std::string &from, const char *data, std::size_t size) noexcept;
 
-   private:
-    mutable std::mutex m_envelopeCacheFillingThreadIsRunningMutex;
-    bool m_envelopeCacheFillingThreadIsRunning;
-    std::thread m_envelopeCacheFillingThread;
+    /**
+     * @return Statistics.
+     */
+    Statistics statistics() const noexcept;
 
-    // Mapping of pos_type (within .rec file) --> cluon::data::Envelope (read from .rec file).
-    std::map<uint64_t, cluon::data::Envelope> m_envelopeCache;
+   private:
+    struct Slot {
+        bool m_used{false};
+        std::string m_from{};
+        uint32_t m_message{0};
+        uint32_t m_missingFragments{0};
+        std::chrono::steady_clock::time_point m_started{};
+        std::vector<bool> m_received{};
+        std::string m_buffer{};
+    };
 
-   public:
-    void setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept;
+    void expire(std::chrono::steady_clock::time_point now) noexcept;
 
    private:
-    std::mutex m_playerListenerMutex;
-    std::function<void(cluon::data::PlayerStatus playerStatus)> m_playerListener{nullptr};
+    const std::chrono::milliseconds m_timeout;
+    std::vector<Slot> m_slots{};
+    Slot *m_completed{nullptr};
+
+    std::atomic<uint64_t> m_fragments{0};
+    std::atomic<uint64_t> m_reassembled{0};
+    std::atomic<uint64_t> m_lost{0};
+    std::atomic<uint64_t> m_discarded{0};
 };
-
 } // namespace cluon
 
 #endif
 /*
- * Copyright (C) 2017-2018  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-#ifndef CLUON_SHAREDMEMORY_HPP
-#define CLUON_SHAREDMEMORY_HPP
+#ifndef CLUON_SHAREDMEMORYRING_HPP
+#define CLUON_SHAREDMEMORYRING_HPP
 
 //#include "cluon/cluon.hpp"
-//#include "cluon/cluonDataStructures.hpp"
-
-// clang-format off
-#ifdef WIN32
-    #include <Windows.h>
-#else
-    #include <pthread.h>
-    #include <sys/ipc.h>
-#endif
-// clang-format on
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <atomic>
 #include <string>
-#include <utility>
 
 namespace cluon {
+/**
+This class broadcasts byte sequences between processes on the same host
+through a ring of fixed-size slots in POSIX shared memory. Any number of
+processes can push into the ring and every reader sees every pushed byte
+sequence from the moment it attached on:
+
+- a producer claims the next slot by incrementing the shared write index and
+  marks the slot as being written, copies its bytes, and publishes the slot
+  with the write index it claimed (per-slot seqlock),
+- a reader keeps its own read index, copies a published slot, and validates
+  afterwards that the slot was not overwritten meanwhile; readers that fall
+  behind by more than the number of slots skip ahead and count the skipped
+  byte sequences as lost,
+- waiting readers sleep on a futex in the shared memory that producers wake
+  only if a reader is waiting.
+
+Processes using the ring can register as participants with an identifier of
+their own in a table in the shared memory (join) and keep the registration
+alive by calling heartbeat regularly; registrations without a heartbeat for
+PARTICIPANT_TIMEOUT milliseconds expire, so the table does not fill up with
+processes that ended without calling leave. Others can look up whether a
+participant with a given identifier is alive (hasParticipant).
+
+The ring is created by the first process and reused by the following ones; it
+is not removed when the processes end. It is only available on Linux; on other
+platforms, valid() returns false.
 
-class LIBCLUON_API SharedMemory {
+\code{.cpp}
+cluon::SharedMemoryRing ring{"/cluon-example"};
+uint64_t cursor{ring.attach()};
+ring.push("Hello", 5, 1);
+
+std::string data;
+uint64_t sender{0};
+if (cluon::SharedMemoryRing::RECEIVED == ring.pop(cursor, data, sender, std::chrono::milliseconds(100))) {
+    std::cout << data << " from " << sender << std::endl;
+}
+\endcode
+*/
+class LIBCLUON_API SharedMemoryRing {
    private:
-    SharedMemory(const SharedMemory &) = delete;
-    SharedMemory(SharedMemory &&)      = delete;
-    SharedMemory &operator=(const SharedMemory &) = delete;
-    SharedMemory &operator=(SharedMemory &&) = delete;
+    SharedMemoryRing(const SharedMemoryRing &) = delete;
+    SharedMemoryRing(SharedMemoryRing &&)      = delete;
+    SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+    SharedMemoryRing &operator=(SharedMemoryRing &&) = delete;
+
+   public:
+    enum PopResult : uint8_t {
+        RECEIVED = 0,
+        TIMEOUT  = 1,
+        INVALID  = 2,
+    };
+
+    enum : uint32_t {
+        MAX_PARTICIPANTS = 64,
+        // A participant without a heartbeat for this many milliseconds is not alive anymore.
+        PARTICIPANT_TIMEOUT = 1000,
+    };
 
    public:
     /**
      * Constructor.
      *
-     * @param name Name of the shared memory area; must start with / and must not
-     * be longer than NAME_MAX (255) on POSIX or PATH_MAX on WIN32. If the name
-     * is missing a leading '/' or is longer than 255, it will be adjusted accordingly.
-     * @param size of the shared memory area to create; if size is 0, the class tries to attach to an existing area.
+     * @param name Name of the POSIX shared memory, starting with '/'.
+     * @param slots Number of slots; processes using the same name must agree on it.
+     * @param slotSize Maximum number of bytes per slot; processes using the same name must agree on it.
      */
-    SharedMemory(const std::string &name, uint32_t size = 0) noexcept;
-    ~SharedMemory() noexcept;
-
-    /**
-     * @return true when this shared memory area is locked.
-     */
-    bool isLocked() const noexcept;
+    SharedMemoryRing(const std::string &name, uint32_t slots = 128, uint32_t slotSize = 65536) noexcept;
+    ~SharedMemoryRing() noexcept;
 
     /**
-     * This method locks the shared memory area.
+     * @return true if the shared memory is mapped and its layout matches.
      */
-    void lock() noexcept;
+    bool valid() const noexcept;
 
     /**
-     * This method unlocks the shared memory area.
+     * @return Maximum number of bytes that can be pushed at once.
      */
-    void unlock() noexcept;
+    uint32_t slotSize() const noexcept;
 
     /**
-     * This method waits for being notified from the shared condition.
+     * @return Read index to start reading from for a new reader.
      */
-    void wait() noexcept;
+    uint64_t attach() const noexcept;
 
     /**
-     * This method notifies all threads waiting on the shared condition.
+     * This method copies the given bytes into the next slot and wakes waiting readers.
+     *
+     * @param data Bytes to push.
+     * @param size Number of bytes to push.
+     * @param sender Identifier of the sender that readers can use to filter.
+     * @return true if the bytes fit into a slot and were pushed.
      */
-    void notifyAll() noexcept;
+    bool push(const char *data, std::size_t size, uint64_t sender) noexcept;
 
     /**
-     * This method sets the time stamp that can be used to
-     * express the sample time stamp of the data in residing
-     * in the shared memory.
-     *
-     * This method is only allowed when the shared memory is locked.
+     * This method copies the next byte sequence for a reader or waits for one.
      *
-     * @param ts TimeStamp.
-     * @return true if the timestamp could set; false if the shared memory was not locked.
+     * @param cursor Read index of the reader; advanced past the returned byte sequence.
+     * @param data Bytes that were read.
+     * @param sender Identifier of the sender of the bytes.
+     * @param timeout Maximum time to wait for a byte sequence.
+     * @return RECEIVED, TIMEOUT, or INVALID if the ring is not valid.
      */
-    bool setTimeStamp(const cluon::data::TimeStamp &ts) noexcept;
+    PopResult pop(uint64_t &cursor, std::string &data, uint64_t &sender, std::chrono::milliseconds timeout) noexcept;
 
     /**
-     * This method returns the sample time stamp.
-     *
-     * This method is only allowed when the shared memory is locked.
-     *
-     * @return (true, sample time stamp) or (false, 0) in case if the shared memory was not locked.
+     * @return Number of byte sequences this process skipped as it read too slowly.
      */
-    std::pair<bool, cluon::data::TimeStamp> getTimeStamp() noexcept;
+    uint64_t lost() const noexcept;
 
-   public:
     /**
-     * @return True if the shared memory area is existing and usable.
+     * This method registers a participant in the shared memory.
+     *
+     * @param identifier Identifier of the participant (!= 0).
+     * @return true if the participant was registered; false if all MAX_PARTICIPANTS entries are taken by live participants.
      */
-    bool valid() noexcept;
+    bool join(uint64_t identifier) noexcept;
 
     /**
-     * @return Pointer to the raw shared memory or nullptr in case of invalid shared memory.
+     * This method removes the registration of a participant.
+     *
+     * @param identifier Identifier of the participant.
      */
-    char *data() noexcept;
+    void leave(uint64_t identifier) noexcept;
 
     /**
-     * @return The size of the shared memory area.
+     * This method keeps the registration of a participant alive; it needs to
+     * be called more often than every PARTICIPANT_TIMEOUT milliseconds. An
+     * expired registration is renewed.
+     *
+     * @param identifier Identifier of the participant.
+     * @return true if the participant is registered.
      */
-    uint32_t size() const noexcept;
+    bool heartbeat(uint64_t identifier) noexcept;
 
     /**
-     * @return Name the shared memory area.
+     * @param identifier Identifier to look for.
+     * @param mask Bits of the identifier to compare.
+     * @return true if a live participant matches identifier in the bits of mask.
      */
-    const std::string name() const noexcept;
+    bool hasParticipant(uint64_t identifier, uint64_t mask = ~static_cast<uint64_t>(0)) const noexcept;
 
-#ifdef WIN32
-   private:
-    void initWIN32() noexcept;
-    void deinitWIN32() noexcept;
-    void lockWIN32() noexcept;
-    void unlockWIN32() noexcept;
-    void waitWIN32() noexcept;
-    void notifyAllWIN32() noexcept;
-#else
    private:
-    void initPOSIX() noexcept;
-    void deinitPOSIX() noexcept;
-    void lockPOSIX() noexcept;
-    void unlockPOSIX() noexcept;
-    void waitPOSIX() noexcept;
-    void notifyAllPOSIX() noexcept;
-    bool validPOSIX() noexcept;
+    struct Header;
+    struct Slot;
+    struct Participant;
 
-    void initSysV() noexcept;
-    void deinitSysV() noexcept;
-    void lockSysV() noexcept;
-    void unlockSysV() noexcept;
-    void waitSysV() noexcept;
-    void notifyAllSysV() noexcept;
-    bool validSysV() noexcept;
-#endif
+    static int64_t now() noexcept;
+    Participant *participant(uint32_t index) const noexcept;
+    Slot *slot(uint64_t index) const noexcept;
+    void wait(uint32_t value, std::chrono::milliseconds timeout) noexcept;
+    void wake() noexcept;
 
    private:
-    std::string m_name{""};
-    std::string m_nameForTimeStamping{""};
-    uint32_t m_size{0};
-    char *m_sharedMemory{nullptr};
-    char *m_userAccessibleSharedMemory{nullptr};
-    bool m_hasOnlyAttachedToSharedMemory{false};
-
-    std::atomic<bool> m_broken{false};
-    std::atomic<bool> m_isLocked{false};
+    std::string m_name{};
+    uint32_t m_slots{0};
+    uint32_t m_slotSize{0};
+    std::size_t m_slotStride{0};
+    std::size_t m_slotsOffset{0};
+    std::size_t m_size{0};
+    char *m_memory{nullptr};
+    Header *m_header{nullptr};
+    std::atomic<uint64_t> m_lost{0};
+};
+} // namespace cluon
 
-#ifdef WIN32
-    HANDLE __conditionEvent{nullptr};
-    HANDLE __mutex{nullptr};
-    HANDLE __sharedMemory{nullptr};
-#else
-    int32_t m_fdForTimeStamping{-1};
-
-    bool m_usePOSIX{true};
-
-    // Member fields for POSIX-based shared memory.
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    int32_t m_fd{-1};
-    struct SharedMemoryHeader {
-        uint32_t __size;
-        pthread_mutex_t __mutex;
-        pthread_cond_t __condition;
-    };
-    SharedMemoryHeader *m_sharedMemoryHeader{nullptr};
-#endif
-
-    // Member fields for SysV-based shared memory.
-    key_t m_shmKeySysV{0};
-    key_t m_mutexKeySysV{0};
-    key_t m_conditionKeySysV{0};
-
-    int m_sharedMemoryIDSysV{-1};
-    int m_mutexIDSysV{-1};
-    int m_conditionIDSysV{-1};
 #endif
-};
-} // namespace cluon
-
-#endif
-#ifndef BEGIN_HEADER_ONLY_IMPLEMENTATION
-#define BEGIN_HEADER_ONLY_IMPLEMENTATION
 /*
  * Copyright (C) 2017-2018  Christian Berger
  *
@@ -9425,732 +9622,890 @@ class LIBCLUON_API SharedMemory {
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "argh/argh.h"
+#ifndef CLUON_OD4SESSION_HPP
+#define CLUON_OD4SESSION_HPP
 
+//#include "cluon/ExecutionLane.hpp"
+//#include "cluon/Fragmentation.hpp"
+//#include "cluon/SharedMemoryRing.hpp"
+//#include "cluon/Time.hpp"
+//#include "cluon/ToProtoVisitor.hpp"
+//#include "cluon/UDPReceiver.hpp"
+//#include "cluon/UDPSender.hpp"
 //#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace cluon {
+/**
+This class provides an interface to an OpenDaVINCI v4 session. An OpenDaVINCI
+v4 session allows the automatic exchange of time-stamped Envelopes carrying
+user-defined messages usually using UDP multicast. A running OD4Session will not
+receive the bytes that itself has sent to other microservices.
 
-inline std::map<std::string, std::string> getCommandlineArguments(int32_t argc, char **argv) noexcept {
-    argh::parser commandline{argc, argv};
-    std::map<std::string, std::string> retVal;
+There are two ways to participate in an OpenDaVINCI session. Variant A is simply
+calling a user-supplied lambda whenever a new Envelope is received:
 
-    for (auto &positionalArgument : commandline.pos_args()) { retVal[positionalArgument] = ""; }
+\code{.cpp}
+cluon::OD4Session od4{111, [](cluon::data::Envelope &&envelope){ std::cout << "Received cluon::Envelope" << std::endl;}
+};
 
-    for (auto &flag : commandline.flags()) { retVal[flag] = "1"; }
+// Do something in parallel.
 
-    for (auto &parameter : commandline.params()) { retVal[parameter.first] = parameter.second; }
+MyMessage msg;
+od4.send(msg);
+\endcode
 
-    return retVal;
-}
+Variant B allows a more fine-grained setup where you specify the Envelopes of interest:
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+\code{.cpp}
+cluon::OD4Session od4{111};
 
-//#include "cluon/MetaMessage.hpp"
+od4.dataTrigger(cluon::data::TimeStamp::ID(), [](cluon::data::Envelope &&envelope){ std::cout << "Received cluon::data::TimeStamp" << std::endl;});
+od4.dataTrigger(MyMessage::ID(), [](cluon::data::Envelope &&envelope){ std::cout << "Received MyMessage" << std::endl;});
 
-namespace cluon {
+// Do something in parallel.
 
-inline MetaMessage::MetaField::MetaFieldDataTypes MetaMessage::MetaField::fieldDataType() const noexcept {
-    return m_fieldDataType;
-}
+MyMessage msg;
+od4.send(msg);
+\endcode
 
-inline MetaMessage::MetaField &MetaMessage::MetaField::fieldDataType(const MetaMessage::MetaField::MetaFieldDataTypes &v) noexcept {
-    m_fieldDataType = v;
-    return *this;
-}
+Several delegates can subscribe to the same message identifier, optionally
+only for certain sender stamps:
 
-inline std::string MetaMessage::MetaField::fieldDataTypeName() const noexcept {
-    return m_fieldDataTypeName;
-}
+\code{.cpp}
+cluon::OD4Session od4{111};
 
-inline MetaMessage::MetaField &MetaMessage::MetaField::fieldDataTypeName(const std::string &v) noexcept {
-    m_fieldDataTypeName = v;
-    return *this;
-}
+auto left = od4.subscribe(MyMessage::ID(), [](cluon::data::Envelope &&envelope){ std::cout << "Received MyMessage/1" << std::endl;}, {1});
+auto any = od4.subscribe(MyMessage::ID(), [](cluon::data::Envelope &&envelope){ std::cout << "Received MyMessage" << std::endl;});
 
-inline std::string MetaMessage::MetaField::fieldName() const noexcept {
-    return m_fieldName;
-}
+od4.unsubscribe(left);
+\endcode
 
-inline MetaMessage::MetaField &MetaMessage::MetaField::fieldName(const std::string &v) noexcept {
-    m_fieldName = v;
-    return *this;
-}
+Data-triggered delegates run on the thread receiving the Envelopes unless
+their message identifier is assigned to an execution lane with a thread of
+its own; the lanes report their queue depth and latencies:
 
-inline uint32_t MetaMessage::MetaField::fieldIdentifier() const noexcept {
-    return m_fieldIdentifier;
-}
+\code{.cpp}
+od4.assignExecutionLane(MyImageMessage::ID(), 1);
+std::cout << od4.executionLane(1)->handlerLatency().valueAtPercentile(99.0) << std::endl;
+\endcode
 
-inline MetaMessage::MetaField &MetaMessage::MetaField::fieldIdentifier(uint32_t v) noexcept {
-    m_fieldIdentifier = v;
-    return *this;
-}
+Next to receive Envelopes, OD4Session can call a user-supplied lambda in a time-triggered
+way. The lambda is executed as long as it does not return false or throws an exception
+that is then caught in the method timeTrigger and the method is exited:
 
-inline std::string MetaMessage::MetaField::defaultInitializationValue() const noexcept {
-    return m_defaultInitializationValue;
-}
+\code{.cpp}
+cluon::OD4Session od4{111};
 
-inline MetaMessage::MetaField &MetaMessage::MetaField::defaultInitializationValue(const std::string &v) noexcept {
-    m_defaultInitializationValue = v;
-    return *this;
-}
+const float FREQ{10}; // 10 Hz.
+od4.timeTrigger(FREQ, [](){
+  // Do something time-triggered.
+  return false;
+}); // This call blocks until the lambda returns false.
+\endcode
 
-////////////////////////////////////////////////////////////////////////////////
+Microservices on the same host exchange Envelopes through the shared memory
+"/cluon-od4-CID" (cf. cluon::SharedMemoryRing) next to UDP multicast. Every
+OD4Session registers in the shared memory as a participant identified by the
+port it sends its UDP packets from and pushes every Envelope that fits into one
+UDP packet into the shared memory:
+
+- UDP packets from the ports of live participants on this host are dropped
+  when they are received as their Envelopes arrived through the shared memory
+  already; fragmented Envelopes are only sent via UDP multicast,
+- any other UDP packet shows that a microservice on another host or one
+  without the shared memory takes part in the session; as long as no such
+  packet arrived for OUTSIDER_TIMEOUT milliseconds, Envelopes are only pushed
+  into the shared memory and not sent via UDP multicast anymore.
+
+Microservices that never send anything cannot be detected; they receive
+nothing while all senders are on the same host. Setting the environment
+variable CLUON_OD4SESSION_SHM=0 disables the shared memory and sends and
+receives all Envelopes via UDP multicast, as OD4Session does if the shared
+memory cannot be used.
+*/
+class LIBCLUON_API OD4Session {
+   private:
+    OD4Session(const OD4Session &) = delete;
+    OD4Session(OD4Session &&)      = delete;
+    OD4Session &operator=(const OD4Session &) = delete;
+    OD4Session &operator=(OD4Session &&) = delete;
 
-inline MetaMessage::MetaMessage() noexcept {}
+   public:
+    /**
+     * Constructor.
+     *
+     * @param CID OpenDaVINCI v4 session identifier [1 .. 254]
+     * @param delegate Function to call on newly arriving Envelopes ("catch-all");
+     *        if a nullptr is passed, the method dataTrigger can be used to set
+     *        message specific delegates. Please note that it is NOT possible
+     *        to have both: a delegate for "catch-all" and the data-triggered ones.
+     */
+    OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate = nullptr) noexcept;
+    ~OD4Session();
 
-inline std::string MetaMessage::packageName() const noexcept {
-    return m_packageName;
-}
+    /**
+     * This method will send a given Envelope to this OpenDaVINCI v4 session.
+     *
+     * @param envelope to be sent.
+     */
+    void send(cluon::data::Envelope &&envelope) noexcept;
 
-inline std::string MetaMessage::messageName() const noexcept {
-    return m_messageName;
-}
+    /**
+     * This method sets a delegate to be called data-triggered on arrival
+     * of a new Envelope for a given message identifier.
+     *
+     * @param messageIdentifier Message identifier to assign a delegate.
+     * @param delegate Function to call on newly arriving Envelopes; setting it to nullptr will erase it.
+     * @return true if the given delegate could be successfully set or unset.
+     */
+    bool dataTrigger(int32_t messageIdentifier, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept;
 
-inline MetaMessage &MetaMessage::packageName(const std::string &v) noexcept {
-    m_packageName = v;
-    return *this;
-}
+    /**
+     * This method adds a delegate to be called data-triggered on arrival of a
+     * new Envelope for a given message identifier; other delegates for the
+     * same message identifier, including the one set by dataTrigger, are kept.
+     * Envelopes from other sender stamps are dropped before they are
+     * decoded. Delegates run concurrently to subscribe and unsubscribe; a
+     * delegate might be called once more for an Envelope being dispatched
+     * while it is unsubscribed.
+     *
+     * @param messageIdentifier Message identifier to subscribe to.
+     * @param delegate Function to call on newly arriving Envelopes.
+     * @param senderStamps Sender stamps of interest; empty for all.
+     * @return Identifier of the subscription for unsubscribe or 0 if the delegate could not be added.
+     */
+    uint32_t subscribe(int32_t messageIdentifier,
+                       std::function<void(cluon::data::Envelope &&envelope)> delegate,
+                       const std::vector<uint32_t> &senderStamps = {}) noexcept;
 
-inline MetaMessage &MetaMessage::messageName(const std::string &v) noexcept {
-    m_messageName = v;
-    return *this;
-}
+    /**
+     * This method removes a delegate added by subscribe.
+     *
+     * @param subscription Identifier returned by subscribe.
+     * @return true if the subscription was found and removed.
+     */
+    bool unsubscribe(uint32_t subscription) noexcept;
 
-inline int32_t MetaMessage::messageIdentifier() const noexcept {
-    return m_messageIdentifier;
-}
+    /**
+     * This method assigns the data-triggered delegates of a message identifier
+     * to an execution lane. Lane 0 is the thread receiving the Envelopes and
+     * the default for all message identifiers; every other lane has a thread
+     * of its own and runs the delegates of the message identifiers assigned to
+     * it in order of arrival. Thus, a slow delegate delays only the message
+     * identifiers sharing its lane.
+     *
+     * @param messageIdentifier Message identifier to assign.
+     * @param lane Lane to run the delegates for messageIdentifier.
+     * @return true if the lane could be assigned.
+     */
+    bool assignExecutionLane(int32_t messageIdentifier, uint32_t lane) noexcept;
 
-inline MetaMessage &MetaMessage::messageIdentifier(int32_t v) noexcept {
-    m_messageIdentifier = v;
-    return *this;
-}
+    /**
+     * @param lane Lane number.
+     * @return Execution lane to read its queue depth and latencies or nullptr if the lane was never assigned.
+     */
+    std::shared_ptr<const ExecutionLane> executionLane(uint32_t lane) noexcept;
 
-inline MetaMessage &MetaMessage::add(MetaMessage::MetaField &&mf) noexcept {
-    m_listOfMetaFields.emplace_back(std::move(mf));
-    return *this;
-}
+    /**
+     * This method enables sending Envelopes larger than a UDP packet as
+     * fragments (cf. cluon::Fragmentation); otherwise, they are not sent.
+     * Receiving fragments is always possible.
+     *
+     * @param enable True to send large Envelopes as fragments.
+     */
+    void fragmentLargeEnvelopes(bool enable) noexcept;
 
-inline const std::vector<MetaMessage::MetaField> &MetaMessage::listOfMetaFields() const noexcept {
-    return m_listOfMetaFields;
-}
+    /**
+     * @return Statistics about reassembling received fragments.
+     */
+    FragmentAssembler::Statistics fragmentStatistics() const noexcept;
 
-inline void MetaMessage::accept(const std::function<void(const MetaMessage &)> &visit) {
-    visit(*this);
-}
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+    /**
+     * This method sets a delegate to be called time-triggered using the
+     * specified frequency until the delegate returns false. This method
+     * blocks until the delegate has returned false or threw an exception.
+     * Thus, this method is typically called as last statement in a main
+     * function of a program. Activations are scheduled by
+     * cluon::PeriodicScheduler; activations missed while the delegate
+     * ran late are skipped.
+     *
+     * @param freq Frequency in Hertz to run the given delegate.
+     * @param delegate Function to call according to the given frequency.
+     */
+    void timeTrigger(float freq, std::function<bool()> delegate) noexcept;
 
-//#include "cluon/MessageParser.hpp"
-//#include "cluon/stringtoolbox.hpp"
+    /**
+     * This method will send a given message to this OpenDaVINCI v4 session.
+     *
+     * @param message Message to be sent.
+     * @param sampleTimeStamp Time point when this sample to be sent was captured (default = sent time point).
+     * @param senderStamp Optional sender stamp (default = 0).
+     */
+    template <typename T>
+    void send(T &message, const cluon::data::TimeStamp &sampleTimeStamp = cluon::data::TimeStamp(), uint32_t senderStamp = 0) noexcept {
+        try {
+            cluon::ToProtoVisitor protoEncoder;
 
-//#include "cpp-peglib/peglib.h"
-
-#include <algorithm>
-#include <functional>
-#include <iostream>
-#include <memory>
-#include <regex>
-#include <string>
-#include <vector>
+            cluon::data::Envelope envelope;
+            {
+                envelope.dataType(static_cast<int32_t>(message.ID()));
+                message.accept(protoEncoder);
+                envelope.serializedData(protoEncoder.encodedData());
+                envelope.sent(cluon::time::now());
+                envelope.sampleTimeStamp((0 == (sampleTimeStamp.seconds() + sampleTimeStamp.microseconds())) ? envelope.sent() : sampleTimeStamp);
+                envelope.senderStamp(senderStamp);
+            }
 
-namespace cluon {
+            send(std::move(envelope));
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
 
-inline std::pair<std::vector<MetaMessage>, MessageParser::MessageParserErrorCodes> MessageParser::parse(const std::string &input) {
-    const char *grammarMessageSpecificationLanguage = R"(
-        MESSAGES_SPECIFICATION      <- PACKAGE_DECLARATION? MESSAGE_DECLARATION*
-        PACKAGE_DECLARATION         <- 'package' PACKAGE_IDENTIFIER ';'
-        PACKAGE_IDENTIFIER          <- < IDENTIFIER ('.' IDENTIFIER)* >
+   public:
+    bool isRunning() noexcept;
 
-        MESSAGE_DECLARATION         <- 'message' MESSAGE_IDENTIFIER MESSAGE_OPTIONS '{' FIELD* '}'
-        MESSAGE_IDENTIFIER          <- < IDENTIFIER ('.' IDENTIFIER)* >
-        MESSAGE_OPTIONS             <- '[' 'id' '=' NATURAL_NUMBER ','? ']'
+   private:
+    void callback(std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) noexcept;
+    void readSharedMemory(uint64_t cursor) noexcept;
+    bool acceptViaUDP(const char *data, std::size_t size, uint16_t port, bool local) noexcept;
+    bool sharedMemoryOnly() const noexcept;
+    void process(const char *data, std::size_t size, const std::chrono::system_clock::time_point &timepoint) noexcept;
+    void sendInternal(std::string &&dataToSend) noexcept;
 
-        FIELD                       <- PRIMITIVE_FIELD
+    /**
+     * This method sends serialized Envelopes with one system call where possible.
+     *
+     * @param serializedEnvelopes Envelopes to send.
+     * @param coalesce True to pack several Envelopes into one UDP packet.
+     */
+    void sendBatch(std::vector<std::string> &&serializedEnvelopes, bool coalesce) noexcept;
 
-        PRIMITIVE_FIELD             <- PRIMITIVE_TYPE IDENTIFIER ('[' PRIMITIVE_FIELD_OPTIONS ']')? ';'
-        PRIMITIVE_FIELD_OPTIONS     <- PRIMITIVE_FIELD_DEFAULT? ','? NUMERICAL_FIELD_IDENTIFIER?
-        NUMERICAL_FIELD_IDENTIFIER  <- 'id' '=' NATURAL_NUMBER
-        PRIMITIVE_FIELD_DEFAULT     <- 'default' '=' (FLOAT_NUMBER / BOOL / CHARACTER / STRING)
-        PRIMITIVE_TYPE              <- < 'bool' / 'float' / 'double' /
-                                         'char' /
-                                         'bytes' / 'string' /
-                                         'int8' / 'uint8' / 
-                                         'int16' / 'uint16' / 
-                                         'int32' / 'uint32' / 
-                                         'int64' / 'uint64' /
-                                         MESSAGE_TYPE >
+    friend class SendBatch;
 
-        MESSAGE_TYPE                <- < IDENTIFIER ('.' IDENTIFIER)* >
+   private:
+    struct Subscription {
+        uint32_t m_identifier{0};
+        std::vector<uint32_t> m_senderStamps{}; // Sorted; empty for all.
+        std::shared_ptr<std::function<void(cluon::data::Envelope &&envelope)>> m_delegate{};
 
-        IDENTIFIER                  <- < [a-zA-Z][a-zA-Z0-9_]* >
-        DIGIT                       <- < [0-9] >
-        NATURAL_NUMBER              <- < [1-9] DIGIT* >
-        FLOAT_NUMBER                <- < ('+' / '-')? DIGIT DIGIT* (('.') DIGIT*)? >
-        BOOL                        <- < 'true' > / < 'false' >
-        STRING                      <- '"' < (!'"'.)* > '"'
-        CHARACTER                   <- '\'' < (!'\'' .) > '\''
+        bool accepts(uint32_t senderStamp) const noexcept;
+    };
 
-        %whitespace                 <- [ \t\r\n]*
-    )";
+    // Immutable once published; changes copy the table and publish the copy (copy-on-write).
+    struct DispatchTable {
+        std::unordered_map<int32_t, std::vector<Subscription>, UseUInt32ValueAsHashKey> m_subscriptions{};
+        std::unordered_map<int32_t, std::shared_ptr<ExecutionLane>, UseUInt32ValueAsHashKey> m_lanes{};
+    };
 
-    ////////////////////////////////////////////////////////////////////////////
+    /**
+     * This method changes a copy of the current dispatch table and publishes it.
+     */
+    void updateDispatchTable(std::function<void(DispatchTable &)> change);
 
-    // Function to check for unique field names.
-    std::function<bool(const peg::Ast &, std::string &, std::vector<std::string> &, std::vector<std::string> &, std::vector<int32_t> &, std::vector<int32_t> &)>
-        check4UniqueFieldNames = [&checkForUniqueFieldNames = check4UniqueFieldNames](const peg::Ast &ast,
-                                                                                      std::string &prefix,
-                                                                                      std::vector<std::string> &messageNames,
-                                                                                      std::vector<std::string> &fieldNames,
-                                                                                      std::vector<int32_t> &numericalMessageIdentifiers,
-                                                                                      std::vector<int32_t> &numericalFieldIdentifiers) {
-            bool retVal = true;
-            // First, we need to visit the children of AST node MESSAGES_SPECIFICATION.
-            if ("MESSAGES_SPECIFICATION" == ast.name) {
-                for (const auto &node : ast.nodes) {
-                    retVal &= checkForUniqueFieldNames(*node, prefix, messageNames, fieldNames, numericalMessageIdentifiers, numericalFieldIdentifiers);
-                }
-                // Try finding duplicated message identifiers.
-                if (retVal) {
-                    std::sort(std::begin(numericalMessageIdentifiers), std::end(numericalMessageIdentifiers));
-                    int32_t duplicatedMessageIdentifier{-1};
-                    for (auto it{std::begin(numericalMessageIdentifiers)}; it != std::end(numericalMessageIdentifiers); it++) {
-                        if (it + 1 != std::end(numericalMessageIdentifiers)) {
-                            if (std::find(it + 1, std::end(numericalMessageIdentifiers), *it) != std::end(numericalMessageIdentifiers)) {
-                                duplicatedMessageIdentifier = *it;
-                            }
-                        }
-                    }
-                    retVal &= (-1 == duplicatedMessageIdentifier);
-                    if (!retVal) {
-                        std::cerr << "[cluon::MessageParser] Found duplicated numerical message identifier: " << duplicatedMessageIdentifier << '\n';
-                    }
-                }
-                // Try finding duplicated message names.
-                if (retVal) {
-                    std::sort(std::begin(messageNames), std::end(messageNames));
-                    std::string duplicatedMessageName;
-                    for (auto it{std::begin(messageNames)}; it != std::end(messageNames); it++) {
-                        if (it + 1 != std::end(messageNames)) {
-                            if (std::find(it + 1, std::end(messageNames), *it) != std::end(messageNames)) {
-                                duplicatedMessageName = *it;
-                            }
-                        }
-                    }
-                    retVal &= (duplicatedMessageName.empty());
-                    if (!retVal) {
-                        std::cerr << "[cluon::MessageParser] Found duplicated message name '" << duplicatedMessageName << "'" << '\n';
-                    }
-                }
-            }
-            // Second, we need to visit the children of AST node MESSAGE_DECLARATION.
-            if ("MESSAGE_DECLARATION" == ast.name) {
-                fieldNames.clear();
-                numericalFieldIdentifiers.clear();
-                prefix = "";
-                retVal = true;
+    /**
+     * This method calls the subscribers of the given Envelope.
+     */
+    static void dispatch(const DispatchTable &table, cluon::data::Envelope &&env) noexcept;
 
-                for (const auto &node : ast.nodes) {
-                    if ("MESSAGE_IDENTIFIER" == node->name) {
-                        prefix = node->token;
-                        messageNames.push_back(::stringtoolbox::trim(prefix));
-                    } else if ("NATURAL_NUMBER" == node->name) {
-                        numericalMessageIdentifiers.push_back(std::stoi(node->token));
-                    } else if ("PRIMITIVE_FIELD" == node->name) {
-                        retVal &= checkForUniqueFieldNames(*node, prefix, messageNames, fieldNames, numericalMessageIdentifiers, numericalFieldIdentifiers);
-                    }
-                }
+   private:
+    enum : uint32_t {
+        // Milliseconds without UDP packets from microservices not using the shared memory before UDP multicast is not used anymore.
+        OUTSIDER_TIMEOUT = 5000,
+    };
 
-                // Try finding duplicated numerical field identifiers.
-                if (retVal) {
-                    std::sort(std::begin(numericalFieldIdentifiers), std::end(numericalFieldIdentifiers));
-                    int32_t duplicatedFieldIdentifier{-1};
-                    for (auto it{std::begin(numericalFieldIdentifiers)}; it != std::end(numericalFieldIdentifiers); it++) {
-                        if (it + 1 != std::end(numericalFieldIdentifiers)) {
-                            if (std::find(it + 1, std::end(numericalFieldIdentifiers), *it) != std::end(numericalFieldIdentifiers)) {
-                                duplicatedFieldIdentifier = *it;
-                            }
-                        }
-                    }
-                    retVal &= (-1 == duplicatedFieldIdentifier);
-                    if (!retVal) {
-                        std::cerr << "[cluon::MessageParser] Found duplicated numerical field identifier in message "
-                                  << "'" << ::stringtoolbox::trim(prefix) << "': " << duplicatedFieldIdentifier << '\n';
-                    }
-                }
-                // Try finding duplicated field names.
-                if (retVal) {
-                    std::sort(std::begin(fieldNames), std::end(fieldNames));
-                    std::string duplicatedFieldName;
-                    for (auto it{std::begin(fieldNames)}; it != std::end(fieldNames); it++) {
-                        if (it + 1 != std::end(fieldNames)) {
-                            if (std::find(it + 1, std::end(fieldNames), *it) != std::end(fieldNames)) {
-                                duplicatedFieldName = *it;
-                            }
-                        }
-                    }
-                    retVal &= (duplicatedFieldName.empty());
-                    if (!retVal) {
-                        std::cerr << "[cluon::MessageParser] Found duplicated field name in message '" << ::stringtoolbox::trim(prefix) << "': '"
-                                  << duplicatedFieldName << "'" << '\n';
-                    }
-                }
-            }
-            // Within AST node MESSAGE_DECLARATION, we have PRIMITIVE_FIELD from
-            // which we need to extract the field "token".
-            if (ast.name == "PRIMITIVE_FIELD") {
-                // Extract the value of entry "IDENTIFIER".
-                auto nodeIdentifier = std::find_if(std::begin(ast.nodes), std::end(ast.nodes), [](auto a) { return (a->name == "IDENTIFIER"); });
-                if (nodeIdentifier != std::end(ast.nodes)) {
-                    fieldNames.push_back((*nodeIdentifier)->token);
-                }
+    std::unique_ptr<cluon::UDPReceiver> m_receiver;
+    cluon::UDPSender m_sender;
 
-                // Visit this node's children to check for duplicated numerical identifiers.
-                for (const auto &node : ast.nodes) {
-                    retVal &= checkForUniqueFieldNames(*node, prefix, messageNames, fieldNames, numericalMessageIdentifiers, numericalFieldIdentifiers);
-                }
-            }
-            // Within AST node PRIMITIVE_FIELD, we have PRIMITIVE_FIELD_OPTIONS from
-            // which we need to extract the field "token".
-            if (ast.name == "PRIMITIVE_FIELD_OPTIONS") {
-                // Extract the value of entry "IDENTIFIER".
-                auto nodeNumericalFieldIdentifier
-                    = std::find_if(std::begin(ast.nodes), std::end(ast.nodes), [](auto a) { return (a->name == "NATURAL_NUMBER"); });
-                if (nodeNumericalFieldIdentifier != std::end(ast.nodes)) {
-                    numericalFieldIdentifiers.push_back(std::stoi((*nodeNumericalFieldIdentifier)->token));
-                }
-            }
+    std::atomic<bool> m_fragmentLargeEnvelopes{false};
+    std::atomic<uint32_t> m_nextFragmentedMessage{0};
 
-            return retVal;
-        };
+    std::function<void(cluon::data::Envelope &&envelope)> m_delegate{nullptr};
 
-    ////////////////////////////////////////////////////////////////////////////
+    // Serializes changes to the dispatch table; reading it does not lock.
+    std::mutex m_dispatchTableMutex{};
+    std::shared_ptr<const DispatchTable> m_dispatchTable{};
+    uint32_t m_nextSubscription{1};
+    std::unordered_map<int32_t, uint32_t, UseUInt32ValueAsHashKey> m_dataTriggerSubscriptions{};
+    std::shared_ptr<ExecutionLane> m_receivingLane{};
+    std::unordered_map<uint32_t, std::shared_ptr<ExecutionLane>> m_executionLanes{};
+
+    // Only used by the thread receiving the Envelopes.
+    FragmentAssembler m_fragmentAssembler{};
+
+    // Envelopes exchanged with microservices on the same host; nullptr if not used.
+    std::unique_ptr<SharedMemoryRing> m_sharedMemory{};
+    uint64_t m_sharedMemoryParticipant{0};
+    std::atomic<bool> m_sharedMemoryReaderRunning{false};
+    std::thread m_sharedMemoryReader{};
+    // Milliseconds of the monotonic clock when the last UDP packet from a microservice not using the shared memory arrived.
+    std::atomic<int64_t> m_lastOutsider{0};
+    // Serializes processing Envelopes from UDP and from the shared memory.
+    std::mutex m_processMutex{};
+};
 
-    // Function to transform AST into list of MetaMessages.
-    std::function<void(const peg::Ast &, std::vector<MetaMessage> &)> transform2MetaMessages
-        = [](const peg::Ast &ast, std::vector<MetaMessage> &listOfMetaMessages) {
-              // "Inner"-lambda to handle various types of message declarations.
-              auto createMetaMessage = [](const peg::Ast &_node, std::string _packageName) -> MetaMessage {
-                  MetaMessage mm;
-                  mm.packageName(::stringtoolbox::trim(_packageName));
-                  uint32_t fieldIdentifierCounter{0};
-                  for (const auto &e : _node.nodes) {
-                      if ("MESSAGE_IDENTIFIER" == e->name) {
-                          std::string _messageName = e->token;
-                          mm.messageName(::stringtoolbox::trim(_messageName));
-                      } else if ("NATURAL_NUMBER" == e->name) {
-                          mm.messageIdentifier(std::stoi(e->token));
-                      } else if ("PRIMITIVE_FIELD" == e->name) {
-                          std::string _fieldName;
-                          auto fieldName = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "IDENTIFIER"); });
-                          if (fieldName != std::end(e->nodes)) {
-                              _fieldName = (*fieldName)->token;
-                          }
+/**
+This class collects Envelopes to send them to an OD4Session at once: the
+messages are serialized without locking and the whole batch is sent with one
+system call where possible. Optionally, small Envelopes are coalesced into one
+UDP packet that starts with 0x0D 0xA6 followed by the serialized Envelopes;
+only OD4Sessions that know about coalesced packets can receive them while
+other receivers drop them.
 
-                          std::string _fieldDataType;
-                          auto fieldDataType = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "PRIMITIVE_TYPE"); });
-                          if (fieldDataType != std::end(e->nodes)) {
-                              _fieldDataType = (*fieldDataType)->token;
-                          }
+\code{.cpp}
+cluon::SendBatch batch{od4};
+batch.add(msgA);
+batch.add(msgB, cluon::time::now(), 1);
+batch.flush(); // Also called by the destructor.
+\endcode
+*/
+class LIBCLUON_API SendBatch {
+   private:
+    SendBatch(const SendBatch &) = delete;
+    SendBatch(SendBatch &&)      = delete;
+    SendBatch &operator=(const SendBatch &) = delete;
+    SendBatch &operator=(SendBatch &&) = delete;
 
-                          fieldIdentifierCounter++; // Automatically count expected field identifiers in case of missing
-                                                    // field options.
-                          std::string _fieldIdentifier;
-                          auto fieldIdentifier = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "NATURAL_NUMBER"); });
-                          if (fieldIdentifier != std::end(e->nodes)) {
-                              _fieldIdentifier = (*fieldIdentifier)->token;
-                          }
+   public:
+    enum : uint32_t {
+        HEADER_SIZE = 2,
+    };
 
-                          std::string _fieldDefaultInitializerValue;
-                          auto primitiveFieldOptions
-                              = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "PRIMITIVE_FIELD_OPTIONS"); });
-                          if (primitiveFieldOptions != std::end(e->nodes)) {
-                              for (const auto &f : (*primitiveFieldOptions)->nodes) {
-                                  if ("NATURAL_NUMBER" != f->name) {
-                                      if ("STRING" == f->name) {
-                                          _fieldDefaultInitializerValue = "\"" + f->token + "\""; // NOLINT
-                                      } else if ("CHARACTER" == f->name) {
-                                          _fieldDefaultInitializerValue = "'" + f->token + "'";
-                                      } else {
-                                          _fieldDefaultInitializerValue = f->token;
-                                      }
-                                  }
-                              }
-                          }
+    /**
+     * @return true if the given bytes start with the header of coalesced Envelopes.
+     */
+    static bool isCoalesced(const char *data, std::size_t size) noexcept;
 
-                          std::map<std::string, MetaMessage::MetaField::MetaFieldDataTypes> STRING_TO_DATATYPE_MAP = {
-                              {"bool", MetaMessage::MetaField::BOOL_T},
-                              {"char", MetaMessage::MetaField::CHAR_T},
-                              {"uint8", MetaMessage::MetaField::UINT8_T},
-                              {"int8", MetaMessage::MetaField::INT8_T},
-                              {"uint16", MetaMessage::MetaField::UINT16_T},
-                              {"int16", MetaMessage::MetaField::INT16_T},
-                              {"uint32", MetaMessage::MetaField::UINT32_T},
-                              {"int32", MetaMessage::MetaField::INT32_T},
-                              {"uint64", MetaMessage::MetaField::UINT64_T},
-                              {"int64", MetaMessage::MetaField::INT64_T},
-                              {"float", MetaMessage::MetaField::FLOAT_T},
-                              {"double", MetaMessage::MetaField::DOUBLE_T},
-                              {"string", MetaMessage::MetaField::STRING_T},
-                              {"bytes", MetaMessage::MetaField::BYTES_T},
-                          };
+   public:
+    /**
+     * Constructor.
+     *
+     * @param od4 OD4Session to send to.
+     * @param coalesce True to pack several Envelopes into one UDP packet.
+     */
+    SendBatch(OD4Session &od4, bool coalesce = false) noexcept;
 
-                          MetaMessage::MetaField mf;
-                          if (0 < STRING_TO_DATATYPE_MAP.count(_fieldDataType)) {
-                              mf.fieldDataType(STRING_TO_DATATYPE_MAP[_fieldDataType]);
-                          } else {
-                              mf.fieldDataType(MetaMessage::MetaField::MESSAGE_T);
-                          }
-                          mf.fieldDataTypeName(::stringtoolbox::trim(_fieldDataType));
-                          mf.fieldName(::stringtoolbox::trim(_fieldName));
-                          mf.fieldIdentifier(
-                              (!_fieldIdentifier.empty() ? static_cast<uint32_t>(std::stoi(::stringtoolbox::trim(_fieldIdentifier))) : fieldIdentifierCounter));
-                          mf.defaultInitializationValue(_fieldDefaultInitializerValue);
-                          mm.add(std::move(mf));
-                      }
-                  }
-                  return mm;
-              };
+    /**
+     * Destructor; sends the pending Envelopes.
+     */
+    ~SendBatch() noexcept;
 
-              ////////////////////////////////////////////////////////////////////////
+    /**
+     * This method adds a message to the batch.
+     *
+     * @param message Message to be sent.
+     * @param sampleTimeStamp Time point when this sample to be sent was captured (default = sent time point).
+     * @param senderStamp Optional sender stamp (default = 0).
+     */
+    template <typename T>
+    void add(T &message, const cluon::data::TimeStamp &sampleTimeStamp = cluon::data::TimeStamp(), uint32_t senderStamp = 0) noexcept {
+        try {
+            cluon::ToProtoVisitor protoEncoder;
 
-              // Case: "package XYZ" present.
-              if ("MESSAGES_SPECIFICATION" == ast.name) {
-                  // Extract the value of entry "PACKAGE_IDENTIFIER".
-                  auto nodeIdentifier = std::find_if(std::begin(ast.nodes), std::end(ast.nodes), [](auto a) { return (a->name == "PACKAGE_IDENTIFIER"); });
-                  std::string packageName;
-                  if (nodeIdentifier != std::end(ast.nodes)) {
-                      packageName = (*nodeIdentifier)->token;
-                  }
+            cluon::data::Envelope envelope;
+            {
+                envelope.dataType(static_cast<int32_t>(message.ID()));
+                message.accept(protoEncoder);
+                envelope.serializedData(protoEncoder.encodedData());
+                envelope.sent(cluon::time::now());
+                envelope.sampleTimeStamp((0 == (sampleTimeStamp.seconds() + sampleTimeStamp.microseconds())) ? envelope.sent() : sampleTimeStamp);
+                envelope.senderStamp(senderStamp);
+            }
 
-                  // Extract the value of entry "MESSAGE_DECLARATION".
-                  for (const auto &node : ast.nodes) {
-                      if (node->name == "MESSAGE_DECLARATION") {
-                          listOfMetaMessages.emplace_back(createMetaMessage(*node, packageName));
-                      }
-                  }
-              } else {
-                  // In case we only have one single message and no package.
-                  listOfMetaMessages.emplace_back(createMetaMessage(ast, ""));
-              }
-          };
+            add(std::move(envelope));
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
 
-    ////////////////////////////////////////////////////////////////////////////
+    /**
+     * This method adds an Envelope to the batch.
+     *
+     * @param envelope Envelope to be sent.
+     */
+    void add(cluon::data::Envelope &&envelope) noexcept;
 
-    peg::parser p(grammarMessageSpecificationLanguage);
-    p.enable_ast();
-    p.log = [](size_t row, size_t col, const std::string &msg) {
-        std::cerr << "[cluon::MessageParser] Parsing error:" << row << ":" << col << ": " << msg << '\n';
-    };
+    /**
+     * This method sends all pending Envelopes.
+     */
+    void flush() noexcept;
+
+    /**
+     * @return Number of pending Envelopes.
+     */
+    std::size_t size() const noexcept;
+
+   private:
+    OD4Session &m_od4;
+    const bool m_coalesce;
+    std::vector<std::string> m_serializedEnvelopes{};
+};
 
-    std::pair<std::vector<MetaMessage>, MessageParserErrorCodes> retVal{};
-    std::string inputWithoutComments{input};
-    try {
-        const std::string MATCH_COMMENTS_REGEX = R"(/\*([\s\S]*?)\*/|//.*)";
-        inputWithoutComments                   = std::regex_replace(input, std::regex(MATCH_COMMENTS_REGEX), ""); // NOLINT
-    } catch (std::regex_error &) {                                                                                // LCOV_EXCL_LINE
-    } catch (std::bad_cast &) {                                                                                   // LCOV_EXCL_LINE
-    }
-    try {
-        std::vector<MetaMessage> listOfMetaMessages{};
-        std::shared_ptr<peg::Ast> ast{};
-        if (p.parse(inputWithoutComments.c_str(), ast)) {
-            ast = peg::AstOptimizer(true).optimize(ast);
-            {
-                std::string tmpPrefix;
-                std::vector<std::string> tmpMessageNames{};
-                std::vector<std::string> tmpFieldNames{};
-                std::vector<int32_t> tmpNumericalMessageIdentifiers{};
-                std::vector<int32_t> tmpNumericalFieldIdentifiers{};
-                if (check4UniqueFieldNames(*ast, tmpPrefix, tmpMessageNames, tmpFieldNames, tmpNumericalMessageIdentifiers, tmpNumericalFieldIdentifiers)) {
-                    transform2MetaMessages(*ast, listOfMetaMessages);
-                    retVal = {listOfMetaMessages, MessageParserErrorCodes::NO_MESSAGEPARSER_ERROR};
-                } else {
-                    retVal = {listOfMetaMessages, MessageParserErrorCodes::DUPLICATE_IDENTIFIERS};
-                }
-            }
-        } else {
-            retVal = {listOfMetaMessages, MessageParserErrorCodes::SYNTAX_ERROR};
-        }
-    } catch (std::bad_cast &) { // LCOV_EXCL_LINE
-    }
-    return retVal;
-}
 } // namespace cluon
+#endif
 /*
- * Copyright (C) 2017-2018  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/TerminateHandler.hpp"
+#ifndef CLUON_COMPRESSEDREC_HPP
+#define CLUON_COMPRESSEDREC_HPP
 
-#include <cstdlib>
-#include <cstring>
-#include <iostream>
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace cluon {
+namespace lz4 {
+/**
+ * This function compresses the given bytes into the LZ4 block format
+ * (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ *
+ * @param src Bytes to compress.
+ * @param size Number of bytes to compress.
+ * @return Compressed bytes.
+ */
+std::string compress(const char *src, size_t size) noexcept;
 
-inline void cluon_handleExit() {
-    TerminateHandler::instance().isTerminated.store(true);
-}
+/**
+ * This function decompresses an LZ4 block.
+ *
+ * @param src Compressed bytes.
+ * @param size Number of compressed bytes.
+ * @param dst Buffer for the decompressed bytes.
+ * @param dstSize Expected number of decompressed bytes.
+ * @return true if exactly dstSize bytes could be decompressed from a valid block.
+ */
+bool decompress(const char *src, size_t size, char *dst, size_t dstSize) noexcept;
+} // namespace lz4
 
-inline void cluon_handleSignal(int32_t /*signal*/) {       // LCOV_EXCL_LINE
-    TerminateHandler::instance().isTerminated.store(true); // LCOV_EXCL_LINE
-}
+/**
+Compressed .rec files group serialized Envelopes into independently compressed
+blocks followed by an index to seek to any Envelope by decompressing only the
+block containing it. All numbers are little endian:
+
+    File header:  "CLUONBLK" uint32 version uint32 reserved
+    Block:        uint32 "CBLK" uint32 codec uint32 compressedSize uint32 uncompressedSize uint32 numberOfEnvelopes
+                  compressed bytes of concatenated serialized Envelopes
+    Index:        uint32 "CIDX" uint32 numberOfBlocks
+                  numberOfBlocks x (uint64 fileOffset uint32 compressedSize uint32 uncompressedSize uint32 codec uint32 numberOfEnvelopes)
+                  uint64 numberOfEnvelopes
+                  numberOfEnvelopes x (int64 sampleTimeStamp uint32 block uint32 offsetInBlock)
+    Footer:       uint64 fileOffsetOfIndex "CLUONEND"
+
+When the index is missing (for instance, if a recording was interrupted),
+readers recover it by scanning the blocks.
+*/
+class LIBCLUON_API CompressedRec {
+   public:
+    enum Codec : uint32_t {
+        STORED = 0,
+        LZ4    = 1,
+    };
 
-inline TerminateHandler::TerminateHandler() noexcept {
-    if (0 != std::atexit(cluon_handleExit)) {
-        std::cerr << "[cluon::TerminateHandler] Failed to register cluon_exitHandler()." << std::endl; // LCOV_EXCL_LINE
-    }
+    struct Block {
+        uint64_t m_fileOffset{0};
+        uint32_t m_compressedSize{0};
+        uint32_t m_uncompressedSize{0};
+        uint32_t m_codec{STORED};
+        uint32_t m_numberOfEnvelopes{0};
+    };
 
-#ifdef WIN32
-    if (SIG_ERR == ::signal(SIGINT, &cluon_handleSignal)) {
-        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGINT." << std::endl;
-    }
-    if (SIG_ERR == ::signal(SIGTERM, &cluon_handleSignal)) {
-        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGTERM." << std::endl;
-    }
-#else
-    std::memset(&m_signalHandler, 0, sizeof(m_signalHandler));
-    m_signalHandler.sa_handler = &cluon_handleSignal;
+    struct Entry {
+        int64_t m_sampleTimeStamp{0};
+        uint32_t m_block{0};
+        uint32_t m_offsetInBlock{0};
+    };
 
-    if (::sigaction(SIGINT, &m_signalHandler, NULL) < 0) {
-        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGINT." << std::endl; // LCOV_EXCL_LINE
-    }
-    if (::sigaction(SIGTERM, &m_signalHandler, NULL) < 0) {
-        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGTERM." << std::endl; // LCOV_EXCL_LINE
+    enum : uint32_t {
+        FILE_HEADER_SIZE  = 16,
+        BLOCK_HEADER_SIZE = 20,
+        FOOTER_SIZE       = 16,
+        VERSION           = 1,
+    };
+
+    /**
+     * @return true if the given stream starts with the header of a compressed .rec file; the stream position is preserved.
+     */
+    static bool isCompressedRec(std::istream &in) noexcept;
+
+    /**
+     * Entries in the index address Envelopes as (block << 32 | offsetInBlock).
+     */
+    static uint64_t position(uint32_t block, uint32_t offsetInBlock) noexcept {
+        return (static_cast<uint64_t>(block) << 32) | offsetInBlock;
     }
-#endif
-}
+};
+
+/**
+This class writes a compressed .rec file. Serialized Envelopes are collected
+until the block size is reached; then, the block is compressed and written.
+The index is appended by close().
+*/
+class LIBCLUON_API CompressedRecWriter {
+   private:
+    CompressedRecWriter(const CompressedRecWriter &) = delete;
+    CompressedRecWriter(CompressedRecWriter &&)      = delete;
+    CompressedRecWriter &operator=(const CompressedRecWriter &) = delete;
+    CompressedRecWriter &operator=(CompressedRecWriter &&) = delete;
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param file File to write.
+     * @param blockSize Number of uncompressed bytes per block.
+     */
+    CompressedRecWriter(const std::string &file, uint32_t blockSize = 1024 * 1024) noexcept;
+    ~CompressedRecWriter() noexcept;
+
+    /**
+     * @return true if the file could be opened.
+     */
+    bool isOpen() const noexcept;
+
+    /**
+     * This method appends a serialized Envelope.
+     *
+     * @param serializedEnvelope Envelope as returned from serializeEnvelope.
+     * @param size Length of the serialized Envelope.
+     * @param sampleTimeStamp Sample time stamp of the Envelope in microseconds.
+     */
+    void append(const char *serializedEnvelope, size_t size, int64_t sampleTimeStamp) noexcept;
+
+    /**
+     * This method writes the pending block and the index; afterwards, no more Envelopes can be appended.
+     */
+    void close() noexcept;
+
+    /**
+     * This method forces the written data to disk.
+     */
+    void sync() noexcept;
+
+    /**
+     * @return Number of uncompressed bytes appended so far.
+     */
+    uint64_t uncompressedBytes() const noexcept;
+
+    /**
+     * @return Number of bytes written to the file so far.
+     */
+    uint64_t compressedBytes() const noexcept;
+
+   private:
+    void writeBlock() noexcept;
+    void writeBytes(const char *data, size_t size) noexcept;
+
+   private:
+    const uint32_t m_blockSize;
+    int32_t m_fd{-1};
+    uint64_t m_fileOffset{0};
+    uint64_t m_uncompressedBytes{0};
+    std::string m_block{};
+    uint32_t m_envelopesInBlock{0};
+    std::vector<CompressedRec::Block> m_blocks{};
+    std::vector<CompressedRec::Entry> m_entries{};
+};
+
+/**
+This class reads Envelopes from a compressed .rec file. The block that follows
+the one currently read is decompressed concurrently so that sequential reading
+finds it ready.
+*/
+class LIBCLUON_API CompressedRecReader {
+   private:
+    CompressedRecReader(const CompressedRecReader &) = delete;
+    CompressedRecReader(CompressedRecReader &&)      = delete;
+    CompressedRecReader &operator=(const CompressedRecReader &) = delete;
+    CompressedRecReader &operator=(CompressedRecReader &&) = delete;
+
+   public:
+    CompressedRecReader() = default;
+    ~CompressedRecReader() noexcept;
+
+    /**
+     * This method reads the index from the given file or reconstructs it by scanning the blocks.
+     *
+     * @param in Opened compressed .rec file.
+     * @return Index entries in file order.
+     */
+    std::vector<CompressedRec::Entry> readIndex(std::istream &in) noexcept;
+
+    /**
+     * This method reads the Envelope at the given position.
+     *
+     * @param in Opened compressed .rec file.
+     * @param position Position as returned by CompressedRec::position.
+     * @return Pair of success and Envelope.
+     */
+    std::pair<bool, cluon::data::Envelope> readEnvelope(std::istream &in, uint64_t position) noexcept;
+
+    /**
+     * @return Number of blocks in the file.
+     */
+    uint32_t numberOfBlocks() const noexcept;
+
+   private:
+    std::string readCompressedBlock(std::istream &in, uint32_t block) noexcept;
+    std::string decompressBlock(uint32_t block, std::string &&compressed) const noexcept;
+    static std::pair<bool, cluon::data::Envelope> decodeEnvelope(const std::string &block, uint32_t offset, uint32_t &length) noexcept;
+
+   private:
+    std::vector<CompressedRec::Block> m_blocks{};
+
+    uint32_t m_currentBlockNumber{0xFFFFFFFF};
+    std::string m_currentBlock{};
+
+    uint32_t m_nextBlockNumber{0xFFFFFFFF};
+    std::future<std::string> m_nextBlock{};
+};
 
 } // namespace cluon
+
+#endif
 /*
- * Copyright (C) 2019  Christian Berger
+ * Copyright (C) 2017-2018  Christian Berger
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/IPv4Tools.hpp"
+#ifndef CLUON_PLAYER_HPP
+#define CLUON_PLAYER_HPP
 
-// clang-format off
-#ifdef WIN32
-    #include <Winsock2.h> // for WSAStartUp
-    #include <ws2tcpip.h>
-    #include <iostream>
-#else
-    #include <arpa/inet.h>
-    #include <netdb.h>
-
-    #if defined(BSD)
-        #include <netinet/in.h>
-        #include <sys/socket.h>
-    #endif
-#endif
-// clang-format on
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
 
-#include <cstring>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
 
 namespace cluon {
 
-inline std::string getIPv4FromHostname(const std::string &hostname) noexcept {
-#ifdef WIN32
-    // Load Winsock 2.2 DLL.
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-        std::cerr << "[cluon::getIPv4FromHostname] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
-    }
-#endif
-    std::string result{""};
-    if (!hostname.empty()) {
-        struct addrinfo hint;
-        {
-            std::memset(&hint, 1, sizeof(struct addrinfo));
-            hint.ai_flags = AI_CANONNAME;
-            hint.ai_family = AF_INET;
-            hint.ai_socktype = 0;
-            hint.ai_protocol = 0;
-            hint.ai_addrlen = 0;
-            hint.ai_canonname = nullptr;
-            hint.ai_addr = nullptr;
-            hint.ai_next = nullptr;
-        }
+class LIBCLUON_API IndexEntry {
+   public:
+    IndexEntry() = default;
+    IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition) noexcept;
 
-        struct addrinfo *listOfHosts{nullptr};
-        if (0 == getaddrinfo(hostname.c_str(), nullptr, &hint, &listOfHosts)) {
-            for(struct addrinfo *e = listOfHosts; nullptr != listOfHosts; listOfHosts = listOfHosts->ai_next) {
-                if (nullptr != e) {
-                    if (AF_INET == e->ai_family) {
-                        struct sockaddr_in *sinp = reinterpret_cast<struct sockaddr_in*>(e->ai_addr);
-                        char buf[INET_ADDRSTRLEN];
-                        const char *addr = inet_ntop(AF_INET, &sinp->sin_addr, buf, INET_ADDRSTRLEN);
-                        if ( (nullptr != addr) && (result.empty()) ) {
-                            result = std::string(addr);
-                            break;
-                        }
-                    }
-                }
-            }
-        }
+   public:
+    int64_t m_sampleTimeStamp{0};
+    uint64_t m_filePosition{0};
+    bool m_available{0};
+};
 
-        if (nullptr != listOfHosts) {
-            freeaddrinfo(listOfHosts);
-        }
-    }
-#ifdef WIN32
-    WSACleanup();
-#endif
-    return result;
-}
+class LIBCLUON_API Player {
+   private:
+    enum {
+        ONE_MILLISECOND_IN_MICROSECONDS = 1000,
+        ONE_SECOND_IN_MICROSECONDS      = 1000 * ONE_MILLISECOND_IN_MICROSECONDS,
+        MAX_DELAY_IN_MICROSECONDS       = 1 * ONE_SECOND_IN_MICROSECONDS,
+        LOOK_AHEAD_IN_S                 = 30,
+        MIN_ENTRIES_FOR_LOOK_AHEAD      = 5000,
+    };
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+   private:
+    Player(const Player &) = delete;
+    Player(Player &&)      = delete;
+    Player &operator=(Player &&) = delete;
+    Player &operator=(const Player &other) = delete;
 
-//#include "cluon/UDPSender.hpp"
-//#include "cluon/IPv4Tools.hpp"
-//#include "cluon/UDPPacketSizeConstraints.hpp"
+   public:
+    /**
+     * Constructor.
+     *
+     * @param file File to play.
+     * @param autoRewind True if the file should be rewind at EOF.
+     * @param threading If set to true, player will load new envelopes from the files in background.
+     */
+    Player(const std::string &file, const bool &autoRewind, const bool &threading) noexcept;
+    ~Player();
 
-// clang-format off
-#ifdef WIN32
-    #include <iostream>
-#else
-    #include <arpa/inet.h>
-    #include <sys/socket.h>
-    #include <sys/types.h>
-    #include <unistd.h>
-#endif
-// clang-format on
+    /**
+     * @return Pair of bool and next cluon::data::Envelope to be replayed;
+     *         if bool is false, no next Envelope is available.
+     */
+    std::pair<bool, cluon::data::Envelope> getNextEnvelopeToBeReplayed() noexcept;
 
-#include <cerrno>
-#include <cstring>
-#include <algorithm>
-#include <iterator>
-#include <sstream>
-#include <vector>
+    /**
+     * @return real delay in microseconds to be waited before the next cluon::data::Envelope should be delivered.
+     */
+    uint32_t delay() const noexcept;
 
-namespace cluon {
+    /**
+     * @return true if there is more data to replay.
+     */
+    bool hasMoreData() const noexcept;
 
-inline UDPSender::UDPSender(const std::string &sendToAddress, uint16_t sendToPort) noexcept
-    : m_socketMutex()
-    , m_sendToAddress() {
-    // Decompose given address into tokens to check validity with numerical IPv4 address.
-    std::string tmp{cluon::getIPv4FromHostname(sendToAddress)};
-    std::replace(tmp.begin(), tmp.end(), '.', ' ');
-    std::istringstream sstr{tmp};
-    std::vector<int> sendToAddressTokens{std::istream_iterator<int>(sstr), std::istream_iterator<int>()};
+    /**
+     * This method rewinds the iterators.
+     */
+    void rewind() noexcept;
 
-    if (!sendToAddress.empty() && (4 == sendToAddressTokens.size())
-        && !(std::end(sendToAddressTokens) != std::find_if(sendToAddressTokens.begin(), sendToAddressTokens.end(), [](int a) { return (a < 0) || (a > 255); }))
-        && (0 < sendToPort)) {
-        ::memset(&m_sendToAddress, 0, sizeof(m_sendToAddress));
-        m_sendToAddress.sin_addr.s_addr = ::inet_addr(sendToAddress.c_str());
-        m_sendToAddress.sin_family      = AF_INET;
-        m_sendToAddress.sin_port        = htons(sendToPort);
+    void seekTo(float ratio) noexcept;
 
-#ifdef WIN32
-        // Load Winsock 2.2 DLL.
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-            std::cerr << "[cluon::UDPSender] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
-        }
-#endif
+    /**
+     * @return total amount of cluon::data::Envelopes in the .rec file.
+     */
+    uint32_t totalNumberOfEnvelopesInRecFile() const noexcept;
 
-        m_socket = ::socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+   private:
+    // Internal methods without Lock.
+    bool hasMoreDataFromRecFile() const noexcept;
 
-        // Bind to random address/port but store sender port.
-        if (!(m_socket < 0)) {
-            struct sockaddr_in sendFromAddress;
-            std::memset(&sendFromAddress, 0, sizeof(sendFromAddress));
-            sendFromAddress.sin_family = AF_INET;
-            sendFromAddress.sin_port   = 0;                                                                              // Randomly choose a port to bind.
-            if (0 == ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&sendFromAddress), sizeof(sendFromAddress))) { // NOLINT
-                struct sockaddr tmpAddr;
-                socklen_t length = sizeof(tmpAddr);
-                if (0 == ::getsockname(m_socket, &tmpAddr, &length)) {
-                    struct sockaddr_in tmpAddrIn;
-                    std::memcpy(&tmpAddrIn, &tmpAddr, sizeof(tmpAddrIn)); /* Flawfinder: ignore */ // NOLINT
-                    m_portToSentFrom = ntohs(tmpAddrIn.sin_port);
-                }
-            }
-        }
+    /**
+     * This method initializes the global index where the sample
+     * time stamps are sorted chronocally and mapped to the
+     * corresponding cluon::data::Envelope in the rec file.
+     */
+    void initializeIndex() noexcept;
 
-#ifdef WIN32
-        if (m_socket < 0) {
-            std::cerr << "[cluon::UDPSender] Error while creating socket: " << WSAGetLastError() << std::endl;
-            WSACleanup();
-        }
-#endif
-    }
-}
+    /**
+     * This method computes the initially required amount of
+     * cluon::data::Envelope in the cache and fill the cache accordingly.
+     */
+    void computeInitialCacheLevelAndFillCache() noexcept;
 
-inline UDPSender::~UDPSender() noexcept {
-    if (!(m_socket < 0)) {
-#ifdef WIN32
-        ::shutdown(m_socket, SD_BOTH);
-        ::closesocket(m_socket);
-        WSACleanup();
-#else
-        ::shutdown(m_socket, SHUT_RDWR); // Disallow further read/write operations.
-        ::close(m_socket);
-#endif
-    }
-    m_socket = -1;
-}
+    /**
+     * This method clears all caches.
+     */
+    void resetCaches() noexcept;
 
-inline uint16_t UDPSender::getSendFromPort() const noexcept {
-    return m_portToSentFrom;
-}
+    /**
+     * This method resets the iterators.
+     */
+    inline void resetIterators() noexcept;
 
-inline std::pair<ssize_t, int32_t> UDPSender::send(std::string &&data) const noexcept {
-    if (-1 == m_socket) {
-        return {-1, EBADF};
-    }
+    /**
+     * This method fills the cache by trying to read up
+     * to maxNumberOfEntriesToReadFromFile from the rec file.
+     *
+     * @param maxNumberOfEntriesToReadFromFile Maximum number of entries to be read from file.
+     * @return Number of entries read from file.
+     */
+    uint32_t fillEnvelopeCache(const uint32_t &maxNumberOfEntriesToReadFromFile) noexcept;
 
-    if (data.empty()) {
-        return {0, 0};
-    }
+    /**
+     * This method reads the cluon::data::Envelope at the given position
+     * from the plain or compressed .rec file.
+     *
+     * @param filePosition Position from the index.
+     * @return Pair of success and cluon::data::Envelope.
+     */
+    std::pair<bool, cluon::data::Envelope> readEnvelopeFromRecFile(const uint64_t &filePosition) noexcept;
 
-    constexpr uint16_t MAX_LENGTH = static_cast<uint16_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
-                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
-                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER);
-    if (MAX_LENGTH < data.size()) {
-        return {-1, E2BIG};
-    }
+    /**
+     * This method checks the availability of the next cluon::data::Envelope
+     * to be replayed from the cache.
+     */
+    inline void checkAvailabilityOfNextEnvelopeToBeReplayed() noexcept;
 
-    std::lock_guard<std::mutex> lck(m_socketMutex);
-    ssize_t bytesSent = ::sendto(m_socket,
-                                 data.c_str(),
-                                 data.length(),
-                                 0,
-                                 reinterpret_cast<const struct sockaddr *>(&m_sendToAddress), // NOLINT
-                                 sizeof(m_sendToAddress));
+   private: // Data for the Player.
+    bool m_threading;
+
+    std::string m_file;
+
+    // Handle to .rec file.
+    std::fstream m_recFile;
+    bool m_recFileValid;
+
+    // Only set for compressed .rec files; positions in the index refer to blocks then.
+    std::unique_ptr<CompressedRecReader> m_compressedRecReader;
+
+   private: // Player states.
+    bool m_autoRewind;
+
+   private: // Index and cache management.
+    // Global index: Mapping SampleTimeStamp --> cache entry (holding the actual content from .rec file).
+    mutable std::mutex m_indexMutex;
+    std::multimap<int64_t, IndexEntry> m_index;
+
+    // Pointers to the current envelope to be replayed and the
+    // envelope that has be replayed from the global index.
+    std::multimap<int64_t, IndexEntry>::iterator m_previousPreviousEnvelopeAlreadyReplayed;
+    std::multimap<int64_t, IndexEntry>::iterator m_previousEnvelopeAlreadyReplayed;
+    std::multimap<int64_t, IndexEntry>::iterator m_currentEnvelopeToReplay;
+
+    // Information about the index.
+    std::multimap<int64_t, IndexEntry>::iterator m_nextEntryToReadFromRecFile;
+
+    uint32_t m_desiredInitialLevel;
+
+    // Fields to compute replay throughput for cache management.
+    cluon::data::TimeStamp m_firstTimePointReturningAEnvelope;
+    uint64_t m_numberOfReturnedEnvelopesInTotal;
+
+    uint32_t m_delay;
+
+   private:
+    /**
+     * This method sets the state of the envelopeCacheFilling thread.
+     *
+     * @param running False if the thread to fill the Envelope cache shall be joined.
+     */
+    void setEnvelopeCacheFillingRunning(const bool &running) noexcept;
+    bool isEnvelopeCacheFillingRunning() const noexcept;
+
+    /**
+     * This method manages the cache.
+     */
+    void manageCache() noexcept;
+
+    /**
+     * This method checks whether the cache needs to be refilled.
+     *
+     * @param numberOfEntries Number of entries in cache.
+     * @param refillMultiplicator Multiplicator to modify the amount of envelopes to be refilled.
+     * @return Modified refillMultiplicator recommedned to be used next time
+     */
+    float checkRefillingCache(const uint32_t &numberOfEntries, float refillMultiplicator) noexcept;
+
+   private:
+    mutable std::mutex m_envelopeCacheFillingThreadIsRunningMutex;
+    bool m_envelopeCacheFillingThreadIsRunning;
+    std::thread m_envelopeCacheFillingThread;
+
+    // Mapping of pos_type (within .rec file) --> cluon::data::Envelope (read from .rec file).
+    std::map<uint64_t, cluon::data::Envelope> m_envelopeCache;
+
+   public:
+    void setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept;
+
+   private:
+    std::mutex m_playerListenerMutex;
+    std::function<void(cluon::data::PlayerStatus playerStatus)> m_playerListener{nullptr};
+};
 
-    return {bytesSent, (0 > bytesSent ? errno : 0)};
-}
 } // namespace cluon
+
+#endif
 /*
  * Copyright (C) 2017-2018  Christian Berger
  *
@@ -10159,695 +10514,667 @@ inline std::pair<ssize_t, int32_t> UDPSender::send(std::string &&data) const noe
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/UDPReceiver.hpp"
-//#include "cluon/IPv4Tools.hpp"
-//#include "cluon/TerminateHandler.hpp"
-//#include "cluon/UDPPacketSizeConstraints.hpp"
+#ifndef CLUON_SHAREDMEMORY_HPP
+#define CLUON_SHAREDMEMORY_HPP
+
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
 
 // clang-format off
 #ifdef WIN32
-    #include <cstdio>
-    #include <cerrno>
-
-    #include <winsock2.h>
-    #include <iphlpapi.h>
-    #include <ws2tcpip.h>
-
-    #include <iostream>
+    #include <Windows.h>
 #else
-    #ifdef __linux__
-        #include <linux/sockios.h>
-    #endif
-
-    #include <arpa/inet.h>
-    #include <sys/ioctl.h>
-    #include <sys/socket.h>
-    #include <sys/types.h>
-    #include <fcntl.h>
-    #include <unistd.h>
-#endif
-
-#ifndef WIN32
-    #include <ifaddrs.h>
-    #include <netdb.h>
+    #include <pthread.h>
+    #include <sys/ipc.h>
 #endif
 // clang-format on
 
-#include <cstring>
-#include <algorithm>
-#include <array>
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <string>
 #include <utility>
-#include <vector>
 
 namespace cluon {
 
-inline UDPReceiver::UDPReceiver(const std::string &receiveFromAddress,
-                         uint16_t receiveFromPort,
-                         std::function<void(std::string &&, std::string &&, std::chrono::system_clock::time_point &&)> delegate,
-                         uint16_t localSendFromPort) noexcept
-    : m_localSendFromPort(localSendFromPort)
-    , m_receiveFromAddress()
-    , m_mreq()
-    , m_readFromSocketThread()
-    , m_delegate(std::move(delegate)) {
-    // Decompose given address string to check validity with numerical IPv4 address.
-    std::string tmp{cluon::getIPv4FromHostname(receiveFromAddress)};
-    std::replace(tmp.begin(), tmp.end(), '.', ' ');
-    std::istringstream sstr{tmp};
-    std::vector<int> receiveFromAddressTokens{std::istream_iterator<int>(sstr), std::istream_iterator<int>()};
+class LIBCLUON_API SharedMemory {
+   private:
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory(SharedMemory &&)      = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+    SharedMemory &operator=(SharedMemory &&) = delete;
 
-    if ((!receiveFromAddress.empty()) && (4 == receiveFromAddressTokens.size())
-        && !(std::end(receiveFromAddressTokens)
-             != std::find_if(receiveFromAddressTokens.begin(), receiveFromAddressTokens.end(), [](int a) { return (a < 0) || (a > 255); }))
-        && (0 < receiveFromPort)) {
-        // Check for valid IP address.
-        struct sockaddr_in tmpSocketAddress {};
-        const bool isValid = (0 < ::inet_pton(AF_INET, receiveFromAddress.c_str(), &(tmpSocketAddress.sin_addr))) && (224 > receiveFromAddressTokens[0]);
+   public:
+    /**
+     * Constructor.
+     *
+     * @param name Name of the shared memory area; must start with / and must not
+     * be longer than NAME_MAX (255) on POSIX or PATH_MAX on WIN32. If the name
+     * is missing a leading '/' or is longer than 255, it will be adjusted accordingly.
+     * @param size of the shared memory area to create; if size is 0, the class tries to attach to an existing area.
+     */
+    SharedMemory(const std::string &name, uint32_t size = 0) noexcept;
+    ~SharedMemory() noexcept;
 
-        // Check for UDP multicast, i.e., IP address range [225.0.0.1 - 239.255.255.255].
-        m_isMulticast = (((224 < receiveFromAddressTokens[0]) && (receiveFromAddressTokens[0] <= 239))
-                         && ((0 <= receiveFromAddressTokens[1]) && (receiveFromAddressTokens[1] <= 255))
-                         && ((0 <= receiveFromAddressTokens[2]) && (receiveFromAddressTokens[2] <= 255))
-                         && ((1 <= receiveFromAddressTokens[3]) && (receiveFromAddressTokens[3] <= 255)));
+    /**
+     * @return true when this shared memory area is locked.
+     */
+    bool isLocked() const noexcept;
 
-        std::memset(&m_receiveFromAddress, 0, sizeof(m_receiveFromAddress));
-#ifdef WIN32
-        // According to http://www.sockets.com/err_lst1.htm, the binding is
-        // different on Windows opposed to POSIX when using the real address
-        // here; thus, we need to use INADDR_ANY.
-        m_receiveFromAddress.sin_addr.s_addr = (m_isMulticast ? htonl(INADDR_ANY) : ::inet_addr(receiveFromAddress.c_str()));
-#else
-        m_receiveFromAddress.sin_addr.s_addr = ::inet_addr(receiveFromAddress.c_str());
-#endif
-        m_receiveFromAddress.sin_family = AF_INET;
-        m_receiveFromAddress.sin_port   = htons(receiveFromPort);
+    /**
+     * This method locks the shared memory area.
+     */
+    void lock() noexcept;
 
-#ifdef WIN32
-        // Load Winsock 2.2 DLL.
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-            std::cerr << "[cluon::UDPReceiver] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
-        }
-#endif
+    /**
+     * This method unlocks the shared memory area.
+     */
+    void unlock() noexcept;
 
-        m_socket = ::socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    /**
+     * This method locks the shared memory area for reading; readers do not
+     * block each other but block and are blocked by lock(). Only the
+     * futex-based implementation distinguishes readers; the others lock().
+     * With several slots, readers do not block lock() at all: they pin the
+     * slot published last and data() points to it.
+     */
+    void lockShared() noexcept;
 
-#ifdef WIN32
-        if (m_socket < 0) {
-            std::cerr << "[cluon::UDPReceiver] Error while creating socket: " << WSAGetLastError() << std::endl;
-            WSACleanup();
-        }
-#endif
+    /**
+     * This method unlocks the shared memory area locked by lockShared().
+     *
+     * @return false if the slot was overwritten while being read and the copy is inconsistent.
+     */
+    bool unlockShared() noexcept;
 
-        if (!(m_socket < 0)) {
-            // Allow reusing of ports by multiple calls with same address/port.
-            uint32_t YES = 1;
-            // clang-format off
-            auto retVal = ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&YES), sizeof(YES)); // NOLINT
-            // clang-format on
-            if (0 > retVal) {
-#ifdef WIN32 // LCOV_EXCL_LINE
-                auto errorCode = WSAGetLastError();
-#else
-                auto errorCode = errno; // LCOV_EXCL_LINE
-#endif                                  // LCOV_EXCL_LINE
-                closeSocket(errorCode); // LCOV_EXCL_LINE
-            }
-        }
+    /**
+     * This method waits for being notified from the shared condition. The
+     * futex-based implementation returns immediately if a notification was
+     * sent since the previous call returned so that none is missed.
+     */
+    void wait() noexcept;
 
-        if (!(m_socket < 0)) {
-            // Trying to enable non_blocking mode.
-#ifdef WIN32 // LCOV_EXCL_LINE
-            u_long nonBlocking = 1;
-            m_isBlockingSocket = !(NO_ERROR == ::ioctlsocket(m_socket, FIONBIO, &nonBlocking));
-#else
-            const int FLAGS    = ::fcntl(m_socket, F_GETFL, 0);
-            m_isBlockingSocket = !(0 == ::fcntl(m_socket, F_SETFL, FLAGS | O_NONBLOCK));
-#endif
-        }
-
-        if (!(m_socket < 0)) {
-            // Trying to enable non_blocking mode.
-#ifdef WIN32 // LCOV_EXCL_LINE
-            u_long nonBlocking = 1;
-            m_isBlockingSocket = !(NO_ERROR == ::ioctlsocket(m_socket, FIONBIO, &nonBlocking));
-#else
-            const int FLAGS    = ::fcntl(m_socket, F_GETFL, 0);
-            m_isBlockingSocket = !(0 == ::fcntl(m_socket, F_SETFL, FLAGS | O_NONBLOCK));
-#endif
-        }
-
-        if (!(m_socket < 0)) {
-            // Try setting receiving buffer.
-            int recvBuffer{26214400};
-            auto retVal = ::setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<char *>(&recvBuffer), sizeof(recvBuffer));
-            if (retVal < 0) {
-#ifdef WIN32 // LCOV_EXCL_LINE
-                auto errorCode = WSAGetLastError();
-#else
-                auto errorCode = errno; // LCOV_EXCL_LINE
-#endif                                                                                                                                       // LCOV_EXCL_LINE
-                std::cerr << "[cluon::UDPReceiver] Error while trying to set SO_RCVBUF to " << recvBuffer << ": " << errorCode << std::endl; // LCOV_EXCL_LINE
-            }
-        }
+    /**
+     * This method notifies all threads waiting on the shared condition.
+     */
+    void notifyAll() noexcept;
 
-        if (!(m_socket < 0)) {
-            // Bind to receive address/port.
-            // clang-format off
-            auto retVal = ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&m_receiveFromAddress), sizeof(m_receiveFromAddress)); // NOLINT
-            // clang-format on
-            if (0 > retVal) {
-#ifdef WIN32 // LCOV_EXCL_LINE
-                auto errorCode = WSAGetLastError();
-#else
-                auto errorCode = errno; // LCOV_EXCL_LINE
-#endif                                  // LCOV_EXCL_LINE
-                closeSocket(errorCode); // LCOV_EXCL_LINE
-            }
-        }
+    /**
+     * @return Number of notifications sent so far, read atomically; only
+     *         counted by the futex-based implementation, 0 otherwise.
+     */
+    uint32_t generation() noexcept;
 
-        if (!(m_socket < 0)) {
-            if (m_isMulticast) {
-                // Join the multicast group.
-                m_mreq.imr_multiaddr.s_addr = ::inet_addr(receiveFromAddress.c_str());
-                m_mreq.imr_interface.s_addr = htonl(INADDR_ANY);
-                // clang-format off
-                auto retval                 = ::setsockopt(m_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<char *>(&m_mreq), sizeof(m_mreq)); // NOLINT
-                // clang-format on
-                if (0 > retval) { // LCOV_EXCL_LINE
-#ifdef WIN32                      // LCOV_EXCL_LINE
-                    closeSocket(WSAGetLastError());
-#else
-                    closeSocket(errno); // LCOV_EXCL_LINE
-#endif // LCOV_EXCL_LINE
-                }
-            } else if (!isValid) {
-                closeSocket(EBADF);
-            }
-        }
+    /**
+     * The futex-based implementation can keep several slots of size() bytes
+     * each when the creating process sets CLUON_SHAREDMEMORY_SLOTS=N: lock()
+     * provides a slot that no reader has pinned, which the producer must fill
+     * completely, and unlock() publishes it. Thus, the producer always gets a
+     * slot and readers copy in parallel.
+     *
+     * @return Number of slots; 1 unless several slots are used.
+     */
+    uint32_t slots() noexcept;
 
-        // Fill list of local IP address to avoid sending data to ourselves.
-        if (!(m_socket < 0)) {
-#ifdef WIN32
-            DWORD size{0};
-            if (ERROR_BUFFER_OVERFLOW == GetAdaptersAddresses(AF_UNSPEC, GAA_FLAG_INCLUDE_PREFIX, NULL, NULL, &size)) {
-                PIP_ADAPTER_ADDRESSES adapters = reinterpret_cast<PIP_ADAPTER_ADDRESSES>(malloc(size));
-                if (ERROR_SUCCESS == GetAdaptersAddresses(AF_UNSPEC, GAA_FLAG_INCLUDE_PREFIX, NULL, adapters, &size)) {
-                    for (PIP_ADAPTER_ADDRESSES adapter = adapters; nullptr != adapter; adapter = adapter->Next) {
-                        for (PIP_ADAPTER_UNICAST_ADDRESS unicastAddress = adapter->FirstUnicastAddress; unicastAddress != NULL;
-                             unicastAddress                             = unicastAddress->Next) {
-                            if (AF_INET == unicastAddress->Address.lpSockaddr->sa_family) {
-                                ::getnameinfo(unicastAddress->Address.lpSockaddr, unicastAddress->Address.iSockaddrLength, nullptr, 0, NULL, 0, NI_NUMERICHOST);
-                                std::memcpy(&tmpSocketAddress, unicastAddress->Address.lpSockaddr, sizeof(tmpSocketAddress)); /* Flawfinder: ignore */ // NOLINT
-                                const unsigned long LOCAL_IP = tmpSocketAddress.sin_addr.s_addr;
-                                m_listOfLocalIPAddresses.insert(LOCAL_IP);
-                            }
-                        }
-                    }
-                }
-                free(adapters);
-            }
-#else
-            struct ifaddrs *interfaceAddress;
-            if (0 == ::getifaddrs(&interfaceAddress)) {
-                for (struct ifaddrs *it = interfaceAddress; nullptr != it; it = it->ifa_next) {
-                    if ((nullptr != it->ifa_addr) && (it->ifa_addr->sa_family == AF_INET)) {
-                        if (0 == ::getnameinfo(it->ifa_addr, sizeof(struct sockaddr_in), nullptr, 0, nullptr, 0, NI_NUMERICHOST)) {
-                            std::memcpy(&tmpSocketAddress, it->ifa_addr, sizeof(tmpSocketAddress)); /* Flawfinder: ignore */ // NOLINT
-                            const unsigned long LOCAL_IP = tmpSocketAddress.sin_addr.s_addr;
-                            m_listOfLocalIPAddresses.insert(LOCAL_IP);
-                        }
-                    }
-                }
-                ::freeifaddrs(interfaceAddress);
-            }
-#endif
-        }
+    /**
+     * @return Number of times the producer had to take a slot pinned by a reader as all slots were pinned.
+     */
+    uint64_t slotReuses() noexcept;
 
-        if (!(m_socket < 0)) {
-            // Constructing the receiving thread could fail.
-            try {
-                m_readFromSocketThread = std::thread(&UDPReceiver::readFromSocket, this);
+    /**
+     * @return Number of times unlockShared() of this instance found its slot overwritten.
+     */
+    uint64_t overruns() const noexcept;
 
-                // Let the operating system spawn the thread.
-                using namespace std::literals::chrono_literals; // NOLINT
-                do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
-            } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
+    /**
+     * This method sets the time stamp that can be used to
+     * express the sample time stamp of the data in residing
+     * in the shared memory.
+     *
+     * This method is only allowed when the shared memory is locked.
+     *
+     * @param ts TimeStamp.
+     * @return true if the timestamp could set; false if the shared memory was not locked.
+     */
+    bool setTimeStamp(const cluon::data::TimeStamp &ts) noexcept;
 
-            try {
-                m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>(
-                    [this](PipelineEntry &&entry) { this->m_delegate(std::move(entry.m_data), std::move(entry.m_from), std::move(entry.m_sampleTime)); });
-                if (m_pipeline) {
-                    // Let the operating system spawn the thread.
-                    using namespace std::literals::chrono_literals; // NOLINT
-                    do { std::this_thread::sleep_for(1ms); } while (!m_pipeline->isRunning());
-                }
-            } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
-        }
-    }
-}
+    /**
+     * This method returns the sample time stamp.
+     *
+     * This method is only allowed when the shared memory is locked.
+     *
+     * @return (true, sample time stamp) or (false, 0) in case if the shared memory was not locked.
+     */
+    std::pair<bool, cluon::data::TimeStamp> getTimeStamp() noexcept;
 
-inline UDPReceiver::~UDPReceiver() noexcept {
-    {
-        m_readFromSocketThreadRunning.store(false);
+   public:
+    /**
+     * @return True if the shared memory area is existing and usable.
+     */
+    bool valid() noexcept;
 
-        // Joining the thread could fail.
-        try {
-            if (m_readFromSocketThread.joinable()) {
-                m_readFromSocketThread.join();
-            }
-        } catch (...) {} // LCOV_EXCL_LINE
-    }
+    /**
+     * @return Pointer to the raw shared memory or nullptr in case of invalid shared memory.
+     */
+    char *data() noexcept;
 
-    m_pipeline.reset();
+    /**
+     * @return The size of the shared memory area.
+     */
+    uint32_t size() const noexcept;
 
-    closeSocket(0);
-}
+    /**
+     * @return Name the shared memory area.
+     */
+    const std::string name() const noexcept;
 
-inline void UDPReceiver::closeSocket(int errorCode) noexcept {
-    if (0 != errorCode) {
-        std::cerr << "[cluon::UDPReceiver] Failed to perform socket operation: ";
 #ifdef WIN32
-        std::cerr << errorCode << std::endl;
+   private:
+    void initWIN32() noexcept;
+    void deinitWIN32() noexcept;
+    void lockWIN32() noexcept;
+    void unlockWIN32() noexcept;
+    void waitWIN32() noexcept;
+    void notifyAllWIN32() noexcept;
 #else
-        std::cerr << ::strerror(errorCode) << " (" << errorCode << ")" << std::endl;
-#endif
-    }
+   private:
+    void initPOSIX() noexcept;
+    void deinitPOSIX() noexcept;
+    void lockPOSIX() noexcept;
+    void unlockPOSIX() noexcept;
+    void waitPOSIX() noexcept;
+    void notifyAllPOSIX() noexcept;
+    bool validPOSIX() noexcept;
 
-    if (!(m_socket < 0)) {
-        if (m_isMulticast) {
-            // clang-format off
-            auto retVal = ::setsockopt(m_socket, IPPROTO_IP, IP_DROP_MEMBERSHIP, reinterpret_cast<char *>(&m_mreq), sizeof(m_mreq)); // NOLINT
-            // clang-format on
-            if (0 > retVal) {                                                                         // LCOV_EXCL_LINE
-                std::cerr << "[cluon::UDPReceiver] Failed to drop multicast membership" << std::endl; // LCOV_EXCL_LINE
-            }
-        }
+    void initSysV() noexcept;
+    void deinitSysV() noexcept;
+    void lockSysV() noexcept;
+    void unlockSysV() noexcept;
+    void waitSysV() noexcept;
+    void notifyAllSysV() noexcept;
+    bool validSysV() noexcept;
 
-#ifdef WIN32
-        ::shutdown(m_socket, SD_BOTH);
-        ::closesocket(m_socket);
-        WSACleanup();
-#else
-        ::shutdown(m_socket, SHUT_RDWR); // Disallow further read/write operations.
-        ::close(m_socket);
+#ifdef __linux__
+    enum : uint32_t {
+        // Bits of SharedMemoryFutexHeader::__lock; the lower bits count the readers.
+        FUTEX_LOCK_WRITER          = 0x80000000u,
+        FUTEX_LOCK_WRITER_WAITING  = 0x40000000u,
+        FUTEX_LOCK_READERS_WAITING = 0x20000000u,
+        FUTEX_LOCK_READERS         = 0x1FFFFFFFu,
+        FUTEX_MAGIC                = 0x434C4658u, // "CLFX"
+    };
+    static void futexWait(std::atomic<uint32_t> *word, uint32_t expected) noexcept;
+    static void futexWakeAll(std::atomic<uint32_t> *word) noexcept;
+
+    void initFutex() noexcept;
+    void deinitFutex() noexcept;
+    void lockFutex() noexcept;
+    void unlockFutex() noexcept;
+    void lockSharedFutex() noexcept;
+    bool unlockSharedFutex() noexcept;
+    std::size_t futexMappingSize(uint32_t size, uint32_t slots) const noexcept;
+    void waitFutex() noexcept;
+    void notifyAllFutex() noexcept;
+    bool validFutex() noexcept;
+#endif
 #endif
-    }
-    m_socket = -1;
-}
 
-inline bool UDPReceiver::isRunning() const noexcept {
-    return (m_readFromSocketThreadRunning.load() && !TerminateHandler::instance().isTerminated.load());
-}
+   private:
+    std::string m_name{""};
+    std::string m_nameForTimeStamping{""};
+    uint32_t m_size{0};
+    char *m_sharedMemory{nullptr};
+    char *m_userAccessibleSharedMemory{nullptr};
+    bool m_hasOnlyAttachedToSharedMemory{false};
 
-inline void UDPReceiver::readFromSocket() noexcept {
-    // Create buffer to store data from socket.
-    constexpr uint16_t MAX_LENGTH = static_cast<uint16_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
-                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
-                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER);
-    std::array<char, MAX_LENGTH> buffer{};
+    std::atomic<bool> m_broken{false};
+    std::atomic<bool> m_isLocked{false};
 
-    struct timeval timeout {};
+#ifdef WIN32
+    HANDLE __conditionEvent{nullptr};
+    HANDLE __mutex{nullptr};
+    HANDLE __sharedMemory{nullptr};
+#else
+    int32_t m_fdForTimeStamping{-1};
 
-    // Define file descriptor set to watch for read operations.
-    fd_set setOfFiledescriptorsToReadFrom{};
-
-    // Sender address and port.
-    constexpr uint16_t MAX_ADDR_SIZE{1024};
-    std::array<char, MAX_ADDR_SIZE> remoteAddress{};
-
-    struct sockaddr_storage remote {};
-    socklen_t addrLength{sizeof(remote)};
-
-    // Indicate to main thread that we are ready.
-    m_readFromSocketThreadRunning.store(true);
+    bool m_usePOSIX{true};
 
-    while (m_readFromSocketThreadRunning.load()) {
-        // Define timeout for select system call. The timeval struct must be
-        // reinitialized for every select call as it might be modified containing
-        // the actual time slept.
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 20 * 1000; // Check for new data with 50Hz.
+    // Member fields for POSIX-based shared memory.
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    int32_t m_fd{-1};
+    struct SharedMemoryHeader {
+        uint32_t __size;
+        pthread_mutex_t __mutex;
+        pthread_cond_t __condition;
+    };
+    SharedMemoryHeader *m_sharedMemoryHeader{nullptr};
+#endif
 
-        FD_ZERO(&setOfFiledescriptorsToReadFrom);          // NOLINT
-        FD_SET(m_socket, &setOfFiledescriptorsToReadFrom); // NOLINT
-        ::select(m_socket + 1, &setOfFiledescriptorsToReadFrom, nullptr, nullptr, &timeout);
+    // Member fields for SysV-based shared memory.
+    key_t m_shmKeySysV{0};
+    key_t m_mutexKeySysV{0};
+    key_t m_conditionKeySysV{0};
 
-        ssize_t totalBytesRead{0};
-        if (FD_ISSET(m_socket, &setOfFiledescriptorsToReadFrom)) { // NOLINT
-            ssize_t bytesRead{0};
-            do {
-                bytesRead = ::recvfrom(m_socket,
-                                       buffer.data(),
-                                       buffer.max_size(),
-                                       0,
-                                       reinterpret_cast<struct sockaddr *>(&remote), // NOLINT
-                                       reinterpret_cast<socklen_t *>(&addrLength));  // NOLINT
+    int m_sharedMemoryIDSysV{-1};
+    int m_mutexIDSysV{-1};
+    int m_conditionIDSysV{-1};
 
-                if ((0 < bytesRead) && (nullptr != m_delegate)) {
+    // Member fields for futex-based shared memory; it uses the POSIX file descriptor.
 #ifdef __linux__
-                    std::chrono::system_clock::time_point timestamp;
-                    struct timeval receivedTimeStamp {};
-                    if (0 == ::ioctl(m_socket, SIOCGSTAMP, &receivedTimeStamp)) { // NOLINT
-                        // Transform struct timeval to C++ chrono.
-                        std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds> transformedTimePoint(
-                            std::chrono::microseconds(receivedTimeStamp.tv_sec * 1000000L + receivedTimeStamp.tv_usec));
-                        timestamp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(transformedTimePoint);
-                    } else { // LCOV_EXCL_LINE
-                        // In case the ioctl failed, fall back to chrono. // LCOV_EXCL_LINE
-                        timestamp = std::chrono::system_clock::now(); // LCOV_EXCL_LINE
-                    }
-#else
-                    std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
+    bool m_useFutex{false};
+    struct SharedMemoryFutexHeader {
+        uint32_t __size;
+        uint32_t __magic;
+        std::atomic<uint32_t> __lock;       // Writer and waiting flags and number of readers.
+        std::atomic<uint32_t> __generation; // Incremented by every notification.
+        std::atomic<uint32_t> __waiters;    // Threads waiting for the next generation.
+        uint32_t __slots;                   // Number of slots of __size bytes.
+        std::atomic<uint32_t> __latestSlot; // Slot published last.
+        std::atomic<uint64_t> __slotReuses; // Pinned slots taken by the producer.
+    };
+    struct alignas(64) SharedMemorySlotHeader {
+        std::atomic<uint32_t> __readers;  // Readers that pinned the slot.
+        std::atomic<uint32_t> __sequence; // Odd while the slot is written.
+        int32_t __seconds;                // Sample time stamp.
+        int32_t __microseconds;
+    };
+    SharedMemoryFutexHeader *m_sharedMemoryFutexHeader{nullptr};
+    SharedMemorySlotHeader *m_slotHeaders{nullptr};
+    char *m_slotData{nullptr};
+    std::size_t m_slotStride{0};
+    uint32_t m_currentSlot{0};
+    uint32_t m_currentSequence{0};
+    uint32_t m_lastGeneration{0};
+    std::atomic<uint64_t> m_overruns{0};
 #endif
-
-                    // Transform sender address to C-string.
-                    ::inet_ntop(remote.ss_family,
-                                &((reinterpret_cast<struct sockaddr_in *>(&remote))->sin_addr), // NOLINT
-                                remoteAddress.data(),
-                                remoteAddress.max_size());
-                    const unsigned long RECVFROM_IP{reinterpret_cast<struct sockaddr_in *>(&remote)->sin_addr.s_addr}; // NOLINT
-                    const uint16_t RECVFROM_PORT{ntohs(reinterpret_cast<struct sockaddr_in *>(&remote)->sin_port)};    // NOLINT
-
-                    // Check if the bytes actually came from us.
-                    bool sentFromUs{false};
-                    {
-                        auto pos                   = m_listOfLocalIPAddresses.find(RECVFROM_IP);
-                        const bool sentFromLocalIP = (pos != m_listOfLocalIPAddresses.end() && (*pos == RECVFROM_IP));
-                        sentFromUs                 = sentFromLocalIP && (m_localSendFromPort == RECVFROM_PORT);
-                    }
-
-                    // Create a pipeline entry to be processed concurrently.
-                    if (!sentFromUs) {
-                        PipelineEntry pe;
-                        pe.m_data       = std::string(buffer.data(), static_cast<size_t>(bytesRead));
-                        pe.m_from       = std::string(remoteAddress.data()) + ':' + std::to_string(RECVFROM_PORT);
-                        pe.m_sampleTime = timestamp;
-
-                        // Store entry in queue.
-                        if (m_pipeline) {
-                            m_pipeline->add(std::move(pe));
-                        }
-                    }
-                    totalBytesRead += bytesRead;
-                }
-            } while (!m_isBlockingSocket && (bytesRead > 0));
-        }
-
-        if (static_cast<int32_t>(totalBytesRead) > 0) {
-            if (m_pipeline) {
-                m_pipeline->notifyAll();
-            }
-        }
-    }
-}
+#endif
+};
 } // namespace cluon
+
+#endif
 /*
- * Copyright (C) 2017-2018  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/TCPConnection.hpp"
-//#include "cluon/IPv4Tools.hpp"
-//#include "cluon/TerminateHandler.hpp"
-
-// clang-format off
-#ifdef WIN32
-    #include <errno.h>
-    #include <iostream>
-#else
-    #ifdef __linux__
-        #include <linux/sockios.h>
-    #endif
+#ifndef CLUON_RECORDER_HPP
+#define CLUON_RECORDER_HPP
 
-    #include <arpa/inet.h>
-    #include <sys/ioctl.h>
-    #include <sys/socket.h>
-    #include <sys/types.h>
-    #include <unistd.h>
-#endif
-// clang-format on
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
 
-#include <cstring>
-#include <algorithm>
-#include <array>
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace cluon {
+/**
+This class writes Envelopes into a .rec file. It is meant to be fed from an
+OD4Session's delegate: the method record only serializes the Envelope and
+appends it to an in-memory batch; a dedicated I/O thread writes the batches
+to disk using large writes with sizes that are multiples of the file system
+block size; the last block that is not yet full is written in place and
+overwritten once it is complete. If the I/O thread falls behind by more than the configured amount
+of bytes, newly arriving Envelopes are dropped and counted instead of blocking
+the caller.
+
+Next to the .rec file, the Recorder writes a sidecar index (.rec.idx) with one
+entry per Envelope (sample time stamp, file position, data type, sender stamp)
+and a .rec.counts.csv file with the number of Envelopes and bytes per data type
+and sender stamp. Optionally, the Recorder writes compressed .rec files instead
+(cf. CompressedRecWriter); those contain their own index and no sidecar index.
 
-inline TCPConnection::TCPConnection(const int32_t &socket) noexcept
-    : m_socket(socket)
-    , m_newDataDelegate(nullptr)
-    , m_connectionLostDelegate(nullptr) {
-    if (!(m_socket < 0)) {
-        startReadingFromSocket();
-    }
-}
+\code{.cpp}
+cluon::Recorder recorder{"myRecording.rec"};
+cluon::OD4Session od4{111, [&recorder](cluon::data::Envelope &&envelope) noexcept {
+    recorder.record(std::move(envelope));
+}};
+\endcode
+*/
+class LIBCLUON_API Recorder {
+   private:
+    Recorder(const Recorder &) = delete;
+    Recorder(Recorder &&)      = delete;
+    Recorder &operator=(const Recorder &) = delete;
+    Recorder &operator=(Recorder &&) = delete;
 
-inline TCPConnection::TCPConnection(const std::string &address,
-                             uint16_t port,
-                             std::function<void(std::string &&, std::chrono::system_clock::time_point &&)> newDataDelegate,
-                             std::function<void()> connectionLostDelegate) noexcept
-    : m_newDataDelegate(std::move(newDataDelegate))
-    , m_connectionLostDelegate(std::move(connectionLostDelegate)) {
-    // Decompose given address string to check validity with numerical IPv4 address.
-    std::string resolvedHostname{cluon::getIPv4FromHostname(address)};
-    std::string tmp{resolvedHostname};
-    std::replace(tmp.begin(), tmp.end(), '.', ' ');
-    std::istringstream sstr{tmp};
-    std::vector<int> addressTokens{std::istream_iterator<int>(sstr), std::istream_iterator<int>()};
+   public:
+    /**
+     * Policy when the written data is forced from the page cache to disk.
+     */
+    enum class FsyncPolicy : uint8_t {
+        NEVER       = 0, // Leave it to the operating system.
+        ON_ROTATION = 1, // When a file is closed.
+        PER_BATCH   = 2, // After every batch written by the I/O thread.
+        INTERVAL    = 3, // At most every fsyncIntervalInMilliseconds.
+    };
 
-    if ((!addressTokens.empty()) && (4 == addressTokens.size())
-        && !(std::end(addressTokens) != std::find_if(addressTokens.begin(), addressTokens.end(), [](int a) { return (a < 0) || (a > 255); })) && (0 < port)) {
-        // Check for valid IP address.
-        struct sockaddr_in tmpSocketAddress {};
-        const bool isValid = (0 < ::inet_pton(AF_INET, resolvedHostname.c_str(), &(tmpSocketAddress.sin_addr)));
-        if (isValid) {
-            std::memset(&m_address, 0, sizeof(m_address));
-            m_address.sin_addr.s_addr = ::inet_addr(resolvedHostname.c_str());
-            m_address.sin_family      = AF_INET;
-            m_address.sin_port        = htons(port);
-#ifdef WIN32
-            // Load Winsock 2.2 DLL.
-            WSADATA wsaData;
-            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-                std::cerr << "[cluon::TCPConnection] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
-            }
-#endif
+    /**
+     * Magic bytes at the beginning of a sidecar index file.
+     */
+    static constexpr const char *INDEX_FILE_MAGIC{"CLUONIDX"};
+    static constexpr uint32_t INDEX_FILE_VERSION{1};
 
-            m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    /**
+     * One entry in a sidecar index file; all fields are stored little endian.
+     */
+    struct IndexFileEntry {
+        int64_t sampleTimeStamp{0}; // in microseconds.
+        uint64_t filePosition{0};
+        int32_t dataType{0};
+        uint32_t senderStamp{0};
+    };
 
-#ifdef WIN32
-            if (m_socket < 0) {
-                std::cerr << "[cluon::TCPConnection] Error while creating socket: " << WSAGetLastError() << std::endl;
-                WSACleanup();
-            }
-#endif
+   public:
+    /**
+     * Constructor.
+     *
+     * @param file Name of the .rec file to write; when rotation is enabled, the
+     *        files are named <file without .rec>-<number>.rec.
+     * @param rotateAfterBytes Start a new file when the current one exceeds this size (0 = never).
+     * @param rotateAfterSeconds Start a new file after this many seconds (0 = never).
+     * @param fsyncPolicy When to force the data to disk.
+     * @param fsyncIntervalInMilliseconds Interval for FsyncPolicy::INTERVAL.
+     * @param maxQueuedBytes Maximum amount of bytes waiting for the I/O thread before Envelopes are dropped.
+     * @param compress Write compressed .rec files.
+     */
+    Recorder(const std::string &file,
+             uint64_t rotateAfterBytes            = 0,
+             uint32_t rotateAfterSeconds          = 0,
+             FsyncPolicy fsyncPolicy              = FsyncPolicy::NEVER,
+             uint32_t fsyncIntervalInMilliseconds = 1000,
+             uint64_t maxQueuedBytes              = 256 * 1024 * 1024,
+             bool compress                        = false) noexcept;
+    ~Recorder() noexcept;
 
-            if (!(m_socket < 0)) {
-                auto retVal = ::connect(m_socket, reinterpret_cast<struct sockaddr *>(&m_address), sizeof(m_address));
-                if (0 > retVal) {
-#ifdef WIN32 // LCOV_EXCL_LINE
-                    auto errorCode = WSAGetLastError();
-#else
-                    auto errorCode = errno;                                          // LCOV_EXCL_LINE
-#endif                                      // LCOV_EXCL_LINE
-                    closeSocket(errorCode); // LCOV_EXCL_LINE
-                } else {
-                    startReadingFromSocket();
-                }
-            }
-        }
-    }
-}
+    /**
+     * This method queues the given Envelope for recording; it never waits for
+     * the disk. If too many bytes are already queued, the Envelope is dropped.
+     *
+     * @param envelope Envelope to record.
+     * @return true if the Envelope was queued, false if it was dropped.
+     */
+    bool record(cluon::data::Envelope &&envelope) noexcept;
 
-inline TCPConnection::~TCPConnection() noexcept {
-    {
-        m_readFromSocketThreadRunning.store(false);
+    /**
+     * @return true if the Recorder could open its output file.
+     */
+    bool isRecording() const noexcept;
 
-        // Joining the thread could fail.
-        try {
-            if (m_readFromSocketThread.joinable()) {
-                m_readFromSocketThread.join();
-            }
-        } catch (...) {} // LCOV_EXCL_LINE
-    }
+    /**
+     * @return Number of Envelopes written to disk.
+     */
+    uint64_t numberOfRecordedEnvelopes() const noexcept;
 
-    m_pipeline.reset();
+    /**
+     * @return Number of bytes written to disk.
+     */
+    uint64_t numberOfRecordedBytes() const noexcept;
 
-    closeSocket(0);
-}
+    /**
+     * @return Number of Envelopes dropped because the I/O thread fell behind.
+     */
+    uint64_t numberOfDroppedEnvelopes() const noexcept;
 
-inline void TCPConnection::closeSocket(int errorCode) noexcept {
-    if (0 != errorCode) {
-        std::cerr << "[cluon::TCPConnection] Failed to perform socket operation: "; // LCOV_EXCL_LINE
-#ifdef WIN32                                                                        // LCOV_EXCL_LINE
-        std::cerr << errorCode << std::endl;
-#else
-        std::cerr << ::strerror(errorCode) << " (" << errorCode << ")" << std::endl; // LCOV_EXCL_LINE
-#endif // LCOV_EXCL_LINE
-    }
+    /**
+     * @return Name of the file that is currently written.
+     */
+    std::string currentFile() const noexcept;
 
-    if (!(m_socket < 0)) {
-#ifdef WIN32
-        ::shutdown(m_socket, SD_BOTH);
-        ::closesocket(m_socket);
-        WSACleanup();
-#else
-        ::shutdown(m_socket, SHUT_RDWR);                                             // Disallow further read/write operations.
-        ::close(m_socket);
-#endif
-    }
-    m_socket = -1;
-}
+   private:
+    enum : uint32_t {
+        BLOCK_SIZE                 = 4096,
+        BATCH_SIZE_TO_WAKE_WRITER  = 1024 * 1024,
+        STAGING_BUFFER_SIZE        = 4 * 1024 * 1024,
+        COUNTS_INTERVAL_IN_SECONDS = 1,
+    };
 
-inline void TCPConnection::startReadingFromSocket() noexcept {
-    // Constructing a thread could fail.
-    try {
-        m_readFromSocketThread = std::thread(&TCPConnection::readFromSocket, this);
+    struct QueuedEnvelope {
+        int64_t m_sampleTimeStamp{0};
+        uint32_t m_size{0};
+        int32_t m_dataType{0};
+        uint32_t m_senderStamp{0};
+    };
 
-        // Let the operating system spawn the thread.
-        using namespace std::literals::chrono_literals;
-        do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
-    } catch (...) {          // LCOV_EXCL_LINE
-        closeSocket(ECHILD); // LCOV_EXCL_LINE
-    }
+    struct Batch {
+        std::string m_data{};
+        std::vector<QueuedEnvelope> m_envelopes{};
+    };
 
-    try {
-        m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>(
-            [this](PipelineEntry &&entry) { this->m_newDataDelegate(std::move(entry.m_data), std::move(entry.m_sampleTime)); });
-        if (m_pipeline) {
-            // Let the operating system spawn the thread.
-            using namespace std::literals::chrono_literals; // NOLINT
-            do { std::this_thread::sleep_for(1ms); } while (!m_pipeline->isRunning());
-        }
-    } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
-}
+   private:
+    void writeToDisk() noexcept;
+    bool openNextFile() noexcept;
+    void closeCurrentFile() noexcept;
+    void writeStagingBuffer(bool flushAll) noexcept;
+    void writeStagingBufferTail(uint64_t position) noexcept;
+    void writeCounts() noexcept;
+    void syncToDisk() noexcept;
 
-inline void TCPConnection::setOnNewData(std::function<void(std::string &&, std::chrono::system_clock::time_point &&)> newDataDelegate) noexcept {
-    std::lock_guard<std::mutex> lck(m_newDataDelegateMutex);
-    m_newDataDelegate = newDataDelegate;
-}
+   private:
+    const std::string m_file;
+    const uint64_t m_rotateAfterBytes;
+    const uint32_t m_rotateAfterSeconds;
+    const FsyncPolicy m_fsyncPolicy;
+    const std::chrono::milliseconds m_fsyncInterval;
+    const uint64_t m_maxQueuedBytes;
+    const bool m_compress;
+
+    std::mutex m_queueMutex{};
+    std::condition_variable m_queueCondition{};
+    Batch m_queue{};
+
+    std::atomic<uint64_t> m_recordedEnvelopes{0};
+    std::atomic<uint64_t> m_recordedBytes{0};
+    std::atomic<uint64_t> m_droppedEnvelopes{0};
+
+    // State only accessed by the I/O thread (and the constructor/destructor).
+    Batch m_writing{};
+    char *m_stagingBuffer{nullptr};
+    uint32_t m_stagingBufferLevel{0};
+    int32_t m_fd{-1};
+    int32_t m_indexFd{-1};
+    std::unique_ptr<CompressedRecWriter> m_compressedRecWriter{};
+    uint32_t m_fileNumber{0};
+    uint64_t m_filePosition{0};
+    std::chrono::steady_clock::time_point m_fileOpened{};
+    std::chrono::steady_clock::time_point m_lastSync{};
+    std::chrono::steady_clock::time_point m_lastCounts{};
+    std::vector<IndexFileEntry> m_indexEntries{};
+    std::map<std::pair<int32_t, uint32_t>, std::pair<uint64_t, uint64_t>> m_counts{};
 
-inline void TCPConnection::setOnConnectionLost(std::function<void()> connectionLostDelegate) noexcept {
-    std::lock_guard<std::mutex> lck(m_connectionLostDelegateMutex);
-    m_connectionLostDelegate = connectionLostDelegate;
-}
+    mutable std::mutex m_currentFileMutex{};
+    std::string m_currentFile{};
 
-inline bool TCPConnection::isRunning() const noexcept {
-    return (m_readFromSocketThreadRunning.load() && !TerminateHandler::instance().isTerminated.load());
-}
+    std::atomic<bool> m_recording{false};
+    std::thread m_writerThread{};
+};
+} // namespace cluon
 
-inline std::pair<ssize_t, int32_t> TCPConnection::send(std::string &&data) const noexcept {
-    if (-1 == m_socket) {
-        return {-1, EBADF};
-    }
+#endif
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-    if (data.empty()) {
-        return {0, 0};
-    }
+#ifndef CLUON_MERGEDPLAYER_HPP
+#define CLUON_MERGEDPLAYER_HPP
 
-    if (!m_readFromSocketThreadRunning.load()) {
-        std::lock_guard<std::mutex> lck(m_connectionLostDelegateMutex); // LCOV_EXCL_LINE
-        if (nullptr != m_connectionLostDelegate) {                      // LCOV_EXCL_LINE
-            m_connectionLostDelegate();                                 // LCOV_EXCL_LINE
-        }
-        return {-1, ENOTCONN}; // LCOV_EXCL_LINE
-    }
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
+//#include "cluon/CompressedRec.hpp"
 
-    constexpr uint16_t MAX_LENGTH{65535};
-    if (MAX_LENGTH < data.size()) {
-        return {-1, E2BIG};
-    }
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-    std::lock_guard<std::mutex> lck(m_socketMutex);
-    ssize_t bytesSent = ::send(m_socket, data.c_str(), data.length(), 0);
-    return {bytesSent, (0 > bytesSent ? errno : 0)};
+namespace cluon {
+/**
+This class replays several .rec files as one stream ordered by sample time
+stamp without merging them on disk. Every file has a cursor over its own
+index; a min-heap over the sample time stamps of the cursors' next entries
+decides which file provides the next Envelope. A background thread reads
+ahead for all files, preferring the file whose next unread Envelope is due
+first; the number of bytes read ahead is bounded in total and shared evenly
+between the files.
+
+The index of a file is read from a compressed .rec file, from a sidecar
+index (.rec.idx) written by cluon::Recorder, or by scanning the file.
+
+\code{.cpp}
+cluon::MergedPlayer player({"camera.rec", "imu.rec"}, false);
+while (player.hasMoreData()) {
+    auto next = player.getNextEnvelopeToBeReplayed();
+    std::this_thread::sleep_for(std::chrono::microseconds(player.delay()));
 }
+\endcode
+*/
+class LIBCLUON_API MergedPlayer {
+   private:
+    enum {
+        ONE_SECOND_IN_MICROSECONDS = 1000 * 1000,
+        MAX_DELAY_IN_MICROSECONDS  = 1 * ONE_SECOND_IN_MICROSECONDS,
+    };
 
-inline void TCPConnection::readFromSocket() noexcept {
-    // Create buffer to store data from socket.
-    constexpr uint16_t MAX_LENGTH{65535};
-    std::array<char, MAX_LENGTH> buffer{};
+   private:
+    MergedPlayer(const MergedPlayer &) = delete;
+    MergedPlayer(MergedPlayer &&)      = delete;
+    MergedPlayer &operator=(MergedPlayer &&) = delete;
+    MergedPlayer &operator=(const MergedPlayer &other) = delete;
 
-    struct timeval timeout {};
+   public:
+    /**
+     * Constructor.
+     *
+     * @param files Files to play.
+     * @param autoRewind True if the files should be rewind at the end.
+     * @param maxBufferedBytes Upper bound for the payload read ahead from all files together.
+     */
+    MergedPlayer(const std::vector<std::string> &files, const bool &autoRewind, uint64_t maxBufferedBytes = 64 * 1024 * 1024) noexcept;
+    ~MergedPlayer();
 
-    // Define file descriptor set to watch for read operations.
-    fd_set setOfFiledescriptorsToReadFrom{};
+    /**
+     * @return Pair of bool and next cluon::data::Envelope to be replayed;
+     *         if bool is false, no next Envelope is available.
+     */
+    std::pair<bool, cluon::data::Envelope> getNextEnvelopeToBeReplayed() noexcept;
 
-    // Indicate to main thread that we are ready.
-    m_readFromSocketThreadRunning.store(true);
+    /**
+     * @return real delay in microseconds to be waited before the next cluon::data::Envelope should be delivered.
+     */
+    uint32_t delay() const noexcept;
 
-    // This flag is used to not read data from the socket until this TCPConnection has a proper onNewDataHandler set.
-    bool hasNewDataDelegate{false};
+    /**
+     * @return true if there is more data to replay.
+     */
+    bool hasMoreData() const noexcept;
 
-    while (m_readFromSocketThreadRunning.load()) {
-        // Define timeout for select system call. The timeval struct must be
-        // reinitialized for every select call as it might be modified containing
-        // the actual time slept.
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 20 * 1000; // Check for new data with 50Hz.
+    /**
+     * This method rewinds all files.
+     */
+    void rewind() noexcept;
 
-        FD_ZERO(&setOfFiledescriptorsToReadFrom);
-        FD_SET(m_socket, &setOfFiledescriptorsToReadFrom);
-        ::select(m_socket + 1, &setOfFiledescriptorsToReadFrom, nullptr, nullptr, &timeout);
+    /**
+     * This method moves all files to the given ratio of the merged time span.
+     *
+     * @param ratio Value between 0 (first sample time stamp) and 1 (last sample time stamp).
+     */
+    void seekTo(float ratio) noexcept;
 
-        // Only read data when the newDataDelegate is set.
-        if (!hasNewDataDelegate) {
-            std::lock_guard<std::mutex> lck(m_newDataDelegateMutex);
-            hasNewDataDelegate = (nullptr != m_newDataDelegate);
-        }
-        if (FD_ISSET(m_socket, &setOfFiledescriptorsToReadFrom) && hasNewDataDelegate) {
-            ssize_t bytesRead = ::recv(m_socket, buffer.data(), buffer.max_size(), 0);
-            if (0 >= bytesRead) {
-                // 0 == bytesRead: peer shut down the connection; 0 > bytesRead: other error.
-                m_readFromSocketThreadRunning.store(false);
+    /**
+     * @return total amount of cluon::data::Envelopes in all files.
+     */
+    uint32_t totalNumberOfEnvelopesInRecFile() const noexcept;
 
-                {
-                    std::lock_guard<std::mutex> lck(m_connectionLostDelegateMutex);
-                    if (nullptr != m_connectionLostDelegate) {
-                        m_connectionLostDelegate();
-                    }
-                }
-                break;
-            }
+    void setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept;
 
-            {
-                std::lock_guard<std::mutex> lck(m_newDataDelegateMutex);
-                if ((0 < bytesRead) && (nullptr != m_newDataDelegate)) {
-                    // SIOCGSTAMP is not available for a stream-based socket,
-                    // thus, falling back to regular chrono timestamping.
-                    std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
-                    {
-                        PipelineEntry pe;
-                        pe.m_data       = std::string(buffer.data(), static_cast<size_t>(bytesRead));
-                        pe.m_sampleTime = timestamp;
+   private:
+    struct Cursor {
+        std::string m_file{};
+        std::fstream m_recFile{};
+        std::unique_ptr<CompressedRecReader> m_compressedRecReader{};
+
+        // Pairs of sample time stamp and position in the file, sorted by sample time stamp.
+        std::vector<std::pair<int64_t, uint64_t>> m_index{};
+
+        // Entries [m_nextToReplay, m_nextToRead) are in m_buffered.
+        size_t m_nextToReplay{0};
+        size_t m_nextToRead{0};
+        std::deque<std::pair<bool, cluon::data::Envelope>> m_buffered{};
+        uint64_t m_bufferedBytes{0};
+    };
 
-                        // Store entry in queue.
-                        if (m_pipeline) {
-                            m_pipeline->add(std::move(pe));
-                        }
-                    }
+    // Sample time stamp of the next entry and number of the cursor.
+    using HeapEntry = std::pair<int64_t, size_t>;
+
+   private:
+    void initializeIndex(Cursor &cursor) noexcept;
+    bool readSidecarIndex(Cursor &cursor) noexcept;
+    std::pair<bool, cluon::data::Envelope> readEnvelope(Cursor &cursor, uint64_t position) noexcept;
+
+    /**
+     * This method moves all cursors to the first entry not before the given
+     * sample time stamp and discards the data read ahead; m_mutex must be held.
+     */
+    void resetTo(int64_t sampleTimeStamp) noexcept;
+
+    /**
+     * This method reads ahead for all files.
+     */
+    void readAhead() noexcept;
+
+   private:
+    const bool m_autoRewind;
+    uint64_t m_maxBufferedBytesPerFile{0};
+    std::vector<std::unique_ptr<Cursor>> m_cursors{};
+    uint32_t m_totalNumberOfEnvelopes{0};
+    int64_t m_firstSampleTimeStamp{0};
+    int64_t m_lastSampleTimeStamp{0};
+
+    mutable std::mutex m_mutex{};
+    std::condition_variable m_readAheadCondition{};
+    std::condition_variable m_envelopeAvailableCondition{};
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> m_heap{};
+    uint64_t m_generation{0};
+    bool m_hasPreviousSampleTimeStamp{false};
+    int64_t m_previousSampleTimeStamp{0};
+    uint32_t m_delay{0};
+    uint64_t m_numberOfReturnedEnvelopesInTotal{0};
+
+    bool m_running{true};
+    std::thread m_readAheadThread{};
+
+    std::mutex m_playerListenerMutex{};
+    std::function<void(cluon::data::PlayerStatus playerStatus)> m_playerListener{nullptr};
+};
 
-                    if (m_pipeline) {
-                        m_pipeline->notifyAll();
-                    }
-                }
-            }
-        }
-    }
-}
 } // namespace cluon
+
+#endif
+#ifndef BEGIN_HEADER_ONLY_IMPLEMENTATION
+#define BEGIN_HEADER_ONLY_IMPLEMENTATION
 /*
  * Copyright (C) 2017-2018  Christian Berger
  *
@@ -10856,187 +11183,25 @@ inline void TCPConnection::readFromSocket() noexcept {
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/TCPServer.hpp"
-//#include "cluon/TerminateHandler.hpp"
-
-// clang-format off
-#ifdef WIN32
-    #include <errno.h>
-    #include <iostream>
-#else
-    #include <arpa/inet.h>
-    #include <sys/ioctl.h>
-    #include <sys/socket.h>
-    #include <sys/types.h>
-    #include <unistd.h>
-#endif
-// clang-format on
+//#include "argh/argh.h"
 
-#include <cstring>
-#include <array>
-#include <iostream>
-#include <memory>
-#include <sstream>
+//#include "cluon/cluon.hpp"
 
 namespace cluon {
 
-inline TCPServer::TCPServer(uint16_t port, std::function<void(std::string &&from, std::shared_ptr<cluon::TCPConnection> connection)> newConnectionDelegate) noexcept
-    : m_newConnectionDelegate(newConnectionDelegate) {
-    if (0 < port) {
-#ifdef WIN32
-        // Load Winsock 2.2 DLL.
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-            std::cerr << "[cluon::TCPServer] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
-        }
-#endif
-        m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+inline std::map<std::string, std::string> getCommandlineArguments(int32_t argc, char **argv) noexcept {
+    argh::parser commandline{argc, argv};
+    std::map<std::string, std::string> retVal;
 
-#ifdef WIN32
-        if (m_socket < 0) {
-            std::cerr << "[cluon::TCPServer] Error while creating socket: " << WSAGetLastError() << std::endl;
-            WSACleanup();
-        }
-#endif
+    for (auto &positionalArgument : commandline.pos_args()) { retVal[positionalArgument] = ""; }
 
-        if (!(m_socket < 0)) {
-            // Allow reusing of ports by multiple calls with same address/port.
-            uint32_t YES = 1;
-            // clang-format off
-            auto retVal = ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&YES), sizeof(YES)); // NOLINT
-            // clang-format on
-            if (0 > retVal) {
-#ifdef WIN32 // LCOV_EXCL_LINE
-                auto errorCode = WSAGetLastError();
-#else
-                auto errorCode = errno;                                              // LCOV_EXCL_LINE
-#endif                                  // LCOV_EXCL_LINE
-                closeSocket(errorCode); // LCOV_EXCL_LINE
-            }
-        }
-
-        if (!(m_socket < 0)) {
-            // Setup address and port.
-            struct sockaddr_in address;
-            ::memset(&address, 0, sizeof(address));
-            address.sin_family      = AF_INET;
-            address.sin_addr.s_addr = htonl(INADDR_ANY);
-            address.sin_port        = htons(port);
-
-            auto retVal = ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address));
-            if (-1 != retVal) {
-                constexpr int32_t MAX_PENDING_CONNECTIONS{100};
-                retVal = ::listen(m_socket, MAX_PENDING_CONNECTIONS);
-                if (-1 != retVal) {
-                    // Constructing a thread could fail.
-                    try {
-                        m_readFromSocketThread = std::thread(&TCPServer::readFromSocket, this);
-
-                        // Let the operating system spawn the thread.
-                        using namespace std::literals::chrono_literals;
-                        do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
-                    } catch (...) {          // LCOV_EXCL_LINE
-                        closeSocket(ECHILD); // LCOV_EXCL_LINE
-                    }
-                } else { // LCOV_EXCL_LINE
-#ifdef WIN32             // LCOV_EXCL_LINE
-                    auto errorCode = WSAGetLastError();
-#else
-                    auto errorCode = errno;                                          // LCOV_EXCL_LINE
-#endif                                      // LCOV_EXCL_LINE
-                    closeSocket(errorCode); // LCOV_EXCL_LINE
-                }
-            } else { // LCOV_EXCL_LINE
-#ifdef WIN32         // LCOV_EXCL_LINE
-                auto errorCode = WSAGetLastError();
-#else
-                auto errorCode = errno;                                              // LCOV_EXCL_LINE
-#endif                                  // LCOV_EXCL_LINE
-                closeSocket(errorCode); // LCOV_EXCL_LINE
-            }
-        }
-    }
-}
-
-inline TCPServer::~TCPServer() noexcept {
-    m_readFromSocketThreadRunning.store(false);
-
-    // Joining the thread could fail.
-    try {
-        if (m_readFromSocketThread.joinable()) {
-            m_readFromSocketThread.join();
-        }
-    } catch (...) { // LCOV_EXCL_LINE
-    }
-
-    closeSocket(0);
-}
-
-inline void TCPServer::closeSocket(int errorCode) noexcept {
-    if (0 != errorCode) {
-        std::cerr << "[cluon::TCPServer] Failed to perform socket operation: "; // LCOV_EXCL_LINE
-#ifdef WIN32                                                                    // LCOV_EXCL_LINE
-        std::cerr << errorCode << std::endl;
-#else
-        std::cerr << ::strerror(errorCode) << " (" << errorCode << ")" << std::endl; // LCOV_EXCL_LINE
-#endif // LCOV_EXCL_LINE
-    }
+    for (auto &flag : commandline.flags()) { retVal[flag] = "1"; }
 
-    if (!(m_socket < 0)) {
-#ifdef WIN32
-        ::shutdown(m_socket, SD_BOTH);
-        ::closesocket(m_socket);
-        WSACleanup();
-#else
-        ::shutdown(m_socket, SHUT_RDWR);                                             // Disallow further read/write operations.
-        ::close(m_socket);
-#endif
-    }
-    m_socket = -1;
-}
+    for (auto &parameter : commandline.params()) { retVal[parameter.first] = parameter.second; }
 
-inline bool TCPServer::isRunning() const noexcept {
-    return (m_readFromSocketThreadRunning.load() && !TerminateHandler::instance().isTerminated.load());
+    return retVal;
 }
 
-inline void TCPServer::readFromSocket() noexcept {
-    struct timeval timeout {};
-
-    // Define file descriptor set to watch for read operations.
-    fd_set setOfFiledescriptorsToReadFrom{};
-
-    // Indicate to main thread that we are ready.
-    m_readFromSocketThreadRunning.store(true);
-
-    constexpr uint16_t MAX_ADDR_SIZE{1024};
-    std::array<char, MAX_ADDR_SIZE> remoteAddress{};
-
-    while (m_readFromSocketThreadRunning.load()) {
-        // Define timeout for select system call. The timeval struct must be
-        // reinitialized for every select call as it might be modified containing
-        // the actual time slept.
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 20 * 1000; // Check for new data with 50Hz.
-
-        FD_ZERO(&setOfFiledescriptorsToReadFrom);
-        FD_SET(m_socket, &setOfFiledescriptorsToReadFrom);
-        ::select(m_socket + 1, &setOfFiledescriptorsToReadFrom, nullptr, nullptr, &timeout);
-        if (FD_ISSET(m_socket, &setOfFiledescriptorsToReadFrom)) {
-            struct sockaddr_storage remote;
-            socklen_t addrLength     = sizeof(remote);
-            int32_t connectingClient = ::accept(m_socket, reinterpret_cast<struct sockaddr *>(&remote), &addrLength);
-            if ((0 <= connectingClient) && (nullptr != m_newConnectionDelegate)) {
-                ::inet_ntop(remote.ss_family,
-                            &((reinterpret_cast<struct sockaddr_in *>(&remote))->sin_addr), // NOLINT
-                            remoteAddress.data(),
-                            remoteAddress.max_size());
-                const uint16_t RECVFROM_PORT{ntohs(reinterpret_cast<struct sockaddr_in *>(&remote)->sin_port)}; // NOLINT
-                m_newConnectionDelegate(std::string(remoteAddress.data()) + ':' + std::to_string(RECVFROM_PORT),
-                                        std::shared_ptr<cluon::TCPConnection>(new cluon::TCPConnection(connectingClient)));
-            }
-        }
-    }
-}
 } // namespace cluon
 /*
  * Copyright (C) 2017-2018  Christian Berger
@@ -11046,217 +11211,97 @@ inline void TCPServer::readFromSocket() noexcept {
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/ToProtoVisitor.hpp"
-
-#include <cstring>
+//#include "cluon/MetaMessage.hpp"
 
 namespace cluon {
 
-inline std::string ToProtoVisitor::encodedData() const noexcept {
-    std::string s{m_buffer.str()};
-    return s;
+inline MetaMessage::MetaField::MetaFieldDataTypes MetaMessage::MetaField::fieldDataType() const noexcept {
+    return m_fieldDataType;
 }
 
-inline void ToProtoVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
-    (void)shortName;
-    (void)longName;
+inline MetaMessage::MetaField &MetaMessage::MetaField::fieldDataType(const MetaMessage::MetaField::MetaFieldDataTypes &v) noexcept {
+    m_fieldDataType = v;
+    return *this;
 }
 
-inline void ToProtoVisitor::postVisit() noexcept {}
-
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<bool>(id, v);
+inline std::string MetaMessage::MetaField::fieldDataTypeName() const noexcept {
+    return m_fieldDataTypeName;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)typeName;
-    (void)name;
-    uint8_t _v = static_cast<uint8_t>(v); // NOLINT
-    toKeyValue<uint8_t>(id, _v);
+inline MetaMessage::MetaField &MetaMessage::MetaField::fieldDataTypeName(const std::string &v) noexcept {
+    m_fieldDataTypeName = v;
+    return *this;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<int8_t>(id, v);
+inline std::string MetaMessage::MetaField::fieldName() const noexcept {
+    return m_fieldName;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<uint8_t>(id, v);
+inline MetaMessage::MetaField &MetaMessage::MetaField::fieldName(const std::string &v) noexcept {
+    m_fieldName = v;
+    return *this;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<int16_t>(id, v);
+inline uint32_t MetaMessage::MetaField::fieldIdentifier() const noexcept {
+    return m_fieldIdentifier;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<uint16_t>(id, v);
+inline MetaMessage::MetaField &MetaMessage::MetaField::fieldIdentifier(uint32_t v) noexcept {
+    m_fieldIdentifier = v;
+    return *this;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<int32_t>(id, v);
+inline std::string MetaMessage::MetaField::defaultInitializationValue() const noexcept {
+    return m_defaultInitializationValue;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<uint32_t>(id, v);
+inline MetaMessage::MetaField &MetaMessage::MetaField::defaultInitializationValue(const std::string &v) noexcept {
+    m_defaultInitializationValue = v;
+    return *this;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<int64_t>(id, v);
-}
+////////////////////////////////////////////////////////////////////////////////
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    toKeyValue<uint64_t>(id, v);
-}
+inline MetaMessage::MetaMessage() noexcept {}
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)typeName;
-    (void)name;
-    uint64_t key = encodeKey(id, static_cast<uint8_t>(ProtoConstants::FOUR_BYTES));
-    toVarInt(m_buffer, key);
-    encode(m_buffer, v);
+inline std::string MetaMessage::packageName() const noexcept {
+    return m_packageName;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)typeName;
-    (void)name;
-    uint64_t key = encodeKey(id, static_cast<uint8_t>(ProtoConstants::EIGHT_BYTES));
-    toVarInt(m_buffer, key);
-    encode(m_buffer, v);
+inline std::string MetaMessage::messageName() const noexcept {
+    return m_messageName;
 }
 
-inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)typeName;
-    (void)name;
-    uint64_t key = encodeKey(id, static_cast<uint8_t>(ProtoConstants::LENGTH_DELIMITED));
-    toVarInt(m_buffer, key);
-    encode(m_buffer, v);
+inline MetaMessage &MetaMessage::packageName(const std::string &v) noexcept {
+    m_packageName = v;
+    return *this;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, bool &v) noexcept {
-    uint64_t _v{(v ? 1u : 0u)};
-    return toVarInt(o, _v);
+inline MetaMessage &MetaMessage::messageName(const std::string &v) noexcept {
+    m_messageName = v;
+    return *this;
 }
 
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, int8_t &v) noexcept {
-    uint64_t _v = toZigZag8(v);
-    return toVarInt(o, _v);
+inline int32_t MetaMessage::messageIdentifier() const noexcept {
+    return m_messageIdentifier;
 }
 
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint8_t &v) noexcept {
-    uint64_t _v = v;
-    return toVarInt(o, _v);
+inline MetaMessage &MetaMessage::messageIdentifier(int32_t v) noexcept {
+    m_messageIdentifier = v;
+    return *this;
 }
 
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, int16_t &v) noexcept {
-    uint64_t _v = toZigZag16(v);
-    return toVarInt(o, _v);
+inline MetaMessage &MetaMessage::add(MetaMessage::MetaField &&mf) noexcept {
+    m_listOfMetaFields.emplace_back(std::move(mf));
+    return *this;
 }
 
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint16_t &v) noexcept {
-    uint64_t _v = v;
-    return toVarInt(o, _v);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, int32_t &v) noexcept {
-    uint64_t _v = toZigZag32(v);
-    return toVarInt(o, _v);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint32_t &v) noexcept {
-    uint64_t _v = v;
-    return toVarInt(o, _v);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, int64_t &v) noexcept {
-    uint64_t _v = toZigZag64(v);
-    return toVarInt(o, _v);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint64_t &v) noexcept {
-    return toVarInt(o, v);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, float &v) noexcept {
-    // Store 4 bytes as little endian encoding.
-    uint32_t _v{0};
-    std::memmove(&_v, &v, sizeof(float));
-    _v = htole32(_v);
-    o.write(reinterpret_cast<const char *>(&_v), sizeof(uint32_t)); // NOLINT
-    return sizeof(uint32_t);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, double &v) noexcept {
-    // Store 8 bytes as little endian encoding.
-    uint64_t _v{0};
-    std::memmove(&_v, &v, sizeof(double));
-    _v = htole64(_v);
-    o.write(reinterpret_cast<const char *>(&_v), sizeof(uint64_t)); // NOLINT
-    return sizeof(uint64_t);
-}
-
-inline std::size_t ToProtoVisitor::encode(std::ostream &o, const std::string &v) noexcept {
-    const std::size_t LENGTH = v.length();
-    std::size_t size         = toVarInt(o, LENGTH);
-    o.write(v.c_str(), static_cast<std::streamsize>(LENGTH)); // LENGTH won't be negative.
-    return size + LENGTH;
-}
-
-inline uint8_t ToProtoVisitor::toZigZag8(int8_t v) noexcept {
-    return static_cast<uint8_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
-}
-
-inline uint16_t ToProtoVisitor::toZigZag16(int16_t v) noexcept {
-    return static_cast<uint16_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
-}
-
-inline uint32_t ToProtoVisitor::toZigZag32(int32_t v) noexcept {
-    return static_cast<uint32_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
-}
-
-inline uint64_t ToProtoVisitor::toZigZag64(int64_t v) noexcept {
-    return static_cast<uint64_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
-}
-
-inline uint64_t ToProtoVisitor::encodeKey(uint32_t fieldIdentifier, uint8_t protoType) noexcept {
-    return (fieldIdentifier << 0x3) | protoType;
+inline const std::vector<MetaMessage::MetaField> &MetaMessage::listOfMetaFields() const noexcept {
+    return m_listOfMetaFields;
 }
 
-inline std::size_t ToProtoVisitor::toVarInt(std::ostream &out, uint64_t v) noexcept {
-    // Minimum size is of the encoded data.
-    std::size_t size{1};
-    uint8_t b{0};
-    while (0x7f < v) {
-        // Use the MSB to indicate value overflow for more bytes to come.
-        b = (static_cast<uint8_t>(v & 0x7f)) | 0x80;
-        out.put(static_cast<char>(b));
-        v >>= 7;
-        size++;
-    }
-    // Write final byte.
-    b = (static_cast<uint8_t>(v)) & 0x7f;
-    out.put(static_cast<char>(b));
-
-    return size;
+inline void MetaMessage::accept(const std::function<void(const MetaMessage &)> &visit) {
+    visit(*this);
 }
 } // namespace cluon
 /*
@@ -11267,80 +11312,1892 @@ inline std::size_t ToProtoVisitor::toVarInt(std::ostream &out, uint64_t v) noexc
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/FromProtoVisitor.hpp"
+//#include "cluon/MessageParser.hpp"
+//#include "cluon/stringtoolbox.hpp"
 
-#include <cstddef>
-#include <cstring>
-#include <utility>
+//#include "cpp-peglib/peglib.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
 
 namespace cluon {
 
-inline void FromProtoVisitor::readBytesFromStream(std::istream &in, std::size_t bytesToReadFromStream, char *buffer) noexcept {
-    if (nullptr != buffer) {
-        const constexpr std::size_t CHUNK_SIZE{1024};
-        std::streamsize bufferPosition{0};
-        std::streamsize extractedBytes{0};
+inline std::pair<std::vector<MetaMessage>, MessageParser::MessageParserErrorCodes> MessageParser::parse(const std::string &input) {
+    const char *grammarMessageSpecificationLanguage = R"(
+        MESSAGES_SPECIFICATION      <- PACKAGE_DECLARATION? MESSAGE_DECLARATION*
+        PACKAGE_DECLARATION         <- 'package' PACKAGE_IDENTIFIER ';'
+        PACKAGE_IDENTIFIER          <- < IDENTIFIER ('.' IDENTIFIER)* >
 
-        while ((0 < bytesToReadFromStream) && in.good()) {
-            // clang-format off
-            in.read(&buffer[static_cast<std::size_t>(bufferPosition)], /* Flawfinder: ignore */ /* Cf. buffer.reserve(...) above.  */
-                    (bytesToReadFromStream > CHUNK_SIZE) ? CHUNK_SIZE : static_cast<std::streamsize>(bytesToReadFromStream));
-            // clang-format on
-            extractedBytes = in.gcount();
-            bufferPosition += extractedBytes;
-            bytesToReadFromStream -= static_cast<std::size_t>(extractedBytes);
-        }
-    }
-}
+        MESSAGE_DECLARATION         <- 'message' MESSAGE_IDENTIFIER MESSAGE_OPTIONS '{' FIELD* '}'
+        MESSAGE_IDENTIFIER          <- < IDENTIFIER ('.' IDENTIFIER)* >
+        MESSAGE_OPTIONS             <- '[' 'id' '=' NATURAL_NUMBER ','? ']'
 
-inline void FromProtoVisitor::decodeFrom(std::istream &in) noexcept {
-    // Reset internal states as this deserializer could be reused.
-    m_mapOfKeyValues.clear();
-    while (in.good()) {
-        // First stage: Read keyFieldType (encoded as VarInt).
-        if (0 < fromVarInt(in, m_keyFieldType)) {
-            // Succeeded to read keyFieldType entry; extract information.
-            m_protoType = static_cast<ProtoConstants>(m_keyFieldType & 0x7);
-            m_fieldId = static_cast<uint32_t>(m_keyFieldType >> 3);
-            switch (m_protoType) {
-                case ProtoConstants::VARINT:
-                {
-                    // Directly decode VarInt value.
-                    fromVarInt(in, m_value);
-                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(m_value));
-                }
-                break;
-                case ProtoConstants::EIGHT_BYTES:
-                {
-                    readBytesFromStream(in, sizeof(double), m_doubleValue.buffer.data());
-                    m_doubleValue.uint64Value = le64toh(m_doubleValue.uint64Value);
-                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(m_doubleValue.doubleValue));
+        FIELD                       <- PRIMITIVE_FIELD
+
+        PRIMITIVE_FIELD             <- PRIMITIVE_TYPE IDENTIFIER ('[' PRIMITIVE_FIELD_OPTIONS ']')? ';'
+        PRIMITIVE_FIELD_OPTIONS     <- PRIMITIVE_FIELD_DEFAULT? ','? NUMERICAL_FIELD_IDENTIFIER?
+        NUMERICAL_FIELD_IDENTIFIER  <- 'id' '=' NATURAL_NUMBER
+        PRIMITIVE_FIELD_DEFAULT     <- 'default' '=' (FLOAT_NUMBER / BOOL / CHARACTER / STRING)
+        PRIMITIVE_TYPE              <- < 'bool' / 'float' / 'double' /
+                                         'char' /
+                                         'bytes' / 'string' /
+                                         'int8' / 'uint8' / 
+                                         'int16' / 'uint16' / 
+                                         'int32' / 'uint32' / 
+                                         'int64' / 'uint64' /
+                                         MESSAGE_TYPE >
+
+        MESSAGE_TYPE                <- < IDENTIFIER ('.' IDENTIFIER)* >
+
+        IDENTIFIER                  <- < [a-zA-Z][a-zA-Z0-9_]* >
+        DIGIT                       <- < [0-9] >
+        NATURAL_NUMBER              <- < [1-9] DIGIT* >
+        FLOAT_NUMBER                <- < ('+' / '-')? DIGIT DIGIT* (('.') DIGIT*)? >
+        BOOL                        <- < 'true' > / < 'false' >
+        STRING                      <- '"' < (!'"'.)* > '"'
+        CHARACTER                   <- '\'' < (!'\'' .) > '\''
+
+        %whitespace                 <- [ \t\r\n]*
+    )";
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Function to check for unique field names.
+    std::function<bool(const peg::Ast &, std::string &, std::vector<std::string> &, std::vector<std::string> &, std::vector<int32_t> &, std::vector<int32_t> &)>
+        check4UniqueFieldNames = [&checkForUniqueFieldNames = check4UniqueFieldNames](const peg::Ast &ast,
+                                                                                      std::string &prefix,
+                                                                                      std::vector<std::string> &messageNames,
+                                                                                      std::vector<std::string> &fieldNames,
+                                                                                      std::vector<int32_t> &numericalMessageIdentifiers,
+                                                                                      std::vector<int32_t> &numericalFieldIdentifiers) {
+            bool retVal = true;
+            // First, we need to visit the children of AST node MESSAGES_SPECIFICATION.
+            if ("MESSAGES_SPECIFICATION" == ast.name) {
+                for (const auto &node : ast.nodes) {
+                    retVal &= checkForUniqueFieldNames(*node, prefix, messageNames, fieldNames, numericalMessageIdentifiers, numericalFieldIdentifiers);
                 }
-                break;
-                case ProtoConstants::FOUR_BYTES:
-                {
-                    readBytesFromStream(in, sizeof(float), m_floatValue.buffer.data());
-                    m_floatValue.uint32Value = le32toh(m_floatValue.uint32Value);
-                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(m_floatValue.floatValue));
+                // Try finding duplicated message identifiers.
+                if (retVal) {
+                    std::sort(std::begin(numericalMessageIdentifiers), std::end(numericalMessageIdentifiers));
+                    int32_t duplicatedMessageIdentifier{-1};
+                    for (auto it{std::begin(numericalMessageIdentifiers)}; it != std::end(numericalMessageIdentifiers); it++) {
+                        if (it + 1 != std::end(numericalMessageIdentifiers)) {
+                            if (std::find(it + 1, std::end(numericalMessageIdentifiers), *it) != std::end(numericalMessageIdentifiers)) {
+                                duplicatedMessageIdentifier = *it;
+                            }
+                        }
+                    }
+                    retVal &= (-1 == duplicatedMessageIdentifier);
+                    if (!retVal) {
+                        std::cerr << "[cluon::MessageParser] Found duplicated numerical message identifier: " << duplicatedMessageIdentifier << '\n';
+                    }
                 }
-                break;
-                case ProtoConstants::LENGTH_DELIMITED:
-                {
-                    fromVarInt(in, m_value);
-                    const std::size_t BYTES_TO_READ_FROM_STREAM{static_cast<std::size_t>(m_value)};
-                    if (m_stringValue.capacity() < BYTES_TO_READ_FROM_STREAM) {
-                        m_stringValue.reserve(BYTES_TO_READ_FROM_STREAM);
+                // Try finding duplicated message names.
+                if (retVal) {
+                    std::sort(std::begin(messageNames), std::end(messageNames));
+                    std::string duplicatedMessageName;
+                    for (auto it{std::begin(messageNames)}; it != std::end(messageNames); it++) {
+                        if (it + 1 != std::end(messageNames)) {
+                            if (std::find(it + 1, std::end(messageNames), *it) != std::end(messageNames)) {
+                                duplicatedMessageName = *it;
+                            }
+                        }
+                    }
+                    retVal &= (duplicatedMessageName.empty());
+                    if (!retVal) {
+                        std::cerr << "[cluon::MessageParser] Found duplicated message name '" << duplicatedMessageName << "'" << '\n';
                     }
-                    readBytesFromStream(in, BYTES_TO_READ_FROM_STREAM, m_stringValue.data());
-                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(std::string(m_stringValue.data(), static_cast<std::size_t>(m_value))));
                 }
-                break;
             }
-        }
-    }
-}
+            // Second, we need to visit the children of AST node MESSAGE_DECLARATION.
+            if ("MESSAGE_DECLARATION" == ast.name) {
+                fieldNames.clear();
+                numericalFieldIdentifiers.clear();
+                prefix = "";
+                retVal = true;
 
-////////////////////////////////////////////////////////////////////////////////
+                for (const auto &node : ast.nodes) {
+                    if ("MESSAGE_IDENTIFIER" == node->name) {
+                        prefix = node->token;
+                        messageNames.push_back(::stringtoolbox::trim(prefix));
+                    } else if ("NATURAL_NUMBER" == node->name) {
+                        numericalMessageIdentifiers.push_back(std::stoi(node->token));
+                    } else if ("PRIMITIVE_FIELD" == node->name) {
+                        retVal &= checkForUniqueFieldNames(*node, prefix, messageNames, fieldNames, numericalMessageIdentifiers, numericalFieldIdentifiers);
+                    }
+                }
+
+                // Try finding duplicated numerical field identifiers.
+                if (retVal) {
+                    std::sort(std::begin(numericalFieldIdentifiers), std::end(numericalFieldIdentifiers));
+                    int32_t duplicatedFieldIdentifier{-1};
+                    for (auto it{std::begin(numericalFieldIdentifiers)}; it != std::end(numericalFieldIdentifiers); it++) {
+                        if (it + 1 != std::end(numericalFieldIdentifiers)) {
+                            if (std::find(it + 1, std::end(numericalFieldIdentifiers), *it) != std::end(numericalFieldIdentifiers)) {
+                                duplicatedFieldIdentifier = *it;
+                            }
+                        }
+                    }
+                    retVal &= (-1 == duplicatedFieldIdentifier);
+                    if (!retVal) {
+                        std::cerr << "[cluon::MessageParser] Found duplicated numerical field identifier in message "
+                                  << "'" << ::stringtoolbox::trim(prefix) << "': " << duplicatedFieldIdentifier << '\n';
+                    }
+                }
+                // Try finding duplicated field names.
+                if (retVal) {
+                    std::sort(std::begin(fieldNames), std::end(fieldNames));
+                    std::string duplicatedFieldName;
+                    for (auto it{std::begin(fieldNames)}; it != std::end(fieldNames); it++) {
+                        if (it + 1 != std::end(fieldNames)) {
+                            if (std::find(it + 1, std::end(fieldNames), *it) != std::end(fieldNames)) {
+                                duplicatedFieldName = *it;
+                            }
+                        }
+                    }
+                    retVal &= (duplicatedFieldName.empty());
+                    if (!retVal) {
+                        std::cerr << "[cluon::MessageParser] Found duplicated field name in message '" << ::stringtoolbox::trim(prefix) << "': '"
+                                  << duplicatedFieldName << "'" << '\n';
+                    }
+                }
+            }
+            // Within AST node MESSAGE_DECLARATION, we have PRIMITIVE_FIELD from
+            // which we need to extract the field "token".
+            if (ast.name == "PRIMITIVE_FIELD") {
+                // Extract the value of entry "IDENTIFIER".
+                auto nodeIdentifier = std::find_if(std::begin(ast.nodes), std::end(ast.nodes), [](auto a) { return (a->name == "IDENTIFIER"); });
+                if (nodeIdentifier != std::end(ast.nodes)) {
+                    fieldNames.push_back((*nodeIdentifier)->token);
+                }
+
+                // Visit this node's children to check for duplicated numerical identifiers.
+                for (const auto &node : ast.nodes) {
+                    retVal &= checkForUniqueFieldNames(*node, prefix, messageNames, fieldNames, numericalMessageIdentifiers, numericalFieldIdentifiers);
+                }
+            }
+            // Within AST node PRIMITIVE_FIELD, we have PRIMITIVE_FIELD_OPTIONS from
+            // which we need to extract the field "token".
+            if (ast.name == "PRIMITIVE_FIELD_OPTIONS") {
+                // Extract the value of entry "IDENTIFIER".
+                auto nodeNumericalFieldIdentifier
+                    = std::find_if(std::begin(ast.nodes), std::end(ast.nodes), [](auto a) { return (a->name == "NATURAL_NUMBER"); });
+                if (nodeNumericalFieldIdentifier != std::end(ast.nodes)) {
+                    numericalFieldIdentifiers.push_back(std::stoi((*nodeNumericalFieldIdentifier)->token));
+                }
+            }
+
+            return retVal;
+        };
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Function to transform AST into list of MetaMessages.
+    std::function<void(const peg::Ast &, std::vector<MetaMessage> &)> transform2MetaMessages
+        = [](const peg::Ast &ast, std::vector<MetaMessage> &listOfMetaMessages) {
+              // "Inner"-lambda to handle various types of message declarations.
+              auto createMetaMessage = [](const peg::Ast &_node, std::string _packageName) -> MetaMessage {
+                  MetaMessage mm;
+                  mm.packageName(::stringtoolbox::trim(_packageName));
+                  uint32_t fieldIdentifierCounter{0};
+                  for (const auto &e : _node.nodes) {
+                      if ("MESSAGE_IDENTIFIER" == e->name) {
+                          std::string _messageName = e->token;
+                          mm.messageName(::stringtoolbox::trim(_messageName));
+                      } else if ("NATURAL_NUMBER" == e->name) {
+                          mm.messageIdentifier(std::stoi(e->token));
+                      } else if ("PRIMITIVE_FIELD" == e->name) {
+                          std::string _fieldName;
+                          auto fieldName = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "IDENTIFIER"); });
+                          if (fieldName != std::end(e->nodes)) {
+                              _fieldName = (*fieldName)->token;
+                          }
+
+                          std::string _fieldDataType;
+                          auto fieldDataType = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "PRIMITIVE_TYPE"); });
+                          if (fieldDataType != std::end(e->nodes)) {
+                              _fieldDataType = (*fieldDataType)->token;
+                          }
+
+                          fieldIdentifierCounter++; // Automatically count expected field identifiers in case of missing
+                                                    // field options.
+                          std::string _fieldIdentifier;
+                          auto fieldIdentifier = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "NATURAL_NUMBER"); });
+                          if (fieldIdentifier != std::end(e->nodes)) {
+                              _fieldIdentifier = (*fieldIdentifier)->token;
+                          }
+
+                          std::string _fieldDefaultInitializerValue;
+                          auto primitiveFieldOptions
+                              = std::find_if(std::begin(e->nodes), std::end(e->nodes), [](auto a) { return (a->name == "PRIMITIVE_FIELD_OPTIONS"); });
+                          if (primitiveFieldOptions != std::end(e->nodes)) {
+                              for (const auto &f : (*primitiveFieldOptions)->nodes) {
+                                  if ("NATURAL_NUMBER" != f->name) {
+                                      if ("STRING" == f->name) {
+                                          _fieldDefaultInitializerValue = "\"" + f->token + "\""; // NOLINT
+                                      } else if ("CHARACTER" == f->name) {
+                                          _fieldDefaultInitializerValue = "'" + f->token + "'";
+                                      } else {
+                                          _fieldDefaultInitializerValue = f->token;
+                                      }
+                                  }
+                              }
+                          }
+
+                          std::map<std::string, MetaMessage::MetaField::MetaFieldDataTypes> STRING_TO_DATATYPE_MAP = {
+                              {"bool", MetaMessage::MetaField::BOOL_T},
+                              {"char", MetaMessage::MetaField::CHAR_T},
+                              {"uint8", MetaMessage::MetaField::UINT8_T},
+                              {"int8", MetaMessage::MetaField::INT8_T},
+                              {"uint16", MetaMessage::MetaField::UINT16_T},
+                              {"int16", MetaMessage::MetaField::INT16_T},
+                              {"uint32", MetaMessage::MetaField::UINT32_T},
+                              {"int32", MetaMessage::MetaField::INT32_T},
+                              {"uint64", MetaMessage::MetaField::UINT64_T},
+                              {"int64", MetaMessage::MetaField::INT64_T},
+                              {"float", MetaMessage::MetaField::FLOAT_T},
+                              {"double", MetaMessage::MetaField::DOUBLE_T},
+                              {"string", MetaMessage::MetaField::STRING_T},
+                              {"bytes", MetaMessage::MetaField::BYTES_T},
+                          };
+
+                          MetaMessage::MetaField mf;
+                          if (0 < STRING_TO_DATATYPE_MAP.count(_fieldDataType)) {
+                              mf.fieldDataType(STRING_TO_DATATYPE_MAP[_fieldDataType]);
+                          } else {
+                              mf.fieldDataType(MetaMessage::MetaField::MESSAGE_T);
+                          }
+                          mf.fieldDataTypeName(::stringtoolbox::trim(_fieldDataType));
+                          mf.fieldName(::stringtoolbox::trim(_fieldName));
+                          mf.fieldIdentifier(
+                              (!_fieldIdentifier.empty() ? static_cast<uint32_t>(std::stoi(::stringtoolbox::trim(_fieldIdentifier))) : fieldIdentifierCounter));
+                          mf.defaultInitializationValue(_fieldDefaultInitializerValue);
+                          mm.add(std::move(mf));
+                      }
+                  }
+                  return mm;
+              };
+
+              ////////////////////////////////////////////////////////////////////////
+
+              // Case: "package XYZ" present.
+              if ("MESSAGES_SPECIFICATION" == ast.name) {
+                  // Extract the value of entry "PACKAGE_IDENTIFIER".
+                  auto nodeIdentifier = std::find_if(std::begin(ast.nodes), std::end(ast.nodes), [](auto a) { return (a->name == "PACKAGE_IDENTIFIER"); });
+                  std::string packageName;
+                  if (nodeIdentifier != std::end(ast.nodes)) {
+                      packageName = (*nodeIdentifier)->token;
+                  }
+
+                  // Extract the value of entry "MESSAGE_DECLARATION".
+                  for (const auto &node : ast.nodes) {
+                      if (node->name == "MESSAGE_DECLARATION") {
+                          listOfMetaMessages.emplace_back(createMetaMessage(*node, packageName));
+                      }
+                  }
+              } else {
+                  // In case we only have one single message and no package.
+                  listOfMetaMessages.emplace_back(createMetaMessage(ast, ""));
+              }
+          };
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    peg::parser p(grammarMessageSpecificationLanguage);
+    p.enable_ast();
+    p.log = [](size_t row, size_t col, const std::string &msg) {
+        std::cerr << "[cluon::MessageParser] Parsing error:" << row << ":" << col << ": " << msg << '\n';
+    };
+
+    std::pair<std::vector<MetaMessage>, MessageParserErrorCodes> retVal{};
+    std::string inputWithoutComments{input};
+    try {
+        const std::string MATCH_COMMENTS_REGEX = R"(/\*([\s\S]*?)\*/|//.*)";
+        inputWithoutComments                   = std::regex_replace(input, std::regex(MATCH_COMMENTS_REGEX), ""); // NOLINT
+    } catch (std::regex_error &) {                                                                                // LCOV_EXCL_LINE
+    } catch (std::bad_cast &) {                                                                                   // LCOV_EXCL_LINE
+    }
+    try {
+        std::vector<MetaMessage> listOfMetaMessages{};
+        std::shared_ptr<peg::Ast> ast{};
+        if (p.parse(inputWithoutComments.c_str(), ast)) {
+            ast = peg::AstOptimizer(true).optimize(ast);
+            {
+                std::string tmpPrefix;
+                std::vector<std::string> tmpMessageNames{};
+                std::vector<std::string> tmpFieldNames{};
+                std::vector<int32_t> tmpNumericalMessageIdentifiers{};
+                std::vector<int32_t> tmpNumericalFieldIdentifiers{};
+                if (check4UniqueFieldNames(*ast, tmpPrefix, tmpMessageNames, tmpFieldNames, tmpNumericalMessageIdentifiers, tmpNumericalFieldIdentifiers)) {
+                    transform2MetaMessages(*ast, listOfMetaMessages);
+                    retVal = {listOfMetaMessages, MessageParserErrorCodes::NO_MESSAGEPARSER_ERROR};
+                } else {
+                    retVal = {listOfMetaMessages, MessageParserErrorCodes::DUPLICATE_IDENTIFIERS};
+                }
+            }
+        } else {
+            retVal = {listOfMetaMessages, MessageParserErrorCodes::SYNTAX_ERROR};
+        }
+    } catch (std::bad_cast &) { // LCOV_EXCL_LINE
+    }
+    return retVal;
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/TerminateHandler.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace cluon {
+
+inline void cluon_handleExit() {
+    TerminateHandler::instance().isTerminated.store(true);
+}
+
+inline void cluon_handleSignal(int32_t /*signal*/) {       // LCOV_EXCL_LINE
+    TerminateHandler::instance().isTerminated.store(true); // LCOV_EXCL_LINE
+}
+
+inline TerminateHandler::TerminateHandler() noexcept {
+    if (0 != std::atexit(cluon_handleExit)) {
+        std::cerr << "[cluon::TerminateHandler] Failed to register cluon_exitHandler()." << std::endl; // LCOV_EXCL_LINE
+    }
+
+#ifdef WIN32
+    if (SIG_ERR == ::signal(SIGINT, &cluon_handleSignal)) {
+        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGINT." << std::endl;
+    }
+    if (SIG_ERR == ::signal(SIGTERM, &cluon_handleSignal)) {
+        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGTERM." << std::endl;
+    }
+#else
+    std::memset(&m_signalHandler, 0, sizeof(m_signalHandler));
+    m_signalHandler.sa_handler = &cluon_handleSignal;
+
+    if (::sigaction(SIGINT, &m_signalHandler, NULL) < 0) {
+        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGINT." << std::endl; // LCOV_EXCL_LINE
+    }
+    if (::sigaction(SIGTERM, &m_signalHandler, NULL) < 0) {
+        std::cerr << "[cluon::TerminateHandler] Failed to register signal SIGTERM." << std::endl; // LCOV_EXCL_LINE
+    }
+#endif
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2019  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/IPv4Tools.hpp"
+
+// clang-format off
+#ifdef WIN32
+    #include <Winsock2.h> // for WSAStartUp
+    #include <ws2tcpip.h>
+    #include <iostream>
+#else
+    #include <arpa/inet.h>
+    #include <netdb.h>
+
+    #if defined(BSD)
+        #include <netinet/in.h>
+        #include <sys/socket.h>
+    #endif
+#endif
+// clang-format on
+
+#include <cstring>
+
+namespace cluon {
+
+inline std::string getIPv4FromHostname(const std::string &hostname) noexcept {
+#ifdef WIN32
+    // Load Winsock 2.2 DLL.
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "[cluon::getIPv4FromHostname] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
+    }
+#endif
+    std::string result{""};
+    if (!hostname.empty()) {
+        struct addrinfo hint;
+        {
+            std::memset(&hint, 1, sizeof(struct addrinfo));
+            hint.ai_flags = AI_CANONNAME;
+            hint.ai_family = AF_INET;
+            hint.ai_socktype = 0;
+            hint.ai_protocol = 0;
+            hint.ai_addrlen = 0;
+            hint.ai_canonname = nullptr;
+            hint.ai_addr = nullptr;
+            hint.ai_next = nullptr;
+        }
+
+        struct addrinfo *listOfHosts{nullptr};
+        if (0 == getaddrinfo(hostname.c_str(), nullptr, &hint, &listOfHosts)) {
+            for(struct addrinfo *e = listOfHosts; nullptr != listOfHosts; listOfHosts = listOfHosts->ai_next) {
+                if (nullptr != e) {
+                    if (AF_INET == e->ai_family) {
+                        struct sockaddr_in *sinp = reinterpret_cast<struct sockaddr_in*>(e->ai_addr);
+                        char buf[INET_ADDRSTRLEN];
+                        const char *addr = inet_ntop(AF_INET, &sinp->sin_addr, buf, INET_ADDRSTRLEN);
+                        if ( (nullptr != addr) && (result.empty()) ) {
+                            result = std::string(addr);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (nullptr != listOfHosts) {
+            freeaddrinfo(listOfHosts);
+        }
+    }
+#ifdef WIN32
+    WSACleanup();
+#endif
+    return result;
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/UDPSender.hpp"
+//#include "cluon/IPv4Tools.hpp"
+//#include "cluon/UDPPacketSizeConstraints.hpp"
+
+// clang-format off
+#ifdef WIN32
+    #include <iostream>
+#else
+    #include <arpa/inet.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+// clang-format on
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace cluon {
+
+inline UDPSender::UDPSender(const std::string &sendToAddress, uint16_t sendToPort) noexcept
+    : m_socketMutex()
+    , m_sendToAddress() {
+    // Decompose given address into tokens to check validity with numerical IPv4 address.
+    std::string tmp{cluon::getIPv4FromHostname(sendToAddress)};
+    std::replace(tmp.begin(), tmp.end(), '.', ' ');
+    std::istringstream sstr{tmp};
+    std::vector<int> sendToAddressTokens{std::istream_iterator<int>(sstr), std::istream_iterator<int>()};
+
+    if (!sendToAddress.empty() && (4 == sendToAddressTokens.size())
+        && !(std::end(sendToAddressTokens) != std::find_if(sendToAddressTokens.begin(), sendToAddressTokens.end(), [](int a) { return (a < 0) || (a > 255); }))
+        && (0 < sendToPort)) {
+        ::memset(&m_sendToAddress, 0, sizeof(m_sendToAddress));
+        m_sendToAddress.sin_addr.s_addr = ::inet_addr(sendToAddress.c_str());
+        m_sendToAddress.sin_family      = AF_INET;
+        m_sendToAddress.sin_port        = htons(sendToPort);
+
+#ifdef WIN32
+        // Load Winsock 2.2 DLL.
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            std::cerr << "[cluon::UDPSender] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
+        }
+#endif
+
+        m_socket = ::socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+        // Bind to random address/port but store sender port.
+        if (!(m_socket < 0)) {
+            struct sockaddr_in sendFromAddress;
+            std::memset(&sendFromAddress, 0, sizeof(sendFromAddress));
+            sendFromAddress.sin_family = AF_INET;
+            sendFromAddress.sin_port   = 0;                                                                              // Randomly choose a port to bind.
+            if (0 == ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&sendFromAddress), sizeof(sendFromAddress))) { // NOLINT
+                struct sockaddr tmpAddr;
+                socklen_t length = sizeof(tmpAddr);
+                if (0 == ::getsockname(m_socket, &tmpAddr, &length)) {
+                    struct sockaddr_in tmpAddrIn;
+                    std::memcpy(&tmpAddrIn, &tmpAddr, sizeof(tmpAddrIn)); /* Flawfinder: ignore */ // NOLINT
+                    m_portToSentFrom = ntohs(tmpAddrIn.sin_port);
+                }
+            }
+        }
+
+#ifdef WIN32
+        if (m_socket < 0) {
+            std::cerr << "[cluon::UDPSender] Error while creating socket: " << WSAGetLastError() << std::endl;
+            WSACleanup();
+        }
+#endif
+    }
+}
+
+inline UDPSender::~UDPSender() noexcept {
+    if (!(m_socket < 0)) {
+#ifdef WIN32
+        ::shutdown(m_socket, SD_BOTH);
+        ::closesocket(m_socket);
+        WSACleanup();
+#else
+        ::shutdown(m_socket, SHUT_RDWR); // Disallow further read/write operations.
+        ::close(m_socket);
+#endif
+    }
+    m_socket = -1;
+}
+
+inline uint16_t UDPSender::getSendFromPort() const noexcept {
+    return m_portToSentFrom;
+}
+
+inline std::pair<ssize_t, int32_t> UDPSender::send(std::string &&data) const noexcept {
+    if (-1 == m_socket) {
+        return {-1, EBADF};
+    }
+
+    if (data.empty()) {
+        return {0, 0};
+    }
+
+    constexpr uint16_t MAX_LENGTH = static_cast<uint16_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER);
+    if (MAX_LENGTH < data.size()) {
+        return {-1, E2BIG};
+    }
+
+    std::lock_guard<std::mutex> lck(m_socketMutex);
+    ssize_t bytesSent = ::sendto(m_socket,
+                                 data.c_str(),
+                                 data.length(),
+                                 0,
+                                 reinterpret_cast<const struct sockaddr *>(&m_sendToAddress), // NOLINT
+                                 sizeof(m_sendToAddress));
+
+    return {bytesSent, (0 > bytesSent ? errno : 0)};
+}
+
+inline std::pair<ssize_t, int32_t> UDPSender::send(std::vector<std::string> &&datagrams) const noexcept {
+    if (-1 == m_socket) {
+        return {-1, EBADF};
+    }
+
+    constexpr uint16_t MAX_LENGTH = static_cast<uint16_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER);
+    ssize_t bytesSent{0};
+    int32_t error{0};
+    auto isSendable = [MAX_LENGTH](const std::string &d) { return !d.empty() && (MAX_LENGTH >= d.size()); };
+    if (std::any_of(datagrams.begin(), datagrams.end(), [isSendable](const std::string &d) { return !isSendable(d); })) {
+        error = E2BIG;
+    }
+
+    std::lock_guard<std::mutex> lck(m_socketMutex);
+#ifdef __linux__
+    constexpr std::size_t BATCH_SIZE{64};
+    struct mmsghdr messages[BATCH_SIZE];
+    struct iovec iovecs[BATCH_SIZE];
+    std::size_t next{0};
+    while (next < datagrams.size()) {
+        unsigned int count{0};
+        for (; (next < datagrams.size()) && (count < BATCH_SIZE); next++) {
+            if (isSendable(datagrams[next])) {
+                iovecs[count].iov_base = const_cast<char *>(datagrams[next].data());
+                iovecs[count].iov_len  = datagrams[next].size();
+                ::memset(&messages[count], 0, sizeof(struct mmsghdr));
+                messages[count].msg_hdr.msg_name    = const_cast<struct sockaddr_in *>(&m_sendToAddress);
+                messages[count].msg_hdr.msg_namelen = sizeof(m_sendToAddress);
+                messages[count].msg_hdr.msg_iov     = &iovecs[count];
+                messages[count].msg_hdr.msg_iovlen  = 1;
+                count++;
+            }
+        }
+
+        // sendmmsg might send only the first packets of a batch.
+        unsigned int sent{0};
+        while (sent < count) {
+            const int RETVAL{::sendmmsg(m_socket, &messages[sent], count - sent, 0)};
+            if (0 > RETVAL) {
+                if (EINTR == errno) {
+                    continue;
+                }
+                if (0 == error) {
+                    error = errno;
+                }
+                break;
+            }
+            for (int i{0}; i < RETVAL; i++) {
+                bytesSent += static_cast<ssize_t>(messages[sent + static_cast<unsigned int>(i)].msg_len);
+            }
+            sent += static_cast<unsigned int>(RETVAL);
+        }
+        if (sent < count) {
+            break;
+        }
+    }
+#else
+    for (const auto &d : datagrams) {
+        if (isSendable(d)) {
+            const auto RETVAL = ::sendto(m_socket,
+                                         d.c_str(),
+                                         d.length(),
+                                         0,
+                                         reinterpret_cast<const struct sockaddr *>(&m_sendToAddress), // NOLINT
+                                         sizeof(m_sendToAddress));
+            if (0 > RETVAL) {
+                if (0 == error) {
+                    error = errno;
+                }
+                break;
+            }
+            bytesSent += static_cast<ssize_t>(RETVAL);
+        }
+    }
+#endif
+    return {bytesSent, error};
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/UDPReceiver.hpp"
+//#include "cluon/IPv4Tools.hpp"
+//#include "cluon/TerminateHandler.hpp"
+//#include "cluon/UDPPacketSizeConstraints.hpp"
+
+// clang-format off
+#ifdef WIN32
+    #include <cstdio>
+    #include <cerrno>
+
+    #include <winsock2.h>
+    #include <iphlpapi.h>
+    #include <ws2tcpip.h>
+
+    #include <iostream>
+#else
+    #ifdef __linux__
+        #include <linux/sockios.h>
+    #endif
+
+    #include <arpa/inet.h>
+    #include <sys/ioctl.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#ifndef WIN32
+    #include <ifaddrs.h>
+    #include <netdb.h>
+#endif
+// clang-format on
+
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace cluon {
+
+inline UDPReceiver::UDPReceiver(const std::string &receiveFromAddress,
+                         uint16_t receiveFromPort,
+                         std::function<void(std::string &&, std::string &&, std::chrono::system_clock::time_point &&)> delegate,
+                         uint16_t localSendFromPort,
+                         std::function<bool(const char *, std::size_t, uint16_t, bool)> filter) noexcept
+    : m_localSendFromPort(localSendFromPort)
+    , m_receiveFromAddress()
+    , m_mreq()
+    , m_readFromSocketThread()
+    , m_delegate(std::move(delegate))
+    , m_filter(std::move(filter)) {
+    // Decompose given address string to check validity with numerical IPv4 address.
+    std::string tmp{cluon::getIPv4FromHostname(receiveFromAddress)};
+    std::replace(tmp.begin(), tmp.end(), '.', ' ');
+    std::istringstream sstr{tmp};
+    std::vector<int> receiveFromAddressTokens{std::istream_iterator<int>(sstr), std::istream_iterator<int>()};
+
+    if ((!receiveFromAddress.empty()) && (4 == receiveFromAddressTokens.size())
+        && !(std::end(receiveFromAddressTokens)
+             != std::find_if(receiveFromAddressTokens.begin(), receiveFromAddressTokens.end(), [](int a) { return (a < 0) || (a > 255); }))
+        && (0 < receiveFromPort)) {
+        // Check for valid IP address.
+        struct sockaddr_in tmpSocketAddress {};
+        const bool isValid = (0 < ::inet_pton(AF_INET, receiveFromAddress.c_str(), &(tmpSocketAddress.sin_addr))) && (224 > receiveFromAddressTokens[0]);
+
+        // Check for UDP multicast, i.e., IP address range [225.0.0.1 - 239.255.255.255].
+        m_isMulticast = (((224 < receiveFromAddressTokens[0]) && (receiveFromAddressTokens[0] <= 239))
+                         && ((0 <= receiveFromAddressTokens[1]) && (receiveFromAddressTokens[1] <= 255))
+                         && ((0 <= receiveFromAddressTokens[2]) && (receiveFromAddressTokens[2] <= 255))
+                         && ((1 <= receiveFromAddressTokens[3]) && (receiveFromAddressTokens[3] <= 255)));
+
+        std::memset(&m_receiveFromAddress, 0, sizeof(m_receiveFromAddress));
+#ifdef WIN32
+        // According to http://www.sockets.com/err_lst1.htm, the binding is
+        // different on Windows opposed to POSIX when using the real address
+        // here; thus, we need to use INADDR_ANY.
+        m_receiveFromAddress.sin_addr.s_addr = (m_isMulticast ? htonl(INADDR_ANY) : ::inet_addr(receiveFromAddress.c_str()));
+#else
+        m_receiveFromAddress.sin_addr.s_addr = ::inet_addr(receiveFromAddress.c_str());
+#endif
+        m_receiveFromAddress.sin_family = AF_INET;
+        m_receiveFromAddress.sin_port   = htons(receiveFromPort);
+
+#ifdef WIN32
+        // Load Winsock 2.2 DLL.
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            std::cerr << "[cluon::UDPReceiver] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
+        }
+#endif
+
+        m_socket = ::socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+#ifdef WIN32
+        if (m_socket < 0) {
+            std::cerr << "[cluon::UDPReceiver] Error while creating socket: " << WSAGetLastError() << std::endl;
+            WSACleanup();
+        }
+#endif
+
+        if (!(m_socket < 0)) {
+            // Allow reusing of ports by multiple calls with same address/port.
+            uint32_t YES = 1;
+            // clang-format off
+            auto retVal = ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&YES), sizeof(YES)); // NOLINT
+            // clang-format on
+            if (0 > retVal) {
+#ifdef WIN32 // LCOV_EXCL_LINE
+                auto errorCode = WSAGetLastError();
+#else
+                auto errorCode = errno; // LCOV_EXCL_LINE
+#endif                                  // LCOV_EXCL_LINE
+                closeSocket(errorCode); // LCOV_EXCL_LINE
+            }
+        }
+
+        if (!(m_socket < 0)) {
+            // Trying to enable non_blocking mode.
+#ifdef WIN32 // LCOV_EXCL_LINE
+            u_long nonBlocking = 1;
+            m_isBlockingSocket = !(NO_ERROR == ::ioctlsocket(m_socket, FIONBIO, &nonBlocking));
+#else
+            const int FLAGS    = ::fcntl(m_socket, F_GETFL, 0);
+            m_isBlockingSocket = !(0 == ::fcntl(m_socket, F_SETFL, FLAGS | O_NONBLOCK));
+#endif
+        }
+
+        if (!(m_socket < 0)) {
+            // Trying to enable non_blocking mode.
+#ifdef WIN32 // LCOV_EXCL_LINE
+            u_long nonBlocking = 1;
+            m_isBlockingSocket = !(NO_ERROR == ::ioctlsocket(m_socket, FIONBIO, &nonBlocking));
+#else
+            const int FLAGS    = ::fcntl(m_socket, F_GETFL, 0);
+            m_isBlockingSocket = !(0 == ::fcntl(m_socket, F_SETFL, FLAGS | O_NONBLOCK));
+#endif
+        }
+
+        if (!(m_socket < 0)) {
+            // Try setting receiving buffer.
+            int recvBuffer{26214400};
+            auto retVal = ::setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<char *>(&recvBuffer), sizeof(recvBuffer));
+            if (retVal < 0) {
+#ifdef WIN32 // LCOV_EXCL_LINE
+                auto errorCode = WSAGetLastError();
+#else
+                auto errorCode = errno; // LCOV_EXCL_LINE
+#endif                                                                                                                                       // LCOV_EXCL_LINE
+                std::cerr << "[cluon::UDPReceiver] Error while trying to set SO_RCVBUF to " << recvBuffer << ": " << errorCode << std::endl; // LCOV_EXCL_LINE
+            }
+        }
+
+        if (!(m_socket < 0)) {
+            // Bind to receive address/port.
+            // clang-format off
+            auto retVal = ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&m_receiveFromAddress), sizeof(m_receiveFromAddress)); // NOLINT
+            // clang-format on
+            if (0 > retVal) {
+#ifdef WIN32 // LCOV_EXCL_LINE
+                auto errorCode = WSAGetLastError();
+#else
+                auto errorCode = errno; // LCOV_EXCL_LINE
+#endif                                  // LCOV_EXCL_LINE
+                closeSocket(errorCode); // LCOV_EXCL_LINE
+            }
+        }
+
+        if (!(m_socket < 0)) {
+            if (m_isMulticast) {
+                // Join the multicast group.
+                m_mreq.imr_multiaddr.s_addr = ::inet_addr(receiveFromAddress.c_str());
+                m_mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+                // clang-format off
+                auto retval                 = ::setsockopt(m_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<char *>(&m_mreq), sizeof(m_mreq)); // NOLINT
+                // clang-format on
+                if (0 > retval) { // LCOV_EXCL_LINE
+#ifdef WIN32                      // LCOV_EXCL_LINE
+                    closeSocket(WSAGetLastError());
+#else
+                    closeSocket(errno); // LCOV_EXCL_LINE
+#endif // LCOV_EXCL_LINE
+                }
+            } else if (!isValid) {
+                closeSocket(EBADF);
+            }
+        }
+
+        // Fill list of local IP address to avoid sending data to ourselves.
+        if (!(m_socket < 0)) {
+#ifdef WIN32
+            DWORD size{0};
+            if (ERROR_BUFFER_OVERFLOW == GetAdaptersAddresses(AF_UNSPEC, GAA_FLAG_INCLUDE_PREFIX, NULL, NULL, &size)) {
+                PIP_ADAPTER_ADDRESSES adapters = reinterpret_cast<PIP_ADAPTER_ADDRESSES>(malloc(size));
+                if (ERROR_SUCCESS == GetAdaptersAddresses(AF_UNSPEC, GAA_FLAG_INCLUDE_PREFIX, NULL, adapters, &size)) {
+                    for (PIP_ADAPTER_ADDRESSES adapter = adapters; nullptr != adapter; adapter = adapter->Next) {
+                        for (PIP_ADAPTER_UNICAST_ADDRESS unicastAddress = adapter->FirstUnicastAddress; unicastAddress != NULL;
+                             unicastAddress                             = unicastAddress->Next) {
+                            if (AF_INET == unicastAddress->Address.lpSockaddr->sa_family) {
+                                ::getnameinfo(unicastAddress->Address.lpSockaddr, unicastAddress->Address.iSockaddrLength, nullptr, 0, NULL, 0, NI_NUMERICHOST);
+                                std::memcpy(&tmpSocketAddress, unicastAddress->Address.lpSockaddr, sizeof(tmpSocketAddress)); /* Flawfinder: ignore */ // NOLINT
+                                const unsigned long LOCAL_IP = tmpSocketAddress.sin_addr.s_addr;
+                                m_listOfLocalIPAddresses.insert(LOCAL_IP);
+                            }
+                        }
+                    }
+                }
+                free(adapters);
+            }
+#else
+            struct ifaddrs *interfaceAddress;
+            if (0 == ::getifaddrs(&interfaceAddress)) {
+                for (struct ifaddrs *it = interfaceAddress; nullptr != it; it = it->ifa_next) {
+                    if ((nullptr != it->ifa_addr) && (it->ifa_addr->sa_family == AF_INET)) {
+                        if (0 == ::getnameinfo(it->ifa_addr, sizeof(struct sockaddr_in), nullptr, 0, nullptr, 0, NI_NUMERICHOST)) {
+                            std::memcpy(&tmpSocketAddress, it->ifa_addr, sizeof(tmpSocketAddress)); /* Flawfinder: ignore */ // NOLINT
+                            const unsigned long LOCAL_IP = tmpSocketAddress.sin_addr.s_addr;
+                            m_listOfLocalIPAddresses.insert(LOCAL_IP);
+                        }
+                    }
+                }
+                ::freeifaddrs(interfaceAddress);
+            }
+#endif
+        }
+
+        if (!(m_socket < 0)) {
+            // Constructing the receiving thread could fail.
+            try {
+                m_readFromSocketThread = std::thread(&UDPReceiver::readFromSocket, this);
+
+                // Let the operating system spawn the thread.
+                using namespace std::literals::chrono_literals; // NOLINT
+                do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
+            } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
+
+            try {
+                m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>(
+                    [this](PipelineEntry &&entry) { this->m_delegate(std::move(entry.m_data), std::move(entry.m_from), std::move(entry.m_sampleTime)); });
+                if (m_pipeline) {
+                    // Let the operating system spawn the thread.
+                    using namespace std::literals::chrono_literals; // NOLINT
+                    do { std::this_thread::sleep_for(1ms); } while (!m_pipeline->isRunning());
+                }
+            } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline UDPReceiver::~UDPReceiver() noexcept {
+    {
+        m_readFromSocketThreadRunning.store(false);
+
+        // Joining the thread could fail.
+        try {
+            if (m_readFromSocketThread.joinable()) {
+                m_readFromSocketThread.join();
+            }
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
+
+    m_pipeline.reset();
+
+    closeSocket(0);
+}
+
+inline void UDPReceiver::closeSocket(int errorCode) noexcept {
+    if (0 != errorCode) {
+        std::cerr << "[cluon::UDPReceiver] Failed to perform socket operation: ";
+#ifdef WIN32
+        std::cerr << errorCode << std::endl;
+#else
+        std::cerr << ::strerror(errorCode) << " (" << errorCode << ")" << std::endl;
+#endif
+    }
+
+    if (!(m_socket < 0)) {
+        if (m_isMulticast) {
+            // clang-format off
+            auto retVal = ::setsockopt(m_socket, IPPROTO_IP, IP_DROP_MEMBERSHIP, reinterpret_cast<char *>(&m_mreq), sizeof(m_mreq)); // NOLINT
+            // clang-format on
+            if (0 > retVal) {                                                                         // LCOV_EXCL_LINE
+                std::cerr << "[cluon::UDPReceiver] Failed to drop multicast membership" << std::endl; // LCOV_EXCL_LINE
+            }
+        }
+
+#ifdef WIN32
+        ::shutdown(m_socket, SD_BOTH);
+        ::closesocket(m_socket);
+        WSACleanup();
+#else
+        ::shutdown(m_socket, SHUT_RDWR); // Disallow further read/write operations.
+        ::close(m_socket);
+#endif
+    }
+    m_socket = -1;
+}
+
+inline bool UDPReceiver::isRunning() const noexcept {
+    return (m_readFromSocketThreadRunning.load() && !TerminateHandler::instance().isTerminated.load());
+}
+
+inline void UDPReceiver::readFromSocket() noexcept {
+    // Create buffer to store data from socket.
+    constexpr uint16_t MAX_LENGTH = static_cast<uint16_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER);
+    std::array<char, MAX_LENGTH> buffer{};
+
+    struct timeval timeout {};
+
+    // Define file descriptor set to watch for read operations.
+    fd_set setOfFiledescriptorsToReadFrom{};
+
+    // Sender address and port.
+    constexpr uint16_t MAX_ADDR_SIZE{1024};
+    std::array<char, MAX_ADDR_SIZE> remoteAddress{};
+
+    struct sockaddr_storage remote {};
+    socklen_t addrLength{sizeof(remote)};
+
+    // Indicate to main thread that we are ready.
+    m_readFromSocketThreadRunning.store(true);
+
+    while (m_readFromSocketThreadRunning.load()) {
+        // Define timeout for select system call. The timeval struct must be
+        // reinitialized for every select call as it might be modified containing
+        // the actual time slept.
+        timeout.tv_sec  = 0;
+        timeout.tv_usec = 20 * 1000; // Check for new data with 50Hz.
+
+        FD_ZERO(&setOfFiledescriptorsToReadFrom);          // NOLINT
+        FD_SET(m_socket, &setOfFiledescriptorsToReadFrom); // NOLINT
+        ::select(m_socket + 1, &setOfFiledescriptorsToReadFrom, nullptr, nullptr, &timeout);
+
+        ssize_t totalBytesRead{0};
+        if (FD_ISSET(m_socket, &setOfFiledescriptorsToReadFrom)) { // NOLINT
+            ssize_t bytesRead{0};
+            do {
+                bytesRead = ::recvfrom(m_socket,
+                                       buffer.data(),
+                                       buffer.max_size(),
+                                       0,
+                                       reinterpret_cast<struct sockaddr *>(&remote), // NOLINT
+                                       reinterpret_cast<socklen_t *>(&addrLength));  // NOLINT
+
+                if ((0 < bytesRead) && (nullptr != m_delegate)) {
+                    const unsigned long RECVFROM_IP{reinterpret_cast<struct sockaddr_in *>(&remote)->sin_addr.s_addr}; // NOLINT
+                    const uint16_t RECVFROM_PORT{ntohs(reinterpret_cast<struct sockaddr_in *>(&remote)->sin_port)};    // NOLINT
+
+                    // Check if the bytes actually came from us.
+                    bool sentFromUs{false};
+                    bool sentFromLocalIP{false};
+                    {
+                        auto pos        = m_listOfLocalIPAddresses.find(RECVFROM_IP);
+                        sentFromLocalIP = (pos != m_listOfLocalIPAddresses.end() && (*pos == RECVFROM_IP));
+                        sentFromUs      = sentFromLocalIP && (m_localSendFromPort == RECVFROM_PORT);
+                    }
+
+                    // Create a pipeline entry to be processed concurrently.
+                    if (!sentFromUs && ((nullptr == m_filter) || m_filter(buffer.data(), static_cast<std::size_t>(bytesRead), RECVFROM_PORT, sentFromLocalIP))) {
+#ifdef __linux__
+                        std::chrono::system_clock::time_point timestamp;
+                        struct timeval receivedTimeStamp {};
+                        if (0 == ::ioctl(m_socket, SIOCGSTAMP, &receivedTimeStamp)) { // NOLINT
+                            // Transform struct timeval to C++ chrono.
+                            std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds> transformedTimePoint(
+                                std::chrono::microseconds(receivedTimeStamp.tv_sec * 1000000L + receivedTimeStamp.tv_usec));
+                            timestamp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(transformedTimePoint);
+                        } else { // LCOV_EXCL_LINE
+                            // In case the ioctl failed, fall back to chrono. // LCOV_EXCL_LINE
+                            timestamp = std::chrono::system_clock::now(); // LCOV_EXCL_LINE
+                        }
+#else
+                        std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
+#endif
+
+                        // Transform sender address to C-string.
+                        ::inet_ntop(remote.ss_family,
+                                    &((reinterpret_cast<struct sockaddr_in *>(&remote))->sin_addr), // NOLINT
+                                    remoteAddress.data(),
+                                    remoteAddress.max_size());
+
+                        PipelineEntry pe;
+                        pe.m_data       = std::string(buffer.data(), static_cast<size_t>(bytesRead));
+                        pe.m_from       = std::string(remoteAddress.data()) + ':' + std::to_string(RECVFROM_PORT);
+                        pe.m_sampleTime = timestamp;
+
+                        // Store entry in queue.
+                        if (m_pipeline) {
+                            m_pipeline->add(std::move(pe));
+                        }
+                    }
+                    totalBytesRead += bytesRead;
+                }
+            } while (!m_isBlockingSocket && (bytesRead > 0));
+        }
+
+        if (static_cast<int32_t>(totalBytesRead) > 0) {
+            if (m_pipeline) {
+                m_pipeline->notifyAll();
+            }
+        }
+    }
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/TCPConnection.hpp"
+//#include "cluon/IPv4Tools.hpp"
+//#include "cluon/TerminateHandler.hpp"
+
+// clang-format off
+#ifdef WIN32
+    #include <errno.h>
+    #include <iostream>
+#else
+    #ifdef __linux__
+        #include <linux/sockios.h>
+    #endif
+
+    #include <arpa/inet.h>
+    #include <sys/ioctl.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+// clang-format on
+
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace cluon {
+
+inline TCPConnection::TCPConnection(const int32_t &socket) noexcept
+    : m_socket(socket)
+    , m_newDataDelegate(nullptr)
+    , m_connectionLostDelegate(nullptr) {
+    if (!(m_socket < 0)) {
+        startReadingFromSocket();
+    }
+}
+
+inline TCPConnection::TCPConnection(const std::string &address,
+                             uint16_t port,
+                             std::function<void(std::string &&, std::chrono::system_clock::time_point &&)> newDataDelegate,
+                             std::function<void()> connectionLostDelegate) noexcept
+    : m_newDataDelegate(std::move(newDataDelegate))
+    , m_connectionLostDelegate(std::move(connectionLostDelegate)) {
+    // Decompose given address string to check validity with numerical IPv4 address.
+    std::string resolvedHostname{cluon::getIPv4FromHostname(address)};
+    std::string tmp{resolvedHostname};
+    std::replace(tmp.begin(), tmp.end(), '.', ' ');
+    std::istringstream sstr{tmp};
+    std::vector<int> addressTokens{std::istream_iterator<int>(sstr), std::istream_iterator<int>()};
+
+    if ((!addressTokens.empty()) && (4 == addressTokens.size())
+        && !(std::end(addressTokens) != std::find_if(addressTokens.begin(), addressTokens.end(), [](int a) { return (a < 0) || (a > 255); })) && (0 < port)) {
+        // Check for valid IP address.
+        struct sockaddr_in tmpSocketAddress {};
+        const bool isValid = (0 < ::inet_pton(AF_INET, resolvedHostname.c_str(), &(tmpSocketAddress.sin_addr)));
+        if (isValid) {
+            std::memset(&m_address, 0, sizeof(m_address));
+            m_address.sin_addr.s_addr = ::inet_addr(resolvedHostname.c_str());
+            m_address.sin_family      = AF_INET;
+            m_address.sin_port        = htons(port);
+#ifdef WIN32
+            // Load Winsock 2.2 DLL.
+            WSADATA wsaData;
+            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+                std::cerr << "[cluon::TCPConnection] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
+            }
+#endif
+
+            m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+#ifdef WIN32
+            if (m_socket < 0) {
+                std::cerr << "[cluon::TCPConnection] Error while creating socket: " << WSAGetLastError() << std::endl;
+                WSACleanup();
+            }
+#endif
+
+            if (!(m_socket < 0)) {
+                auto retVal = ::connect(m_socket, reinterpret_cast<struct sockaddr *>(&m_address), sizeof(m_address));
+                if (0 > retVal) {
+#ifdef WIN32 // LCOV_EXCL_LINE
+                    auto errorCode = WSAGetLastError();
+#else
+                    auto errorCode = errno;                                          // LCOV_EXCL_LINE
+#endif                                      // LCOV_EXCL_LINE
+                    closeSocket(errorCode); // LCOV_EXCL_LINE
+                } else {
+                    startReadingFromSocket();
+                }
+            }
+        }
+    }
+}
+
+inline TCPConnection::~TCPConnection() noexcept {
+    {
+        m_readFromSocketThreadRunning.store(false);
+
+        // Joining the thread could fail.
+        try {
+            if (m_readFromSocketThread.joinable()) {
+                m_readFromSocketThread.join();
+            }
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
+
+    m_pipeline.reset();
+
+    closeSocket(0);
+}
+
+inline void TCPConnection::closeSocket(int errorCode) noexcept {
+    if (0 != errorCode) {
+        std::cerr << "[cluon::TCPConnection] Failed to perform socket operation: "; // LCOV_EXCL_LINE
+#ifdef WIN32                                                                        // LCOV_EXCL_LINE
+        std::cerr << errorCode << std::endl;
+#else
+        std::cerr << ::strerror(errorCode) << " (" << errorCode << ")" << std::endl; // LCOV_EXCL_LINE
+#endif // LCOV_EXCL_LINE
+    }
+
+    if (!(m_socket < 0)) {
+#ifdef WIN32
+        ::shutdown(m_socket, SD_BOTH);
+        ::closesocket(m_socket);
+        WSACleanup();
+#else
+        ::shutdown(m_socket, SHUT_RDWR);                                             // Disallow further read/write operations.
+        ::close(m_socket);
+#endif
+    }
+    m_socket = -1;
+}
+
+inline void TCPConnection::startReadingFromSocket() noexcept {
+    // Constructing a thread could fail.
+    try {
+        m_readFromSocketThread = std::thread(&TCPConnection::readFromSocket, this);
+
+        // Let the operating system spawn the thread.
+        using namespace std::literals::chrono_literals;
+        do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
+    } catch (...) {          // LCOV_EXCL_LINE
+        closeSocket(ECHILD); // LCOV_EXCL_LINE
+    }
+
+    try {
+        m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>(
+            [this](PipelineEntry &&entry) { this->m_newDataDelegate(std::move(entry.m_data), std::move(entry.m_sampleTime)); });
+        if (m_pipeline) {
+            // Let the operating system spawn the thread.
+            using namespace std::literals::chrono_literals; // NOLINT
+            do { std::this_thread::sleep_for(1ms); } while (!m_pipeline->isRunning());
+        }
+    } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
+}
+
+inline void TCPConnection::setOnNewData(std::function<void(std::string &&, std::chrono::system_clock::time_point &&)> newDataDelegate) noexcept {
+    std::lock_guard<std::mutex> lck(m_newDataDelegateMutex);
+    m_newDataDelegate = newDataDelegate;
+}
+
+inline void TCPConnection::setOnConnectionLost(std::function<void()> connectionLostDelegate) noexcept {
+    std::lock_guard<std::mutex> lck(m_connectionLostDelegateMutex);
+    m_connectionLostDelegate = connectionLostDelegate;
+}
+
+inline bool TCPConnection::isRunning() const noexcept {
+    return (m_readFromSocketThreadRunning.load() && !TerminateHandler::instance().isTerminated.load());
+}
+
+inline std::pair<ssize_t, int32_t> TCPConnection::send(std::string &&data) const noexcept {
+    if (-1 == m_socket) {
+        return {-1, EBADF};
+    }
+
+    if (data.empty()) {
+        return {0, 0};
+    }
+
+    if (!m_readFromSocketThreadRunning.load()) {
+        std::lock_guard<std::mutex> lck(m_connectionLostDelegateMutex); // LCOV_EXCL_LINE
+        if (nullptr != m_connectionLostDelegate) {                      // LCOV_EXCL_LINE
+            m_connectionLostDelegate();                                 // LCOV_EXCL_LINE
+        }
+        return {-1, ENOTCONN}; // LCOV_EXCL_LINE
+    }
+
+    constexpr uint16_t MAX_LENGTH{65535};
+    if (MAX_LENGTH < data.size()) {
+        return {-1, E2BIG};
+    }
+
+    std::lock_guard<std::mutex> lck(m_socketMutex);
+    ssize_t bytesSent = ::send(m_socket, data.c_str(), data.length(), 0);
+    return {bytesSent, (0 > bytesSent ? errno : 0)};
+}
+
+inline bool TCPConnection::setSendTimeout(std::chrono::milliseconds timeout) noexcept {
+    if (-1 == m_socket) {
+        return false;
+    }
+#ifdef WIN32
+    DWORD value{static_cast<DWORD>(timeout.count())};
+#else
+    struct timeval value {};
+    value.tv_sec  = static_cast<decltype(value.tv_sec)>(timeout.count() / 1000);
+    value.tv_usec = static_cast<decltype(value.tv_usec)>((timeout.count() % 1000) * 1000);
+#endif
+    std::lock_guard<std::mutex> lck(m_socketMutex);
+    return 0 == ::setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char *>(&value), sizeof(value)); // NOLINT
+}
+
+inline void TCPConnection::readFromSocket() noexcept {
+    // Create buffer to store data from socket.
+    constexpr uint16_t MAX_LENGTH{65535};
+    std::array<char, MAX_LENGTH> buffer{};
+
+    struct timeval timeout {};
+
+    // Define file descriptor set to watch for read operations.
+    fd_set setOfFiledescriptorsToReadFrom{};
+
+    // Indicate to main thread that we are ready.
+    m_readFromSocketThreadRunning.store(true);
+
+    // This flag is used to not read data from the socket until this TCPConnection has a proper onNewDataHandler set.
+    bool hasNewDataDelegate{false};
+
+    while (m_readFromSocketThreadRunning.load()) {
+        // Define timeout for select system call. The timeval struct must be
+        // reinitialized for every select call as it might be modified containing
+        // the actual time slept.
+        timeout.tv_sec  = 0;
+        timeout.tv_usec = 20 * 1000; // Check for new data with 50Hz.
+
+        FD_ZERO(&setOfFiledescriptorsToReadFrom);
+        FD_SET(m_socket, &setOfFiledescriptorsToReadFrom);
+        ::select(m_socket + 1, &setOfFiledescriptorsToReadFrom, nullptr, nullptr, &timeout);
+
+        // Only read data when the newDataDelegate is set.
+        if (!hasNewDataDelegate) {
+            std::lock_guard<std::mutex> lck(m_newDataDelegateMutex);
+            hasNewDataDelegate = (nullptr != m_newDataDelegate);
+        }
+        if (FD_ISSET(m_socket, &setOfFiledescriptorsToReadFrom) && hasNewDataDelegate) {
+            ssize_t bytesRead = ::recv(m_socket, buffer.data(), buffer.max_size(), 0);
+            if (0 >= bytesRead) {
+                // 0 == bytesRead: peer shut down the connection; 0 > bytesRead: other error.
+                m_readFromSocketThreadRunning.store(false);
+
+                {
+                    std::lock_guard<std::mutex> lck(m_connectionLostDelegateMutex);
+                    if (nullptr != m_connectionLostDelegate) {
+                        m_connectionLostDelegate();
+                    }
+                }
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lck(m_newDataDelegateMutex);
+                if ((0 < bytesRead) && (nullptr != m_newDataDelegate)) {
+                    // SIOCGSTAMP is not available for a stream-based socket,
+                    // thus, falling back to regular chrono timestamping.
+                    std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
+                    {
+                        PipelineEntry pe;
+                        pe.m_data       = std::string(buffer.data(), static_cast<size_t>(bytesRead));
+                        pe.m_sampleTime = timestamp;
+
+                        // Store entry in queue.
+                        if (m_pipeline) {
+                            m_pipeline->add(std::move(pe));
+                        }
+                    }
+
+                    if (m_pipeline) {
+                        m_pipeline->notifyAll();
+                    }
+                }
+            }
+        }
+    }
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/TCPServer.hpp"
+//#include "cluon/TerminateHandler.hpp"
+
+// clang-format off
+#ifdef WIN32
+    #include <errno.h>
+    #include <iostream>
+#else
+    #include <arpa/inet.h>
+    #include <sys/ioctl.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+// clang-format on
+
+#include <cstring>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+namespace cluon {
+
+inline TCPServer::TCPServer(uint16_t port, std::function<void(std::string &&from, std::shared_ptr<cluon::TCPConnection> connection)> newConnectionDelegate) noexcept
+    : m_newConnectionDelegate(newConnectionDelegate) {
+    if (0 < port) {
+#ifdef WIN32
+        // Load Winsock 2.2 DLL.
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            std::cerr << "[cluon::TCPServer] Error while calling WSAStartUp: " << WSAGetLastError() << std::endl;
+        }
+#endif
+        m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+#ifdef WIN32
+        if (m_socket < 0) {
+            std::cerr << "[cluon::TCPServer] Error while creating socket: " << WSAGetLastError() << std::endl;
+            WSACleanup();
+        }
+#endif
+
+        if (!(m_socket < 0)) {
+            // Allow reusing of ports by multiple calls with same address/port.
+            uint32_t YES = 1;
+            // clang-format off
+            auto retVal = ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&YES), sizeof(YES)); // NOLINT
+            // clang-format on
+            if (0 > retVal) {
+#ifdef WIN32 // LCOV_EXCL_LINE
+                auto errorCode = WSAGetLastError();
+#else
+                auto errorCode = errno;                                              // LCOV_EXCL_LINE
+#endif                                  // LCOV_EXCL_LINE
+                closeSocket(errorCode); // LCOV_EXCL_LINE
+            }
+        }
+
+        if (!(m_socket < 0)) {
+            // Setup address and port.
+            struct sockaddr_in address;
+            ::memset(&address, 0, sizeof(address));
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            address.sin_port        = htons(port);
+
+            auto retVal = ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address));
+            if (-1 != retVal) {
+                constexpr int32_t MAX_PENDING_CONNECTIONS{100};
+                retVal = ::listen(m_socket, MAX_PENDING_CONNECTIONS);
+                if (-1 != retVal) {
+                    // Constructing a thread could fail.
+                    try {
+                        m_readFromSocketThread = std::thread(&TCPServer::readFromSocket, this);
+
+                        // Let the operating system spawn the thread.
+                        using namespace std::literals::chrono_literals;
+                        do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
+                    } catch (...) {          // LCOV_EXCL_LINE
+                        closeSocket(ECHILD); // LCOV_EXCL_LINE
+                    }
+                } else { // LCOV_EXCL_LINE
+#ifdef WIN32             // LCOV_EXCL_LINE
+                    auto errorCode = WSAGetLastError();
+#else
+                    auto errorCode = errno;                                          // LCOV_EXCL_LINE
+#endif                                      // LCOV_EXCL_LINE
+                    closeSocket(errorCode); // LCOV_EXCL_LINE
+                }
+            } else { // LCOV_EXCL_LINE
+#ifdef WIN32         // LCOV_EXCL_LINE
+                auto errorCode = WSAGetLastError();
+#else
+                auto errorCode = errno;                                              // LCOV_EXCL_LINE
+#endif                                  // LCOV_EXCL_LINE
+                closeSocket(errorCode); // LCOV_EXCL_LINE
+            }
+        }
+    }
+}
+
+inline TCPServer::~TCPServer() noexcept {
+    m_readFromSocketThreadRunning.store(false);
+
+    // Joining the thread could fail.
+    try {
+        if (m_readFromSocketThread.joinable()) {
+            m_readFromSocketThread.join();
+        }
+    } catch (...) { // LCOV_EXCL_LINE
+    }
+
+    closeSocket(0);
+}
+
+inline void TCPServer::closeSocket(int errorCode) noexcept {
+    if (0 != errorCode) {
+        std::cerr << "[cluon::TCPServer] Failed to perform socket operation: "; // LCOV_EXCL_LINE
+#ifdef WIN32                                                                    // LCOV_EXCL_LINE
+        std::cerr << errorCode << std::endl;
+#else
+        std::cerr << ::strerror(errorCode) << " (" << errorCode << ")" << std::endl; // LCOV_EXCL_LINE
+#endif // LCOV_EXCL_LINE
+    }
+
+    if (!(m_socket < 0)) {
+#ifdef WIN32
+        ::shutdown(m_socket, SD_BOTH);
+        ::closesocket(m_socket);
+        WSACleanup();
+#else
+        ::shutdown(m_socket, SHUT_RDWR);                                             // Disallow further read/write operations.
+        ::close(m_socket);
+#endif
+    }
+    m_socket = -1;
+}
+
+inline bool TCPServer::isRunning() const noexcept {
+    return (m_readFromSocketThreadRunning.load() && !TerminateHandler::instance().isTerminated.load());
+}
+
+inline void TCPServer::readFromSocket() noexcept {
+    struct timeval timeout {};
+
+    // Define file descriptor set to watch for read operations.
+    fd_set setOfFiledescriptorsToReadFrom{};
+
+    // Indicate to main thread that we are ready.
+    m_readFromSocketThreadRunning.store(true);
+
+    constexpr uint16_t MAX_ADDR_SIZE{1024};
+    std::array<char, MAX_ADDR_SIZE> remoteAddress{};
+
+    while (m_readFromSocketThreadRunning.load()) {
+        // Define timeout for select system call. The timeval struct must be
+        // reinitialized for every select call as it might be modified containing
+        // the actual time slept.
+        timeout.tv_sec  = 0;
+        timeout.tv_usec = 20 * 1000; // Check for new data with 50Hz.
+
+        FD_ZERO(&setOfFiledescriptorsToReadFrom);
+        FD_SET(m_socket, &setOfFiledescriptorsToReadFrom);
+        ::select(m_socket + 1, &setOfFiledescriptorsToReadFrom, nullptr, nullptr, &timeout);
+        if (FD_ISSET(m_socket, &setOfFiledescriptorsToReadFrom)) {
+            struct sockaddr_storage remote;
+            socklen_t addrLength     = sizeof(remote);
+            int32_t connectingClient = ::accept(m_socket, reinterpret_cast<struct sockaddr *>(&remote), &addrLength);
+            if ((0 <= connectingClient) && (nullptr != m_newConnectionDelegate)) {
+                ::inet_ntop(remote.ss_family,
+                            &((reinterpret_cast<struct sockaddr_in *>(&remote))->sin_addr), // NOLINT
+                            remoteAddress.data(),
+                            remoteAddress.max_size());
+                const uint16_t RECVFROM_PORT{ntohs(reinterpret_cast<struct sockaddr_in *>(&remote)->sin_port)}; // NOLINT
+                m_newConnectionDelegate(std::string(remoteAddress.data()) + ':' + std::to_string(RECVFROM_PORT),
+                                        std::shared_ptr<cluon::TCPConnection>(new cluon::TCPConnection(connectingClient)));
+            }
+        }
+    }
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/ToProtoVisitor.hpp"
+
+#include <cstring>
+
+namespace cluon {
+
+inline std::string ToProtoVisitor::encodedData() const noexcept {
+    std::string s{m_buffer.str()};
+    return s;
+}
+
+inline void ToProtoVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+}
+
+inline void ToProtoVisitor::postVisit() noexcept {}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<bool>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)typeName;
+    (void)name;
+    uint8_t _v = static_cast<uint8_t>(v); // NOLINT
+    toKeyValue<uint8_t>(id, _v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<int8_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<uint8_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<int16_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<uint16_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<int32_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<uint32_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<int64_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    toKeyValue<uint64_t>(id, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)typeName;
+    (void)name;
+    uint64_t key = encodeKey(id, static_cast<uint8_t>(ProtoConstants::FOUR_BYTES));
+    toVarInt(m_buffer, key);
+    encode(m_buffer, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)typeName;
+    (void)name;
+    uint64_t key = encodeKey(id, static_cast<uint8_t>(ProtoConstants::EIGHT_BYTES));
+    toVarInt(m_buffer, key);
+    encode(m_buffer, v);
+}
+
+inline void ToProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)typeName;
+    (void)name;
+    uint64_t key = encodeKey(id, static_cast<uint8_t>(ProtoConstants::LENGTH_DELIMITED));
+    toVarInt(m_buffer, key);
+    encode(m_buffer, v);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, bool &v) noexcept {
+    uint64_t _v{(v ? 1u : 0u)};
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, int8_t &v) noexcept {
+    uint64_t _v = toZigZag8(v);
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint8_t &v) noexcept {
+    uint64_t _v = v;
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, int16_t &v) noexcept {
+    uint64_t _v = toZigZag16(v);
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint16_t &v) noexcept {
+    uint64_t _v = v;
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, int32_t &v) noexcept {
+    uint64_t _v = toZigZag32(v);
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint32_t &v) noexcept {
+    uint64_t _v = v;
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, int64_t &v) noexcept {
+    uint64_t _v = toZigZag64(v);
+    return toVarInt(o, _v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, uint64_t &v) noexcept {
+    return toVarInt(o, v);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, float &v) noexcept {
+    // Store 4 bytes as little endian encoding.
+    uint32_t _v{0};
+    std::memmove(&_v, &v, sizeof(float));
+    _v = htole32(_v);
+    o.write(reinterpret_cast<const char *>(&_v), sizeof(uint32_t)); // NOLINT
+    return sizeof(uint32_t);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, double &v) noexcept {
+    // Store 8 bytes as little endian encoding.
+    uint64_t _v{0};
+    std::memmove(&_v, &v, sizeof(double));
+    _v = htole64(_v);
+    o.write(reinterpret_cast<const char *>(&_v), sizeof(uint64_t)); // NOLINT
+    return sizeof(uint64_t);
+}
+
+inline std::size_t ToProtoVisitor::encode(std::ostream &o, const std::string &v) noexcept {
+    const std::size_t LENGTH = v.length();
+    std::size_t size         = toVarInt(o, LENGTH);
+    o.write(v.c_str(), static_cast<std::streamsize>(LENGTH)); // LENGTH won't be negative.
+    return size + LENGTH;
+}
+
+inline uint8_t ToProtoVisitor::toZigZag8(int8_t v) noexcept {
+    return static_cast<uint8_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
+}
+
+inline uint16_t ToProtoVisitor::toZigZag16(int16_t v) noexcept {
+    return static_cast<uint16_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
+}
+
+inline uint32_t ToProtoVisitor::toZigZag32(int32_t v) noexcept {
+    return static_cast<uint32_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
+}
+
+inline uint64_t ToProtoVisitor::toZigZag64(int64_t v) noexcept {
+    return static_cast<uint64_t>((v << 1) ^ (v >> ((sizeof(v) * 8) - 1)));
+}
+
+inline uint64_t ToProtoVisitor::encodeKey(uint32_t fieldIdentifier, uint8_t protoType) noexcept {
+    return (fieldIdentifier << 0x3) | protoType;
+}
+
+inline std::size_t ToProtoVisitor::toVarInt(std::ostream &out, uint64_t v) noexcept {
+    // Minimum size is of the encoded data.
+    std::size_t size{1};
+    uint8_t b{0};
+    while (0x7f < v) {
+        // Use the MSB to indicate value overflow for more bytes to come.
+        b = (static_cast<uint8_t>(v & 0x7f)) | 0x80;
+        out.put(static_cast<char>(b));
+        v >>= 7;
+        size++;
+    }
+    // Write final byte.
+    b = (static_cast<uint8_t>(v)) & 0x7f;
+    out.put(static_cast<char>(b));
+
+    return size;
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/FromProtoVisitor.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+namespace cluon {
+
+inline void FromProtoVisitor::readBytesFromStream(std::istream &in, std::size_t bytesToReadFromStream, char *buffer) noexcept {
+    if (nullptr != buffer) {
+        const constexpr std::size_t CHUNK_SIZE{1024};
+        std::streamsize bufferPosition{0};
+        std::streamsize extractedBytes{0};
+
+        while ((0 < bytesToReadFromStream) && in.good()) {
+            // clang-format off
+            in.read(&buffer[static_cast<std::size_t>(bufferPosition)], /* Flawfinder: ignore */ /* Cf. buffer.reserve(...) above.  */
+                    (bytesToReadFromStream > CHUNK_SIZE) ? CHUNK_SIZE : static_cast<std::streamsize>(bytesToReadFromStream));
+            // clang-format on
+            extractedBytes = in.gcount();
+            bufferPosition += extractedBytes;
+            bytesToReadFromStream -= static_cast<std::size_t>(extractedBytes);
+        }
+    }
+}
+
+inline void FromProtoVisitor::decodeFrom(std::istream &in) noexcept {
+    // Reset internal states as this deserializer could be reused.
+    m_mapOfKeyValues.clear();
+    while (in.good()) {
+        // First stage: Read keyFieldType (encoded as VarInt).
+        if (0 < fromVarInt(in, m_keyFieldType)) {
+            // Succeeded to read keyFieldType entry; extract information.
+            m_protoType = static_cast<ProtoConstants>(m_keyFieldType & 0x7);
+            m_fieldId = static_cast<uint32_t>(m_keyFieldType >> 3);
+            switch (m_protoType) {
+                case ProtoConstants::VARINT:
+                {
+                    // Directly decode VarInt value.
+                    fromVarInt(in, m_value);
+                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(m_value));
+                }
+                break;
+                case ProtoConstants::EIGHT_BYTES:
+                {
+                    readBytesFromStream(in, sizeof(double), m_doubleValue.buffer.data());
+                    m_doubleValue.uint64Value = le64toh(m_doubleValue.uint64Value);
+                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(m_doubleValue.doubleValue));
+                }
+                break;
+                case ProtoConstants::FOUR_BYTES:
+                {
+                    readBytesFromStream(in, sizeof(float), m_floatValue.buffer.data());
+                    m_floatValue.uint32Value = le32toh(m_floatValue.uint32Value);
+                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(m_floatValue.floatValue));
+                }
+                break;
+                case ProtoConstants::LENGTH_DELIMITED:
+                {
+                    fromVarInt(in, m_value);
+                    const std::size_t BYTES_TO_READ_FROM_STREAM{static_cast<std::size_t>(m_value)};
+                    if (m_stringValue.capacity() < BYTES_TO_READ_FROM_STREAM) {
+                        m_stringValue.reserve(BYTES_TO_READ_FROM_STREAM);
+                    }
+                    readBytesFromStream(in, BYTES_TO_READ_FROM_STREAM, m_stringValue.data());
+                    m_mapOfKeyValues.emplace(m_fieldId, linb::any(std::string(m_stringValue.data(), static_cast<std::size_t>(m_value))));
+                }
+                break;
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
 inline FromProtoVisitor &FromProtoVisitor::operator=(const FromProtoVisitor &other) noexcept {
     m_mapOfKeyValues = other.m_mapOfKeyValues;
@@ -11349,242 +13206,1998 @@ inline FromProtoVisitor &FromProtoVisitor::operator=(const FromProtoVisitor &oth
 
 ////////////////////////////////////////////////////////////////////////////////
 
-inline void FromProtoVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+inline void FromProtoVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+}
+
+inline void FromProtoVisitor::postVisit() noexcept {}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = (0 != m_value);
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            v = (0 != linb::any_cast<uint64_t>(m_mapOfKeyValues[id]));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<char>(m_value);
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<char>(_v);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<int8_t>(fromZigZag8(static_cast<uint8_t>(m_value)));
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<int8_t>(fromZigZag8(static_cast<uint8_t>(_v)));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<uint8_t>(m_value);
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<uint8_t>(_v);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<int16_t>(fromZigZag16(static_cast<uint16_t>(m_value)));
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<int16_t>(fromZigZag16(static_cast<uint16_t>(_v)));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<uint16_t>(m_value);
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<uint16_t>(_v);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<int32_t>(fromZigZag32(static_cast<uint32_t>(m_value)));
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<int32_t>(fromZigZag32(static_cast<uint32_t>(_v)));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<uint32_t>(m_value);
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<uint32_t>(_v);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = static_cast<int64_t>(fromZigZag64(static_cast<uint64_t>(m_value)));
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+            v           = static_cast<int64_t>(fromZigZag64(_v));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = m_value;
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = m_floatValue.floatValue;
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            v = linb::any_cast<float>(m_mapOfKeyValues[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = m_doubleValue.doubleValue;
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            v = linb::any_cast<double>(m_mapOfKeyValues[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (m_callToDecodeFromWithDirectVisit) {
+        v = std::string(m_stringValue.data(), static_cast<std::size_t>(m_value));
+    }
+    else if (m_mapOfKeyValues.count(id) > 0) {
+        try {
+            v = linb::any_cast<std::string>(m_mapOfKeyValues[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline int8_t FromProtoVisitor::fromZigZag8(uint8_t v) noexcept {
+    return static_cast<int8_t>((v >> 1) ^ -(v & 1));
+}
+
+inline int16_t FromProtoVisitor::fromZigZag16(uint16_t v) noexcept {
+    return static_cast<int16_t>((v >> 1) ^ -(v & 1));
+}
+
+inline int32_t FromProtoVisitor::fromZigZag32(uint32_t v) noexcept {
+    return static_cast<int32_t>((v >> 1) ^ -(v & 1));
+}
+
+inline int64_t FromProtoVisitor::fromZigZag64(uint64_t v) noexcept {
+    return static_cast<int64_t>((v >> 1) ^ -(v & 1));
+}
+
+inline std::size_t FromProtoVisitor::fromVarInt(std::istream &in, uint64_t &value) noexcept {
+    value = 0;
+
+    constexpr uint64_t MASK  = 0x7f;
+    constexpr uint64_t SHIFT = 0x7;
+    constexpr uint64_t MSB   = 0x80;
+
+    std::size_t size = 0;
+    uint64_t C{0};
+    while (in.good()) {
+        auto x = in.get();
+        C = static_cast<uint64_t>(x);
+        value |= (C & MASK) << (SHIFT * size++);
+        if (!(C & MSB)) { // NOLINT
+            break;
+        }
+    }
+
+    return size;
+}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+// clang-format off
+#ifdef WIN32
+    #include <Winsock2.h> // for ntohll
+#endif
+// clang-format on
+
+//#include "cluon/FromLCMVisitor.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace cluon {
+
+inline FromLCMVisitor::FromLCMVisitor() noexcept
+    : m_buffer(m_internalBuffer) {}
+
+inline FromLCMVisitor::FromLCMVisitor(std::stringstream &in) noexcept
+    : m_expectedHash{0}
+    , m_buffer(in) {}
+
+inline void FromLCMVisitor::decodeFrom(std::istream &in) noexcept {
+    // Reset internal states as this deserializer could be reused.
+    m_buffer.clear();
+    m_buffer.str("");
+
+    in.read(reinterpret_cast<char *>(&m_expectedHash), sizeof(int64_t));
+    m_expectedHash = static_cast<int64_t>(be64toh(m_expectedHash));
+
+    m_buffer << in.rdbuf();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline void FromLCMVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+
+    // Reset m_buffer read pointer to beginning only if we are not dealing with
+    // nested complex types as we are sharing our buffer with our parent message.
+    if (0 != m_expectedHash) {
+        m_buffer.clear();
+        m_buffer.seekg(0);
+        m_calculatedHash = 0x12345678;
+        m_hashes.clear();
+    }
+}
+
+inline void FromLCMVisitor::postVisit() noexcept {
+    if ((0 != m_expectedHash) && (m_expectedHash != hash())) {
+        std::cerr << "[cluon::FromLCMVisitor] Hash mismatch - decoding might have failed" << std::endl; // LCOV_EXCL_LINE
+    }
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("boolean");
+    calculateHash(0);
+    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(bool));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int8_t");
+    calculateHash(0);
+    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(char));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int8_t");
+    calculateHash(0);
+    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int8_t");
+    calculateHash(0);
+    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int16_t");
+    calculateHash(0);
+    int16_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int16_t));
+    v = static_cast<int16_t>(be16toh(_v));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int16_t");
+    calculateHash(0);
+    int16_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int16_t));
+    v = be16toh(_v);
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int32_t");
+    calculateHash(0);
+    int32_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int32_t));
+    v = static_cast<int32_t>(be32toh(_v));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int32_t");
+    calculateHash(0);
+    int32_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int32_t));
+    v = be32toh(_v);
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int64_t");
+    calculateHash(0);
+    int64_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int64_t));
+    v = static_cast<int64_t>(be64toh(_v));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("int64_t");
+    calculateHash(0);
+    int64_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int64_t));
+    v = be64toh(_v);
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("float");
+    calculateHash(0);
+    int32_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int32_t));
+    _v = static_cast<int32_t>(be32toh(_v));
+    std::memmove(&v, &_v, sizeof(int32_t));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)id;
+    (void)typeName;
+    calculateHash(name);
+    calculateHash("double");
+    calculateHash(0);
+    int64_t _v{0};
+    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int64_t));
+    _v = static_cast<int64_t>(be64toh(_v));
+    std::memmove(&v, &_v, sizeof(int64_t));
+}
+
+inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)id;
+    (void)typeName;
+    (void)name;
+    (void)v;
+    calculateHash(name);
+    calculateHash("string");
+    calculateHash(0);
+
+    int32_t length{0};
+    m_buffer.read(reinterpret_cast<char *>(&length), sizeof(int32_t));
+    length = static_cast<int32_t>(be32toh(length));
+
+    v.clear();
+    if (length > 0) {
+        std::vector<char> buffer;
+        buffer.reserve(static_cast<uint32_t>(length));
+#ifdef WIN32
+        for (uint32_t i = 0; i < static_cast<uint32_t>(length); i++) {
+            char c;
+            m_buffer.get(c);
+            buffer.push_back(c);
+        }
+#else
+        m_buffer.read(static_cast<char *>(&buffer[0]), static_cast<std::streamsize>(length));
+#endif
+        const std::string s(buffer.begin(), buffer.begin() + length - 1); // Skip trailing '\0'.
+        v = s;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline int64_t FromLCMVisitor::hash() const noexcept {
+    // Apply ZigZag encoding for hash from this message's fields and depending
+    // hashes for complex nested types.
+    int64_t tmp{m_calculatedHash};
+    for (int64_t v : m_hashes) { tmp += v; }
+
+    const int64_t hash = (tmp << 1) + ((tmp >> 63) & 1);
+    return hash;
+}
+
+inline void FromLCMVisitor::calculateHash(char c) noexcept {
+    m_calculatedHash = ((m_calculatedHash << 8) ^ (m_calculatedHash >> 55)) + c;
+}
+
+inline void FromLCMVisitor::calculateHash(const std::string &s) noexcept {
+    const std::string tmp{(s.length() > 255 ? s.substr(0, 255) : s)};
+    const uint8_t length{static_cast<uint8_t>(tmp.length())};
+    calculateHash(static_cast<char>(length));
+    for (auto c : tmp) { calculateHash(c); }
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+// clang-format off
+#ifdef WIN32
+    #include <Winsock2.h> // for ntohl, ntohs
+#endif
+// clang-format on
+
+//#include "cluon/FromMsgPackVisitor.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace cluon {
+
+inline FromMsgPackVisitor::FromMsgPackVisitor() noexcept
+    : m_keyValues{m_data} {}
+
+inline FromMsgPackVisitor::FromMsgPackVisitor(std::map<std::string, FromMsgPackVisitor::MsgPackKeyValue> &preset) noexcept
+    : m_keyValues{preset} {}
+
+inline MsgPackConstants FromMsgPackVisitor::getFormatFamily(uint8_t T) noexcept {
+    MsgPackConstants formatFamily{MsgPackConstants::UNKNOWN_FORMAT};
+
+    if (static_cast<uint8_t>(MsgPackConstants::IS_FALSE) == T) {
+        formatFamily = MsgPackConstants::BOOL_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::IS_TRUE) == T) {
+        formatFamily = MsgPackConstants::BOOL_FORMAT;
+    } else if (0x7F >= T) {
+        formatFamily = MsgPackConstants::UINT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::UINT8) == T) {
+        formatFamily = MsgPackConstants::UINT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::UINT16) == T) {
+        formatFamily = MsgPackConstants::UINT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::UINT32) == T) {
+        formatFamily = MsgPackConstants::UINT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::UINT64) == T) {
+        formatFamily = MsgPackConstants::UINT_FORMAT;
+    } else if (0xE0 <= T) {
+        formatFamily = MsgPackConstants::INT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::INT8) == T) {
+        formatFamily = MsgPackConstants::INT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::INT16) == T) {
+        formatFamily = MsgPackConstants::INT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::INT32) == T) {
+        formatFamily = MsgPackConstants::INT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::INT64) == T) {
+        formatFamily = MsgPackConstants::INT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::FLOAT) == T) {
+        formatFamily = MsgPackConstants::FLOAT_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::DOUBLE) == T) {
+        formatFamily = MsgPackConstants::FLOAT_FORMAT;
+    } else if ((static_cast<uint8_t>(MsgPackConstants::FIXSTR) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXSTR_END) > T)) {
+        formatFamily = MsgPackConstants::STR_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::STR8) == T) {
+        formatFamily = MsgPackConstants::STR_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::STR16) == T) {
+        formatFamily = MsgPackConstants::STR_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::STR32) == T) {
+        formatFamily = MsgPackConstants::STR_FORMAT;
+    } else if ((static_cast<uint8_t>(MsgPackConstants::FIXMAP) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXMAP_END) > T)) {
+        formatFamily = MsgPackConstants::MAP_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::MAP16) == T) {
+        formatFamily = MsgPackConstants::MAP_FORMAT;
+    } else if (static_cast<uint8_t>(MsgPackConstants::MAP32) == T) { // LCOV_EXCL_LINE
+        formatFamily = MsgPackConstants::MAP_FORMAT;                 // LCOV_EXCL_LINE
+    }
+
+    return formatFamily;
+}
+
+inline uint64_t FromMsgPackVisitor::readUint(std::istream &in) noexcept {
+    uint64_t retVal{0};
+    if (in.good()) {
+        uint8_t c = static_cast<uint8_t>(in.get());
+        if (MsgPackConstants::UINT_FORMAT == getFormatFamily(c)) {
+            if (0x7F >= c) {
+                retVal = static_cast<uint64_t>(c);
+            } else if (static_cast<uint8_t>(MsgPackConstants::UINT8) == c) {
+                uint8_t v{0};
+                in.read(reinterpret_cast<char *>(&v), sizeof(uint8_t));
+                retVal = static_cast<uint64_t>(v);
+            } else if (static_cast<uint8_t>(MsgPackConstants::UINT16) == c) {
+                uint16_t v{0};
+                in.read(reinterpret_cast<char *>(&v), sizeof(uint16_t));
+                v      = be16toh(v);
+                retVal = static_cast<uint64_t>(v);
+            } else if (static_cast<uint8_t>(MsgPackConstants::UINT32) == c) {
+                uint32_t v{0};
+                in.read(reinterpret_cast<char *>(&v), sizeof(uint32_t));
+                v      = be32toh(v);
+                retVal = static_cast<uint64_t>(v);
+            } else if (static_cast<uint8_t>(MsgPackConstants::UINT64) == c) {
+                in.read(reinterpret_cast<char *>(&retVal), sizeof(uint64_t));
+                retVal = be64toh(retVal);
+            }
+        }
+    }
+    return retVal;
+}
+
+inline int64_t FromMsgPackVisitor::readInt(std::istream &in) noexcept {
+    int64_t retVal{0};
+    if (in.good()) {
+        int8_t c = static_cast<int8_t>(in.get());
+        if (MsgPackConstants::INT_FORMAT == getFormatFamily(static_cast<uint8_t>(c))) {
+            if (0xE0 <= static_cast<uint8_t>(c)) {
+                retVal = static_cast<int64_t>(c);
+            } else if (static_cast<int8_t>(MsgPackConstants::INT8) == c) {
+                int8_t v{0};
+                in.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
+                retVal = static_cast<int64_t>(v);
+            } else if (static_cast<int8_t>(MsgPackConstants::INT16) == c) {
+                int16_t v{0};
+                in.read(reinterpret_cast<char *>(&v), sizeof(int16_t));
+                v      = static_cast<int16_t>(be16toh(v));
+                retVal = static_cast<int64_t>(v);
+            } else if (static_cast<int8_t>(MsgPackConstants::INT32) == c) {
+                int32_t v{0};
+                in.read(reinterpret_cast<char *>(&v), sizeof(int32_t));
+                v      = static_cast<int32_t>(be32toh(v));
+                retVal = static_cast<int64_t>(v);
+            } else if (static_cast<int8_t>(MsgPackConstants::INT64) == c) {
+                in.read(reinterpret_cast<char *>(&retVal), sizeof(int64_t));
+                retVal = static_cast<int64_t>(be64toh(retVal));
+            }
+        }
+    }
+    return retVal;
+}
+
+inline std::string FromMsgPackVisitor::readString(std::istream &in) noexcept {
+    std::string retVal{""};
+    if (in.good()) {
+        uint8_t c = static_cast<uint8_t>(in.get());
+        if (MsgPackConstants::STR_FORMAT == getFormatFamily(c)) {
+            uint32_t length{0};
+            const uint8_t T = static_cast<uint8_t>(c);
+            if ((static_cast<uint8_t>(MsgPackConstants::FIXSTR) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXSTR_END) > T)) {
+                length = T - static_cast<uint8_t>(MsgPackConstants::FIXSTR);
+            } else if (static_cast<uint8_t>(MsgPackConstants::STR8) == T) {
+                uint8_t _length{0};
+                in.read(reinterpret_cast<char *>(&_length), sizeof(uint8_t));
+                length = _length;
+            } else if (static_cast<uint8_t>(MsgPackConstants::STR16) == T) {
+                uint16_t _length{0};
+                in.read(reinterpret_cast<char *>(&_length), sizeof(uint16_t));
+                length = be16toh(_length);
+            } else if (static_cast<uint8_t>(MsgPackConstants::STR32) == T) {
+                in.read(reinterpret_cast<char *>(&length), sizeof(uint32_t));
+                length = be32toh(length);
+            }
+
+            if (0 < length) {
+                std::vector<char> buffer;
+                buffer.reserve(length);
+#ifdef WIN32
+                for (uint32_t i = 0; i < static_cast<uint32_t>(length); i++) {
+                    char c;
+                    in.get(c);
+                    buffer.push_back(c);
+                }
+#else
+                in.read(static_cast<char *>(&buffer[0]), static_cast<std::streamsize>(length));
+#endif
+                retVal = std::string(buffer.data(), length);
+            }
+        }
+    }
+    return retVal;
+}
+
+inline std::map<std::string, FromMsgPackVisitor::MsgPackKeyValue> FromMsgPackVisitor::readKeyValues(std::istream &in) noexcept {
+    std::map<std::string, FromMsgPackVisitor::MsgPackKeyValue> keyValues;
+    while (in.good()) {
+        uint8_t c = static_cast<uint8_t>(in.get());
+        if (MsgPackConstants::MAP_FORMAT == getFormatFamily(c)) {
+            // First, search for map opening token.
+            const uint8_t T = static_cast<uint8_t>(c);
+            uint32_t tokensToRead{0};
+            if ((static_cast<uint8_t>(MsgPackConstants::FIXMAP) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXMAP_END) > T)) {
+                tokensToRead = T - static_cast<uint8_t>(MsgPackConstants::FIXMAP);
+            } else if (static_cast<uint8_t>(MsgPackConstants::MAP16) == T) {
+                uint16_t tokens{0};
+                in.read(reinterpret_cast<char *>(&tokens), sizeof(uint16_t));
+                tokensToRead = be16toh(tokens);
+            } else if (static_cast<uint8_t>(MsgPackConstants::MAP32) == T) {        // LCOV_EXCL_LINE
+                in.read(reinterpret_cast<char *>(&tokensToRead), sizeof(uint32_t)); // LCOV_EXCL_LINE
+                tokensToRead = be32toh(tokensToRead);                               // LCOV_EXCL_LINE
+            }
+
+            // Next, read pairs string/value.
+            while (0 < tokensToRead) {
+                MsgPackKeyValue entry;
+                entry.m_key = readString(in);
+                // Read next byte and determine format family.
+                c                    = static_cast<uint8_t>(in.get());
+                entry.m_formatFamily = getFormatFamily(c);
+
+                if (MsgPackConstants::BOOL_FORMAT == entry.m_formatFamily) {
+                    entry.m_value = false;
+                    if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::IS_TRUE)) {
+                        entry.m_value = true;
+                    } else if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::IS_FALSE)) {
+                        entry.m_value = false;
+                    }
+                } else if (MsgPackConstants::UINT_FORMAT == entry.m_formatFamily) {
+                    in.unget(); // Last character needs to be put back to process the uints correctly as it might
+                                // contain the value.
+                    entry.m_value = readUint(in);
+                } else if (MsgPackConstants::INT_FORMAT == entry.m_formatFamily) {
+                    in.unget(); // Last character needs to be put back to process the ints correctly as it might contain
+                                // the value.
+                    entry.m_value = readInt(in);
+                } else if (MsgPackConstants::FLOAT_FORMAT == entry.m_formatFamily) {
+                    if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::FLOAT)) {
+                        uint32_t _v{0};
+                        in.read(reinterpret_cast<char *>(&_v), sizeof(uint32_t));
+                        _v = be32toh(_v);
+                        float v{0.0f};
+                        std::memmove(&v, &_v, sizeof(float));
+                        entry.m_value = v;
+                    }
+                    if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::DOUBLE)) {
+                        uint64_t _v{0};
+                        in.read(reinterpret_cast<char *>(&_v), sizeof(uint64_t));
+                        _v = be64toh(_v);
+                        double v{0.0};
+                        std::memmove(&v, &_v, sizeof(double));
+                        entry.m_value = v;
+                    }
+                } else if (MsgPackConstants::STR_FORMAT == entry.m_formatFamily) {
+                    in.unget(); // Last character needs to be put back to process the string correctly as it might
+                                // encode its length.
+                    entry.m_value = readString(in);
+                } else if (MsgPackConstants::MAP_FORMAT == entry.m_formatFamily) {
+                    in.unget(); // Last character needs to be put back to process the contained nested map correctly as
+                                // it might encode its length.
+                    entry.m_value = readKeyValues(in);
+                }
+
+                keyValues[entry.m_key] = entry;
+                tokensToRead--;
+            }
+            // Stop processing further tokens (might be handled from outer decoder).
+            break;
+        }
+    }
+    return keyValues;
+}
+
+inline void FromMsgPackVisitor::decodeFrom(std::istream &in) noexcept {
+    (void)in;
+
+    m_keyValues = readKeyValues(in);
+}
+
+inline void FromMsgPackVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+}
+
+inline void FromMsgPackVisitor::postVisit() noexcept {}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<bool>(m_keyValues[name].m_value);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<std::string>(m_keyValues[name].m_value).at(0);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = static_cast<int8_t>(linb::any_cast<int64_t>(m_keyValues[name].m_value));
+        } catch (const linb::bad_any_cast &) {
+            // A positive value was stored.
+            try {
+                v = static_cast<int8_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = static_cast<uint8_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = static_cast<int16_t>(linb::any_cast<int64_t>(m_keyValues[name].m_value));
+        } catch (const linb::bad_any_cast &) {
+            // A positive value was stored.
+            try {
+                v = static_cast<int16_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = static_cast<uint16_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = static_cast<int32_t>(linb::any_cast<int64_t>(m_keyValues[name].m_value));
+        } catch (const linb::bad_any_cast &) {
+            // A positive value was stored.
+            try {
+                v = static_cast<int32_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = static_cast<uint32_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<int64_t>(m_keyValues[name].m_value);
+        } catch (const linb::bad_any_cast &) {
+            // A positive value was stored.
+            try {
+                v = static_cast<int64_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<uint64_t>(m_keyValues[name].m_value);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<float>(m_keyValues[name].m_value);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<double>(m_keyValues[name].m_value);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            v = linb::any_cast<std::string>(m_keyValues[name].m_value);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2019  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/FromJSONVisitor.hpp"
+//#include "cluon/stringtoolbox.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <regex>
+#include <sstream>
+#include <vector>
+
+#include <iostream>
+namespace cluon {
+
+inline FromJSONVisitor::FromJSONVisitor() noexcept
+    : m_keyValues{m_data} {}
+
+inline FromJSONVisitor::FromJSONVisitor(std::map<std::string, FromJSONVisitor::JSONKeyValue> &preset) noexcept
+    : m_keyValues{preset} {}
+
+inline std::map<std::string, FromJSONVisitor::JSONKeyValue> FromJSONVisitor::readKeyValues(std::string &input) noexcept {
+    const std::string MATCH_JSON
+        = R"((?:\"|\')(?:[^"]*)(?:\"|\')(?=:)(?:\:\s*)(?:\"|\')?(?:true|false|[\-]{0,1}[0-9]+[\.][0-9]+|[\-]{0,1}[0-9]+|[0-9a-zA-Z\+\-\,\.\$\ \=]*)(?:\"|\')?)";
+
+    std::map<std::string, FromJSONVisitor::JSONKeyValue> result;
+    std::string oldInput;
+    try {
+        std::smatch m;
+        do {
+            std::regex_search(input, m, std::regex(MATCH_JSON));
+
+            if (m.size() > 0) {
+                std::string match{m[0]};
+                std::vector<std::string> retVal = stringtoolbox::split(match, ':');
+                if ( (retVal.size() == 2) && (stringtoolbox::trim(retVal[1]).size() == 0) ) {
+                    std::string keyOfNestedObject{stringtoolbox::trim(retVal[0])};
+                    keyOfNestedObject = stringtoolbox::split(keyOfNestedObject, '"')[1];
+                    {
+                        std::string suffix(m.suffix());
+                        suffix   = stringtoolbox::trim(suffix);
+                        oldInput = input;
+                        input    = suffix;
+                    }
+
+                    auto mapOfNestedValues = readKeyValues(input);
+
+                    JSONKeyValue kv;
+                    kv.m_key   = keyOfNestedObject;
+                    kv.m_type  = JSONConstants::OBJECT;
+                    kv.m_value = mapOfNestedValues;
+
+                    result[keyOfNestedObject] = kv;
+                }
+                if ( (retVal.size() == 2) && (stringtoolbox::trim(retVal[1]).size() > 0) ) {
+                    auto e = std::make_pair(stringtoolbox::trim(retVal[0]), stringtoolbox::trim(retVal[1]));
+
+                    JSONKeyValue kv;
+                    kv.m_key = stringtoolbox::split(e.first, '"')[1];
+
+                    if ((e.second.size() > 0) && (e.second.at(0) == '"')) {
+                        kv.m_type  = JSONConstants::STRING;
+                        kv.m_value = std::string(e.second).substr(1);
+                    } else if ((e.second.size() > 0) && ((e.second == "false") || (e.second == "true"))) {
+                        kv.m_type  = (e.second == "true" ? JSONConstants::IS_TRUE : JSONConstants::IS_FALSE);
+                        kv.m_value = e.second == "true";
+                    } else {
+                        kv.m_type = JSONConstants::NUMBER;
+                        std::stringstream tmp(e.second);
+                        double v;
+                        tmp >> v;
+                        kv.m_value = v;
+                    }
+
+                    result[kv.m_key] = kv;
+
+                    {
+                        std::string suffix(m.suffix());
+                        suffix   = stringtoolbox::trim(suffix);
+                        oldInput = input;
+                        input    = suffix;
+                        if (suffix.size() > 0 && suffix.at(0) == '}') {
+                            break; // Nested payload complete; return.
+                        }
+                    }
+                }
+            }
+        } while (!m.empty() && (oldInput != input));
+    } catch (std::regex_error &) { // LCOV_EXCL_LINE
+    } catch (std::bad_cast &) {}   // LCOV_EXCL_LINE
+
+    return result;
+}
+
+inline void FromJSONVisitor::decodeFrom(std::istream &in) noexcept {
+    m_keyValues.clear();
+
+    std::string s;
+    std::istream_iterator<char> it(in), it_end;
+    std::copy(it, it_end, std::insert_iterator<std::string>(s, s.begin()));
+
+    // Remove whitespace characters like newline, carriage return, or tab.
+    s.erase(std::remove_if(s.begin(), s.end(), [](char c) { return (c == '\r' || c == '\t' || c == '\n'); }), s.end());
+
+    // Parse JSON from in.
+    m_keyValues = readKeyValues(s);
+}
+
+inline std::string FromJSONVisitor::decodeBase64(const std::string &input) noexcept {
+    const std::string ALPHABET{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+    uint8_t counter{0};
+    std::array<char, 4> buffer;
+    std::string decoded;
+    for (uint32_t i{0}; i < input.size(); i++) {
+        char c;
+        for (c = 0; c < 64 && (ALPHABET.at(static_cast<uint8_t>(c)) != input.at(i)); c++) {}
+
+        buffer[counter++] = c;
+        if (4 == counter) {
+            decoded.push_back(static_cast<char>((buffer[0] << 2) + (buffer[1] >> 4)));
+            if (64 != buffer[2]) {
+                decoded.push_back(static_cast<char>((buffer[1] << 4) + (buffer[2] >> 2)));
+            }
+            if (64 != buffer[3]) {
+                decoded.push_back(static_cast<char>((buffer[2] << 6) + buffer[3]));
+            }
+            counter = 0;
+        }
+    }
+    return decoded;
+}
+
+inline void FromJSONVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+}
+
+inline void FromJSONVisitor::postVisit() noexcept {}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::IS_FALSE == m_keyValues[name].m_type) {
+                v = false;
+            } else if (JSONConstants::IS_TRUE == m_keyValues[name].m_type) {
+                v = true;
+            } else if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = (1 == static_cast<uint32_t>(linb::any_cast<double>(m_keyValues[name].m_value)));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::STRING == m_keyValues[name].m_type) {
+                v = linb::any_cast<std::string>(m_keyValues[name].m_value).at(0);
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<int8_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<uint8_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<int16_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<uint16_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<int32_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<uint32_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<int64_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<uint64_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = static_cast<float>(linb::any_cast<double>(m_keyValues[name].m_value));
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
+                v = linb::any_cast<double>(m_keyValues[name].m_value);
+            }
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)id;
+    (void)typeName;
+    if (0 < m_keyValues.count(name)) {
+        try {
+            std::string tmp{linb::any_cast<std::string>(m_keyValues[name].m_value)};
+            v = FromJSONVisitor::decodeBase64(tmp);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/GenericMessage.hpp"
+
+#include <istream>
+#include <iterator>
+#include <regex>
+
+namespace cluon {
+
+inline void GenericMessage::GenericMessageVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)longName;
+    m_metaMessage.messageIdentifier(id).messageName(shortName);
+    if (!longName.empty()) {
+        const auto pos = longName.rfind(shortName);
+        if (std::string::npos != pos) {
+            m_metaMessage.packageName(longName.substr(0, pos - 1));
+        }
+    }
+}
+
+inline void GenericMessage::GenericMessageVisitor::postVisit() noexcept {}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::BOOL_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::CHAR_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT8_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT8_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT16_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT16_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT32_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT32_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT64_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT64_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::FLOAT_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::DOUBLE_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    cluon::MetaMessage::MetaField mf;
+    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::STRING_T).fieldDataTypeName(typeName).fieldName(name);
+    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
+    m_metaMessage.add(std::move(mf));
+}
+
+inline MetaMessage GenericMessage::GenericMessageVisitor::metaMessage() const noexcept {
+    return m_metaMessage;
+}
+
+inline std::unordered_map<uint32_t, linb::any, UseUInt32ValueAsHashKey> GenericMessage::GenericMessageVisitor::intermediateDataRepresentation() const noexcept {
+    return m_intermediateDataRepresentation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline int32_t GenericMessage::ID() {
+    return m_metaMessage.messageIdentifier();
+}
+
+inline const std::string GenericMessage::ShortName() {
+    std::string tmp{LongName()};
+    std::replace(tmp.begin(), tmp.end(), '.', ' ');
+    std::istringstream sstr{tmp};
+    std::vector<std::string> tokens{std::istream_iterator<std::string>(sstr), std::istream_iterator<std::string>()};
+
+    return tokens.back();
+}
+
+inline const std::string GenericMessage::LongName() {
+    return m_metaMessage.packageName() + (!m_metaMessage.packageName().empty() ? "." : "") + m_metaMessage.messageName();
+}
+
+inline void GenericMessage::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+}
+
+inline void GenericMessage::postVisit() noexcept {}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<bool>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<char>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<int8_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<uint8_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<int16_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<uint16_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<int32_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<uint32_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<int64_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<uint64_t>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<float>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<double>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)typeName;
+    (void)name;
+    if (0 < m_intermediateDataRepresentation.count(id)) {
+        try {
+            v = linb::any_cast<std::string>(m_intermediateDataRepresentation[id]);
+        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline void GenericMessage::createFrom(const MetaMessage &mm, const std::vector<MetaMessage> &mms) noexcept {
+    m_metaMessage = mm;
+    m_longName    = m_metaMessage.messageName();
+
+    m_scopeOfMetaMessages.clear();
+    m_scopeOfMetaMessages = mms;
+
+    m_mapForScopeOfMetaMessages.clear();
+    for (const auto &e : m_scopeOfMetaMessages) { m_mapForScopeOfMetaMessages[e.messageName()] = e; }
+
+    m_intermediateDataRepresentation.clear();
+    for (const auto &f : m_metaMessage.listOfMetaFields()) {
+        if (f.fieldDataType() == MetaMessage::MetaField::BOOL_T) {
+            try {
+                linb::any _v{false};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::CHAR_T) {
+            try {
+                linb::any _v{static_cast<char>('\0')};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT8_T) {
+            try {
+                linb::any _v{static_cast<uint8_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::INT8_T) {
+            try {
+                linb::any _v{static_cast<int8_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT16_T) {
+            try {
+                linb::any _v{static_cast<uint16_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::INT16_T) {
+            try {
+                linb::any _v{static_cast<int16_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT32_T) {
+            try {
+                linb::any _v{static_cast<uint32_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::INT32_T) {
+            try {
+                linb::any _v{static_cast<int32_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT64_T) {
+            try {
+                linb::any _v{static_cast<uint64_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::INT64_T) {
+            try {
+                linb::any _v{static_cast<int64_t>(0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::FLOAT_T) {
+            try {
+                linb::any _v{static_cast<float>(0.0f)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::DOUBLE_T) {
+            try {
+                linb::any _v{static_cast<double>(0.0)};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if ((f.fieldDataType() == MetaMessage::MetaField::STRING_T) || (f.fieldDataType() == MetaMessage::MetaField::BYTES_T)) {
+            try {
+                linb::any _v                                          = std::string{};
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
+            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            }
+        } else if (f.fieldDataType() == MetaMessage::MetaField::MESSAGE_T) {
+            if (0 < m_mapForScopeOfMetaMessages.count(f.fieldDataTypeName())) {
+                // Create a GenericMessage from the decoded Proto-data.
+                cluon::GenericMessage gm;
+                gm.createFrom(m_mapForScopeOfMetaMessages[f.fieldDataTypeName()], m_scopeOfMetaMessages);
+
+                m_intermediateDataRepresentation[f.fieldIdentifier()] = linb::any{gm};
+            }
+        }
+    }
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/ToJSONVisitor.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace cluon {
+
+inline ToJSONVisitor::ToJSONVisitor(bool withOuterCurlyBraces, const std::map<uint32_t, bool> &mask) noexcept
+    : m_withOuterCurlyBraces(withOuterCurlyBraces)
+    , m_mask(mask) {}
+
+inline std::string ToJSONVisitor::json() const noexcept {
+    const std::string tmp{m_buffer.str()};
+    std::string retVal{"{}"};
+    if (2 < tmp.size()) {
+        retVal = {(m_withOuterCurlyBraces ? "{" : "") + tmp.substr(0, tmp.size() - 2) + (m_withOuterCurlyBraces ? "}" : "")};
+    }
+    return retVal;
+}
+
+inline void ToJSONVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
     (void)id;
-    (void)shortName;
     (void)longName;
+    (void)shortName;
+}
+
+inline void ToJSONVisitor::postVisit() noexcept {}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
+    }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << '\"' << v << '\"' << ',' << '\n';
+    }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
+    }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
+    }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
+    }
 }
 
-inline void FromProtoVisitor::postVisit() noexcept {}
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
+    }
+}
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = (0 != m_value);
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
     }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            v = (0 != linb::any_cast<uint64_t>(m_mapOfKeyValues[id]));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<char>(m_value);
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
     }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<char>(_v);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<int8_t>(fromZigZag8(static_cast<uint8_t>(m_value)));
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << std::setprecision(7) << v << std::setprecision(6) << ',' << '\n';
     }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<int8_t>(fromZigZag8(static_cast<uint8_t>(_v)));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+}
+
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << std::setprecision(11) << v << std::setprecision(6) << ',' << '\n';
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<uint8_t>(m_value);
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        m_buffer << '\"' << name << '\"' << ':' << '\"' << ToJSONVisitor::encodeBase64(v) << '\"' << ',' << '\n';
     }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<uint8_t>(_v);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+}
+
+inline std::string ToJSONVisitor::encodeBase64(const std::string &input) noexcept {
+    std::string retVal;
+
+    const std::string ALPHABET{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+    auto length{input.length()};
+    uint32_t index{0};
+    uint32_t value{0};
+
+    while (length > 2) {
+        value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 16;
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 8;
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++)));
+        retVal += ALPHABET.at((value & 0xFC0000) >> 18);
+        retVal += ALPHABET.at((value & 0x3F000) >> 12);
+        retVal += ALPHABET.at((value & 0xFC0) >> 6);
+        retVal += ALPHABET.at(value & 0x3F);
+        length -= 3;
+    }
+    if (length == 2) {
+        value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 16;
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 8;
+        retVal += ALPHABET.at((value & 0xFC0000) >> 18);
+        retVal += ALPHABET.at((value & 0x3F000) >> 12);
+        retVal += ALPHABET.at((value & 0xFC0) >> 6);
+        retVal += "=";
+    } else if (length == 1) {
+        value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 16;
+        retVal += ALPHABET.at((value & 0xFC0000) >> 18);
+        retVal += ALPHABET.at((value & 0x3F000) >> 12);
+        retVal += "==";
     }
+
+    return retVal;
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<int16_t>(fromZigZag16(static_cast<uint16_t>(m_value)));
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/ToCSVVisitor.hpp"
+//#include "cluon/ToJSONVisitor.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace cluon {
+
+inline ToCSVVisitor::ToCSVVisitor(char delimiter, bool withHeader, const std::map<uint32_t, bool> &mask) noexcept
+    : m_mask(mask)
+    , m_prefix("")
+    , m_delimiter(delimiter)
+    , m_withHeader(withHeader)
+    , m_isNested(false) {}
+
+inline ToCSVVisitor::ToCSVVisitor(const std::string &prefix, char delimiter, bool withHeader, bool isNested) noexcept
+    : m_prefix(prefix)
+    , m_delimiter(delimiter)
+    , m_withHeader(withHeader)
+    , m_isNested(isNested) {}
+
+inline void ToCSVVisitor::clear() noexcept {
+    m_bufferHeader.str("");
+    m_bufferValues.str("");
+    m_fillHeader = true;
+}
+
+inline std::string ToCSVVisitor::csv() const noexcept {
+    std::stringstream tmp;
+    if (m_withHeader) {
+        tmp << m_bufferHeader.str();
     }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<int16_t>(fromZigZag16(static_cast<uint16_t>(_v)));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+    tmp << m_bufferValues.str();
+    const std::string retVal{tmp.str()};
+    return retVal;
+}
+
+inline void ToCSVVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+    (void)id;
+    (void)shortName;
+    (void)longName;
+}
+
+inline void ToCSVVisitor::postVisit() noexcept {
+    if (m_fillHeader) {
+        m_bufferHeader << (m_isNested ? "" : "\n");
     }
+    m_fillHeader = false;
+    m_bufferValues << (m_isNested ? "" : "\n");
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<uint16_t>(m_value);
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<uint16_t>(_v);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<int32_t>(fromZigZag32(static_cast<uint32_t>(m_value)));
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<int32_t>(fromZigZag32(static_cast<uint32_t>(_v)));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<uint32_t>(m_value);
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<uint32_t>(_v);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << +v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = static_cast<int64_t>(fromZigZag64(static_cast<uint64_t>(m_value)));
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            uint64_t _v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-            v           = static_cast<int64_t>(fromZigZag64(_v));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << +v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = m_value;
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            v = linb::any_cast<uint64_t>(m_mapOfKeyValues[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = m_floatValue.floatValue;
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            v = linb::any_cast<float>(m_mapOfKeyValues[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = m_doubleValue.doubleValue;
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            v = linb::any_cast<double>(m_mapOfKeyValues[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << v << m_delimiter;
     }
 }
 
-inline void FromProtoVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (m_callToDecodeFromWithDirectVisit) {
-        v = std::string(m_stringValue.data(), static_cast<std::size_t>(m_value));
-    }
-    else if (m_mapOfKeyValues.count(id) > 0) {
-        try {
-            v = linb::any_cast<std::string>(m_mapOfKeyValues[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << v << m_delimiter;
     }
 }
 
-////////////////////////////////////////////////////////////////////////////////
-
-inline int8_t FromProtoVisitor::fromZigZag8(uint8_t v) noexcept {
-    return static_cast<int8_t>((v >> 1) ^ -(v & 1));
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+        }
+        m_bufferValues << v << m_delimiter;
+    }
 }
 
-inline int16_t FromProtoVisitor::fromZigZag16(uint16_t v) noexcept {
-    return static_cast<int16_t>((v >> 1) ^ -(v & 1));
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+        }
+        m_bufferValues << v << m_delimiter;
+    }
 }
 
-inline int32_t FromProtoVisitor::fromZigZag32(uint32_t v) noexcept {
-    return static_cast<int32_t>((v >> 1) ^ -(v & 1));
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+        }
+        m_bufferValues << std::setprecision(7) << v << std::setprecision(6) << m_delimiter;
+    }
 }
 
-inline int64_t FromProtoVisitor::fromZigZag64(uint64_t v) noexcept {
-    return static_cast<int64_t>((v >> 1) ^ -(v & 1));
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+        }
+        m_bufferValues << std::setprecision(11) << v << std::setprecision(6) << m_delimiter;
+    }
 }
 
-inline std::size_t FromProtoVisitor::fromVarInt(std::istream &in, uint64_t &value) noexcept {
-    value = 0;
-
-    constexpr uint64_t MASK  = 0x7f;
-    constexpr uint64_t SHIFT = 0x7;
-    constexpr uint64_t MSB   = 0x80;
-
-    std::size_t size = 0;
-    uint64_t C{0};
-    while (in.good()) {
-        auto x = in.get();
-        C = static_cast<uint64_t>(x);
-        value |= (C & MASK) << (SHIFT * size++);
-        if (!(C & MSB)) { // NOLINT
-            break;
+inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)typeName;
+    if ((0 == m_mask.count(id)) || m_mask[id]) {
+        if (m_fillHeader) {
+            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
         }
+        m_bufferValues << '\"' << cluon::ToJSONVisitor::encodeBase64(v) << '\"' << m_delimiter;
     }
-
-    return size;
 }
+
 } // namespace cluon
 /*
  * Copyright (C) 2017-2018  Christian Berger
@@ -11596,238 +15209,192 @@ inline std::size_t FromProtoVisitor::fromVarInt(std::istream &in, uint64_t &valu
 
 // clang-format off
 #ifdef WIN32
-    #include <Winsock2.h> // for ntohll
+    #include <Winsock2.h> // for htonll
 #endif
 // clang-format on
 
-//#include "cluon/FromLCMVisitor.hpp"
+//#include "cluon/ToLCMVisitor.hpp"
 
 #include <cstring>
-#include <algorithm>
-#include <iostream>
-#include <vector>
 
 namespace cluon {
 
-inline FromLCMVisitor::FromLCMVisitor() noexcept
-    : m_buffer(m_internalBuffer) {}
-
-inline FromLCMVisitor::FromLCMVisitor(std::stringstream &in) noexcept
-    : m_expectedHash{0}
-    , m_buffer(in) {}
-
-inline void FromLCMVisitor::decodeFrom(std::istream &in) noexcept {
-    // Reset internal states as this deserializer could be reused.
-    m_buffer.clear();
-    m_buffer.str("");
+inline std::string ToLCMVisitor::encodedData(bool withHash) const noexcept {
+    int64_t _hash = hash();
+    _hash         = static_cast<int64_t>(htobe64(_hash));
 
-    in.read(reinterpret_cast<char *>(&m_expectedHash), sizeof(int64_t));
-    m_expectedHash = static_cast<int64_t>(be64toh(m_expectedHash));
+    std::stringstream hashBuffer;
+    hashBuffer.write(reinterpret_cast<const char *>(&_hash), sizeof(int64_t));
 
-    m_buffer << in.rdbuf();
+    const std::string s{(withHash ? hashBuffer.str() : "") + m_buffer.str()};
+    return s;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-inline void FromLCMVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+inline void ToLCMVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
     (void)id;
     (void)shortName;
     (void)longName;
-
-    // Reset m_buffer read pointer to beginning only if we are not dealing with
-    // nested complex types as we are sharing our buffer with our parent message.
-    if (0 != m_expectedHash) {
-        m_buffer.clear();
-        m_buffer.seekg(0);
-        m_calculatedHash = 0x12345678;
-        m_hashes.clear();
-    }
 }
 
-inline void FromLCMVisitor::postVisit() noexcept {
-    if ((0 != m_expectedHash) && (m_expectedHash != hash())) {
-        std::cerr << "[cluon::FromLCMVisitor] Hash mismatch - decoding might have failed" << std::endl; // LCOV_EXCL_LINE
-    }
-}
+inline void ToLCMVisitor::postVisit() noexcept {}
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("boolean");
     calculateHash(0);
-    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(bool));
+    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(bool));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int8_t");
     calculateHash(0);
-    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(char));
+    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(char));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int8_t");
     calculateHash(0);
-    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
+    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(int8_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int8_t");
     calculateHash(0);
-    m_buffer.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
+    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(uint8_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int16_t");
     calculateHash(0);
-    int16_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int16_t));
-    v = static_cast<int16_t>(be16toh(_v));
+    int16_t _v = static_cast<int16_t>(htobe16(v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int16_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int16_t");
     calculateHash(0);
-    int16_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int16_t));
-    v = be16toh(_v);
+    int16_t _v = static_cast<int16_t>(htobe16(v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int16_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int32_t");
     calculateHash(0);
-    int32_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-    v = static_cast<int32_t>(be32toh(_v));
+    int32_t _v = static_cast<int32_t>(htobe32(v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int32_t");
     calculateHash(0);
-    int32_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-    v = be32toh(_v);
+    int32_t _v = static_cast<int32_t>(htobe32(v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int64_t");
     calculateHash(0);
-    int64_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int64_t));
-    v = static_cast<int64_t>(be64toh(_v));
+    int64_t _v = static_cast<int64_t>(htobe64(v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int64_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("int64_t");
     calculateHash(0);
-    int64_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int64_t));
-    v = be64toh(_v);
+    int64_t _v = static_cast<int64_t>(htobe64(v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int64_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("float");
     calculateHash(0);
     int32_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-    _v = static_cast<int32_t>(be32toh(_v));
-    std::memmove(&v, &_v, sizeof(int32_t));
+    std::memmove(&_v, &v, sizeof(int32_t));
+    _v = static_cast<int32_t>(htobe32(_v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
     (void)id;
     (void)typeName;
     calculateHash(name);
     calculateHash("double");
     calculateHash(0);
     int64_t _v{0};
-    m_buffer.read(reinterpret_cast<char *>(&_v), sizeof(int64_t));
-    _v = static_cast<int64_t>(be64toh(_v));
-    std::memmove(&v, &_v, sizeof(int64_t));
+    std::memmove(&_v, &v, sizeof(int64_t));
+    _v = static_cast<int64_t>(htobe64(_v));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int64_t));
 }
 
-inline void FromLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
     (void)id;
     (void)typeName;
-    (void)name;
-    (void)v;
     calculateHash(name);
     calculateHash("string");
     calculateHash(0);
 
-    int32_t length{0};
-    m_buffer.read(reinterpret_cast<char *>(&length), sizeof(int32_t));
-    length = static_cast<int32_t>(be32toh(length));
-
-    v.clear();
-    if (length > 0) {
-        std::vector<char> buffer;
-        buffer.reserve(static_cast<uint32_t>(length));
-#ifdef WIN32
-        for (uint32_t i = 0; i < static_cast<uint32_t>(length); i++) {
-            char c;
-            m_buffer.get(c);
-            buffer.push_back(c);
-        }
-#else
-        m_buffer.read(static_cast<char *>(&buffer[0]), static_cast<std::streamsize>(length));
-#endif
-        const std::string s(buffer.begin(), buffer.begin() + length - 1); // Skip trailing '\0'.
-        v = s;
-    }
+    const std::size_t LENGTH = v.length();
+    int32_t _v               = static_cast<int32_t>(htobe32(static_cast<uint32_t>(LENGTH + 1)));
+    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
+    m_buffer.write(v.c_str(), static_cast<std::streamsize>(LENGTH)); // LENGTH won't be negative.
+    m_buffer << '\0';
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-inline int64_t FromLCMVisitor::hash() const noexcept {
+inline int64_t ToLCMVisitor::hash() const noexcept {
     // Apply ZigZag encoding for hash from this message's fields and depending
     // hashes for complex nested types.
-    int64_t tmp{m_calculatedHash};
+    int64_t tmp{m_hash};
     for (int64_t v : m_hashes) { tmp += v; }
 
     const int64_t hash = (tmp << 1) + ((tmp >> 63) & 1);
     return hash;
 }
 
-inline void FromLCMVisitor::calculateHash(char c) noexcept {
-    m_calculatedHash = ((m_calculatedHash << 8) ^ (m_calculatedHash >> 55)) + c;
+inline void ToLCMVisitor::calculateHash(char c) noexcept {
+    m_hash = ((m_hash << 8) ^ (m_hash >> 55)) + c;
 }
 
-inline void FromLCMVisitor::calculateHash(const std::string &s) noexcept {
+inline void ToLCMVisitor::calculateHash(const std::string &s) noexcept {
     const std::string tmp{(s.length() > 255 ? s.substr(0, 255) : s)};
     const uint8_t length{static_cast<uint8_t>(tmp.length())};
     calculateHash(static_cast<char>(length));
-    for (auto c : tmp) { calculateHash(c); }
+    for (auto c : s) { calculateHash(c); }
 }
 
 } // namespace cluon
@@ -11839,1705 +15406,1912 @@ inline void FromLCMVisitor::calculateHash(const std::string &s) noexcept {
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+//#include "cluon/LCMToGenericMessage.hpp"
+//#include "cluon/FromLCMVisitor.hpp"
+//#include "cluon/MessageParser.hpp"
+
+#include <array>
+#include <iostream>
+#include <sstream>
+
 // clang-format off
 #ifdef WIN32
-    #include <Winsock2.h> // for ntohl, ntohs
-#endif
-// clang-format on
+    #undef be32toh
+    #define be32toh(x) __ntohl(x)
 
-//#include "cluon/FromMsgPackVisitor.hpp"
+    #include <cstdint>
+    #include <cstring>
+    uint32_t __ntohl(const uint32_t v) {
+        uint8_t d[4] = {};
+        std::memmove(&d, &v, sizeof(d));
 
-#include <cstring>
-#include <vector>
+        return ((uint32_t) d[3] << 0)
+             | ((uint32_t) d[2] << 8)
+             | ((uint32_t) d[1] << 16)
+             | ((uint32_t) d[0] << 24);
+    }
+#endif
+// clang-format on
 
 namespace cluon {
 
-inline FromMsgPackVisitor::FromMsgPackVisitor() noexcept
-    : m_keyValues{m_data} {}
-
-inline FromMsgPackVisitor::FromMsgPackVisitor(std::map<std::string, FromMsgPackVisitor::MsgPackKeyValue> &preset) noexcept
-    : m_keyValues{preset} {}
-
-inline MsgPackConstants FromMsgPackVisitor::getFormatFamily(uint8_t T) noexcept {
-    MsgPackConstants formatFamily{MsgPackConstants::UNKNOWN_FORMAT};
-
-    if (static_cast<uint8_t>(MsgPackConstants::IS_FALSE) == T) {
-        formatFamily = MsgPackConstants::BOOL_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::IS_TRUE) == T) {
-        formatFamily = MsgPackConstants::BOOL_FORMAT;
-    } else if (0x7F >= T) {
-        formatFamily = MsgPackConstants::UINT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::UINT8) == T) {
-        formatFamily = MsgPackConstants::UINT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::UINT16) == T) {
-        formatFamily = MsgPackConstants::UINT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::UINT32) == T) {
-        formatFamily = MsgPackConstants::UINT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::UINT64) == T) {
-        formatFamily = MsgPackConstants::UINT_FORMAT;
-    } else if (0xE0 <= T) {
-        formatFamily = MsgPackConstants::INT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::INT8) == T) {
-        formatFamily = MsgPackConstants::INT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::INT16) == T) {
-        formatFamily = MsgPackConstants::INT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::INT32) == T) {
-        formatFamily = MsgPackConstants::INT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::INT64) == T) {
-        formatFamily = MsgPackConstants::INT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::FLOAT) == T) {
-        formatFamily = MsgPackConstants::FLOAT_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::DOUBLE) == T) {
-        formatFamily = MsgPackConstants::FLOAT_FORMAT;
-    } else if ((static_cast<uint8_t>(MsgPackConstants::FIXSTR) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXSTR_END) > T)) {
-        formatFamily = MsgPackConstants::STR_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::STR8) == T) {
-        formatFamily = MsgPackConstants::STR_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::STR16) == T) {
-        formatFamily = MsgPackConstants::STR_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::STR32) == T) {
-        formatFamily = MsgPackConstants::STR_FORMAT;
-    } else if ((static_cast<uint8_t>(MsgPackConstants::FIXMAP) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXMAP_END) > T)) {
-        formatFamily = MsgPackConstants::MAP_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::MAP16) == T) {
-        formatFamily = MsgPackConstants::MAP_FORMAT;
-    } else if (static_cast<uint8_t>(MsgPackConstants::MAP32) == T) { // LCOV_EXCL_LINE
-        formatFamily = MsgPackConstants::MAP_FORMAT;                 // LCOV_EXCL_LINE
-    }
+inline int32_t LCMToGenericMessage::setMessageSpecification(const std::string &ms) noexcept {
+    int32_t retVal{-1};
 
-    return formatFamily;
-}
+    m_listOfMetaMessages.clear();
+    m_scopeOfMetaMessages.clear();
 
-inline uint64_t FromMsgPackVisitor::readUint(std::istream &in) noexcept {
-    uint64_t retVal{0};
-    if (in.good()) {
-        uint8_t c = static_cast<uint8_t>(in.get());
-        if (MsgPackConstants::UINT_FORMAT == getFormatFamily(c)) {
-            if (0x7F >= c) {
-                retVal = static_cast<uint64_t>(c);
-            } else if (static_cast<uint8_t>(MsgPackConstants::UINT8) == c) {
-                uint8_t v{0};
-                in.read(reinterpret_cast<char *>(&v), sizeof(uint8_t));
-                retVal = static_cast<uint64_t>(v);
-            } else if (static_cast<uint8_t>(MsgPackConstants::UINT16) == c) {
-                uint16_t v{0};
-                in.read(reinterpret_cast<char *>(&v), sizeof(uint16_t));
-                v      = be16toh(v);
-                retVal = static_cast<uint64_t>(v);
-            } else if (static_cast<uint8_t>(MsgPackConstants::UINT32) == c) {
-                uint32_t v{0};
-                in.read(reinterpret_cast<char *>(&v), sizeof(uint32_t));
-                v      = be32toh(v);
-                retVal = static_cast<uint64_t>(v);
-            } else if (static_cast<uint8_t>(MsgPackConstants::UINT64) == c) {
-                in.read(reinterpret_cast<char *>(&retVal), sizeof(uint64_t));
-                retVal = be64toh(retVal);
-            }
-        }
+    cluon::MessageParser mp;
+    auto parsingResult = mp.parse(ms);
+    if (cluon::MessageParser::MessageParserErrorCodes::NO_MESSAGEPARSER_ERROR == parsingResult.second) {
+        m_listOfMetaMessages = parsingResult.first;
+        for (const auto &mm : m_listOfMetaMessages) { m_scopeOfMetaMessages[mm.messageName()] = mm; }
+        retVal = static_cast<int32_t>(m_listOfMetaMessages.size());
     }
     return retVal;
 }
 
-inline int64_t FromMsgPackVisitor::readInt(std::istream &in) noexcept {
-    int64_t retVal{0};
-    if (in.good()) {
-        int8_t c = static_cast<int8_t>(in.get());
-        if (MsgPackConstants::INT_FORMAT == getFormatFamily(static_cast<uint8_t>(c))) {
-            if (0xE0 <= static_cast<uint8_t>(c)) {
-                retVal = static_cast<int64_t>(c);
-            } else if (static_cast<int8_t>(MsgPackConstants::INT8) == c) {
-                int8_t v{0};
-                in.read(reinterpret_cast<char *>(&v), sizeof(int8_t));
-                retVal = static_cast<int64_t>(v);
-            } else if (static_cast<int8_t>(MsgPackConstants::INT16) == c) {
-                int16_t v{0};
-                in.read(reinterpret_cast<char *>(&v), sizeof(int16_t));
-                v      = static_cast<int16_t>(be16toh(v));
-                retVal = static_cast<int64_t>(v);
-            } else if (static_cast<int8_t>(MsgPackConstants::INT32) == c) {
-                int32_t v{0};
-                in.read(reinterpret_cast<char *>(&v), sizeof(int32_t));
-                v      = static_cast<int32_t>(be32toh(v));
-                retVal = static_cast<int64_t>(v);
-            } else if (static_cast<int8_t>(MsgPackConstants::INT64) == c) {
-                in.read(reinterpret_cast<char *>(&retVal), sizeof(int64_t));
-                retVal = static_cast<int64_t>(be64toh(retVal));
-            }
-        }
-    }
-    return retVal;
-}
+inline cluon::GenericMessage LCMToGenericMessage::getGenericMessage(const std::string &data) noexcept {
+    cluon::GenericMessage gm;
 
-inline std::string FromMsgPackVisitor::readString(std::istream &in) noexcept {
-    std::string retVal{""};
-    if (in.good()) {
-        uint8_t c = static_cast<uint8_t>(in.get());
-        if (MsgPackConstants::STR_FORMAT == getFormatFamily(c)) {
-            uint32_t length{0};
-            const uint8_t T = static_cast<uint8_t>(c);
-            if ((static_cast<uint8_t>(MsgPackConstants::FIXSTR) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXSTR_END) > T)) {
-                length = T - static_cast<uint8_t>(MsgPackConstants::FIXSTR);
-            } else if (static_cast<uint8_t>(MsgPackConstants::STR8) == T) {
-                uint8_t _length{0};
-                in.read(reinterpret_cast<char *>(&_length), sizeof(uint8_t));
-                length = _length;
-            } else if (static_cast<uint8_t>(MsgPackConstants::STR16) == T) {
-                uint16_t _length{0};
-                in.read(reinterpret_cast<char *>(&_length), sizeof(uint16_t));
-                length = be16toh(_length);
-            } else if (static_cast<uint8_t>(MsgPackConstants::STR32) == T) {
-                in.read(reinterpret_cast<char *>(&length), sizeof(uint32_t));
-                length = be32toh(length);
+    if (!m_listOfMetaMessages.empty()) {
+        constexpr uint8_t LCM_HEADER_SIZE{4 /*magic number*/ + 4 /*sequence number*/ + 1 /*'\0' after channel name*/};
+        if (LCM_HEADER_SIZE < data.size()) {
+            // First, read magic number.
+            constexpr uint32_t MAGIC_NUMBER_LCM2{0x4c433032};
+            uint32_t offset{0};
+            uint32_t magicNumber{0};
+            {
+                std::stringstream sstr{std::string(&data[offset], 4)};
+                // clang-format off
+                sstr.read(reinterpret_cast<char *>(&magicNumber), sizeof(uint32_t)); /* Flawfinder: ignore */ // NOLINT
+                // clang-format on
+                magicNumber = be32toh(magicNumber);
             }
+            if (MAGIC_NUMBER_LCM2 == magicNumber) {
+                offset += 4;
 
-            if (0 < length) {
-                std::vector<char> buffer;
-                buffer.reserve(length);
-#ifdef WIN32
-                for (uint32_t i = 0; i < static_cast<uint32_t>(length); i++) {
-                    char c;
-                    in.get(c);
-                    buffer.push_back(c);
+                // Next, read sequence number in case of fragmented data.
+                uint32_t sequenceNumber{0};
+                {
+                    std::stringstream sstr{std::string(&data[offset], 4)};
+                    // clang-format off
+                    sstr.read(reinterpret_cast<char *>(&sequenceNumber), sizeof(uint32_t)); /* Flawfinder: ignore */ // NOLINT
+                    // clang-format on
+                    sequenceNumber = be32toh(sequenceNumber);
                 }
-#else
-                in.read(static_cast<char *>(&buffer[0]), static_cast<std::streamsize>(length));
-#endif
-                retVal = std::string(buffer.data(), length);
-            }
-        }
-    }
-    return retVal;
-}
+                // Only support for non-fragmented messages.
+                if (0 == sequenceNumber) {
+                    offset += 4;
 
-inline std::map<std::string, FromMsgPackVisitor::MsgPackKeyValue> FromMsgPackVisitor::readKeyValues(std::istream &in) noexcept {
-    std::map<std::string, FromMsgPackVisitor::MsgPackKeyValue> keyValues;
-    while (in.good()) {
-        uint8_t c = static_cast<uint8_t>(in.get());
-        if (MsgPackConstants::MAP_FORMAT == getFormatFamily(c)) {
-            // First, search for map opening token.
-            const uint8_t T = static_cast<uint8_t>(c);
-            uint32_t tokensToRead{0};
-            if ((static_cast<uint8_t>(MsgPackConstants::FIXMAP) <= T) && (static_cast<uint8_t>(MsgPackConstants::FIXMAP_END) > T)) {
-                tokensToRead = T - static_cast<uint8_t>(MsgPackConstants::FIXMAP);
-            } else if (static_cast<uint8_t>(MsgPackConstants::MAP16) == T) {
-                uint16_t tokens{0};
-                in.read(reinterpret_cast<char *>(&tokens), sizeof(uint16_t));
-                tokensToRead = be16toh(tokens);
-            } else if (static_cast<uint8_t>(MsgPackConstants::MAP32) == T) {        // LCOV_EXCL_LINE
-                in.read(reinterpret_cast<char *>(&tokensToRead), sizeof(uint32_t)); // LCOV_EXCL_LINE
-                tokensToRead = be32toh(tokensToRead);                               // LCOV_EXCL_LINE
-            }
+                    const std::string::size_type START_POSITION = offset;
+                    std::string::size_type pos                  = data.find('\0', START_POSITION); // Extract channel name.
+                    if (std::string::npos != pos) {
+                        const std::string CHANNEL_NAME(data.substr(START_POSITION, (pos - START_POSITION)));
 
-            // Next, read pairs string/value.
-            while (0 < tokensToRead) {
-                MsgPackKeyValue entry;
-                entry.m_key = readString(in);
-                // Read next byte and determine format family.
-                c                    = static_cast<uint8_t>(in.get());
-                entry.m_formatFamily = getFormatFamily(c);
+                        // Next, find the MetaMessage corresponding to the channel name
+                        // and create a Message therefrom based on the decoded LCM data.
+                        if ((0 < m_scopeOfMetaMessages.count(CHANNEL_NAME)) && (std::string::npos != (pos + 1))) {
+                            // data[offset+i] marks now the beginning of the payload to be decoded.
+                            std::stringstream sstr{data.substr(pos + 1)};
 
-                if (MsgPackConstants::BOOL_FORMAT == entry.m_formatFamily) {
-                    entry.m_value = false;
-                    if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::IS_TRUE)) {
-                        entry.m_value = true;
-                    } else if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::IS_FALSE)) {
-                        entry.m_value = false;
-                    }
-                } else if (MsgPackConstants::UINT_FORMAT == entry.m_formatFamily) {
-                    in.unget(); // Last character needs to be put back to process the uints correctly as it might
-                                // contain the value.
-                    entry.m_value = readUint(in);
-                } else if (MsgPackConstants::INT_FORMAT == entry.m_formatFamily) {
-                    in.unget(); // Last character needs to be put back to process the ints correctly as it might contain
-                                // the value.
-                    entry.m_value = readInt(in);
-                } else if (MsgPackConstants::FLOAT_FORMAT == entry.m_formatFamily) {
-                    if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::FLOAT)) {
-                        uint32_t _v{0};
-                        in.read(reinterpret_cast<char *>(&_v), sizeof(uint32_t));
-                        _v = be32toh(_v);
-                        float v{0.0f};
-                        std::memmove(&v, &_v, sizeof(float));
-                        entry.m_value = v;
-                    }
-                    if (static_cast<uint8_t>(c) == static_cast<uint8_t>(MsgPackConstants::DOUBLE)) {
-                        uint64_t _v{0};
-                        in.read(reinterpret_cast<char *>(&_v), sizeof(uint64_t));
-                        _v = be64toh(_v);
-                        double v{0.0};
-                        std::memmove(&v, &_v, sizeof(double));
-                        entry.m_value = v;
+                            cluon::FromLCMVisitor fromLCM;
+                            fromLCM.decodeFrom(sstr);
+
+                            gm.createFrom(m_scopeOfMetaMessages[CHANNEL_NAME], m_listOfMetaMessages);
+                            gm.accept(fromLCM);
+                        }
                     }
-                } else if (MsgPackConstants::STR_FORMAT == entry.m_formatFamily) {
-                    in.unget(); // Last character needs to be put back to process the string correctly as it might
-                                // encode its length.
-                    entry.m_value = readString(in);
-                } else if (MsgPackConstants::MAP_FORMAT == entry.m_formatFamily) {
-                    in.unget(); // Last character needs to be put back to process the contained nested map correctly as
-                                // it might encode its length.
-                    entry.m_value = readKeyValues(in);
                 }
-
-                keyValues[entry.m_key] = entry;
-                tokensToRead--;
             }
-            // Stop processing further tokens (might be handled from outer decoder).
-            break;
         }
     }
-    return keyValues;
+
+    return gm;
 }
 
-inline void FromMsgPackVisitor::decodeFrom(std::istream &in) noexcept {
-    (void)in;
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-    m_keyValues = readKeyValues(in);
+// clang-format off
+#ifdef WIN32
+    #include <Winsock2.h> // for htonl, htons
+#endif
+// clang-format on
+
+//#include "cluon/ToMsgPackVisitor.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace cluon {
+
+inline std::string ToMsgPackVisitor::encodedData() const noexcept {
+    std::stringstream prefix;
+    if (m_numberOfFields <= 0xF) {
+        const uint8_t pairs = static_cast<uint8_t>(MsgPackConstants::FIXMAP) | static_cast<uint8_t>(m_numberOfFields);
+        prefix.write(reinterpret_cast<const char *>(&pairs), sizeof(uint8_t));
+    } else if ((m_numberOfFields > 0xF) && (m_numberOfFields <= 0xFFFF)) {
+        const uint8_t pairs = static_cast<uint8_t>(MsgPackConstants::MAP16);
+        prefix.write(reinterpret_cast<const char *>(&pairs), sizeof(uint8_t));
+        uint16_t n = htobe16(static_cast<uint16_t>(m_numberOfFields));
+        prefix.write(reinterpret_cast<const char *>(&n), sizeof(uint16_t));
+    } else if (m_numberOfFields > 0xFFFF) {                                    // LCOV_EXCL_LINE
+        const uint8_t pairs = static_cast<uint8_t>(MsgPackConstants::MAP32);   // LCOV_EXCL_LINE
+        prefix.write(reinterpret_cast<const char *>(&pairs), sizeof(uint8_t)); // LCOV_EXCL_LINE
+        uint32_t n = htobe32(static_cast<uint32_t>(m_numberOfFields));         // LCOV_EXCL_LINE
+        prefix.write(reinterpret_cast<const char *>(&n), sizeof(uint32_t));    // LCOV_EXCL_LINE
+    }
+    std::string s{prefix.str() + m_buffer.str()};
+    return s;
 }
 
-inline void FromMsgPackVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
+inline void ToMsgPackVisitor::encode(std::ostream &o, const std::string &s) {
+    const uint32_t LENGTH{static_cast<uint32_t>(s.size())};
+    if (LENGTH < 32) {
+        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::FIXSTR) | static_cast<uint8_t>(LENGTH);
+        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
+    } else if (LENGTH <= 0xFF) {
+        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::STR8);
+        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
+        uint8_t len = static_cast<uint8_t>(LENGTH);
+        o.write(reinterpret_cast<const char *>(&len), sizeof(uint8_t));
+    } else if (LENGTH <= 0xFFFF) {
+        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::STR16);
+        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
+        uint16_t len = htobe16(static_cast<uint16_t>(LENGTH));
+        o.write(reinterpret_cast<const char *>(&len), sizeof(uint16_t));
+    } else {
+        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::STR32);
+        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
+        uint32_t len = htobe32(LENGTH);
+        o.write(reinterpret_cast<const char *>(&len), sizeof(uint32_t));
+    }
+    o.write(s.c_str(), static_cast<std::streamsize>(LENGTH)); // LENGTH won't be negative.
+}
+
+inline void ToMsgPackVisitor::encodeUint(std::ostream &o, uint64_t v) {
+    if (0x7f >= v) {
+        const uint8_t _v = static_cast<uint8_t>(v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint8_t));
+    } else if (0xFF >= v) {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT8);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        const uint8_t _v = static_cast<uint8_t>(v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint8_t));
+    } else if (0xFFFF >= v) {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT16);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        uint16_t _v = static_cast<uint16_t>(v);
+        _v          = htobe16(_v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint16_t));
+    } else if (0xFFFFFFFF >= v) {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT32);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        uint32_t _v = static_cast<uint32_t>(v);
+        _v          = htobe32(_v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint32_t));
+    } else {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT64);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        uint64_t _v = v;
+        _v          = htobe64(_v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint64_t));
+    }
+}
+
+inline void ToMsgPackVisitor::encodeInt(std::ostream &o, int64_t v) {
+    if (-31 <= v) {
+        int8_t _v = static_cast<int8_t>(v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(int8_t));
+    } else if (std::numeric_limits<int8_t>::lowest() <= v) {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT8);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        int8_t _v = static_cast<int8_t>(v);
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(int8_t));
+    } else if (std::numeric_limits<int16_t>::lowest() <= v) {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT16);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        int16_t _v = static_cast<int16_t>(v);
+        _v         = static_cast<int16_t>(htobe16(_v));
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(int16_t));
+    } else if (std::numeric_limits<int32_t>::lowest() <= v) {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT32);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        int32_t _v = static_cast<int32_t>(v);
+        _v         = static_cast<int32_t>(htobe32(_v));
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(int32_t));
+    } else {
+        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT64);
+        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+        int64_t _v = static_cast<int64_t>(v);
+        _v         = static_cast<int64_t>(htobe64(_v));
+        o.write(reinterpret_cast<const char *>(&_v), sizeof(int64_t));
+    }
+}
+
+inline void ToMsgPackVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
     (void)id;
     (void)shortName;
     (void)longName;
+
+    m_numberOfFields = 0;
+    m_buffer.str("");
 }
 
-inline void FromMsgPackVisitor::postVisit() noexcept {}
+inline void ToMsgPackVisitor::postVisit() noexcept {}
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<bool>(m_keyValues[name].m_value);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
-}
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<std::string>(m_keyValues[name].m_value).at(0);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    encode(m_buffer, name);
+    const uint8_t value = (v ? static_cast<uint8_t>(MsgPackConstants::IS_TRUE) : static_cast<uint8_t>(MsgPackConstants::IS_FALSE));
+    m_buffer.write(reinterpret_cast<const char *>(&value), sizeof(uint8_t));
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = static_cast<int8_t>(linb::any_cast<int64_t>(m_keyValues[name].m_value));
-        } catch (const linb::bad_any_cast &) {
-            // A positive value was stored.
-            try {
-                v = static_cast<int8_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        }
-    }
+
+    encode(m_buffer, name);
+    const std::string s(1, v);
+    encode(m_buffer, s);
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = static_cast<uint8_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint8_t>(v));
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = static_cast<int16_t>(linb::any_cast<int64_t>(m_keyValues[name].m_value));
-        } catch (const linb::bad_any_cast &) {
-            // A positive value was stored.
-            try {
-                v = static_cast<int16_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        }
-    }
+
+    encode(m_buffer, name);
+    encodeUint(m_buffer, v);
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = static_cast<uint16_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint16_t>(v));
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = static_cast<int32_t>(linb::any_cast<int64_t>(m_keyValues[name].m_value));
-        } catch (const linb::bad_any_cast &) {
-            // A positive value was stored.
-            try {
-                v = static_cast<int32_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        }
-    }
+
+    encode(m_buffer, name);
+    encodeUint(m_buffer, v);
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = static_cast<uint32_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint32_t>(v));
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<int64_t>(m_keyValues[name].m_value);
-        } catch (const linb::bad_any_cast &) {
-            // A positive value was stored.
-            try {
-                v = static_cast<int64_t>(linb::any_cast<uint64_t>(m_keyValues[name].m_value));
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        }
-    }
+
+    encode(m_buffer, name);
+    encodeUint(m_buffer, v);
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<uint64_t>(m_keyValues[name].m_value);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint64_t>(v));
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<float>(m_keyValues[name].m_value);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    encodeUint(m_buffer, v);
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<double>(m_keyValues[name].m_value);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    const uint8_t t = static_cast<uint8_t>(MsgPackConstants::FLOAT);
+    m_buffer.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+    uint32_t _v{0};
+    std::memmove(&_v, &v, sizeof(float));
+    _v = htobe32(_v);
+    m_buffer.write(reinterpret_cast<const char *>(&_v), sizeof(uint32_t));
+    m_numberOfFields++;
 }
 
-inline void FromMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
     (void)id;
     (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            v = linb::any_cast<std::string>(m_keyValues[name].m_value);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+
+    encode(m_buffer, name);
+    const uint8_t t = static_cast<uint8_t>(MsgPackConstants::DOUBLE);
+    m_buffer.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
+    uint64_t _v{0};
+    std::memmove(&_v, &v, sizeof(double));
+    _v = htobe64(_v);
+    m_buffer.write(reinterpret_cast<const char *>(&_v), sizeof(double));
+    m_numberOfFields++;
+}
+
+inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+    (void)id;
+    (void)typeName;
+
+    encode(m_buffer, name);
+    encode(m_buffer, v);
+    m_numberOfFields++;
 }
 
 } // namespace cluon
 /*
- * Copyright (C) 2017-2019  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/FromJSONVisitor.hpp"
-//#include "cluon/stringtoolbox.hpp"
+//#include "cluon/SharedMemoryRing.hpp"
 
-#include <algorithm>
-#include <array>
-#include <cstring>
-#include <iterator>
-#include <regex>
-#include <sstream>
-#include <vector>
+// clang-format off
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <linux/futex.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+// clang-format on
 
+#include <atomic>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
-namespace cluon {
-
-inline FromJSONVisitor::FromJSONVisitor() noexcept
-    : m_keyValues{m_data} {}
+#include <thread>
 
-inline FromJSONVisitor::FromJSONVisitor(std::map<std::string, FromJSONVisitor::JSONKeyValue> &preset) noexcept
-    : m_keyValues{preset} {}
+namespace cluon {
 
-inline std::map<std::string, FromJSONVisitor::JSONKeyValue> FromJSONVisitor::readKeyValues(std::string &input) noexcept {
-    const std::string MATCH_JSON
-        = R"((?:\"|\')(?:[^"]*)(?:\"|\')(?=:)(?:\:\s*)(?:\"|\')?(?:true|false|[\-]{0,1}[0-9]+[\.][0-9]+|[\-]{0,1}[0-9]+|[0-9a-zA-Z\+\-\,\.\$\ \=]*)(?:\"|\')?)";
+struct SharedMemoryRing::Header {
+    enum : uint32_t {
+        UNINITIALIZED = 0,
+        INITIALIZING  = 1,
+        READY         = 2,
+    };
 
-    std::map<std::string, FromJSONVisitor::JSONKeyValue> result;
-    std::string oldInput;
-    try {
-        std::smatch m;
-        do {
-            std::regex_search(input, m, std::regex(MATCH_JSON));
+    std::atomic<uint32_t> m_state;
+    uint32_t m_slots;
+    uint32_t m_slotSize;
 
-            if (m.size() > 0) {
-                std::string match{m[0]};
-                std::vector<std::string> retVal = stringtoolbox::split(match, ':');
-                if ( (retVal.size() == 2) && (stringtoolbox::trim(retVal[1]).size() == 0) ) {
-                    std::string keyOfNestedObject{stringtoolbox::trim(retVal[0])};
-                    keyOfNestedObject = stringtoolbox::split(keyOfNestedObject, '"')[1];
-                    {
-                        std::string suffix(m.suffix());
-                        suffix   = stringtoolbox::trim(suffix);
-                        oldInput = input;
-                        input    = suffix;
-                    }
+    // Written by all producers; kept apart from the futex read by waiting readers.
+    alignas(64) std::atomic<uint64_t> m_writeIndex;
+    alignas(64) std::atomic<uint32_t> m_futex;
+    std::atomic<uint32_t> m_waiters;
+};
 
-                    auto mapOfNestedValues = readKeyValues(input);
+struct SharedMemoryRing::Participant {
+    // 0 for a free entry.
+    std::atomic<uint64_t> m_identifier;
+    // Milliseconds of the monotonic clock, which is the same for all processes.
+    std::atomic<int64_t> m_heartbeat;
+};
 
-                    JSONKeyValue kv;
-                    kv.m_key   = keyOfNestedObject;
-                    kv.m_type  = JSONConstants::OBJECT;
-                    kv.m_value = mapOfNestedValues;
+struct SharedMemoryRing::Slot {
+    // 2 * index + 1 while the slot is written for index, 2 * index + 2 once it is published.
+    alignas(64) std::atomic<uint64_t> m_sequence;
+    uint32_t m_length;
+    uint64_t m_sender;
+};
 
-                    result[keyOfNestedObject] = kv;
-                }
-                if ( (retVal.size() == 2) && (stringtoolbox::trim(retVal[1]).size() > 0) ) {
-                    auto e = std::make_pair(stringtoolbox::trim(retVal[0]), stringtoolbox::trim(retVal[1]));
+inline SharedMemoryRing::SharedMemoryRing(const std::string &name, uint32_t slots, uint32_t slotSize) noexcept
+    : m_name{name}
+    , m_slots{slots}
+    , m_slotSize{slotSize} {
+#ifdef __linux__
+    if (m_name.empty() || (0 == m_slots) || (0 == m_slotSize) || !std::atomic<uint64_t>{}.is_lock_free()) {
+        return;
+    }
+    if ('/' != m_name[0]) {
+        m_name = "/" + m_name;
+    }
+    // Header and slot headers are multiples of 64 bytes; keep the participants and the slots aligned as well.
+    m_slotStride  = sizeof(Slot) + (m_slotSize + 63) / 64 * 64;
+    m_slotsOffset = sizeof(Header) + (MAX_PARTICIPANTS * sizeof(Participant) + 63) / 64 * 64;
+    m_size        = m_slotsOffset + m_slots * m_slotStride;
 
-                    JSONKeyValue kv;
-                    kv.m_key = stringtoolbox::split(e.first, '"')[1];
+    int fd = ::shm_open(m_name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (-1 == fd) {
+        std::cerr << "[cluon::SharedMemoryRing]: Failed to open " << m_name << ": " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+        return;                                                                                                         // LCOV_EXCL_LINE
+    }
+    struct stat info;
+    if ((0 == ::fstat(fd, &info)) && (static_cast<std::size_t>(info.st_size) < m_size)) {
+        // Creators race to set the same size.
+        if (0 != ::ftruncate(fd, static_cast<off_t>(m_size))) {
+            std::cerr << "[cluon::SharedMemoryRing]: Failed to resize " << m_name << ": " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+        }
+    }
+    if ((0 == ::fstat(fd, &info)) && (static_cast<std::size_t>(info.st_size) == m_size)) {
+        void *memory = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (MAP_FAILED != memory) {
+            m_memory = static_cast<char *>(memory);
+        } else {
+            std::cerr << "[cluon::SharedMemoryRing]: Failed to map " << m_name << ": " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+        }
+    } else {
+        std::cerr << "[cluon::SharedMemoryRing]: " << m_name << " exists with a different size." << std::endl;
+    }
+    ::close(fd);
+
+    if (nullptr != m_memory) {
+        // New shared memory is zeroed; the first process to see it uninitialized initializes it.
+        Header *header = reinterpret_cast<Header *>(m_memory);
+        uint32_t expected{Header::UNINITIALIZED};
+        if (header->m_state.compare_exchange_strong(expected, Header::INITIALIZING)) {
+            header->m_slots    = m_slots;
+            header->m_slotSize = m_slotSize;
+            header->m_state.store(Header::READY, std::memory_order_release);
+        } else {
+            for (uint32_t i{0}; (i < 1000) && (Header::READY != header->m_state.load(std::memory_order_acquire)); i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
 
-                    if ((e.second.size() > 0) && (e.second.at(0) == '"')) {
-                        kv.m_type  = JSONConstants::STRING;
-                        kv.m_value = std::string(e.second).substr(1);
-                    } else if ((e.second.size() > 0) && ((e.second == "false") || (e.second == "true"))) {
-                        kv.m_type  = (e.second == "true" ? JSONConstants::IS_TRUE : JSONConstants::IS_FALSE);
-                        kv.m_value = e.second == "true";
-                    } else {
-                        kv.m_type = JSONConstants::NUMBER;
-                        std::stringstream tmp(e.second);
-                        double v;
-                        tmp >> v;
-                        kv.m_value = v;
-                    }
+        if ((Header::READY == header->m_state.load(std::memory_order_acquire)) && (m_slots == header->m_slots) && (m_slotSize == header->m_slotSize)) {
+            m_header = header;
+        } else {
+            std::cerr << "[cluon::SharedMemoryRing]: " << m_name << " has a different layout." << std::endl;
+            ::munmap(m_memory, m_size);
+            m_memory = nullptr;
+        }
+    }
+#else
+    std::cerr << "[cluon::SharedMemoryRing]: Not available on this platform." << std::endl;
+#endif
+}
 
-                    result[kv.m_key] = kv;
+inline SharedMemoryRing::~SharedMemoryRing() noexcept {
+#ifdef __linux__
+    if (nullptr != m_memory) {
+        ::munmap(m_memory, m_size);
+    }
+#endif
+}
 
-                    {
-                        std::string suffix(m.suffix());
-                        suffix   = stringtoolbox::trim(suffix);
-                        oldInput = input;
-                        input    = suffix;
-                        if (suffix.size() > 0 && suffix.at(0) == '}') {
-                            break; // Nested payload complete; return.
-                        }
-                    }
-                }
-            }
-        } while (!m.empty() && (oldInput != input));
-    } catch (std::regex_error &) { // LCOV_EXCL_LINE
-    } catch (std::bad_cast &) {}   // LCOV_EXCL_LINE
+inline bool SharedMemoryRing::valid() const noexcept {
+    return nullptr != m_header;
+}
 
-    return result;
+inline uint32_t SharedMemoryRing::slotSize() const noexcept {
+    return m_slotSize;
 }
 
-inline void FromJSONVisitor::decodeFrom(std::istream &in) noexcept {
-    m_keyValues.clear();
+inline uint64_t SharedMemoryRing::lost() const noexcept {
+    return m_lost.load();
+}
 
-    std::string s;
-    std::istream_iterator<char> it(in), it_end;
-    std::copy(it, it_end, std::insert_iterator<std::string>(s, s.begin()));
+inline uint64_t SharedMemoryRing::attach() const noexcept {
+    return valid() ? m_header->m_writeIndex.load() : 0;
+}
 
-    // Remove whitespace characters like newline, carriage return, or tab.
-    s.erase(std::remove_if(s.begin(), s.end(), [](char c) { return (c == '\r' || c == '\t' || c == '\n'); }), s.end());
+inline SharedMemoryRing::Slot *SharedMemoryRing::slot(uint64_t index) const noexcept {
+    return reinterpret_cast<Slot *>(m_memory + m_slotsOffset + (index % m_slots) * m_slotStride);
+}
 
-    // Parse JSON from in.
-    m_keyValues = readKeyValues(s);
+inline SharedMemoryRing::Participant *SharedMemoryRing::participant(uint32_t index) const noexcept {
+    return reinterpret_cast<Participant *>(m_memory + sizeof(Header)) + index;
 }
 
-inline std::string FromJSONVisitor::decodeBase64(const std::string &input) noexcept {
-    const std::string ALPHABET{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
-    uint8_t counter{0};
-    std::array<char, 4> buffer;
-    std::string decoded;
-    for (uint32_t i{0}; i < input.size(); i++) {
-        char c;
-        for (c = 0; c < 64 && (ALPHABET.at(static_cast<uint8_t>(c)) != input.at(i)); c++) {}
+inline int64_t SharedMemoryRing::now() noexcept {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-        buffer[counter++] = c;
-        if (4 == counter) {
-            decoded.push_back(static_cast<char>((buffer[0] << 2) + (buffer[1] >> 4)));
-            if (64 != buffer[2]) {
-                decoded.push_back(static_cast<char>((buffer[1] << 4) + (buffer[2] >> 2)));
-            }
-            if (64 != buffer[3]) {
-                decoded.push_back(static_cast<char>((buffer[2] << 6) + buffer[3]));
-            }
-            counter = 0;
+inline bool SharedMemoryRing::join(uint64_t identifier) noexcept {
+    if (!valid() || (0 == identifier)) {
+        return false;
+    }
+    const int64_t NOW{now()};
+    for (uint32_t i{0}; i < MAX_PARTICIPANTS; i++) {
+        Participant *p{participant(i)};
+        uint64_t previous{p->m_identifier.load()};
+        // Take free entries and those of participants that ended without leaving.
+        if (((0 == previous) || (NOW - p->m_heartbeat.load() >= PARTICIPANT_TIMEOUT))
+            && p->m_identifier.compare_exchange_strong(previous, identifier)) {
+            p->m_heartbeat.store(NOW);
+            return true;
         }
     }
-    return decoded;
+    return false;
 }
 
-inline void FromJSONVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
-    (void)shortName;
-    (void)longName;
+inline void SharedMemoryRing::leave(uint64_t identifier) noexcept {
+    for (uint32_t i{0}; valid() && (0 != identifier) && (i < MAX_PARTICIPANTS); i++) {
+        uint64_t expected{identifier};
+        participant(i)->m_identifier.compare_exchange_strong(expected, 0);
+    }
 }
 
-inline void FromJSONVisitor::postVisit() noexcept {}
-
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::IS_FALSE == m_keyValues[name].m_type) {
-                v = false;
-            } else if (JSONConstants::IS_TRUE == m_keyValues[name].m_type) {
-                v = true;
-            } else if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = (1 == static_cast<uint32_t>(linb::any_cast<double>(m_keyValues[name].m_value)));
-            }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+inline bool SharedMemoryRing::heartbeat(uint64_t identifier) noexcept {
+    for (uint32_t i{0}; valid() && (0 != identifier) && (i < MAX_PARTICIPANTS); i++) {
+        Participant *p{participant(i)};
+        if (identifier == p->m_identifier.load()) {
+            p->m_heartbeat.store(now());
+            return true;
         }
     }
+    // The entry expired and was taken by another participant.
+    return join(identifier);
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::STRING == m_keyValues[name].m_type) {
-                v = linb::any_cast<std::string>(m_keyValues[name].m_value).at(0);
+inline bool SharedMemoryRing::hasParticipant(uint64_t identifier, uint64_t mask) const noexcept {
+    if (valid()) {
+        const int64_t NOW{now()};
+        for (uint32_t i{0}; i < MAX_PARTICIPANTS; i++) {
+            const Participant *p{participant(i)};
+            const uint64_t IDENTIFIER{p->m_identifier.load()};
+            if ((0 != IDENTIFIER) && ((IDENTIFIER & mask) == (identifier & mask)) && (NOW - p->m_heartbeat.load() < PARTICIPANT_TIMEOUT)) {
+                return true;
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
         }
     }
+    return false;
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<int8_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+inline bool SharedMemoryRing::push(const char *data, std::size_t size, uint64_t sender) noexcept {
+    if (!valid() || (nullptr == data) || (m_slotSize < size)) {
+        return false;
+    }
+    const uint64_t INDEX{m_header->m_writeIndex.fetch_add(1)};
+    Slot *s{slot(INDEX)};
+    s->m_sequence.store(2 * INDEX + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s->m_length = static_cast<uint32_t>(size);
+    s->m_sender = sender;
+    std::memcpy(reinterpret_cast<char *>(s) + sizeof(Slot), data, size);
+    s->m_sequence.store(2 * INDEX + 2, std::memory_order_release);
+
+    m_header->m_futex.fetch_add(1);
+    if (0 < m_header->m_waiters.load()) {
+        wake();
+    }
+    return true;
+}
+
+inline SharedMemoryRing::PopResult SharedMemoryRing::pop(uint64_t &cursor, std::string &data, uint64_t &sender, std::chrono::milliseconds timeout) noexcept {
+    if (!valid()) {
+        return INVALID;
+    }
+    const auto DEADLINE{std::chrono::steady_clock::now() + timeout};
+    while (true) {
+        const uint32_t FUTEX{m_header->m_futex.load()};
+        Slot *s{slot(cursor)};
+        const uint64_t PUBLISHED{2 * cursor + 2};
+        uint64_t sequence{s->m_sequence.load(std::memory_order_acquire)};
+        if (PUBLISHED == sequence) {
+            const uint32_t LENGTH{s->m_length};
+            sender = s->m_sender;
+            if (LENGTH <= m_slotSize) {
+                try {
+                    data.assign(reinterpret_cast<const char *>(s) + sizeof(Slot), LENGTH);
+                } catch (...) {} // LCOV_EXCL_LINE
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            sequence = s->m_sequence.load(std::memory_order_relaxed);
+            if ((PUBLISHED == sequence) && (LENGTH <= m_slotSize)) {
+                cursor++;
+                return RECEIVED;
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
         }
-    }
-}
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<uint8_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+        const uint64_t WRITE_INDEX{m_header->m_writeIndex.load()};
+        if ((PUBLISHED < sequence) || (cursor + m_slots < WRITE_INDEX)) {
+            // Overtaken by the producers: continue with the oldest slot that can still be read.
+            const uint64_t NEXT{(WRITE_INDEX > m_slots) ? WRITE_INDEX - m_slots + 1 : cursor + 1};
+            const uint64_t SKIPPED{(NEXT > cursor) ? NEXT - cursor : 1};
+            m_lost += SKIPPED;
+            cursor += SKIPPED;
+            continue;
+        }
+
+        const auto NOW{std::chrono::steady_clock::now()};
+        if (cursor < WRITE_INDEX) {
+            // A producer claimed the slot but has not published it yet.
+            if (NOW >= DEADLINE) {
+                // Do not wait forever for a producer that ended while writing.
+                m_lost++;
+                cursor++;
+                return TIMEOUT;
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+            std::this_thread::yield();
+            continue;
+        }
+        if (NOW >= DEADLINE) {
+            return TIMEOUT;
         }
+
+        m_header->m_waiters.fetch_add(1);
+        wait(FUTEX, std::chrono::duration_cast<std::chrono::milliseconds>(DEADLINE - NOW) + std::chrono::milliseconds(1));
+        m_header->m_waiters.fetch_sub(1);
     }
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<int16_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+inline void SharedMemoryRing::wait(uint32_t value, std::chrono::milliseconds timeout) noexcept {
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec  = static_cast<time_t>(timeout.count() / 1000);
+    ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000 * 1000);
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_header->m_futex), FUTEX_WAIT, value, &ts, nullptr, 0);
+#else
+    (void)value;
+    (void)timeout;
+#endif
+}
+
+inline void SharedMemoryRing::wake() noexcept {
+#ifdef __linux__
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_header->m_futex), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/OD4Session.hpp"
+//#include "cluon/Envelope.hpp"
+//#include "cluon/FromProtoVisitor.hpp"
+//#include "cluon/TerminateHandler.hpp"
+//#include "cluon/Time.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace cluon {
+
+inline OD4Session::OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept
+    : m_receiver{nullptr}
+    , m_sender{"225.0.0." + std::to_string(CID), 12175}
+    , m_delegate(std::move(delegate))
+    , m_dispatchTableMutex{}
+    , m_dispatchTable{std::make_shared<const DispatchTable>()} {
+    m_receivingLane     = std::make_shared<ExecutionLane>(false);
+    m_executionLanes[0] = m_receivingLane;
+
+    const char *CLUON_OD4SESSION_SHM = getenv("CLUON_OD4SESSION_SHM");
+    if ((nullptr == CLUON_OD4SESSION_SHM) || (CLUON_OD4SESSION_SHM[0] != '0')) {
+        m_sharedMemory = std::make_unique<SharedMemoryRing>("/cluon-od4-" + std::to_string(CID));
+        // Random as process identifiers are not unique across containers; the lowest 16 bits are the port of the UDP packets.
+        std::random_device rd;
+        m_sharedMemoryParticipant = (static_cast<uint64_t>(rd()) << 32) | (static_cast<uint64_t>(rd() & 0xFFFF0000u)) | m_sender.getSendFromPort();
+        if (m_sharedMemory->valid() && (0 < m_sender.getSendFromPort()) && m_sharedMemory->join(m_sharedMemoryParticipant)) {
+            // Until UDP packets have been watched for long enough, others might not use the shared memory.
+            m_lastOutsider.store(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+            // Attach before returning to not miss Envelopes sent right after construction.
+            m_sharedMemoryReaderRunning.store(true);
+            try {
+                m_sharedMemoryReader = std::thread(&OD4Session::readSharedMemory, this, m_sharedMemory->attach());
+            } catch (...) {                                                  // LCOV_EXCL_LINE
+                m_sharedMemory->leave(m_sharedMemoryParticipant);            // LCOV_EXCL_LINE
+                m_sharedMemory.reset();                                      // LCOV_EXCL_LINE
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        } else {
+            std::clog << "[cluon::OD4Session]: Shared memory not available; using UDP multicast only." << std::endl;
+            m_sharedMemory.reset();
         }
     }
+
+    std::function<bool(const char *, std::size_t, uint16_t, bool)> filter{nullptr};
+    if (m_sharedMemory) {
+        filter = [this](const char *data, std::size_t size, uint16_t port, bool local) { return this->acceptViaUDP(data, size, port, local); };
+    }
+    m_receiver = std::make_unique<cluon::UDPReceiver>(
+        "225.0.0." + std::to_string(CID),
+        12175,
+        [this](std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) {
+            this->callback(std::move(data), std::move(from), std::move(timepoint));
+        },
+        m_sender.getSendFromPort() /* passing our local send from port to the UDPReceiver to filter out our own bytes */,
+        filter);
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<uint16_t>(linb::any_cast<double>(m_keyValues[name].m_value));
-            }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+inline OD4Session::~OD4Session() {
+    // Stop receiving before the dispatch table and the execution lanes are destroyed.
+    m_receiver.reset();
+    m_sharedMemoryReaderRunning.store(false);
+    if (m_sharedMemoryReader.joinable()) {
+        m_sharedMemoryReader.join();
+    }
+    if (m_sharedMemory) {
+        m_sharedMemory->leave(m_sharedMemoryParticipant);
     }
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<int32_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+inline void OD4Session::timeTrigger(float freq, std::function<bool()> delegate) noexcept {
+    if (nullptr != delegate) {
+        PeriodicScheduler scheduler;
+        uint32_t task{0};
+        uint64_t reportedViolations{0};
+        int64_t lastReport{0};
+        task = scheduler.add(freq, [&scheduler, &task, &reportedViolations, &lastReport, &delegate]() {
+            // Report violated time slices at most once per second.
+            const uint64_t VIOLATIONS{scheduler.overrun(task).count()};
+            const int64_t NOW{PeriodicScheduler::now()};
+            if ((VIOLATIONS > reportedViolations) && ((NOW - lastReport) >= 1000 * 1000 * 1000)) {
+                std::cerr << "[cluon::OD4Session]: time-triggered delegate violated allocated time slice " << (VIOLATIONS - reportedViolations) << " time(s)." << std::endl;
+                reportedViolations = VIOLATIONS;
+                lastReport         = NOW;
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+            return delegate();
+        }, PeriodicScheduler::SKIP);
+        scheduler.run();
     }
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
+inline bool OD4Session::Subscription::accepts(uint32_t senderStamp) const noexcept {
+    return m_senderStamps.empty() || std::binary_search(m_senderStamps.begin(), m_senderStamps.end(), senderStamp);
+}
+
+inline void OD4Session::updateDispatchTable(std::function<void(DispatchTable &)> change) {
+    std::lock_guard<std::mutex> lck{m_dispatchTableMutex};
+    std::shared_ptr<DispatchTable> copy{std::make_shared<DispatchTable>(*std::atomic_load(&m_dispatchTable))};
+    change(*copy);
+    std::atomic_store(&m_dispatchTable, std::shared_ptr<const DispatchTable>(std::move(copy)));
+}
+
+inline bool OD4Session::dataTrigger(int32_t messageIdentifier, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept {
+    bool retVal{false};
+    if (nullptr == m_delegate) {
         try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<uint32_t>(linb::any_cast<double>(m_keyValues[name].m_value));
-            }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+            // dataTrigger replaces the delegate it set before for the same message identifier.
+            updateDispatchTable([this, messageIdentifier, &delegate](DispatchTable &table) {
+                if (m_dataTriggerSubscriptions.count(messageIdentifier) > 0) {
+                    const uint32_t PREVIOUS{m_dataTriggerSubscriptions[messageIdentifier]};
+                    auto &subscriptions = table.m_subscriptions[messageIdentifier];
+                    subscriptions.erase(std::remove_if(subscriptions.begin(),
+                                                       subscriptions.end(),
+                                                       [PREVIOUS](const Subscription &sub) { return PREVIOUS == sub.m_identifier; }),
+                                        subscriptions.end());
+                    if (subscriptions.empty()) {
+                        table.m_subscriptions.erase(messageIdentifier);
+                    }
+                    m_dataTriggerSubscriptions.erase(messageIdentifier);
+                }
+                if (nullptr != delegate) {
+                    Subscription sub;
+                    sub.m_identifier = m_nextSubscription++;
+                    sub.m_delegate   = std::make_shared<std::function<void(cluon::data::Envelope && envelope)>>(delegate);
+                    table.m_subscriptions[messageIdentifier].push_back(sub);
+                    m_dataTriggerSubscriptions[messageIdentifier] = sub.m_identifier;
+                }
+            });
+            retVal = true;
+        } catch (...) {} // LCOV_EXCL_LINE
     }
+    return retVal;
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
+inline uint32_t OD4Session::subscribe(int32_t messageIdentifier,
+                                      std::function<void(cluon::data::Envelope &&envelope)> delegate,
+                                      const std::vector<uint32_t> &senderStamps) noexcept {
+    uint32_t retVal{0};
+    if ((nullptr == m_delegate) && (nullptr != delegate)) {
         try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<int64_t>(linb::any_cast<double>(m_keyValues[name].m_value));
-            }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
+            Subscription sub;
+            sub.m_senderStamps = senderStamps;
+            std::sort(sub.m_senderStamps.begin(), sub.m_senderStamps.end());
+            sub.m_delegate = std::make_shared<std::function<void(cluon::data::Envelope && envelope)>>(std::move(delegate));
+            updateDispatchTable([this, messageIdentifier, &sub, &retVal](DispatchTable &table) {
+                sub.m_identifier = m_nextSubscription++;
+                table.m_subscriptions[messageIdentifier].push_back(sub);
+                retVal = sub.m_identifier;
+            });
+        } catch (...) {} // LCOV_EXCL_LINE
     }
+    return retVal;
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<uint64_t>(linb::any_cast<double>(m_keyValues[name].m_value));
+inline bool OD4Session::unsubscribe(uint32_t subscription) noexcept {
+    bool retVal{false};
+    try {
+        updateDispatchTable([subscription, &retVal](DispatchTable &table) {
+            for (auto it = table.m_subscriptions.begin(); it != table.m_subscriptions.end(); it++) {
+                auto &subscriptions = it->second;
+                auto element        = std::find_if(
+                    subscriptions.begin(), subscriptions.end(), [subscription](const Subscription &sub) { return subscription == sub.m_identifier; });
+                if (element != subscriptions.end()) {
+                    subscriptions.erase(element);
+                    if (subscriptions.empty()) {
+                        table.m_subscriptions.erase(it);
+                    }
+                    retVal = true;
+                    break;
+                }
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        });
+    } catch (...) {} // LCOV_EXCL_LINE
+    return retVal;
+}
+
+inline bool OD4Session::assignExecutionLane(int32_t messageIdentifier, uint32_t lane) noexcept {
+    bool retVal{false};
+    try {
+        updateDispatchTable([this, messageIdentifier, lane](DispatchTable &table) {
+            if (0 == m_executionLanes.count(lane)) {
+                m_executionLanes[lane] = std::make_shared<ExecutionLane>(true);
+            }
+            if (0 == lane) {
+                table.m_lanes.erase(messageIdentifier);
+            } else {
+                table.m_lanes[messageIdentifier] = m_executionLanes[lane];
+            }
+        });
+        retVal = true;
+    } catch (...) {} // LCOV_EXCL_LINE
+    return retVal;
+}
+
+inline std::shared_ptr<const ExecutionLane> OD4Session::executionLane(uint32_t lane) noexcept {
+    std::shared_ptr<const ExecutionLane> retVal{nullptr};
+    try {
+        std::lock_guard<std::mutex> lck{m_dispatchTableMutex};
+        if (m_executionLanes.count(lane) > 0) {
+            retVal = m_executionLanes[lane];
         }
-    }
+    } catch (...) {} // LCOV_EXCL_LINE
+    return retVal;
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = static_cast<float>(linb::any_cast<double>(m_keyValues[name].m_value));
+inline void OD4Session::dispatch(const DispatchTable &table, cluon::data::Envelope &&env) noexcept {
+    auto entry = table.m_subscriptions.find(env.dataType());
+    if (entry != table.m_subscriptions.end()) {
+        const std::vector<Subscription> &subscriptions{entry->second};
+        const uint32_t SENDER_STAMP{env.senderStamp()};
+
+        // Every subscriber but the last one receives a copy of the Envelope.
+        const Subscription *previous{nullptr};
+        for (const auto &sub : subscriptions) {
+            if (sub.accepts(SENDER_STAMP)) {
+                if (nullptr != previous) {
+                    cluon::data::Envelope copy{env};
+                    try {
+                        (*previous->m_delegate)(std::move(copy));
+                    } catch (...) {} // LCOV_EXCL_LINE
+                }
+                previous = &sub;
             }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+        }
+        if (nullptr != previous) {
+            try {
+                (*previous->m_delegate)(std::move(env));
+            } catch (...) {} // LCOV_EXCL_LINE
         }
     }
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            if (JSONConstants::NUMBER == m_keyValues[name].m_type) {
-                v = linb::any_cast<double>(m_keyValues[name].m_value);
-            }
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+inline void OD4Session::readSharedMemory(uint64_t cursor) noexcept {
+    std::string data;
+    uint64_t sender{0};
+    auto lastHeartbeat{std::chrono::steady_clock::now()};
+    while (m_sharedMemoryReaderRunning.load()) {
+        const SharedMemoryRing::PopResult RESULT{m_sharedMemory->pop(cursor, data, sender, std::chrono::milliseconds(100))};
+        if ((SharedMemoryRing::RECEIVED == RESULT) && (sender != m_sharedMemoryParticipant)) {
+            std::lock_guard<std::mutex> lck(m_processMutex);
+            process(data.data(), data.size(), std::chrono::system_clock::now());
         }
+        const auto NOW{std::chrono::steady_clock::now()};
+        if (NOW - lastHeartbeat >= std::chrono::milliseconds(SharedMemoryRing::PARTICIPANT_TIMEOUT / 10)) {
+            m_sharedMemory->heartbeat(m_sharedMemoryParticipant);
+            lastHeartbeat = NOW;
+        }
+    }
+}
+
+inline bool OD4Session::acceptViaUDP(const char *data, std::size_t size, uint16_t port, bool local) noexcept {
+    // Participants push all Envelopes that are not fragmented into the shared memory before sending them.
+    if (local && m_sharedMemory->hasParticipant(port, 0xFFFF)) {
+        return Fragmentation::isFragment(data, size);
     }
+    m_lastOutsider.store(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    return true;
+}
+
+inline bool OD4Session::sharedMemoryOnly() const noexcept {
+    const int64_t NOW{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()};
+    return m_sharedMemory && (NOW - m_lastOutsider.load() >= OUTSIDER_TIMEOUT);
 }
 
-inline void FromJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)id;
-    (void)typeName;
-    if (0 < m_keyValues.count(name)) {
-        try {
-            std::string tmp{linb::any_cast<std::string>(m_keyValues[name].m_value)};
-            v = FromJSONVisitor::decodeBase64(tmp);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
+inline void OD4Session::callback(std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) noexcept {
+    // Delegates are not called concurrently when Envelopes also arrive through the shared memory.
+    std::unique_lock<std::mutex> lck(m_processMutex, std::defer_lock);
+    if (m_sharedMemory) {
+        lck.lock();
+    }
+
+    if (Fragmentation::isFragment(data.data(), data.size())) {
+        const std::string *completed{m_fragmentAssembler.add(from, data.data(), data.size())};
+        if (nullptr != completed) {
+            process(completed->data(), completed->size(), timepoint);
+        }
+    } else if (SendBatch::isCoalesced(data.data(), data.size())) {
+        // Every Envelope in the packet is prefixed by its OD4 header with its length.
+        constexpr std::size_t OD4_HEADER_SIZE{5};
+        std::size_t pos{SendBatch::HEADER_SIZE};
+        while (pos + OD4_HEADER_SIZE <= data.size()) {
+            const std::size_t LENGTH{static_cast<std::size_t>(static_cast<uint8_t>(data[pos + 2]))
+                                     | (static_cast<std::size_t>(static_cast<uint8_t>(data[pos + 3])) << 8)
+                                     | (static_cast<std::size_t>(static_cast<uint8_t>(data[pos + 4])) << 16)};
+            if (pos + OD4_HEADER_SIZE + LENGTH > data.size()) {
+                break;
+            }
+            process(data.data() + pos, OD4_HEADER_SIZE + LENGTH, timepoint);
+            pos += OD4_HEADER_SIZE + LENGTH;
         }
+    } else {
+        process(data.data(), data.size(), timepoint);
     }
 }
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+inline void OD4Session::process(const char *data, std::size_t size, const std::chrono::system_clock::time_point &timepoint) noexcept {
+    // Keep the current dispatch table alive while dispatching, even if it is replaced meanwhile.
+    std::shared_ptr<const DispatchTable> table{std::atomic_load(&m_dispatchTable)};
 
-//#include "cluon/GenericMessage.hpp"
+    // Without a "catch all"-delegate, drop Envelopes nobody subscribed to before decoding them.
+    if (nullptr == m_delegate) {
+        int32_t dataType{0};
+        uint32_t senderStamp{0};
+        if (table->m_subscriptions.empty() || !peekEnvelope(data, size, dataType, senderStamp)) {
+            return;
+        }
+        auto entry = table->m_subscriptions.find(dataType);
+        if ((entry == table->m_subscriptions.end())
+            || std::none_of(entry->second.begin(), entry->second.end(), [senderStamp](const Subscription &sub) { return sub.accepts(senderStamp); })) {
+            return;
+        }
+    }
 
-#include <istream>
-#include <iterator>
-#include <regex>
+    // Only unpack the envelope when it needs to be post-processed.
+    if ((nullptr != m_delegate) || !table->m_subscriptions.empty()) {
+        std::stringstream sstr(std::string(data, size));
+        auto retVal = extractEnvelope(sstr);
 
-namespace cluon {
+        if (retVal.first) {
+            cluon::data::Envelope env{retVal.second};
+            env.received(cluon::time::convert(timepoint));
 
-inline void GenericMessage::GenericMessageVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)longName;
-    m_metaMessage.messageIdentifier(id).messageName(shortName);
-    if (!longName.empty()) {
-        const auto pos = longName.rfind(shortName);
-        if (std::string::npos != pos) {
-            m_metaMessage.packageName(longName.substr(0, pos - 1));
+            // "Catch all"-delegate.
+            if (nullptr != m_delegate) {
+                m_delegate(std::move(env));
+            } else if (table->m_subscriptions.count(env.dataType()) > 0) {
+                // Data triggered-delegates, either on this thread (lane 0) or on the lane assigned to the message identifier.
+                auto lane = table->m_lanes.find(env.dataType());
+                if (lane == table->m_lanes.end()) {
+                    m_receivingLane->post([&table, &env]() { dispatch(*table, std::move(env)); });
+                } else {
+                    try {
+                        // std::function needs copyable tasks; hence, the Envelope is shared with the task.
+                        auto envelope = std::make_shared<cluon::data::Envelope>(std::move(env));
+                        lane->second->post([table, envelope]() { dispatch(*table, std::move(*envelope)); });
+                    } catch (...) {} // LCOV_EXCL_LINE
+                }
+            }
         }
     }
 }
 
-inline void GenericMessage::GenericMessageVisitor::postVisit() noexcept {}
-
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::BOOL_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline void OD4Session::send(cluon::data::Envelope &&envelope) noexcept {
+    sendInternal(cluon::serializeEnvelope(std::move(envelope)));
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::CHAR_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline void OD4Session::sendInternal(std::string &&dataToSend) noexcept {
+    constexpr std::size_t MAX_LENGTH{Fragmentation::MAX_FRAGMENT_SIZE + Fragmentation::HEADER_SIZE};
+    // Receivers on this host take the Envelope from the shared memory and drop the UDP packet.
+    if (m_sharedMemory && (MAX_LENGTH >= dataToSend.size()) && m_sharedMemory->push(dataToSend.data(), dataToSend.size(), m_sharedMemoryParticipant)
+        && sharedMemoryOnly()) {
+        return;
+    }
+    if (m_fragmentLargeEnvelopes.load() && (MAX_LENGTH < dataToSend.size())) {
+        for (auto &fragment : Fragmentation::split(dataToSend, m_nextFragmentedMessage++)) {
+            m_sender.send(std::move(fragment));
+        }
+    } else {
+        m_sender.send(std::move(dataToSend));
+    }
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT8_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
-}
+inline void OD4Session::sendBatch(std::vector<std::string> &&serializedEnvelopes, bool coalesce) noexcept {
+    constexpr std::size_t MAX_LENGTH{Fragmentation::MAX_FRAGMENT_SIZE + Fragmentation::HEADER_SIZE};
+    try {
+        std::vector<std::string> datagrams;
+        datagrams.reserve(serializedEnvelopes.size());
+
+        std::string coalesced;
+        uint32_t envelopesInCoalesced{0};
+        auto closeCoalesced = [&datagrams, &coalesced, &envelopesInCoalesced]() {
+            if (1 == envelopesInCoalesced) {
+                // A single Envelope is sent as is to be understood by any receiver.
+                datagrams.emplace_back(coalesced.substr(SendBatch::HEADER_SIZE));
+            } else if (1 < envelopesInCoalesced) {
+                datagrams.emplace_back(std::move(coalesced));
+            }
+            coalesced.clear();
+            envelopesInCoalesced = 0;
+        };
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT8_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
-}
+        const bool SHARED_MEMORY_ONLY{sharedMemoryOnly()};
+        for (auto &e : serializedEnvelopes) {
+            if (m_sharedMemory && (MAX_LENGTH >= e.size()) && m_sharedMemory->push(e.data(), e.size(), m_sharedMemoryParticipant) && SHARED_MEMORY_ONLY) {
+                continue;
+            }
+            if (MAX_LENGTH < e.size()) {
+                if (m_fragmentLargeEnvelopes.load()) {
+                    for (auto &fragment : Fragmentation::split(e, m_nextFragmentedMessage++)) {
+                        datagrams.emplace_back(std::move(fragment));
+                    }
+                }
+            } else if (coalesce) {
+                if (coalesced.size() + e.size() > MAX_LENGTH) {
+                    closeCoalesced();
+                }
+                if (coalesced.empty()) {
+                    coalesced.push_back(static_cast<char>(0x0D));
+                    coalesced.push_back(static_cast<char>(0xA6));
+                }
+                coalesced.append(e);
+                envelopesInCoalesced++;
+            } else {
+                datagrams.emplace_back(std::move(e));
+            }
+        }
+        closeCoalesced();
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT16_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+        m_sender.send(std::move(datagrams));
+    } catch (...) {} // LCOV_EXCL_LINE
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT16_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline void OD4Session::fragmentLargeEnvelopes(bool enable) noexcept {
+    m_fragmentLargeEnvelopes.store(enable);
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT32_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline FragmentAssembler::Statistics OD4Session::fragmentStatistics() const noexcept {
+    return m_fragmentAssembler.statistics();
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT32_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline bool OD4Session::isRunning() noexcept {
+    return m_receiver->isRunning();
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::INT64_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline bool SendBatch::isCoalesced(const char *data, std::size_t size) noexcept {
+    return (nullptr != data) && (HEADER_SIZE <= size) && (0x0D == static_cast<uint8_t>(data[0])) && (0xA6 == static_cast<uint8_t>(data[1]));
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::UINT64_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
-}
+inline SendBatch::SendBatch(OD4Session &od4, bool coalesce) noexcept
+    : m_od4{od4}
+    , m_coalesce{coalesce} {}
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::FLOAT_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline SendBatch::~SendBatch() noexcept {
+    flush();
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::DOUBLE_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline void SendBatch::add(cluon::data::Envelope &&envelope) noexcept {
+    try {
+        m_serializedEnvelopes.emplace_back(cluon::serializeEnvelope(std::move(envelope)));
+    } catch (...) {} // LCOV_EXCL_LINE
 }
 
-inline void GenericMessage::GenericMessageVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    cluon::MetaMessage::MetaField mf;
-    mf.fieldIdentifier(id).fieldDataType(cluon::MetaMessage::MetaField::STRING_T).fieldDataTypeName(typeName).fieldName(name);
-    m_intermediateDataRepresentation[mf.fieldIdentifier()] = linb::any{v};
-    m_metaMessage.add(std::move(mf));
+inline void SendBatch::flush() noexcept {
+    if (!m_serializedEnvelopes.empty()) {
+        std::vector<std::string> serializedEnvelopes;
+        serializedEnvelopes.swap(m_serializedEnvelopes);
+        m_od4.sendBatch(std::move(serializedEnvelopes), m_coalesce);
+    }
 }
 
-inline MetaMessage GenericMessage::GenericMessageVisitor::metaMessage() const noexcept {
-    return m_metaMessage;
+inline std::size_t SendBatch::size() const noexcept {
+    return m_serializedEnvelopes.size();
 }
 
-inline std::unordered_map<uint32_t, linb::any, UseUInt32ValueAsHashKey> GenericMessage::GenericMessageVisitor::intermediateDataRepresentation() const noexcept {
-    return m_intermediateDataRepresentation;
-}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-////////////////////////////////////////////////////////////////////////////////
+//#include "cluon/ToODVDVisitor.hpp"
 
-inline int32_t GenericMessage::ID() {
-    return m_metaMessage.messageIdentifier();
-}
+#include <sstream>
 
-inline const std::string GenericMessage::ShortName() {
-    std::string tmp{LongName()};
-    std::replace(tmp.begin(), tmp.end(), '.', ' ');
-    std::istringstream sstr{tmp};
-    std::vector<std::string> tokens{std::istream_iterator<std::string>(sstr), std::istream_iterator<std::string>()};
+namespace cluon {
 
-    return tokens.back();
-}
+inline std::string ToODVDVisitor::messageSpecification() const noexcept {
+    std::stringstream tmp;
+    for (const auto &e : m_forwardDeclarations) { tmp << e; }
+    tmp << m_buffer.str();
 
-inline const std::string GenericMessage::LongName() {
-    return m_metaMessage.packageName() + (!m_metaMessage.packageName().empty() ? "." : "") + m_metaMessage.messageName();
+    const std::string retVal{tmp.str()};
+    return retVal;
 }
 
-inline void GenericMessage::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
+inline void ToODVDVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
     (void)shortName;
-    (void)longName;
+    m_buffer << "message " << longName << " [ id = " << id << " ] {" << '\n';
 }
 
-inline void GenericMessage::postVisit() noexcept {}
+inline void ToODVDVisitor::postVisit() noexcept {
+    m_buffer << '}' << '\n';
+}
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<bool>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "bool"
+             << " " << name << " [ default = false, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<char>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "char"
+             << " " << name << " [ default = '0', id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<int8_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "int8"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<uint8_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "uint8"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<int16_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "int16"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<uint16_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "uint16"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<int32_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "int32"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<uint32_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "uint32"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<int64_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "int64"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<uint64_t>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "uint64"
+             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<float>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "float"
+             << " " << name << " [ default = 0.0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<double>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "double"
+             << " " << name << " [ default = 0.0, id = " << id << " ];" << '\n';
 }
 
-inline void GenericMessage::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
+inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
     (void)typeName;
-    (void)name;
-    if (0 < m_intermediateDataRepresentation.count(id)) {
-        try {
-            v = linb::any_cast<std::string>(m_intermediateDataRepresentation[id]);
-        } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-        }
-    }
+    (void)v;
+    m_buffer << "    "
+             << "string"
+             << " " << name << " [ default = \"\", id = " << id << " ];" << '\n';
 }
 
-////////////////////////////////////////////////////////////////////////////////
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-inline void GenericMessage::createFrom(const MetaMessage &mm, const std::vector<MetaMessage> &mms) noexcept {
-    m_metaMessage = mm;
-    m_longName    = m_metaMessage.messageName();
+//#include "cluon/EnvelopeConverter.hpp"
+//#include "cluon/Envelope.hpp"
+//#include "cluon/FromJSONVisitor.hpp"
+//#include "cluon/FromProtoVisitor.hpp"
+//#include "cluon/GenericMessage.hpp"
+//#include "cluon/MessageParser.hpp"
+//#include "cluon/Time.hpp"
+//#include "cluon/ToJSONVisitor.hpp"
+//#include "cluon/ToProtoVisitor.hpp"
+//#include "cluon/any/any.hpp"
 
-    m_scopeOfMetaMessages.clear();
-    m_scopeOfMetaMessages = mms;
+#include <algorithm>
+#include <sstream>
+#include <utility>
 
-    m_mapForScopeOfMetaMessages.clear();
-    for (const auto &e : m_scopeOfMetaMessages) { m_mapForScopeOfMetaMessages[e.messageName()] = e; }
+namespace cluon {
 
-    m_intermediateDataRepresentation.clear();
-    for (const auto &f : m_metaMessage.listOfMetaFields()) {
-        if (f.fieldDataType() == MetaMessage::MetaField::BOOL_T) {
-            try {
-                linb::any _v{false};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::CHAR_T) {
-            try {
-                linb::any _v{static_cast<char>('\0')};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT8_T) {
-            try {
-                linb::any _v{static_cast<uint8_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::INT8_T) {
-            try {
-                linb::any _v{static_cast<int8_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT16_T) {
-            try {
-                linb::any _v{static_cast<uint16_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::INT16_T) {
-            try {
-                linb::any _v{static_cast<int16_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT32_T) {
-            try {
-                linb::any _v{static_cast<uint32_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::INT32_T) {
-            try {
-                linb::any _v{static_cast<int32_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::UINT64_T) {
-            try {
-                linb::any _v{static_cast<uint64_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::INT64_T) {
-            try {
-                linb::any _v{static_cast<int64_t>(0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::FLOAT_T) {
-            try {
-                linb::any _v{static_cast<float>(0.0f)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::DOUBLE_T) {
-            try {
-                linb::any _v{static_cast<double>(0.0)};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if ((f.fieldDataType() == MetaMessage::MetaField::STRING_T) || (f.fieldDataType() == MetaMessage::MetaField::BYTES_T)) {
-            try {
-                linb::any _v                                          = std::string{};
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = _v;
-            } catch (const linb::bad_any_cast &) { // LCOV_EXCL_LINE
-            }
-        } else if (f.fieldDataType() == MetaMessage::MetaField::MESSAGE_T) {
-            if (0 < m_mapForScopeOfMetaMessages.count(f.fieldDataTypeName())) {
-                // Create a GenericMessage from the decoded Proto-data.
-                cluon::GenericMessage gm;
-                gm.createFrom(m_mapForScopeOfMetaMessages[f.fieldDataTypeName()], m_scopeOfMetaMessages);
+inline int32_t EnvelopeConverter::setMessageSpecification(const std::string &ms) noexcept {
+    int32_t retVal{-1};
 
-                m_intermediateDataRepresentation[f.fieldIdentifier()] = linb::any{gm};
+    m_listOfMetaMessages.clear();
+    m_scopeOfMetaMessages.clear();
+
+    cluon::MessageParser mp;
+    auto parsingResult = mp.parse(ms);
+    if (cluon::MessageParser::MessageParserErrorCodes::NO_MESSAGEPARSER_ERROR == parsingResult.second) {
+        m_listOfMetaMessages = parsingResult.first;
+        for (const auto &mm : m_listOfMetaMessages) { m_scopeOfMetaMessages[mm.messageIdentifier()] = mm; }
+        retVal = static_cast<int32_t>(m_listOfMetaMessages.size());
+    }
+    return retVal;
+}
+
+inline std::string EnvelopeConverter::getJSONFromProtoEncodedEnvelope(const std::string &protoEncodedEnvelope) noexcept {
+    std::string retVal{"{}"};
+    if (!m_listOfMetaMessages.empty()) {
+        cluon::data::Envelope envelope;
+        std::stringstream sstr(protoEncodedEnvelope);
+        constexpr uint8_t OD4_HEADER_SIZE{5};
+        if (OD4_HEADER_SIZE < protoEncodedEnvelope.size()) {
+            // Try decoding complete OD4-encoded Envelope including header.
+            constexpr uint8_t byte0{0x0D};
+            constexpr uint8_t byte1{0xA4};
+            if ((static_cast<uint8_t>(protoEncodedEnvelope.at(0)) == byte0) && (static_cast<uint8_t>(protoEncodedEnvelope.at(1)) == byte1)) {
+                uint32_t length = (*reinterpret_cast<const uint32_t *>(protoEncodedEnvelope.data() + 1));
+                length          = le32toh(length) >> 8;
+                if ((OD4_HEADER_SIZE + length) == protoEncodedEnvelope.size()) {
+                    auto result{extractEnvelope(sstr)};
+                    if (result.first) {
+                        envelope = result.second;
+                    }
+                }
             }
         }
+
+        if (0 == envelope.dataType()) {
+            // Directly decoding complete OD4 container failed, try decoding without header.
+            cluon::FromProtoVisitor protoDecoder;
+            protoDecoder.decodeFrom(sstr, envelope);
+        }
+
+        retVal = getJSONFromEnvelope(envelope);
     }
+    return retVal;
 }
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+inline std::string EnvelopeConverter::getJSONFromEnvelope(cluon::data::Envelope &envelope) noexcept {
+    std::string retVal{"{}"};
+    if (!m_listOfMetaMessages.empty()) {
+        if (0 < m_scopeOfMetaMessages.count(envelope.dataType())) {
+            // First, create JSON from Envelope.
+            constexpr bool OUTER_CURLY_BRACES{false};
+            // Ignore field 2 (= serializedData) as it will be replaced below.
+            const std::map<uint32_t, bool> mask{{2, false}};
+            ToJSONVisitor envelopeToJSON{OUTER_CURLY_BRACES, mask};
+            envelope.accept(envelopeToJSON);
 
-//#include "cluon/ToJSONVisitor.hpp"
+            std::stringstream sstr{envelope.serializedData()};
+            cluon::FromProtoVisitor protoDecoder;
+            protoDecoder.decodeFrom(sstr);
 
-#include <iomanip>
-#include <sstream>
+            // Now, create JSON from payload.
+            cluon::MetaMessage payload{m_scopeOfMetaMessages[envelope.dataType()]};
+            cluon::GenericMessage gm;
 
-namespace cluon {
+            // Create "empty" GenericMessage from this MetaMessage.
+            gm.createFrom(payload, m_listOfMetaMessages);
 
-inline ToJSONVisitor::ToJSONVisitor(bool withOuterCurlyBraces, const std::map<uint32_t, bool> &mask) noexcept
-    : m_withOuterCurlyBraces(withOuterCurlyBraces)
-    , m_mask(mask) {}
+            // Set values in the newly created GenericMessage from ProtoDecoder.
+            gm.accept(protoDecoder);
 
-inline std::string ToJSONVisitor::json() const noexcept {
-    const std::string tmp{m_buffer.str()};
-    std::string retVal{"{}"};
-    if (2 < tmp.size()) {
-        retVal = {(m_withOuterCurlyBraces ? "{" : "") + tmp.substr(0, tmp.size() - 2) + (m_withOuterCurlyBraces ? "}" : "")};
-    }
-    return retVal;
-}
+            ToJSONVisitor payloadToJSON{OUTER_CURLY_BRACES};
+            try {
+                // Catch possible linb::any exception.
+                gm.accept(payloadToJSON);
+            } catch (const linb::bad_any_cast &) {} // LCOV_EXCL_LINE
 
-inline void ToJSONVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
-    (void)longName;
-    (void)shortName;
-}
+            std::string tmp{payload.messageName()};
+            std::replace(tmp.begin(), tmp.end(), '.', '_');
 
-inline void ToJSONVisitor::postVisit() noexcept {}
+            const std::string strPayloadJSON{payloadToJSON.json() != "{}" ? payloadToJSON.json() : ""};
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
+            retVal = '{' + envelopeToJSON.json() + ',' + '\n' + '"' + tmp + '"' + ':' + '{' + strPayloadJSON + '}' + '}';
+        }
     }
+    return retVal;
 }
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << '\"' << v << '\"' << ',' << '\n';
-    }
+// clang-format off
+inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSONWithoutTimeStamps(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept {
+    // clang-format on
+    return getProtoEncodedEnvelopeFromJSON(json, messageIdentifier, senderStamp, cluon::data::TimeStamp());
 }
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
-    }
+// clang-format off
+inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept {
+    // clang-format on
+    return getProtoEncodedEnvelopeFromJSON(json, messageIdentifier, senderStamp, cluon::time::now());
 }
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
-    }
-}
+// clang-format off
+inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp, cluon::data::TimeStamp sampleTimeStamp) noexcept {
+    // clang-format on
+    std::string retVal;
+    if (0 < m_scopeOfMetaMessages.count(messageIdentifier)) {
+        // Get specification for message to be created.
+        cluon::MetaMessage message{m_scopeOfMetaMessages[messageIdentifier]};
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
-    }
-}
+        // Create "empty" instance for the required message as GenericMessage.
+        cluon::GenericMessage gm;
+        gm.createFrom(message, m_listOfMetaMessages);
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << +v << ',' << '\n';
-    }
-}
+        // Parse data from given JSON.
+        std::stringstream sstr{json};
+        cluon::FromJSONVisitor jsonDecoder;
+        jsonDecoder.decodeFrom(sstr);
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
-    }
-}
+        // Set values in the newly created GenericMessage from JSONDecoder.
+        gm.accept(jsonDecoder);
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
-    }
-}
+        // Finally, transform GenericMessage into Envelope.
+        ToProtoVisitor protoEncoder;
+        gm.accept(protoEncoder);
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
-    }
-}
+        cluon::data::Envelope env;
+        env.dataType(messageIdentifier).serializedData(protoEncoder.encodedData()).senderStamp(senderStamp).sampleTimeStamp(sampleTimeStamp);
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << v << ',' << '\n';
+        retVal = cluon::serializeEnvelope(std::move(env));
     }
+    return retVal;
 }
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << std::setprecision(7) << v << std::setprecision(6) << ',' << '\n';
-    }
-}
+} // namespace cluon
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << std::setprecision(11) << v << std::setprecision(6) << ',' << '\n';
-    }
-}
+//#include "cluon/Player.hpp"
+//#include "cluon/Envelope.hpp"
+//#include "cluon/Time.hpp"
 
-inline void ToJSONVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        m_buffer << '\"' << name << '\"' << ':' << '\"' << ToJSONVisitor::encodeBase64(v) << '\"' << ',' << '\n';
-    }
-}
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <utility>
 
-inline std::string ToJSONVisitor::encodeBase64(const std::string &input) noexcept {
-    std::string retVal;
+namespace cluon {
 
-    const std::string ALPHABET{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
-    auto length{input.length()};
-    uint32_t index{0};
-    uint32_t value{0};
+inline IndexEntry::IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition) noexcept
+    : m_sampleTimeStamp(sampleTimeStamp)
+    , m_filePosition(filePosition)
+    , m_available(false) {}
 
-    while (length > 2) {
-        value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 16;
-        value |= static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 8;
-        value |= static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++)));
-        retVal += ALPHABET.at((value & 0xFC0000) >> 18);
-        retVal += ALPHABET.at((value & 0x3F000) >> 12);
-        retVal += ALPHABET.at((value & 0xFC0) >> 6);
-        retVal += ALPHABET.at(value & 0x3F);
-        length -= 3;
+////////////////////////////////////////////////////////////////////////
+
+inline Player::Player(const std::string &file, const bool &autoRewind, const bool &threading) noexcept
+    : m_threading(threading)
+    , m_file(file)
+    , m_recFile()
+    , m_recFileValid(false)
+    , m_compressedRecReader(nullptr)
+    , m_autoRewind(autoRewind)
+    , m_indexMutex()
+    , m_index()
+    , m_previousPreviousEnvelopeAlreadyReplayed(m_index.end())
+    , m_previousEnvelopeAlreadyReplayed(m_index.begin())
+    , m_currentEnvelopeToReplay(m_index.begin())
+    , m_nextEntryToReadFromRecFile(m_index.begin())
+    , m_desiredInitialLevel(0)
+    , m_firstTimePointReturningAEnvelope()
+    , m_numberOfReturnedEnvelopesInTotal(0)
+    , m_delay(0)
+    , m_envelopeCacheFillingThreadIsRunningMutex()
+    , m_envelopeCacheFillingThreadIsRunning(false)
+    , m_envelopeCacheFillingThread()
+    , m_envelopeCache()
+    , m_playerListenerMutex()
+    , m_playerListener(nullptr) {
+    initializeIndex();
+    computeInitialCacheLevelAndFillCache();
+
+    if (m_threading) {
+        // Start concurrent thread to manage cache.
+        setEnvelopeCacheFillingRunning(true);
+        m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
     }
-    if (length == 2) {
-        value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 16;
-        value |= static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 8;
-        retVal += ALPHABET.at((value & 0xFC0000) >> 18);
-        retVal += ALPHABET.at((value & 0x3F000) >> 12);
-        retVal += ALPHABET.at((value & 0xFC0) >> 6);
-        retVal += "=";
-    } else if (length == 1) {
-        value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(index++))) << 16;
-        retVal += ALPHABET.at((value & 0xFC0000) >> 18);
-        retVal += ALPHABET.at((value & 0x3F000) >> 12);
-        retVal += "==";
+}
+
+inline Player::~Player() {
+    if (m_threading) {
+        // Stop concurrent thread to manage cache.
+        setEnvelopeCacheFillingRunning(false);
+        m_envelopeCacheFillingThread.join();
     }
 
-    return retVal;
+    m_recFile.close();
 }
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
-
-//#include "cluon/ToCSVVisitor.hpp"
-//#include "cluon/ToJSONVisitor.hpp"
+////////////////////////////////////////////////////////////////////////
 
-#include <iomanip>
-#include <sstream>
+inline void Player::setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept {
+    std::lock_guard<std::mutex> lck(m_playerListenerMutex);
+    m_playerListener = playerListener;
+}
 
-namespace cluon {
+////////////////////////////////////////////////////////////////////////
 
-inline ToCSVVisitor::ToCSVVisitor(char delimiter, bool withHeader, const std::map<uint32_t, bool> &mask) noexcept
-    : m_mask(mask)
-    , m_prefix("")
-    , m_delimiter(delimiter)
-    , m_withHeader(withHeader)
-    , m_isNested(false) {}
+inline void Player::initializeIndex() noexcept {
+    m_recFile.open(m_file.c_str(), std::ios_base::in | std::ios_base::binary); /* Flawfinder: ignore */
+    m_recFileValid = m_recFile.good();
 
-inline ToCSVVisitor::ToCSVVisitor(const std::string &prefix, char delimiter, bool withHeader, bool isNested) noexcept
-    : m_prefix(prefix)
-    , m_delimiter(delimiter)
-    , m_withHeader(withHeader)
-    , m_isNested(isNested) {}
+    if (m_recFileValid && CompressedRec::isCompressedRec(m_recFile)) {
+        // Compressed .rec files carry their own index.
+        const cluon::data::TimeStamp BEFORE{cluon::time::now()};
+        m_compressedRecReader.reset(new CompressedRecReader());
+        for (const auto &e : m_compressedRecReader->readIndex(m_recFile)) {
+            m_index.emplace(std::make_pair(e.m_sampleTimeStamp, IndexEntry(e.m_sampleTimeStamp, CompressedRec::position(e.m_block, e.m_offsetInBlock))));
+        }
+        const cluon::data::TimeStamp AFTER{cluon::time::now()};
 
-inline void ToCSVVisitor::clear() noexcept {
-    m_bufferHeader.str("");
-    m_bufferValues.str("");
-    m_fillHeader = true;
-}
+        std::clog << "[cluon::Player]: " << m_file << " contains " << m_index.size() << " entries in " << m_compressedRecReader->numberOfBlocks()
+                  << " compressed blocks; read index in " << cluon::time::deltaInMicroseconds(AFTER, BEFORE) / static_cast<int64_t>(1000) << "ms."
+                  << std::endl;
+    } else if (m_recFileValid) {
+        // Determine file size to display progress.
+        m_recFile.seekg(0, m_recFile.end);
+        int64_t fileLength = m_recFile.tellg();
+        m_recFile.seekg(0, m_recFile.beg);
 
-inline std::string ToCSVVisitor::csv() const noexcept {
-    std::stringstream tmp;
-    if (m_withHeader) {
-        tmp << m_bufferHeader.str();
-    }
-    tmp << m_bufferValues.str();
-    const std::string retVal{tmp.str()};
-    return retVal;
-}
+        // Read complete file and store file positions to envelopes to create
+        // index of available data. The actual reading of Envelopes is deferred.
+        uint64_t totalBytesRead = 0;
+        const cluon::data::TimeStamp BEFORE{cluon::time::now()};
+        {
+            int32_t oldPercentage = -1;
+            while (m_recFile.good()) {
+                const uint64_t POS_BEFORE = static_cast<uint64_t>(m_recFile.tellg());
+                auto retVal               = extractEnvelope(m_recFile);
+                const uint64_t POS_AFTER  = static_cast<uint64_t>(m_recFile.tellg());
 
-inline void ToCSVVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
-    (void)shortName;
-    (void)longName;
-}
+                if (!m_recFile.eof() && retVal.first) {
+                    totalBytesRead += (POS_AFTER - POS_BEFORE);
 
-inline void ToCSVVisitor::postVisit() noexcept {
-    if (m_fillHeader) {
-        m_bufferHeader << (m_isNested ? "" : "\n");
-    }
-    m_fillHeader = false;
-    m_bufferValues << (m_isNested ? "" : "\n");
-}
+                    // Store mapping .rec file position --> index entry.
+                    const int64_t microseconds = cluon::time::toMicroseconds(retVal.second.sampleTimeStamp());
+                    m_index.emplace(std::make_pair(microseconds, IndexEntry(microseconds, POS_BEFORE)));
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+                    const int32_t percentage = static_cast<int32_t>((static_cast<float>(m_recFile.tellg()) * 100.0f) / static_cast<float>(fileLength));
+                    if ((percentage % 5 == 0) && (percentage != oldPercentage)) {
+                        std::clog << "[cluon::Player]: Indexed " << percentage << "% from " << m_file << "." << std::endl;
+                        oldPercentage = percentage;
+                    }
+                }
+            }
         }
-        m_bufferValues << v << m_delimiter;
-    }
-}
+        const cluon::data::TimeStamp AFTER{cluon::time::now()};
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << v << m_delimiter;
+        std::clog << "[cluon::Player]: " << m_file << " contains " << m_index.size() << " entries; "
+                  << "read " << totalBytesRead << " bytes "
+                  << "in " << cluon::time::deltaInMicroseconds(AFTER, BEFORE) / static_cast<int64_t>(1000 * 1000) << "s." << std::endl;
+    } else {
+        std::clog << "[cluon::Player]: " << m_file << " could not be opened." << std::endl;
     }
 }
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << +v << m_delimiter;
-    }
+inline void Player::resetCaches() noexcept {
+    try {
+        std::lock_guard<std::mutex> lck(m_indexMutex);
+        m_delay                            = 0;
+        m_numberOfReturnedEnvelopesInTotal = 0;
+        m_envelopeCache.clear();
+    } catch (...) {} // LCOV_EXCL_LINE
 }
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << +v << m_delimiter;
-    }
+inline void Player::resetIterators() noexcept {
+    try {
+        std::lock_guard<std::mutex> lck(m_indexMutex);
+        // Point to first entry in index.
+        m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay = m_index.begin();
+        // Invalidate iterator for erasing entries point.
+        m_previousPreviousEnvelopeAlreadyReplayed = m_index.end();
+    } catch (...) {} // LCOV_EXCL_LINE
 }
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+inline void Player::computeInitialCacheLevelAndFillCache() noexcept {
+    if (m_recFileValid && (m_index.size() > 0)) {
+        int64_t smallestSampleTimePoint = (std::numeric_limits<int64_t>::max)();
+        int64_t largestSampleTimePoint  = (std::numeric_limits<int64_t>::min)();
+        for (auto it = m_index.begin(); it != m_index.end(); it++) {
+            smallestSampleTimePoint = (std::min)(smallestSampleTimePoint, it->first);
+            largestSampleTimePoint  = (std::max)(largestSampleTimePoint, it->first);
         }
-        m_bufferValues << v << m_delimiter;
-    }
-}
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << v << m_delimiter;
-    }
-}
+        const uint32_t ENTRIES_TO_READ_PER_SECOND_FOR_REALTIME_REPLAY
+            = static_cast<uint32_t>(std::ceil(static_cast<float>(m_index.size()) * (static_cast<float>(Player::ONE_SECOND_IN_MICROSECONDS))
+                                              / static_cast<float>(largestSampleTimePoint - smallestSampleTimePoint)));
+        m_desiredInitialLevel = (std::max<uint32_t>)(ENTRIES_TO_READ_PER_SECOND_FOR_REALTIME_REPLAY * Player::LOOK_AHEAD_IN_S, MIN_ENTRIES_FOR_LOOK_AHEAD);
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << v << m_delimiter;
-    }
-}
+        std::clog << "[cluon::Player]: Initializing cache with " << m_desiredInitialLevel << " entries." << std::endl;
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << v << m_delimiter;
+        resetCaches();
+        resetIterators();
+        fillEnvelopeCache(m_desiredInitialLevel);
     }
 }
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << v << m_delimiter;
-    }
-}
+inline uint32_t Player::fillEnvelopeCache(const uint32_t &maxNumberOfEntriesToReadFromFile) noexcept {
+    uint32_t entriesReadFromFile = 0;
+    if (m_recFileValid && (maxNumberOfEntriesToReadFromFile > 0)) {
+        // Reset any fstream's error states.
+        m_recFile.clear();
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+        while ((m_nextEntryToReadFromRecFile != m_index.end()) && (entriesReadFromFile < maxNumberOfEntriesToReadFromFile)) {
+            // Read the corresponding cluon::data::Envelope.
+            auto retVal = readEnvelopeFromRecFile(m_nextEntryToReadFromRecFile->second.m_filePosition);
+            if (retVal.first) {
+                // Store the envelope in the envelope cache.
+                try {
+                    std::lock_guard<std::mutex> lck(m_indexMutex);
+                    m_nextEntryToReadFromRecFile->second.m_available
+                        = m_envelopeCache.emplace(std::make_pair(m_nextEntryToReadFromRecFile->second.m_filePosition, retVal.second)).second;
+                } catch (...) {} // LCOV_EXCL_LINE
+
+                m_nextEntryToReadFromRecFile++;
+                entriesReadFromFile++;
+            } else if (m_compressedRecReader) {
+                // Do not retry entries from corrupt blocks forever.
+                std::clog << "[cluon::Player]: Skipping unreadable entry in block " << (m_nextEntryToReadFromRecFile->second.m_filePosition >> 32) << "."
+                          << std::endl;
+                m_nextEntryToReadFromRecFile++;
+                entriesReadFromFile++;
+            }
         }
-        m_bufferValues << v << m_delimiter;
     }
+
+    return entriesReadFromFile;
 }
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << std::setprecision(7) << v << std::setprecision(6) << m_delimiter;
+inline std::pair<bool, cluon::data::Envelope> Player::readEnvelopeFromRecFile(const uint64_t &filePosition) noexcept {
+    if (m_compressedRecReader) {
+        return m_compressedRecReader->readEnvelope(m_recFile, filePosition);
     }
+
+    // Move to corresponding position in the .rec file.
+    m_recFile.seekg(static_cast<std::streamoff>(filePosition));
+    return extractEnvelope(m_recFile);
 }
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
+inline std::pair<bool, cluon::data::Envelope> Player::getNextEnvelopeToBeReplayed() noexcept {
+    bool hasEnvelopeToReturn{false};
+    cluon::data::Envelope envelopeToReturn;
+
+    // If at "EOF", either throw exception or autorewind.
+    if (m_currentEnvelopeToReplay == m_index.end()) {
+        if (!m_autoRewind) {
+            return std::make_pair(hasEnvelopeToReturn, envelopeToReturn);
+        } else {
+            rewind();
         }
-        m_bufferValues << std::setprecision(11) << v << std::setprecision(6) << m_delimiter;
     }
-}
 
-inline void ToCSVVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)typeName;
-    if ((0 == m_mask.count(id)) || m_mask[id]) {
-        if (m_fillHeader) {
-            m_bufferHeader << m_prefix << (!m_prefix.empty() ? "." : "") << name << m_delimiter;
-        }
-        m_bufferValues << '\"' << cluon::ToJSONVisitor::encodeBase64(v) << '\"' << m_delimiter;
-    }
-}
+    if (m_currentEnvelopeToReplay != m_index.end()) {
+        checkAvailabilityOfNextEnvelopeToBeReplayed();
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+        try {
+            {
+                std::lock_guard<std::mutex> lck(m_indexMutex);
 
-// clang-format off
-#ifdef WIN32
-    #include <Winsock2.h> // for htonll
-#endif
-// clang-format on
+                cluon::data::Envelope &nextEnvelope = m_envelopeCache[m_currentEnvelopeToReplay->second.m_filePosition];
+                envelopeToReturn                    = nextEnvelope;
 
-//#include "cluon/ToLCMVisitor.hpp"
+                m_delay = static_cast<uint32_t>(m_currentEnvelopeToReplay->first - m_previousEnvelopeAlreadyReplayed->first);
 
-#include <cstring>
+                // TODO: Delegate deleting into own thread.
+                if (m_previousPreviousEnvelopeAlreadyReplayed != m_index.end()) {
+                    auto it = m_envelopeCache.find(m_previousEnvelopeAlreadyReplayed->second.m_filePosition);
+                    if (it != m_envelopeCache.end()) {
+                        m_envelopeCache.erase(it);
+                    }
+                }
 
-namespace cluon {
+                m_previousPreviousEnvelopeAlreadyReplayed = m_previousEnvelopeAlreadyReplayed;
+                m_previousEnvelopeAlreadyReplayed         = m_currentEnvelopeToReplay++;
 
-inline std::string ToLCMVisitor::encodedData(bool withHash) const noexcept {
-    int64_t _hash = hash();
-    _hash         = static_cast<int64_t>(htobe64(_hash));
+                m_numberOfReturnedEnvelopesInTotal++;
+            }
 
-    std::stringstream hashBuffer;
-    hashBuffer.write(reinterpret_cast<const char *>(&_hash), sizeof(int64_t));
+            // TODO compensate for internal data processing.
 
-    const std::string s{(withHash ? hashBuffer.str() : "") + m_buffer.str()};
-    return s;
-}
+            // If Player is non-threaded, read next entry sequentially.
+            if (!m_threading) {
+                fillEnvelopeCache(1);
+            }
 
-////////////////////////////////////////////////////////////////////////////////
+            // Store sample time stamp as int64 to avoid unnecessary copying of Envelopes.
+            hasEnvelopeToReturn = true;
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
+    return std::make_pair(hasEnvelopeToReturn, envelopeToReturn);
+}
 
-inline void ToLCMVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
-    (void)shortName;
-    (void)longName;
+inline void Player::checkAvailabilityOfNextEnvelopeToBeReplayed() noexcept {
+    uint64_t numberOfEntries = 0;
+    do {
+        {
+            try {
+                std::lock_guard<std::mutex> lck(m_indexMutex);
+                numberOfEntries = m_envelopeCache.size();
+            } catch (...) {} // LCOV_EXCL_LINE
+        }
+        if (0 == numberOfEntries) {
+            using namespace std::chrono_literals; // LCOV_EXCL_LINE
+            std::this_thread::sleep_for(10ms);    // LCOV_EXCL_LINE
+        }
+    } while (0 == numberOfEntries);
 }
 
-inline void ToLCMVisitor::postVisit() noexcept {}
+////////////////////////////////////////////////////////////////////////
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("boolean");
-    calculateHash(0);
-    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(bool));
+inline uint32_t Player::totalNumberOfEnvelopesInRecFile() const noexcept {
+    std::lock_guard<std::mutex> lck(m_indexMutex);
+    return static_cast<uint32_t>(m_index.size());
 }
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int8_t");
-    calculateHash(0);
-    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(char));
+inline uint32_t Player::delay() const noexcept {
+    std::lock_guard<std::mutex> lck(m_indexMutex);
+    // Make sure that delay is not exceeding the specified maximum delay.
+    return std::min<uint32_t>(m_delay, Player::MAX_DELAY_IN_MICROSECONDS);
 }
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int8_t");
-    calculateHash(0);
-    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(int8_t));
-}
+inline void Player::rewind() noexcept {
+    if (m_threading) {
+        // Stop concurrent thread.
+        setEnvelopeCacheFillingRunning(false);
+        m_envelopeCacheFillingThread.join();
+    }
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int8_t");
-    calculateHash(0);
-    m_buffer.write(reinterpret_cast<char *>(&v), sizeof(uint8_t));
-}
+    computeInitialCacheLevelAndFillCache();
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int16_t");
-    calculateHash(0);
-    int16_t _v = static_cast<int16_t>(htobe16(v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int16_t));
+    if (m_threading) {
+        // Re-start concurrent thread.
+        setEnvelopeCacheFillingRunning(true);
+        m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
+    }
 }
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int16_t");
-    calculateHash(0);
-    int16_t _v = static_cast<int16_t>(htobe16(v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int16_t));
-}
+inline void Player::seekTo(float ratio) noexcept {
+    if (!(ratio < 0) && !(ratio > 1)) {
+        bool enableThreading = m_threading;
+        if (m_threading) {
+            // Stop concurrent thread.
+            setEnvelopeCacheFillingRunning(false);
+            m_envelopeCacheFillingThread.join();
+        }
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int32_t");
-    calculateHash(0);
-    int32_t _v = static_cast<int32_t>(htobe32(v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-}
+        // Read data sequentially.
+        m_threading = false;
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int32_t");
-    calculateHash(0);
-    int32_t _v = static_cast<int32_t>(htobe32(v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-}
+        resetCaches();
+        resetIterators();
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int64_t");
-    calculateHash(0);
-    int64_t _v = static_cast<int64_t>(htobe64(v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int64_t));
-}
+        uint32_t numberOfEntriesInIndex = 0;
+        try {
+            std::lock_guard<std::mutex> lck(m_indexMutex);
+            numberOfEntriesInIndex = static_cast<uint32_t>(m_index.size());
+        } catch (...) {} // LCOV_EXCL_LINE
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("int64_t");
-    calculateHash(0);
-    int64_t _v = static_cast<int64_t>(htobe64(v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int64_t));
-}
+        // Fast forward.
+        m_numberOfReturnedEnvelopesInTotal = 0;
+        std::clog << "[cluon::Player]: Seeking to " << static_cast<float>(numberOfEntriesInIndex) * ratio << "/" << numberOfEntriesInIndex << std::endl;
+        if (0 < ratio) {
+            for (m_numberOfReturnedEnvelopesInTotal = 0;
+                 m_numberOfReturnedEnvelopesInTotal < static_cast<uint32_t>(static_cast<float>(numberOfEntriesInIndex) * ratio) - 1;
+                 m_numberOfReturnedEnvelopesInTotal++) {
+                m_currentEnvelopeToReplay++;
+            }
+        }
+        try {
+            std::lock_guard<std::mutex> lck(m_indexMutex);
+            m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay;
+        } catch (...) {} // LCOV_EXCL_LINE
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("float");
-    calculateHash(0);
-    int32_t _v{0};
-    std::memmove(&_v, &v, sizeof(int32_t));
-    _v = static_cast<int32_t>(htobe32(_v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-}
+        // Refill cache.
+        m_envelopeCache.clear();
+        fillEnvelopeCache(static_cast<uint32_t>(static_cast<float>(m_desiredInitialLevel) * .3f));
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("double");
-    calculateHash(0);
-    int64_t _v{0};
-    std::memmove(&_v, &v, sizeof(int64_t));
-    _v = static_cast<int64_t>(htobe64(_v));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int64_t));
+        // Correct iterators if not at the beginning.
+        if ((0 < ratio) && (ratio < 1)) {
+            getNextEnvelopeToBeReplayed();
+        }
+        std::clog << "[cluon::Player]: Seeking done." << std::endl;
+
+        if (enableThreading) {
+            m_threading = enableThreading;
+            // Re-start concurrent thread.
+            setEnvelopeCacheFillingRunning(true);
+            m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
+        }
+    }
 }
 
-inline void ToLCMVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)id;
-    (void)typeName;
-    calculateHash(name);
-    calculateHash("string");
-    calculateHash(0);
+inline bool Player::hasMoreData() const noexcept {
+    std::lock_guard<std::mutex> lck(m_indexMutex);
+    return hasMoreDataFromRecFile();
+}
 
-    const std::size_t LENGTH = v.length();
-    int32_t _v               = static_cast<int32_t>(htobe32(static_cast<uint32_t>(LENGTH + 1)));
-    m_buffer.write(reinterpret_cast<char *>(&_v), sizeof(int32_t));
-    m_buffer.write(v.c_str(), static_cast<std::streamsize>(LENGTH)); // LENGTH won't be negative.
-    m_buffer << '\0';
+inline bool Player::hasMoreDataFromRecFile() const noexcept {
+    // File must be successfully opened AND
+    //  the Player must be configured as m_autoRewind OR
+    //  some entries are left to replay.
+    return (m_recFileValid && (m_autoRewind || (m_currentEnvelopeToReplay != m_index.end())));
 }
 
-////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
 
-inline int64_t ToLCMVisitor::hash() const noexcept {
-    // Apply ZigZag encoding for hash from this message's fields and depending
-    // hashes for complex nested types.
-    int64_t tmp{m_hash};
-    for (int64_t v : m_hashes) { tmp += v; }
+inline void Player::setEnvelopeCacheFillingRunning(const bool &running) noexcept {
+    std::lock_guard<std::mutex> lck(m_envelopeCacheFillingThreadIsRunningMutex);
+    m_envelopeCacheFillingThreadIsRunning = running;
+}
 
-    const int64_t hash = (tmp << 1) + ((tmp >> 63) & 1);
-    return hash;
+inline bool Player::isEnvelopeCacheFillingRunning() const noexcept {
+    std::lock_guard<std::mutex> lck(m_envelopeCacheFillingThreadIsRunningMutex);
+    return m_envelopeCacheFillingThreadIsRunning;
 }
 
-inline void ToLCMVisitor::calculateHash(char c) noexcept {
-    m_hash = ((m_hash << 8) ^ (m_hash >> 55)) + c;
+inline void Player::manageCache() noexcept {
+    uint8_t statisticsCounter = 0;
+    float refillMultiplicator = 1.1f;
+    uint32_t numberOfEntries  = 0;
+
+    while (isEnvelopeCacheFillingRunning()) {
+        try {
+            std::lock_guard<std::mutex> lck(m_indexMutex);
+            numberOfEntries = static_cast<uint32_t>(m_envelopeCache.size());
+        } catch (...) {} // LCOV_EXCL_LINE
+
+        // Check if refilling of the cache is needed.
+        refillMultiplicator = checkRefillingCache(numberOfEntries, refillMultiplicator);
+        (void)refillMultiplicator;
+
+        // Manage cache at 10 Hz.
+        using namespace std::chrono_literals;
+        std::this_thread::sleep_for(100ms);
+
+        // Publish some statistics at 1 Hz.
+        if (0 == ((++statisticsCounter) % 10)) {
+            uint64_t numberOfReturnedEnvelopesInTotal = 0;
+            uint32_t totalNumberOfEnvelopes           = 0;
+            try {
+                // m_numberOfReturnedEnvelopesInTotal is modified in a different thread.
+                std::lock_guard<std::mutex> lck(m_indexMutex);
+                numberOfReturnedEnvelopesInTotal = m_numberOfReturnedEnvelopesInTotal;
+                totalNumberOfEnvelopes           = static_cast<uint32_t>(m_index.size());
+            } catch (...) {} // LCOV_EXCL_LINE
+
+            try {
+                std::lock_guard<std::mutex> lck(m_playerListenerMutex);
+                if (nullptr != m_playerListener) {
+                    cluon::data::PlayerStatus ps;
+                    ps.state(2); // State: "playback"
+                    ps.numberOfEntries(totalNumberOfEnvelopes);
+                    ps.currentEntryForPlayback(static_cast<uint32_t>(numberOfReturnedEnvelopesInTotal));
+                    m_playerListener(ps);
+                }
+            } catch (...) {} // LCOV_EXCL_LINE
+
+            statisticsCounter = 0;
+        }
+    }
 }
 
-inline void ToLCMVisitor::calculateHash(const std::string &s) noexcept {
-    const std::string tmp{(s.length() > 255 ? s.substr(0, 255) : s)};
-    const uint8_t length{static_cast<uint8_t>(tmp.length())};
-    calculateHash(static_cast<char>(length));
-    for (auto c : s) { calculateHash(c); }
+inline float Player::checkRefillingCache(const uint32_t &numberOfEntries, float refillMultiplicator) noexcept {
+    // If filling level is around 35%, pour in more from the recording.
+    if (numberOfEntries < 0.35 * m_desiredInitialLevel) {
+        const uint32_t entriesReadFromFile = fillEnvelopeCache(static_cast<uint32_t>(refillMultiplicator * static_cast<float>(m_desiredInitialLevel)));
+        if (entriesReadFromFile > 0) {
+            std::clog << "[cluon::Player]: Number of entries in cache: " << numberOfEntries << ". " << entriesReadFromFile << " added to cache. "
+                      << m_envelopeCache.size() << " entries available." << std::endl;
+            refillMultiplicator *= 1.25f;
+        }
+    }
+    return refillMultiplicator;
 }
 
 } // namespace cluon
@@ -13549,1261 +17323,1865 @@ inline void ToLCMVisitor::calculateHash(const std::string &s) noexcept {
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/LCMToGenericMessage.hpp"
-//#include "cluon/FromLCMVisitor.hpp"
-//#include "cluon/MessageParser.hpp"
-
-#include <array>
-#include <iostream>
-#include <sstream>
+//#include "cluon/SharedMemory.hpp"
 
 // clang-format off
 #ifdef WIN32
-    #undef be32toh
-    #define be32toh(x) __ntohl(x)
-
-    #include <cstdint>
-    #include <cstring>
-    uint32_t __ntohl(const uint32_t v) {
-        uint8_t d[4] = {};
-        std::memmove(&d, &v, sizeof(d));
-
-        return ((uint32_t) d[3] << 0)
-             | ((uint32_t) d[2] << 8)
-             | ((uint32_t) d[1] << 16)
-             | ((uint32_t) d[0] << 24);
-    }
+    #include <limits>
+#else
+    #include <cstdlib>
+    #include <fcntl.h>
+    #include <sys/ipc.h>
+    #include <sys/mman.h>
+    #include <sys/sem.h>
+    #include <sys/shm.h>
+    #include <sys/stat.h>
+    #include <sys/time.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+#ifdef __linux__
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
 #endif
 // clang-format on
 
-namespace cluon {
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <thread>
 
-inline int32_t LCMToGenericMessage::setMessageSpecification(const std::string &ms) noexcept {
-    int32_t retVal{-1};
+#if !defined(__APPLE__) && !defined(__OpenBSD__) && (defined(_SEM_SEMUN_UNDEFINED) || !defined(__FreeBSD__))
+union semun {
+    int val;               /* for SETVAL */
+    struct semid_ds *buf;  /* for IPC_STAT and IPC_SET */
+    unsigned short *array; /* for GETALL and SETALL*/
+};
+#endif
 
-    m_listOfMetaMessages.clear();
-    m_scopeOfMetaMessages.clear();
+namespace cluon {
 
-    cluon::MessageParser mp;
-    auto parsingResult = mp.parse(ms);
-    if (cluon::MessageParser::MessageParserErrorCodes::NO_MESSAGEPARSER_ERROR == parsingResult.second) {
-        m_listOfMetaMessages = parsingResult.first;
-        for (const auto &mm : m_listOfMetaMessages) { m_scopeOfMetaMessages[mm.messageName()] = mm; }
-        retVal = static_cast<int32_t>(m_listOfMetaMessages.size());
-    }
-    return retVal;
-}
+inline SharedMemory::SharedMemory(const std::string &name, uint32_t size) noexcept
+    : m_size(size) {
+    if (!name.empty()) {
+#ifdef WIN32
+        constexpr int MAX_LENGTH_NAME{MAX_PATH};
+#else
+        constexpr int MAX_LENGTH_NAME{254};
+#endif
+        const std::string n{name.substr(0, (name.size() > MAX_LENGTH_NAME ? MAX_LENGTH_NAME : name.size()))};
+        if ('/' != n[0]) {
+            m_name = "/";
+        }
 
-inline cluon::GenericMessage LCMToGenericMessage::getGenericMessage(const std::string &data) noexcept {
-    cluon::GenericMessage gm;
+#ifndef WIN32
+#if defined(__NetBSD__) || defined(__OpenBSD__)
+        std::clog << "[cluon::SharedMemory] Found NetBSD or OpenBSD; using SysV implementation." << std::endl;
+        m_usePOSIX = false;
+#else
+        const char *CLUON_SHAREDMEMORY_POSIX = getenv("CLUON_SHAREDMEMORY_POSIX");
+        m_usePOSIX                           = ((nullptr != CLUON_SHAREDMEMORY_POSIX) && (CLUON_SHAREDMEMORY_POSIX[0] == '1'));
+#ifdef __linux__
+        // The futex-based implementation uses POSIX shared memory with a different header; producer and consumers must agree on it.
+        const char *CLUON_SHAREDMEMORY_FUTEX = getenv("CLUON_SHAREDMEMORY_FUTEX");
+        m_useFutex                           = ((nullptr != CLUON_SHAREDMEMORY_FUTEX) && (CLUON_SHAREDMEMORY_FUTEX[0] == '1'));
+        m_usePOSIX |= m_useFutex;
+        std::clog << "[cluon::SharedMemory] Using " << (m_useFutex ? "futex" : (m_usePOSIX ? "POSIX" : "SysV")) << " implementation." << std::endl;
+#else
+        std::clog << "[cluon::SharedMemory] Using " << (m_usePOSIX ? "POSIX" : "SysV") << " implementation." << std::endl;
+#endif
+#endif
+        // Define filename for timestamping.
+        if (0 != n.find("/tmp")) {
+            m_nameForTimeStamping = "/tmp" + m_name;
 
-    if (!m_listOfMetaMessages.empty()) {
-        constexpr uint8_t LCM_HEADER_SIZE{4 /*magic number*/ + 4 /*sequence number*/ + 1 /*'\0' after channel name*/};
-        if (LCM_HEADER_SIZE < data.size()) {
-            // First, read magic number.
-            constexpr uint32_t MAGIC_NUMBER_LCM2{0x4c433032};
-            uint32_t offset{0};
-            uint32_t magicNumber{0};
-            {
-                std::stringstream sstr{std::string(&data[offset], 4)};
-                // clang-format off
-                sstr.read(reinterpret_cast<char *>(&magicNumber), sizeof(uint32_t)); /* Flawfinder: ignore */ // NOLINT
-                // clang-format on
-                magicNumber = be32toh(magicNumber);
+            // For NetBSD and OpenBSD or for the SysV-based implementation, we put all token files to /tmp.
+            if (!m_usePOSIX) {
+                m_name = m_nameForTimeStamping;
             }
-            if (MAGIC_NUMBER_LCM2 == magicNumber) {
-                offset += 4;
-
-                // Next, read sequence number in case of fragmented data.
-                uint32_t sequenceNumber{0};
-                {
-                    std::stringstream sstr{std::string(&data[offset], 4)};
-                    // clang-format off
-                    sstr.read(reinterpret_cast<char *>(&sequenceNumber), sizeof(uint32_t)); /* Flawfinder: ignore */ // NOLINT
-                    // clang-format on
-                    sequenceNumber = be32toh(sequenceNumber);
-                }
-                // Only support for non-fragmented messages.
-                if (0 == sequenceNumber) {
-                    offset += 4;
-
-                    const std::string::size_type START_POSITION = offset;
-                    std::string::size_type pos                  = data.find('\0', START_POSITION); // Extract channel name.
-                    if (std::string::npos != pos) {
-                        const std::string CHANNEL_NAME(data.substr(START_POSITION, (pos - START_POSITION)));
-
-                        // Next, find the MetaMessage corresponding to the channel name
-                        // and create a Message therefrom based on the decoded LCM data.
-                        if ((0 < m_scopeOfMetaMessages.count(CHANNEL_NAME)) && (std::string::npos != (pos + 1))) {
-                            // data[offset+i] marks now the beginning of the payload to be decoded.
-                            std::stringstream sstr{data.substr(pos + 1)};
+        }
+#endif
 
-                            cluon::FromLCMVisitor fromLCM;
-                            fromLCM.decodeFrom(sstr);
+        // Name of the shared memory.
+        {
+            m_name += n;
+            if (m_name.size() > MAX_LENGTH_NAME) {
+                m_name = m_name.substr(0, MAX_LENGTH_NAME);
+            }
+        }
 
-                            gm.createFrom(m_scopeOfMetaMessages[CHANNEL_NAME], m_listOfMetaMessages);
-                            gm.accept(fromLCM);
-                        }
-                    }
-                }
+        // Name of the file for timestamping.
+        {
+            m_nameForTimeStamping += n;
+            if (m_nameForTimeStamping.size() > MAX_LENGTH_NAME) {
+                m_nameForTimeStamping = m_nameForTimeStamping.substr(0, MAX_LENGTH_NAME);
             }
         }
+
+#ifdef WIN32
+        initWIN32();
+#else
+#ifdef __linux__
+        if (m_useFutex) {
+            initFutex();
+            return;
+        }
+#endif
+        if (m_usePOSIX) {
+            initPOSIX();
+        } else {
+            initSysV();
+        }
+#endif
     }
-
-    return gm;
 }
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
-
-// clang-format off
+inline SharedMemory::~SharedMemory() noexcept {
 #ifdef WIN32
-    #include <Winsock2.h> // for htonl, htons
+    deinitWIN32();
+#else
+#ifdef __linux__
+    if (m_useFutex) {
+        deinitFutex();
+    } else
 #endif
-// clang-format on
-
-//#include "cluon/ToMsgPackVisitor.hpp"
-
-#include <cstring>
-#include <limits>
+    if (m_usePOSIX) {
+        deinitPOSIX();
+    } else {
+        deinitSysV();
+    }
+#endif
+}
 
-namespace cluon {
+inline bool SharedMemory::isLocked() const noexcept {
+    return m_isLocked.load();
+}
 
-inline std::string ToMsgPackVisitor::encodedData() const noexcept {
-    std::stringstream prefix;
-    if (m_numberOfFields <= 0xF) {
-        const uint8_t pairs = static_cast<uint8_t>(MsgPackConstants::FIXMAP) | static_cast<uint8_t>(m_numberOfFields);
-        prefix.write(reinterpret_cast<const char *>(&pairs), sizeof(uint8_t));
-    } else if ((m_numberOfFields > 0xF) && (m_numberOfFields <= 0xFFFF)) {
-        const uint8_t pairs = static_cast<uint8_t>(MsgPackConstants::MAP16);
-        prefix.write(reinterpret_cast<const char *>(&pairs), sizeof(uint8_t));
-        uint16_t n = htobe16(static_cast<uint16_t>(m_numberOfFields));
-        prefix.write(reinterpret_cast<const char *>(&n), sizeof(uint16_t));
-    } else if (m_numberOfFields > 0xFFFF) {                                    // LCOV_EXCL_LINE
-        const uint8_t pairs = static_cast<uint8_t>(MsgPackConstants::MAP32);   // LCOV_EXCL_LINE
-        prefix.write(reinterpret_cast<const char *>(&pairs), sizeof(uint8_t)); // LCOV_EXCL_LINE
-        uint32_t n = htobe32(static_cast<uint32_t>(m_numberOfFields));         // LCOV_EXCL_LINE
-        prefix.write(reinterpret_cast<const char *>(&n), sizeof(uint32_t));    // LCOV_EXCL_LINE
+inline void SharedMemory::lock() noexcept {
+#ifdef WIN32
+    lockWIN32();
+#else
+#ifdef __linux__
+    if (m_useFutex) {
+        lockFutex();
+    } else
+#endif
+    if (m_usePOSIX) {
+        lockPOSIX();
+    } else {
+        lockSysV();
     }
-    std::string s{prefix.str() + m_buffer.str()};
-    return s;
+#endif
+    m_isLocked.store(true);
 }
 
-inline void ToMsgPackVisitor::encode(std::ostream &o, const std::string &s) {
-    const uint32_t LENGTH{static_cast<uint32_t>(s.size())};
-    if (LENGTH < 32) {
-        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::FIXSTR) | static_cast<uint8_t>(LENGTH);
-        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
-    } else if (LENGTH <= 0xFF) {
-        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::STR8);
-        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
-        uint8_t len = static_cast<uint8_t>(LENGTH);
-        o.write(reinterpret_cast<const char *>(&len), sizeof(uint8_t));
-    } else if (LENGTH <= 0xFFFF) {
-        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::STR16);
-        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
-        uint16_t len = htobe16(static_cast<uint16_t>(LENGTH));
-        o.write(reinterpret_cast<const char *>(&len), sizeof(uint16_t));
+inline void SharedMemory::unlock() noexcept {
+#ifdef WIN32
+    unlockWIN32();
+#else
+#ifdef __linux__
+    if (m_useFutex) {
+        unlockFutex();
+    } else
+#endif
+    if (m_usePOSIX) {
+        unlockPOSIX();
     } else {
-        const uint8_t v = static_cast<uint8_t>(MsgPackConstants::STR32);
-        o.write(reinterpret_cast<const char *>(&v), sizeof(uint8_t));
-        uint32_t len = htobe32(LENGTH);
-        o.write(reinterpret_cast<const char *>(&len), sizeof(uint32_t));
+        unlockSysV();
     }
-    o.write(s.c_str(), static_cast<std::streamsize>(LENGTH)); // LENGTH won't be negative.
+#endif
+    m_isLocked.store(false);
 }
 
-inline void ToMsgPackVisitor::encodeUint(std::ostream &o, uint64_t v) {
-    if (0x7f >= v) {
-        const uint8_t _v = static_cast<uint8_t>(v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint8_t));
-    } else if (0xFF >= v) {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT8);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        const uint8_t _v = static_cast<uint8_t>(v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint8_t));
-    } else if (0xFFFF >= v) {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT16);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        uint16_t _v = static_cast<uint16_t>(v);
-        _v          = htobe16(_v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint16_t));
-    } else if (0xFFFFFFFF >= v) {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT32);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        uint32_t _v = static_cast<uint32_t>(v);
-        _v          = htobe32(_v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint32_t));
+inline void SharedMemory::wait() noexcept {
+#ifdef WIN32
+    waitWIN32();
+#else
+#ifdef __linux__
+    if (m_useFutex) {
+        waitFutex();
+    } else
+#endif
+    if (m_usePOSIX) {
+        waitPOSIX();
     } else {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::UINT64);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        uint64_t _v = v;
-        _v          = htobe64(_v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(uint64_t));
+        waitSysV();
     }
+#endif
 }
 
-inline void ToMsgPackVisitor::encodeInt(std::ostream &o, int64_t v) {
-    if (-31 <= v) {
-        int8_t _v = static_cast<int8_t>(v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(int8_t));
-    } else if (std::numeric_limits<int8_t>::lowest() <= v) {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT8);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        int8_t _v = static_cast<int8_t>(v);
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(int8_t));
-    } else if (std::numeric_limits<int16_t>::lowest() <= v) {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT16);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        int16_t _v = static_cast<int16_t>(v);
-        _v         = static_cast<int16_t>(htobe16(_v));
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(int16_t));
-    } else if (std::numeric_limits<int32_t>::lowest() <= v) {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT32);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        int32_t _v = static_cast<int32_t>(v);
-        _v         = static_cast<int32_t>(htobe32(_v));
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(int32_t));
+inline void SharedMemory::notifyAll() noexcept {
+#ifdef WIN32
+    notifyAllWIN32();
+#else
+#ifdef __linux__
+    if (m_useFutex) {
+        notifyAllFutex();
+    } else
+#endif
+    if (m_usePOSIX) {
+        notifyAllPOSIX();
     } else {
-        const uint8_t t = static_cast<uint8_t>(MsgPackConstants::INT64);
-        o.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-        int64_t _v = static_cast<int64_t>(v);
-        _v         = static_cast<int64_t>(htobe64(_v));
-        o.write(reinterpret_cast<const char *>(&_v), sizeof(int64_t));
+        notifyAllSysV();
     }
+#endif
 }
 
-inline void ToMsgPackVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)id;
-    (void)shortName;
-    (void)longName;
-
-    m_numberOfFields = 0;
-    m_buffer.str("");
+inline void SharedMemory::lockShared() noexcept {
+#ifdef __linux__
+    if (m_useFutex) {
+        lockSharedFutex();
+        m_isLocked.store(true);
+        return;
+    }
+#endif
+    lock();
 }
 
-inline void ToMsgPackVisitor::postVisit() noexcept {}
+inline bool SharedMemory::unlockShared() noexcept {
+#ifdef __linux__
+    if (m_useFutex) {
+        const bool CONSISTENT{unlockSharedFutex()};
+        m_isLocked.store(false);
+        return CONSISTENT;
+    }
+#endif
+    unlock();
+    return true;
+}
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)id;
-    (void)typeName;
+inline uint32_t SharedMemory::generation() noexcept {
+#ifdef __linux__
+    if (m_useFutex && (nullptr != m_sharedMemoryFutexHeader)) {
+        return m_sharedMemoryFutexHeader->__generation.load();
+    }
+#endif
+    return 0;
+}
 
-    encode(m_buffer, name);
-    const uint8_t value = (v ? static_cast<uint8_t>(MsgPackConstants::IS_TRUE) : static_cast<uint8_t>(MsgPackConstants::IS_FALSE));
-    m_buffer.write(reinterpret_cast<const char *>(&value), sizeof(uint8_t));
-    m_numberOfFields++;
+inline uint32_t SharedMemory::slots() noexcept {
+#ifdef __linux__
+    if (m_useFutex && (nullptr != m_sharedMemoryFutexHeader)) {
+        return m_sharedMemoryFutexHeader->__slots;
+    }
+#endif
+    return 1;
 }
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)id;
-    (void)typeName;
+inline uint64_t SharedMemory::slotReuses() noexcept {
+#ifdef __linux__
+    if (m_useFutex && (nullptr != m_sharedMemoryFutexHeader)) {
+        return m_sharedMemoryFutexHeader->__slotReuses.load();
+    }
+#endif
+    return 0;
+}
 
-    encode(m_buffer, name);
-    const std::string s(1, v);
-    encode(m_buffer, s);
-    m_numberOfFields++;
+inline uint64_t SharedMemory::overruns() const noexcept {
+#ifdef __linux__
+    return m_overruns.load();
+#else
+    return 0;
+#endif
 }
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+inline bool SharedMemory::setTimeStamp(const cluon::data::TimeStamp &ts) noexcept {
+    bool retVal{false};
 
-    encode(m_buffer, name);
-    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint8_t>(v));
-    m_numberOfFields++;
-}
+#ifdef __linux__
+    // With several slots, every slot carries its own time stamp.
+    if (m_useFutex && (1 < slots())) {
+        if ((retVal = isLocked())) {
+            m_slotHeaders[m_currentSlot].__seconds      = ts.seconds();
+            m_slotHeaders[m_currentSlot].__microseconds = ts.microseconds();
+        }
+        return retVal;
+    }
+#endif
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+#ifdef WIN32
+    (void)ts;
+#else
+    if ((retVal = isLocked())) {
+#ifdef __APPLE__
+        struct timeval accessedTime;
+        accessedTime.tv_sec = 0;
+        accessedTime.tv_usec = 0;
 
-    encode(m_buffer, name);
-    encodeUint(m_buffer, v);
-    m_numberOfFields++;
-}
+        struct timeval modifiedTime;
+        modifiedTime.tv_sec = ts.seconds();
+        modifiedTime.tv_usec = ts.microseconds();
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+        struct timeval times[2]{accessedTime, modifiedTime};
+        if (0 != futimes(m_fdForTimeStamping, times)) {
+            std::cerr << "[cluon::SharedMemory] Failed to set time stamp: '" << strerror(errno) << "' (" << errno << "): " << std::endl;
+            retVal = false;
+        }
+#else
+        struct timespec accessedTime;
+        accessedTime.tv_sec = 0;
+        accessedTime.tv_nsec = UTIME_OMIT;
 
-    encode(m_buffer, name);
-    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint16_t>(v));
-    m_numberOfFields++;
-}
+        struct timespec modifiedTime;
+        modifiedTime.tv_sec = ts.seconds();
+        modifiedTime.tv_nsec = ts.microseconds()*1000;
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+        struct timespec times[2]{accessedTime, modifiedTime};
+        if (0 != futimens(m_fdForTimeStamping, times)) {
+            std::cerr << "[cluon::SharedMemory] Failed to set time stamp: '" << strerror(errno) << "' (" << errno << "): " << std::endl; // LCOV_EXCL_LINE
+            retVal = false; // LCOV_EXCL_LINE
+        }
+#endif
+    }
+#endif
 
-    encode(m_buffer, name);
-    encodeUint(m_buffer, v);
-    m_numberOfFields++;
+    return retVal;
 }
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+inline std::pair<bool, cluon::data::TimeStamp> SharedMemory::getTimeStamp() noexcept {
+    bool retVal{false};
+    cluon::data::TimeStamp sampleTimeStamp;
 
-    encode(m_buffer, name);
-    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint32_t>(v));
-    m_numberOfFields++;
-}
+#ifdef __linux__
+    if (m_useFutex && (1 < slots())) {
+        if ((retVal = isLocked())) {
+            sampleTimeStamp.seconds(m_slotHeaders[m_currentSlot].__seconds).microseconds(m_slotHeaders[m_currentSlot].__microseconds);
+        }
+        return std::make_pair(retVal, sampleTimeStamp);
+    }
+#endif
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+#ifndef WIN32
+    if ((retVal = isLocked())) {
+        struct stat fileStatus;
+        auto r = fstat(m_fdForTimeStamping, &fileStatus);
+        if (0 == r) {
+#ifdef __APPLE__
+            sampleTimeStamp.seconds(static_cast<int32_t>(fileStatus.st_mtimespec.tv_sec))
+                           .microseconds(static_cast<int32_t>(fileStatus.st_mtimespec.tv_nsec/1000));
+#else
+            sampleTimeStamp.seconds(static_cast<int32_t>(fileStatus.st_mtim.tv_sec))
+                           .microseconds(static_cast<int32_t>(fileStatus.st_mtim.tv_nsec/1000));
+#endif
+        }
+    }
+#endif
 
-    encode(m_buffer, name);
-    encodeUint(m_buffer, v);
-    m_numberOfFields++;
+    return std::make_pair(retVal, sampleTimeStamp);
 }
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+inline bool SharedMemory::valid() noexcept {
+    bool valid{!m_broken.load()};
+    valid &= (nullptr != m_sharedMemory);
+    valid &= (0 < m_size);
+#ifndef WIN32
+#ifdef __linux__
+    if (m_useFutex) {
+        valid &= validFutex();
+    } else
+#endif
+    if (m_usePOSIX) {
+        valid &= validPOSIX();
+    } else {
+        valid &= validSysV();
+    }
+#endif
+    return valid;
+}
 
-    encode(m_buffer, name);
-    (v < 0) ? encodeInt(m_buffer, v) : encodeUint(m_buffer, static_cast<uint64_t>(v));
-    m_numberOfFields++;
+inline char *SharedMemory::data() noexcept {
+    return m_userAccessibleSharedMemory;
 }
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)id;
-    (void)typeName;
+inline uint32_t SharedMemory::size() const noexcept {
+    return m_size;
+}
 
-    encode(m_buffer, name);
-    encodeUint(m_buffer, v);
-    m_numberOfFields++;
+inline const std::string SharedMemory::name() const noexcept {
+    return m_name;
 }
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)id;
-    (void)typeName;
+////////////////////////////////////////////////////////////////////////////////
+// Platform-dependent implementations.
+#ifdef WIN32
+inline void SharedMemory::initWIN32() noexcept {
+    std::string mutexName = m_name;
+    if (mutexName.size() > MAX_PATH) {
+        mutexName = mutexName.substr(0, MAX_PATH - 6);
+    }
+    const std::string conditionEventName = mutexName + "_event";
+    mutexName += "_mutex";
 
-    encode(m_buffer, name);
-    const uint8_t t = static_cast<uint8_t>(MsgPackConstants::FLOAT);
-    m_buffer.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-    uint32_t _v{0};
-    std::memmove(&_v, &v, sizeof(float));
-    _v = htobe32(_v);
-    m_buffer.write(reinterpret_cast<const char *>(&_v), sizeof(uint32_t));
-    m_numberOfFields++;
-}
+    if (0 < m_size) {
+        // Create a shared memory area and semaphores.
+        const LONG MUTEX_INITIAL_COUNT = 1;
+        const LONG MUTEX_MAX_COUNT     = 1;
+        const DWORD FLAGS              = 0; // Reserved.
+        __mutex                        = CreateSemaphoreEx(NULL, MUTEX_INITIAL_COUNT, MUTEX_MAX_COUNT, mutexName.c_str(), FLAGS, SEMAPHORE_ALL_ACCESS);
+        if (nullptr != __mutex) {
+            __conditionEvent = CreateEvent(
+                NULL /*use default security*/, TRUE /*manually resetting event*/, FALSE /*initial state is not signaled*/, conditionEventName.c_str());
+            if (nullptr != __conditionEvent) {
+                __sharedMemory = CreateFileMapping(INVALID_HANDLE_VALUE /*use paging file*/,
+                                                   NULL /*use default security*/,
+                                                   PAGE_READWRITE,
+                                                   0,
+                                                   m_size + sizeof(uint32_t) /*size + size-information (uint32_t)*/,
+                                                   m_name.c_str());
+                if (nullptr != __sharedMemory) {
+                    m_sharedMemory = (char *)MapViewOfFile(__sharedMemory, FILE_MAP_ALL_ACCESS, 0, 0, m_size + sizeof(uint32_t));
+                    if (nullptr != m_sharedMemory) {
+                        // Provide size information at the beginning of the shared memory.
+                        *(uint32_t *)m_sharedMemory  = m_size;
+                        m_userAccessibleSharedMemory = m_sharedMemory + sizeof(uint32_t);
+                    } else {
+                        std::cerr << "[cluon::SharedMemory] Failed to map shared memory '" << m_name << "': "
+                                  << " (" << GetLastError() << ")" << std::endl;
+                        CloseHandle(__sharedMemory);
+                        __sharedMemory = nullptr;
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)id;
-    (void)typeName;
+                        CloseHandle(__conditionEvent);
+                        __conditionEvent = nullptr;
 
-    encode(m_buffer, name);
-    const uint8_t t = static_cast<uint8_t>(MsgPackConstants::DOUBLE);
-    m_buffer.write(reinterpret_cast<const char *>(&t), sizeof(uint8_t));
-    uint64_t _v{0};
-    std::memmove(&_v, &v, sizeof(double));
-    _v = htobe64(_v);
-    m_buffer.write(reinterpret_cast<const char *>(&_v), sizeof(double));
-    m_numberOfFields++;
-}
+                        CloseHandle(__mutex);
+                        __mutex = nullptr;
+                    }
+                } else {
+                    std::cerr << "[cluon::SharedMemory] Failed to request shared memory '" << m_name << "': "
+                              << " (" << GetLastError() << ")" << std::endl;
+                    CloseHandle(__conditionEvent);
+                    __conditionEvent = nullptr;
 
-inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)id;
-    (void)typeName;
+                    CloseHandle(__mutex);
+                    __mutex = nullptr;
+                }
+            } else {
+                std::cerr << "[cluon::SharedMemory] Failed to request event '" << conditionEventName << "': "
+                          << " (" << GetLastError() << ")" << std::endl;
+                CloseHandle(__conditionEvent);
+                __conditionEvent = nullptr;
 
-    encode(m_buffer, name);
-    encode(m_buffer, v);
-    m_numberOfFields++;
-}
+                CloseHandle(__mutex);
+                __mutex = nullptr;
+            }
+        } else {
+            std::cerr << "[cluon::SharedMemory] Failed to create mutex '" << mutexName << "': "
+                      << " (" << GetLastError() << ")" << std::endl;
+            CloseHandle(__mutex);
+            __mutex = nullptr;
+        }
+    } else {
+        // Open a shared memory area and semaphores.
+        m_hasOnlyAttachedToSharedMemory = true;
+        const BOOL INHERIT_HANDLE       = FALSE;
+        __mutex                         = OpenSemaphore(SEMAPHORE_ALL_ACCESS, INHERIT_HANDLE, mutexName.c_str());
+        if (nullptr != __mutex) {
+            __conditionEvent = OpenEvent(EVENT_ALL_ACCESS, FALSE /*do not inherit the name*/, conditionEventName.c_str());
+            if (nullptr != __conditionEvent) {
+                __sharedMemory = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE /*do not inherit the name*/, m_name.c_str());
+                if (nullptr != __sharedMemory) {
+                    // Firstly, map only for the size of a uint32_t to read the entire size.
+                    m_sharedMemory = (char *)MapViewOfFile(__sharedMemory, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(uint32_t));
+                    if (nullptr != m_sharedMemory) {
+                        //  Now, read the real size...
+                        m_size = *(uint32_t *)m_sharedMemory;
+                        // ..unmap and re-map.
+                        UnmapViewOfFile(m_sharedMemory);
+                        m_sharedMemory = (char *)MapViewOfFile(__sharedMemory, FILE_MAP_ALL_ACCESS, 0, 0, m_size + sizeof(uint32_t));
+                        if (nullptr != m_sharedMemory) {
+                            m_userAccessibleSharedMemory = m_sharedMemory + sizeof(uint32_t);
+                        } else {
+                            std::cerr << "[cluon::SharedMemory] Failed to finally map shared memory '" << m_name << "': "
+                                      << " (" << GetLastError() << ")" << std::endl;
+                            CloseHandle(__sharedMemory);
+                            __sharedMemory = nullptr;
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+                            CloseHandle(__conditionEvent);
+                            __conditionEvent = nullptr;
 
-//#include "cluon/OD4Session.hpp"
-//#include "cluon/Envelope.hpp"
-//#include "cluon/FromProtoVisitor.hpp"
-//#include "cluon/TerminateHandler.hpp"
-//#include "cluon/Time.hpp"
+                            CloseHandle(__mutex);
+                            __mutex = nullptr;
+                        }
+                    } else {
+                        std::cerr << "[cluon::SharedMemory] Failed to temporarily map shared memory '" << m_name << "': "
+                                  << " (" << GetLastError() << ")" << std::endl;
+                        CloseHandle(__sharedMemory);
+                        __sharedMemory = nullptr;
 
-#include <iostream>
-#include <sstream>
-#include <thread>
+                        CloseHandle(__conditionEvent);
+                        __conditionEvent = nullptr;
+
+                        CloseHandle(__mutex);
+                        __mutex = nullptr;
+                    }
+                } else {
+                    std::cerr << "[cluon::SharedMemory] Failed to open shared memory '" << m_name << "': "
+                              << " (" << GetLastError() << ")" << std::endl;
+                    CloseHandle(__conditionEvent);
+                    __conditionEvent = nullptr;
 
-namespace cluon {
+                    CloseHandle(__mutex);
+                    __mutex = nullptr;
+                }
+            } else {
+                std::cerr << "[cluon::SharedMemory] Failed to open event '" << conditionEventName << "': "
+                          << " (" << GetLastError() << ")" << std::endl;
+                CloseHandle(__conditionEvent);
+                __conditionEvent = nullptr;
 
-inline OD4Session::OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept
-    : m_receiver{nullptr}
-    , m_sender{"225.0.0." + std::to_string(CID), 12175}
-    , m_delegate(std::move(delegate))
-    , m_mapOfDataTriggeredDelegatesMutex{}
-    , m_mapOfDataTriggeredDelegates{} {
-    m_receiver = std::make_unique<cluon::UDPReceiver>(
-        "225.0.0." + std::to_string(CID),
-        12175,
-        [this](std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) {
-            this->callback(std::move(data), std::move(from), std::move(timepoint));
-        },
-        m_sender.getSendFromPort() /* passing our local send from port to the UDPReceiver to filter out our own bytes */);
+                CloseHandle(__mutex);
+                __mutex = nullptr;
+            }
+        } else {
+            std::cerr << "[cluon::SharedMemory] Failed to open mutex '" << mutexName << "': "
+                      << " (" << GetLastError() << ")" << std::endl;
+            CloseHandle(__mutex);
+            __mutex = nullptr;
+        }
+    }
 }
 
-inline void OD4Session::timeTrigger(float freq, std::function<bool()> delegate) noexcept {
-    if (nullptr != delegate) {
-        bool delegateIsRunning{true};
-        const int64_t TIME_SLICE_IN_MILLISECONDS{static_cast<uint32_t>(1000 / ((freq > 0) ? freq : 1.0f))};
-        do {
-            cluon::data::TimeStamp before{cluon::time::now()};
-            try {
-                delegateIsRunning = delegate();
-            } catch (...) {
-                delegateIsRunning = false; // delegate threw exception.
-            }
-            cluon::data::TimeStamp after{cluon::time::now()};
+inline void SharedMemory::deinitWIN32() noexcept {
+    if (nullptr != __conditionEvent) {
+        SetEvent(__conditionEvent);
+        CloseHandle(__conditionEvent);
+    }
+    if (nullptr != __mutex) {
+        unlock();
+        CloseHandle(__mutex);
+    }
+    if (nullptr != m_sharedMemory) {
+        UnmapViewOfFile(m_sharedMemory);
+    }
+    if (nullptr != __sharedMemory) {
+        CloseHandle(__sharedMemory);
+    }
+}
 
-            const int64_t beforeInMicroseconds{cluon::time::toMicroseconds(before)};
-            const int64_t afterInMicroseconds{cluon::time::toMicroseconds(after)};
+inline void SharedMemory::lockWIN32() noexcept {
+    if (nullptr != __mutex) {
+        if (0 != WaitForSingleObject(__mutex, INFINITE)) {
+            m_broken.store(true);
+        }
+    }
+}
 
-            const int64_t timeSpent{(afterInMicroseconds > beforeInMicroseconds) ? (afterInMicroseconds - beforeInMicroseconds) / 1000 : 0};
-            const int64_t timeToSleepInMilliseconds{TIME_SLICE_IN_MILLISECONDS - timeSpent};
+inline void SharedMemory::unlockWIN32() noexcept {
+    if (nullptr != __mutex) {
+        const LONG RELEASE_COUNT = 1;
+        if (/* Testing for equality with 0 is correct according to MSDN reference. */ 0 == ReleaseSemaphore(__mutex, RELEASE_COUNT, 0)) {
+            m_broken.store(true);
+        }
+    }
+}
 
-            // Sleep the remaining time.
-            if ((timeToSleepInMilliseconds > 0) && (timeToSleepInMilliseconds <= TIME_SLICE_IN_MILLISECONDS)) {
-                std::this_thread::sleep_for(std::chrono::duration<int64_t, std::milli>(timeToSleepInMilliseconds));
-            } else {
-                std::cerr << "[cluon::OD4Session]: time-triggered delegate violated allocated time slice." << std::endl;
-            }
-        } while (delegateIsRunning && !TerminateHandler::instance().isTerminated.load());
+inline void SharedMemory::waitWIN32() noexcept {
+    if (nullptr != __conditionEvent) {
+        if (0 != WaitForSingleObject(__conditionEvent, INFINITE)) {
+            m_broken.store(true);
+        }
     }
 }
 
-inline bool OD4Session::dataTrigger(int32_t messageIdentifier, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept {
-    bool retVal{false};
-    if (nullptr == m_delegate) {
-        try {
-            std::lock_guard<std::mutex> lck{m_mapOfDataTriggeredDelegatesMutex};
-            if ((nullptr == delegate) && (m_mapOfDataTriggeredDelegates.count(messageIdentifier) > 0)) {
-                auto element = m_mapOfDataTriggeredDelegates.find(messageIdentifier);
-                if (element != m_mapOfDataTriggeredDelegates.end()) {
-                    m_mapOfDataTriggeredDelegates.erase(element);
-                }
-            } else {
-                m_mapOfDataTriggeredDelegates[messageIdentifier] = delegate;
-            }
-            retVal = true;
-        } catch (...) {} // LCOV_EXCL_LINE
+inline void SharedMemory::notifyAllWIN32() noexcept {
+    if (nullptr != __conditionEvent) {
+        if (/* Testing for equality with 0 is correct according to MSDN reference. */ 0 == SetEvent(__conditionEvent)) {
+            m_broken.store(true);
+        }
+        if (/* Testing for equality with 0 is correct according to MSDN reference. */ 0 == ResetEvent(__conditionEvent)) {
+            m_broken.store(true);
+        }
     }
-    return retVal;
 }
 
-inline void OD4Session::callback(std::string &&data, std::string && /*from*/, std::chrono::system_clock::time_point &&timepoint) noexcept {
-    size_t numberOfDataTriggeredDelegates{0};
-    {
-        try {
-            std::lock_guard<std::mutex> lck{m_mapOfDataTriggeredDelegatesMutex};
-            numberOfDataTriggeredDelegates = m_mapOfDataTriggeredDelegates.size();
-        } catch (...) {} // LCOV_EXCL_LINE
+#else /* POSIX and SysV */
+
+inline void SharedMemory::initPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    // If size is greater than 0, the caller wants to create a new shared
+    // memory area. Otherwise, the caller wants to open an existing shared memory.
+    int flags = O_RDWR;
+    if (0 < m_size) {
+        flags |= O_CREAT | O_EXCL;
     }
-    // Only unpack the envelope when it needs to be post-processed.
-    if ((nullptr != m_delegate) || (0 < numberOfDataTriggeredDelegates)) {
-        std::stringstream sstr(data);
-        auto retVal = extractEnvelope(sstr);
 
-        if (retVal.first) {
-            cluon::data::Envelope env{retVal.second};
-            env.received(cluon::time::convert(timepoint));
+    m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
+    if (-1 == m_fd) {
+// clang-format off
+        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to open shared memory '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+// clang-format on
+        // Try to remove existing shared memory segment and try again.
+        if ((flags & O_CREAT) == O_CREAT) {
+            std::clog << "[cluon::SharedMemory (POSIX)] Trying to remove existing shared memory '" << m_name << "' and trying again... ";
+            if (0 == ::shm_unlink(m_name.c_str())) {
+                m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
+            }
 
-            // "Catch all"-delegate.
-            if (nullptr != m_delegate) {
-                m_delegate(std::move(env));
+            if (-1 == m_fd) {
+                std::cerr << "failed: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
             } else {
-                try {
-                    // Data triggered-delegates.
-                    std::lock_guard<std::mutex> lck{m_mapOfDataTriggeredDelegatesMutex};
-                    if (m_mapOfDataTriggeredDelegates.count(env.dataType()) > 0) {
-                        m_mapOfDataTriggeredDelegates[env.dataType()](std::move(env));
-                    }
-                } catch (...) {} // LCOV_EXCL_LINE
+                std::cerr << "succeeded." << std::endl;
             }
         }
     }
-}
 
-inline void OD4Session::send(cluon::data::Envelope &&envelope) noexcept {
-    sendInternal(cluon::serializeEnvelope(std::move(envelope)));
-}
+    if (-1 != m_fd) {
+        bool retVal{true};
 
-inline void OD4Session::sendInternal(std::string &&dataToSend) noexcept {
-    m_sender.send(std::move(dataToSend));
-}
+        // When creating a shared memory segment, truncate it.
+        if (0 < m_size) {
+            retVal = (0 == ::ftruncate(m_fd, static_cast<off_t>(sizeof(SharedMemoryHeader) + m_size)));
+            if (!retVal) {
+// clang-format off // LCOV_EXCL_LINE
+                std::cerr << "[cluon::SharedMemory (POSIX)] Failed to truncate '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+            }
+        }
 
-inline bool OD4Session::isRunning() noexcept {
-    return m_receiver->isRunning();
-}
+        // Accessing shared memory segment.
+        if (retVal) {
+            // On opening (i.e., NOT creating) a shared memory segment, m_size is still 0 and we need to figure out the size first.
+            m_sharedMemory = static_cast<char *>(::mmap(0, sizeof(SharedMemoryHeader) + m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
+            if (MAP_FAILED != m_sharedMemory) {
+                m_sharedMemoryHeader = reinterpret_cast<SharedMemoryHeader *>(m_sharedMemory);
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+                // On creating (i.e., NOT opening) a shared memory segment, setup the shared memory header.
+                if (0 < m_size) {
+                    // Store user accessible size in shared memory.
+                    m_sharedMemoryHeader->__size = m_size;
 
-//#include "cluon/ToODVDVisitor.hpp"
+                    // Create process-shared mutex (fastest approach, cf. Stevens & Rago: "Advanced Programming in the UNIX (R) Environment").
+                    pthread_mutexattr_t mutexAttribute;
+                    ::pthread_mutexattr_init(&mutexAttribute);
+                    ::pthread_mutexattr_setpshared(&mutexAttribute, PTHREAD_PROCESS_SHARED); // Share between unrelated processes.
+#ifndef __APPLE__
+                    ::pthread_mutexattr_setrobust(&mutexAttribute, PTHREAD_MUTEX_ROBUST);    // Allow continuation of other processes waiting for this mutex
+                                                                                             // when the currently holding process unexpectedly terminates.
+#endif
+                    ::pthread_mutexattr_settype(&mutexAttribute, PTHREAD_MUTEX_NORMAL);      // Using regular mutex with deadlock behavior.
+                    ::pthread_mutex_init(&(m_sharedMemoryHeader->__mutex), &mutexAttribute);
+                    ::pthread_mutexattr_destroy(&mutexAttribute);
 
-#include <sstream>
+                    // Create shared condition.
+                    pthread_condattr_t conditionAttribute;
+                    ::pthread_condattr_init(&conditionAttribute);
+#ifndef __APPLE__
+                    ::pthread_condattr_setclock(&conditionAttribute, CLOCK_MONOTONIC);          // Use realtime clock for timed waits with non-negative jumps.
+#endif
+                    ::pthread_condattr_setpshared(&conditionAttribute, PTHREAD_PROCESS_SHARED); // Share between unrelated processes.
+                    ::pthread_cond_init(&(m_sharedMemoryHeader->__condition), &conditionAttribute);
+                    ::pthread_condattr_destroy(&conditionAttribute);
+                } else {
+                    // Indicate that this instance is attaching to an existing shared memory segment.
+                    m_hasOnlyAttachedToSharedMemory = true;
 
-namespace cluon {
+                    // Read size as we are attaching to an existing shared memory.
+                    m_size = m_sharedMemoryHeader->__size;
 
-inline std::string ToODVDVisitor::messageSpecification() const noexcept {
-    std::stringstream tmp;
-    for (const auto &e : m_forwardDeclarations) { tmp << e; }
-    tmp << m_buffer.str();
+                    // Now, as we know the real size, unmap the first mapping that did not know the size.
+                    if (::munmap(m_sharedMemory, sizeof(SharedMemoryHeader))) {
+// clang-format off // LCOV_EXCL_LINE
+                        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                    }
 
-    const std::string retVal{tmp.str()};
-    return retVal;
-}
+                    // Invalidate all pointers.
+                    m_sharedMemory = nullptr;
+                    m_sharedMemoryHeader = nullptr;
 
-inline void ToODVDVisitor::preVisit(int32_t id, const std::string &shortName, const std::string &longName) noexcept {
-    (void)shortName;
-    m_buffer << "message " << longName << " [ id = " << id << " ] {" << '\n';
+                    // Re-map with the correct size parameter.
+                    m_sharedMemory = static_cast<char *>(::mmap(0, sizeof(SharedMemoryHeader) + m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
+                    if (MAP_FAILED != m_sharedMemory) {
+                        m_sharedMemoryHeader = reinterpret_cast<SharedMemoryHeader *>(m_sharedMemory);
+                    }
+                }
+            } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                std::cerr << "[cluon::SharedMemory (POSIX)] Failed to map '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+            }
+
+            // If the shared memory segment is correctly available, store the pointer for the user data.
+            if (MAP_FAILED != m_sharedMemory) {
+                m_userAccessibleSharedMemory = m_sharedMemory + sizeof(SharedMemoryHeader);
+
+                // Lock the shared memory into RAM for performance reasons.
+                if (-1 == ::mlock(m_sharedMemory, sizeof(SharedMemoryHeader) + m_size)) {
+                    std::cerr << "[cluon::SharedMemory (POSIX)] Failed to mlock shared memory: " // LCOV_EXCL_LINE
+                              << ::strerror(errno) << " (" << errno << ")" << std::endl;         // LCOV_EXCL_LINE
+                }
+            }
+        } else { // LCOV_EXCL_LINE
+            if (-1 != m_fd) { // LCOV_EXCL_LINE
+                if (-1 == ::shm_unlink(m_name.c_str())) { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                    std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unlink shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                }
+            }
+            m_fd = -1; // LCOV_EXCL_LINE
+        }
+    }
+#endif
+
+#ifdef __linux__
+    // On Linux, the POSIX shared memory lives in /dev/shm and we have a valid
+    // file descriptor to use for timestamping.
+    if (-1 != m_fd) {
+        m_fdForTimeStamping = m_fd;
+    }
+#else
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    // On *BSDs, the POSIX shared memory lives not in /dev/shm and we have
+    // need to use a separate file for timestamping.
+    if (-1 != m_fd) {
+        m_fdForTimeStamping = ::open(m_nameForTimeStamping.c_str(), O_CREAT|O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+    }
+#endif
+#endif
 }
 
-inline void ToODVDVisitor::postVisit() noexcept {
-    m_buffer << '}' << '\n';
-}
+inline void SharedMemory::deinitPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    if ((nullptr != m_sharedMemoryHeader) && (!m_hasOnlyAttachedToSharedMemory)) {
+        // Wake any waiting threads as we are going to end the shared memory session.
+        ::pthread_cond_broadcast(&(m_sharedMemoryHeader->__condition));
+        ::pthread_cond_destroy(&(m_sharedMemoryHeader->__condition));
+        ::pthread_mutex_destroy(&(m_sharedMemoryHeader->__mutex));
+    }
+    if ((nullptr != m_sharedMemory) && ::munmap(m_sharedMemory, sizeof(SharedMemoryHeader) + m_size)) {
+// clang-format off // LCOV_EXCL_LINE
+        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+    }
+    if (!m_hasOnlyAttachedToSharedMemory && (-1 != m_fd) && (-1 == ::shm_unlink(m_name.c_str()) && (ENOENT != errno))) {
+// clang-format off // LCOV_EXCL_LINE
+        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unlink shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+    }
+#endif
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, bool &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "bool"
-             << " " << name << " [ default = false, id = " << id << " ];" << '\n';
+#ifndef __linux__
+    // On *BSDs, the POSIX shared memory lives not in /dev/shm and we have
+    // used a separate file for timestamping.
+    if (-1 != m_fdForTimeStamping) {
+        ::close(m_fdForTimeStamping);
+        ::unlink(m_nameForTimeStamping.c_str());
+    }
+#endif
 }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, char &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "char"
-             << " " << name << " [ default = '0', id = " << id << " ];" << '\n';
+inline void SharedMemory::lockPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    if (nullptr != m_sharedMemoryHeader) {
+        auto retVal = ::pthread_mutex_lock(&(m_sharedMemoryHeader->__mutex));
+        if (EOWNERDEAD == retVal) {
+// clang-format off // LCOV_EXCL_LINE
+            std::cerr << "[cluon::SharedMemory (POSIX)] pthread_mutex_lock returned for EOWNERDEAD for mutex in shared memory '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+        } else if (0 != retVal) {
+            m_broken.store(true); // LCOV_EXCL_LINE
+        }
+    }
+#endif
 }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int8_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "int8"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
+inline void SharedMemory::unlockPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    if (nullptr != m_sharedMemoryHeader) {
+        if (0 != ::pthread_mutex_unlock(&(m_sharedMemoryHeader->__mutex))) {
+            m_broken.store(true); // LCOV_EXCL_LINE
+        }
+    }
+#endif
 }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint8_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "uint8"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
+inline void SharedMemory::waitPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    if (nullptr != m_sharedMemoryHeader) {
+        lock();
+        if (0 != ::pthread_cond_wait(&(m_sharedMemoryHeader->__condition), &(m_sharedMemoryHeader->__mutex))) {
+            m_broken.store(true); // LCOV_EXCL_LINE
+        }
+        unlock();
+    }
+#endif
 }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int16_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "int16"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
+inline void SharedMemory::notifyAllPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    if (nullptr != m_sharedMemoryHeader) {
+        if (0 != ::pthread_cond_broadcast(&(m_sharedMemoryHeader->__condition))) {
+            m_broken.store(true); // LCOV_EXCL_LINE
+        }
+    }
+#endif
 }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint16_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "uint16"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
+inline bool SharedMemory::validPOSIX() noexcept {
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    return (-1 != m_fd) && (MAP_FAILED != m_sharedMemory);
+#else
+    return false;
+#endif
 }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int32_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "int32"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
-}
+////////////////////////////////////////////////////////////////////////////////
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint32_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "uint32"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
-}
+inline void SharedMemory::initSysV() noexcept {
+    // If size is greater than 0, the caller wants to create a new shared
+    // memory area. Otherwise, the caller wants to open an existing shared memory.
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, int64_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "int64"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
-}
+    // Create a key to identify the shared memory area.
+    constexpr int32_t ID_SHM = 1;
+    constexpr int32_t ID_SEM_AS_MUTEX = 2;
+    constexpr int32_t ID_SEM_AS_CONDITION = 3;
+    bool tokenFileExisting{false};
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, uint64_t &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "uint64"
-             << " " << name << " [ default = 0, id = " << id << " ];" << '\n';
-}
+    if (0 < m_size) {
+        // The file should not exist; otherwise, we need to clear an existing
+        // set of semaphores and shared memory areas.
+        std::fstream tokenFile(m_name.c_str(), std::ios::in);
+        if (tokenFile.good()) {
+            // Existing tokenFile found. Cleaning up will be tried in the code below.
+        }
+        tokenFile.close();
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, float &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "float"
-             << " " << name << " [ default = 0.0, id = " << id << " ];" << '\n';
-}
+        tokenFile.open(m_name.c_str(), std::ios::out);
+        tokenFileExisting = tokenFile.good();
+        if (!tokenFileExisting) {
+            std::cerr << "[cluon::SharedMemory (SysV)] Token file '" << m_name << "' could not be created; shared memory cannot be created." << std::endl;
+        }
+        tokenFile.close();
+    } else {
+        // Open an existing shared memory area indicated by an existing token file.
+        m_hasOnlyAttachedToSharedMemory = true;
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, double &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "double"
-             << " " << name << " [ default = 0.0, id = " << id << " ];" << '\n';
-}
+        std::fstream tokenFile(m_name.c_str(), std::ios::in);
+        tokenFileExisting = tokenFile.good();
+        if (!tokenFileExisting) {
+            std::cerr << "[cluon::SharedMemory (SysV)] Token file '" << m_name << "' not found; shared memory cannot be created." << std::endl;
+        }
+        tokenFile.close();
+    }
 
-inline void ToODVDVisitor::visit(uint32_t id, std::string &&typeName, std::string &&name, std::string &v) noexcept {
-    (void)typeName;
-    (void)v;
-    m_buffer << "    "
-             << "string"
-             << " " << name << " [ default = \"\", id = " << id << " ];" << '\n';
-}
+    // We have a token file to be used for the keys.
+    if (tokenFileExisting) {
+        m_shmKeySysV = ::ftok(m_name.c_str(), ID_SHM);
+        if (-1 == m_shmKeySysV) {
+// clang-format off // LCOV_EXCL_LINE
+            std::cerr << "[cluon::SharedMemory (SysV)] Key for shared memory could not be created: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+        } else {
+            if (!m_hasOnlyAttachedToSharedMemory) {
+                // The caller wants to create a shared memory segment.
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
+                // First, try to clean up an orphaned shared memory segment.
+                // Therefore, we try to open the shared memory area without the
+                // IPC_CREAT flag. On a clean environment, this call must fail
+                // as there should not be any shared memory segments left.
+                {
+                    int orphanedSharedMemoryIDSysV = ::shmget(m_shmKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                    if (!(orphanedSharedMemoryIDSysV < 0)) {
+                        if (::shmctl(orphanedSharedMemoryIDSysV, IPC_RMID, 0)) {
+// clang-format off // LCOV_EXCL_LINE
+                            std::cerr << "[cluon::SharedMemory (SysV)] Existing shared memory (0x" << std::hex << m_shmKeySysV << std::dec << ") found; removing failed." << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                        }
+                    }
+                }
 
-//#include "cluon/EnvelopeConverter.hpp"
-//#include "cluon/Envelope.hpp"
-//#include "cluon/FromJSONVisitor.hpp"
-//#include "cluon/FromProtoVisitor.hpp"
-//#include "cluon/GenericMessage.hpp"
-//#include "cluon/MessageParser.hpp"
-//#include "cluon/Time.hpp"
-//#include "cluon/ToJSONVisitor.hpp"
-//#include "cluon/ToProtoVisitor.hpp"
-//#include "cluon/any/any.hpp"
+                // Now, create the shared memory segment.
+                m_sharedMemoryIDSysV = ::shmget(m_shmKeySysV, m_size, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                if (-1 != m_sharedMemoryIDSysV) {
+                    m_sharedMemory = reinterpret_cast<char *>(::shmat(m_sharedMemoryIDSysV, nullptr, 0));
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+                    if ((void *)-1 != m_sharedMemory) {
+                        m_userAccessibleSharedMemory = m_sharedMemory;
+                    } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                        std::cerr << "[cluon::SharedMemory (SysV)] Failed to attach to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                    }
+#pragma GCC diagnostic pop
+                } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                }
+            } else {
+                // The caller wants to attach to an existing shared memory segment.
+                m_sharedMemoryIDSysV = ::shmget(m_shmKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                if (-1 != m_sharedMemoryIDSysV) {
+                    struct shmid_ds info;
+                    if (-1 != ::shmctl(m_sharedMemoryIDSysV, IPC_STAT, &info)) {
+                        m_size = static_cast<uint32_t>(info.shm_segsz);
+                        m_sharedMemory = reinterpret_cast<char *>(::shmat(m_sharedMemoryIDSysV, nullptr, 0));
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+                        if ((void *)-1 != m_sharedMemory) {
+                            m_userAccessibleSharedMemory = m_sharedMemory;
+                        } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                            std::cerr << "[cluon::SharedMemory (SysV)] Failed to attach to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                        }
+#pragma GCC diagnostic pop
+                    } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                        std::cerr << "[cluon::SharedMemory (SysV)] Could not read information about shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                    }
+                } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                }
+            }
+        }
 
-#include <algorithm>
-#include <sstream>
-#include <utility>
+        // Next, create the mutex (but only if the shared memory was acquired correctly.
+        m_mutexKeySysV = ::ftok(m_name.c_str(), ID_SEM_AS_MUTEX);
+        if (-1 == m_mutexKeySysV) {
+// clang-format off // LCOV_EXCL_LINE
+            std::cerr << "[cluon::SharedMemory (SysV)] Key for mutex could not be created: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+        }
+        if ((-1 != m_shmKeySysV) && (-1 != m_mutexKeySysV) && (nullptr != m_userAccessibleSharedMemory)) {
+            if (!m_hasOnlyAttachedToSharedMemory) {
+                // The caller has created the shared memory segment and thus,
+                // we need the corresponding mutex.
 
-namespace cluon {
+                // First, try to remove the orphaned one.
+                {
+                    int orphanedMutexIDSysV = ::semget(m_mutexKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                    if (!(orphanedMutexIDSysV < 0)) {
+                        if (::semctl(orphanedMutexIDSysV, 0, IPC_RMID)) {
+// clang-format off // LCOV_EXCL_LINE
+                            std::cerr << "[cluon::SharedMemory (SysV)] Existing semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex) found; removing failed." << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                        }
+                    }
+                }
 
-inline int32_t EnvelopeConverter::setMessageSpecification(const std::string &ms) noexcept {
-    int32_t retVal{-1};
+                // Next, create the correct semaphore used as mutex.
+                {
+                    constexpr int NSEMS{1};
+                    m_mutexIDSysV = ::semget(m_mutexKeySysV, NSEMS, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                    if (-1 != m_mutexIDSysV) {
+                        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+                        constexpr int INITIAL_VALUE{1};
+                        union semun tmp;
+                        tmp.val = INITIAL_VALUE;
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wclass-varargs"
+#endif
+                        if (-1 == ::semctl(m_mutexIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
+// clang-format off // LCOV_EXCL_LINE
+                            std::cerr << "[cluon::SharedMemory (SysV)] Failed to initialize semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                        }
+#pragma GCC diagnostic pop
+                    } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                        std::cerr << "[cluon::SharedMemory (SysV)] Failed to create semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                    }
+                }
+            } else {
+                m_mutexIDSysV = ::semget(m_mutexKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                if (-1 == m_mutexIDSysV) {
+// clang-format off // LCOV_EXCL_LINE
+                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                }
+            }
+        }
 
-    m_listOfMetaMessages.clear();
-    m_scopeOfMetaMessages.clear();
+        // Next, create the condition variable (but only if the shared memory was acquired correctly.
+        m_conditionKeySysV = ::ftok(m_name.c_str(), ID_SEM_AS_CONDITION);
+        if (-1 == m_conditionKeySysV) {
+// clang-format off // LCOV_EXCL_LINE
+            std::cerr << "[cluon::SharedMemory (SysV)] Key for condition could not be created: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+        }
+        if ((-1 != m_shmKeySysV) && (-1 != m_mutexKeySysV) && (-1 != m_conditionKeySysV) && (nullptr != m_userAccessibleSharedMemory)) {
+            if (!m_hasOnlyAttachedToSharedMemory) {
+                // The caller has created the shared memory segment and thus,
+                // we need the corresponding condition variable.
 
-    cluon::MessageParser mp;
-    auto parsingResult = mp.parse(ms);
-    if (cluon::MessageParser::MessageParserErrorCodes::NO_MESSAGEPARSER_ERROR == parsingResult.second) {
-        m_listOfMetaMessages = parsingResult.first;
-        for (const auto &mm : m_listOfMetaMessages) { m_scopeOfMetaMessages[mm.messageIdentifier()] = mm; }
-        retVal = static_cast<int32_t>(m_listOfMetaMessages.size());
-    }
-    return retVal;
-}
+                // First, try to remove the orphaned one.
+                {
+                    int orphanedConditionIDSysV = ::semget(m_conditionKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                    if (!(orphanedConditionIDSysV < 0)) {
+                        if (::semctl(orphanedConditionIDSysV, 0, IPC_RMID)) {
+// clang-format off // LCOV_EXCL_LINE
+                            std::cerr << "[cluon::SharedMemory (SysV)] Existing semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable) found; removing failed." << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                        }
+                    }
+                }
 
-inline std::string EnvelopeConverter::getJSONFromProtoEncodedEnvelope(const std::string &protoEncodedEnvelope) noexcept {
-    std::string retVal{"{}"};
-    if (!m_listOfMetaMessages.empty()) {
-        cluon::data::Envelope envelope;
-        std::stringstream sstr(protoEncodedEnvelope);
-        constexpr uint8_t OD4_HEADER_SIZE{5};
-        if (OD4_HEADER_SIZE < protoEncodedEnvelope.size()) {
-            // Try decoding complete OD4-encoded Envelope including header.
-            constexpr uint8_t byte0{0x0D};
-            constexpr uint8_t byte1{0xA4};
-            if ((static_cast<uint8_t>(protoEncodedEnvelope.at(0)) == byte0) && (static_cast<uint8_t>(protoEncodedEnvelope.at(1)) == byte1)) {
-                uint32_t length = (*reinterpret_cast<const uint32_t *>(protoEncodedEnvelope.data() + 1));
-                length          = le32toh(length) >> 8;
-                if ((OD4_HEADER_SIZE + length) == protoEncodedEnvelope.size()) {
-                    auto result{extractEnvelope(sstr)};
-                    if (result.first) {
-                        envelope = result.second;
+                // Next, create the correct semaphore used as condition variable.
+                {
+                    constexpr int NSEMS{1};
+                    m_conditionIDSysV = ::semget(m_conditionKeySysV, NSEMS, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                    if (-1 != m_conditionIDSysV) {
+                        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+                        constexpr int INITIAL_VALUE{1};
+                        union semun tmp;
+                        tmp.val = INITIAL_VALUE;
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wclass-varargs"
+#endif
+                        if (-1 == ::semctl(m_conditionIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
+// clang-format off // LCOV_EXCL_LINE
+                            std::cerr << "[cluon::SharedMemory (SysV)] Failed to initialize semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                        }
+#pragma GCC diagnostic pop
+                    } else { // LCOV_EXCL_LINE
+// clang-format off // LCOV_EXCL_LINE
+                        std::cerr << "[cluon::SharedMemory (SysV)] Failed to create semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
                     }
                 }
+            } else {
+                m_conditionIDSysV = ::semget(m_conditionKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                if (-1 == m_conditionIDSysV) {
+// clang-format off // LCOV_EXCL_LINE
+                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+                }
             }
         }
+    }
 
-        if (0 == envelope.dataType()) {
-            // Directly decoding complete OD4 container failed, try decoding without header.
-            cluon::FromProtoVisitor protoDecoder;
-            protoDecoder.decodeFrom(sstr, envelope);
-        }
-
-        retVal = getJSONFromEnvelope(envelope);
+    // If the shared memory is present, open the token file for the time stamping.
+    if (nullptr != m_sharedMemory) {
+        m_fdForTimeStamping = ::open(m_name.c_str(), O_RDONLY);
     }
-    return retVal;
 }
 
-inline std::string EnvelopeConverter::getJSONFromEnvelope(cluon::data::Envelope &envelope) noexcept {
-    std::string retVal{"{}"};
-    if (!m_listOfMetaMessages.empty()) {
-        if (0 < m_scopeOfMetaMessages.count(envelope.dataType())) {
-            // First, create JSON from Envelope.
-            constexpr bool OUTER_CURLY_BRACES{false};
-            // Ignore field 2 (= serializedData) as it will be replaced below.
-            const std::map<uint32_t, bool> mask{{2, false}};
-            ToJSONVisitor envelopeToJSON{OUTER_CURLY_BRACES, mask};
-            envelope.accept(envelopeToJSON);
-
-            std::stringstream sstr{envelope.serializedData()};
-            cluon::FromProtoVisitor protoDecoder;
-            protoDecoder.decodeFrom(sstr);
-
-            // Now, create JSON from payload.
-            cluon::MetaMessage payload{m_scopeOfMetaMessages[envelope.dataType()]};
-            cluon::GenericMessage gm;
-
-            // Create "empty" GenericMessage from this MetaMessage.
-            gm.createFrom(payload, m_listOfMetaMessages);
+inline void SharedMemory::deinitSysV() noexcept {
+    if (nullptr != m_sharedMemory) {
+        // Close token file.
+        ::close(m_fdForTimeStamping);
+        m_fdForTimeStamping = -1;
 
-            // Set values in the newly created GenericMessage from ProtoDecoder.
-            gm.accept(protoDecoder);
+        if (-1 == ::shmdt(m_sharedMemory)) {
+// clang-format off // LCOV_EXCL_LINE
+            std::cerr << "[cluon::SharedMemory (SysV)] Could not detach shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+// clang-format on // LCOV_EXCL_LINE
+        }
+    }
 
-            ToJSONVisitor payloadToJSON{OUTER_CURLY_BRACES};
-            try {
-                // Catch possible linb::any exception.
-                gm.accept(payloadToJSON);
-            } catch (const linb::bad_any_cast &) {} // LCOV_EXCL_LINE
+    if (!m_hasOnlyAttachedToSharedMemory) {
+        notifyAllSysV();
 
-            std::string tmp{payload.messageName()};
-            std::replace(tmp.begin(), tmp.end(), '.', '_');
+        if (-1 != m_conditionIDSysV) {
+            if (-1 == ::semctl(m_conditionIDSysV, 0, IPC_RMID)) {
+                std::cerr << "[cluon::SharedMemory (SysV)] Semaphore (0x" << std::hex << m_conditionKeySysV << std::dec
+                          << ") used as condition could not be removed: " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+            }
+        }
 
-            const std::string strPayloadJSON{payloadToJSON.json() != "{}" ? payloadToJSON.json() : ""};
+        if (-1 != m_mutexIDSysV) {
+            if (-1 == ::semctl(m_mutexIDSysV, 0, IPC_RMID)) {
+                std::cerr << "[cluon::SharedMemory (SysV)] Semaphore (0x" << std::hex << m_mutexKeySysV << std::dec
+                          << ") used as mutex could not be removed: " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+            }
+        }
+        if (-1 != m_sharedMemoryIDSysV) {
+            if (-1 == ::shmctl(m_sharedMemoryIDSysV, IPC_RMID, 0)) {
+                std::cerr << "[cluon::SharedMemory (SysV)] Shared memory (0x" << std::hex << m_shmKeySysV << std::dec
+                          << ") could not be removed: " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+            }
+        }
 
-            retVal = '{' + envelopeToJSON.json() + ',' + '\n' + '"' + tmp + '"' + ':' + '{' + strPayloadJSON + '}' + '}';
+        if (-1 == ::unlink(m_name.c_str())) {
+            std::cerr << "[cluon::SharedMemory (SysV)] Token file '" << m_name << "' could not be removed: " << ::strerror(errno) << " (" << errno << ")"
+                      << std::endl;
         }
     }
-    return retVal;
 }
 
-// clang-format off
-inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSONWithoutTimeStamps(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept {
-    // clang-format on
-    return getProtoEncodedEnvelopeFromJSON(json, messageIdentifier, senderStamp, cluon::data::TimeStamp());
-}
+inline void SharedMemory::lockSysV() noexcept {
+    if (-1 != m_mutexIDSysV) {
+        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+        constexpr int VALUE{-1};
 
-// clang-format off
-inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept {
-    // clang-format on
-    return getProtoEncodedEnvelopeFromJSON(json, messageIdentifier, senderStamp, cluon::time::now());
+        struct sembuf tmp;
+        tmp.sem_num = NUMBER_OF_SEMAPHORE_TO_CONTROL;
+        tmp.sem_op = VALUE;
+        tmp.sem_flg = SEM_UNDO; // When the caller terminates unexpectedly, let the kernel restore the original value.
+        if (-1 == ::semop(m_mutexIDSysV, &tmp, 1)) {
+            std::cerr << "[cluon::SharedMemory (SysV)] Failed to lock semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << "): " << ::strerror(errno)
+                      << " (" << errno << ")" << std::endl;
+            m_broken.store(true);
+        }
+    }
 }
 
-// clang-format off
-inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp, cluon::data::TimeStamp sampleTimeStamp) noexcept {
-    // clang-format on
-    std::string retVal;
-    if (0 < m_scopeOfMetaMessages.count(messageIdentifier)) {
-        // Get specification for message to be created.
-        cluon::MetaMessage message{m_scopeOfMetaMessages[messageIdentifier]};
-
-        // Create "empty" instance for the required message as GenericMessage.
-        cluon::GenericMessage gm;
-        gm.createFrom(message, m_listOfMetaMessages);
-
-        // Parse data from given JSON.
-        std::stringstream sstr{json};
-        cluon::FromJSONVisitor jsonDecoder;
-        jsonDecoder.decodeFrom(sstr);
-
-        // Set values in the newly created GenericMessage from JSONDecoder.
-        gm.accept(jsonDecoder);
-
-        // Finally, transform GenericMessage into Envelope.
-        ToProtoVisitor protoEncoder;
-        gm.accept(protoEncoder);
-
-        cluon::data::Envelope env;
-        env.dataType(messageIdentifier).serializedData(protoEncoder.encodedData()).senderStamp(senderStamp).sampleTimeStamp(sampleTimeStamp);
+inline void SharedMemory::unlockSysV() noexcept {
+    if (-1 != m_mutexIDSysV) {
+        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+        constexpr int VALUE{+1};
 
-        retVal = cluon::serializeEnvelope(std::move(env));
+        struct sembuf tmp;
+        tmp.sem_num = NUMBER_OF_SEMAPHORE_TO_CONTROL;
+        tmp.sem_op = VALUE;
+        tmp.sem_flg = SEM_UNDO; // When the caller terminates unexpectedly, let the kernel restore the original value.
+        if (-1 == ::semop(m_mutexIDSysV, &tmp, 1)) {
+            std::cerr << "[cluon::SharedMemory (SysV)] Failed to unlock semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << "): " << ::strerror(errno)
+                      << " (" << errno << ")" << std::endl;
+            m_broken.store(true);
+        }
     }
-    return retVal;
 }
 
-} // namespace cluon
-/*
- * Copyright (C) 2017-2018  Christian Berger
- *
- * This Source Code Form is subject to the terms of the Mozilla Public
- * License, v. 2.0. If a copy of the MPL was not distributed with this
- * file, You can obtain one at http://mozilla.org/MPL/2.0/.
- */
-
-//#include "cluon/Player.hpp"
-//#include "cluon/Envelope.hpp"
-//#include "cluon/Time.hpp"
-
-#include <algorithm>
-#include <chrono>
-#include <cmath>
-#include <cstdio>
-#include <fstream>
-#include <iostream>
-#include <limits>
-#include <thread>
-#include <utility>
-
-namespace cluon {
+inline void SharedMemory::waitSysV() noexcept {
+    if (-1 != m_conditionIDSysV) {
+        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+        constexpr int VALUE{0}; // Wait for this semaphore to become 0.
 
-inline IndexEntry::IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition) noexcept
-    : m_sampleTimeStamp(sampleTimeStamp)
-    , m_filePosition(filePosition)
-    , m_available(false) {}
+        struct sembuf tmp;
+        tmp.sem_num = NUMBER_OF_SEMAPHORE_TO_CONTROL;
+        tmp.sem_op = VALUE;
+        tmp.sem_flg = 0;
+        if (-1 == ::semop(m_conditionIDSysV, &tmp, 1)) {
+            std::cerr << "[cluon::SharedMemory (SysV)] Failed to wait on semaphore (0x" << std::hex << m_conditionKeySysV << std::dec
+                      << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+            m_broken.store(true);
+        }
+    }
+}
 
-////////////////////////////////////////////////////////////////////////
+inline void SharedMemory::notifyAllSysV() noexcept {
+    if (-1 != m_conditionIDSysV) {
+        {
+            constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+            constexpr int WAKEUP_VALUE{0};
 
-inline Player::Player(const std::string &file, const bool &autoRewind, const bool &threading) noexcept
-    : m_threading(threading)
-    , m_file(file)
-    , m_recFile()
-    , m_recFileValid(false)
-    , m_autoRewind(autoRewind)
-    , m_indexMutex()
-    , m_index()
-    , m_previousPreviousEnvelopeAlreadyReplayed(m_index.end())
-    , m_previousEnvelopeAlreadyReplayed(m_index.begin())
-    , m_currentEnvelopeToReplay(m_index.begin())
-    , m_nextEntryToReadFromRecFile(m_index.begin())
-    , m_desiredInitialLevel(0)
-    , m_firstTimePointReturningAEnvelope()
-    , m_numberOfReturnedEnvelopesInTotal(0)
-    , m_delay(0)
-    , m_envelopeCacheFillingThreadIsRunningMutex()
-    , m_envelopeCacheFillingThreadIsRunning(false)
-    , m_envelopeCacheFillingThread()
-    , m_envelopeCache()
-    , m_playerListenerMutex()
-    , m_playerListener(nullptr) {
-    initializeIndex();
-    computeInitialCacheLevelAndFillCache();
+            union semun tmp;
+            tmp.val = WAKEUP_VALUE;
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wclass-varargs"
+#endif
+            if (-1 == ::semctl(m_conditionIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
+                std::cerr << "[cluon::SharedMemory (SysV)] Failed to notify semaphore (0x" << std::hex << m_conditionKeySysV << std::dec
+                          << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+                m_broken.store(true);
+            }
+#pragma GCC diagnostic pop
+        }
+        {
+            constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
+            constexpr int SLEEPING_VALUE{1};
 
-    if (m_threading) {
-        // Start concurrent thread to manage cache.
-        setEnvelopeCacheFillingRunning(true);
-        m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
+            union semun tmp;
+            tmp.val = SLEEPING_VALUE;
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wclass-varargs"
+#endif
+            if (-1 == ::semctl(m_conditionIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
+                std::cerr << "[cluon::SharedMemory (SysV)] Failed to reset semaphore for notification (0x" << std::hex << m_conditionKeySysV << std::dec
+                          << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+                m_broken.store(true);
+            }
+#pragma GCC diagnostic pop
+        }
     }
 }
 
-inline Player::~Player() {
-    if (m_threading) {
-        // Stop concurrent thread to manage cache.
-        setEnvelopeCacheFillingRunning(false);
-        m_envelopeCacheFillingThread.join();
-    }
-
-    m_recFile.close();
+inline bool SharedMemory::validSysV() noexcept {
+    return (-1 != m_sharedMemoryIDSysV) && (nullptr != m_sharedMemory) && (0 < m_size) && (-1 != m_mutexIDSysV) && (-1 != m_conditionIDSysV);
 }
 
-////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
 
-inline void Player::setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept {
-    std::lock_guard<std::mutex> lck(m_playerListenerMutex);
-    m_playerListener = playerListener;
+#ifdef __linux__
+inline void SharedMemory::futexWait(std::atomic<uint32_t> *word, uint32_t expected) noexcept {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
 }
 
-////////////////////////////////////////////////////////////////////////
+inline void SharedMemory::futexWakeAll(std::atomic<uint32_t> *word) noexcept {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
 
-inline void Player::initializeIndex() noexcept {
-    m_recFile.open(m_file.c_str(), std::ios_base::in | std::ios_base::binary); /* Flawfinder: ignore */
-    m_recFileValid = m_recFile.good();
+inline std::size_t SharedMemory::futexMappingSize(uint32_t size, uint32_t slots) const noexcept {
+    // Header, slot headers, and slots are aligned to cache lines.
+    constexpr std::size_t ALIGNMENT{64};
+    const std::size_t HEADER{(sizeof(SharedMemoryFutexHeader) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT};
+    const std::size_t SLOT{(static_cast<std::size_t>(size) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT};
+    return HEADER + slots * (sizeof(SharedMemorySlotHeader) + SLOT);
+}
 
-    if (m_recFileValid) {
-        // Determine file size to display progress.
-        m_recFile.seekg(0, m_recFile.end);
-        int64_t fileLength = m_recFile.tellg();
-        m_recFile.seekg(0, m_recFile.beg);
+inline void SharedMemory::initFutex() noexcept {
+    // If size is greater than 0, the caller wants to create a new shared
+    // memory area. Otherwise, the caller wants to open an existing shared memory.
+    int flags = O_RDWR;
+    uint32_t slots{1};
+    if (0 < m_size) {
+        flags |= O_CREAT | O_EXCL;
 
-        // Read complete file and store file positions to envelopes to create
-        // index of available data. The actual reading of Envelopes is deferred.
-        uint64_t totalBytesRead = 0;
-        const cluon::data::TimeStamp BEFORE{cluon::time::now()};
-        {
-            int32_t oldPercentage = -1;
-            while (m_recFile.good()) {
-                const uint64_t POS_BEFORE = static_cast<uint64_t>(m_recFile.tellg());
-                auto retVal               = extractEnvelope(m_recFile);
-                const uint64_t POS_AFTER  = static_cast<uint64_t>(m_recFile.tellg());
+        const char *CLUON_SHAREDMEMORY_SLOTS = getenv("CLUON_SHAREDMEMORY_SLOTS");
+        if (nullptr != CLUON_SHAREDMEMORY_SLOTS) {
+            const long VALUE{std::strtol(CLUON_SHAREDMEMORY_SLOTS, nullptr, 10)};
+            slots = static_cast<uint32_t>(std::max(1L, std::min(VALUE, 64L)));
+        }
+    }
 
-                if (!m_recFile.eof() && retVal.first) {
-                    totalBytesRead += (POS_AFTER - POS_BEFORE);
+    m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
+    if ((-1 == m_fd) && ((flags & O_CREAT) == O_CREAT)) {
+        std::clog << "[cluon::SharedMemory (futex)] Trying to remove existing shared memory '" << m_name << "' and trying again... " << std::endl;
+        if (0 == ::shm_unlink(m_name.c_str())) {
+            m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
+        }
+    }
+    if (-1 == m_fd) {
+        std::cerr << "[cluon::SharedMemory (futex)] Failed to open shared memory '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+        return;
+    }
 
-                    // Store mapping .rec file position --> index entry.
-                    const int64_t microseconds = cluon::time::toMicroseconds(retVal.second.sampleTimeStamp());
-                    m_index.emplace(std::make_pair(microseconds, IndexEntry(microseconds, POS_BEFORE)));
+    if ((0 < m_size) && (0 != ::ftruncate(m_fd, static_cast<off_t>(futexMappingSize(m_size, slots))))) {
+        std::cerr << "[cluon::SharedMemory (futex)] Failed to truncate '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+        ::shm_unlink(m_name.c_str());                                                                                                                // LCOV_EXCL_LINE
+        ::close(m_fd);                                                                                                                               // LCOV_EXCL_LINE
+        m_fd = -1;                                                                                                                                   // LCOV_EXCL_LINE
+        return;                                                                                                                                      // LCOV_EXCL_LINE
+    }
 
-                    const int32_t percentage = static_cast<int32_t>((static_cast<float>(m_recFile.tellg()) * 100.0f) / static_cast<float>(fileLength));
-                    if ((percentage % 5 == 0) && (percentage != oldPercentage)) {
-                        std::clog << "[cluon::Player]: Indexed " << percentage << "% from " << m_file << "." << std::endl;
-                        oldPercentage = percentage;
-                    }
+    if (0 == m_size) {
+        // Attaching: read size and slots from the header first; the area must have been created by the futex-based implementation.
+        m_hasOnlyAttachedToSharedMemory = true;
+        struct stat fileStatus;
+        if ((0 == ::fstat(m_fd, &fileStatus)) && (sizeof(SharedMemoryFutexHeader) <= static_cast<std::size_t>(fileStatus.st_size))) {
+            void *header = ::mmap(0, sizeof(SharedMemoryFutexHeader), PROT_READ, MAP_SHARED, m_fd, 0);
+            if (MAP_FAILED != header) {
+                const SharedMemoryFutexHeader *h = reinterpret_cast<const SharedMemoryFutexHeader *>(header);
+                if ((FUTEX_MAGIC == h->__magic) && (0 < h->__slots) && (futexMappingSize(h->__size, h->__slots) <= static_cast<std::size_t>(fileStatus.st_size))) {
+                    m_size = h->__size;
+                    slots  = h->__slots;
                 }
+                ::munmap(header, sizeof(SharedMemoryFutexHeader));
             }
         }
-        const cluon::data::TimeStamp AFTER{cluon::time::now()};
+        if (0 == m_size) {
+            std::cerr << "[cluon::SharedMemory (futex)] '" << m_name << "' was not created with CLUON_SHAREDMEMORY_FUTEX=1." << std::endl;
+            ::close(m_fd);
+            m_fd = -1;
+            return;
+        }
+    }
 
-        std::clog << "[cluon::Player]: " << m_file << " contains " << m_index.size() << " entries; "
-                  << "read " << totalBytesRead << " bytes "
-                  << "in " << cluon::time::deltaInMicroseconds(AFTER, BEFORE) / static_cast<int64_t>(1000 * 1000) << "s." << std::endl;
-    } else {
-        std::clog << "[cluon::Player]: " << m_file << " could not be opened." << std::endl;
+    const std::size_t MAPPING_SIZE{futexMappingSize(m_size, slots)};
+    void *memory = ::mmap(0, MAPPING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (MAP_FAILED == memory) {
+        std::cerr << "[cluon::SharedMemory (futex)] Failed to map '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+        return;                                                                                                                                   // LCOV_EXCL_LINE
     }
-}
+    m_sharedMemory            = static_cast<char *>(memory);
+    m_sharedMemoryFutexHeader = reinterpret_cast<SharedMemoryFutexHeader *>(m_sharedMemory);
+    if (!m_hasOnlyAttachedToSharedMemory) {
+        // The new area is zeroed: unlocked, generation 0, no waiters, and slot 0 published last.
+        m_sharedMemoryFutexHeader->__size  = m_size;
+        m_sharedMemoryFutexHeader->__slots = slots;
+        m_sharedMemoryFutexHeader->__magic = FUTEX_MAGIC;
+    }
+    m_slotStride                 = (m_size + 63) / 64 * 64;
+    m_slotHeaders                = reinterpret_cast<SharedMemorySlotHeader *>(m_sharedMemory + futexMappingSize(0, 0));
+    m_slotData                   = reinterpret_cast<char *>(m_slotHeaders + slots);
+    m_lastGeneration             = m_sharedMemoryFutexHeader->__generation.load();
+    m_userAccessibleSharedMemory = m_slotData + m_sharedMemoryFutexHeader->__latestSlot.load() * m_slotStride;
 
-inline void Player::resetCaches() noexcept {
-    try {
-        std::lock_guard<std::mutex> lck(m_indexMutex);
-        m_delay                            = 0;
-        m_numberOfReturnedEnvelopesInTotal = 0;
-        m_envelopeCache.clear();
-    } catch (...) {} // LCOV_EXCL_LINE
+    // Lock the shared memory into RAM for performance reasons.
+    if (-1 == ::mlock(m_sharedMemory, MAPPING_SIZE)) {
+        std::cerr << "[cluon::SharedMemory (futex)] Failed to mlock shared memory: " // LCOV_EXCL_LINE
+                  << ::strerror(errno) << " (" << errno << ")" << std::endl;         // LCOV_EXCL_LINE
+    }
+
+    // The POSIX shared memory lives in /dev/shm and its file descriptor is used for timestamping.
+    m_fdForTimeStamping = m_fd;
 }
 
-inline void Player::resetIterators() noexcept {
-    try {
-        std::lock_guard<std::mutex> lck(m_indexMutex);
-        // Point to first entry in index.
-        m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay = m_index.begin();
-        // Invalidate iterator for erasing entries point.
-        m_previousPreviousEnvelopeAlreadyReplayed = m_index.end();
-    } catch (...) {} // LCOV_EXCL_LINE
+inline void SharedMemory::deinitFutex() noexcept {
+    if ((nullptr != m_sharedMemoryFutexHeader) && (!m_hasOnlyAttachedToSharedMemory)) {
+        // Wake any waiting threads as we are going to end the shared memory session.
+        notifyAllFutex();
+    }
+    if ((nullptr != m_sharedMemoryFutexHeader) && ::munmap(m_sharedMemory, futexMappingSize(m_size, m_sharedMemoryFutexHeader->__slots))) {
+        std::cerr << "[cluon::SharedMemory (futex)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+    }
+    if (!m_hasOnlyAttachedToSharedMemory && (-1 != m_fd) && (-1 == ::shm_unlink(m_name.c_str()) && (ENOENT != errno))) {
+        std::cerr << "[cluon::SharedMemory (futex)] Failed to unlink shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
+    }
+    if (-1 != m_fd) {
+        ::close(m_fd);
+    }
 }
 
-inline void Player::computeInitialCacheLevelAndFillCache() noexcept {
-    if (m_recFileValid && (m_index.size() > 0)) {
-        int64_t smallestSampleTimePoint = (std::numeric_limits<int64_t>::max)();
-        int64_t largestSampleTimePoint  = (std::numeric_limits<int64_t>::min)();
-        for (auto it = m_index.begin(); it != m_index.end(); it++) {
-            smallestSampleTimePoint = (std::min)(smallestSampleTimePoint, it->first);
-            largestSampleTimePoint  = (std::max)(largestSampleTimePoint, it->first);
+inline void SharedMemory::lockFutex() noexcept {
+    if (nullptr != m_sharedMemoryFutexHeader) {
+        std::atomic<uint32_t> &word = m_sharedMemoryFutexHeader->__lock;
+        uint32_t state{word.load()};
+        while (true) {
+            if (0 == (state & (FUTEX_LOCK_WRITER | FUTEX_LOCK_READERS))) {
+                // Keep the waiting flags so that unlock wakes the others.
+                if (word.compare_exchange_weak(state, state | FUTEX_LOCK_WRITER)) {
+                    break;
+                }
+            } else if (0 == (state & FUTEX_LOCK_WRITER_WAITING)) {
+                // Announce the waiting writer to keep new readers out.
+                word.compare_exchange_weak(state, state | FUTEX_LOCK_WRITER_WAITING);
+            } else {
+                futexWait(&word, state);
+                state = word.load();
+            }
         }
 
-        const uint32_t ENTRIES_TO_READ_PER_SECOND_FOR_REALTIME_REPLAY
-            = static_cast<uint32_t>(std::ceil(static_cast<float>(m_index.size()) * (static_cast<float>(Player::ONE_SECOND_IN_MICROSECONDS))
-                                              / static_cast<float>(largestSampleTimePoint - smallestSampleTimePoint)));
-        m_desiredInitialLevel = (std::max<uint32_t>)(ENTRIES_TO_READ_PER_SECOND_FOR_REALTIME_REPLAY * Player::LOOK_AHEAD_IN_S, MIN_ENTRIES_FOR_LOOK_AHEAD);
-
-        std::clog << "[cluon::Player]: Initializing cache with " << m_desiredInitialLevel << " entries." << std::endl;
-
-        resetCaches();
-        resetIterators();
-        fillEnvelopeCache(m_desiredInitialLevel);
+        const uint32_t SLOTS{m_sharedMemoryFutexHeader->__slots};
+        if (1 < SLOTS) {
+            // Take the next slot that no reader pinned; if all are pinned, take the one after the latest anyway.
+            const uint32_t LATEST{m_sharedMemoryFutexHeader->__latestSlot.load()};
+            uint32_t slot{(LATEST + 1) % SLOTS};
+            while ((slot != LATEST) && (0 < m_slotHeaders[slot].__readers.load())) {
+                slot = (slot + 1) % SLOTS;
+            }
+            if (slot == LATEST) {
+                slot = (LATEST + 1) % SLOTS;
+                m_sharedMemoryFutexHeader->__slotReuses++;
+            }
+            m_currentSlot     = slot;
+            m_currentSequence = m_slotHeaders[slot].__sequence.load(std::memory_order_relaxed) + 1;
+            m_slotHeaders[slot].__sequence.store(m_currentSequence, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_userAccessibleSharedMemory = m_slotData + slot * m_slotStride;
+        }
     }
 }
 
-inline uint32_t Player::fillEnvelopeCache(const uint32_t &maxNumberOfEntriesToReadFromFile) noexcept {
-    uint32_t entriesReadFromFile = 0;
-    if (m_recFileValid && (maxNumberOfEntriesToReadFromFile > 0)) {
-        // Reset any fstream's error states.
-        m_recFile.clear();
+inline void SharedMemory::unlockFutex() noexcept {
+    if (nullptr != m_sharedMemoryFutexHeader) {
+        if (1 < m_sharedMemoryFutexHeader->__slots) {
+            // Publish the written slot.
+            m_slotHeaders[m_currentSlot].__sequence.store(m_currentSequence + 1, std::memory_order_release);
+            m_sharedMemoryFutexHeader->__latestSlot.store(m_currentSlot, std::memory_order_release);
+        }
 
-        while ((m_nextEntryToReadFromRecFile != m_index.end()) && (entriesReadFromFile < maxNumberOfEntriesToReadFromFile)) {
-            // Move to corresponding position in the .rec file.
-            m_recFile.seekg(static_cast<std::streamoff>(m_nextEntryToReadFromRecFile->second.m_filePosition));
+        const uint32_t PREVIOUS{m_sharedMemoryFutexHeader->__lock.exchange(0)};
+        if (0 != (PREVIOUS & (FUTEX_LOCK_WRITER_WAITING | FUTEX_LOCK_READERS_WAITING))) {
+            futexWakeAll(&m_sharedMemoryFutexHeader->__lock);
+        }
+    }
+}
 
-            // Read the corresponding cluon::data::Envelope.
-            auto retVal = extractEnvelope(m_recFile);
-            if (retVal.first) {
-                // Store the envelope in the envelope cache.
-                try {
-                    std::lock_guard<std::mutex> lck(m_indexMutex);
-                    m_nextEntryToReadFromRecFile->second.m_available
-                        = m_envelopeCache.emplace(std::make_pair(m_nextEntryToReadFromRecFile->second.m_filePosition, retVal.second)).second;
-                } catch (...) {} // LCOV_EXCL_LINE
+inline void SharedMemory::lockSharedFutex() noexcept {
+    if (nullptr != m_sharedMemoryFutexHeader) {
+        if (1 < m_sharedMemoryFutexHeader->__slots) {
+            // Pin the slot published last; the sequence validates the copy in case the producer had to take it nonetheless.
+            while (true) {
+                const uint32_t SLOT{m_sharedMemoryFutexHeader->__latestSlot.load(std::memory_order_acquire)};
+                m_slotHeaders[SLOT].__readers.fetch_add(1);
+                const uint32_t SEQUENCE{m_slotHeaders[SLOT].__sequence.load(std::memory_order_acquire)};
+                if (0 == (SEQUENCE & 1)) {
+                    m_currentSlot                = SLOT;
+                    m_currentSequence            = SEQUENCE;
+                    m_userAccessibleSharedMemory = m_slotData + SLOT * m_slotStride;
+                    return;
+                }
+                m_slotHeaders[SLOT].__readers.fetch_sub(1);
+                std::this_thread::yield();
+            }
+        }
 
-                m_nextEntryToReadFromRecFile++;
-                entriesReadFromFile++;
+        std::atomic<uint32_t> &word = m_sharedMemoryFutexHeader->__lock;
+        uint32_t state{word.load()};
+        while (true) {
+            if (0 == (state & (FUTEX_LOCK_WRITER | FUTEX_LOCK_WRITER_WAITING))) {
+                if (word.compare_exchange_weak(state, state + 1)) {
+                    return;
+                }
+            } else if (0 == (state & FUTEX_LOCK_READERS_WAITING)) {
+                word.compare_exchange_weak(state, state | FUTEX_LOCK_READERS_WAITING);
+            } else {
+                futexWait(&word, state);
+                state = word.load();
             }
         }
     }
-
-    return entriesReadFromFile;
 }
 
-inline std::pair<bool, cluon::data::Envelope> Player::getNextEnvelopeToBeReplayed() noexcept {
-    bool hasEnvelopeToReturn{false};
-    cluon::data::Envelope envelopeToReturn;
+inline bool SharedMemory::unlockSharedFutex() noexcept {
+    bool consistent{true};
+    if (nullptr != m_sharedMemoryFutexHeader) {
+        if (1 < m_sharedMemoryFutexHeader->__slots) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            consistent = (m_currentSequence == m_slotHeaders[m_currentSlot].__sequence.load(std::memory_order_relaxed));
+            m_slotHeaders[m_currentSlot].__readers.fetch_sub(1);
+            if (!consistent) {
+                m_overruns++;
+            }
+            return consistent;
+        }
 
-    // If at "EOF", either throw exception or autorewind.
-    if (m_currentEnvelopeToReplay == m_index.end()) {
-        if (!m_autoRewind) {
-            return std::make_pair(hasEnvelopeToReturn, envelopeToReturn);
-        } else {
-            rewind();
+        const uint32_t PREVIOUS{m_sharedMemoryFutexHeader->__lock.fetch_sub(1)};
+        // The last reader lets a waiting writer in.
+        if ((1 == (PREVIOUS & FUTEX_LOCK_READERS)) && (0 != (PREVIOUS & FUTEX_LOCK_WRITER_WAITING))) {
+            futexWakeAll(&m_sharedMemoryFutexHeader->__lock);
         }
     }
+    return consistent;
+}
 
-    if (m_currentEnvelopeToReplay != m_index.end()) {
-        checkAvailabilityOfNextEnvelopeToBeReplayed();
+inline void SharedMemory::waitFutex() noexcept {
+    if (nullptr != m_sharedMemoryFutexHeader) {
+        std::atomic<uint32_t> &generation = m_sharedMemoryFutexHeader->__generation;
+        uint32_t current{generation.load()};
+        while (current == m_lastGeneration) {
+            m_sharedMemoryFutexHeader->__waiters.fetch_add(1);
+            futexWait(&generation, current);
+            m_sharedMemoryFutexHeader->__waiters.fetch_sub(1);
+            current = generation.load();
+        }
+        m_lastGeneration = current;
+    }
+}
 
-        try {
-            {
-                std::lock_guard<std::mutex> lck(m_indexMutex);
+inline void SharedMemory::notifyAllFutex() noexcept {
+    if (nullptr != m_sharedMemoryFutexHeader) {
+        m_sharedMemoryFutexHeader->__generation.fetch_add(1);
+        // Waiters register before sleeping; the system call is only needed if there are any.
+        if (0 < m_sharedMemoryFutexHeader->__waiters.load()) {
+            futexWakeAll(&m_sharedMemoryFutexHeader->__generation);
+        }
+    }
+}
 
-                cluon::data::Envelope &nextEnvelope = m_envelopeCache[m_currentEnvelopeToReplay->second.m_filePosition];
-                envelopeToReturn                    = nextEnvelope;
+inline bool SharedMemory::validFutex() noexcept {
+    return (-1 != m_fd) && (nullptr != m_sharedMemoryFutexHeader);
+}
+#endif
+#endif
 
-                m_delay = static_cast<uint32_t>(m_currentEnvelopeToReplay->first - m_previousEnvelopeAlreadyReplayed->first);
+} // namespace cluon
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-                // TODO: Delegate deleting into own thread.
-                if (m_previousPreviousEnvelopeAlreadyReplayed != m_index.end()) {
-                    auto it = m_envelopeCache.find(m_previousEnvelopeAlreadyReplayed->second.m_filePosition);
-                    if (it != m_envelopeCache.end()) {
-                        m_envelopeCache.erase(it);
-                    }
-                }
+//#include "cluon/Recorder.hpp"
+//#include "cluon/Envelope.hpp"
+//#include "cluon/Time.hpp"
 
-                m_previousPreviousEnvelopeAlreadyReplayed = m_previousEnvelopeAlreadyReplayed;
-                m_previousEnvelopeAlreadyReplayed         = m_currentEnvelopeToReplay++;
+// clang-format off
+#ifdef WIN32
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+// clang-format on
 
-                m_numberOfReturnedEnvelopesInTotal++;
-            }
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
 
-            // TODO compensate for internal data processing.
+namespace cluon {
 
-            // If Player is non-threaded, read next entry sequentially.
-            if (!m_threading) {
-                fillEnvelopeCache(1);
-            }
+inline Recorder::Recorder(const std::string &file,
+                          uint64_t rotateAfterBytes,
+                          uint32_t rotateAfterSeconds,
+                          FsyncPolicy fsyncPolicy,
+                          uint32_t fsyncIntervalInMilliseconds,
+                          uint64_t maxQueuedBytes,
+                          bool compress) noexcept
+    : m_file(file)
+    , m_rotateAfterBytes(rotateAfterBytes)
+    , m_rotateAfterSeconds(rotateAfterSeconds)
+    , m_fsyncPolicy(fsyncPolicy)
+    , m_fsyncInterval(fsyncIntervalInMilliseconds)
+    , m_maxQueuedBytes(maxQueuedBytes)
+    , m_compress(compress) {
+    // The staging buffer is aligned to the block size so that the writes could also go through O_DIRECT.
+#ifdef WIN32
+    m_stagingBuffer = static_cast<char *>(::_aligned_malloc(STAGING_BUFFER_SIZE, BLOCK_SIZE));
+#else
+    void *buffer{nullptr};
+    if (0 == ::posix_memalign(&buffer, BLOCK_SIZE, STAGING_BUFFER_SIZE)) {
+        m_stagingBuffer = static_cast<char *>(buffer);
+    }
+#endif
+    if ((nullptr != m_stagingBuffer) && openNextFile()) {
+        try {
+            m_queue.m_data.reserve(2 * BATCH_SIZE_TO_WAKE_WRITER);
+            m_writing.m_data.reserve(2 * BATCH_SIZE_TO_WAKE_WRITER);
 
-            // Store sample time stamp as int64 to avoid unnecessary copying of Envelopes.
-            hasEnvelopeToReturn = true;
-        } catch (...) {} // LCOV_EXCL_LINE
+            m_recording.store(true);
+            m_writerThread = std::thread(&Recorder::writeToDisk, this);
+        } catch (...) { m_recording.store(false); } // LCOV_EXCL_LINE
     }
-    return std::make_pair(hasEnvelopeToReturn, envelopeToReturn);
 }
 
-inline void Player::checkAvailabilityOfNextEnvelopeToBeReplayed() noexcept {
-    uint64_t numberOfEntries = 0;
-    do {
-        {
-            try {
-                std::lock_guard<std::mutex> lck(m_indexMutex);
-                numberOfEntries = m_envelopeCache.size();
-            } catch (...) {} // LCOV_EXCL_LINE
-        }
-        if (0 == numberOfEntries) {
-            using namespace std::chrono_literals; // LCOV_EXCL_LINE
-            std::this_thread::sleep_for(10ms);    // LCOV_EXCL_LINE
+inline Recorder::~Recorder() noexcept {
+    m_recording.store(false);
+    m_queueCondition.notify_all();
+    try {
+        if (m_writerThread.joinable()) {
+            m_writerThread.join();
         }
-    } while (0 == numberOfEntries);
-}
+    } catch (...) {} // LCOV_EXCL_LINE
 
-////////////////////////////////////////////////////////////////////////
+    closeCurrentFile();
+    if (0 < (m_recordedEnvelopes.load() + m_droppedEnvelopes.load())) {
+        std::clog << "[cluon::Recorder]: Recorded " << m_recordedEnvelopes.load() << " Envelopes (" << m_recordedBytes.load() << " bytes); dropped "
+                  << m_droppedEnvelopes.load() << "." << std::endl;
+    }
 
-inline uint32_t Player::totalNumberOfEnvelopesInRecFile() const noexcept {
-    std::lock_guard<std::mutex> lck(m_indexMutex);
-    return static_cast<uint32_t>(m_index.size());
+#ifdef WIN32
+    ::_aligned_free(m_stagingBuffer);
+#else
+    ::free(m_stagingBuffer);
+#endif
+    m_stagingBuffer = nullptr;
 }
 
-inline uint32_t Player::delay() const noexcept {
-    std::lock_guard<std::mutex> lck(m_indexMutex);
-    // Make sure that delay is not exceeding the specified maximum delay.
-    return std::min<uint32_t>(m_delay, Player::MAX_DELAY_IN_MICROSECONDS);
+inline bool Recorder::isRecording() const noexcept {
+    return m_recording.load();
 }
 
-inline void Player::rewind() noexcept {
-    if (m_threading) {
-        // Stop concurrent thread.
-        setEnvelopeCacheFillingRunning(false);
-        m_envelopeCacheFillingThread.join();
-    }
-
-    computeInitialCacheLevelAndFillCache();
-
-    if (m_threading) {
-        // Re-start concurrent thread.
-        setEnvelopeCacheFillingRunning(true);
-        m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
-    }
+inline uint64_t Recorder::numberOfRecordedEnvelopes() const noexcept {
+    return m_recordedEnvelopes.load();
 }
 
-inline void Player::seekTo(float ratio) noexcept {
-    if (!(ratio < 0) && !(ratio > 1)) {
-        bool enableThreading = m_threading;
-        if (m_threading) {
-            // Stop concurrent thread.
-            setEnvelopeCacheFillingRunning(false);
-            m_envelopeCacheFillingThread.join();
-        }
+inline uint64_t Recorder::numberOfRecordedBytes() const noexcept {
+    return m_recordedBytes.load();
+}
 
-        // Read data sequentially.
-        m_threading = false;
+inline uint64_t Recorder::numberOfDroppedEnvelopes() const noexcept {
+    return m_droppedEnvelopes.load();
+}
 
-        resetCaches();
-        resetIterators();
+inline std::string Recorder::currentFile() const noexcept {
+    std::lock_guard<std::mutex> lck(m_currentFileMutex);
+    return m_currentFile;
+}
 
-        uint32_t numberOfEntriesInIndex = 0;
+inline bool Recorder::record(cluon::data::Envelope &&envelope) noexcept {
+    bool retVal{false};
+    if (m_recording.load()) {
         try {
-            std::lock_guard<std::mutex> lck(m_indexMutex);
-            numberOfEntriesInIndex = static_cast<uint32_t>(m_index.size());
-        } catch (...) {} // LCOV_EXCL_LINE
+            QueuedEnvelope qe;
+            qe.m_sampleTimeStamp = cluon::time::toMicroseconds(envelope.sampleTimeStamp());
+            qe.m_dataType        = envelope.dataType();
+            qe.m_senderStamp     = envelope.senderStamp();
 
-        // Fast forward.
-        m_numberOfReturnedEnvelopesInTotal = 0;
-        std::clog << "[cluon::Player]: Seeking to " << static_cast<float>(numberOfEntriesInIndex) * ratio << "/" << numberOfEntriesInIndex << std::endl;
-        if (0 < ratio) {
-            for (m_numberOfReturnedEnvelopesInTotal = 0;
-                 m_numberOfReturnedEnvelopesInTotal < static_cast<uint32_t>(static_cast<float>(numberOfEntriesInIndex) * ratio) - 1;
-                 m_numberOfReturnedEnvelopesInTotal++) {
-                m_currentEnvelopeToReplay++;
+            // Serialize outside of the lock.
+            const std::string data{cluon::serializeEnvelope(std::move(envelope))};
+            qe.m_size = static_cast<uint32_t>(data.size());
+
+            bool wakeWriter{false};
+            {
+                std::lock_guard<std::mutex> lck(m_queueMutex);
+                if ((m_queue.m_data.size() + data.size()) <= m_maxQueuedBytes) {
+                    m_queue.m_data.append(data);
+                    m_queue.m_envelopes.push_back(qe);
+                    wakeWriter = (m_queue.m_data.size() >= BATCH_SIZE_TO_WAKE_WRITER);
+                    retVal     = true;
+                }
+            }
+            if (wakeWriter) {
+                m_queueCondition.notify_one();
             }
-        }
-        try {
-            std::lock_guard<std::mutex> lck(m_indexMutex);
-            m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay;
         } catch (...) {} // LCOV_EXCL_LINE
+    }
+    if (!retVal) {
+        m_droppedEnvelopes++;
+    }
+    return retVal;
+}
 
-        // Refill cache.
-        m_envelopeCache.clear();
-        fillEnvelopeCache(static_cast<uint32_t>(static_cast<float>(m_desiredInitialLevel) * .3f));
-
-        // Correct iterators if not at the beginning.
-        if ((0 < ratio) && (ratio < 1)) {
-            getNextEnvelopeToBeReplayed();
+inline void Recorder::writeToDisk() noexcept {
+    bool running{true};
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lck(m_queueMutex);
+            // Write at least every 100ms to bound the amount of data lost on a crash.
+            m_queueCondition.wait_for(lck, std::chrono::milliseconds(100), [this] {
+                return (!m_recording.load() || (m_queue.m_data.size() >= BATCH_SIZE_TO_WAKE_WRITER));
+            });
+            // Keep on draining the queue after the Recorder was stopped.
+            running = m_recording.load();
+            std::swap(m_queue, m_writing);
+        }
+
+        const auto NOW{std::chrono::steady_clock::now()};
+        const bool ROTATE_BY_TIME{(0 < m_rotateAfterSeconds) && ((NOW - m_fileOpened) >= std::chrono::seconds(m_rotateAfterSeconds))};
+        const uint64_t FILE_SIZE{m_compressedRecWriter ? m_compressedRecWriter->compressedBytes() : m_filePosition};
+        const bool ROTATE_BY_SIZE{(0 < m_rotateAfterBytes) && (FILE_SIZE >= m_rotateAfterBytes)};
+        if (!m_writing.m_envelopes.empty() && (ROTATE_BY_TIME || ROTATE_BY_SIZE)) {
+            closeCurrentFile();
+            if (!openNextFile()) {
+                // Without a file, everything that arrives from now on is lost.
+                m_droppedEnvelopes += m_writing.m_envelopes.size();
+                m_writing.m_data.clear();
+                m_writing.m_envelopes.clear();
+                m_recording.store(false);
+                break;
+            }
         }
-        std::clog << "[cluon::Player]: Seeking done." << std::endl;
 
-        if (enableThreading) {
-            m_threading = enableThreading;
-            // Re-start concurrent thread.
-            setEnvelopeCacheFillingRunning(true);
-            m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
+        if (m_compressedRecWriter) {
+            // Compressed files are written block by block by the CompressedRecWriter.
+            size_t offset{0};
+            for (const auto &e : m_writing.m_envelopes) {
+                m_compressedRecWriter->append(m_writing.m_data.data() + offset, e.m_size, e.m_sampleTimeStamp);
+                offset += e.m_size;
+            }
+        } else {
+            // Copy the batch into the aligned staging buffer and write full blocks.
+            const char *data{m_writing.m_data.data()};
+            size_t remaining{m_writing.m_data.size()};
+            while (0 < remaining) {
+                const size_t CHUNK{(std::min)(remaining, static_cast<size_t>(STAGING_BUFFER_SIZE - m_stagingBufferLevel))};
+                std::memcpy(m_stagingBuffer + m_stagingBufferLevel, data, CHUNK);
+                m_stagingBufferLevel += static_cast<uint32_t>(CHUNK);
+                data += CHUNK;
+                remaining -= CHUNK;
+                writeStagingBuffer(false);
+            }
+            // The index entries below must not point past the data handed to the file system.
+            writeStagingBufferTail(m_filePosition + m_writing.m_data.size() - m_stagingBufferLevel);
         }
-    }
-}
 
-inline bool Player::hasMoreData() const noexcept {
-    std::lock_guard<std::mutex> lck(m_indexMutex);
-    return hasMoreDataFromRecFile();
-}
+        for (const auto &e : m_writing.m_envelopes) {
+            IndexFileEntry entry;
+            entry.sampleTimeStamp = static_cast<int64_t>(htole64(static_cast<uint64_t>(e.m_sampleTimeStamp)));
+            entry.filePosition    = htole64(m_filePosition);
+            entry.dataType        = static_cast<int32_t>(htole32(static_cast<uint32_t>(e.m_dataType)));
+            entry.senderStamp     = htole32(e.m_senderStamp);
+            m_indexEntries.push_back(entry);
 
-inline bool Player::hasMoreDataFromRecFile() const noexcept {
-    // File must be successfully opened AND
-    //  the Player must be configured as m_autoRewind OR
-    //  some entries are left to replay.
-    return (m_recFileValid && (m_autoRewind || (m_currentEnvelopeToReplay != m_index.end())));
-}
+            auto &counts = m_counts[std::make_pair(e.m_dataType, e.m_senderStamp)];
+            counts.first++;
+            counts.second += e.m_size;
 
-////////////////////////////////////////////////////////////////////////
+            m_filePosition += e.m_size;
+        }
+        if ((-1 != m_indexFd) && !m_indexEntries.empty()) {
+            const auto BYTES{static_cast<ssize_t>(m_indexEntries.size() * sizeof(IndexFileEntry))};
+            if (BYTES != ::write(m_indexFd, m_indexEntries.data(), static_cast<size_t>(BYTES))) {
+                std::cerr << "[cluon::Recorder]: Failed to write index: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+            }
+        }
+        m_indexEntries.clear();
 
-inline void Player::setEnvelopeCacheFillingRunning(const bool &running) noexcept {
-    std::lock_guard<std::mutex> lck(m_envelopeCacheFillingThreadIsRunningMutex);
-    m_envelopeCacheFillingThreadIsRunning = running;
-}
+        m_recordedEnvelopes += m_writing.m_envelopes.size();
+        m_recordedBytes += m_writing.m_data.size();
+        const bool WROTE_SOMETHING{!m_writing.m_envelopes.empty()};
+        m_writing.m_data.clear();
+        m_writing.m_envelopes.clear();
 
-inline bool Player::isEnvelopeCacheFillingRunning() const noexcept {
-    std::lock_guard<std::mutex> lck(m_envelopeCacheFillingThreadIsRunningMutex);
-    return m_envelopeCacheFillingThreadIsRunning;
+        if (WROTE_SOMETHING) {
+            if ((FsyncPolicy::PER_BATCH == m_fsyncPolicy)
+                || ((FsyncPolicy::INTERVAL == m_fsyncPolicy) && ((NOW - m_lastSync) >= m_fsyncInterval))) {
+                syncToDisk();
+                m_lastSync = NOW;
+            }
+            if ((NOW - m_lastCounts) >= std::chrono::seconds(COUNTS_INTERVAL_IN_SECONDS)) {
+                writeCounts();
+                m_lastCounts = NOW;
+            }
+        }
+    }
 }
 
-inline void Player::manageCache() noexcept {
-    uint8_t statisticsCounter = 0;
-    float refillMultiplicator = 1.1f;
-    uint32_t numberOfEntries  = 0;
+inline bool Recorder::openNextFile() noexcept {
+    std::string file{m_file};
+    if ((0 < m_rotateAfterBytes) || (0 < m_rotateAfterSeconds)) {
+        const std::string SUFFIX{".rec"};
+        const bool HAS_SUFFIX{(file.size() > SUFFIX.size()) && (0 == file.compare(file.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX))};
+        std::stringstream sstr;
+        sstr << (HAS_SUFFIX ? file.substr(0, file.size() - SUFFIX.size()) : file) << "-" << m_fileNumber++ << SUFFIX;
+        file = sstr.str();
+    }
 
-    while (isEnvelopeCacheFillingRunning()) {
+    if (m_compress) {
         try {
-            std::lock_guard<std::mutex> lck(m_indexMutex);
-            numberOfEntries = static_cast<uint32_t>(m_envelopeCache.size());
+            m_compressedRecWriter.reset(new CompressedRecWriter(file));
         } catch (...) {} // LCOV_EXCL_LINE
+        if (!m_compressedRecWriter || !m_compressedRecWriter->isOpen()) {
+            m_compressedRecWriter.reset();
+            return false;
+        }
+    } else {
+#ifdef WIN32
+        m_fd = ::_open(file.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+        m_indexFd = ::_open((file + ".idx").c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        m_fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        m_indexFd = ::open((file + ".idx").c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+#endif
+    }
+    if (!m_compressedRecWriter && (-1 == m_fd)) {
+        std::cerr << "[cluon::Recorder]: Failed to open '" << file << "': " << ::strerror(errno) << std::endl;
+        return false;
+    }
+    if (-1 != m_indexFd) {
+        char header[12];
+        const uint32_t VERSION{htole32(INDEX_FILE_VERSION)};
+        std::memcpy(header, INDEX_FILE_MAGIC, 8);
+        std::memcpy(header + 8, &VERSION, sizeof(VERSION));
+        if (static_cast<ssize_t>(sizeof(header)) != ::write(m_indexFd, header, sizeof(header))) {
+            std::cerr << "[cluon::Recorder]: Failed to write index header for '" << file << "'." << std::endl; // LCOV_EXCL_LINE
+        }
+    }
 
-        // Check if refilling of the cache is needed.
-        refillMultiplicator = checkRefillingCache(numberOfEntries, refillMultiplicator);
-        (void)refillMultiplicator;
-
-        // Manage cache at 10 Hz.
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(100ms);
-
-        // Publish some statistics at 1 Hz.
-        if (0 == ((++statisticsCounter) % 10)) {
-            uint64_t numberOfReturnedEnvelopesInTotal = 0;
-            uint32_t totalNumberOfEnvelopes           = 0;
-            try {
-                // m_numberOfReturnedEnvelopesInTotal is modified in a different thread.
-                std::lock_guard<std::mutex> lck(m_indexMutex);
-                numberOfReturnedEnvelopesInTotal = m_numberOfReturnedEnvelopesInTotal;
-                totalNumberOfEnvelopes           = static_cast<uint32_t>(m_index.size());
-            } catch (...) {} // LCOV_EXCL_LINE
+    m_filePosition = 0;
+    m_counts.clear();
+    m_fileOpened = m_lastSync = m_lastCounts = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lck(m_currentFileMutex);
+        m_currentFile = file;
+    }
+    std::clog << "[cluon::Recorder]: Recording to '" << file << "'." << std::endl;
+    return true;
+}
 
-            try {
-                std::lock_guard<std::mutex> lck(m_playerListenerMutex);
-                if (nullptr != m_playerListener) {
-                    cluon::data::PlayerStatus ps;
-                    ps.state(2); // State: "playback"
-                    ps.numberOfEntries(totalNumberOfEnvelopes);
-                    ps.currentEntryForPlayback(static_cast<uint32_t>(numberOfReturnedEnvelopesInTotal));
-                    m_playerListener(ps);
+inline void Recorder::closeCurrentFile() noexcept {
+    if (m_compressedRecWriter) {
+        m_compressedRecWriter->close();
+        if (FsyncPolicy::NEVER != m_fsyncPolicy) {
+            m_compressedRecWriter->sync();
+        }
+        m_compressedRecWriter.reset();
+        writeCounts();
+    }
+    if (-1 != m_fd) {
+        writeStagingBuffer(true);
+        if (FsyncPolicy::NEVER != m_fsyncPolicy) {
+            syncToDisk();
+        }
+        writeCounts();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    if (-1 != m_indexFd) {
+        ::close(m_indexFd);
+        m_indexFd = -1;
+    }
+}
+
+inline void Recorder::writeStagingBuffer(bool flushAll) noexcept {
+    // Hand only full blocks to the file system; the remainder is kept for the next round.
+    const uint32_t BYTES{flushAll ? m_stagingBufferLevel : (m_stagingBufferLevel / BLOCK_SIZE) * BLOCK_SIZE};
+    if ((-1 != m_fd) && (0 < BYTES)) {
+        uint32_t written{0};
+        while (written < BYTES) {
+            const ssize_t n{::write(m_fd, m_stagingBuffer + written, BYTES - written)};
+            if (0 > n) {
+                if (EINTR == errno) {
+                    continue;
                 }
-            } catch (...) {} // LCOV_EXCL_LINE
+                std::cerr << "[cluon::Recorder]: Failed to write: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+                break;                                                                                 // LCOV_EXCL_LINE
+            }
+            written += static_cast<uint32_t>(n);
+        }
+        std::memmove(m_stagingBuffer, m_stagingBuffer + BYTES, m_stagingBufferLevel - BYTES);
+        m_stagingBufferLevel -= BYTES;
+    }
+}
 
-            statisticsCounter = 0;
+inline void Recorder::writeStagingBufferTail(uint64_t position) noexcept {
+    // Write the remainder at its final position without moving the file offset;
+    // the next full block written by writeStagingBuffer overwrites it.
+    if ((-1 != m_fd) && (0 < m_stagingBufferLevel)) {
+        uint32_t written{0};
+        while (written < m_stagingBufferLevel) {
+#ifdef WIN32
+            ::_lseeki64(m_fd, static_cast<int64_t>(position + written), SEEK_SET);
+            const int n{::_write(m_fd, m_stagingBuffer + written, m_stagingBufferLevel - written)};
+            ::_lseeki64(m_fd, static_cast<int64_t>(position), SEEK_SET);
+#else
+            const ssize_t n{::pwrite(m_fd, m_stagingBuffer + written, m_stagingBufferLevel - written, static_cast<off_t>(position + written))};
+#endif
+            if (0 > n) {
+                if (EINTR == errno) {
+                    continue;
+                }
+                std::cerr << "[cluon::Recorder]: Failed to write: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+                break;                                                                                 // LCOV_EXCL_LINE
+            }
+            written += static_cast<uint32_t>(n);
         }
     }
 }
 
-inline float Player::checkRefillingCache(const uint32_t &numberOfEntries, float refillMultiplicator) noexcept {
-    // If filling level is around 35%, pour in more from the recording.
-    if (numberOfEntries < 0.35 * m_desiredInitialLevel) {
-        const uint32_t entriesReadFromFile = fillEnvelopeCache(static_cast<uint32_t>(refillMultiplicator * static_cast<float>(m_desiredInitialLevel)));
-        if (entriesReadFromFile > 0) {
-            std::clog << "[cluon::Player]: Number of entries in cache: " << numberOfEntries << ". " << entriesReadFromFile << " added to cache. "
-                      << m_envelopeCache.size() << " entries available." << std::endl;
-            refillMultiplicator *= 1.25f;
+inline void Recorder::writeCounts() noexcept {
+    std::string file{currentFile()};
+    std::fstream fout(file + ".counts.csv", std::ios::out | std::ios::trunc);
+    if (fout.good()) {
+        fout << "dataType;senderStamp;envelopes;bytes" << std::endl;
+        for (const auto &e : m_counts) {
+            fout << e.first.first << ";" << e.first.second << ";" << e.second.first << ";" << e.second.second << std::endl;
         }
     }
-    return refillMultiplicator;
+}
+
+inline void Recorder::syncToDisk() noexcept {
+    if (m_compressedRecWriter) {
+        m_compressedRecWriter->sync();
+        return;
+    }
+#ifdef WIN32
+    ::_commit(m_fd);
+#elif defined(__linux__)
+    ::fdatasync(m_fd);
+    if (-1 != m_indexFd) {
+        ::fdatasync(m_indexFd);
+    }
+#else
+    ::fsync(m_fd);
+    if (-1 != m_indexFd) {
+        ::fsync(m_indexFd);
+    }
+#endif
 }
 
 } // namespace cluon
 /*
- * Copyright (C) 2017-2018  Christian Berger
+ * Copyright (C) 2023  Group 02
  *
  * This Source Code Form is subject to the terms of the Mozilla Public
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-//#include "cluon/SharedMemory.hpp"
+//#include "cluon/CompressedRec.hpp"
+//#include "cluon/Envelope.hpp"
+//#include "cluon/FromProtoVisitor.hpp"
 
 // clang-format off
 #ifdef WIN32
-    #include <limits>
+    #include <io.h>
 #else
-    #include <cstdlib>
     #include <fcntl.h>
-    #include <sys/ipc.h>
-    #include <sys/mman.h>
-    #include <sys/sem.h>
-    #include <sys/shm.h>
     #include <sys/stat.h>
-    #include <sys/time.h>
     #include <sys/types.h>
     #include <unistd.h>
 #endif
@@ -14812,1038 +19190,1438 @@ inline float Player::checkRefillingCache(const uint32_t &numberOfEntries, float
 #include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <fstream>
-
-#if !defined(__APPLE__) && !defined(__OpenBSD__) && (defined(_SEM_SEMUN_UNDEFINED) || !defined(__FreeBSD__))
-union semun {
-    int val;               /* for SETVAL */
-    struct semid_ds *buf;  /* for IPC_STAT and IPC_SET */
-    unsigned short *array; /* for GETALL and SETALL*/
-};
-#endif
+#include <sstream>
+#include <vector>
 
 namespace cluon {
+namespace lz4 {
+
+inline std::string compress(const char *src, size_t size) noexcept {
+    enum : uint32_t {
+        MIN_MATCH     = 4,
+        LAST_LITERALS = 5,  // The last five bytes are always literals.
+        MF_LIMIT      = 12, // The last match must start at least 12 bytes before the end.
+        HASH_LOG      = 16,
+        MAX_OFFSET    = 65535,
+    };
 
-inline SharedMemory::SharedMemory(const std::string &name, uint32_t size) noexcept
-    : m_size(size) {
-    if (!name.empty()) {
-#ifdef WIN32
-        constexpr int MAX_LENGTH_NAME{MAX_PATH};
-#else
-        constexpr int MAX_LENGTH_NAME{254};
-#endif
-        const std::string n{name.substr(0, (name.size() > MAX_LENGTH_NAME ? MAX_LENGTH_NAME : name.size()))};
-        if ('/' != n[0]) {
-            m_name = "/";
-        }
+    std::string out;
+    try {
+        out.reserve(size + size / 255 + 16);
+        const uint8_t *in{reinterpret_cast<const uint8_t *>(src)};
 
-#ifndef WIN32
-#if defined(__NetBSD__) || defined(__OpenBSD__)
-        std::clog << "[cluon::SharedMemory] Found NetBSD or OpenBSD; using SysV implementation." << std::endl;
-        m_usePOSIX = false;
-#else
-        const char *CLUON_SHAREDMEMORY_POSIX = getenv("CLUON_SHAREDMEMORY_POSIX");
-        m_usePOSIX                           = ((nullptr != CLUON_SHAREDMEMORY_POSIX) && (CLUON_SHAREDMEMORY_POSIX[0] == '1'));
-        std::clog << "[cluon::SharedMemory] Using " << (m_usePOSIX ? "POSIX" : "SysV") << " implementation." << std::endl;
-#endif
-        // Define filename for timestamping.
-        if (0 != n.find("/tmp")) {
-            m_nameForTimeStamping = "/tmp" + m_name;
+        auto read32 = [in](size_t pos) {
+            uint32_t v;
+            std::memcpy(&v, in + pos, sizeof(v));
+            return v;
+        };
+        auto writeLength = [&out](size_t length) {
+            while (length >= 255) {
+                out.push_back(static_cast<char>(255));
+                length -= 255;
+            }
+            out.push_back(static_cast<char>(length));
+        };
 
-            // For NetBSD and OpenBSD or for the SysV-based implementation, we put all token files to /tmp.
-            if (!m_usePOSIX) {
-                m_name = m_nameForTimeStamping;
+        size_t anchor{0};
+        if (size > MF_LIMIT) {
+            std::vector<uint32_t> table(1u << HASH_LOG, 0);
+            const size_t MATCH_START_LIMIT{size - MF_LIMIT};
+            const size_t MATCH_END_LIMIT{size - LAST_LITERALS};
+
+            size_t ip{0};
+            while (ip < MATCH_START_LIMIT) {
+                const uint32_t SEQUENCE{read32(ip)};
+                const uint32_t HASH{(SEQUENCE * 2654435761u) >> (32 - HASH_LOG)};
+                const size_t REF{table[HASH]};
+                table[HASH] = static_cast<uint32_t>(ip);
+
+                if ((REF < ip) && ((ip - REF) <= MAX_OFFSET) && (read32(REF) == SEQUENCE)) {
+                    size_t length{MIN_MATCH};
+                    while (((ip + length) < MATCH_END_LIMIT) && (in[REF + length] == in[ip + length])) {
+                        length++;
+                    }
+
+                    const size_t LITERALS{ip - anchor};
+                    const size_t MATCH{length - MIN_MATCH};
+                    const size_t OFFSET{ip - REF};
+                    out.push_back(static_cast<char>(((LITERALS >= 15 ? 15 : LITERALS) << 4) | (MATCH >= 15 ? 15 : MATCH)));
+                    if (LITERALS >= 15) {
+                        writeLength(LITERALS - 15);
+                    }
+                    out.append(src + anchor, LITERALS);
+                    out.push_back(static_cast<char>(OFFSET & 0xFF));
+                    out.push_back(static_cast<char>(OFFSET >> 8));
+                    if (MATCH >= 15) {
+                        writeLength(MATCH - 15);
+                    }
+
+                    ip += length;
+                    anchor = ip;
+                } else {
+                    // Step faster over data that does not compress.
+                    ip += 1 + ((ip - anchor) >> 6);
+                }
             }
         }
-#endif
 
-        // Name of the shared memory.
-        {
-            m_name += n;
-            if (m_name.size() > MAX_LENGTH_NAME) {
-                m_name = m_name.substr(0, MAX_LENGTH_NAME);
+        const size_t LITERALS{size - anchor};
+        out.push_back(static_cast<char>((LITERALS >= 15 ? 15 : LITERALS) << 4));
+        if (LITERALS >= 15) {
+            writeLength(LITERALS - 15);
+        }
+        out.append(src + anchor, LITERALS);
+    } catch (...) { out.clear(); } // LCOV_EXCL_LINE
+    return out;
+}
+
+inline bool decompress(const char *src, size_t size, char *dst, size_t dstSize) noexcept {
+    const uint8_t *in{reinterpret_cast<const uint8_t *>(src)};
+    size_t ip{0};
+    size_t op{0};
+    while (ip < size) {
+        const uint8_t TOKEN{in[ip++]};
+
+        size_t literals{static_cast<size_t>(TOKEN >> 4)};
+        if (15 == literals) {
+            uint8_t b{255};
+            while (255 == b) {
+                if (ip >= size) {
+                    return false;
+                }
+                b = in[ip++];
+                literals += b;
             }
         }
+        if ((literals > (size - ip)) || (literals > (dstSize - op))) {
+            return false;
+        }
+        std::memcpy(dst + op, src + ip, literals);
+        ip += literals;
+        op += literals;
 
-        // Name of the file for timestamping.
-        {
-            m_nameForTimeStamping += n;
-            if (m_nameForTimeStamping.size() > MAX_LENGTH_NAME) {
-                m_nameForTimeStamping = m_nameForTimeStamping.substr(0, MAX_LENGTH_NAME);
+        // The last sequence consists of literals only.
+        if (ip == size) {
+            break;
+        }
+
+        if (2 > (size - ip)) {
+            return false;
+        }
+        const size_t OFFSET{static_cast<size_t>(in[ip]) | (static_cast<size_t>(in[ip + 1]) << 8)};
+        ip += 2;
+        if ((0 == OFFSET) || (OFFSET > op)) {
+            return false;
+        }
+
+        size_t length{static_cast<size_t>(TOKEN & 0x0F)};
+        if (15 == length) {
+            uint8_t b{255};
+            while (255 == b) {
+                if (ip >= size) {
+                    return false;
+                }
+                b = in[ip++];
+                length += b;
             }
         }
+        length += 4;
+        if (length > (dstSize - op)) {
+            return false;
+        }
 
-#ifdef WIN32
-        initWIN32();
-#else
-        if (m_usePOSIX) {
-            initPOSIX();
+        const char *match{dst + op - OFFSET};
+        if (OFFSET >= length) {
+            std::memcpy(dst + op, match, length);
         } else {
-            initSysV();
+            // Overlapping matches repeat the last OFFSET bytes.
+            for (size_t i{0}; i < length; i++) {
+                dst[op + i] = match[i];
+            }
         }
-#endif
-    }
-}
-
-inline SharedMemory::~SharedMemory() noexcept {
-#ifdef WIN32
-    deinitWIN32();
-#else
-    if (m_usePOSIX) {
-        deinitPOSIX();
-    } else {
-        deinitSysV();
+        op += length;
     }
-#endif
+    return (op == dstSize);
 }
 
-inline bool SharedMemory::isLocked() const noexcept {
-    return m_isLocked.load();
-}
+} // namespace lz4
 
-inline void SharedMemory::lock() noexcept {
-#ifdef WIN32
-    lockWIN32();
-#else
-    if (m_usePOSIX) {
-        lockPOSIX();
-    } else {
-        lockSysV();
-    }
-#endif
-    m_isLocked.store(true);
-}
+////////////////////////////////////////////////////////////////////////////////
 
-inline void SharedMemory::unlock() noexcept {
-#ifdef WIN32
-    unlockWIN32();
-#else
-    if (m_usePOSIX) {
-        unlockPOSIX();
-    } else {
-        unlockSysV();
-    }
-#endif
-    m_isLocked.store(false);
+inline bool CompressedRec::isCompressedRec(std::istream &in) noexcept {
+    bool retVal{false};
+    try {
+        const auto POS{in.tellg()};
+        char magic[8];
+        in.seekg(0, in.beg);
+        in.read(magic, sizeof(magic));
+        retVal = (static_cast<std::streamsize>(sizeof(magic)) == in.gcount()) && (0 == std::memcmp(magic, "CLUONBLK", sizeof(magic)));
+        in.clear();
+        in.seekg(POS);
+    } catch (...) {} // LCOV_EXCL_LINE
+    return retVal;
 }
 
-inline void SharedMemory::wait() noexcept {
-#ifdef WIN32
-    waitWIN32();
-#else
-    if (m_usePOSIX) {
-        waitPOSIX();
-    } else {
-        waitSysV();
-    }
-#endif
-}
+////////////////////////////////////////////////////////////////////////////////
 
-inline void SharedMemory::notifyAll() noexcept {
+inline CompressedRecWriter::CompressedRecWriter(const std::string &file, uint32_t blockSize) noexcept
+    : m_blockSize(blockSize) {
 #ifdef WIN32
-    notifyAllWIN32();
+    m_fd = ::_open(file.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
 #else
-    if (m_usePOSIX) {
-        notifyAllPOSIX();
+    m_fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+#endif
+    if (-1 == m_fd) {
+        std::cerr << "[cluon::CompressedRecWriter]: Failed to open '" << file << "': " << ::strerror(errno) << std::endl;
     } else {
-        notifyAllSysV();
+        char header[CompressedRec::FILE_HEADER_SIZE]{};
+        const uint32_t VERSION{htole32(CompressedRec::VERSION)};
+        std::memcpy(header, "CLUONBLK", 8);
+        std::memcpy(header + 8, &VERSION, sizeof(VERSION));
+        writeBytes(header, sizeof(header));
+        try {
+            m_block.reserve(m_blockSize);
+        } catch (...) {} // LCOV_EXCL_LINE
     }
-#endif
 }
 
-inline bool SharedMemory::setTimeStamp(const cluon::data::TimeStamp &ts) noexcept {
-    bool retVal{false};
+inline CompressedRecWriter::~CompressedRecWriter() noexcept {
+    close();
+}
 
-#ifdef WIN32
-    (void)ts;
-#else
-    if ((retVal = isLocked())) {
-#ifdef __APPLE__
-        struct timeval accessedTime;
-        accessedTime.tv_sec = 0;
-        accessedTime.tv_usec = 0;
+inline bool CompressedRecWriter::isOpen() const noexcept {
+    return (-1 != m_fd);
+}
 
-        struct timeval modifiedTime;
-        modifiedTime.tv_sec = ts.seconds();
-        modifiedTime.tv_usec = ts.microseconds();
+inline uint64_t CompressedRecWriter::uncompressedBytes() const noexcept {
+    return m_uncompressedBytes;
+}
 
-        struct timeval times[2]{accessedTime, modifiedTime};
-        if (0 != futimes(m_fdForTimeStamping, times)) {
-            std::cerr << "[cluon::SharedMemory] Failed to set time stamp: '" << strerror(errno) << "' (" << errno << "): " << std::endl;
-            retVal = false;
-        }
-#else
-        struct timespec accessedTime;
-        accessedTime.tv_sec = 0;
-        accessedTime.tv_nsec = UTIME_OMIT;
+inline uint64_t CompressedRecWriter::compressedBytes() const noexcept {
+    return m_fileOffset;
+}
 
-        struct timespec modifiedTime;
-        modifiedTime.tv_sec = ts.seconds();
-        modifiedTime.tv_nsec = ts.microseconds()*1000;
+inline void CompressedRecWriter::append(const char *serializedEnvelope, size_t size, int64_t sampleTimeStamp) noexcept {
+    if (-1 != m_fd) {
+        try {
+            if (!m_block.empty() && ((m_block.size() + size) > m_blockSize)) {
+                writeBlock();
+            }
 
-        struct timespec times[2]{accessedTime, modifiedTime};
-        if (0 != futimens(m_fdForTimeStamping, times)) {
-            std::cerr << "[cluon::SharedMemory] Failed to set time stamp: '" << strerror(errno) << "' (" << errno << "): " << std::endl; // LCOV_EXCL_LINE
-            retVal = false; // LCOV_EXCL_LINE
-        }
-#endif
-    }
-#endif
+            CompressedRec::Entry entry;
+            entry.m_sampleTimeStamp = sampleTimeStamp;
+            entry.m_block           = static_cast<uint32_t>(m_blocks.size());
+            entry.m_offsetInBlock   = static_cast<uint32_t>(m_block.size());
+            m_entries.push_back(entry);
 
-    return retVal;
+            m_block.append(serializedEnvelope, size);
+            m_envelopesInBlock++;
+            m_uncompressedBytes += size;
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
 }
 
-inline std::pair<bool, cluon::data::TimeStamp> SharedMemory::getTimeStamp() noexcept {
-    bool retVal{false};
-    cluon::data::TimeStamp sampleTimeStamp;
+inline void CompressedRecWriter::writeBlock() noexcept {
+    if (!m_block.empty()) {
+        std::string compressed{lz4::compress(m_block.data(), m_block.size())};
 
-#ifndef WIN32
-    if ((retVal = isLocked())) {
-        struct stat fileStatus;
-        auto r = fstat(m_fdForTimeStamping, &fileStatus);
-        if (0 == r) {
-#ifdef __APPLE__
-            sampleTimeStamp.seconds(static_cast<int32_t>(fileStatus.st_mtimespec.tv_sec))
-                           .microseconds(static_cast<int32_t>(fileStatus.st_mtimespec.tv_nsec/1000));
+        CompressedRec::Block block;
+        block.m_fileOffset        = m_fileOffset;
+        block.m_uncompressedSize  = static_cast<uint32_t>(m_block.size());
+        block.m_numberOfEnvelopes = m_envelopesInBlock;
+        // Already compressed payloads like h264 frames are stored as they are.
+        block.m_codec          = (!compressed.empty() && (compressed.size() < m_block.size())) ? CompressedRec::LZ4 : CompressedRec::STORED;
+        block.m_compressedSize = (CompressedRec::LZ4 == block.m_codec) ? static_cast<uint32_t>(compressed.size()) : block.m_uncompressedSize;
+
+        char header[CompressedRec::BLOCK_HEADER_SIZE];
+        const uint32_t FIELDS[]{htole32(block.m_codec), htole32(block.m_compressedSize), htole32(block.m_uncompressedSize), htole32(block.m_numberOfEnvelopes)};
+        std::memcpy(header, "CBLK", 4);
+        std::memcpy(header + 4, FIELDS, sizeof(FIELDS));
+        writeBytes(header, sizeof(header));
+        if (CompressedRec::LZ4 == block.m_codec) {
+            writeBytes(compressed.data(), compressed.size());
+        } else {
+            writeBytes(m_block.data(), m_block.size());
+        }
+
+        try {
+            m_blocks.push_back(block);
+        } catch (...) {} // LCOV_EXCL_LINE
+        m_block.clear();
+        m_envelopesInBlock = 0;
+    }
+}
+
+inline void CompressedRecWriter::writeBytes(const char *data, size_t size) noexcept {
+    size_t written{0};
+    while ((-1 != m_fd) && (written < size)) {
+#ifdef WIN32
+        const int n{::_write(m_fd, data + written, static_cast<unsigned int>(size - written))};
 #else
-            sampleTimeStamp.seconds(static_cast<int32_t>(fileStatus.st_mtim.tv_sec))
-                           .microseconds(static_cast<int32_t>(fileStatus.st_mtim.tv_nsec/1000));
+        const ssize_t n{::write(m_fd, data + written, size - written)};
 #endif
+        if (0 > n) {
+            if (EINTR == errno) {
+                continue;
+            }
+            std::cerr << "[cluon::CompressedRecWriter]: Failed to write: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+            break;                                                                                            // LCOV_EXCL_LINE
         }
+        written += static_cast<size_t>(n);
     }
-#endif
-
-    return std::make_pair(retVal, sampleTimeStamp);
+    m_fileOffset += written;
 }
 
-inline bool SharedMemory::valid() noexcept {
-    bool valid{!m_broken.load()};
-    valid &= (nullptr != m_sharedMemory);
-    valid &= (0 < m_size);
-#ifndef WIN32
-    if (m_usePOSIX) {
-        valid &= validPOSIX();
-    } else {
-        valid &= validSysV();
+inline void CompressedRecWriter::close() noexcept {
+    if (-1 != m_fd) {
+        writeBlock();
+
+        try {
+            std::string index;
+            index.reserve(16 + m_blocks.size() * 24 + m_entries.size() * 16);
+            auto put = [&index](const void *value, size_t size) { index.append(static_cast<const char *>(value), size); };
+
+            const uint32_t NUMBER_OF_BLOCKS{htole32(static_cast<uint32_t>(m_blocks.size()))};
+            index.append("CIDX", 4);
+            put(&NUMBER_OF_BLOCKS, sizeof(NUMBER_OF_BLOCKS));
+            for (const auto &b : m_blocks) {
+                const uint64_t OFFSET{htole64(b.m_fileOffset)};
+                const uint32_t FIELDS[]{htole32(b.m_compressedSize), htole32(b.m_uncompressedSize), htole32(b.m_codec), htole32(b.m_numberOfEnvelopes)};
+                put(&OFFSET, sizeof(OFFSET));
+                put(FIELDS, sizeof(FIELDS));
+            }
+            const uint64_t NUMBER_OF_ENVELOPES{htole64(static_cast<uint64_t>(m_entries.size()))};
+            put(&NUMBER_OF_ENVELOPES, sizeof(NUMBER_OF_ENVELOPES));
+            for (const auto &e : m_entries) {
+                const uint64_t TIMESTAMP{htole64(static_cast<uint64_t>(e.m_sampleTimeStamp))};
+                const uint32_t FIELDS[]{htole32(e.m_block), htole32(e.m_offsetInBlock)};
+                put(&TIMESTAMP, sizeof(TIMESTAMP));
+                put(FIELDS, sizeof(FIELDS));
+            }
+
+            const uint64_t INDEX_OFFSET{htole64(m_fileOffset)};
+            put(&INDEX_OFFSET, sizeof(INDEX_OFFSET));
+            index.append("CLUONEND", 8);
+            writeBytes(index.data(), index.size());
+        } catch (...) {} // LCOV_EXCL_LINE
+
+#ifdef WIN32
+        ::_close(m_fd);
+#else
+        ::close(m_fd);
+#endif
+        m_fd = -1;
     }
+}
+
+inline void CompressedRecWriter::sync() noexcept {
+    if (-1 != m_fd) {
+#ifdef WIN32
+        ::_commit(m_fd);
+#elif defined(__linux__)
+        ::fdatasync(m_fd);
+#else
+        ::fsync(m_fd);
 #endif
-    return valid;
+    }
 }
 
-inline char *SharedMemory::data() noexcept {
-    return m_userAccessibleSharedMemory;
+////////////////////////////////////////////////////////////////////////////////
+
+inline CompressedRecReader::~CompressedRecReader() noexcept {
+    try {
+        if (m_nextBlock.valid()) {
+            m_nextBlock.wait();
+        }
+    } catch (...) {} // LCOV_EXCL_LINE
 }
 
-inline uint32_t SharedMemory::size() const noexcept {
-    return m_size;
+inline uint32_t CompressedRecReader::numberOfBlocks() const noexcept {
+    return static_cast<uint32_t>(m_blocks.size());
 }
 
-inline const std::string SharedMemory::name() const noexcept {
-    return m_name;
+inline std::vector<CompressedRec::Entry> CompressedRecReader::readIndex(std::istream &in) noexcept {
+    std::vector<CompressedRec::Entry> entries;
+    try {
+        if (m_nextBlock.valid()) {
+            m_nextBlock.wait();
+        }
+        m_nextBlock          = std::future<std::string>();
+        m_nextBlockNumber    = 0xFFFFFFFF;
+        m_currentBlockNumber = 0xFFFFFFFF;
+        m_currentBlock.clear();
+        m_blocks.clear();
+
+        auto get32 = [](const char *p) {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return le32toh(v);
+        };
+        auto get64 = [](const char *p) {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return le64toh(v);
+        };
+
+        in.clear();
+        in.seekg(0, in.end);
+        const uint64_t FILE_LENGTH{static_cast<uint64_t>(in.tellg())};
+
+        // Try the index at the end of the file first.
+        bool indexValid{false};
+        if (FILE_LENGTH >= (CompressedRec::FILE_HEADER_SIZE + CompressedRec::FOOTER_SIZE)) {
+            char footer[CompressedRec::FOOTER_SIZE];
+            in.seekg(static_cast<std::streamoff>(FILE_LENGTH - CompressedRec::FOOTER_SIZE));
+            in.read(footer, sizeof(footer));
+            const uint64_t INDEX_OFFSET{get64(footer)};
+            if ((static_cast<std::streamsize>(sizeof(footer)) == in.gcount()) && (0 == std::memcmp(footer + 8, "CLUONEND", 8))
+                && (INDEX_OFFSET >= CompressedRec::FILE_HEADER_SIZE) && (INDEX_OFFSET < (FILE_LENGTH - CompressedRec::FOOTER_SIZE))) {
+                std::string index(static_cast<size_t>(FILE_LENGTH - CompressedRec::FOOTER_SIZE - INDEX_OFFSET), '\0');
+                in.seekg(static_cast<std::streamoff>(INDEX_OFFSET));
+                in.read(&index[0], static_cast<std::streamsize>(index.size()));
+
+                const char *p{index.data()};
+                const char *END{index.data() + index.size()};
+                if ((static_cast<std::streamsize>(index.size()) == in.gcount()) && (8 <= index.size()) && (0 == std::memcmp(p, "CIDX", 4))) {
+                    const uint64_t NUMBER_OF_BLOCKS{get32(p + 4)};
+                    p += 8;
+                    if ((NUMBER_OF_BLOCKS * 24 + 8) <= static_cast<uint64_t>(END - p)) {
+                        for (uint64_t i{0}; i < NUMBER_OF_BLOCKS; i++, p += 24) {
+                            CompressedRec::Block b;
+                            b.m_fileOffset        = get64(p);
+                            b.m_compressedSize    = get32(p + 8);
+                            b.m_uncompressedSize  = get32(p + 12);
+                            b.m_codec             = get32(p + 16);
+                            b.m_numberOfEnvelopes = get32(p + 20);
+                            m_blocks.push_back(b);
+                        }
+                        const uint64_t NUMBER_OF_ENVELOPES{get64(p)};
+                        p += 8;
+                        if ((NUMBER_OF_ENVELOPES * 16) == static_cast<uint64_t>(END - p)) {
+                            entries.reserve(static_cast<size_t>(NUMBER_OF_ENVELOPES));
+                            for (uint64_t i{0}; i < NUMBER_OF_ENVELOPES; i++, p += 16) {
+                                CompressedRec::Entry e;
+                                e.m_sampleTimeStamp = static_cast<int64_t>(get64(p));
+                                e.m_block           = get32(p + 8);
+                                e.m_offsetInBlock   = get32(p + 12);
+                                entries.push_back(e);
+                            }
+                            indexValid = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (!indexValid) {
+            // The recording was not closed properly; walk through all blocks instead.
+            m_blocks.clear();
+            entries.clear();
+            uint64_t pos{CompressedRec::FILE_HEADER_SIZE};
+            while ((pos + CompressedRec::BLOCK_HEADER_SIZE) <= FILE_LENGTH) {
+                char header[CompressedRec::BLOCK_HEADER_SIZE];
+                in.clear();
+                in.seekg(static_cast<std::streamoff>(pos));
+                in.read(header, sizeof(header));
+                if ((static_cast<std::streamsize>(sizeof(header)) != in.gcount()) || (0 != std::memcmp(header, "CBLK", 4))) {
+                    break;
+                }
+
+                CompressedRec::Block b;
+                b.m_fileOffset        = pos;
+                b.m_codec             = get32(header + 4);
+                b.m_compressedSize    = get32(header + 8);
+                b.m_uncompressedSize  = get32(header + 12);
+                b.m_numberOfEnvelopes = get32(header + 16);
+                if ((pos + CompressedRec::BLOCK_HEADER_SIZE + b.m_compressedSize) > FILE_LENGTH) {
+                    break;
+                }
+                m_blocks.push_back(b);
+
+                const uint32_t BLOCK_NUMBER{static_cast<uint32_t>(m_blocks.size() - 1)};
+                const std::string BLOCK{decompressBlock(BLOCK_NUMBER, readCompressedBlock(in, BLOCK_NUMBER))};
+                uint32_t offset{0};
+                uint32_t length{0};
+                auto retVal = decodeEnvelope(BLOCK, offset, length);
+                while (retVal.first) {
+                    CompressedRec::Entry e;
+                    e.m_sampleTimeStamp = cluon::time::toMicroseconds(retVal.second.sampleTimeStamp());
+                    e.m_block           = BLOCK_NUMBER;
+                    e.m_offsetInBlock   = offset;
+                    entries.push_back(e);
+
+                    offset += length;
+                    retVal = decodeEnvelope(BLOCK, offset, length);
+                }
+                pos += CompressedRec::BLOCK_HEADER_SIZE + b.m_compressedSize;
+            }
+            std::clog << "[cluon::CompressedRecReader]: Index missing; recovered " << entries.size() << " entries from " << m_blocks.size() << " blocks."
+                      << std::endl;
+        }
+        in.clear();
+    } catch (...) {} // LCOV_EXCL_LINE
+    return entries;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// Platform-dependent implementations.
-#ifdef WIN32
-inline void SharedMemory::initWIN32() noexcept {
-    std::string mutexName = m_name;
-    if (mutexName.size() > MAX_PATH) {
-        mutexName = mutexName.substr(0, MAX_PATH - 6);
+inline std::pair<bool, cluon::data::Envelope> CompressedRecReader::readEnvelope(std::istream &in, uint64_t position) noexcept {
+    const uint32_t BLOCK_NUMBER{static_cast<uint32_t>(position >> 32)};
+    const uint32_t OFFSET{static_cast<uint32_t>(position & 0xFFFFFFFF)};
+    if (BLOCK_NUMBER >= m_blocks.size()) {
+        return std::make_pair(false, cluon::data::Envelope());
     }
-    const std::string conditionEventName = mutexName + "_event";
-    mutexName += "_mutex";
 
-    if (0 < m_size) {
-        // Create a shared memory area and semaphores.
-        const LONG MUTEX_INITIAL_COUNT = 1;
-        const LONG MUTEX_MAX_COUNT     = 1;
-        const DWORD FLAGS              = 0; // Reserved.
-        __mutex                        = CreateSemaphoreEx(NULL, MUTEX_INITIAL_COUNT, MUTEX_MAX_COUNT, mutexName.c_str(), FLAGS, SEMAPHORE_ALL_ACCESS);
-        if (nullptr != __mutex) {
-            __conditionEvent = CreateEvent(
-                NULL /*use default security*/, TRUE /*manually resetting event*/, FALSE /*initial state is not signaled*/, conditionEventName.c_str());
-            if (nullptr != __conditionEvent) {
-                __sharedMemory = CreateFileMapping(INVALID_HANDLE_VALUE /*use paging file*/,
-                                                   NULL /*use default security*/,
-                                                   PAGE_READWRITE,
-                                                   0,
-                                                   m_size + sizeof(uint32_t) /*size + size-information (uint32_t)*/,
-                                                   m_name.c_str());
-                if (nullptr != __sharedMemory) {
-                    m_sharedMemory = (char *)MapViewOfFile(__sharedMemory, FILE_MAP_ALL_ACCESS, 0, 0, m_size + sizeof(uint32_t));
-                    if (nullptr != m_sharedMemory) {
-                        // Provide size information at the beginning of the shared memory.
-                        *(uint32_t *)m_sharedMemory  = m_size;
-                        m_userAccessibleSharedMemory = m_sharedMemory + sizeof(uint32_t);
-                    } else {
-                        std::cerr << "[cluon::SharedMemory] Failed to map shared memory '" << m_name << "': "
-                                  << " (" << GetLastError() << ")" << std::endl;
-                        CloseHandle(__sharedMemory);
-                        __sharedMemory = nullptr;
+    try {
+        if (BLOCK_NUMBER != m_currentBlockNumber) {
+            if (m_nextBlock.valid() && (BLOCK_NUMBER == m_nextBlockNumber)) {
+                m_currentBlock = m_nextBlock.get();
+            } else {
+                // After seeking, the prefetched block is not needed anymore.
+                if (m_nextBlock.valid()) {
+                    m_nextBlock.wait();
+                }
+                m_currentBlock = decompressBlock(BLOCK_NUMBER, readCompressedBlock(in, BLOCK_NUMBER));
+            }
+            m_currentBlockNumber = BLOCK_NUMBER;
+            m_nextBlock          = std::future<std::string>();
+            m_nextBlockNumber    = 0xFFFFFFFF;
+
+            // Decompress the following block while the current one is consumed.
+            const uint32_t NEXT{BLOCK_NUMBER + 1};
+            if (NEXT < m_blocks.size()) {
+                std::string compressed{readCompressedBlock(in, NEXT)};
+                m_nextBlock = std::async(std::launch::async, [this, NEXT, c = std::move(compressed)]() mutable { return decompressBlock(NEXT, std::move(c)); });
+                m_nextBlockNumber = NEXT;
+            }
+        }
+    } catch (...) {} // LCOV_EXCL_LINE
 
-                        CloseHandle(__conditionEvent);
-                        __conditionEvent = nullptr;
+    uint32_t length{0};
+    return decodeEnvelope(m_currentBlock, OFFSET, length);
+}
 
-                        CloseHandle(__mutex);
-                        __mutex = nullptr;
-                    }
-                } else {
-                    std::cerr << "[cluon::SharedMemory] Failed to request shared memory '" << m_name << "': "
-                              << " (" << GetLastError() << ")" << std::endl;
-                    CloseHandle(__conditionEvent);
-                    __conditionEvent = nullptr;
+inline std::string CompressedRecReader::readCompressedBlock(std::istream &in, uint32_t block) noexcept {
+    std::string data;
+    try {
+        const CompressedRec::Block &B{m_blocks.at(block)};
+        data.resize(B.m_compressedSize);
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(B.m_fileOffset + CompressedRec::BLOCK_HEADER_SIZE));
+        in.read(&data[0], static_cast<std::streamsize>(data.size()));
+        if (static_cast<std::streamsize>(data.size()) != in.gcount()) {
+            data.clear();
+        }
+    } catch (...) { data.clear(); } // LCOV_EXCL_LINE
+    return data;
+}
 
-                    CloseHandle(__mutex);
-                    __mutex = nullptr;
+inline std::string CompressedRecReader::decompressBlock(uint32_t block, std::string &&compressed) const noexcept {
+    std::string data;
+    try {
+        const CompressedRec::Block &B{m_blocks.at(block)};
+        if (compressed.size() == B.m_compressedSize) {
+            if (CompressedRec::STORED == B.m_codec) {
+                data = std::move(compressed);
+            } else if (CompressedRec::LZ4 == B.m_codec) {
+                data.resize(B.m_uncompressedSize);
+                if (!lz4::decompress(compressed.data(), compressed.size(), &data[0], data.size())) {
+                    data.clear();
                 }
-            } else {
-                std::cerr << "[cluon::SharedMemory] Failed to request event '" << conditionEventName << "': "
-                          << " (" << GetLastError() << ")" << std::endl;
-                CloseHandle(__conditionEvent);
-                __conditionEvent = nullptr;
+            }
+        }
+        if (data.size() != B.m_uncompressedSize) {
+            std::cerr << "[cluon::CompressedRecReader]: Block " << block << " is corrupt." << std::endl;
+            data.clear();
+        }
+    } catch (...) { data.clear(); } // LCOV_EXCL_LINE
+    return data;
+}
 
-                CloseHandle(__mutex);
-                __mutex = nullptr;
+inline std::pair<bool, cluon::data::Envelope> CompressedRecReader::decodeEnvelope(const std::string &block, uint32_t offset, uint32_t &length) noexcept {
+    bool retVal{false};
+    cluon::data::Envelope env;
+    constexpr uint32_t OD4_HEADER_SIZE{5};
+    if ((static_cast<uint64_t>(offset) + OD4_HEADER_SIZE) <= block.size()) {
+        const uint8_t *p{reinterpret_cast<const uint8_t *>(block.data()) + offset};
+        if ((0x0D == p[0]) && (0xA4 == p[1])) {
+            const uint32_t LENGTH{static_cast<uint32_t>(p[2]) | (static_cast<uint32_t>(p[3]) << 8) | (static_cast<uint32_t>(p[4]) << 16)};
+            if ((static_cast<uint64_t>(offset) + OD4_HEADER_SIZE + LENGTH) <= block.size()) {
+                try {
+                    std::stringstream sstr(block.substr(offset + OD4_HEADER_SIZE, LENGTH));
+                    cluon::FromProtoVisitor protoDecoder;
+                    protoDecoder.decodeFrom(sstr, env);
+                    length = OD4_HEADER_SIZE + LENGTH;
+                    retVal = true;
+                } catch (...) {} // LCOV_EXCL_LINE
             }
-        } else {
-            std::cerr << "[cluon::SharedMemory] Failed to create mutex '" << mutexName << "': "
-                      << " (" << GetLastError() << ")" << std::endl;
-            CloseHandle(__mutex);
-            __mutex = nullptr;
         }
-    } else {
-        // Open a shared memory area and semaphores.
-        m_hasOnlyAttachedToSharedMemory = true;
-        const BOOL INHERIT_HANDLE       = FALSE;
-        __mutex                         = OpenSemaphore(SEMAPHORE_ALL_ACCESS, INHERIT_HANDLE, mutexName.c_str());
-        if (nullptr != __mutex) {
-            __conditionEvent = OpenEvent(EVENT_ALL_ACCESS, FALSE /*do not inherit the name*/, conditionEventName.c_str());
-            if (nullptr != __conditionEvent) {
-                __sharedMemory = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE /*do not inherit the name*/, m_name.c_str());
-                if (nullptr != __sharedMemory) {
-                    // Firstly, map only for the size of a uint32_t to read the entire size.
-                    m_sharedMemory = (char *)MapViewOfFile(__sharedMemory, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(uint32_t));
-                    if (nullptr != m_sharedMemory) {
-                        //  Now, read the real size...
-                        m_size = *(uint32_t *)m_sharedMemory;
-                        // ..unmap and re-map.
-                        UnmapViewOfFile(m_sharedMemory);
-                        m_sharedMemory = (char *)MapViewOfFile(__sharedMemory, FILE_MAP_ALL_ACCESS, 0, 0, m_size + sizeof(uint32_t));
-                        if (nullptr != m_sharedMemory) {
-                            m_userAccessibleSharedMemory = m_sharedMemory + sizeof(uint32_t);
-                        } else {
-                            std::cerr << "[cluon::SharedMemory] Failed to finally map shared memory '" << m_name << "': "
-                                      << " (" << GetLastError() << ")" << std::endl;
-                            CloseHandle(__sharedMemory);
-                            __sharedMemory = nullptr;
+    }
+    return std::make_pair(retVal, env);
+}
 
-                            CloseHandle(__conditionEvent);
-                            __conditionEvent = nullptr;
+} // namespace cluon
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-                            CloseHandle(__mutex);
-                            __mutex = nullptr;
-                        }
-                    } else {
-                        std::cerr << "[cluon::SharedMemory] Failed to temporarily map shared memory '" << m_name << "': "
-                                  << " (" << GetLastError() << ")" << std::endl;
-                        CloseHandle(__sharedMemory);
-                        __sharedMemory = nullptr;
+//#include "cluon/MergedPlayer.hpp"
+//#include "cluon/CompressedRec.hpp"
+//#include "cluon/Envelope.hpp"
+//#include "cluon/Recorder.hpp"
+//#include "cluon/Time.hpp"
 
-                        CloseHandle(__conditionEvent);
-                        __conditionEvent = nullptr;
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
 
-                        CloseHandle(__mutex);
-                        __mutex = nullptr;
-                    }
-                } else {
-                    std::cerr << "[cluon::SharedMemory] Failed to open shared memory '" << m_name << "': "
-                              << " (" << GetLastError() << ")" << std::endl;
-                    CloseHandle(__conditionEvent);
-                    __conditionEvent = nullptr;
+namespace cluon {
 
-                    CloseHandle(__mutex);
-                    __mutex = nullptr;
-                }
-            } else {
-                std::cerr << "[cluon::SharedMemory] Failed to open event '" << conditionEventName << "': "
-                          << " (" << GetLastError() << ")" << std::endl;
-                CloseHandle(__conditionEvent);
-                __conditionEvent = nullptr;
+inline MergedPlayer::MergedPlayer(const std::vector<std::string> &files, const bool &autoRewind, uint64_t maxBufferedBytes) noexcept
+    : m_autoRewind(autoRewind) {
+    m_maxBufferedBytesPerFile = (std::max<uint64_t>)(maxBufferedBytes / (std::max<uint64_t>)(files.size(), 1), 1);
 
-                CloseHandle(__mutex);
-                __mutex = nullptr;
+    m_firstSampleTimeStamp = (std::numeric_limits<int64_t>::max)();
+    m_lastSampleTimeStamp  = (std::numeric_limits<int64_t>::min)();
+    try {
+        for (const auto &file : files) {
+            std::unique_ptr<Cursor> cursor{new Cursor()};
+            cursor->m_file = file;
+            initializeIndex(*cursor);
+            if (!cursor->m_index.empty()) {
+                m_totalNumberOfEnvelopes += static_cast<uint32_t>(cursor->m_index.size());
+                m_firstSampleTimeStamp = (std::min)(m_firstSampleTimeStamp, cursor->m_index.front().first);
+                m_lastSampleTimeStamp  = (std::max)(m_lastSampleTimeStamp, cursor->m_index.back().first);
             }
-        } else {
-            std::cerr << "[cluon::SharedMemory] Failed to open mutex '" << mutexName << "': "
-                      << " (" << GetLastError() << ")" << std::endl;
-            CloseHandle(__mutex);
-            __mutex = nullptr;
+            m_cursors.push_back(std::move(cursor));
         }
+    } catch (...) {} // LCOV_EXCL_LINE
+    if (0 == m_totalNumberOfEnvelopes) {
+        m_firstSampleTimeStamp = m_lastSampleTimeStamp = 0;
     }
-}
+    std::clog << "[cluon::MergedPlayer]: Merging " << m_cursors.size() << " files with " << m_totalNumberOfEnvelopes << " entries in total." << std::endl;
 
-inline void SharedMemory::deinitWIN32() noexcept {
-    if (nullptr != __conditionEvent) {
-        SetEvent(__conditionEvent);
-        CloseHandle(__conditionEvent);
-    }
-    if (nullptr != __mutex) {
-        unlock();
-        CloseHandle(__mutex);
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        resetTo(m_firstSampleTimeStamp);
     }
-    if (nullptr != m_sharedMemory) {
-        UnmapViewOfFile(m_sharedMemory);
+    try {
+        m_readAheadThread = std::thread(&MergedPlayer::readAhead, this);
+    } catch (...) { m_running = false; } // LCOV_EXCL_LINE
+}
+
+inline MergedPlayer::~MergedPlayer() {
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        m_running = false;
     }
-    if (nullptr != __sharedMemory) {
-        CloseHandle(__sharedMemory);
+    m_readAheadCondition.notify_all();
+    m_envelopeAvailableCondition.notify_all();
+    if (m_readAheadThread.joinable()) {
+        m_readAheadThread.join();
     }
 }
 
-inline void SharedMemory::lockWIN32() noexcept {
-    if (nullptr != __mutex) {
-        if (0 != WaitForSingleObject(__mutex, INFINITE)) {
-            m_broken.store(true);
-        }
-    }
+////////////////////////////////////////////////////////////////////////
+
+inline void MergedPlayer::setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept {
+    std::lock_guard<std::mutex> lck(m_playerListenerMutex);
+    m_playerListener = playerListener;
 }
 
-inline void SharedMemory::unlockWIN32() noexcept {
-    if (nullptr != __mutex) {
-        const LONG RELEASE_COUNT = 1;
-        if (/* Testing for equality with 0 is correct according to MSDN reference. */ 0 == ReleaseSemaphore(__mutex, RELEASE_COUNT, 0)) {
-            m_broken.store(true);
-        }
+////////////////////////////////////////////////////////////////////////
+
+inline void MergedPlayer::initializeIndex(Cursor &cursor) noexcept {
+    cursor.m_recFile.open(cursor.m_file.c_str(), std::ios_base::in | std::ios_base::binary); /* Flawfinder: ignore */
+    if (!cursor.m_recFile.good()) {
+        std::clog << "[cluon::MergedPlayer]: " << cursor.m_file << " could not be opened." << std::endl;
+        return;
     }
+
+    std::string source;
+    try {
+        if (CompressedRec::isCompressedRec(cursor.m_recFile)) {
+            cursor.m_compressedRecReader.reset(new CompressedRecReader());
+            for (const auto &e : cursor.m_compressedRecReader->readIndex(cursor.m_recFile)) {
+                cursor.m_index.emplace_back(e.m_sampleTimeStamp, CompressedRec::position(e.m_block, e.m_offsetInBlock));
+            }
+            source = "compressed index";
+        } else if (readSidecarIndex(cursor)) {
+            source = "sidecar index";
+        } else {
+            // Read complete file and store file positions to envelopes.
+            cursor.m_recFile.clear();
+            cursor.m_recFile.seekg(0, cursor.m_recFile.beg);
+            while (cursor.m_recFile.good()) {
+                const uint64_t POS_BEFORE = static_cast<uint64_t>(cursor.m_recFile.tellg());
+                auto retVal               = extractEnvelope(cursor.m_recFile);
+                if (!cursor.m_recFile.eof() && retVal.first) {
+                    cursor.m_index.emplace_back(cluon::time::toMicroseconds(retVal.second.sampleTimeStamp()), POS_BEFORE);
+                }
+            }
+            source = "scan";
+        }
+
+        // Keep the order from the file for Envelopes with the same sample time stamp.
+        std::stable_sort(cursor.m_index.begin(), cursor.m_index.end(), [](const std::pair<int64_t, uint64_t> &a, const std::pair<int64_t, uint64_t> &b) {
+            return a.first < b.first;
+        });
+    } catch (...) {} // LCOV_EXCL_LINE
+    cursor.m_recFile.clear();
+
+    std::clog << "[cluon::MergedPlayer]: " << cursor.m_file << " contains " << cursor.m_index.size() << " entries (from " << source << ")." << std::endl;
 }
 
-inline void SharedMemory::waitWIN32() noexcept {
-    if (nullptr != __conditionEvent) {
-        if (0 != WaitForSingleObject(__conditionEvent, INFINITE)) {
-            m_broken.store(true);
+inline bool MergedPlayer::readSidecarIndex(Cursor &cursor) noexcept {
+    bool retVal{false};
+    try {
+        std::fstream idx((cursor.m_file + ".idx").c_str(), std::ios_base::in | std::ios_base::binary);
+        if (idx.good()) {
+            cursor.m_recFile.clear();
+            cursor.m_recFile.seekg(0, cursor.m_recFile.end);
+            const uint64_t FILE_LENGTH{static_cast<uint64_t>(cursor.m_recFile.tellg())};
+
+            char header[12];
+            idx.read(header, sizeof(header));
+            uint32_t version{0};
+            std::memcpy(&version, header + 8, sizeof(version));
+            if ((static_cast<std::streamsize>(sizeof(header)) == idx.gcount()) && (0 == std::memcmp(header, Recorder::INDEX_FILE_MAGIC, 8))
+                && (Recorder::INDEX_FILE_VERSION == le32toh(version))) {
+                Recorder::IndexFileEntry entry;
+                retVal = true;
+                while (retVal && idx.read(reinterpret_cast<char *>(&entry), sizeof(entry))) {
+                    const uint64_t POSITION{le64toh(entry.filePosition)};
+                    // An index that does not match the file is ignored entirely.
+                    retVal = (POSITION < FILE_LENGTH);
+                    cursor.m_index.emplace_back(static_cast<int64_t>(le64toh(static_cast<uint64_t>(entry.sampleTimeStamp))), POSITION);
+                }
+                // The last Envelope must end exactly at the end of the file; otherwise, the index is incomplete.
+                if (retVal && !cursor.m_index.empty()) {
+                    cursor.m_recFile.clear();
+                    cursor.m_recFile.seekg(static_cast<std::streamoff>(cursor.m_index.back().second));
+                    retVal = extractEnvelope(cursor.m_recFile).first && (FILE_LENGTH == static_cast<uint64_t>(cursor.m_recFile.tellg()));
+                } else {
+                    retVal = false;
+                }
+            }
         }
+    } catch (...) { retVal = false; } // LCOV_EXCL_LINE
+    if (!retVal) {
+        cursor.m_index.clear();
     }
+    return retVal;
 }
 
-inline void SharedMemory::notifyAllWIN32() noexcept {
-    if (nullptr != __conditionEvent) {
-        if (/* Testing for equality with 0 is correct according to MSDN reference. */ 0 == SetEvent(__conditionEvent)) {
-            m_broken.store(true);
-        }
-        if (/* Testing for equality with 0 is correct according to MSDN reference. */ 0 == ResetEvent(__conditionEvent)) {
-            m_broken.store(true);
-        }
+inline std::pair<bool, cluon::data::Envelope> MergedPlayer::readEnvelope(Cursor &cursor, uint64_t position) noexcept {
+    if (cursor.m_compressedRecReader) {
+        return cursor.m_compressedRecReader->readEnvelope(cursor.m_recFile, position);
     }
+    cursor.m_recFile.clear();
+    cursor.m_recFile.seekg(static_cast<std::streamoff>(position));
+    return extractEnvelope(cursor.m_recFile);
 }
 
-#else /* POSIX and SysV */
+////////////////////////////////////////////////////////////////////////
 
-inline void SharedMemory::initPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    // If size is greater than 0, the caller wants to create a new shared
-    // memory area. Otherwise, the caller wants to open an existing shared memory.
-    int flags = O_RDWR;
-    if (0 < m_size) {
-        flags |= O_CREAT | O_EXCL;
-    }
+inline void MergedPlayer::resetTo(int64_t sampleTimeStamp) noexcept {
+    try {
+        // Data that is currently read ahead belongs to the previous position.
+        m_generation++;
 
-    m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
-    if (-1 == m_fd) {
-// clang-format off
-        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to open shared memory '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl;
-// clang-format on
-        // Try to remove existing shared memory segment and try again.
-        if ((flags & O_CREAT) == O_CREAT) {
-            std::clog << "[cluon::SharedMemory (POSIX)] Trying to remove existing shared memory '" << m_name << "' and trying again... ";
-            if (0 == ::shm_unlink(m_name.c_str())) {
-                m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
-            }
+        m_heap                             = decltype(m_heap)();
+        m_hasPreviousSampleTimeStamp       = false;
+        m_delay                            = 0;
+        m_numberOfReturnedEnvelopesInTotal = 0;
+        for (size_t i{0}; i < m_cursors.size(); i++) {
+            Cursor &c{*m_cursors[i]};
+            auto it = std::lower_bound(c.m_index.begin(), c.m_index.end(), sampleTimeStamp, [](const std::pair<int64_t, uint64_t> &e, int64_t ts) {
+                return e.first < ts;
+            });
+            c.m_nextToReplay = c.m_nextToRead = static_cast<size_t>(it - c.m_index.begin());
+            c.m_buffered.clear();
+            c.m_bufferedBytes = 0;
 
-            if (-1 == m_fd) {
-                std::cerr << "failed: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-            } else {
-                std::cerr << "succeeded." << std::endl;
+            m_numberOfReturnedEnvelopesInTotal += c.m_nextToReplay;
+            if (c.m_nextToReplay < c.m_index.size()) {
+                m_heap.push(std::make_pair(c.m_index[c.m_nextToReplay].first, i));
             }
         }
-    }
+    } catch (...) {} // LCOV_EXCL_LINE
+    m_readAheadCondition.notify_all();
+}
 
-    if (-1 != m_fd) {
-        bool retVal{true};
+inline std::pair<bool, cluon::data::Envelope> MergedPlayer::getNextEnvelopeToBeReplayed() noexcept {
+    try {
+        std::unique_lock<std::mutex> lck(m_mutex);
+        while (m_running) {
+            if (m_heap.empty()) {
+                if (!m_autoRewind || (0 == m_totalNumberOfEnvelopes)) {
+                    break;
+                }
+                resetTo(m_firstSampleTimeStamp);
+            }
 
-        // When creating a shared memory segment, truncate it.
-        if (0 < m_size) {
-            retVal = (0 == ::ftruncate(m_fd, static_cast<off_t>(sizeof(SharedMemoryHeader) + m_size)));
-            if (!retVal) {
-// clang-format off // LCOV_EXCL_LINE
-                std::cerr << "[cluon::SharedMemory (POSIX)] Failed to truncate '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
+            const HeapEntry NEXT{m_heap.top()};
+            Cursor &c{*m_cursors[NEXT.second]};
+            m_envelopeAvailableCondition.wait(lck, [this, &c] { return !m_running || !c.m_buffered.empty(); });
+            if (!m_running) {
+                break;
             }
-        }
 
-        // Accessing shared memory segment.
-        if (retVal) {
-            // On opening (i.e., NOT creating) a shared memory segment, m_size is still 0 and we need to figure out the size first.
-            m_sharedMemory = static_cast<char *>(::mmap(0, sizeof(SharedMemoryHeader) + m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
-            if (MAP_FAILED != m_sharedMemory) {
-                m_sharedMemoryHeader = reinterpret_cast<SharedMemoryHeader *>(m_sharedMemory);
+            auto envelope = std::move(c.m_buffered.front());
+            c.m_buffered.pop_front();
+            c.m_bufferedBytes -= envelope.second.serializedData().size();
+            c.m_nextToReplay++;
+            m_heap.pop();
+            if (c.m_nextToReplay < c.m_index.size()) {
+                m_heap.push(std::make_pair(c.m_index[c.m_nextToReplay].first, NEXT.second));
+            }
+            m_numberOfReturnedEnvelopesInTotal++;
+            m_readAheadCondition.notify_all();
+
+            // Skip Envelopes that could not be read.
+            if (envelope.first) {
+                m_delay = m_hasPreviousSampleTimeStamp ? static_cast<uint32_t>(NEXT.first - m_previousSampleTimeStamp) : 0;
+                m_previousSampleTimeStamp    = NEXT.first;
+                m_hasPreviousSampleTimeStamp = true;
+                return envelope;
+            }
+        }
+    } catch (...) {} // LCOV_EXCL_LINE
+    return std::make_pair(false, cluon::data::Envelope());
+}
 
-                // On creating (i.e., NOT opening) a shared memory segment, setup the shared memory header.
-                if (0 < m_size) {
-                    // Store user accessible size in shared memory.
-                    m_sharedMemoryHeader->__size = m_size;
+inline void MergedPlayer::readAhead() noexcept {
+    auto lastStatus{std::chrono::steady_clock::now()};
+    try {
+        std::unique_lock<std::mutex> lck(m_mutex);
+        while (m_running) {
+            // Read for the file whose next unread Envelope is due first.
+            Cursor *next{nullptr};
+            int64_t earliest{(std::numeric_limits<int64_t>::max)()};
+            for (auto &c : m_cursors) {
+                if ((c->m_nextToRead < c->m_index.size()) && (c->m_buffered.empty() || (c->m_bufferedBytes < m_maxBufferedBytesPerFile))
+                    && (c->m_index[c->m_nextToRead].first < earliest)) {
+                    earliest = c->m_index[c->m_nextToRead].first;
+                    next     = c.get();
+                }
+            }
 
-                    // Create process-shared mutex (fastest approach, cf. Stevens & Rago: "Advanced Programming in the UNIX (R) Environment").
-                    pthread_mutexattr_t mutexAttribute;
-                    ::pthread_mutexattr_init(&mutexAttribute);
-                    ::pthread_mutexattr_setpshared(&mutexAttribute, PTHREAD_PROCESS_SHARED); // Share between unrelated processes.
-#ifndef __APPLE__
-                    ::pthread_mutexattr_setrobust(&mutexAttribute, PTHREAD_MUTEX_ROBUST);    // Allow continuation of other processes waiting for this mutex
-                                                                                             // when the currently holding process unexpectedly terminates.
-#endif
-                    ::pthread_mutexattr_settype(&mutexAttribute, PTHREAD_MUTEX_NORMAL);      // Using regular mutex with deadlock behavior.
-                    ::pthread_mutex_init(&(m_sharedMemoryHeader->__mutex), &mutexAttribute);
-                    ::pthread_mutexattr_destroy(&mutexAttribute);
+            if (nullptr != next) {
+                const uint64_t GENERATION{m_generation};
+                const uint64_t POSITION{next->m_index[next->m_nextToRead].second};
 
-                    // Create shared condition.
-                    pthread_condattr_t conditionAttribute;
-                    ::pthread_condattr_init(&conditionAttribute);
-#ifndef __APPLE__
-                    ::pthread_condattr_setclock(&conditionAttribute, CLOCK_MONOTONIC);          // Use realtime clock for timed waits with non-negative jumps.
-#endif
-                    ::pthread_condattr_setpshared(&conditionAttribute, PTHREAD_PROCESS_SHARED); // Share between unrelated processes.
-                    ::pthread_cond_init(&(m_sharedMemoryHeader->__condition), &conditionAttribute);
-                    ::pthread_condattr_destroy(&conditionAttribute);
-                } else {
-                    // Indicate that this instance is attaching to an existing shared memory segment.
-                    m_hasOnlyAttachedToSharedMemory = true;
+                // Only this thread accesses the files; the index is not modified after construction.
+                lck.unlock();
+                auto envelope = readEnvelope(*next, POSITION);
+                lck.lock();
 
-                    // Read size as we are attaching to an existing shared memory.
-                    m_size = m_sharedMemoryHeader->__size;
+                if (GENERATION == m_generation) {
+                    next->m_bufferedBytes += envelope.second.serializedData().size();
+                    next->m_buffered.push_back(std::move(envelope));
+                    next->m_nextToRead++;
+                    m_envelopeAvailableCondition.notify_all();
+                }
+            } else {
+                m_readAheadCondition.wait_for(lck, std::chrono::milliseconds(100));
+            }
 
-                    // Now, as we know the real size, unmap the first mapping that did not know the size.
-                    if (::munmap(m_sharedMemory, sizeof(SharedMemoryHeader))) {
-// clang-format off // LCOV_EXCL_LINE
-                        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                    }
+            // Publish some statistics at 1 Hz.
+            const auto NOW{std::chrono::steady_clock::now()};
+            if ((NOW - lastStatus) >= std::chrono::seconds(1)) {
+                lastStatus = NOW;
 
-                    // Invalidate all pointers.
-                    m_sharedMemory = nullptr;
-                    m_sharedMemoryHeader = nullptr;
+                cluon::data::PlayerStatus ps;
+                ps.state(2); // State: "playback"
+                ps.numberOfEntries(m_totalNumberOfEnvelopes);
+                ps.currentEntryForPlayback(static_cast<uint32_t>(m_numberOfReturnedEnvelopesInTotal));
 
-                    // Re-map with the correct size parameter.
-                    m_sharedMemory = static_cast<char *>(::mmap(0, sizeof(SharedMemoryHeader) + m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
-                    if (MAP_FAILED != m_sharedMemory) {
-                        m_sharedMemoryHeader = reinterpret_cast<SharedMemoryHeader *>(m_sharedMemory);
+                lck.unlock();
+                {
+                    std::lock_guard<std::mutex> lckListener(m_playerListenerMutex);
+                    if (nullptr != m_playerListener) {
+                        m_playerListener(ps);
                     }
                 }
-            } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                std::cerr << "[cluon::SharedMemory (POSIX)] Failed to map '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
+                lck.lock();
             }
+        }
+    } catch (...) {} // LCOV_EXCL_LINE
+}
+
+////////////////////////////////////////////////////////////////////////
+
+inline uint32_t MergedPlayer::totalNumberOfEnvelopesInRecFile() const noexcept {
+    return m_totalNumberOfEnvelopes;
+}
+
+inline uint32_t MergedPlayer::delay() const noexcept {
+    std::lock_guard<std::mutex> lck(m_mutex);
+    // Make sure that delay is not exceeding the specified maximum delay.
+    return std::min<uint32_t>(m_delay, MergedPlayer::MAX_DELAY_IN_MICROSECONDS);
+}
+
+inline bool MergedPlayer::hasMoreData() const noexcept {
+    std::lock_guard<std::mutex> lck(m_mutex);
+    return (0 < m_totalNumberOfEnvelopes) && (m_autoRewind || !m_heap.empty());
+}
+
+inline void MergedPlayer::rewind() noexcept {
+    std::lock_guard<std::mutex> lck(m_mutex);
+    resetTo(m_firstSampleTimeStamp);
+}
+
+inline void MergedPlayer::seekTo(float ratio) noexcept {
+    if (!(ratio < 0) && !(ratio > 1)) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        const int64_t SAMPLE_TIME_STAMP{m_firstSampleTimeStamp
+                                        + static_cast<int64_t>(static_cast<double>(m_lastSampleTimeStamp - m_firstSampleTimeStamp) * static_cast<double>(ratio))};
+        resetTo(SAMPLE_TIME_STAMP);
+        std::clog << "[cluon::MergedPlayer]: Seeking to " << SAMPLE_TIME_STAMP << " (" << m_numberOfReturnedEnvelopesInTotal << "/" << m_totalNumberOfEnvelopes
+                  << ")." << std::endl;
+    }
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/Histogram.hpp"
 
-            // If the shared memory segment is correctly available, store the pointer for the user data.
-            if (MAP_FAILED != m_sharedMemory) {
-                m_userAccessibleSharedMemory = m_sharedMemory + sizeof(SharedMemoryHeader);
+#include <cmath>
 
-                // Lock the shared memory into RAM for performance reasons.
-                if (-1 == ::mlock(m_sharedMemory, sizeof(SharedMemoryHeader) + m_size)) {
-                    std::cerr << "[cluon::SharedMemory (POSIX)] Failed to mlock shared memory: " // LCOV_EXCL_LINE
-                              << ::strerror(errno) << " (" << errno << ")" << std::endl;         // LCOV_EXCL_LINE
-                }
-            }
-        } else { // LCOV_EXCL_LINE
-            if (-1 != m_fd) { // LCOV_EXCL_LINE
-                if (-1 == ::shm_unlink(m_name.c_str())) { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                    std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unlink shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                }
-            }
-            m_fd = -1; // LCOV_EXCL_LINE
-        }
-    }
-#endif
+namespace cluon {
 
-#ifdef __linux__
-    // On Linux, the POSIX shared memory lives in /dev/shm and we have a valid
-    // file descriptor to use for timestamping.
-    if (-1 != m_fd) {
-        m_fdForTimeStamping = m_fd;
-    }
-#else
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    // On *BSDs, the POSIX shared memory lives not in /dev/shm and we have
-    // need to use a separate file for timestamping.
-    if (-1 != m_fd) {
-        m_fdForTimeStamping = ::open(m_nameForTimeStamping.c_str(), O_CREAT|O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+inline Histogram::Histogram() noexcept {
+    for (auto &b : m_buckets) {
+        b.store(0, std::memory_order_relaxed);
     }
-#endif
-#endif
 }
 
-inline void SharedMemory::deinitPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    if ((nullptr != m_sharedMemoryHeader) && (!m_hasOnlyAttachedToSharedMemory)) {
-        // Wake any waiting threads as we are going to end the shared memory session.
-        ::pthread_cond_broadcast(&(m_sharedMemoryHeader->__condition));
-        ::pthread_cond_destroy(&(m_sharedMemoryHeader->__condition));
-        ::pthread_mutex_destroy(&(m_sharedMemoryHeader->__mutex));
-    }
-    if ((nullptr != m_sharedMemory) && ::munmap(m_sharedMemory, sizeof(SharedMemoryHeader) + m_size)) {
-// clang-format off // LCOV_EXCL_LINE
-        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-    }
-    if (!m_hasOnlyAttachedToSharedMemory && (-1 != m_fd) && (-1 == ::shm_unlink(m_name.c_str()) && (ENOENT != errno))) {
-// clang-format off // LCOV_EXCL_LINE
-        std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unlink shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
+inline uint32_t Histogram::bucketOf(uint64_t value) noexcept {
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<uint32_t>(value);
     }
-#endif
-
-#ifndef __linux__
-    // On *BSDs, the POSIX shared memory lives not in /dev/shm and we have
-    // used a separate file for timestamping.
-    if (-1 != m_fdForTimeStamping) {
-        ::close(m_fdForTimeStamping);
-        ::unlink(m_nameForTimeStamping.c_str());
+#if defined(__GNUC__) || defined(__clang__)
+    const uint32_t MSB{63u - static_cast<uint32_t>(__builtin_clzll(value))};
+#else
+    uint32_t MSB{0};
+    for (uint64_t v{value}; v > 1; v >>= 1) {
+        MSB++;
     }
 #endif
+    const uint32_t SHIFT{MSB - SUB_BUCKET_BITS};
+    const uint32_t SUB_BUCKET{static_cast<uint32_t>(value >> SHIFT) - SUB_BUCKETS};
+    return 2 * SUB_BUCKETS + (SHIFT - 1) * SUB_BUCKETS + SUB_BUCKET;
 }
 
-inline void SharedMemory::lockPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    if (nullptr != m_sharedMemoryHeader) {
-        auto retVal = ::pthread_mutex_lock(&(m_sharedMemoryHeader->__mutex));
-        if (EOWNERDEAD == retVal) {
-// clang-format off // LCOV_EXCL_LINE
-            std::cerr << "[cluon::SharedMemory (POSIX)] pthread_mutex_lock returned for EOWNERDEAD for mutex in shared memory '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-        } else if (0 != retVal) {
-            m_broken.store(true); // LCOV_EXCL_LINE
-        }
+inline uint64_t Histogram::highestValueOf(uint32_t bucket) noexcept {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
     }
-#endif
+    const uint32_t SHIFT{(bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1};
+    const uint64_t SUB_BUCKET{(bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS};
+    return ((SUB_BUCKET + 1) << SHIFT) - 1;
 }
 
-inline void SharedMemory::unlockPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    if (nullptr != m_sharedMemoryHeader) {
-        if (0 != ::pthread_mutex_unlock(&(m_sharedMemoryHeader->__mutex))) {
-            m_broken.store(true); // LCOV_EXCL_LINE
-        }
-    }
-#endif
+inline void Histogram::record(uint64_t value) noexcept {
+    m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current{m_minimum.load(std::memory_order_relaxed)};
+    while ((value < current) && !m_minimum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    current = m_maximum.load(std::memory_order_relaxed);
+    while ((value > current) && !m_maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
 }
 
-inline void SharedMemory::waitPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    if (nullptr != m_sharedMemoryHeader) {
-        lock();
-        if (0 != ::pthread_cond_wait(&(m_sharedMemoryHeader->__condition), &(m_sharedMemoryHeader->__mutex))) {
-            m_broken.store(true); // LCOV_EXCL_LINE
+inline void Histogram::merge(const Histogram &other) noexcept {
+    for (uint32_t i{0}; i < NUMBER_OF_BUCKETS; i++) {
+        const uint64_t N{other.m_buckets[i].load(std::memory_order_relaxed)};
+        if (0 < N) {
+            m_buckets[i].fetch_add(N, std::memory_order_relaxed);
         }
-        unlock();
     }
-#endif
+    m_count.fetch_add(other.m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    const uint64_t MINIMUM{other.m_minimum.load(std::memory_order_relaxed)};
+    uint64_t current{m_minimum.load(std::memory_order_relaxed)};
+    while ((MINIMUM < current) && !m_minimum.compare_exchange_weak(current, MINIMUM, std::memory_order_relaxed)) {}
+    const uint64_t MAXIMUM{other.m_maximum.load(std::memory_order_relaxed)};
+    current = m_maximum.load(std::memory_order_relaxed);
+    while ((MAXIMUM > current) && !m_maximum.compare_exchange_weak(current, MAXIMUM, std::memory_order_relaxed)) {}
 }
 
-inline void SharedMemory::notifyAllPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    if (nullptr != m_sharedMemoryHeader) {
-        if (0 != ::pthread_cond_broadcast(&(m_sharedMemoryHeader->__condition))) {
-            m_broken.store(true); // LCOV_EXCL_LINE
-        }
+inline void Histogram::reset() noexcept {
+    for (auto &b : m_buckets) {
+        b.store(0, std::memory_order_relaxed);
     }
-#endif
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_minimum.store(UINT64_MAX, std::memory_order_relaxed);
+    m_maximum.store(0, std::memory_order_relaxed);
 }
 
-inline bool SharedMemory::validPOSIX() noexcept {
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
-    return (-1 != m_fd) && (MAP_FAILED != m_sharedMemory);
-#else
-    return false;
-#endif
+inline uint64_t Histogram::count() const noexcept {
+    return m_count.load(std::memory_order_relaxed);
 }
 
-////////////////////////////////////////////////////////////////////////////////
+inline uint64_t Histogram::minimum() const noexcept {
+    const uint64_t MINIMUM{m_minimum.load(std::memory_order_relaxed)};
+    return (UINT64_MAX == MINIMUM) ? 0 : MINIMUM;
+}
 
-inline void SharedMemory::initSysV() noexcept {
-    // If size is greater than 0, the caller wants to create a new shared
-    // memory area. Otherwise, the caller wants to open an existing shared memory.
+inline uint64_t Histogram::maximum() const noexcept {
+    return m_maximum.load(std::memory_order_relaxed);
+}
 
-    // Create a key to identify the shared memory area.
-    constexpr int32_t ID_SHM = 1;
-    constexpr int32_t ID_SEM_AS_MUTEX = 2;
-    constexpr int32_t ID_SEM_AS_CONDITION = 3;
-    bool tokenFileExisting{false};
+inline double Histogram::mean() const noexcept {
+    const uint64_t COUNT{count()};
+    return (0 == COUNT) ? 0.0 : static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(COUNT);
+}
 
-    if (0 < m_size) {
-        // The file should not exist; otherwise, we need to clear an existing
-        // set of semaphores and shared memory areas.
-        std::fstream tokenFile(m_name.c_str(), std::ios::in);
-        if (tokenFile.good()) {
-            // Existing tokenFile found. Cleaning up will be tried in the code below.
-        }
-        tokenFile.close();
+inline uint64_t Histogram::valueAtPercentile(double percentile) const noexcept {
+    // Sum up the buckets instead of using m_count to stay consistent while values are recorded.
+    uint64_t total{0};
+    for (const auto &b : m_buckets) {
+        total += b.load(std::memory_order_relaxed);
+    }
+    if (0 == total) {
+        return 0;
+    }
 
-        tokenFile.open(m_name.c_str(), std::ios::out);
-        tokenFileExisting = tokenFile.good();
-        if (!tokenFileExisting) {
-            std::cerr << "[cluon::SharedMemory (SysV)] Token file '" << m_name << "' could not be created; shared memory cannot be created." << std::endl;
-        }
-        tokenFile.close();
-    } else {
-        // Open an existing shared memory area indicated by an existing token file.
-        m_hasOnlyAttachedToSharedMemory = true;
+    const double P{(percentile < 0.0) ? 0.0 : ((percentile > 100.0) ? 100.0 : percentile)};
+    uint64_t rank{static_cast<uint64_t>(std::ceil(P / 100.0 * static_cast<double>(total)))};
+    rank = (0 == rank) ? 1 : rank;
 
-        std::fstream tokenFile(m_name.c_str(), std::ios::in);
-        tokenFileExisting = tokenFile.good();
-        if (!tokenFileExisting) {
-            std::cerr << "[cluon::SharedMemory (SysV)] Token file '" << m_name << "' not found; shared memory cannot be created." << std::endl;
+    uint64_t seen{0};
+    for (uint32_t i{0}; i < NUMBER_OF_BUCKETS; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            const uint64_t MAXIMUM{maximum()};
+            const uint64_t VALUE{highestValueOf(i)};
+            return ((0 < MAXIMUM) && (VALUE > MAXIMUM)) ? MAXIMUM : VALUE;
         }
-        tokenFile.close();
     }
+    return maximum();
+}
 
-    // We have a token file to be used for the keys.
-    if (tokenFileExisting) {
-        m_shmKeySysV = ::ftok(m_name.c_str(), ID_SHM);
-        if (-1 == m_shmKeySysV) {
-// clang-format off // LCOV_EXCL_LINE
-            std::cerr << "[cluon::SharedMemory (SysV)] Key for shared memory could not be created: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-        } else {
-            if (!m_hasOnlyAttachedToSharedMemory) {
-                // The caller wants to create a shared memory segment.
+} // namespace cluon
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-                // First, try to clean up an orphaned shared memory segment.
-                // Therefore, we try to open the shared memory area without the
-                // IPC_CREAT flag. On a clean environment, this call must fail
-                // as there should not be any shared memory segments left.
-                {
-                    int orphanedSharedMemoryIDSysV = ::shmget(m_shmKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                    if (!(orphanedSharedMemoryIDSysV < 0)) {
-                        if (::shmctl(orphanedSharedMemoryIDSysV, IPC_RMID, 0)) {
-// clang-format off // LCOV_EXCL_LINE
-                            std::cerr << "[cluon::SharedMemory (SysV)] Existing shared memory (0x" << std::hex << m_shmKeySysV << std::dec << ") found; removing failed." << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                        }
-                    }
-                }
+//#include "cluon/PeriodicScheduler.hpp"
+//#include "cluon/TerminateHandler.hpp"
 
-                // Now, create the shared memory segment.
-                m_sharedMemoryIDSysV = ::shmget(m_shmKeySysV, m_size, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                if (-1 != m_sharedMemoryIDSysV) {
-                    m_sharedMemory = reinterpret_cast<char *>(::shmat(m_sharedMemoryIDSysV, nullptr, 0));
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-                    if ((void *)-1 != m_sharedMemory) {
-                        m_userAccessibleSharedMemory = m_sharedMemory;
-                    } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                        std::cerr << "[cluon::SharedMemory (SysV)] Failed to attach to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                    }
-#pragma GCC diagnostic pop
-                } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                }
-            } else {
-                // The caller wants to attach to an existing shared memory segment.
-                m_sharedMemoryIDSysV = ::shmget(m_shmKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                if (-1 != m_sharedMemoryIDSysV) {
-                    struct shmid_ds info;
-                    if (-1 != ::shmctl(m_sharedMemoryIDSysV, IPC_STAT, &info)) {
-                        m_size = static_cast<uint32_t>(info.shm_segsz);
-                        m_sharedMemory = reinterpret_cast<char *>(::shmat(m_sharedMemoryIDSysV, nullptr, 0));
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-                        if ((void *)-1 != m_sharedMemory) {
-                            m_userAccessibleSharedMemory = m_sharedMemory;
-                        } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                            std::cerr << "[cluon::SharedMemory (SysV)] Failed to attach to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                        }
-#pragma GCC diagnostic pop
-                    } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                        std::cerr << "[cluon::SharedMemory (SysV)] Could not read information about shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                    }
-                } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                }
-            }
-        }
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <thread>
 
-        // Next, create the mutex (but only if the shared memory was acquired correctly.
-        m_mutexKeySysV = ::ftok(m_name.c_str(), ID_SEM_AS_MUTEX);
-        if (-1 == m_mutexKeySysV) {
-// clang-format off // LCOV_EXCL_LINE
-            std::cerr << "[cluon::SharedMemory (SysV)] Key for mutex could not be created: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-        }
-        if ((-1 != m_shmKeySysV) && (-1 != m_mutexKeySysV) && (nullptr != m_userAccessibleSharedMemory)) {
-            if (!m_hasOnlyAttachedToSharedMemory) {
-                // The caller has created the shared memory segment and thus,
-                // we need the corresponding mutex.
+#ifdef __linux__
+    #include <time.h>
+#endif
 
-                // First, try to remove the orphaned one.
-                {
-                    int orphanedMutexIDSysV = ::semget(m_mutexKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                    if (!(orphanedMutexIDSysV < 0)) {
-                        if (::semctl(orphanedMutexIDSysV, 0, IPC_RMID)) {
-// clang-format off // LCOV_EXCL_LINE
-                            std::cerr << "[cluon::SharedMemory (SysV)] Existing semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex) found; removing failed." << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                        }
-                    }
-                }
+namespace cluon {
+
+inline int64_t PeriodicScheduler::now() noexcept {
+#ifdef __linux__
+    struct timespec ts {};
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + static_cast<int64_t>(ts.tv_nsec);
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
 
-                // Next, create the correct semaphore used as mutex.
-                {
-                    constexpr int NSEMS{1};
-                    m_mutexIDSysV = ::semget(m_mutexKeySysV, NSEMS, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                    if (-1 != m_mutexIDSysV) {
-                        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-                        constexpr int INITIAL_VALUE{1};
-                        union semun tmp;
-                        tmp.val = INITIAL_VALUE;
-#pragma GCC diagnostic push
-#if defined(__clang__)
-#pragma GCC diagnostic ignored "-Wclass-varargs"
+inline void PeriodicScheduler::sleepUntil(int64_t deadline) noexcept {
+#ifdef __linux__
+    struct timespec ts {};
+    ts.tv_sec  = static_cast<time_t>(deadline / (1000 * 1000 * 1000));
+    ts.tv_nsec = static_cast<long>(deadline % (1000 * 1000 * 1000));
+    // Sleeping until an absolute time point is not prolonged by interruptions.
+    while (EINTR == ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)) {}
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline)));
 #endif
-                        if (-1 == ::semctl(m_mutexIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
-// clang-format off // LCOV_EXCL_LINE
-                            std::cerr << "[cluon::SharedMemory (SysV)] Failed to initialize semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                        }
-#pragma GCC diagnostic pop
-                    } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                        std::cerr << "[cluon::SharedMemory (SysV)] Failed to create semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                    }
+}
+
+inline int64_t PeriodicScheduler::deadlineOf(const Task &task, uint64_t activation) noexcept {
+    return task.m_start + static_cast<int64_t>(std::llround(static_cast<double>(activation) * task.m_periodInNanoseconds));
+}
+
+inline uint32_t PeriodicScheduler::add(float freq, std::function<bool()> delegate, OverrunPolicy policy) noexcept {
+    uint32_t retVal{0};
+    try {
+        std::unique_ptr<Task> task{new Task()};
+        task->m_delegate            = delegate;
+        task->m_policy              = policy;
+        task->m_periodInNanoseconds = 1000.0 * 1000.0 * 1000.0 / static_cast<double>((freq > 0) ? freq : 1.0f);
+        task->m_running             = (nullptr != delegate);
+
+        std::lock_guard<std::mutex> lck(m_tasksMutex);
+        retVal = static_cast<uint32_t>(m_tasks.size());
+        m_tasks.emplace_back(std::move(task));
+    } catch (...) {} // LCOV_EXCL_LINE
+    return retVal;
+}
+
+inline void PeriodicScheduler::run() noexcept {
+    m_stop.store(false);
+    while (!m_stop.load() && !TerminateHandler::instance().isTerminated.load()) {
+        // Find the task with the earliest deadline; tasks are never removed from m_tasks so that pointers stay valid.
+        Task *next{nullptr};
+        {
+            std::lock_guard<std::mutex> lck(m_tasksMutex);
+            for (auto &t : m_tasks) {
+                if (!t->m_started) {
+                    // The first activation of a task is due when the scheduler picks it up.
+                    t->m_start    = now();
+                    t->m_deadline = t->m_start;
+                    t->m_started  = true;
                 }
-            } else {
-                m_mutexIDSysV = ::semget(m_mutexKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                if (-1 == m_mutexIDSysV) {
-// clang-format off // LCOV_EXCL_LINE
-                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << ", intended to use as mutex): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
+                if (t->m_running && ((nullptr == next) || (t->m_deadline < next->m_deadline))) {
+                    next = t.get();
                 }
             }
         }
-
-        // Next, create the condition variable (but only if the shared memory was acquired correctly.
-        m_conditionKeySysV = ::ftok(m_name.c_str(), ID_SEM_AS_CONDITION);
-        if (-1 == m_conditionKeySysV) {
-// clang-format off // LCOV_EXCL_LINE
-            std::cerr << "[cluon::SharedMemory (SysV)] Key for condition could not be created: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
+        if (nullptr == next) {
+            break;
         }
-        if ((-1 != m_shmKeySysV) && (-1 != m_mutexKeySysV) && (-1 != m_conditionKeySysV) && (nullptr != m_userAccessibleSharedMemory)) {
-            if (!m_hasOnlyAttachedToSharedMemory) {
-                // The caller has created the shared memory segment and thus,
-                // we need the corresponding condition variable.
 
-                // First, try to remove the orphaned one.
-                {
-                    int orphanedConditionIDSysV = ::semget(m_conditionKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                    if (!(orphanedConditionIDSysV < 0)) {
-                        if (::semctl(orphanedConditionIDSysV, 0, IPC_RMID)) {
-// clang-format off // LCOV_EXCL_LINE
-                            std::cerr << "[cluon::SharedMemory (SysV)] Existing semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable) found; removing failed." << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                        }
-                    }
-                }
+        sleepUntil(next->m_deadline);
 
-                // Next, create the correct semaphore used as condition variable.
-                {
-                    constexpr int NSEMS{1};
-                    m_conditionIDSysV = ::semget(m_conditionKeySysV, NSEMS, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                    if (-1 != m_conditionIDSysV) {
-                        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-                        constexpr int INITIAL_VALUE{1};
-                        union semun tmp;
-                        tmp.val = INITIAL_VALUE;
-#pragma GCC diagnostic push
-#if defined(__clang__)
-#pragma GCC diagnostic ignored "-Wclass-varargs"
-#endif
-                        if (-1 == ::semctl(m_conditionIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
-// clang-format off // LCOV_EXCL_LINE
-                            std::cerr << "[cluon::SharedMemory (SysV)] Failed to initialize semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                        }
-#pragma GCC diagnostic pop
-                    } else { // LCOV_EXCL_LINE
-// clang-format off // LCOV_EXCL_LINE
-                        std::cerr << "[cluon::SharedMemory (SysV)] Failed to create semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-                    }
-                }
-            } else {
-                m_conditionIDSysV = ::semget(m_conditionKeySysV, 0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
-                if (-1 == m_conditionIDSysV) {
-// clang-format off // LCOV_EXCL_LINE
-                    std::cerr << "[cluon::SharedMemory (SysV)] Failed to get semaphore (0x" << std::hex << m_conditionKeySysV << std::dec << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
+        const int64_t START{now()};
+        next->m_jitter.record(static_cast<uint64_t>(std::max<int64_t>(START - next->m_deadline, 0)));
+        try {
+            next->m_running = next->m_delegate();
+        } catch (...) {
+            next->m_running = false; // delegate threw exception.
+        }
+        const int64_t END{now()};
+
+        next->m_activation++;
+        const int64_t NEXT_DEADLINE{deadlineOf(*next, next->m_activation)};
+        if (END > NEXT_DEADLINE) {
+            next->m_overrun.record(static_cast<uint64_t>(END - NEXT_DEADLINE));
+            if (SKIP == next->m_policy) {
+                // Continue with the first deadline after now.
+                const uint64_t ACTIVATION{static_cast<uint64_t>(static_cast<double>(END - next->m_start) / next->m_periodInNanoseconds) + 1};
+                if (ACTIVATION > next->m_activation) {
+                    next->m_skipped.fetch_add(ACTIVATION - next->m_activation);
+                    next->m_activation = ACTIVATION;
                 }
             }
         }
+        next->m_deadline = deadlineOf(*next, next->m_activation);
     }
+}
 
-    // If the shared memory is present, open the token file for the time stamping.
-    if (nullptr != m_sharedMemory) {
-        m_fdForTimeStamping = ::open(m_name.c_str(), O_RDONLY);
-    }
+inline void PeriodicScheduler::stop() noexcept {
+    m_stop.store(true);
 }
 
-inline void SharedMemory::deinitSysV() noexcept {
-    if (nullptr != m_sharedMemory) {
-        // Close token file.
-        ::close(m_fdForTimeStamping);
-        m_fdForTimeStamping = -1;
+inline const Histogram &PeriodicScheduler::jitter(uint32_t task) const noexcept {
+    std::lock_guard<std::mutex> lck(m_tasksMutex);
+    return (task < m_tasks.size()) ? m_tasks[task]->m_jitter : m_unknownTask;
+}
 
-        if (-1 == ::shmdt(m_sharedMemory)) {
-// clang-format off // LCOV_EXCL_LINE
-            std::cerr << "[cluon::SharedMemory (SysV)] Could not detach shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
-// clang-format on // LCOV_EXCL_LINE
-        }
-    }
+inline const Histogram &PeriodicScheduler::overrun(uint32_t task) const noexcept {
+    std::lock_guard<std::mutex> lck(m_tasksMutex);
+    return (task < m_tasks.size()) ? m_tasks[task]->m_overrun : m_unknownTask;
+}
 
-    if (!m_hasOnlyAttachedToSharedMemory) {
-        notifyAllSysV();
+inline uint64_t PeriodicScheduler::skipped(uint32_t task) const noexcept {
+    std::lock_guard<std::mutex> lck(m_tasksMutex);
+    return (task < m_tasks.size()) ? m_tasks[task]->m_skipped.load() : 0;
+}
 
-        if (-1 != m_conditionIDSysV) {
-            if (-1 == ::semctl(m_conditionIDSysV, 0, IPC_RMID)) {
-                std::cerr << "[cluon::SharedMemory (SysV)] Semaphore (0x" << std::hex << m_conditionKeySysV << std::dec
-                          << ") used as condition could not be removed: " << ::strerror(errno) << " (" << errno << ")" << std::endl;
-            }
-        }
+} // namespace cluon
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
 
-        if (-1 != m_mutexIDSysV) {
-            if (-1 == ::semctl(m_mutexIDSysV, 0, IPC_RMID)) {
-                std::cerr << "[cluon::SharedMemory (SysV)] Semaphore (0x" << std::hex << m_mutexKeySysV << std::dec
-                          << ") used as mutex could not be removed: " << ::strerror(errno) << " (" << errno << ")" << std::endl;
-            }
+//#include "cluon/ExecutionLane.hpp"
+//#include "cluon/PeriodicScheduler.hpp"
+
+namespace cluon {
+
+inline ExecutionLane::ExecutionLane(bool dedicatedThread) noexcept
+    : m_dedicatedThread{dedicatedThread} {
+    if (m_dedicatedThread) {
+        try {
+            m_thread = std::thread(&ExecutionLane::processQueue, this);
+        } catch (...) {} // LCOV_EXCL_LINE
+    }
+}
+
+inline ExecutionLane::~ExecutionLane() noexcept {
+    {
+        std::lock_guard<std::mutex> lck(m_queueMutex);
+        m_running = false;
+    }
+    m_queueCondition.notify_all();
+    try {
+        if (m_thread.joinable()) {
+            m_thread.join();
         }
-        if (-1 != m_sharedMemoryIDSysV) {
-            if (-1 == ::shmctl(m_sharedMemoryIDSysV, IPC_RMID, 0)) {
-                std::cerr << "[cluon::SharedMemory (SysV)] Shared memory (0x" << std::hex << m_shmKeySysV << std::dec
-                          << ") could not be removed: " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+    } catch (...) {} // LCOV_EXCL_LINE
+}
+
+inline void ExecutionLane::post(std::function<void()> &&task) noexcept {
+    const int64_t POSTED{PeriodicScheduler::now()};
+    if (!m_dedicatedThread) {
+        run(task, POSTED);
+        return;
+    }
+    try {
+        {
+            std::lock_guard<std::mutex> lck(m_queueMutex);
+            m_queue.emplace_back(std::move(task), POSTED);
+            const uint32_t DEPTH{static_cast<uint32_t>(m_queue.size())};
+            m_queueDepth.store(DEPTH, std::memory_order_relaxed);
+            if (DEPTH > m_maxQueueDepth.load(std::memory_order_relaxed)) {
+                m_maxQueueDepth.store(DEPTH, std::memory_order_relaxed);
             }
         }
+        m_queueCondition.notify_one();
+    } catch (...) {} // LCOV_EXCL_LINE
+}
 
-        if (-1 == ::unlink(m_name.c_str())) {
-            std::cerr << "[cluon::SharedMemory (SysV)] Token file '" << m_name << "' could not be removed: " << ::strerror(errno) << " (" << errno << ")"
-                      << std::endl;
-        }
-    }
+inline void ExecutionLane::run(std::function<void()> &task, int64_t posted) noexcept {
+    const int64_t START{PeriodicScheduler::now()};
+    m_queueLatency.record(static_cast<uint64_t>(START - posted));
+    try {
+        task();
+    } catch (...) {} // LCOV_EXCL_LINE
+    m_handlerLatency.record(static_cast<uint64_t>(PeriodicScheduler::now() - START));
 }
 
-inline void SharedMemory::lockSysV() noexcept {
-    if (-1 != m_mutexIDSysV) {
-        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-        constexpr int VALUE{-1};
+inline void ExecutionLane::processQueue() noexcept {
+    std::unique_lock<std::mutex> lck(m_queueMutex);
+    while (m_running) {
+        m_queueCondition.wait(lck, [this] { return (!this->m_running || !this->m_queue.empty()); });
+        while (m_running && !m_queue.empty()) {
+            auto entry = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_queueDepth.store(static_cast<uint32_t>(m_queue.size()), std::memory_order_relaxed);
 
-        struct sembuf tmp;
-        tmp.sem_num = NUMBER_OF_SEMAPHORE_TO_CONTROL;
-        tmp.sem_op = VALUE;
-        tmp.sem_flg = SEM_UNDO; // When the caller terminates unexpectedly, let the kernel restore the original value.
-        if (-1 == ::semop(m_mutexIDSysV, &tmp, 1)) {
-            std::cerr << "[cluon::SharedMemory (SysV)] Failed to lock semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << "): " << ::strerror(errno)
-                      << " (" << errno << ")" << std::endl;
-            m_broken.store(true);
+            lck.unlock();
+            run(entry.first, entry.second);
+            lck.lock();
         }
     }
 }
 
-inline void SharedMemory::unlockSysV() noexcept {
-    if (-1 != m_mutexIDSysV) {
-        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-        constexpr int VALUE{+1};
+inline uint32_t ExecutionLane::queueDepth() const noexcept {
+    return m_queueDepth.load(std::memory_order_relaxed);
+}
 
-        struct sembuf tmp;
-        tmp.sem_num = NUMBER_OF_SEMAPHORE_TO_CONTROL;
-        tmp.sem_op = VALUE;
-        tmp.sem_flg = SEM_UNDO; // When the caller terminates unexpectedly, let the kernel restore the original value.
-        if (-1 == ::semop(m_mutexIDSysV, &tmp, 1)) {
-            std::cerr << "[cluon::SharedMemory (SysV)] Failed to unlock semaphore (0x" << std::hex << m_mutexKeySysV << std::dec << "): " << ::strerror(errno)
-                      << " (" << errno << ")" << std::endl;
-            m_broken.store(true);
-        }
-    }
+inline uint32_t ExecutionLane::maxQueueDepth() const noexcept {
+    return m_maxQueueDepth.load(std::memory_order_relaxed);
 }
 
-inline void SharedMemory::waitSysV() noexcept {
-    if (-1 != m_conditionIDSysV) {
-        constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-        constexpr int VALUE{0}; // Wait for this semaphore to become 0.
+inline const Histogram &ExecutionLane::queueLatency() const noexcept {
+    return m_queueLatency;
+}
 
-        struct sembuf tmp;
-        tmp.sem_num = NUMBER_OF_SEMAPHORE_TO_CONTROL;
-        tmp.sem_op = VALUE;
-        tmp.sem_flg = 0;
-        if (-1 == ::semop(m_conditionIDSysV, &tmp, 1)) {
-            std::cerr << "[cluon::SharedMemory (SysV)] Failed to wait on semaphore (0x" << std::hex << m_conditionKeySysV << std::dec
-                      << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl;
-            m_broken.store(true);
+inline const Histogram &ExecutionLane::handlerLatency() const noexcept {
+    return m_handlerLatency;
+}
+
+} // namespace cluon
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+//#include "cluon/Fragmentation.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cluon {
+
+inline bool Fragmentation::isFragment(const char *data, std::size_t size) noexcept {
+    return (nullptr != data) && (HEADER_SIZE <= size) && (0x0D == static_cast<uint8_t>(data[0])) && (0xA5 == static_cast<uint8_t>(data[1]));
+}
+
+inline std::vector<std::string> Fragmentation::split(const std::string &data, uint32_t message) noexcept {
+    std::vector<std::string> fragments;
+    if (data.empty() || (MAX_MESSAGE_SIZE < data.size())) {
+        return fragments;
+    }
+    try {
+        const uint32_t TOTAL_SIZE{static_cast<uint32_t>(data.size())};
+        const uint16_t NUMBER_OF_FRAGMENTS{static_cast<uint16_t>((TOTAL_SIZE + MAX_FRAGMENT_SIZE - 1) / MAX_FRAGMENT_SIZE)};
+        fragments.reserve(NUMBER_OF_FRAGMENTS);
+        for (uint16_t index{0}; index < NUMBER_OF_FRAGMENTS; index++) {
+            const uint32_t OFFSET{index * static_cast<uint32_t>(MAX_FRAGMENT_SIZE)};
+            const uint32_t LENGTH{std::min(static_cast<uint32_t>(MAX_FRAGMENT_SIZE), TOTAL_SIZE - OFFSET)};
+
+            std::string fragment(HEADER_SIZE + LENGTH, '\0');
+            char *header{&fragment[0]};
+            header[0] = static_cast<char>(0x0D);
+            header[1] = static_cast<char>(0xA5);
+            const uint32_t MESSAGE_LE{htole32(message)};
+            const uint32_t TOTAL_SIZE_LE{htole32(TOTAL_SIZE)};
+            const uint32_t OFFSET_LE{htole32(OFFSET)};
+            const uint16_t INDEX_LE{htole16(index)};
+            const uint16_t NUMBER_OF_FRAGMENTS_LE{htole16(NUMBER_OF_FRAGMENTS)};
+            std::memcpy(header + 2, &MESSAGE_LE, sizeof(MESSAGE_LE));
+            std::memcpy(header + 6, &TOTAL_SIZE_LE, sizeof(TOTAL_SIZE_LE));
+            std::memcpy(header + 10, &OFFSET_LE, sizeof(OFFSET_LE));
+            std::memcpy(header + 14, &INDEX_LE, sizeof(INDEX_LE));
+            std::memcpy(header + 16, &NUMBER_OF_FRAGMENTS_LE, sizeof(NUMBER_OF_FRAGMENTS_LE));
+            std::memcpy(header + HEADER_SIZE, data.data() + OFFSET, LENGTH);
+            fragments.emplace_back(std::move(fragment));
         }
+    } catch (...) { // LCOV_EXCL_LINE
+        fragments.clear(); // LCOV_EXCL_LINE
     }
+    return fragments;
 }
 
-inline void SharedMemory::notifyAllSysV() noexcept {
-    if (-1 != m_conditionIDSysV) {
-        {
-            constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-            constexpr int WAKEUP_VALUE{0};
+inline FragmentAssembler::FragmentAssembler(uint32_t numberOfSlots, std::chrono::milliseconds timeout) noexcept
+    : m_timeout{timeout} {
+    try {
+        m_slots.resize(std::max(numberOfSlots, 1u));
+    } catch (...) {} // LCOV_EXCL_LINE
+}
 
-            union semun tmp;
-            tmp.val = WAKEUP_VALUE;
-#pragma GCC diagnostic push
-#if defined(__clang__)
-#pragma GCC diagnostic ignored "-Wclass-varargs"
-#endif
-            if (-1 == ::semctl(m_conditionIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
-                std::cerr << "[cluon::SharedMemory (SysV)] Failed to notify semaphore (0x" << std::hex << m_conditionKeySysV << std::dec
-                          << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl;
-                m_broken.store(true);
-            }
-#pragma GCC diagnostic pop
+inline void FragmentAssembler::expire(std::chrono::steady_clock::time_point now) noexcept {
+    for (auto &slot : m_slots) {
+        if (slot.m_used && ((now - slot.m_started) > m_timeout)) {
+            slot.m_used = false;
+            m_lost++;
         }
-        {
-            constexpr int NUMBER_OF_SEMAPHORE_TO_CONTROL{0};
-            constexpr int SLEEPING_VALUE{1};
+    }
+}
 
-            union semun tmp;
-            tmp.val = SLEEPING_VALUE;
-#pragma GCC diagnostic push
-#if defined(__clang__)
-#pragma GCC diagnostic ignored "-Wclass-varargs"
-#endif
-            if (-1 == ::semctl(m_conditionIDSysV, NUMBER_OF_SEMAPHORE_TO_CONTROL, SETVAL, tmp)) {
-                std::cerr << "[cluon::SharedMemory (SysV)] Failed to reset semaphore for notification (0x" << std::hex << m_conditionKeySysV << std::dec
-                          << ", intended to use as condition variable): " << ::strerror(errno) << " (" << errno << ")" << std::endl;
-                m_broken.store(true);
+inline const std::string *FragmentAssembler::add(const std::string &from, const char *data, std::size_t size) noexcept {
+    // Release the buffer of the message completed by the previous call.
+    if (nullptr != m_completed) {
+        m_completed->m_used = false;
+        m_completed         = nullptr;
+    }
+    if (!Fragmentation::isFragment(data, size) || m_slots.empty()) {
+        m_discarded++;
+        return nullptr;
+    }
+    m_fragments++;
+
+    uint32_t message{0};
+    uint32_t totalSize{0};
+    uint32_t offset{0};
+    uint16_t index{0};
+    uint16_t numberOfFragments{0};
+    std::memcpy(&message, data + 2, sizeof(message));
+    std::memcpy(&totalSize, data + 6, sizeof(totalSize));
+    std::memcpy(&offset, data + 10, sizeof(offset));
+    std::memcpy(&index, data + 14, sizeof(index));
+    std::memcpy(&numberOfFragments, data + 16, sizeof(numberOfFragments));
+    message           = le32toh(message);
+    totalSize         = le32toh(totalSize);
+    offset            = le32toh(offset);
+    index             = le16toh(index);
+    numberOfFragments = le16toh(numberOfFragments);
+
+    // Fragments must cover the message exactly as Fragmentation::split produces them.
+    const std::size_t LENGTH{size - Fragmentation::HEADER_SIZE};
+    if ((0 == totalSize) || (Fragmentation::MAX_MESSAGE_SIZE < totalSize)
+        || (numberOfFragments != (totalSize + Fragmentation::MAX_FRAGMENT_SIZE - 1) / Fragmentation::MAX_FRAGMENT_SIZE) || (index >= numberOfFragments)
+        || (offset != index * static_cast<uint32_t>(Fragmentation::MAX_FRAGMENT_SIZE))
+        || (LENGTH != std::min(static_cast<uint32_t>(Fragmentation::MAX_FRAGMENT_SIZE), totalSize - offset))) {
+        m_discarded++;
+        return nullptr;
+    }
+
+    const auto NOW{std::chrono::steady_clock::now()};
+    expire(NOW);
+
+    Slot *slot{nullptr};
+    for (auto &s : m_slots) {
+        if (s.m_used && (s.m_message == message) && (s.m_from == from)) {
+            slot = &s;
+            break;
+        }
+    }
+    if (nullptr == slot) {
+        // Take a free slot or give up the oldest message.
+        for (auto &s : m_slots) {
+            if (!s.m_used) {
+                slot = &s;
+                break;
             }
-#pragma GCC diagnostic pop
+            if ((nullptr == slot) || (s.m_started < slot->m_started)) {
+                slot = &s;
+            }
+        }
+        if (slot->m_used) {
+            m_lost++;
         }
+        try {
+            slot->m_used             = true;
+            slot->m_from             = from;
+            slot->m_message          = message;
+            slot->m_missingFragments = numberOfFragments;
+            slot->m_started          = NOW;
+            slot->m_received.assign(numberOfFragments, false);
+            slot->m_buffer.resize(totalSize);
+        } catch (...) { // LCOV_EXCL_LINE
+            slot->m_used = false; // LCOV_EXCL_LINE
+            m_discarded++;        // LCOV_EXCL_LINE
+            return nullptr;       // LCOV_EXCL_LINE
+        }
+    }
+
+    if ((slot->m_buffer.size() != totalSize) || (slot->m_received.size() != numberOfFragments) || slot->m_received[index]) {
+        m_discarded++;
+        return nullptr;
+    }
+    std::memcpy(&slot->m_buffer[offset], data + Fragmentation::HEADER_SIZE, LENGTH);
+    slot->m_received[index] = true;
+    slot->m_missingFragments--;
+
+    if (0 == slot->m_missingFragments) {
+        m_reassembled++;
+        m_completed = slot;
+        return &slot->m_buffer;
     }
+    return nullptr;
 }
 
-inline bool SharedMemory::validSysV() noexcept {
-    return (-1 != m_sharedMemoryIDSysV) && (nullptr != m_sharedMemory) && (0 < m_size) && (-1 != m_mutexIDSysV) && (-1 != m_conditionIDSysV);
+inline FragmentAssembler::Statistics FragmentAssembler::statistics() const noexcept {
+    Statistics s;
+    s.m_fragments   = m_fragments.load();
+    s.m_reassembled = m_reassembled.load();
+    s.m_lost        = m_lost.load();
+    s.m_discarded   = m_discarded.load();
+    return s;
 }
-#endif
 
 } // namespace cluon
 #endif
@@ -17705,8 +22483,11 @@ int32_t main(int32_t argc, char **argv) {
 //#include "cluon/OD4Session.hpp"
 //#include "cluon/ToProtoVisitor.hpp"
 //#include "cluon/Player.hpp"
+//#include "cluon/MergedPlayer.hpp"
 //#include "cluon/cluonDataStructures.hpp"
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -17714,6 +22495,7 @@ int32_t main(int32_t argc, char **argv) {
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 inline int32_t cluon_replay(int32_t argc, char **argv) {
     int32_t retCode{0};
@@ -17721,38 +22503,65 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
     auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
     if (1 == argc) {
         std::cerr << PROGRAM << " replays a .rec file into an OpenDaVINCI session or to stdout; if playing back to an OD4Session using parameter --cid, you can specify the optional parameter --stdout to also playback to stdout; --keeprunning keeps " << PROGRAM << " open at the end of a recording file." << std::endl;
-        std::cerr << "Usage:   " << PROGRAM << " [--cid=<OpenDaVINCI session> [--stdout] [--keeprunning]] recording.rec" << std::endl;
+        std::cerr << "Using --lockstep=<dataType> together with --cid replays the recording as fast as the consumer allows: after every Envelope of the given dataType, " << PROGRAM << " waits until a cluon.data.PlayerCommand with command = " << +cluon::data::PlayerCommand::LOCKSTEP_ACKNOWLEDGE << " is received before advancing (at most --acktimeout milliseconds, default 5000)." << std::endl;
+        std::cerr << "Several .rec files are replayed as one stream ordered by sample time stamp." << std::endl;
+        std::cerr << "Usage:   " << PROGRAM << " [--cid=<OpenDaVINCI session> [--stdout] [--keeprunning] [--lockstep=<dataType> [--acktimeout=<ms>]]] recording.rec [more.rec ...]" << std::endl;
         std::cerr << "Example: " << PROGRAM << " --cid=111 file.rec" << std::endl;
         std::cerr << "         " << PROGRAM << " --cid=111 --stdout file.rec" << std::endl;
+        std::cerr << "         " << PROGRAM << " --cid=111 --lockstep=1055 file.rec" << std::endl;
+        std::cerr << "         " << PROGRAM << " --cid=111 camera.rec imu.rec" << std::endl;
         std::cerr << "         " << PROGRAM << " file.rec" << std::endl;
         retCode = 1;
     }
     else {
         const bool playBackToStdout = ( (0 != commandlineArguments.count("stdout")) || (0 == commandlineArguments.count("cid")) );
         const bool keepRunning = (0 != commandlineArguments.count("keeprunning"));
-
-        std::string recFile;
+        // In lockstep mode, the replay does not follow the recorded timing but
+        // waits for an acknowledgement after every Envelope of the given type.
+        const bool lockstep = ( (0 != commandlineArguments.count("lockstep")) && (0 != commandlineArguments.count("cid")) );
+        const int32_t LOCKSTEP_DATATYPE{lockstep ? std::stoi(commandlineArguments["lockstep"]) : 0};
+        const std::chrono::milliseconds ACK_TIMEOUT{(0 != commandlineArguments.count("acktimeout")) ? std::stoi(commandlineArguments["acktimeout"]) : 5000};
+
+        std::vector<std::string> recFiles;
+        std::string missingRecFile;
         for (auto e : commandlineArguments) {
-            if (recFile.empty() && e.second.empty() && e.first != PROGRAM) {
-                recFile = e.first;
-                break;
+            if (e.second.empty() && e.first != PROGRAM) {
+                recFiles.push_back(e.first);
+                std::fstream fin(e.first, std::ios::in|std::ios::binary);
+                if (!fin.good() && missingRecFile.empty()) {
+                    missingRecFile = e.first;
+                }
             }
         }
 
-        std::fstream fin(recFile, std::ios::in|std::ios::binary);
-        if (fin.good()) {
+        if (!recFiles.empty() && missingRecFile.empty()) {
             std::atomic<bool> playCommandUpdate{false};
             std::mutex playerCommandMutex;
             cluon::data::PlayerCommand playerCommand;
 
+            // Acknowledgements from the consumer in lockstep mode (PlayerCommand::LOCKSTEP_ACKNOWLEDGE).
+            std::mutex lockstepMutex;
+            std::condition_variable lockstepCondition;
+            uint64_t lockstepFramesSent{0};
+            uint64_t lockstepFramesAcknowledged{0};
+
             // Create an OD4Session to relay the.
             std::unique_ptr<cluon::OD4Session> od4;
             if (0 != commandlineArguments.count("cid")) {
                 // Interface to a running OpenDaVINCI session and listening for PlayerCommands.
                 od4 = std::make_unique<cluon::OD4Session>(static_cast<uint16_t>(std::stoi(commandlineArguments["cid"]))); // LCOV_EXCL_LINE
                 if (od4) {
-                    od4->dataTrigger(cluon::data::PlayerCommand::ID(), [&playCommandUpdate, &playerCommandMutex, &playerCommand](cluon::data::Envelope &&env){
+                    od4->dataTrigger(cluon::data::PlayerCommand::ID(), [&playCommandUpdate, &playerCommandMutex, &playerCommand, &lockstepMutex, &lockstepCondition, &lockstepFramesSent, &lockstepFramesAcknowledged](cluon::data::Envelope &&env){
                         cluon::data::PlayerCommand pc = cluon::extractMessage<cluon::data::PlayerCommand>(std::move(env));
+                        if (cluon::data::PlayerCommand::LOCKSTEP_ACKNOWLEDGE == pc.command()) {
+                            {
+                                std::lock_guard<std::mutex> lck(lockstepMutex);
+                                // Late acknowledgements for frames that already timed out must not count for the next one.
+                                lockstepFramesAcknowledged = (std::min)(lockstepFramesAcknowledged + 1, lockstepFramesSent);
+                            }
+                            lockstepCondition.notify_all();
+                            return;
+                        }
                         {
                             std::lock_guard<std::mutex> lck(playerCommandMutex);
                             playerCommand = pc;
@@ -17790,57 +22599,20 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
                     std::cout.flush();
                 }
             }
-            constexpr bool AUTOREWIND{false};
-            constexpr bool THREADING{true};
-            cluon::Player player(recFile, AUTOREWIND, THREADING);
-            player.setPlayerListener([&playerStatusUpdate, &playerStatusMutex, &playerStatus](cluon::data::PlayerStatus &&ps){
-                {
-                    std::lock_guard<std::mutex> lck(playerStatusMutex);
-                    playerStatus = ps;
-                }
-                playerStatusUpdate = true;
-            });
+            // Several recordings are replayed as one stream ordered by sample time stamp.
+            auto replay = [&](auto &player) {
+                player.setPlayerListener([&playerStatusUpdate, &playerStatusMutex, &playerStatus](cluon::data::PlayerStatus &&ps){
+                    {
+                        std::lock_guard<std::mutex> lck(playerStatusMutex);
+                        playerStatus = ps;
+                    }
+                    playerStatusUpdate = true;
+                });
 
-            {
-                std::string s;
-                playerStatus.numberOfEntries(player.totalNumberOfEnvelopesInRecFile());
-                playerStatus.state(2); // playback file
                 {
-                    std::lock_guard<std::mutex> lck(playerStatusMutex);
-
-                    cluon::ToProtoVisitor protoEncoder;
-                    playerStatus.accept(protoEncoder);
-                    s = protoEncoder.encodedData();
-                }
-                cluon::data::Envelope env;
-                env.dataType(playerStatus.ID())
-                   .sent(cluon::time::now())
-                   .sampleTimeStamp(cluon::time::now())
-                   .serializedData(s);
-
-                if (od4 && od4->isRunning()) {
-                    od4->send(std::move(env));
-                }
-                else {
-                    std::cout << cluon::serializeEnvelope(std::move(env));
-                    std::cout.flush();
-                }
-            }
-
-            bool play = true;
-            bool step = false;
-            while ( (player.hasMoreData() || keepRunning) ) {
-                // Stop execution in case of a running OD4Session.
-                if (od4 && !od4->isRunning()) {
-                    break;
-                }
-                // If we are at the end of the playback file, simply wait a little to avoid excessive system load.
-                if (!player.hasMoreData() && keepRunning) {
-                    std::this_thread::sleep_for(std::chrono::duration<int32_t, std::milli>(200)); // LCOV_EXCL_LINE
-                }
-                // Check for broadcasting status updates.
-                if (playerStatusUpdate) {
                     std::string s;
+                    playerStatus.numberOfEntries(player.totalNumberOfEnvelopesInRecFile());
+                    playerStatus.state(2); // playback file
                     {
                         std::lock_guard<std::mutex> lck(playerStatusMutex);
 
@@ -17855,64 +22627,131 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
                        .serializedData(s);
 
                     if (od4 && od4->isRunning()) {
-                        cluon::data::Envelope e = env;
-                        od4->send(std::move(e));
+                        od4->send(std::move(env));
                     }
-                    if (playBackToStdout) {
-                        cluon::data::Envelope e = env;
-                        std::cout << cluon::serializeEnvelope(std::move(e));
+                    else {
+                        std::cout << cluon::serializeEnvelope(std::move(env));
                         std::cout.flush();
                     }
-                    playerStatusUpdate = false;
                 }
-                // Check for remotely controlling the player.
-                if (playCommandUpdate) {
-                    std::lock_guard<std::mutex> lck(playerCommandMutex);
-                    if ( (playerCommand.command() == 1) || (playerCommand.command() == 2) ) {
-                        play = !(2 == playerCommand.command()); // LCOV_EXCL_LINE
-                        std::clog << PROGRAM << ": Change state: " << +playerCommand.command() << ", play = " << play << std::endl;
-                    }
 
-                    if (3 == playerCommand.command()) {
-                        std::clog << PROGRAM << ": Change state: " << +playerCommand.command() << ", seekTo: " << playerCommand.seekTo() << std::endl;
-                        player.seekTo(playerCommand.seekTo());
+                bool play = true;
+                bool step = false;
+                while ( (player.hasMoreData() || keepRunning) ) {
+                    // Stop execution in case of a running OD4Session.
+                    if (od4 && !od4->isRunning()) {
+                        break;
                     }
-
-                    if (4 == playerCommand.command()) {
-                        play = false;
-                        step = true;
-                        std::clog << PROGRAM << ": Change state: " << +playerCommand.command() << ", play = " << play << std::endl;
+                    // If we are at the end of the playback file, simply wait a little to avoid excessive system load.
+                    if (!player.hasMoreData() && keepRunning) {
+                        std::this_thread::sleep_for(std::chrono::duration<int32_t, std::milli>(200)); // LCOV_EXCL_LINE
                     }
+                    // Check for broadcasting status updates.
+                    if (playerStatusUpdate) {
+                        std::string s;
+                        {
+                            std::lock_guard<std::mutex> lck(playerStatusMutex);
+
+                            cluon::ToProtoVisitor protoEncoder;
+                            playerStatus.accept(protoEncoder);
+                            s = protoEncoder.encodedData();
+                        }
+                        cluon::data::Envelope env;
+                        env.dataType(playerStatus.ID())
+                           .sent(cluon::time::now())
+                           .sampleTimeStamp(cluon::time::now())
+                           .serializedData(s);
 
-                    playCommandUpdate = false;
-                }
-                // If playback is desired, relay the Envelope to the OD4Session.
-                if (play || step) {
-                    auto next = player.getNextEnvelopeToBeReplayed();
-                    if (next.first) {
                         if (od4 && od4->isRunning()) {
-                            cluon::data::Envelope e = next.second;
+                            cluon::data::Envelope e = env;
                             od4->send(std::move(e));
                         }
                         if (playBackToStdout) {
-                            cluon::data::Envelope e = next.second;
+                            cluon::data::Envelope e = env;
                             std::cout << cluon::serializeEnvelope(std::move(e));
                             std::cout.flush();
                         }
-                        std::this_thread::sleep_for(std::chrono::duration<int32_t, std::micro>(player.delay()));
+                        playerStatusUpdate = false;
+                    }
+                    // Check for remotely controlling the player.
+                    if (playCommandUpdate) {
+                        std::lock_guard<std::mutex> lck(playerCommandMutex);
+                        if ( (playerCommand.command() == cluon::data::PlayerCommand::PLAY) || (playerCommand.command() == cluon::data::PlayerCommand::PAUSE) ) {
+                            play = !(cluon::data::PlayerCommand::PAUSE == playerCommand.command()); // LCOV_EXCL_LINE
+                            std::clog << PROGRAM << ": Change state: " << +playerCommand.command() << ", play = " << play << std::endl;
+                        }
+
+                        if (cluon::data::PlayerCommand::SEEK_TO == playerCommand.command()) {
+                            std::clog << PROGRAM << ": Change state: " << +playerCommand.command() << ", seekTo: " << playerCommand.seekTo() << std::endl;
+                            player.seekTo(playerCommand.seekTo());
+                        }
+
+                        if (cluon::data::PlayerCommand::STEP == playerCommand.command()) {
+                            play = false;
+                            step = true;
+                            std::clog << PROGRAM << ": Change state: " << +playerCommand.command() << ", play = " << play << std::endl;
+                        }
+
+                        playCommandUpdate = false;
+                    }
+                    // If playback is desired, relay the Envelope to the OD4Session.
+                    if (play || step) {
+                        auto next = player.getNextEnvelopeToBeReplayed();
+                        if (next.first) {
+                            const bool waitForAcknowledgement{lockstep && (LOCKSTEP_DATATYPE == next.second.dataType())};
+                            if (waitForAcknowledgement) {
+                                std::lock_guard<std::mutex> lck(lockstepMutex);
+                                lockstepFramesSent++;
+                            }
+                            if (od4 && od4->isRunning()) {
+                                cluon::data::Envelope e = next.second;
+                                od4->send(std::move(e));
+                            }
+                            if (playBackToStdout) {
+                                cluon::data::Envelope e = next.second;
+                                std::cout << cluon::serializeEnvelope(std::move(e));
+                                std::cout.flush();
+                            }
+                            if (waitForAcknowledgement) {
+                                std::unique_lock<std::mutex> lck(lockstepMutex);
+                                const auto DEADLINE{std::chrono::steady_clock::now() + ACK_TIMEOUT};
+                                // Wake up regularly to not miss a terminating OD4Session.
+                                while ((lockstepFramesAcknowledged < lockstepFramesSent) && od4->isRunning() && (std::chrono::steady_clock::now() < DEADLINE)) {
+                                    lockstepCondition.wait_until(lck, (std::min)(DEADLINE, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+                                }
+                                if (lockstepFramesAcknowledged < lockstepFramesSent) {
+                                    std::clog << PROGRAM << ": No acknowledgement for Envelope " << lockstepFramesSent << " of type " << LOCKSTEP_DATATYPE << " within " << ACK_TIMEOUT.count() << " ms; advancing." << std::endl;
+                                    lockstepFramesAcknowledged = lockstepFramesSent;
+                                }
+                            }
+                            else if (!lockstep) {
+                                std::this_thread::sleep_for(std::chrono::duration<int32_t, std::micro>(player.delay()));
+                            }
+                        }
                     }
+                    else {
+                        std::this_thread::sleep_for(std::chrono::duration<int32_t, std::milli>(100)); // LCOV_EXCL_LINE
+                    } // LCOV_EXCL_LINE
+
+                    // Reset step.
+                    step = false;
                 }
-                else {
-                    std::this_thread::sleep_for(std::chrono::duration<int32_t, std::milli>(100)); // LCOV_EXCL_LINE
-                } // LCOV_EXCL_LINE
+            };
 
-                // Reset step.
-                step = false;
+            constexpr bool AUTOREWIND{false};
+            if (1 < recFiles.size()) {
+                cluon::MergedPlayer player(recFiles, AUTOREWIND);
+                replay(player);
+            }
+            else {
+                constexpr bool THREADING{true};
+                cluon::Player player(recFiles.front(), AUTOREWIND, THREADING);
+                replay(player);
             }
             retCode = 0;
         }
         else {
-            std::cerr << PROGRAM << ": file '" << recFile << "' not found." << std::endl;
+            std::cerr << PROGRAM << ": file '" << missingRecFile << "' not found." << std::endl;
             retCode = 1;
         }
     }
@@ -17958,16 +22797,19 @@ int32_t main(int32_t argc, char **argv) {
 //#include "cluon/OD4Session.hpp"
 //#include "cluon/TerminateHandler.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <unordered_map>
-#include <mutex>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 enum Color {
     RED     = 31,
@@ -17993,6 +22835,197 @@ inline std::string formatTimeStamp(const cluon::data::TimeStamp &ts) {
     return str;
 }
 
+/**
+This class keeps statistics per tupel (dataType, senderStamp) in a fixed-size
+open-addressing table of atomics. Updating does neither allocate nor lock, and
+snapshot() can be called concurrently to update(); every slot is guarded by a
+sequence counter so that a snapshot never shows a half-updated entry. There
+must be only one thread calling update(), like the receiving thread of an
+OD4Session.
+*/
+class LiveFeedStatistics {
+   private:
+    LiveFeedStatistics(const LiveFeedStatistics &) = delete;
+    LiveFeedStatistics(LiveFeedStatistics &&)      = delete;
+    LiveFeedStatistics &operator=(const LiveFeedStatistics &) = delete;
+    LiveFeedStatistics &operator=(LiveFeedStatistics &&) = delete;
+
+   public:
+    struct Entry {
+        int32_t m_dataType{0};
+        uint32_t m_senderStamp{0};
+        uint64_t m_numberOfEnvelopes{0};
+        int64_t m_sent{0};            // Microseconds.
+        int64_t m_received{0};        // Microseconds.
+        int64_t m_sampleTimeStamp{0}; // Microseconds.
+        float m_rate{0};              // Envelopes per second, moving average.
+        float m_bytesPerSecond{0};    // Payload bytes per second, moving average.
+        int64_t m_minInterArrival{0}; // Microseconds between sample time stamps; 0 while unknown.
+        int64_t m_maxInterArrival{0}; // Microseconds between sample time stamps; 0 while unknown.
+    };
+
+    enum : uint32_t {
+        CAPACITY = 4096, // Must be a power of two.
+    };
+
+   private:
+    enum : uint32_t {
+        FREE    = 0,
+        CLAIMED = 1,
+        READY   = 2,
+    };
+
+    struct Slot {
+        std::atomic<uint32_t> m_state{FREE};
+        std::atomic<int32_t> m_dataType{0};
+        std::atomic<uint32_t> m_senderStamp{0};
+
+        // Odd while update() is writing the fields below.
+        std::atomic<uint32_t> m_sequence{0};
+        std::atomic<uint64_t> m_numberOfEnvelopes{0};
+        std::atomic<int64_t> m_sent{0};
+        std::atomic<int64_t> m_received{0};
+        std::atomic<int64_t> m_sampleTimeStamp{0};
+        std::atomic<float> m_rate{0};
+        std::atomic<float> m_bytesPerSecond{0};
+        std::atomic<int64_t> m_minInterArrival{0};
+        std::atomic<int64_t> m_maxInterArrival{0};
+    };
+
+   public:
+    LiveFeedStatistics() noexcept
+        : m_slots{new Slot[CAPACITY]} {}
+
+    /**
+     * This method accounts for the given Envelope unless its sample time
+     * stamp is the same as the one of the previous Envelope of its tupel.
+     */
+    void update(const cluon::data::Envelope &envelope) noexcept {
+        Slot *slot{find(envelope.dataType(), envelope.senderStamp())};
+        if (nullptr == slot) {
+            m_numberOfDroppedEnvelopes.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const int64_t SAMPLE_TIMESTAMP{cluon::time::toMicroseconds(envelope.sampleTimeStamp())};
+        const uint64_t NUMBER_OF_ENVELOPES{slot->m_numberOfEnvelopes.load(std::memory_order_relaxed)};
+        const int64_t LAST_SAMPLE_TIMESTAMP{slot->m_sampleTimeStamp.load(std::memory_order_relaxed)};
+        if ((0 < NUMBER_OF_ENVELOPES) && (SAMPLE_TIMESTAMP == LAST_SAMPLE_TIMESTAMP)) {
+            return;
+        }
+
+        float rate{slot->m_rate.load(std::memory_order_relaxed)};
+        float bytesPerSecond{slot->m_bytesPerSecond.load(std::memory_order_relaxed)};
+        int64_t minInterArrival{slot->m_minInterArrival.load(std::memory_order_relaxed)};
+        int64_t maxInterArrival{slot->m_maxInterArrival.load(std::memory_order_relaxed)};
+        const int64_t DELTA{SAMPLE_TIMESTAMP - LAST_SAMPLE_TIMESTAMP};
+        if ((0 < NUMBER_OF_ENVELOPES) && (0 < DELTA)) {
+            const float SECONDS{static_cast<float>(DELTA) / (1000.0f * 1000.0f)};
+            rate           = (1.0f / SECONDS) * 0.1f + 0.9f * rate;
+            bytesPerSecond = (static_cast<float>(envelope.serializedData().size()) / SECONDS) * 0.1f + 0.9f * bytesPerSecond;
+            minInterArrival = ((0 == minInterArrival) || (DELTA < minInterArrival)) ? DELTA : minInterArrival;
+            maxInterArrival = std::max(DELTA, maxInterArrival);
+        }
+
+        const uint32_t SEQUENCE{slot->m_sequence.load(std::memory_order_relaxed)};
+        slot->m_sequence.store(SEQUENCE + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->m_numberOfEnvelopes.store(NUMBER_OF_ENVELOPES + 1, std::memory_order_relaxed);
+        slot->m_sent.store(cluon::time::toMicroseconds(envelope.sent()), std::memory_order_relaxed);
+        slot->m_received.store(cluon::time::toMicroseconds(envelope.received()), std::memory_order_relaxed);
+        slot->m_sampleTimeStamp.store(SAMPLE_TIMESTAMP, std::memory_order_relaxed);
+        slot->m_rate.store(rate, std::memory_order_relaxed);
+        slot->m_bytesPerSecond.store(bytesPerSecond, std::memory_order_relaxed);
+        slot->m_minInterArrival.store(minInterArrival, std::memory_order_relaxed);
+        slot->m_maxInterArrival.store(maxInterArrival, std::memory_order_relaxed);
+        slot->m_sequence.store(SEQUENCE + 2, std::memory_order_release);
+    }
+
+    /**
+     * @return Consistent copies of all entries, sorted by dataType and senderStamp.
+     */
+    std::vector<Entry> snapshot() const noexcept {
+        std::vector<Entry> entries;
+        try {
+            for (uint32_t i{0}; i < CAPACITY; i++) {
+                const Slot &slot{m_slots[i]};
+                if (READY != slot.m_state.load(std::memory_order_acquire)) {
+                    continue;
+                }
+
+                Entry e;
+                e.m_dataType    = slot.m_dataType.load(std::memory_order_relaxed);
+                e.m_senderStamp = slot.m_senderStamp.load(std::memory_order_relaxed);
+                uint32_t before{0};
+                uint32_t after{0};
+                do {
+                    before = slot.m_sequence.load(std::memory_order_acquire);
+                    if (0 != (before & 1)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    e.m_numberOfEnvelopes = slot.m_numberOfEnvelopes.load(std::memory_order_relaxed);
+                    e.m_sent              = slot.m_sent.load(std::memory_order_relaxed);
+                    e.m_received          = slot.m_received.load(std::memory_order_relaxed);
+                    e.m_sampleTimeStamp   = slot.m_sampleTimeStamp.load(std::memory_order_relaxed);
+                    e.m_rate              = slot.m_rate.load(std::memory_order_relaxed);
+                    e.m_bytesPerSecond    = slot.m_bytesPerSecond.load(std::memory_order_relaxed);
+                    e.m_minInterArrival   = slot.m_minInterArrival.load(std::memory_order_relaxed);
+                    e.m_maxInterArrival   = slot.m_maxInterArrival.load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    after = slot.m_sequence.load(std::memory_order_relaxed);
+                } while ((0 != (before & 1)) || (before != after));
+
+                if (0 < e.m_numberOfEnvelopes) {
+                    entries.push_back(e);
+                }
+            }
+            std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+                return (a.m_dataType < b.m_dataType) || ((a.m_dataType == b.m_dataType) && (a.m_senderStamp < b.m_senderStamp));
+            });
+        } catch (...) {} // LCOV_EXCL_LINE
+        return entries;
+    }
+
+    /**
+     * @return Number of Envelopes not accounted for as the table was full.
+     */
+    uint64_t numberOfDroppedEnvelopes() const noexcept {
+        return m_numberOfDroppedEnvelopes.load(std::memory_order_relaxed);
+    }
+
+   private:
+    Slot *find(int32_t dataType, uint32_t senderStamp) noexcept {
+        const uint64_t KEY{(static_cast<uint64_t>(static_cast<uint32_t>(dataType)) << 32) | senderStamp};
+        // Fibonacci hashing spreads consecutive data types and sender stamps over the table.
+        uint32_t i{static_cast<uint32_t>((KEY * 0x9E3779B97F4A7C15ull) >> 32) & (CAPACITY - 1)};
+        for (uint32_t probe{0}; probe < CAPACITY; probe++, i = (i + 1) & (CAPACITY - 1)) {
+            Slot &slot{m_slots[i]};
+            uint32_t state{slot.m_state.load(std::memory_order_acquire)};
+            if (FREE == state) {
+                if (slot.m_state.compare_exchange_strong(state, CLAIMED, std::memory_order_acq_rel)) {
+                    slot.m_dataType.store(dataType, std::memory_order_relaxed);
+                    slot.m_senderStamp.store(senderStamp, std::memory_order_relaxed);
+                    slot.m_state.store(READY, std::memory_order_release);
+                    return &slot;
+                }
+            }
+            while (CLAIMED == state) {
+                std::this_thread::yield();
+                state = slot.m_state.load(std::memory_order_acquire);
+            }
+            if ((slot.m_dataType.load(std::memory_order_relaxed) == dataType) && (slot.m_senderStamp.load(std::memory_order_relaxed) == senderStamp)) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+   private:
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_numberOfDroppedEnvelopes{0};
+};
+
 inline int32_t cluon_livefeed(int32_t argc, char **argv) {
     int retVal{1};
     const std::string PROGRAM{argv[0]}; // NOLINT
@@ -18024,80 +23057,50 @@ inline int32_t cluon_livefeed(int32_t argc, char **argv) {
             }
         }
 
-        std::mutex mapOfLastEnvelopesMutex;
-        std::unordered_map<int32_t, std::unordered_map<uint32_t, cluon::data::Envelope, cluon::UseUInt32ValueAsHashKey>, cluon::UseUInt32ValueAsHashKey> mapOfLastEnvelopes;
-        std::unordered_map<int32_t, std::unordered_map<uint32_t, float>, cluon::UseUInt32ValueAsHashKey> mapOfUpdateRates;
+        LiveFeedStatistics statistics;
 
         cluon::OD4Session od4Session(static_cast<uint16_t>(std::stoi(commandlineArguments["cid"])),
-            [&mapOfLastEnvelopesMutex, &mapOfLastEnvelopes, &mapOfUpdateRates](cluon::data::Envelope &&envelope) noexcept {
-            std::lock_guard<std::mutex> lck(mapOfLastEnvelopesMutex);
-
-            int64_t lastTimeStamp{0};
-            int64_t currentTimeStamp{0};
-            {
-                // Update mapping for tupel (dataType, senderStamp) --> Envelope.
-                auto entry = mapOfLastEnvelopes[envelope.dataType()];
-                if (0 != entry.count(envelope.senderStamp())) {
-                    lastTimeStamp = cluon::time::toMicroseconds(entry[envelope.senderStamp()].sampleTimeStamp()); // LCOV_EXCL_LINE
-                }
-                currentTimeStamp = cluon::time::toMicroseconds(envelope.sampleTimeStamp()); // LCOV_EXCL_LINE
-                if (currentTimeStamp != lastTimeStamp) {
-                    entry[envelope.senderStamp()] = envelope; // LCOV_EXCL_LINE
-                    mapOfLastEnvelopes[envelope.dataType()] = entry; // LCOV_EXCL_LINE
-                }
-            }
-            if (currentTimeStamp != lastTimeStamp) {
-                // Update mapping for tupel (dataType, senderStamp) --> deltaToLastEnvelope.
-                auto entry = mapOfUpdateRates[envelope.dataType()];
-
-                float average{0};
-                if (0 != entry.count(envelope.senderStamp())) {
-                    average = entry[envelope.senderStamp()]; // LCOV_EXCL_LINE
-                    float freq = (static_cast<float>(currentTimeStamp - lastTimeStamp))/(1000.0f*1000.0f); // LCOV_EXCL_LINE
-                    average = (1.0f/freq)*0.1f + 0.9f*average; // LCOV_EXCL_LINE
-                }
-                entry[envelope.senderStamp()] = average;
-                mapOfUpdateRates[envelope.dataType()] = entry;
-            }
+            [&statistics](cluon::data::Envelope &&envelope) noexcept {
+            statistics.update(envelope);
         });
 
         if (od4Session.isRunning()) {
-            od4Session.timeTrigger(5, [&mapOfLastEnvelopesMutex, &mapOfLastEnvelopes, &mapOfUpdateRates, &scopeOfMetaMessages, &od4Session](){
-                std::lock_guard<std::mutex> lck(mapOfLastEnvelopesMutex);
+            od4Session.timeTrigger(5, [&statistics, &scopeOfMetaMessages, &od4Session](){
+                const auto entries = statistics.snapshot();
 
-                if (!mapOfLastEnvelopes.empty()) {
+                if (!entries.empty()) {
                     clearScreen();
 
                     uint8_t y = 1;
                     const uint8_t x = 1;
-                    for (auto e : mapOfLastEnvelopes) {
-                        for (auto ee : e.second) {
-                            auto env = ee.second;
-                            std::stringstream sstr;
-
-                            float freq{0};
-                            if ( (0 < mapOfUpdateRates.count(ee.second.dataType())) && (0 < mapOfUpdateRates[ee.second.dataType()].count(ee.second.senderStamp())) ) {
-                                freq = mapOfUpdateRates[ee.second.dataType()][ee.second.senderStamp()];
-                            }
-
-                            sstr << "Envelope: " << std::setfill(' ') << std::setw(5) << env.dataType() << std::setw(0) << "/" << env.senderStamp() << "; " << (static_cast<float>(static_cast<uint32_t>(freq*100.0f))/100.f) << " Hz; " << "sent: " << formatTimeStamp(env.sent()) << "; sample: " << formatTimeStamp(env.sampleTimeStamp());
-                            if (scopeOfMetaMessages.count(env.dataType()) > 0) {
-                                sstr << "; " << scopeOfMetaMessages[env.dataType()].messageName();
-                            }
-                            else {
-                                sstr << "; unknown data type";
-                            }
-                            sstr << std::endl;
+                    for (const auto &e : entries) {
+                        std::stringstream sstr;
+
+                        sstr << "Envelope: " << std::setfill(' ') << std::setw(5) << e.m_dataType << std::setw(0) << "/" << e.m_senderStamp << "; " << (static_cast<float>(static_cast<uint32_t>(e.m_rate*100.0f))/100.f) << " Hz; "
+                             << (static_cast<float>(static_cast<uint32_t>(e.m_bytesPerSecond/10.24f))/100.f) << " kB/s; "
+                             << "interval: " << (static_cast<float>(e.m_minInterArrival/10)/100.f) << "-" << (static_cast<float>(e.m_maxInterArrival/10)/100.f) << " ms; "
+                             << "sent: " << formatTimeStamp(cluon::time::fromMicroseconds(e.m_sent)) << "; sample: " << formatTimeStamp(cluon::time::fromMicroseconds(e.m_sampleTimeStamp));
+                        if (scopeOfMetaMessages.count(e.m_dataType) > 0) {
+                            sstr << "; " << scopeOfMetaMessages[e.m_dataType].messageName();
+                        }
+                        else {
+                            sstr << "; unknown data type";
+                        }
+                        sstr << std::endl;
 
-                            const auto AGE{cluon::time::deltaInMicroseconds(cluon::time::now(), env.received())};
+                        const auto AGE{cluon::time::deltaInMicroseconds(cluon::time::now(), cluon::time::fromMicroseconds(e.m_received))};
 
-                            Color c = Color::DEFAULT;
-                            if (AGE <= 2 * 1000 * 1000) { c = Color::GREEN; }
-                            if (AGE > 2 * 1000 * 1000 && AGE <= 5 * 1000 * 1000) { c = Color::YELLOW; }
-                            if (AGE > 5 * 1000 * 1000) { c = Color::RED; }
+                        Color c = Color::DEFAULT;
+                        if (AGE <= 2 * 1000 * 1000) { c = Color::GREEN; }
+                        if (AGE > 2 * 1000 * 1000 && AGE <= 5 * 1000 * 1000) { c = Color::YELLOW; }
+                        if (AGE > 5 * 1000 * 1000) { c = Color::RED; }
 
-                            writeText(c, y++, x, sstr.str());
-                        }
+                        writeText(c, y++, x, sstr.str());
+                    }
+                    if (0 < statistics.numberOfDroppedEnvelopes()) {
+                        std::stringstream sstr;
+                        sstr << statistics.numberOfDroppedEnvelopes() << " Envelope(s) not shown as more than " << LiveFeedStatistics::CAPACITY << " tupels (dataType, senderStamp) were received." << std::endl;
+                        writeText(Color::RED, y++, x, sstr.str());
                     }
                 }
                 return od4Session.isRunning();
@@ -18328,3 +23331,183 @@ int32_t main(int32_t argc, char **argv) {
     return cluon_rec2csv(argc, argv);
 }
 #endif
+#ifdef HAVE_CLUON_RECORDER
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_RECORDER_TOOL_HPP
+#define CLUON_RECORDER_TOOL_HPP
+
+//#include "cluon/cluon.hpp"
+//#include "cluon/OD4Session.hpp"
+//#include "cluon/Recorder.hpp"
+//#include "cluon/CompressedRec.hpp"
+//#include "cluon/Player.hpp"
+//#include "cluon/TerminateHandler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+inline int32_t cluon_recorder_export(const std::string &PROGRAM, const std::string &from, const std::string &to, bool verify) {
+    using Clock = std::chrono::steady_clock;
+    auto megabytesPerSecond = [](uint64_t bytes, Clock::duration duration) {
+        const double SECONDS{std::chrono::duration<double>(duration).count()};
+        return (0.0 < SECONDS) ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / SECONDS : 0.0;
+    };
+
+    std::fstream fin(from, std::ios::in | std::ios::binary);
+    if (!fin.good()) {
+        std::cerr << PROGRAM << ": Could not open '" << from << "'." << std::endl;
+        return 1;
+    }
+
+    uint64_t envelopes{0};
+    uint64_t uncompressedBytes{0};
+    uint64_t compressedBytes{0};
+    const auto COMPRESSION_START{Clock::now()};
+    {
+        cluon::CompressedRecWriter writer(to);
+        if (!writer.isOpen()) {
+            return 1;
+        }
+        while (fin.good()) {
+            auto retVal = cluon::extractEnvelope(fin);
+            if (retVal.first) {
+                const int64_t SAMPLE_TIME_STAMP{cluon::time::toMicroseconds(retVal.second.sampleTimeStamp())};
+                const std::string DATA{cluon::serializeEnvelope(std::move(retVal.second))};
+                writer.append(DATA.data(), DATA.size(), SAMPLE_TIME_STAMP);
+                envelopes++;
+            }
+        }
+        writer.close();
+        uncompressedBytes = writer.uncompressedBytes();
+        compressedBytes   = writer.compressedBytes();
+    }
+    const auto COMPRESSION_DURATION{Clock::now() - COMPRESSION_START};
+
+    std::cout << PROGRAM << ": Exported " << envelopes << " Envelopes from '" << from << "' to '" << to << "': " << uncompressedBytes << " bytes -> "
+              << compressedBytes << " bytes (ratio "
+              << ((0 < compressedBytes) ? static_cast<double>(uncompressedBytes) / static_cast<double>(compressedBytes) : 0.0) << "), compressed with "
+              << megabytesPerSecond(uncompressedBytes, COMPRESSION_DURATION) << " MB/s." << std::endl;
+
+    if (verify) {
+        // Replay both files as fast as possible and compare them Envelope by Envelope.
+        constexpr bool AUTO_REWIND{false};
+        constexpr bool THREADING{false};
+        cluon::Player original(from, AUTO_REWIND, THREADING);
+        cluon::Player compressed(to, AUTO_REWIND, THREADING);
+
+        uint64_t mismatches{0};
+        Clock::duration originalDuration{0};
+        Clock::duration compressedDuration{0};
+        while (original.hasMoreData() || compressed.hasMoreData()) {
+            auto before{Clock::now()};
+            auto a = original.getNextEnvelopeToBeReplayed();
+            originalDuration += Clock::now() - before;
+
+            before = Clock::now();
+            auto b = compressed.getNextEnvelopeToBeReplayed();
+            compressedDuration += Clock::now() - before;
+
+            if ((a.first != b.first) || (cluon::serializeEnvelope(std::move(a.second)) != cluon::serializeEnvelope(std::move(b.second)))) {
+                mismatches++;
+            }
+        }
+
+        std::cout << PROGRAM << ": Read " << uncompressedBytes << " bytes with " << megabytesPerSecond(uncompressedBytes, originalDuration)
+                  << " MB/s from the original and with " << megabytesPerSecond(uncompressedBytes, compressedDuration)
+                  << " MB/s from the compressed file; " << mismatches << " mismatching Envelopes." << std::endl;
+        return (0 == mismatches) ? 0 : 1;
+    }
+    return 0;
+}
+
+inline int32_t cluon_recorder(int32_t argc, char **argv) {
+    int32_t retCode{1};
+    const std::string PROGRAM{argv[0]}; // NOLINT
+    auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+    if ( (0 == commandlineArguments.count("rec")) || ((0 == commandlineArguments.count("cid")) && (0 == commandlineArguments.count("from"))) ) {
+        std::cerr << PROGRAM << " records all Envelopes from an OpenDaVINCI session into a .rec file with a sidecar index (.rec.idx) and per data type counts (.rec.counts.csv)." << std::endl;
+        std::cerr << "Usage:   " << PROGRAM << " --cid=<OpenDaVINCI session> --rec=<file.rec> [--rotatemb=<MB>] [--rotates=<seconds>] [--fsync=never|rotation|batch|<ms>] [--maxqueuemb=<MB>] [--compress]" << std::endl;
+        std::cerr << "         " << PROGRAM << " --from=<file.rec> --rec=<compressed.rec> [--verify]" << std::endl;
+        std::cerr << "         --rotatemb:   start a new file after the given amount of megabytes" << std::endl;
+        std::cerr << "         --rotates:    start a new file after the given amount of seconds" << std::endl;
+        std::cerr << "         --fsync:      force data to disk never (default), when closing a file, after every batch, or every <ms> milliseconds" << std::endl;
+        std::cerr << "         --maxqueuemb: megabytes waiting for the disk before Envelopes are dropped (default: 256)" << std::endl;
+        std::cerr << "         --compress:   write compressed .rec files (LZ4 blocks with an index for seeking; readable by cluon::Player)" << std::endl;
+        std::cerr << "         --from:       export an existing .rec file into a compressed .rec file and report ratio and throughput" << std::endl;
+        std::cerr << "         --verify:     replay both files after exporting, compare them, and report read throughput" << std::endl;
+        std::cerr << "Example: " << PROGRAM << " --cid=111 --rec=myRecording.rec --rotatemb=1024 --fsync=1000" << std::endl;
+    } else if (0 != commandlineArguments.count("from")) {
+        retCode = cluon_recorder_export(PROGRAM, commandlineArguments["from"], commandlineArguments["rec"], 0 != commandlineArguments.count("verify"));
+    } else {
+        const uint64_t ROTATE_AFTER_BYTES{(0 != commandlineArguments.count("rotatemb")) ? static_cast<uint64_t>(std::stoull(commandlineArguments["rotatemb"])) * 1024 * 1024 : 0};
+        const uint32_t ROTATE_AFTER_SECONDS{(0 != commandlineArguments.count("rotates")) ? static_cast<uint32_t>(std::stoul(commandlineArguments["rotates"])) : 0};
+        const uint64_t MAX_QUEUED_BYTES{static_cast<uint64_t>((0 != commandlineArguments.count("maxqueuemb")) ? std::stoull(commandlineArguments["maxqueuemb"]) : 256) * 1024 * 1024};
+
+        cluon::Recorder::FsyncPolicy fsyncPolicy{cluon::Recorder::FsyncPolicy::NEVER};
+        uint32_t fsyncInterval{1000};
+        {
+            const std::string FSYNC{commandlineArguments["fsync"]};
+            if ("rotation" == FSYNC) {
+                fsyncPolicy = cluon::Recorder::FsyncPolicy::ON_ROTATION;
+            } else if ("batch" == FSYNC) {
+                fsyncPolicy = cluon::Recorder::FsyncPolicy::PER_BATCH;
+            } else if (!FSYNC.empty() && ("never" != FSYNC)) {
+                fsyncPolicy   = cluon::Recorder::FsyncPolicy::INTERVAL;
+                fsyncInterval = static_cast<uint32_t>(std::stoul(FSYNC));
+            }
+        }
+
+        const bool COMPRESS{0 != commandlineArguments.count("compress")};
+        cluon::Recorder recorder(commandlineArguments["rec"], ROTATE_AFTER_BYTES, ROTATE_AFTER_SECONDS, fsyncPolicy, fsyncInterval, MAX_QUEUED_BYTES, COMPRESS);
+        if (recorder.isRecording()) {
+            cluon::OD4Session od4Session(static_cast<uint16_t>(std::stoi(commandlineArguments["cid"])), [&recorder](cluon::data::Envelope &&envelope) noexcept {
+                recorder.record(std::move(envelope));
+            });
+
+            uint64_t droppedEnvelopes{0};
+            while (od4Session.isRunning() && recorder.isRecording()) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                if (recorder.numberOfDroppedEnvelopes() != droppedEnvelopes) {
+                    droppedEnvelopes = recorder.numberOfDroppedEnvelopes();
+                    std::cerr << PROGRAM << ": " << droppedEnvelopes << " Envelopes dropped so far." << std::endl;
+                }
+            }
+            retCode = 0;
+        }
+    }
+    return retCode;
+}
+
+#endif
+
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+// This test for a compiler definition is necessary to preserve single-file, header-only compability.
+#ifndef HAVE_CLUON_RECORDER
+#include "cluon-recorder.hpp"
+#endif
+
+#include <cstdint>
+
+int32_t main(int32_t argc, char **argv) {
+    return cluon_recorder(argc, argv);
+}
+#endif
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_CONE_DETECTION_HPP
+#define BENCH_CONE_DETECTION_HPP
+
+#include "bench.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "cone-detection.hpp"
+#include "cone-segmentation.hpp"
+#include "image-pyramid.hpp"
+#include "region-of-interest.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#ifdef BENCH_HAVE_VIDEOIO
+    #include <opencv2/videoio.hpp>
+#endif
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Blob labeling of the cone masks: the single-pass labeling must find the same
+// blobs as a flood fill, first on random masks of random sizes and windows and
+// then on the masks of the frames. With --rec, the frames are the h264
+// ImageReadings of a recording decoded with OpenCV and segmented like in the
+// solution (default region of interest at --level, default 1); otherwise,
+// frames with random cone-like ellipses are used. Labeling both masks of a
+// frame is timed.
+namespace bench {
+
+/**
+ * This method finds the 8-connected blobs within a window with a flood fill; it
+ * is slow but obviously right.
+ */
+inline void floodFillBlobs(const cv::Mat &mask, const cv::Rect &window, uint32_t minArea, std::vector<detection::Blob> &blobs) {
+    const cv::Rect W{window & cv::Rect(0, 0, mask.cols, mask.rows)};
+    std::vector<uint8_t> visited(static_cast<std::size_t>(mask.cols) * static_cast<std::size_t>(mask.rows), 0);
+    std::vector<cv::Point> stack;
+    blobs.clear();
+    for (int y{W.y}; y < W.y + W.height; y++) {
+        for (int x{W.x}; x < W.x + W.width; x++) {
+            if ((0 == mask.ptr<uint8_t>(y)[x]) || (0 != visited[static_cast<std::size_t>(y * mask.cols + x)])) {
+                continue;
+            }
+            uint32_t area{0};
+            uint64_t sumX{0};
+            uint64_t sumY{0};
+            int minX{x}, minY{y}, maxX{x}, maxY{y};
+            visited[static_cast<std::size_t>(y * mask.cols + x)] = 1;
+            stack.push_back(cv::Point(x, y));
+            while (!stack.empty()) {
+                const cv::Point P{stack.back()};
+                stack.pop_back();
+                area++;
+                sumX += static_cast<uint64_t>(P.x);
+                sumY += static_cast<uint64_t>(P.y);
+                minX = std::min(minX, P.x);
+                minY = std::min(minY, P.y);
+                maxX = std::max(maxX, P.x);
+                maxY = std::max(maxY, P.y);
+                for (int dy{-1}; dy <= 1; dy++) {
+                    for (int dx{-1}; dx <= 1; dx++) {
+                        const int NX{P.x + dx};
+                        const int NY{P.y + dy};
+                        if ((W.x <= NX) && (NX < W.x + W.width) && (W.y <= NY) && (NY < W.y + W.height) && (0 != mask.ptr<uint8_t>(NY)[NX])
+                            && (0 == visited[static_cast<std::size_t>(NY * mask.cols + NX)])) {
+                            visited[static_cast<std::size_t>(NY * mask.cols + NX)] = 1;
+                            stack.push_back(cv::Point(NX, NY));
+                        }
+                    }
+                }
+            }
+            if (area >= minArea) {
+                detection::Blob b;
+                b.area = area;
+                b.x    = static_cast<float>(static_cast<double>(sumX) / area);
+                b.y    = static_cast<float>(static_cast<double>(sumY) / area);
+                b.box  = cv::Rect(minX, minY, maxX - minX + 1, maxY - minY + 1);
+                blobs.push_back(b);
+            }
+        }
+    }
+}
+
+/**
+ * @return true if both lists contain the same blobs in any order.
+ */
+inline bool sameBlobs(std::vector<detection::Blob> a, std::vector<detection::Blob> b) {
+    auto order = [](const detection::Blob &l, const detection::Blob &r) {
+        return (l.box.y != r.box.y) ? (l.box.y < r.box.y) : ((l.box.x != r.box.x) ? (l.box.x < r.box.x) : (l.area < r.area));
+    };
+    std::sort(a.begin(), a.end(), order);
+    std::sort(b.begin(), b.end(), order);
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i{0}; i < a.size(); i++) {
+        if ((a[i].area != b[i].area) || (a[i].box.x != b[i].box.x) || (a[i].box.y != b[i].box.y) || (a[i].box.width != b[i].box.width)
+            || (a[i].box.height != b[i].box.height) || (1e-3f < std::fabs(a[i].x - b[i].x)) || (1e-3f < std::fabs(a[i].y - b[i].y))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * This method decodes the h264 ImageReadings of a recording into BGRA frames.
+ *
+ * @return false if the recording cannot be read or decoded.
+ */
+inline bool framesOfRecording(const std::string &rec, uint32_t maxFrames, std::vector<cv::Mat> &frames) {
+#ifdef BENCH_HAVE_VIDEOIO
+    // OpenCV only decodes from files: the frames are concatenated into a raw h264 stream.
+    char directory[]{"/tmp/bench-XXXXXX"};
+    if (nullptr == ::mkdtemp(directory)) {
+        return false;
+    }
+    const std::string STREAM{std::string{directory} + "/frames.h264"};
+    {
+        std::fstream in(rec, std::ios::in | std::ios::binary);
+        std::fstream out(STREAM, std::ios::out | std::ios::binary | std::ios::trunc);
+        while (in.good() && out.good()) {
+            auto retVal{cluon::extractEnvelope(in)};
+            if (!retVal.first) {
+                break;
+            }
+            if (opendlv::proxy::ImageReading::ID() == retVal.second.dataType()) {
+                const auto IMAGE{cluon::extractMessage<opendlv::proxy::ImageReading>(std::move(retVal.second))};
+                if ("h264" == IMAGE.fourcc()) {
+                    out.write(IMAGE.data().data(), static_cast<std::streamsize>(IMAGE.data().size()));
+                }
+            }
+        }
+    }
+    cv::VideoCapture capture(STREAM);
+    cv::Mat bgr;
+    while ((frames.size() < maxFrames) && capture.read(bgr)) {
+        cv::Mat bgra;
+        cv::cvtColor(bgr, bgra, cv::COLOR_BGR2BGRA);
+        frames.push_back(bgra);
+    }
+    std::remove(STREAM.c_str());
+    ::rmdir(directory);
+    return !frames.empty();
+#else
+    (void)rec;
+    (void)maxFrames;
+    (void)frames;
+    std::cerr << "bench was built without OpenCV's videoio and cannot decode recordings." << std::endl;
+    return false;
+#endif
+}
+
+inline int32_t coneDetection(Arguments &arguments) {
+    const uint32_t LEVEL{(0 != arguments.count("level")) ? std::min(static_cast<uint32_t>(std::stoi(arguments["level"])), pyramid::ImagePyramid::LEVELS - 1u) : 1u};
+    const uint32_t MIN_AREA{std::max(1u, 32u >> (2 * LEVEL))};
+    std::mt19937 random(7);
+    int32_t retCode{0};
+
+    // Random masks of random sizes with random windows, including windows
+    // reaching over the borders, from sparse to dense.
+    {
+        detection::BlobLabeling labeling{3};
+        std::vector<detection::Blob> blobs, reference;
+        uint32_t differing{0};
+        const uint32_t MASKS{3000};
+        for (uint32_t i{0}; i < MASKS; i++) {
+            const int W{1 + static_cast<int>(random() % 70)};
+            const int H{1 + static_cast<int>(random() % 40)};
+            const uint32_t DENSITY{static_cast<uint32_t>(random() % 1000)};
+            cv::Mat mask(H, W, CV_8UC1);
+            for (int y{0}; y < H; y++) {
+                for (int x{0}; x < W; x++) {
+                    mask.ptr<uint8_t>(y)[x] = (random() % 1000 < DENSITY) ? ((0 == random() % 2) ? 255 : 7) : 0;
+                }
+            }
+            const cv::Rect WINDOW{(0 == i % 2) ? cv::Rect(0, 0, W, H)
+                                                : cv::Rect(static_cast<int>(random() % static_cast<uint32_t>(W)) - 3, static_cast<int>(random() % static_cast<uint32_t>(H)) - 3,
+                                                           static_cast<int>(random() % static_cast<uint32_t>(W)) + 5, static_cast<int>(random() % static_cast<uint32_t>(H)) + 2)};
+            labeling.detect(mask, WINDOW, blobs);
+            floodFillBlobs(mask, WINDOW, 3, reference);
+            differing += sameBlobs(blobs, reference) ? 0 : 1;
+        }
+        std::cout << "blob labeling of " << MASKS << " random masks: "
+                  << ((0 == differing) ? "same blobs as the flood fill" : "DIFFERENT blobs in " + std::to_string(differing) + " masks") << std::endl;
+        retCode |= (0 == differing) ? 0 : 1;
+    }
+
+    std::vector<cv::Mat> frames;
+    const std::string REC{(0 != arguments.count("rec")) ? arguments["rec"] : ""};
+    if (!REC.empty()) {
+        if (!framesOfRecording(REC, option(arguments, "frames", 1000), frames)) {
+            std::cerr << "Cannot decode the frames of " << REC << "." << std::endl;
+            return 1;
+        }
+    } else {
+        // Yellow and blue ellipses of the size of cones on a gray ground.
+        for (uint32_t i{0}; i < 100; i++) {
+            cv::Mat frame(480, 640, CV_8UC4, cv::Scalar(90, 90, 90, 255));
+            for (uint32_t c{0}; c < 12; c++) {
+                const int CX{static_cast<int>(random() % 640)};
+                const int CY{240 + static_cast<int>(random() % 240)};
+                const int RX{4 + static_cast<int>(random() % 20)};
+                const int RY{6 + static_cast<int>(random() % 30)};
+                const bool BLUE{0 == c % 2};
+                for (int y{std::max(0, CY - RY)}; y < std::min(480, CY + RY); y++) {
+                    for (int x{std::max(0, CX - RX)}; x < std::min(640, CX + RX); x++) {
+                        if ((x - CX) * (x - CX) * RY * RY + (y - CY) * (y - CY) * RX * RX <= RX * RX * RY * RY) {
+                            uint8_t *p{frame.ptr<uint8_t>(y) + 4 * x};
+                            p[0] = BLUE ? 200 : 20;
+                            p[1] = BLUE ? 60 : 200;
+                            p[2] = BLUE ? 20 : 230;
+                        }
+                    }
+                }
+            }
+            frames.push_back(frame);
+        }
+    }
+
+    // Segmentation as in the solution with the default region of interest.
+    const roi::RegionOfInterest REGION{roi::RegionOfInterest::defaults(640, 480)};
+    const cv::Size SIZE{pyramid::ImagePyramid::size(REGION.region().size(), LEVEL)};
+    cv::Mat mask{REGION.mask()};
+    if (0 < LEVEL) {
+        cv::resize(REGION.mask(), mask, SIZE, 0, 0, cv::INTER_NEAREST);
+    }
+    cones::ConeSegmentation segmentation{cones::ConeSegmentation::blueDefaults(), cones::ConeSegmentation::yellowDefaults()};
+    pyramid::ImagePyramid imagePyramid;
+    detection::BlobLabeling labeling{MIN_AREA};
+    std::vector<detection::Blob> blue, yellow, reference;
+    std::vector<double> durations;
+    uint32_t differing{0};
+    std::size_t found{0};
+    cv::Mat blueMask, yellowMask;
+    for (const auto &frame : frames) {
+        const cv::Mat REGION_OF_FRAME{cv::Mat(frame, REGION.region()).clone()};
+        imagePyramid.reset(REGION_OF_FRAME);
+        segmentation.apply(imagePyramid.level(LEVEL), mask, blueMask, yellowMask);
+
+        const auto BEFORE{std::chrono::steady_clock::now()};
+        labeling.detect(blueMask, blue);
+        labeling.detect(yellowMask, yellow);
+        durations.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEFORE).count()));
+        found += blue.size() + yellow.size();
+
+        floodFillBlobs(blueMask, cv::Rect(0, 0, blueMask.cols, blueMask.rows), MIN_AREA, reference);
+        differing += sameBlobs(blue, reference) ? 0 : 1;
+        floodFillBlobs(yellowMask, cv::Rect(0, 0, yellowMask.cols, yellowMask.rows), MIN_AREA, reference);
+        differing += sameBlobs(yellow, reference) ? 0 : 1;
+    }
+    std::sort(durations.begin(), durations.end());
+    std::cout << "blob labeling of both masks of " << frames.size() << (REC.empty() ? " synthetic frames" : " frames of " + REC) << " at " << SIZE.width << "x"
+              << SIZE.height << ": " << summary(durations, 1000.0, "us") << ", " << found << " blobs, "
+              << ((0 == differing) ? "same blobs as the flood fill" : "DIFFERENT blobs in " + std::to_string(differing) + " masks") << std::endl;
+    retCode |= (0 == differing) ? 0 : 1;
+    return retCode;
+}
+
+} // namespace bench
+
+#endif
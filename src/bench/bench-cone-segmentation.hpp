@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_CONE_SEGMENTATION_HPP
+#define BENCH_CONE_SEGMENTATION_HPP
+
+#include "bench.hpp"
+#include "cone-segmentation.hpp"
+#include "region-of-interest.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Cone segmentation at 640x480: every implementation available on this CPU
+// must produce the same masks as the scalar reference, for the whole frame
+// with the default mask of the region of interest and for a window at an odd
+// offset and width; then each implementation is timed on the whole frame.
+namespace bench {
+
+inline int32_t coneSegmentation(Arguments &arguments) {
+    const int WIDTH{640};
+    const int HEIGHT{480};
+    const uint32_t RUNS{option(arguments, "runs", 200)};
+
+    // Random colors hit every branch of the HSV conversion; grays, blue, and
+    // yellow are mixed in for the cases with zero saturation and for the
+    // pixels near the bounds of the ranges.
+    cv::Mat bgra(HEIGHT, WIDTH, CV_8UC4);
+    std::mt19937 random(42);
+    for (int y{0}; y < HEIGHT; y++) {
+        uint8_t *p{bgra.ptr<uint8_t>(y)};
+        for (int x{0}; x < WIDTH; x++, p += 4) {
+            const uint32_t V{static_cast<uint32_t>(random())};
+            p[0] = static_cast<uint8_t>(V);
+            p[1] = static_cast<uint8_t>(V >> 8);
+            p[2] = static_cast<uint8_t>(V >> 16);
+            p[3] = 255;
+            switch (V >> 29) {
+                case 0: p[1] = p[2] = p[0]; break;
+                case 1: p[0] = static_cast<uint8_t>(128 + (p[0] >> 1)); p[2] = static_cast<uint8_t>(p[2] >> 2); break;
+                case 2: p[0] = static_cast<uint8_t>(p[0] >> 2); p[2] = static_cast<uint8_t>(128 + (p[2] >> 1)); p[1] = static_cast<uint8_t>(p[2] - (p[1] >> 3)); break;
+                default: break;
+            }
+        }
+    }
+    // The wires of the car are masked as in the default region of interest.
+    roi::RegionOfInterest wholeFrame{WIDTH, HEIGHT};
+    wholeFrame.addMask(cv::Rect(160, 390, 336, 90));
+    const cv::Mat MASK{wholeFrame.mask()};
+    const cv::Rect WINDOW{3, 101, 317, 77};
+
+    cones::ConeSegmentation segmentation{cones::ConeSegmentation::blueDefaults(), cones::ConeSegmentation::yellowDefaults()};
+    // Masks of the whole frame followed by the masks of the window.
+    auto segment = [&segmentation, &bgra, &MASK, &WINDOW]() {
+        std::vector<cv::Mat> masks(4);
+        segmentation.apply(bgra, MASK, masks[0], masks[1]);
+        masks[2] = cv::Mat(HEIGHT, WIDTH, CV_8UC1, cv::Scalar(0));
+        masks[3] = cv::Mat(HEIGHT, WIDTH, CV_8UC1, cv::Scalar(0));
+        segmentation.apply(bgra, cv::Mat(), masks[2], masks[3], WINDOW);
+        return masks;
+    };
+    auto same = [](const std::vector<cv::Mat> &a, const std::vector<cv::Mat> &b) {
+        for (std::size_t i{0}; i < a.size(); i++) {
+            for (int y{0}; y < a[i].rows; y++) {
+                if (0 != std::memcmp(a[i].ptr<uint8_t>(y), b[i].ptr<uint8_t>(y), static_cast<std::size_t>(a[i].cols))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    segmentation.use("scalar");
+    const std::vector<cv::Mat> REFERENCE{segment()};
+    std::cout << "cone segmentation of " << WIDTH << "x" << HEIGHT << " BGRA, " << RUNS << " runs" << std::endl;
+
+    int32_t retCode{0};
+    for (const std::string IMPLEMENTATION : {"scalar", "sse4.1", "avx2", "neon"}) {
+        if (!segmentation.use(IMPLEMENTATION)) {
+            std::cout << "  " << std::setw(7) << std::left << IMPLEMENTATION << " not available on this CPU" << std::endl;
+            continue;
+        }
+        const bool IDENTICAL{same(segment(), REFERENCE)};
+        retCode |= IDENTICAL ? 0 : 1;
+
+        cv::Mat blue, yellow;
+        const auto DURATIONS{measure(RUNS, [&segmentation, &bgra, &MASK, &blue, &yellow]() { segmentation.apply(bgra, MASK, blue, yellow); })};
+        std::cout << "  " << std::setw(7) << std::left << IMPLEMENTATION << " " << summary(DURATIONS, 1000.0, "us") << ", masks "
+                  << (IDENTICAL ? "identical" : "DIFFERENT") << std::endl;
+    }
+    return retCode;
+}
+
+} // namespace bench
+
+#endif
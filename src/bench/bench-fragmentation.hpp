@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_FRAGMENTATION_HPP
+#define BENCH_FRAGMENTATION_HPP
+
+#include "bench.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Envelopes larger than a UDP packet: splitting and reassembling them in
+// memory must give back the serialized Envelope, and over the loopback
+// interface, every ImageReading sent by one OD4Session with fragments must
+// arrive intact at another one on the same CID. The loopback test sends the
+// next Envelope once the previous one arrived, so it measures the latency of
+// a whole Envelope and the throughput without overrunning the socket buffers.
+namespace bench {
+
+inline int32_t fragmentation(Arguments &arguments) {
+    const uint16_t CID{static_cast<uint16_t>(option(arguments, "cid", 242))};
+    const uint32_t MESSAGES{option(arguments, "messages", 200)};
+    const std::chrono::milliseconds TIMEOUT{200};
+    int32_t retCode{0};
+
+    for (const uint32_t SIZE : {64u * 1024u, 320u * 240u * 4u, 640u * 480u * 4u}) {
+        opendlv::proxy::ImageReading image;
+        image.fourcc("BGRA").width(SIZE / 4).height(1).data(std::string(SIZE, '\0'));
+        std::string payload{image.data()};
+        for (uint32_t i{0}; i < SIZE; i++) {
+            payload[i] = static_cast<char>(i * 7);
+        }
+        image.data(payload);
+
+        // In memory.
+        cluon::data::Envelope envelope;
+        {
+            cluon::ToProtoVisitor protoEncoder;
+            image.accept(protoEncoder);
+            envelope.dataType(opendlv::proxy::ImageReading::ID()).serializedData(protoEncoder.encodedData());
+        }
+        const std::string SERIALIZED{cluon::serializeEnvelope(std::move(envelope))};
+        cluon::FragmentAssembler assembler;
+        uint32_t message{0};
+        bool intact{true};
+        const auto IN_MEMORY{measure(50, [&]() {
+            const std::string *completed{nullptr};
+            for (const auto &fragment : cluon::Fragmentation::split(SERIALIZED, message)) {
+                completed = assembler.add("127.0.0.1:1", fragment.data(), fragment.size());
+            }
+            message++;
+            intact = intact && (nullptr != completed) && (*completed == SERIALIZED);
+        })};
+
+        // Over the loopback interface.
+        cluon::OD4Session receiver{CID};
+        cluon::OD4Session sender{CID};
+        sender.fragmentLargeEnvelopes(true);
+        std::mutex mutex;
+        std::condition_variable arrived;
+        uint32_t received{0};
+        receiver.dataTrigger(opendlv::proxy::ImageReading::ID(), [&](cluon::data::Envelope &&env) {
+            const auto IMAGE{cluon::extractMessage<opendlv::proxy::ImageReading>(std::move(env))};
+            uint32_t sequence{0};
+            if (sizeof(sequence) <= IMAGE.data().size()) {
+                std::memcpy(&sequence, IMAGE.data().data(), sizeof(sequence));
+            }
+            std::lock_guard<std::mutex> lck(mutex);
+            intact = intact && (IMAGE.data().size() == SIZE) && (0 == std::memcmp(IMAGE.data().data() + 4, payload.data() + 4, SIZE - 4));
+            received = std::max(received, sequence + 1);
+            arrived.notify_all();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::vector<double> latencies;
+        uint32_t lost{0};
+        const auto START{std::chrono::steady_clock::now()};
+        for (uint32_t i{0}; i < MESSAGES; i++) {
+            std::memcpy(&payload[0], &i, sizeof(i));
+            image.data(payload);
+            const auto BEFORE{std::chrono::steady_clock::now()};
+            sender.send(image);
+            std::unique_lock<std::mutex> lck(mutex);
+            if (arrived.wait_for(lck, TIMEOUT, [&received, i]() { return received > i; })) {
+                latencies.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEFORE).count()));
+            } else {
+                lost++;
+            }
+        }
+        const double SECONDS{std::chrono::duration<double>(std::chrono::steady_clock::now() - START).count()};
+        std::sort(latencies.begin(), latencies.end());
+
+        const auto STATISTICS{receiver.fragmentStatistics()};
+        std::cout << std::fixed << std::setprecision(1) << "fragmented Envelopes of " << SERIALIZED.size() << " bytes ("
+                  << cluon::Fragmentation::split(SERIALIZED, 0).size() << " fragments)" << std::endl;
+        std::cout << "  in memory: " << static_cast<double>(SERIALIZED.size()) / percentile(IN_MEMORY, 50.0) * 1000.0 << " MB/s split and reassembled"
+                  << std::endl;
+        std::cout << "  loopback:  " << latencies.size() << " of " << MESSAGES << " arrived, " << summary(latencies, 1000.0, "us") << ", "
+                  << static_cast<double>(latencies.size()) * static_cast<double>(SERIALIZED.size()) / SECONDS / 1e6 << " MB/s; " << STATISTICS.m_lost
+                  << " lost and " << STATISTICS.m_discarded << " discarded by the assembler; " << (intact ? "intact" : "CORRUPTED") << std::endl;
+        retCode |= (intact && (0 == lost)) ? 0 : 1;
+    }
+    return retCode;
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_OD4_TRANSPORT_HPP
+#define BENCH_OD4_TRANSPORT_HPP
+
+#include "bench.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Envelopes between two OD4Sessions on this host, once via UDP multicast only,
+// once through the shared memory alone after the sessions stopped sending UDP
+// packets, and once through the shared memory while a third session without
+// it sends, so UDP multicast is still used as well:
+// - round trip: one session sends a request and waits for the reply of the
+//   other one,
+// - throughput: one session sends Envelopes of 1 KiB as fast as the other one
+//   receives them, with at most WINDOW of them in flight so that neither the
+//   socket buffers nor the slots of the shared memory are overrun.
+// A plain UDPReceiver counts the UDP packets that were sent meanwhile.
+namespace bench {
+
+inline int32_t od4Transport(Arguments &arguments) {
+    const uint16_t CID{static_cast<uint16_t>(option(arguments, "cid", 243))};
+    const uint32_t MESSAGES{option(arguments, "messages", 2000)};
+    const uint32_t BURST{option(arguments, "burst", 20000)};
+    const uint32_t WINDOW{64};
+    const std::chrono::milliseconds TIMEOUT{100};
+    struct Transport {
+        const char *name;
+        bool sharedMemory;
+        bool peerWithoutSharedMemory;
+    };
+    int32_t retCode{0};
+
+    std::cout << std::fixed << std::setprecision(1) << "Envelopes between two OD4Sessions on CID " << CID << ", " << MESSAGES << " round trips, "
+              << BURST << " Envelopes of 1 KiB" << std::endl;
+    for (const Transport &transport : {Transport{"UDP multicast", false, false},
+                                       Transport{"shared memory", true, false},
+                                       Transport{"shared memory and UDP", true, true}}) {
+        std::atomic<uint32_t> packets{0};
+        cluon::UDPReceiver listener{"225.0.0." + std::to_string(CID), 12175, [&packets](std::string &&, std::string &&, std::chrono::system_clock::time_point &&) {
+                                        packets++;
+                                    }};
+
+        // The transport is chosen when an OD4Session is created.
+        ::setenv("CLUON_OD4SESSION_SHM", transport.sharedMemory ? "1" : "0", 1);
+        cluon::OD4Session client{CID};
+        cluon::OD4Session server{CID};
+        ::setenv("CLUON_OD4SESSION_SHM", "0", 1);
+        std::unique_ptr<cluon::OD4Session> peer{transport.peerWithoutSharedMemory ? std::make_unique<cluon::OD4Session>(CID) : nullptr};
+        ::unsetenv("CLUON_OD4SESSION_SHM");
+        std::atomic<bool> peerRunning{true};
+        std::thread peerSending([&peer, &peerRunning]() {
+            while (peer && peerRunning.load()) {
+                cluon::data::TimeStamp alive;
+                peer->send(alive);
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+        });
+        if (transport.sharedMemory) {
+            // Until then, the sessions send UDP packets for microservices that might not use the shared memory.
+            std::this_thread::sleep_for(std::chrono::milliseconds(5500));
+        }
+
+        std::mutex mutex;
+        std::condition_variable arrived;
+        uint32_t replied{0};
+        uint32_t received{0};
+        client.dataTrigger(opendlv::proxy::GroundSteeringRequest::ID(), [&](cluon::data::Envelope &&env) {
+            std::lock_guard<std::mutex> lck(mutex);
+            replied = std::max(replied, env.senderStamp() + 1);
+            arrived.notify_all();
+        });
+        server.dataTrigger(opendlv::proxy::PedalPositionRequest::ID(), [&server](cluon::data::Envelope &&env) {
+            opendlv::proxy::GroundSteeringRequest reply;
+            server.send(reply, cluon::data::TimeStamp(), env.senderStamp());
+        });
+        server.dataTrigger(opendlv::proxy::ImageReading::ID(), [&](cluon::data::Envelope &&) {
+            std::lock_guard<std::mutex> lck(mutex);
+            received++;
+            arrived.notify_all();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // Round trips.
+        const uint32_t PACKETS_BEFORE{packets.load()};
+        std::vector<double> roundTrips;
+        for (uint32_t i{0}; i < MESSAGES; i++) {
+            opendlv::proxy::PedalPositionRequest request;
+            const auto BEFORE{std::chrono::steady_clock::now()};
+            client.send(request, cluon::data::TimeStamp(), i);
+            std::unique_lock<std::mutex> lck(mutex);
+            if (arrived.wait_for(lck, TIMEOUT, [&replied, i]() { return replied > i; })) {
+                roundTrips.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEFORE).count()));
+            }
+        }
+        const uint32_t PACKETS{packets.load() - PACKETS_BEFORE};
+        std::sort(roundTrips.begin(), roundTrips.end());
+
+        // Throughput.
+        opendlv::proxy::ImageReading image;
+        image.fourcc("BGRA").width(256).height(1).data(std::string(1024, '\0'));
+        uint32_t sent{0};
+        uint32_t lost{0};
+        const auto START{std::chrono::steady_clock::now()};
+        while (sent < BURST) {
+            {
+                // Envelopes that do not arrive in time are counted as lost to not stall the window.
+                std::unique_lock<std::mutex> lck(mutex);
+                if (!arrived.wait_for(lck, TIMEOUT, [&]() { return sent < received + lost + WINDOW; })) {
+                    lost = sent - received;
+                }
+            }
+            client.send(image);
+            sent++;
+        }
+        {
+            std::unique_lock<std::mutex> lck(mutex);
+            arrived.wait_for(lck, TIMEOUT, [&]() { return received >= BURST; });
+            lost = BURST - received;
+        }
+        const double SECONDS{std::chrono::duration<double>(std::chrono::steady_clock::now() - START).count()};
+
+        peerRunning.store(false);
+        peerSending.join();
+
+        std::cout << "  " << std::setw(22) << std::left << transport.name << std::right << " round trip " << summary(roundTrips, 1000.0, "us") << ", "
+                  << (MESSAGES - roundTrips.size()) << " lost, " << PACKETS << " UDP packets; throughput "
+                  << static_cast<double>(BURST - lost) / SECONDS / 1000.0 << "k Envelopes/s, " << lost << " lost" << std::endl;
+        retCode |= roundTrips.empty() ? 1 : 0;
+    }
+    return retCode;
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_PEEK_ENVELOPE_HPP
+#define BENCH_PEEK_ENVELOPE_HPP
+
+#include "bench.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Filtering of the mixed traffic of a recording as OD4Session::process does:
+// every Envelope of the recording is serialized like a datagram, and only the
+// data types the solution subscribes to (with --estimator=fused) are wanted.
+// Decoding every Envelope before looking at its data type is compared with
+// peeking at the header first; peekEnvelope must report the data type and
+// sender stamp of the full decoding for every Envelope.
+namespace bench {
+
+inline int32_t peekEnvelope(Arguments &arguments) {
+    const std::string REC{(0 != arguments.count("rec")) ? arguments["rec"] : "recordings/5.rec"};
+    const uint32_t RUNS{option(arguments, "runs", 20)};
+    std::vector<std::string> datagrams;
+    std::size_t bytes{0};
+    {
+        std::fstream in(REC, std::ios::in | std::ios::binary);
+        while (in.good()) {
+            auto retVal{cluon::extractEnvelope(in)};
+            if (!retVal.first) {
+                break;
+            }
+            datagrams.push_back(cluon::serializeEnvelope(std::move(retVal.second)));
+            bytes += datagrams.back().size();
+        }
+    }
+    if (datagrams.empty()) {
+        std::cerr << "Cannot read Envelopes from " << REC << "." << std::endl;
+        return 1;
+    }
+
+    const std::set<int32_t> SUBSCRIBED{opendlv::proxy::GroundSteeringRequest::ID(), opendlv::proxy::AngularVelocityReading::ID(),
+                                       opendlv::proxy::AccelerationReading::ID(),   opendlv::proxy::MagneticFieldReading::ID(),
+                                       opendlv::proxy::GroundSpeedReading::ID(),    opendlv::proxy::PedalPositionReading::ID()};
+    auto decode = [](const std::string &datagram) {
+        std::stringstream sstr(datagram);
+        return cluon::extractEnvelope(sstr);
+    };
+
+    uint32_t mismatches{0};
+    std::size_t wanted{0};
+    for (const auto &d : datagrams) {
+        int32_t dataType{0};
+        uint32_t senderStamp{0};
+        const auto ENVELOPE{decode(d)};
+        if (!cluon::peekEnvelope(d.data(), d.size(), dataType, senderStamp) || (ENVELOPE.second.dataType() != dataType)
+            || (ENVELOPE.second.senderStamp() != senderStamp)) {
+            mismatches++;
+        }
+        wanted += SUBSCRIBED.count(ENVELOPE.second.dataType());
+    }
+
+    std::size_t delivered{0};
+    const auto DECODE_ALL{measure(RUNS, [&]() {
+        for (const auto &d : datagrams) {
+            auto retVal{decode(d)};
+            if (retVal.first && (0 < SUBSCRIBED.count(retVal.second.dataType()))) {
+                delivered++;
+            }
+        }
+    })};
+    const auto PEEK_FIRST{measure(RUNS, [&]() {
+        for (const auto &d : datagrams) {
+            int32_t dataType{0};
+            uint32_t senderStamp{0};
+            if (cluon::peekEnvelope(d.data(), d.size(), dataType, senderStamp) && (0 < SUBSCRIBED.count(dataType))) {
+                auto retVal{decode(d)};
+                delivered += retVal.first ? 1 : 0;
+            }
+        }
+    })};
+    // Both variants run RUNS + 1 times and must deliver the same Envelopes.
+    const bool SAME{(0 == mismatches) && (delivered == 2 * (RUNS + 1) * wanted)};
+
+    const double ENVELOPES{static_cast<double>(datagrams.size())};
+    std::cout << std::fixed << std::setprecision(1) << "filtering " << datagrams.size() << " Envelopes (" << bytes / 1024 << " KiB) of " << REC << ", " << wanted
+              << " of them subscribed, " << RUNS << " runs" << std::endl;
+    std::cout << "  decode all:  " << percentile(DECODE_ALL, 50.0) / ENVELOPES << " ns per Envelope, "
+              << static_cast<double>(bytes) / percentile(DECODE_ALL, 50.0) * 1000.0 << " MB/s" << std::endl;
+    std::cout << "  peek first:  " << percentile(PEEK_FIRST, 50.0) / ENVELOPES << " ns per Envelope, "
+              << static_cast<double>(bytes) / percentile(PEEK_FIRST, 50.0) * 1000.0 << " MB/s, "
+              << (SAME ? "same Envelopes delivered" : "DIFFERENT Envelopes delivered") << std::endl;
+    return SAME ? 0 : 1;
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_SHARED_MEMORY_HPP
+#define BENCH_SHARED_MEMORY_HPP
+
+#include "bench.hpp"
+#include "cluon-complete.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Wake-up latency of cluon::SharedMemory with the SysV, POSIX, and futex
+// implementations: a producer writes the time into the shared memory and
+// notifies about once per millisecond like a camera; a consumer attached from
+// another thread waits, locks, and reads it. The latency is the time from
+// writing until the consumer holds the data; notifications the consumer
+// slept through are counted as missed.
+namespace bench {
+
+inline int32_t sharedMemoryWakeUp(Arguments &arguments) {
+    const uint32_t NOTIFICATIONS{option(arguments, "notifications", 2000)};
+    const uint32_t LAST{0xFFFFFFFFu};
+    struct Implementation {
+        const char *name;
+        const char *posix;
+        const char *futex;
+    };
+    struct Stamp {
+        uint32_t sequence;
+        int64_t written; // Nanoseconds of the steady clock.
+    };
+    auto now = []() { return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()); };
+
+    int32_t retCode{0};
+    std::cout << "shared memory wake-up latency, " << NOTIFICATIONS << " notifications" << std::endl;
+    for (const Implementation &implementation : {Implementation{"SysV", "0", "0"}, Implementation{"POSIX", "1", "0"}, Implementation{"futex", "0", "1"}}) {
+        // The implementation is chosen when a SharedMemory is created or attached.
+        ::setenv("CLUON_SHAREDMEMORY_POSIX", implementation.posix, 1);
+        ::setenv("CLUON_SHAREDMEMORY_FUTEX", implementation.futex, 1);
+        cluon::SharedMemory producer{"/bench-wakeup", sizeof(Stamp)};
+        if (!producer.valid()) {
+            std::cout << "  " << std::setw(6) << std::left << implementation.name << " not available" << std::endl;
+            retCode = 1;
+            continue;
+        }
+
+        std::atomic<bool> attached{false};
+        std::atomic<bool> done{false};
+        std::vector<double> latencies;
+        latencies.reserve(NOTIFICATIONS);
+        std::thread consumer([&]() {
+            cluon::SharedMemory sharedMemory{"/bench-wakeup"};
+            attached.store(sharedMemory.valid());
+            uint32_t previous{LAST};
+            while (sharedMemory.valid()) {
+                sharedMemory.wait();
+                sharedMemory.lock();
+                Stamp stamp;
+                std::memcpy(&stamp, sharedMemory.data(), sizeof(stamp));
+                const int64_t NOW{now()};
+                sharedMemory.unlock();
+                if (LAST == stamp.sequence) {
+                    break;
+                }
+                if (stamp.sequence != previous) {
+                    latencies.push_back(static_cast<double>(NOW - stamp.written));
+                    previous = stamp.sequence;
+                }
+            }
+            done.store(true);
+        });
+        while (!attached.load() && !done.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto publish = [&producer, &now](uint32_t sequence) {
+            producer.lock();
+            const Stamp STAMP{sequence, now()};
+            std::memcpy(producer.data(), &STAMP, sizeof(STAMP));
+            producer.unlock();
+            producer.notifyAll();
+        };
+        for (uint32_t i{0}; (i < NOTIFICATIONS) && !done.load(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            publish(i);
+        }
+        // The implementations without a generation count can lose a notification; repeat the last one until it arrives.
+        while (!done.load()) {
+            publish(LAST);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        consumer.join();
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  " << std::setw(6) << std::left << implementation.name << " " << summary(latencies, 1000.0, "us") << ", max "
+                  << percentile(latencies, 100.0) / 1000.0 << " us, " << (NOTIFICATIONS - latencies.size()) << " missed" << std::endl;
+        retCode |= latencies.empty() ? 1 : 0;
+    }
+    ::unsetenv("CLUON_SHAREDMEMORY_POSIX");
+    ::unsetenv("CLUON_SHAREDMEMORY_FUTEX");
+    return retCode;
+}
+
+} // namespace bench
+
+#endif
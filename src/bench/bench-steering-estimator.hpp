@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_STEERING_ESTIMATOR_HPP
+#define BENCH_STEERING_ESTIMATOR_HPP
+
+#include "bench.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "steering-estimator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Steering of a recording replayed as fast as possible: the readings are fed
+// to the fused estimator as the solution does, and at every ImageReading both
+// the original formula and the fused estimator are scored against the last
+// GroundSteeringRequest with the tolerance of the solution. The time of every
+// update and of every steering is measured, including reading the clock.
+namespace bench {
+
+inline int32_t steeringEstimator(Arguments &arguments) {
+    const std::string REC{(0 != arguments.count("rec")) ? arguments["rec"] : "recordings/5.rec"};
+    std::fstream in(REC, std::ios::in | std::ios::binary);
+    if (!in.good()) {
+        std::cerr << "Cannot read " << REC << "." << std::endl;
+        return 1;
+    }
+
+    estimation::SteeringEstimator estimator;
+    std::vector<double> updates, steerings;
+    float groundSteering{0.0f};
+    float angularVelocityZ{0.0f};
+    uint32_t frames{0}, formulaCorrect{0}, fusedCorrect{0};
+    auto timed = [](std::vector<double> &durations, const std::function<void()> &f) {
+        const auto BEFORE{std::chrono::steady_clock::now()};
+        f();
+        durations.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEFORE).count()));
+    };
+
+    while (in.good()) {
+        auto retVal{cluon::extractEnvelope(in)};
+        if (!retVal.first) {
+            break;
+        }
+        cluon::data::Envelope &env{retVal.second};
+        const double T{static_cast<double>(cluon::time::toMicroseconds(env.sampleTimeStamp())) * 1e-6};
+        const int32_t DATA_TYPE{env.dataType()};
+        if (opendlv::proxy::GroundSteeringRequest::ID() == DATA_TYPE) {
+            groundSteering = cluon::extractMessage<opendlv::proxy::GroundSteeringRequest>(std::move(env)).groundSteering();
+        } else if (opendlv::proxy::AngularVelocityReading::ID() == DATA_TYPE) {
+            angularVelocityZ = cluon::extractMessage<opendlv::proxy::AngularVelocityReading>(std::move(env)).angularVelocityZ();
+            timed(updates, [&]() { estimator.angularVelocity(T, angularVelocityZ); });
+        } else if (opendlv::proxy::AccelerationReading::ID() == DATA_TYPE) {
+            const auto MSG{cluon::extractMessage<opendlv::proxy::AccelerationReading>(std::move(env))};
+            timed(updates, [&]() { estimator.acceleration(T, MSG.accelerationX(), MSG.accelerationY(), MSG.accelerationZ()); });
+        } else if (opendlv::proxy::MagneticFieldReading::ID() == DATA_TYPE) {
+            const auto MSG{cluon::extractMessage<opendlv::proxy::MagneticFieldReading>(std::move(env))};
+            timed(updates, [&]() { estimator.magneticField(T, MSG.magneticFieldX(), MSG.magneticFieldY(), MSG.magneticFieldZ()); });
+        } else if (opendlv::proxy::GroundSpeedReading::ID() == DATA_TYPE) {
+            const float SPEED{cluon::extractMessage<opendlv::proxy::GroundSpeedReading>(std::move(env)).groundSpeed()};
+            timed(updates, [&]() { estimator.groundSpeed(T, SPEED); });
+        } else if (opendlv::proxy::PedalPositionReading::ID() == DATA_TYPE) {
+            const float POSITION{cluon::extractMessage<opendlv::proxy::PedalPositionReading>(std::move(env)).position()};
+            timed(updates, [&]() { estimator.pedalPosition(T, POSITION); });
+        } else if (opendlv::proxy::ImageReading::ID() == DATA_TYPE) {
+            const float TOLERANCE{(0.0f < std::abs(groundSteering)) ? std::abs(0.3f * groundSteering) : 0.05f};
+            float fused{0.0f};
+            timed(steerings, [&]() { fused = estimator.steering(T); });
+            frames++;
+            formulaCorrect += (std::abs(groundSteering - estimation::SteeringEstimator::fromAngularVelocity(angularVelocityZ)) <= TOLERANCE) ? 1 : 0;
+            fusedCorrect += (std::abs(groundSteering - fused) <= TOLERANCE) ? 1 : 0;
+        }
+    }
+    if (0 == frames) {
+        std::cerr << REC << " has no ImageReadings." << std::endl;
+        return 1;
+    }
+
+    std::sort(updates.begin(), updates.end());
+    std::sort(steerings.begin(), steerings.end());
+    std::cout << std::fixed << std::setprecision(1) << "steering of " << frames << " frames of " << REC << ": formula " << 100.0 * formulaCorrect / frames
+              << "% within the tolerance, fused " << 100.0 * fusedCorrect / frames << "%" << std::endl;
+    std::cout << "  " << updates.size() << " updates: " << summary(updates, 1.0, "ns") << std::endl;
+    std::cout << "  " << steerings.size() << " steerings: " << summary(steerings, 1.0, "ns") << std::endl;
+    // The fused estimator must not be worse than the formula it replaces.
+    return (fusedCorrect >= formulaCorrect) ? 0 : 1;
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmarks of the vision stages and of libcluon; each one also checks that
+// the optimized code gives the same results as a reference and exits with 1
+// if it does not.
+#include "cluon-complete.hpp"
+
+#include "bench-cone-segmentation.hpp"
+#include "bench-cone-detection.hpp"
+#include "bench-steering-estimator.hpp"
+#include "bench-peek-envelope.hpp"
+#include "bench-fragmentation.hpp"
+#include "bench-shared-memory.hpp"
+#include "bench-od4-transport.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+int32_t main(int32_t argc, char **argv) {
+    struct Benchmark {
+        const char *name;
+        const char *description;
+        int32_t (*run)(bench::Arguments &arguments);
+    };
+    const Benchmark BENCHMARKS[]{
+        {"segmentation", "cone segmentation kernels at 640x480 [--runs=<n>]", &bench::coneSegmentation},
+        {"labeling", "blob labeling of the cone masks [--rec=<file>] [--frames=<n>] [--level=<n>]", &bench::coneDetection},
+        {"steering", "fused steering estimator against the formula over a recording [--rec=<file>]", &bench::steeringEstimator},
+        {"peek", "header peek against full decoding of a recording's mixed traffic [--rec=<file>] [--runs=<n>]", &bench::peekEnvelope},
+        {"fragmentation", "fragmented Envelopes in memory and over loopback [--cid=<n>] [--messages=<n>]", &bench::fragmentation},
+        {"wakeup", "shared memory wake-up latency of the SysV, POSIX, and futex implementations [--notifications=<n>]", &bench::sharedMemoryWakeUp},
+        {"transport", "OD4Session round trips and throughput via UDP multicast and via shared memory [--cid=<n>] [--messages=<n>] [--burst=<n>]", &bench::od4Transport},
+    };
+
+    int32_t retCode{0};
+    const std::string NAME{(1 < argc) ? argv[1] : ""};
+    auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+    bool found{false};
+    for (const auto &b : BENCHMARKS) {
+        if (("all" == NAME) || (b.name == NAME)) {
+            found = true;
+            if (0 != b.run(commandlineArguments)) {
+                retCode = 1;
+            }
+        }
+    }
+    if (!found) {
+        retCode = 1;
+        std::cerr << argv[0] << " runs benchmarks that also check the results against a reference." << std::endl;
+        std::cerr << "Usage:   " << argv[0] << " all|<benchmark> [options]" << std::endl;
+        for (const auto &b : BENCHMARKS) {
+            std::cerr << "         " << std::setw(14) << std::left << b.name << b.description << std::endl;
+        }
+        std::cerr << "Example: " << argv[0] << " segmentation --runs=500" << std::endl;
+    }
+    return retCode;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Helpers shared by the benchmarks: timing of repeated runs and reading the
+// options given as --name=value.
+namespace bench {
+
+using Arguments = std::map<std::string, std::string>;
+
+/**
+ * This method runs a function once to warm up the caches and then the given
+ * number of times.
+ *
+ * @return Durations of the runs in nanoseconds, sorted ascending.
+ */
+template <typename F>
+std::vector<double> measure(uint32_t runs, F &&f) {
+    f();
+    std::vector<double> durations;
+    durations.reserve(runs);
+    for (uint32_t i{0}; i < runs; i++) {
+        const auto BEFORE{std::chrono::steady_clock::now()};
+        f();
+        durations.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEFORE).count()));
+    }
+    std::sort(durations.begin(), durations.end());
+    return durations;
+}
+
+/**
+ * @param sorted Values sorted ascending.
+ * @param p Percentile between 0 and 100.
+ * @return Value at the percentile, or 0 for no values.
+ */
+inline double percentile(const std::vector<double> &sorted, double p) noexcept {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t I{static_cast<std::size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5)};
+    return sorted[std::min(I, sorted.size() - 1)];
+}
+
+/**
+ * @return Median and 99th percentile of durations in nanoseconds, in the given unit (1000 for microseconds).
+ */
+inline std::string summary(const std::vector<double> &sorted, double unit, const std::string &unitName) noexcept {
+    std::stringstream sstr;
+    sstr << std::fixed << std::setprecision(unit > 1.0 ? 2 : 0) << "median " << percentile(sorted, 50.0) / unit << " " << unitName << ", p99 "
+         << percentile(sorted, 99.0) / unit << " " << unitName;
+    return sstr.str();
+}
+
+/**
+ * @return Value of the option --name=value, or the default if it is not given.
+ */
+inline uint32_t option(Arguments &arguments, const std::string &name, uint32_t defaultValue) noexcept {
+    if (0 == arguments.count(name)) {
+        return defaultValue;
+    }
+    try {
+        return static_cast<uint32_t>(std::max(1, std::stoi(arguments[name])));
+    } catch (...) {} // LCOV_EXCL_LINE
+    return defaultValue;
+}
+
+} // namespace bench
+
+#endif
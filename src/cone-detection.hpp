@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONE_DETECTION_HPP
+#define CONE_DETECTION_HPP
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Detection of the cones in the masks of the cone segmentation: 8-connected
+// blobs are labeled in a single pass over the rows with a union-find over the
+// runs of set pixels. Only the runs of the previous row and the statistics of
+// the labels are kept, so no label image or contour is allocated, and all
+// buffers are reused from frame to frame.
+namespace detection {
+
+// Values of opendlv.logic.perception.ObjectType.type for the cones.
+enum ConeType : uint32_t { BLUE_CONE = 1, YELLOW_CONE = 2 };
+
+/**
+ * Blob of set pixels; coordinates are in the pixels of the mask.
+ */
+struct Blob {
+    uint32_t area{0};
+    float x{0.0f}; // Centroid.
+    float y{0.0f};
+    cv::Rect box{};
+};
+
+class BlobLabeling {
+   private:
+    BlobLabeling(const BlobLabeling &) = delete;
+    BlobLabeling(BlobLabeling &&)      = delete;
+    BlobLabeling &operator=(const BlobLabeling &) = delete;
+    BlobLabeling &operator=(BlobLabeling &&) = delete;
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param minArea Smaller blobs are noise and not reported.
+     */
+    explicit BlobLabeling(uint32_t minArea) noexcept
+        : m_minArea{std::max(1u, minArea)} {}
+
+    /**
+     * This method finds the blobs of a mask.
+     *
+     * @param mask Image of type CV_8UC1; pixels that are not 0 are set.
+     * @param blobs Blobs found, replacing the previous content.
+     */
+    void detect(const cv::Mat &mask, std::vector<Blob> &blobs) {
+        detect(mask, cv::Rect(0, 0, mask.cols, mask.rows), blobs);
+    }
+
+    /**
+     * This method finds the blobs within a window of a mask; blobs crossing the
+     * border of the window are cut off.
+     *
+     * @param window Rectangle of the mask to scan; clipped to the mask.
+     */
+    void detect(const cv::Mat &mask, const cv::Rect &window, std::vector<Blob> &blobs) {
+        blobs.clear();
+        m_labels.clear();
+        m_previous.clear();
+        const cv::Rect W{window & cv::Rect(0, 0, mask.cols, mask.rows)};
+        for (int y{W.y}; y < W.y + W.height; y++) {
+            m_current.clear();
+            scanRow(mask.ptr<uint8_t>(y), W.x, W.x + W.width);
+            std::size_t p{0};
+            for (auto &run : m_current) {
+                // Runs of the previous row touching this run, including diagonally.
+                while ((p < m_previous.size()) && (m_previous[p].end < run.begin)) {
+                    p++;
+                }
+                uint32_t label{NONE};
+                for (std::size_t q{p}; (q < m_previous.size()) && (m_previous[q].begin <= run.end); q++) {
+                    label = (NONE == label) ? find(m_previous[q].label) : unite(label, m_previous[q].label);
+                }
+                if (NONE == label) {
+                    label = static_cast<uint32_t>(m_labels.size());
+                    m_labels.push_back(Label{label, 0, 0, 0, run.begin, y, run.end - 1, y});
+                }
+                run.label = label;
+                add(m_labels[label], run, y);
+            }
+            std::swap(m_previous, m_current);
+        }
+
+        for (uint32_t i{0}; i < m_labels.size(); i++) {
+            const Label &l = m_labels[i];
+            if ((l.parent == i) && (l.area >= m_minArea)) {
+                Blob b;
+                b.area = l.area;
+                b.x    = static_cast<float>(static_cast<double>(l.sumX) / l.area);
+                b.y    = static_cast<float>(static_cast<double>(l.sumY) / l.area);
+                b.box  = cv::Rect(l.minX, l.minY, l.maxX - l.minX + 1, l.maxY - l.minY + 1);
+                blobs.push_back(b);
+            }
+        }
+    }
+
+   private:
+    enum : uint32_t { NONE = 0xFFFFFFFF };
+
+    // Set pixels [begin, end) of a row.
+    struct Run {
+        int begin;
+        int end;
+        uint32_t label;
+    };
+
+    // Statistics are only valid for labels that are their own parent.
+    struct Label {
+        uint32_t parent;
+        uint32_t area;
+        uint64_t sumX;
+        uint64_t sumY;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    // Skips eight cleared or eight set pixels at once; masks are mostly empty.
+    void scanRow(const uint8_t *row, int begin, int end) {
+        const uint64_t ONES{0x0101010101010101ull};
+        const uint64_t HIGHS{0x8080808080808080ull};
+        int x{begin};
+        while (x < end) {
+            uint64_t word;
+            while ((x + 8 <= end) && (std::memcpy(&word, row + x, 8), 0 == word)) {
+                x += 8;
+            }
+            while ((x < end) && (0 == row[x])) {
+                x++;
+            }
+            if (x >= end) {
+                break;
+            }
+            const int BEGIN{x};
+            // A word without a zero byte is set throughout.
+            while ((x + 8 <= end) && (std::memcpy(&word, row + x, 8), 0 == ((word - ONES) & ~word & HIGHS))) {
+                x += 8;
+            }
+            while ((x < end) && (0 != row[x])) {
+                x++;
+            }
+            m_current.push_back(Run{BEGIN, x, NONE});
+        }
+    }
+
+    uint32_t find(uint32_t label) noexcept {
+        while (m_labels[label].parent != label) {
+            m_labels[label].parent = m_labels[m_labels[label].parent].parent;
+            label                  = m_labels[label].parent;
+        }
+        return label;
+    }
+
+    // The older label survives and takes over the statistics of the other one.
+    uint32_t unite(uint32_t a, uint32_t b) noexcept {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return a;
+        }
+        if (a > b) {
+            std::swap(a, b);
+        }
+        Label &to         = m_labels[a];
+        const Label &from = m_labels[b];
+        to.area += from.area;
+        to.sumX += from.sumX;
+        to.sumY += from.sumY;
+        to.minX = std::min(to.minX, from.minX);
+        to.minY = std::min(to.minY, from.minY);
+        to.maxX = std::max(to.maxX, from.maxX);
+        to.maxY = std::max(to.maxY, from.maxY);
+
+        m_labels[b].parent = a;
+        return a;
+    }
+
+    static void add(Label &l, const Run &run, int y) noexcept {
+        const uint64_t LENGTH{static_cast<uint64_t>(run.end - run.begin)};
+        l.area += static_cast<uint32_t>(LENGTH);
+        l.sumX += static_cast<uint64_t>(run.begin + run.end - 1) * LENGTH / 2;
+        l.sumY += static_cast<uint64_t>(y) * LENGTH;
+        l.minX = std::min(l.minX, run.begin);
+        l.maxX = std::max(l.maxX, run.end - 1);
+        l.maxY = std::max(l.maxY, y);
+    }
+
+   private:
+    const uint32_t m_minArea;
+    std::vector<Run> m_previous{};
+    std::vector<Run> m_current{};
+    std::vector<Label> m_labels{};
+};
+
+/**
+ * Pinhole camera looking straight ahead with its optical axis parallel to the
+ * ground, so the horizon is the middle row of the frame. Angles follow OpenDLV:
+ * azimuth is positive to the left and zenith is positive above the horizon.
+ */
+class Camera {
+   public:
+    /**
+     * Constructor.
+     *
+     * @param width Width of the frame in pixels.
+     * @param height Height of the frame in pixels.
+     * @param horizontalFieldOfView Angle between the left and the right border of the frame in degrees.
+     * @param mountingHeight Height of the camera above the ground in meters.
+     */
+    Camera(uint32_t width, uint32_t height, float horizontalFieldOfView, float mountingHeight) noexcept
+        : m_centerX{0.5f * static_cast<float>(width)}
+        , m_centerY{0.5f * static_cast<float>(height)}
+        , m_focalLength{m_centerX / std::tan(0.5f * horizontalFieldOfView * static_cast<float>(M_PI) / 180.0f)}
+        , m_horizontalFieldOfView{horizontalFieldOfView}
+        , m_mountingHeight{mountingHeight} {}
+
+    /**
+     * This method parses "<horizontal field of view in degrees>,<mounting height in meters>".
+     *
+     * @return false if the text is not a valid camera.
+     */
+    static bool parse(const std::string &text, uint32_t width, uint32_t height, Camera &camera) noexcept {
+        std::string s{text};
+        std::replace(s.begin(), s.end(), ',', ' ');
+        std::stringstream sstr(s);
+        float fov, mountingHeight;
+        std::string rest;
+        if (!(sstr >> fov >> mountingHeight) || (sstr >> rest) || !(0.0f < fov) || !(fov < 180.0f) || !(0.0f < mountingHeight)) {
+            return false;
+        }
+        camera = Camera{width, height, fov, mountingHeight};
+        return true;
+    }
+
+    /**
+     * @return Azimuth of a column of the frame in radians.
+     */
+    float azimuth(float x) const noexcept {
+        return std::atan2(m_centerX - x, m_focalLength);
+    }
+
+    /**
+     * @return Zenith of a row of the frame in radians.
+     */
+    float zenith(float y) const noexcept {
+        return std::atan2(m_centerY - y, m_focalLength);
+    }
+
+    /**
+     * @return Distance in meters to a point on the ground seen in the given row; 0 at and above the horizon.
+     */
+    float distance(float y) const noexcept {
+        return (y > m_centerY) ? m_mountingHeight * m_focalLength / (y - m_centerY) : 0.0f;
+    }
+
+    std::string toString() const noexcept {
+        std::stringstream sstr;
+        sstr << m_horizontalFieldOfView << " degrees field of view, " << m_mountingHeight << " m above the ground";
+        return sstr.str();
+    }
+
+   private:
+    float m_centerX;
+    float m_centerY;
+    float m_focalLength;
+    float m_horizontalFieldOfView;
+    float m_mountingHeight;
+};
+
+} // namespace detection
+
+#endif
@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONE_SEGMENTATION_HPP
+#define CONE_SEGMENTATION_HPP
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// clang-format off
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define CONE_SEGMENTATION_X86
+    #include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define CONE_SEGMENTATION_NEON
+    #include <arm_neon.h>
+#endif
+// clang-format on
+
+// Segmentation of blue and yellow cones in one pass over a BGRA frame: every
+// pixel is converted to HSV and compared against both ranges without storing
+// the HSV image, and masked pixels of the region of interest are cleared in
+// the same pass. There is a scalar reference and SSE4.1/AVX2 (selected at
+// runtime) and NEON (selected at compile time) versions of the same integer
+// arithmetic, so all of them produce identical masks.
+namespace cones {
+
+/**
+ * Inclusive bounds in OpenCV's 8-bit HSV: hue 0..180 (degrees / 2), saturation
+ * and value 0..255. A range with hueLow > hueHigh wraps around red.
+ */
+struct HsvRange {
+    uint8_t hueLow{0};
+    uint8_t saturationLow{0};
+    uint8_t valueLow{0};
+    uint8_t hueHigh{180};
+    uint8_t saturationHigh{255};
+    uint8_t valueHigh{255};
+
+    /**
+     * This method parses a range given as "hLow,sLow,vLow,hHigh,sHigh,vHigh" like
+     * the lower and upper bounds for cv::inRange.
+     *
+     * @return false if the text is not a valid range.
+     */
+    static bool parse(const std::string &text, HsvRange &range) noexcept {
+        std::string s{text};
+        std::replace(s.begin(), s.end(), ',', ' ');
+        std::stringstream sstr(s);
+        int v[6];
+        std::string rest;
+        if (!(sstr >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5]) || (sstr >> rest)) {
+            return false;
+        }
+        for (int i{0}; i < 6; i++) {
+            if ((0 > v[i]) || (((0 == i) || (3 == i)) ? 180 : 255) < v[i]) {
+                return false;
+            }
+        }
+        range = HsvRange{static_cast<uint8_t>(v[0]), static_cast<uint8_t>(v[1]), static_cast<uint8_t>(v[2]),
+                         static_cast<uint8_t>(v[3]), static_cast<uint8_t>(v[4]), static_cast<uint8_t>(v[5])};
+        return (range.saturationLow <= range.saturationHigh) && (range.valueLow <= range.valueHigh);
+    }
+
+    std::string toString() const noexcept {
+        std::stringstream sstr;
+        sstr << +hueLow << "," << +saturationLow << "," << +valueLow << "," << +hueHigh << "," << +saturationHigh << "," << +valueHigh;
+        return sstr.str();
+    }
+};
+
+class ConeSegmentation {
+   public:
+    /**
+     * @return Range of the blue cones on the track.
+     */
+    static HsvRange blueDefaults() noexcept {
+        return HsvRange{100, 80, 30, 130, 255, 255};
+    }
+
+    /**
+     * @return Range of the yellow cones on the track.
+     */
+    static HsvRange yellowDefaults() noexcept {
+        return HsvRange{15, 80, 80, 35, 255, 255};
+    }
+
+    /**
+     * Constructor; selects the fastest implementation available on this CPU.
+     */
+    ConeSegmentation(const HsvRange &blue, const HsvRange &yellow) noexcept
+        : m_blue{thresholds(blue)}
+        , m_yellow{thresholds(yellow)} {
+#ifdef CONE_SEGMENTATION_NEON
+        use("neon");
+#endif
+#ifdef CONE_SEGMENTATION_X86
+        if (!use("avx2")) {
+            use("sse4.1");
+        }
+#endif
+    }
+
+    /**
+     * This method selects an implementation, for comparing them with each other.
+     *
+     * @param implementation "scalar", "sse4.1", "avx2", or "neon".
+     * @return false if the implementation is not available on this CPU.
+     */
+    bool use(const std::string &implementation) noexcept {
+        if ("scalar" == implementation) {
+            m_implementation = "scalar";
+            m_kernel         = &ConeSegmentation::thresholdScalar;
+            return true;
+        }
+#ifdef CONE_SEGMENTATION_X86
+        if (("sse4.1" == implementation) && __builtin_cpu_supports("sse4.1")) {
+            m_implementation = "sse4.1";
+            m_kernel         = &ConeSegmentation::thresholdSSE41;
+            return true;
+        }
+        if (("avx2" == implementation) && __builtin_cpu_supports("avx2")) {
+            m_implementation = "avx2";
+            m_kernel         = &ConeSegmentation::thresholdAVX2;
+            return true;
+        }
+#endif
+#ifdef CONE_SEGMENTATION_NEON
+        if ("neon" == implementation) {
+            m_implementation = "neon";
+            m_kernel         = &ConeSegmentation::thresholdNEON;
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    /**
+     * @return Name of the implementation in use.
+     */
+    const char *implementation() const noexcept {
+        return m_implementation;
+    }
+
+    /**
+     * This method segments a BGRA image into masks with 255 for cone pixels and 0 otherwise.
+     *
+     * @param bgra Image of type CV_8UC4.
+     * @param mask Optional image of type CV_8UC1 and the same size; pixels that are 0 are never cones.
+     * @param blue Mask of the blue cones; (re)allocated if needed.
+     * @param yellow Mask of the yellow cones; (re)allocated if needed.
+     */
+    void apply(const cv::Mat &bgra, const cv::Mat &mask, cv::Mat &blue, cv::Mat &yellow) const {
+        blue.create(bgra.rows, bgra.cols, CV_8UC1);
+        yellow.create(bgra.rows, bgra.cols, CV_8UC1);
+        apply(bgra, mask, blue, yellow, 0, bgra.rows);
+    }
+
+    /**
+     * This method segments the rows [firstRow, lastRow) of a BGRA image, for
+     * running bands of rows in parallel.
+     *
+     * @param blue Mask of the blue cones; must have the size of the image.
+     * @param yellow Mask of the yellow cones; must have the size of the image.
+     */
+    void apply(const cv::Mat &bgra, const cv::Mat &mask, cv::Mat &blue, cv::Mat &yellow, int firstRow, int lastRow) const noexcept {
+        const bool MASKED{!mask.empty() && (mask.rows == bgra.rows) && (mask.cols == bgra.cols)};
+        for (int row{firstRow}; row < lastRow; row++) {
+            m_kernel(bgra.ptr<uint8_t>(row), MASKED ? mask.ptr<uint8_t>(row) : nullptr, static_cast<uint32_t>(bgra.cols), m_blue, m_yellow,
+                     blue.ptr<uint8_t>(row), yellow.ptr<uint8_t>(row));
+        }
+    }
+
+    /**
+     * This method segments a rectangle of a BGRA image, for searching only
+     * around known cones; the masks are left untouched outside of it.
+     *
+     * @param area Rectangle within the image.
+     */
+    void apply(const cv::Mat &bgra, const cv::Mat &mask, cv::Mat &blue, cv::Mat &yellow, const cv::Rect &area) const noexcept {
+        const bool MASKED{!mask.empty() && (mask.rows == bgra.rows) && (mask.cols == bgra.cols)};
+        for (int row{area.y}; row < area.y + area.height; row++) {
+            m_kernel(bgra.ptr<uint8_t>(row) + 4 * area.x, MASKED ? mask.ptr<uint8_t>(row) + area.x : nullptr, static_cast<uint32_t>(area.width), m_blue, m_yellow,
+                     blue.ptr<uint8_t>(row) + area.x, yellow.ptr<uint8_t>(row) + area.x);
+        }
+    }
+
+    std::string toString() const noexcept {
+        return std::string{"blue "} + unpack(m_blue).toString() + ", yellow " + unpack(m_yellow).toString() + " (" + m_implementation + ")";
+    }
+
+   private:
+    // Bounds prepared for comparisons without division; see classify().
+    struct Thresholds {
+        uint16_t hueLow;
+        uint16_t hueHigh;
+        uint16_t saturationLow;
+        uint16_t saturationHigh;
+        uint16_t valueLow;
+        uint16_t valueHigh;
+        uint16_t wraps;  // 0xFFFF if hueLow > hueHigh.
+        uint16_t grayOk; // 0xFFFF if pixels without saturation (hue 0) are inside the hue and saturation bounds.
+    };
+
+    typedef void (*Kernel)(const uint8_t *, const uint8_t *, uint32_t, const Thresholds &, const Thresholds &, uint8_t *, uint8_t *);
+
+    static Thresholds thresholds(const HsvRange &r) noexcept {
+        const bool WRAPS{r.hueLow > r.hueHigh};
+        const bool HUE_ZERO_OK{WRAPS || (0 == r.hueLow)};
+        return Thresholds{r.hueLow,
+                          r.hueHigh,
+                          r.saturationLow,
+                          r.saturationHigh,
+                          r.valueLow,
+                          r.valueHigh,
+                          static_cast<uint16_t>(WRAPS ? 0xFFFF : 0),
+                          static_cast<uint16_t>((HUE_ZERO_OK && (0 == r.saturationLow)) ? 0xFFFF : 0)};
+    }
+
+    static HsvRange unpack(const Thresholds &t) noexcept {
+        return HsvRange{static_cast<uint8_t>(t.hueLow),   static_cast<uint8_t>(t.saturationLow),  static_cast<uint8_t>(t.valueLow),
+                        static_cast<uint8_t>(t.hueHigh),  static_cast<uint8_t>(t.saturationHigh), static_cast<uint8_t>(t.valueHigh)};
+    }
+
+    /**
+     * Reference for one pixel. With V = max(R, G, B) and d = V - min(R, G, B),
+     * OpenCV's hue is H = n / d with n = 30 * (G - B) (+ 180 * d if negative)
+     * if V = R, 60 * d + 30 * (B - R) if V = G, and 120 * d + 30 * (R - G)
+     * otherwise; saturation is S = 255 * d / V. The bounds are compared as
+     * hueLow * d <= n <= hueHigh * d and saturationLow * V <= 255 * d <=
+     * saturationHigh * V: all terms fit into 16 bits and no division is needed.
+     * Gray pixels (d = 0) have hue and saturation 0.
+     */
+    static bool classify(uint32_t b, uint32_t g, uint32_t r, const Thresholds &t) noexcept {
+        const uint32_t V{std::max(std::max(b, g), r)};
+        const uint32_t D{V - std::min(std::min(b, g), r)};
+        if ((V < t.valueLow) || (V > t.valueHigh)) {
+            return false;
+        }
+        if (0 == D) {
+            return 0 != t.grayOk;
+        }
+        uint32_t n;
+        if (V == r) {
+            n = (g >= b) ? 30 * (g - b) : 180 * D - 30 * (b - g);
+        } else if (V == g) {
+            n = 60 * D + 30 * b - 30 * r;
+        } else {
+            n = 120 * D + 30 * r - 30 * g;
+        }
+        const bool ABOVE_LOW{n >= t.hueLow * D};
+        const bool BELOW_HIGH{n <= t.hueHigh * D};
+        const bool HUE_OK{(0 != t.wraps) ? (ABOVE_LOW || BELOW_HIGH) : (ABOVE_LOW && BELOW_HIGH)};
+        return HUE_OK && (255 * D >= t.saturationLow * V) && (255 * D <= t.saturationHigh * V);
+    }
+
+    static void thresholdScalar(const uint8_t *bgra, const uint8_t *mask, uint32_t n, const Thresholds &blue, const Thresholds &yellow, uint8_t *blueOut,
+                                uint8_t *yellowOut) noexcept {
+        for (uint32_t i{0}; i < n; i++, bgra += 4) {
+            const bool ON{(nullptr == mask) || (0 != mask[i])};
+            blueOut[i]   = (ON && classify(bgra[0], bgra[1], bgra[2], blue)) ? 255 : 0;
+            yellowOut[i] = (ON && classify(bgra[0], bgra[1], bgra[2], yellow)) ? 255 : 0;
+        }
+    }
+
+#ifdef CONE_SEGMENTATION_X86
+    // The x86 versions process eight pixels per 128 bit or sixteen pixels per
+    // 256 bit register in 16 bit lanes; unsigned comparisons are done with
+    // min/max as SSE and AVX2 only have signed ones.
+    __attribute__((target("sse4.1"))) static __m128i classifySSE41(__m128i b, __m128i g, __m128i r, const Thresholds &t) noexcept {
+        const __m128i V{_mm_max_epu16(_mm_max_epu16(b, g), r)};
+        const __m128i D{_mm_sub_epi16(V, _mm_min_epu16(_mm_min_epu16(b, g), r))};
+        const __m128i ZERO{_mm_setzero_si128()};
+        const __m128i C30{_mm_set1_epi16(30)};
+
+        const __m128i IS_R{_mm_cmpeq_epi16(V, r)};
+        const __m128i IS_G{_mm_andnot_si128(IS_R, _mm_cmpeq_epi16(V, g))};
+        const __m128i G_BELOW_B{_mm_andnot_si128(_mm_cmpeq_epi16(_mm_max_epu16(g, b), g), _mm_set1_epi16(-1))};
+        const __m128i N_R{_mm_add_epi16(_mm_sub_epi16(_mm_mullo_epi16(g, C30), _mm_mullo_epi16(b, C30)),
+                                        _mm_and_si128(G_BELOW_B, _mm_mullo_epi16(D, _mm_set1_epi16(180))))};
+        const __m128i N_G{_mm_add_epi16(_mm_mullo_epi16(D, _mm_set1_epi16(60)), _mm_sub_epi16(_mm_mullo_epi16(b, C30), _mm_mullo_epi16(r, C30)))};
+        const __m128i N_B{_mm_add_epi16(_mm_mullo_epi16(D, _mm_set1_epi16(120)), _mm_sub_epi16(_mm_mullo_epi16(r, C30), _mm_mullo_epi16(g, C30)))};
+        const __m128i N{_mm_blendv_epi8(_mm_blendv_epi8(N_B, N_G, IS_G), N_R, IS_R)};
+
+        const __m128i HUE_LOW{_mm_mullo_epi16(D, _mm_set1_epi16(static_cast<int16_t>(t.hueLow)))};
+        const __m128i HUE_HIGH{_mm_mullo_epi16(D, _mm_set1_epi16(static_cast<int16_t>(t.hueHigh)))};
+        const __m128i ABOVE_LOW{_mm_cmpeq_epi16(_mm_max_epu16(N, HUE_LOW), N)};
+        const __m128i BELOW_HIGH{_mm_cmpeq_epi16(_mm_min_epu16(N, HUE_HIGH), N)};
+        const __m128i WRAPS{_mm_set1_epi16(static_cast<int16_t>(t.wraps))};
+        const __m128i HUE_OK{_mm_blendv_epi8(_mm_and_si128(ABOVE_LOW, BELOW_HIGH), _mm_or_si128(ABOVE_LOW, BELOW_HIGH), WRAPS)};
+
+        const __m128i S{_mm_mullo_epi16(D, _mm_set1_epi16(255))};
+        const __m128i SATURATION_LOW{_mm_mullo_epi16(V, _mm_set1_epi16(static_cast<int16_t>(t.saturationLow)))};
+        const __m128i SATURATION_HIGH{_mm_mullo_epi16(V, _mm_set1_epi16(static_cast<int16_t>(t.saturationHigh)))};
+        const __m128i SATURATION_OK{_mm_and_si128(_mm_cmpeq_epi16(_mm_max_epu16(S, SATURATION_LOW), S), _mm_cmpeq_epi16(_mm_min_epu16(S, SATURATION_HIGH), S))};
+
+        const __m128i VALUE_OK{_mm_and_si128(_mm_cmpeq_epi16(_mm_max_epu16(V, _mm_set1_epi16(static_cast<int16_t>(t.valueLow))), V),
+                                             _mm_cmpeq_epi16(_mm_min_epu16(V, _mm_set1_epi16(static_cast<int16_t>(t.valueHigh))), V))};
+        const __m128i GRAY{_mm_cmpeq_epi16(D, ZERO)};
+        const __m128i COLOR_OK{_mm_blendv_epi8(_mm_and_si128(HUE_OK, SATURATION_OK), _mm_set1_epi16(static_cast<int16_t>(t.grayOk)), GRAY)};
+        return _mm_and_si128(VALUE_OK, COLOR_OK);
+    }
+
+    __attribute__((target("sse4.1"))) static void thresholdSSE41(const uint8_t *bgra, const uint8_t *mask, uint32_t n, const Thresholds &blue,
+                                                                  const Thresholds &yellow, uint8_t *blueOut, uint8_t *yellowOut) noexcept {
+        // Gathers B, G, R, and A of four pixels into consecutive bytes.
+        const __m128i DEINTERLEAVE{_mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15)};
+        uint32_t i{0};
+        for (; i + 16 <= n; i += 16) {
+            __m128i blueHalves[2];
+            __m128i yellowHalves[2];
+            for (uint32_t h{0}; h < 2; h++) {
+                const uint8_t *p{bgra + 4 * (i + 8 * h)};
+                const __m128i P0{_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), DEINTERLEAVE)};
+                const __m128i P1{_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16)), DEINTERLEAVE)};
+                const __m128i BG{_mm_unpacklo_epi32(P0, P1)};
+                const __m128i RA{_mm_unpackhi_epi32(P0, P1)};
+                const __m128i B{_mm_cvtepu8_epi16(BG)};
+                const __m128i G{_mm_cvtepu8_epi16(_mm_srli_si128(BG, 8))};
+                const __m128i R{_mm_cvtepu8_epi16(RA)};
+                blueHalves[h]   = classifySSE41(B, G, R, blue);
+                yellowHalves[h] = classifySSE41(B, G, R, yellow);
+            }
+            __m128i on{_mm_set1_epi8(-1)};
+            if (nullptr != mask) {
+                on = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i)), _mm_setzero_si128()), on);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(blueOut + i), _mm_and_si128(on, _mm_packs_epi16(blueHalves[0], blueHalves[1])));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(yellowOut + i), _mm_and_si128(on, _mm_packs_epi16(yellowHalves[0], yellowHalves[1])));
+        }
+        thresholdScalar(bgra + 4 * i, (nullptr != mask) ? mask + i : nullptr, n - i, blue, yellow, blueOut + i, yellowOut + i);
+    }
+
+    __attribute__((target("avx2"))) static __m256i classifyAVX2(__m256i b, __m256i g, __m256i r, const Thresholds &t) noexcept {
+        const __m256i V{_mm256_max_epu16(_mm256_max_epu16(b, g), r)};
+        const __m256i D{_mm256_sub_epi16(V, _mm256_min_epu16(_mm256_min_epu16(b, g), r))};
+        const __m256i ZERO{_mm256_setzero_si256()};
+        const __m256i C30{_mm256_set1_epi16(30)};
+
+        const __m256i IS_R{_mm256_cmpeq_epi16(V, r)};
+        const __m256i IS_G{_mm256_andnot_si256(IS_R, _mm256_cmpeq_epi16(V, g))};
+        const __m256i G_BELOW_B{_mm256_andnot_si256(_mm256_cmpeq_epi16(_mm256_max_epu16(g, b), g), _mm256_set1_epi16(-1))};
+        const __m256i N_R{_mm256_add_epi16(_mm256_sub_epi16(_mm256_mullo_epi16(g, C30), _mm256_mullo_epi16(b, C30)),
+                                           _mm256_and_si256(G_BELOW_B, _mm256_mullo_epi16(D, _mm256_set1_epi16(180))))};
+        const __m256i N_G{
+            _mm256_add_epi16(_mm256_mullo_epi16(D, _mm256_set1_epi16(60)), _mm256_sub_epi16(_mm256_mullo_epi16(b, C30), _mm256_mullo_epi16(r, C30)))};
+        const __m256i N_B{
+            _mm256_add_epi16(_mm256_mullo_epi16(D, _mm256_set1_epi16(120)), _mm256_sub_epi16(_mm256_mullo_epi16(r, C30), _mm256_mullo_epi16(g, C30)))};
+        const __m256i N{_mm256_blendv_epi8(_mm256_blendv_epi8(N_B, N_G, IS_G), N_R, IS_R)};
+
+        const __m256i HUE_LOW{_mm256_mullo_epi16(D, _mm256_set1_epi16(static_cast<int16_t>(t.hueLow)))};
+        const __m256i HUE_HIGH{_mm256_mullo_epi16(D, _mm256_set1_epi16(static_cast<int16_t>(t.hueHigh)))};
+        const __m256i ABOVE_LOW{_mm256_cmpeq_epi16(_mm256_max_epu16(N, HUE_LOW), N)};
+        const __m256i BELOW_HIGH{_mm256_cmpeq_epi16(_mm256_min_epu16(N, HUE_HIGH), N)};
+        const __m256i WRAPS{_mm256_set1_epi16(static_cast<int16_t>(t.wraps))};
+        const __m256i HUE_OK{_mm256_blendv_epi8(_mm256_and_si256(ABOVE_LOW, BELOW_HIGH), _mm256_or_si256(ABOVE_LOW, BELOW_HIGH), WRAPS)};
+
+        const __m256i S{_mm256_mullo_epi16(D, _mm256_set1_epi16(255))};
+        const __m256i SATURATION_LOW{_mm256_mullo_epi16(V, _mm256_set1_epi16(static_cast<int16_t>(t.saturationLow)))};
+        const __m256i SATURATION_HIGH{_mm256_mullo_epi16(V, _mm256_set1_epi16(static_cast<int16_t>(t.saturationHigh)))};
+        const __m256i SATURATION_OK{
+            _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_max_epu16(S, SATURATION_LOW), S), _mm256_cmpeq_epi16(_mm256_min_epu16(S, SATURATION_HIGH), S))};
+
+        const __m256i VALUE_OK{_mm256_and_si256(_mm256_cmpeq_epi16(_mm256_max_epu16(V, _mm256_set1_epi16(static_cast<int16_t>(t.valueLow))), V),
+                                                _mm256_cmpeq_epi16(_mm256_min_epu16(V, _mm256_set1_epi16(static_cast<int16_t>(t.valueHigh))), V))};
+        const __m256i GRAY{_mm256_cmpeq_epi16(D, ZERO)};
+        const __m256i COLOR_OK{
+            _mm256_blendv_epi8(_mm256_and_si256(HUE_OK, SATURATION_OK), _mm256_set1_epi16(static_cast<int16_t>(t.grayOk)), GRAY)};
+        return _mm256_and_si256(VALUE_OK, COLOR_OK);
+    }
+
+    __attribute__((target("avx2"))) static void thresholdAVX2(const uint8_t *bgra, const uint8_t *mask, uint32_t n, const Thresholds &blue,
+                                                               const Thresholds &yellow, uint8_t *blueOut, uint8_t *yellowOut) noexcept {
+        // Per 128 bit lane, gathers B, G, R, and A of four pixels into consecutive bytes;
+        // the permutation then moves B and G of eight pixels into the lower and R and A into the upper lane.
+        const __m256i DEINTERLEAVE{_mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15)};
+        const __m256i PERMUTATION{_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)};
+        uint32_t i{0};
+        for (; i + 16 <= n; i += 16) {
+            const uint8_t *p{bgra + 4 * i};
+            const __m256i X0{_mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), DEINTERLEAVE), PERMUTATION)};
+            const __m256i X1{
+                _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32)), DEINTERLEAVE), PERMUTATION)};
+            const __m128i BG0{_mm256_castsi256_si128(X0)};
+            const __m128i BG1{_mm256_castsi256_si128(X1)};
+            const __m256i B{_mm256_cvtepu8_epi16(_mm_unpacklo_epi64(BG0, BG1))};
+            const __m256i G{_mm256_cvtepu8_epi16(_mm_unpackhi_epi64(BG0, BG1))};
+            const __m256i R{_mm256_cvtepu8_epi16(_mm_unpacklo_epi64(_mm256_extracti128_si256(X0, 1), _mm256_extracti128_si256(X1, 1)))};
+            const __m256i BLUE{classifyAVX2(B, G, R, blue)};
+            const __m256i YELLOW{classifyAVX2(B, G, R, yellow)};
+
+            __m128i on{_mm_set1_epi8(-1)};
+            if (nullptr != mask) {
+                on = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i)), _mm_setzero_si128()), on);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(blueOut + i),
+                             _mm_and_si128(on, _mm_packs_epi16(_mm256_castsi256_si128(BLUE), _mm256_extracti128_si256(BLUE, 1))));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(yellowOut + i),
+                             _mm_and_si128(on, _mm_packs_epi16(_mm256_castsi256_si128(YELLOW), _mm256_extracti128_si256(YELLOW, 1))));
+        }
+        thresholdScalar(bgra + 4 * i, (nullptr != mask) ? mask + i : nullptr, n - i, blue, yellow, blueOut + i, yellowOut + i);
+    }
+#endif
+
+#ifdef CONE_SEGMENTATION_NEON
+    static uint16x8_t classifyNEON(uint16x8_t b, uint16x8_t g, uint16x8_t r, const Thresholds &t) noexcept {
+        const uint16x8_t V{vmaxq_u16(vmaxq_u16(b, g), r)};
+        const uint16x8_t D{vsubq_u16(V, vminq_u16(vminq_u16(b, g), r))};
+
+        const uint16x8_t IS_R{vceqq_u16(V, r)};
+        const uint16x8_t IS_G{vbicq_u16(vceqq_u16(V, g), IS_R)};
+        const uint16x8_t N_R{vaddq_u16(vmlsq_n_u16(vmulq_n_u16(g, 30), b, 30), vandq_u16(vcltq_u16(g, b), vmulq_n_u16(D, 180)))};
+        const uint16x8_t N_G{vmlsq_n_u16(vmlaq_n_u16(vmulq_n_u16(D, 60), b, 30), r, 30)};
+        const uint16x8_t N_B{vmlsq_n_u16(vmlaq_n_u16(vmulq_n_u16(D, 120), r, 30), g, 30)};
+        const uint16x8_t N{vbslq_u16(IS_R, N_R, vbslq_u16(IS_G, N_G, N_B))};
+
+        const uint16x8_t ABOVE_LOW{vcgeq_u16(N, vmulq_n_u16(D, t.hueLow))};
+        const uint16x8_t BELOW_HIGH{vcleq_u16(N, vmulq_n_u16(D, t.hueHigh))};
+        const uint16x8_t HUE_OK{vbslq_u16(vdupq_n_u16(t.wraps), vorrq_u16(ABOVE_LOW, BELOW_HIGH), vandq_u16(ABOVE_LOW, BELOW_HIGH))};
+
+        const uint16x8_t S{vmulq_n_u16(D, 255)};
+        const uint16x8_t SATURATION_OK{vandq_u16(vcgeq_u16(S, vmulq_n_u16(V, t.saturationLow)), vcleq_u16(S, vmulq_n_u16(V, t.saturationHigh)))};
+        const uint16x8_t VALUE_OK{vandq_u16(vcgeq_u16(V, vdupq_n_u16(t.valueLow)), vcleq_u16(V, vdupq_n_u16(t.valueHigh)))};
+        const uint16x8_t COLOR_OK{vbslq_u16(vceqq_u16(D, vdupq_n_u16(0)), vdupq_n_u16(t.grayOk), vandq_u16(HUE_OK, SATURATION_OK))};
+        return vandq_u16(VALUE_OK, COLOR_OK);
+    }
+
+    static void thresholdNEON(const uint8_t *bgra, const uint8_t *mask, uint32_t n, const Thresholds &blue, const Thresholds &yellow, uint8_t *blueOut,
+                              uint8_t *yellowOut) noexcept {
+        uint32_t i{0};
+        for (; i + 8 <= n; i += 8) {
+            // Loads eight pixels split into B, G, R, and A.
+            const uint8x8x4_t P = vld4_u8(bgra + 4 * i);
+            const uint16x8_t B{vmovl_u8(P.val[0])};
+            const uint16x8_t G{vmovl_u8(P.val[1])};
+            const uint16x8_t R{vmovl_u8(P.val[2])};
+            uint8x8_t on{vdup_n_u8(0xFF)};
+            if (nullptr != mask) {
+                on = vtst_u8(vld1_u8(mask + i), on);
+            }
+            vst1_u8(blueOut + i, vand_u8(on, vmovn_u16(classifyNEON(B, G, R, blue))));
+            vst1_u8(yellowOut + i, vand_u8(on, vmovn_u16(classifyNEON(B, G, R, yellow))));
+        }
+        thresholdScalar(bgra + 4 * i, (nullptr != mask) ? mask + i : nullptr, n - i, blue, yellow, blueOut + i, yellowOut + i);
+    }
+#endif
+
+   private:
+    Thresholds m_blue;
+    Thresholds m_yellow;
+    const char *m_implementation{"scalar"};
+    Kernel m_kernel{&ConeSegmentation::thresholdScalar};
+};
+
+} // namespace cones
+
+#endif
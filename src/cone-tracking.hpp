@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONE_TRACKING_HPP
+#define CONE_TRACKING_HPP
+
+#include "cone-detection.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Tracks of the detected cones from frame to frame. Cones move only a few
+// pixels between frames, so the vision workers search only windows around the
+// predicted positions of the tracks and scan the whole frame every few frames
+// or after a track was lost, to find cones coming into view.
+//
+// The tracks are updated in frame order by the committing thread, which gives
+// them stable ids; the vision workers predict from the latest update, which may
+// be some frames older than the frame they process.
+namespace tracking {
+
+struct Track {
+    uint32_t id{0};
+    uint32_t type{0};      // detection::ConeType.
+    uint64_t sequence{0};  // Frame in which the cone was seen last.
+    uint32_t misses{0};    // Frames in a row in which the cone was not found.
+    float x{0.0f};         // Centroid in the pixels of the mask.
+    float y{0.0f};
+    float velocityX{0.0f}; // Pixels per frame.
+    float velocityY{0.0f};
+    cv::Rect box{};
+};
+
+class ConeTracker {
+   private:
+    ConeTracker(const ConeTracker &) = delete;
+    ConeTracker(ConeTracker &&)      = delete;
+    ConeTracker &operator=(const ConeTracker &) = delete;
+    ConeTracker &operator=(ConeTracker &&) = delete;
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param fullScanInterval Every fullScanInterval-th frame is scanned completely; 1 to scan every frame.
+     * @param maxMisses Tracks not found for more frames in a row are dropped.
+     */
+    ConeTracker(uint32_t fullScanInterval, uint32_t maxMisses) noexcept
+        : m_fullScanInterval{std::max(1u, fullScanInterval)}
+        , m_maxMisses{maxMisses} {}
+
+    /**
+     * This method returns the windows to search in a frame; it may be called from several threads.
+     *
+     * @param sequence Sequence number of the frame.
+     * @param size Size of the masks.
+     * @param windows Non-overlapping windows around the predicted cones.
+     * @return false if the whole frame is to be scanned.
+     */
+    bool searchWindows(uint64_t sequence, const cv::Size &size, std::vector<cv::Rect> &windows) const {
+        windows.clear();
+        std::lock_guard<std::mutex> lck(m_predictionMutex);
+        if ((0 == sequence % m_fullScanInterval) || m_lost || m_predictions.empty()) {
+            return false;
+        }
+        const cv::Rect FRAME{0, 0, size.width, size.height};
+        for (const auto &t : m_predictions) {
+            const cv::Rect PREDICTED{predict(t, sequence)};
+            // Room for the cone to grow while coming closer, and for errors of the prediction.
+            const int MARGIN{MIN_MARGIN + std::max(PREDICTED.width, PREDICTED.height) / 2};
+            const cv::Rect WINDOW{cv::Rect(PREDICTED.x - MARGIN, PREDICTED.y - MARGIN, PREDICTED.width + 2 * MARGIN, PREDICTED.height + 2 * MARGIN) & FRAME};
+            if (0 < WINDOW.area()) {
+                windows.push_back(WINDOW);
+            }
+        }
+        // Overlapping windows are merged so that no pixel is scanned twice and no cone is found twice.
+        for (bool merged{true}; merged;) {
+            merged = false;
+            for (std::size_t i{0}; i < windows.size(); i++) {
+                for (std::size_t j{i + 1}; j < windows.size();) {
+                    if (0 < (windows[i] & windows[j]).area()) {
+                        windows[i] = windows[i] | windows[j];
+                        windows.erase(windows.begin() + static_cast<std::ptrdiff_t>(j));
+                        merged = true;
+                    } else {
+                        j++;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * This method assigns the blobs of a frame to the tracks; frames must be passed in order.
+     *
+     * @param sequence Sequence number of the frame.
+     * @param blue Blue cones found in the frame.
+     * @param yellow Yellow cones found in the frame.
+     */
+    void update(uint64_t sequence, const std::vector<detection::Blob> &blue, const std::vector<detection::Blob> &yellow) {
+        for (auto &t : m_tracks) {
+            t.misses++;
+        }
+        assign(sequence, detection::BLUE_CONE, blue);
+        assign(sequence, detection::YELLOW_CONE, yellow);
+
+        bool lost{false};
+        for (auto it{m_tracks.begin()}; it != m_tracks.end();) {
+            lost = lost || (0 < it->misses);
+            if (it->misses > m_maxMisses) {
+                it = m_tracks.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        std::lock_guard<std::mutex> lck(m_predictionMutex);
+        m_predictions = m_tracks;
+        m_lost        = lost;
+    }
+
+    /**
+     * @return Tracks after the last update; the ones with 0 misses were seen in that frame.
+     */
+    const std::vector<Track> &tracks() const noexcept {
+        return m_tracks;
+    }
+
+   private:
+    enum : int { MIN_MARGIN = 4 };
+
+    static cv::Rect predict(const Track &t, uint64_t sequence) noexcept {
+        const float FRAMES{static_cast<float>(sequence - t.sequence)};
+        return cv::Rect(t.box.x + static_cast<int>(std::lround(t.velocityX * FRAMES)), t.box.y + static_cast<int>(std::lround(t.velocityY * FRAMES)), t.box.width, t.box.height);
+    }
+
+    // Greedy nearest-neighbor assignment: the closest pairs of blob and predicted track are matched first.
+    void assign(uint64_t sequence, uint32_t type, const std::vector<detection::Blob> &blobs) {
+        m_pairs.clear();
+        for (uint32_t b{0}; b < blobs.size(); b++) {
+            for (uint32_t t{0}; t < m_tracks.size(); t++) {
+                const Track &track = m_tracks[t];
+                if (track.type != type) {
+                    continue;
+                }
+                const float FRAMES{static_cast<float>(sequence - track.sequence)};
+                const float DX{blobs[b].x - (track.x + track.velocityX * FRAMES)};
+                const float DY{blobs[b].y - (track.y + track.velocityY * FRAMES)};
+                const float GATE{static_cast<float>(MIN_MARGIN + std::max(track.box.width, track.box.height))};
+                const float DISTANCE{DX * DX + DY * DY};
+                if (DISTANCE <= GATE * GATE) {
+                    m_pairs.push_back(Pair{DISTANCE, b, t});
+                }
+            }
+        }
+        std::sort(m_pairs.begin(), m_pairs.end(), [](const Pair &a, const Pair &b) { return a.distance < b.distance; });
+
+        m_blobAssigned.assign(blobs.size(), false);
+        for (const auto &p : m_pairs) {
+            Track &track = m_tracks[p.track];
+            if (m_blobAssigned[p.blob] || (track.sequence == sequence)) {
+                continue;
+            }
+            m_blobAssigned[p.blob] = true;
+
+            const detection::Blob &blob = blobs[p.blob];
+            const float FRAMES{static_cast<float>(sequence - track.sequence)};
+            // Smoothed to keep the predictions steady despite jittering blobs.
+            track.velocityX = 0.5f * track.velocityX + 0.5f * (blob.x - track.x) / FRAMES;
+            track.velocityY = 0.5f * track.velocityY + 0.5f * (blob.y - track.y) / FRAMES;
+            track.x         = blob.x;
+            track.y         = blob.y;
+            track.box       = blob.box;
+            track.sequence  = sequence;
+            track.misses    = 0;
+        }
+
+        for (uint32_t b{0}; b < blobs.size(); b++) {
+            if (!m_blobAssigned[b]) {
+                Track track;
+                track.id       = m_nextId++;
+                track.type     = type;
+                track.sequence = sequence;
+                track.x        = blobs[b].x;
+                track.y        = blobs[b].y;
+                track.box      = blobs[b].box;
+                m_tracks.push_back(track);
+            }
+        }
+    }
+
+   private:
+    struct Pair {
+        float distance;
+        uint32_t blob;
+        uint32_t track;
+    };
+
+    const uint32_t m_fullScanInterval;
+    const uint32_t m_maxMisses;
+
+    // Used only by the thread calling update().
+    std::vector<Track> m_tracks{};
+    std::vector<Pair> m_pairs{};
+    std::vector<bool> m_blobAssigned{};
+    uint32_t m_nextId{0};
+
+    mutable std::mutex m_predictionMutex{};
+    std::vector<Track> m_predictions{};
+    bool m_lost{false};
+};
+
+} // namespace tracking
+
+#endif
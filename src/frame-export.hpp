@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_EXPORT_HPP
+#define FRAME_EXPORT_HPP
+
+#include "cluon-complete.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Export of the annotated frames for running without a display:
+//
+// - "mjpeg:<file>": JPEG images appended to a file (play with ffplay -f mjpeg);
+//   after the given number of frames, the file is renamed to <file>.1 and a
+//   new one is started,
+// - "png:<directory>": one PNG image per frame; only the given number of the
+//   latest images is kept,
+// - "tcp:<port>": an HTTP MJPEG stream for browsers or ffplay at
+//   http://<host>:<port>/.
+//
+// Writing or sending happens in the thread calling write(); a viewer that
+// does not take a frame within SEND_TIMEOUT_MS is disconnected so that it
+// cannot hold up the other viewers.
+namespace headless {
+
+class FrameExport {
+   private:
+    FrameExport(const FrameExport &) = delete;
+    FrameExport(FrameExport &&)      = delete;
+    FrameExport &operator=(const FrameExport &) = delete;
+    FrameExport &operator=(FrameExport &&) = delete;
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param target "mjpeg:<file>", "png:<directory>", or "tcp:<port>".
+     * @param keep Number of frames per MJPEG file or number of PNG images to keep.
+     */
+    FrameExport(const std::string &target, uint32_t keep) noexcept
+        : m_keep{std::max(1u, keep)} {
+        const std::size_t COLON{target.find(':')};
+        const std::string KIND{target.substr(0, COLON)};
+        const std::string WHERE{(std::string::npos != COLON) ? target.substr(COLON + 1) : ""};
+        if (WHERE.empty()) {
+            std::cerr << "[headless] Invalid export target '" << target << "'." << std::endl;
+        } else if ("mjpeg" == KIND) {
+            m_kind = MJPEG;
+            m_path = WHERE;
+            m_file.open(m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            m_valid = m_file.good();
+        } else if ("png" == KIND) {
+            m_kind = PNG;
+            m_path = WHERE;
+            struct stat info;
+            m_valid = (0 == ::stat(m_path.c_str(), &info)) && S_ISDIR(info.st_mode) && (0 == ::access(m_path.c_str(), W_OK | X_OK));
+        } else if ("tcp" == KIND) {
+            m_kind = TCP;
+            m_path = WHERE;
+            // Sending to a viewer that disconnected must not end the program.
+            std::signal(SIGPIPE, SIG_IGN);
+            const int PORT{std::atoi(WHERE.c_str())};
+            if ((0 < PORT) && (PORT <= 65535)) {
+                m_server.reset(new cluon::TCPServer(static_cast<uint16_t>(PORT), [this](std::string &&from, std::shared_ptr<cluon::TCPConnection> connection) {
+                    std::clog << "[headless] Streaming to " << from << "." << std::endl;
+                    connection->setSendTimeout(std::chrono::milliseconds(SEND_TIMEOUT_MS));
+                    sendAll(*connection, "HTTP/1.0 200 OK\r\nCache-Control: no-cache\r\nContent-Type: multipart/x-mixed-replace; boundary=frame\r\n\r\n");
+                    std::lock_guard<std::mutex> lck(m_connectionsMutex);
+                    m_connections.push_back(connection);
+                }));
+                m_valid = m_server->isRunning();
+            }
+        } else {
+            std::cerr << "[headless] Unknown export target '" << target << "'." << std::endl;
+        }
+        if (!m_valid) {
+            std::cerr << "[headless] Cannot export to '" << target << "'." << std::endl;
+        }
+    }
+
+    bool valid() const noexcept {
+        return m_valid;
+    }
+
+    /**
+     * This method encodes a BGRA image and writes or sends it.
+     */
+    void write(const cv::Mat &bgra) noexcept {
+        if (!m_valid) {
+            return;
+        }
+        try {
+            // The alpha channel of the frames is not meaningful.
+            cv::cvtColor(bgra, m_bgr, cv::COLOR_BGRA2BGR);
+            if (PNG == m_kind) {
+                std::stringstream name;
+                name << m_path << "/frame-" << m_frames << ".png";
+                if (!cv::imwrite(name.str(), m_bgr, {cv::IMWRITE_PNG_COMPRESSION, 1})) {
+                    failed(name.str());
+                }
+                if (m_frames >= m_keep) {
+                    std::stringstream old;
+                    old << m_path << "/frame-" << (m_frames - m_keep) << ".png";
+                    std::remove(old.str().c_str());
+                }
+            } else {
+                cv::imencode(".jpg", m_bgr, m_jpeg, {cv::IMWRITE_JPEG_QUALITY, 80});
+                if (MJPEG == m_kind) {
+                    if ((0 < m_frames) && (0 == m_frames % m_keep)) {
+                        m_file.close();
+                        std::rename(m_path.c_str(), (m_path + ".1").c_str());
+                        m_file.open(m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+                    }
+                    m_file.write(reinterpret_cast<const char *>(m_jpeg.data()), static_cast<std::streamsize>(m_jpeg.size()));
+                    m_file.flush();
+                    if (!m_file.good()) {
+                        failed(m_path);
+                    }
+                } else {
+                    send();
+                }
+            }
+            m_frames++;
+        } catch (...) {}
+    }
+
+    std::string toString() const noexcept {
+        std::stringstream sstr;
+        if (MJPEG == m_kind) {
+            sstr << "MJPEG file " << m_path << " (" << m_keep << " frames per file)";
+        } else if (PNG == m_kind) {
+            sstr << "PNG images in " << m_path << " (keeping " << m_keep << ")";
+        } else {
+            sstr << "MJPEG stream over HTTP on port " << m_path;
+        }
+        return sstr.str();
+    }
+
+   private:
+    enum Kind : uint8_t { MJPEG = 0, PNG = 1, TCP = 2 };
+    enum : uint32_t { SEND_TIMEOUT_MS = 200 };
+
+    // Failing writes are reported once; the frames keep coming.
+    void failed(const std::string &where) noexcept {
+        if (!m_failed) {
+            m_failed = true;
+            std::cerr << "[headless] Cannot write " << where << "; further failures are not reported." << std::endl;
+        }
+    }
+
+    // cluon::TCPConnection sends at most 64 KB at once and may send less.
+    static bool sendAll(const cluon::TCPConnection &connection, const std::string &data) noexcept {
+        const std::size_t MAX_LENGTH{65535};
+        const auto DEADLINE{std::chrono::steady_clock::now() + std::chrono::milliseconds(SEND_TIMEOUT_MS)};
+        for (std::size_t offset{0}; offset < data.size();) {
+            const auto RESULT{connection.send(data.substr(offset, MAX_LENGTH))};
+            if (0 >= RESULT.first) {
+                return false;
+            }
+            offset += static_cast<std::size_t>(RESULT.first);
+            if ((offset < data.size()) && (std::chrono::steady_clock::now() > DEADLINE)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void send() {
+        std::stringstream part;
+        part << "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " << m_jpeg.size() << "\r\n\r\n";
+        part.write(reinterpret_cast<const char *>(m_jpeg.data()), static_cast<std::streamsize>(m_jpeg.size()));
+        part << "\r\n";
+        const std::string PART{part.str()};
+
+        std::lock_guard<std::mutex> lck(m_connectionsMutex);
+        for (auto it{m_connections.begin()}; it != m_connections.end();) {
+            if (sendAll(**it, PART)) {
+                it++;
+            } else {
+                std::clog << "[headless] Stopped streaming to a viewer that disconnected or did not keep up." << std::endl;
+                it = m_connections.erase(it);
+            }
+        }
+    }
+
+   private:
+    Kind m_kind{MJPEG};
+    bool m_valid{false};
+    bool m_failed{false};
+    uint32_t m_keep;
+    uint64_t m_frames{0};
+    std::string m_path{};
+    std::ofstream m_file{};
+    cv::Mat m_bgr{};
+    std::vector<unsigned char> m_jpeg{};
+
+    std::mutex m_connectionsMutex{};
+    std::vector<std::shared_ptr<cluon::TCPConnection>> m_connections{};
+    // Declared last to stop accepting connections before the connections are destroyed.
+    std::unique_ptr<cluon::TCPServer> m_server{};
+};
+
+} // namespace headless
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_PIPELINE_HPP
+#define FRAME_PIPELINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Bounded queues between the threads of the frame pipeline: capture, vision
+// workers, the thread committing the results in frame order, and the
+// visualization.
+namespace pipeline {
+
+// What happens to frames when the next stage falls behind.
+enum DropPolicy : uint8_t {
+    DROP_NEWEST = 0, // A full queue rejects new frames; queued frames are all processed.
+    DROP_OLDEST = 1, // Consumers skip queued frames in favor of the newest one.
+};
+
+/**
+ * This function parses "newest" or "oldest".
+ *
+ * @return false if the text is not a drop policy.
+ */
+inline bool parse(const std::string &text, DropPolicy &policy) noexcept {
+    if ("newest" == text) {
+        policy = DROP_NEWEST;
+        return true;
+    }
+    if ("oldest" == text) {
+        policy = DROP_OLDEST;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Bounded queue for exactly one producer thread and one consumer thread. Items
+ * are moved in and out; the consumer can wait for items, the producer never
+ * blocks.
+ */
+template <typename T>
+class SpscQueue {
+   private:
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue(SpscQueue &&)      = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+    SpscQueue &operator=(SpscQueue &&) = delete;
+
+   public:
+    explicit SpscQueue(uint32_t capacity) noexcept
+        : m_capacity{std::max(1u, capacity)}
+        , m_items(m_capacity) {}
+
+    /**
+     * This method moves an item into the queue if there is room; otherwise, the item is left untouched.
+     *
+     * @return false if the queue is full.
+     */
+    bool push(T &item) noexcept {
+        const uint64_t TAIL{m_tail.load(std::memory_order_relaxed)};
+        if (TAIL - m_head.load(std::memory_order_acquire) >= m_capacity) {
+            return false;
+        }
+        m_items[TAIL % m_capacity] = std::move(item);
+        // Sequentially consistent with m_waiting so that either this thread sees the waiting consumer or the consumer sees the item.
+        m_tail.store(TAIL + 1);
+        if (m_waiting.load()) {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            m_available.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * This method moves the oldest item out of the queue.
+     *
+     * @return false if the queue is empty.
+     */
+    bool pop(T &item) noexcept {
+        const uint64_t HEAD{m_head.load(std::memory_order_relaxed)};
+        if (HEAD == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(m_items[HEAD % m_capacity]);
+        m_head.store(HEAD + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * This method moves the oldest item out of the queue and waits for one if the queue is empty.
+     *
+     * @return false if no item arrived within the timeout.
+     */
+    bool pop(T &item, std::chrono::milliseconds timeout) noexcept {
+        if (pop(item)) {
+            return true;
+        }
+        {
+            std::unique_lock<std::mutex> lck(m_mutex);
+            m_waiting.store(true);
+            m_available.wait_for(lck, timeout, [this]() { return m_head.load(std::memory_order_relaxed) != m_tail.load(); });
+            m_waiting.store(false);
+        }
+        return pop(item);
+    }
+
+    /**
+     * @return Number of queued items; only exact for the producer and the consumer.
+     */
+    uint32_t size() const noexcept {
+        return static_cast<uint32_t>(m_tail.load() - m_head.load());
+    }
+
+   private:
+    const uint32_t m_capacity;
+    std::vector<T> m_items;
+
+    // Written by the consumer; padded to keep it apart from the producer's index.
+    std::atomic<uint64_t> m_head{0};
+    char m_padding[64]{};
+    std::atomic<uint64_t> m_tail{0};
+
+    std::atomic<bool> m_waiting{false};
+    std::mutex m_mutex{};
+    std::condition_variable m_available{};
+};
+
+/**
+ * Single slot handing the latest item from one thread to another: a new item
+ * replaces an item that was not taken yet, so a slow receiver skips items.
+ * Items are swapped in and out to reuse their buffers.
+ */
+template <typename T>
+class Mailbox {
+   private:
+    Mailbox(const Mailbox &) = delete;
+    Mailbox(Mailbox &&)      = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
+    Mailbox &operator=(Mailbox &&) = delete;
+
+   public:
+    Mailbox() = default;
+
+    /**
+     * This method puts an item into the slot.
+     *
+     * @param item Item to post; afterwards, an earlier item to reuse.
+     * @return true if the replaced item was never taken.
+     */
+    bool post(T &item) noexcept {
+        bool skipped{false};
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            std::swap(m_item, item);
+            skipped = m_full;
+            m_full  = true;
+        }
+        m_available.notify_one();
+        return skipped;
+    }
+
+    /**
+     * This method takes the latest item out of the slot and waits for one if there is none.
+     *
+     * @param item Item taken; its previous content goes back to the poster for reuse.
+     * @return false if no item arrived within the timeout.
+     */
+    bool take(T &item, std::chrono::milliseconds timeout) noexcept {
+        std::unique_lock<std::mutex> lck(m_mutex);
+        if (!m_available.wait_for(lck, timeout, [this]() { return m_full; })) {
+            return false;
+        }
+        std::swap(m_item, item);
+        m_full = false;
+        return true;
+    }
+
+   private:
+    T m_item{};
+    bool m_full{false};
+    std::mutex m_mutex{};
+    std::condition_variable m_available{};
+};
+
+} // namespace pipeline
+
+#endif
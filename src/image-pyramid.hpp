@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGE_PYRAMID_HPP
+#define IMAGE_PYRAMID_HPP
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+// clang-format off
+#if defined(__SSE2__)
+    #define IMAGE_PYRAMID_SSE2
+    #include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define IMAGE_PYRAMID_NEON
+    #include <arm_neon.h>
+#endif
+// clang-format on
+
+// Half, quarter, and eighth resolution versions of a BGRA frame for stages
+// that do not need every pixel. A level is computed from the level above it
+// with a 2x2 box filter the first time a stage asks for it during a frame;
+// the images are kept from frame to frame to reuse their memory.
+namespace pyramid {
+
+class ImagePyramid {
+   private:
+    ImagePyramid(const ImagePyramid &) = delete;
+    ImagePyramid(ImagePyramid &&)      = delete;
+    ImagePyramid &operator=(const ImagePyramid &) = delete;
+    ImagePyramid &operator=(ImagePyramid &&) = delete;
+
+   public:
+    // Level 0 is the frame itself; level n has 1/2^n of its width and height.
+    enum : uint32_t { LEVELS = 4 };
+
+    ImagePyramid() = default;
+
+    /**
+     * @return Size of a level for a frame of the given size; odd rows and columns are dropped.
+     */
+    static cv::Size size(const cv::Size &frame, uint32_t level) noexcept {
+        cv::Size s{frame};
+        for (uint32_t i{0}; i < std::min(level, LEVELS - 1u); i++) {
+            s = cv::Size(s.width / 2, s.height / 2);
+        }
+        return s;
+    }
+
+    /**
+     * This method starts a new frame; the image must stay unchanged while levels are requested.
+     *
+     * @param frame BGRA image of type CV_8UC4.
+     */
+    void reset(const cv::Mat &frame) noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        m_levels[0] = frame;
+        m_computed  = 1;
+    }
+
+    /**
+     * This method returns a level and computes it and the levels above it if needed; it may be called from several threads.
+     *
+     * @param level 0 to LEVELS - 1.
+     * @return Image that stays valid until the next call to reset().
+     */
+    const cv::Mat &level(uint32_t level) {
+        level = std::min(level, LEVELS - 1u);
+        std::lock_guard<std::mutex> lck(m_mutex);
+        for (; m_computed <= level; m_computed++) {
+            downsample(m_levels[m_computed - 1], m_levels[m_computed]);
+        }
+        return m_levels[level];
+    }
+
+    /**
+     * This method halves width and height of a BGRA image; every pixel is the rounded mean of a 2x2 block.
+     *
+     * @param src Image of type CV_8UC4.
+     * @param dst Result; (re)allocated if needed.
+     */
+    static void downsample(const cv::Mat &src, cv::Mat &dst) {
+        dst.create(src.rows / 2, src.cols / 2, CV_8UC4);
+        for (int y{0}; y < dst.rows; y++) {
+            downsampleRow(src.ptr<uint8_t>(2 * y), src.ptr<uint8_t>(2 * y + 1), dst.ptr<uint8_t>(y), dst.cols);
+        }
+    }
+
+   private:
+    static void downsampleRow(const uint8_t *row0, const uint8_t *row1, uint8_t *out, int width) noexcept {
+        int x{0};
+#ifdef IMAGE_PYRAMID_SSE2
+        // Four output pixels from eight pixels of two rows; the sums are done in 16 bit lanes.
+        const __m128i ZERO{_mm_setzero_si128()};
+        const __m128i TWO{_mm_set1_epi16(2)};
+        for (; x + 4 <= width; x += 4) {
+            __m128i pairs[2];
+            for (int h{0}; h < 2; h++) {
+                const __m128i A{_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 8 * x + 16 * h))};
+                const __m128i B{_mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 8 * x + 16 * h))};
+                // Pixels 0 and 1, and pixels 2 and 3, with both rows added.
+                const __m128i P01{_mm_add_epi16(_mm_unpacklo_epi8(A, ZERO), _mm_unpacklo_epi8(B, ZERO))};
+                const __m128i P23{_mm_add_epi16(_mm_unpackhi_epi8(A, ZERO), _mm_unpackhi_epi8(B, ZERO))};
+                const __m128i SUMS{_mm_unpacklo_epi64(_mm_add_epi16(P01, _mm_srli_si128(P01, 8)), _mm_add_epi16(P23, _mm_srli_si128(P23, 8)))};
+                pairs[h] = _mm_srli_epi16(_mm_add_epi16(SUMS, TWO), 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * x), _mm_packus_epi16(pairs[0], pairs[1]));
+        }
+#endif
+#ifdef IMAGE_PYRAMID_NEON
+        // Two output pixels from four pixels of two rows; the rounding shift divides by four.
+        for (; x + 2 <= width; x += 2) {
+            const uint8x16_t A{vld1q_u8(row0 + 8 * x)};
+            const uint8x16_t B{vld1q_u8(row1 + 8 * x)};
+            const uint16x8_t P01{vaddl_u8(vget_low_u8(A), vget_low_u8(B))};
+            const uint16x8_t P23{vaddl_u8(vget_high_u8(A), vget_high_u8(B))};
+            const uint16x8_t SUMS{vcombine_u16(vadd_u16(vget_low_u16(P01), vget_high_u16(P01)), vadd_u16(vget_low_u16(P23), vget_high_u16(P23)))};
+            vst1_u8(out + 4 * x, vrshrn_n_u16(SUMS, 2));
+        }
+#endif
+        for (; x < width; x++) {
+            for (int c{0}; c < 4; c++) {
+                const int SUM{row0[8 * x + c] + row0[8 * x + 4 + c] + row1[8 * x + c] + row1[8 * x + 4 + c]};
+                out[4 * x + c] = static_cast<uint8_t>((SUM + 2) >> 2);
+            }
+        }
+    }
+
+   private:
+    std::mutex m_mutex{};
+    cv::Mat m_levels[LEVELS]{};
+    // Number of levels that are up to date, including level 0.
+    uint32_t m_computed{1};
+};
+
+} // namespace pyramid
+
+#endif
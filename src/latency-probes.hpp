@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCY_PROBES_HPP
+#define LATENCY_PROBES_HPP
+
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Latency probes for the camera-to-steering pipeline. Every thread records
+// into its own set of histograms (one per stage) so that probes never contend;
+// reports merge the sets of all threads.
+namespace latency {
+
+enum Stage : uint8_t {
+    FRAME_AGE = 0,   // Frame time stamp from the producer -> wait() returned.
+    WAIT,            // Blocked in wait().
+    LOCK,            // Acquiring the shared memory lock.
+    COPY,            // Holding the shared memory lock, including copies repeated after the producer overwrote the frame.
+    MASK,            // Segmenting the cones within the masks of the region of interest.
+    STEERING,        // Computing and writing the steering.
+    END_TO_END,      // wait() returned -> steering written.
+    FRAME_TO_OUTPUT, // Frame time stamp from the producer -> steering written.
+    DETECT,          // Labeling the blobs of the cone masks; appended to keep the senderStamps of the other stages.
+    NUMBER_OF_STAGES
+};
+
+inline const char *stageName(Stage stage) noexcept {
+    static const char *NAMES[NUMBER_OF_STAGES]{"frame-age", "wait", "lock", "copy", "mask", "steering", "end-to-end", "frame-to-output", "detect"};
+    return (stage < NUMBER_OF_STAGES) ? NAMES[stage] : "unknown";
+}
+
+class Probes {
+   private:
+    struct Histograms {
+        cluon::Histogram m_stages[NUMBER_OF_STAGES];
+    };
+
+   public:
+    static Probes &instance() noexcept {
+        static Probes instance;
+        return instance;
+    }
+
+    /**
+     * Records the duration of a stage in nanoseconds for the calling thread.
+     */
+    void record(Stage stage, uint64_t nanoseconds) noexcept {
+        Histograms *h{local()};
+        if ((nullptr != h) && (stage < NUMBER_OF_STAGES)) {
+            h->m_stages[stage].record(nanoseconds);
+        }
+    }
+
+    /**
+     * Records the time since a time stamp set by another process (system clock);
+     * implausible values, like those from replayed recordings, are ignored.
+     */
+    void recordSince(Stage stage, const cluon::data::TimeStamp &then, const cluon::data::TimeStamp &now) noexcept {
+        const int64_t MICROSECONDS{cluon::time::deltaInMicroseconds(now, then)};
+        if ((0 <= MICROSECONDS) && (MICROSECONDS < MAX_PLAUSIBLE_AGE_IN_MICROSECONDS)) {
+            record(stage, static_cast<uint64_t>(MICROSECONDS) * 1000);
+        }
+    }
+
+    /**
+     * @return Percentiles in microseconds per stage, merged over all threads.
+     */
+    std::string report() const noexcept {
+        std::stringstream sstr;
+        try {
+            sstr << "[latency] " << std::left << std::setw(16) << "stage" << std::right << std::setw(10) << "count" << std::setw(10) << "p50" << std::setw(10)
+                 << "p99" << std::setw(10) << "p999" << std::setw(10) << "max"
+                 << " (us)" << std::endl;
+            sstr << std::fixed << std::setprecision(1);
+            for (uint8_t s{0}; s < NUMBER_OF_STAGES; s++) {
+                cluon::Histogram merged;
+                mergeInto(static_cast<Stage>(s), merged);
+                sstr << "[latency] " << std::left << std::setw(16) << stageName(static_cast<Stage>(s)) << std::right << std::setw(10) << merged.count()
+                     << std::setw(10) << toMicroseconds(merged.valueAtPercentile(50.0)) << std::setw(10) << toMicroseconds(merged.valueAtPercentile(99.0))
+                     << std::setw(10) << toMicroseconds(merged.valueAtPercentile(99.9)) << std::setw(10) << toMicroseconds(merged.maximum()) << std::endl;
+            }
+        } catch (...) {}
+        return sstr.str();
+    }
+
+    /**
+     * Publishes one opendlv.system.SignalStatusMessage per stage with at least
+     * one value: senderStamp is the stage, code is p99 in microseconds, and the
+     * description lists count and percentiles.
+     */
+    void publish(cluon::OD4Session &od4) const noexcept {
+        try {
+            for (uint8_t s{0}; s < NUMBER_OF_STAGES; s++) {
+                cluon::Histogram merged;
+                mergeInto(static_cast<Stage>(s), merged);
+                if (0 < merged.count()) {
+                    std::stringstream sstr;
+                    sstr << std::fixed << std::setprecision(1) << stageName(static_cast<Stage>(s)) << " n=" << merged.count()
+                         << " p50=" << toMicroseconds(merged.valueAtPercentile(50.0)) << "us p99=" << toMicroseconds(merged.valueAtPercentile(99.0))
+                         << "us p999=" << toMicroseconds(merged.valueAtPercentile(99.9)) << "us max=" << toMicroseconds(merged.maximum()) << "us";
+
+                    opendlv::system::SignalStatusMessage msg;
+                    msg.code(static_cast<int32_t>(merged.valueAtPercentile(99.0) / 1000));
+                    msg.description(sstr.str());
+                    od4.send(msg, cluon::time::now(), s);
+                }
+            }
+        } catch (...) {}
+    }
+
+   private:
+    enum : int64_t { MAX_PLAUSIBLE_AGE_IN_MICROSECONDS = 10 * 1000 * 1000 };
+
+    Probes() = default;
+
+    static double toMicroseconds(uint64_t nanoseconds) noexcept {
+        return static_cast<double>(nanoseconds) / 1000.0;
+    }
+
+    Histograms *local() noexcept {
+        // The histograms of a thread are kept after it ends so that reports still include them.
+        thread_local Histograms *histograms{nullptr};
+        if (nullptr == histograms) {
+            try {
+                std::lock_guard<std::mutex> lck(m_histogramsMutex);
+                m_histograms.emplace_back(new Histograms());
+                histograms = m_histograms.back().get();
+            } catch (...) {}
+        }
+        return histograms;
+    }
+
+    void mergeInto(Stage stage, cluon::Histogram &merged) const noexcept {
+        std::lock_guard<std::mutex> lck(m_histogramsMutex);
+        for (const auto &h : m_histograms) {
+            merged.merge(h->m_stages[stage]);
+        }
+    }
+
+   private:
+    mutable std::mutex m_histogramsMutex{};
+    std::vector<std::unique_ptr<Histograms>> m_histograms{};
+};
+
+/**
+ * Measures consecutive stages of one pass through the pipeline.
+ */
+class Stopwatch {
+   public:
+    Stopwatch() noexcept
+        : m_last{std::chrono::steady_clock::now()} {}
+
+    void restart() noexcept {
+        m_last = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * Records the time since the previous lap (or restart) for the given stage.
+     */
+    void lap(Stage stage) noexcept {
+        const auto NOW{std::chrono::steady_clock::now()};
+        Probes::instance().record(stage, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(NOW - m_last).count()));
+        m_last = NOW;
+    }
+
+   private:
+    std::chrono::steady_clock::time_point m_last;
+};
+
+// Set from the SIGUSR1 handler; the pipeline prints a report when it sees it.
+inline std::atomic<bool> &dumpRequest() noexcept {
+    static std::atomic<bool> requested{false};
+    return requested;
+}
+
+inline void onDumpSignal(int) {
+    dumpRequest().store(true);
+}
+
+inline void installDumpSignalHandler() noexcept {
+    // Initialize the flag here as the signal handler must not do it.
+    dumpRequest();
+#ifndef WIN32
+    std::signal(SIGUSR1, &onDumpSignal);
+#endif
+}
+
+/**
+ * @return true once after SIGUSR1 was received.
+ */
+inline bool dumpRequested() noexcept {
+    return dumpRequest().exchange(false);
+}
+
+} // namespace latency
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_OF_INTEREST_HPP
+#define REGION_OF_INTEREST_HPP
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The part of a frame that the pipeline looks at: only the rows and columns of
+// the region are copied out of the shared memory, and masked rectangles inside
+// the region (like the wires of the car) are metadata for later stages instead
+// of black pixels.
+namespace roi {
+
+class RegionOfInterest {
+   public:
+    /**
+     * Constructor; the region is the whole frame without masks.
+     */
+    RegionOfInterest(uint32_t width, uint32_t height) noexcept
+        : m_frame{0, 0, static_cast<int>(width), static_cast<int>(height)}
+        , m_region{m_frame} {
+        updateMask();
+    }
+
+    /**
+     * @return Region below the horizon with the wires of the car masked; the
+     *         rectangles are given for a 640x480 frame and scaled to the given frame.
+     */
+    static RegionOfInterest defaults(uint32_t width, uint32_t height) noexcept {
+        auto scaled = [width, height](int x, int y, int w, int h) {
+            const int W{static_cast<int>(width)};
+            const int H{static_cast<int>(height)};
+            return cv::Rect(x * W / 640, y * H / 480, w * W / 640, h * H / 480);
+        };
+        RegionOfInterest r{width, height};
+        r.region(scaled(0, 241, 640, 239));
+        r.addMask(scaled(160, 390, 336, 90));
+        return r;
+    }
+
+    /**
+     * This method sets the region; masks are kept as far as they overlap it.
+     *
+     * @param region Rectangle in frame coordinates; clipped to the frame.
+     * @return false if the region does not overlap the frame.
+     */
+    bool region(const cv::Rect &region) noexcept {
+        const cv::Rect CLIPPED{clip(region, m_frame)};
+        if ((0 >= CLIPPED.width) || (0 >= CLIPPED.height)) {
+            return false;
+        }
+        std::vector<cv::Rect> masks;
+        for (const auto &m : m_masks) {
+            masks.push_back(cv::Rect(m.x + m_region.x, m.y + m_region.y, m.width, m.height));
+        }
+        m_region = CLIPPED;
+        m_masks.clear();
+        for (const auto &m : masks) {
+            addMaskInternal(m);
+        }
+        updateMask();
+        return true;
+    }
+
+    /**
+     * This method excludes a rectangle of the region from processing.
+     *
+     * @param mask Rectangle in frame coordinates; parts outside the region are ignored.
+     */
+    void addMask(const cv::Rect &mask) noexcept {
+        addMaskInternal(mask);
+        updateMask();
+    }
+
+    /**
+     * This method reads "roi x y w h" and "mask x y w h" lines; '#' starts a comment.
+     *
+     * @return false if the file cannot be read or contains invalid lines.
+     */
+    bool load(const std::string &file) noexcept {
+        std::ifstream in(file);
+        if (!in.good()) {
+            std::cerr << "[roi] Cannot read '" << file << "'." << std::endl;
+            return false;
+        }
+        bool retVal{true};
+        std::string line;
+        uint32_t lineNumber{0};
+        while (std::getline(in, line)) {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            std::stringstream sstr(line);
+            std::string keyword;
+            if (!(sstr >> keyword)) {
+                continue;
+            }
+            cv::Rect r;
+            bool valid{(sstr >> r.x >> r.y >> r.width >> r.height) && (0 < r.width) && (0 < r.height)};
+            if (valid && ("roi" == keyword)) {
+                valid = region(r);
+            } else if (valid && ("mask" == keyword)) {
+                addMask(r);
+            } else {
+                valid = false;
+            }
+            if (!valid) {
+                std::cerr << "[roi] Invalid line " << lineNumber << " in '" << file << "': " << line << std::endl;
+                retVal = false;
+            }
+        }
+        return retVal;
+    }
+
+    /**
+     * This method parses a rectangle given as "x,y,w,h".
+     *
+     * @return false if the text is not a valid rectangle.
+     */
+    static bool parse(const std::string &text, cv::Rect &rect) noexcept {
+        std::string s{text};
+        std::replace(s.begin(), s.end(), ',', ' ');
+        std::stringstream sstr(s);
+        std::string rest;
+        return (sstr >> rect.x >> rect.y >> rect.width >> rect.height) && !(sstr >> rest) && (0 < rect.width) && (0 < rect.height);
+    }
+
+    /**
+     * This method copies the region of a BGRA frame row by row.
+     *
+     * @param frame Pixels of the whole frame.
+     * @return Copy of the region.
+     */
+    cv::Mat copy(const char *frame) const {
+        cv::Mat wrapped(m_frame.height, m_frame.width, CV_8UC4, const_cast<char *>(frame));
+        return cv::Mat(wrapped, m_region).clone();
+    }
+
+    /**
+     * This method copies the region of a BGRA frame into an image that is
+     * only (re)allocated if its size does not match.
+     *
+     * @param frame Pixels of the whole frame.
+     * @param image Copy of the region.
+     */
+    void copy(const char *frame, cv::Mat &image) const {
+        cv::Mat wrapped(m_frame.height, m_frame.width, CV_8UC4, const_cast<char *>(frame));
+        cv::Mat(wrapped, m_region).copyTo(image);
+    }
+
+    /**
+     * @return Region in frame coordinates.
+     */
+    const cv::Rect &region() const noexcept {
+        return m_region;
+    }
+
+    /**
+     * @return Masked rectangles in coordinates of the region.
+     */
+    const std::vector<cv::Rect> &masks() const noexcept {
+        return m_masks;
+    }
+
+    /**
+     * @return Single-channel image of the region's size: 0 for masked pixels, 255 otherwise.
+     */
+    const cv::Mat &mask() const noexcept {
+        return m_mask;
+    }
+
+    /**
+     * @return Number of bytes copied per BGRA frame.
+     */
+    std::size_t bytesPerFrame() const noexcept {
+        return static_cast<std::size_t>(m_region.width) * static_cast<std::size_t>(m_region.height) * 4;
+    }
+
+    std::string toString() const noexcept {
+        std::stringstream sstr;
+        sstr << "region " << m_region.x << "," << m_region.y << "," << m_region.width << "," << m_region.height << " (" << bytesPerFrame() << " of "
+             << static_cast<std::size_t>(m_frame.width) * static_cast<std::size_t>(m_frame.height) * 4 << " bytes)";
+        for (const auto &m : m_masks) {
+            sstr << ", mask " << (m.x + m_region.x) << "," << (m.y + m_region.y) << "," << m.width << "," << m.height;
+        }
+        return sstr.str();
+    }
+
+   private:
+    static cv::Rect clip(const cv::Rect &r, const cv::Rect &bounds) noexcept {
+        const int X0{std::max(r.x, bounds.x)};
+        const int Y0{std::max(r.y, bounds.y)};
+        const int X1{std::min(r.x + r.width, bounds.x + bounds.width)};
+        const int Y1{std::min(r.y + r.height, bounds.y + bounds.height)};
+        return cv::Rect(X0, Y0, std::max(0, X1 - X0), std::max(0, Y1 - Y0));
+    }
+
+    void addMaskInternal(const cv::Rect &mask) noexcept {
+        const cv::Rect CLIPPED{clip(mask, m_region)};
+        if ((0 < CLIPPED.width) && (0 < CLIPPED.height)) {
+            m_masks.push_back(cv::Rect(CLIPPED.x - m_region.x, CLIPPED.y - m_region.y, CLIPPED.width, CLIPPED.height));
+        }
+    }
+
+    void updateMask() noexcept {
+        try {
+            m_mask = cv::Mat(m_region.height, m_region.width, CV_8UC1, cv::Scalar(255));
+            for (const auto &m : m_masks) {
+                cv::Mat(m_mask, m).setTo(cv::Scalar(0));
+            }
+        } catch (...) {}
+    }
+
+   private:
+    cv::Rect m_frame;
+    cv::Rect m_region;
+    std::vector<cv::Rect> m_masks{};
+    cv::Mat m_mask{};
+};
+
+} // namespace roi
+
+#endif
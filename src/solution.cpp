@@ -20,6 +20,26 @@
 // Include the OpenDLV Standard Message Set that contains messages that are usually exchanged for automotive or robotic applications 
 // #include "opendlv-standard-message-set.hpp"
 #include "opendlv-standard-message-set.hpp"
+// Per-stage latency histograms, printed on SIGUSR1 and at exit
+#include "latency-probes.hpp"
+// Part of the frame to copy and process, with masked rectangles
+#include "region-of-interest.hpp"
+// Blue and yellow cone masks in one pass over the frame
+#include "cone-segmentation.hpp"
+// Persistent threads running the vision stages over bands of rows
+#include "tile-pool.hpp"
+// Queues between the capture, vision, and committing threads
+#include "frame-pipeline.hpp"
+// Annotated frames written to disk or streamed without a display
+#include "frame-export.hpp"
+// Half, quarter, and eighth resolution versions of the frame for the vision stages
+#include "image-pyramid.hpp"
+// Blobs of the cone masks and their direction and distance
+#include "cone-detection.hpp"
+// Cone tracks with stable ids and windows to search around them
+#include "cone-tracking.hpp"
+// Steering fused from the sensor readings and the cones
+#include "steering-estimator.hpp"
 
 // Include the GUI and image processing header files from OpenCV
 #include <opencv2/highgui/highgui.hpp>
@@ -30,6 +50,10 @@
 #include <stdexcept>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 
 int32_t main(int32_t argc, char **argv) {
@@ -43,11 +67,31 @@ int32_t main(int32_t argc, char **argv) {
          (0 == commandlineArguments.count("width")) ||
          (0 == commandlineArguments.count("height")) ) {
         std::cerr << argv[0] << " attaches to a shared memory area containing an ARGB image." << std::endl;
-        std::cerr << "Usage:   " << argv[0] << " --cid=<OD4 session> --name=<name of shared memory area> [--verbose]" << std::endl;
-        std::cerr << "         --cid:    CID of the OD4Session to send and receive messages" << std::endl;
-        std::cerr << "         --name:   name of the shared memory area to attach" << std::endl;
-        std::cerr << "         --width:  width of the frame" << std::endl;
-        std::cerr << "         --height: height of the frame" << std::endl;
+        std::cerr << "Usage:   " << argv[0] << " --cid=<OD4 session> --name=<name of shared memory area> [--verbose] [--lockstep] [--publishlatency=<ms>] [--roi=x,y,w,h] [--mask=x,y,w,h[;x,y,w,h...]] [--roifile=<file>] [--blue=h,s,v,h,s,v] [--yellow=h,s,v,h,s,v] [--level=<n>] [--minarea=<pixels>] [--camera=<degrees>,<m>] [--fullscan=<n>] [--estimator=formula|fused] [--threads=<n>] [--visionworkers=<n>] [--queue=<frames>] [--drop=oldest|newest] [--fps=<n>] [--export=<target>] [--exportkeep=<n>]" << std::endl;
+        std::cerr << "         --cid:      CID of the OD4Session to send and receive messages" << std::endl;
+        std::cerr << "         --name:     name of the shared memory area to attach" << std::endl;
+        std::cerr << "         --width:    width of the frame" << std::endl;
+        std::cerr << "         --height:   height of the frame" << std::endl;
+        std::cerr << "         --lockstep: acknowledge every processed frame to a cluon-replay running with --lockstep" << std::endl;
+        std::cerr << "         --publishlatency: send the per-stage latencies as opendlv.system.SignalStatusMessage every <ms> milliseconds" << std::endl;
+        std::cerr << "         --roi:      region of the frame to copy and process (default: below the horizon, 0,241,640,239)" << std::endl;
+        std::cerr << "         --mask:     rectangles inside the region to ignore (default: wires of the car, 160,390,336,90)" << std::endl;
+        std::cerr << "         --roifile:  file with lines 'roi x y w h' and 'mask x y w h' instead of --roi and --mask" << std::endl;
+        std::cerr << "         --blue:     lower and upper HSV bounds of the blue cones (hue 0..180; default: 100,80,30,130,255,255)" << std::endl;
+        std::cerr << "         --yellow:   lower and upper HSV bounds of the yellow cones (hue 0..180; default: 15,80,80,35,255,255)" << std::endl;
+        std::cerr << "         --level:    resolution of the cone segmentation: 0 full, 1 half, 2 quarter, 3 eighth (default: 1)" << std::endl;
+        std::cerr << "         --minarea:  smallest cone in pixels of the full frame; smaller blobs are noise (default: 32)" << std::endl;
+        std::cerr << "         --camera:   horizontal field of view in degrees and mounting height in meters to place the cones (default: 62.2,0.1)" << std::endl;
+        std::cerr << "         --fullscan: scan every n-th frame completely and in between only around the tracked cones; 1 scans every frame (default: 10)" << std::endl;
+        std::cerr << "         --estimator: formula: steering from the angular velocity; fused: Kalman filters over all sensor readings and the cones (default: formula)" << std::endl;
+        std::cerr << "         --threads:  number of threads for the vision stages (default: one per core)" << std::endl;
+        std::cerr << "         --visionworkers: number of frames processed at the same time; the threads are shared among them (default: 1)" << std::endl;
+        std::cerr << "         --queue:    number of frames waiting for a vision worker before new frames are dropped; dropped frames get a steering but no cones (default: 2)" << std::endl;
+        std::cerr << "         --drop:     oldest: workers skip waiting frames for the newest one; newest: only full queues drop frames (default: oldest)" << std::endl;
+        std::cerr << "         --fps:      maximum number of frames per second shown with --verbose or exported; frames in between are skipped (default: 10)" << std::endl;
+        std::cerr << "         --export:   write the annotated frames without a display: mjpeg:<file>, png:<directory>, or tcp:<port> for an HTTP MJPEG stream" << std::endl;
+        std::cerr << "         --exportkeep: number of frames per MJPEG file (the previous file is kept as <file>.1) or number of PNG images to keep (default: 1000)" << std::endl;
+        std::cerr << "         Per-stage latencies are printed to stderr on SIGUSR1 and at exit." << std::endl;
         std::cerr << "Example: " << argv[0] << " --cid=253 --name=img --width=640 --height=480 --verbose" << std::endl;
     }
     else {
@@ -56,6 +100,115 @@ int32_t main(int32_t argc, char **argv) {
         const uint32_t WIDTH{static_cast<uint32_t>(std::stoi(commandlineArguments["width"]))};
         const uint32_t HEIGHT{static_cast<uint32_t>(std::stoi(commandlineArguments["height"]))};
         const bool VERBOSE{commandlineArguments.count("verbose") != 0};
+        const uint32_t FPS{(commandlineArguments.count("fps") != 0) ? static_cast<uint32_t>(std::max(1, std::stoi(commandlineArguments["fps"]))) : 10};
+        const bool LOCKSTEP{commandlineArguments.count("lockstep") != 0};
+        const std::chrono::milliseconds PUBLISH_LATENCY{(commandlineArguments.count("publishlatency") != 0) ? std::stoi(commandlineArguments["publishlatency"]) : 0};
+        latency::installDumpSignalHandler();
+
+        // Only the region of interest is copied out of the shared memory; masks are passed on as metadata.
+        roi::RegionOfInterest regionOfInterest{roi::RegionOfInterest::defaults(WIDTH, HEIGHT)};
+        if (0 != commandlineArguments.count("roifile")) {
+            regionOfInterest = roi::RegionOfInterest{WIDTH, HEIGHT};
+            if (!regionOfInterest.load(commandlineArguments["roifile"])) {
+                return retCode;
+            }
+        } else if ((0 != commandlineArguments.count("roi")) || (0 != commandlineArguments.count("mask"))) {
+            // Each option only replaces its own default: --roi keeps the wires masked, --mask keeps the region below the horizon.
+            if (0 != commandlineArguments.count("mask")) {
+                const cv::Rect DEFAULT_REGION{regionOfInterest.region()};
+                regionOfInterest = roi::RegionOfInterest{WIDTH, HEIGHT};
+                regionOfInterest.region(DEFAULT_REGION);
+            }
+            cv::Rect r;
+            if ((0 != commandlineArguments.count("roi")) && !(roi::RegionOfInterest::parse(commandlineArguments["roi"], r) && regionOfInterest.region(r))) {
+                std::cerr << argv[0] << ": invalid --roi=" << commandlineArguments["roi"] << std::endl;
+                return retCode;
+            }
+            std::stringstream masks(commandlineArguments["mask"]);
+            std::string mask;
+            while (std::getline(masks, mask, ';')) {
+                if (!roi::RegionOfInterest::parse(mask, r)) {
+                    std::cerr << argv[0] << ": invalid --mask=" << mask << std::endl;
+                    return retCode;
+                }
+                regionOfInterest.addMask(r);
+            }
+        }
+        std::clog << argv[0] << ": Processing " << regionOfInterest.toString() << "." << std::endl;
+
+        cones::HsvRange blueRange{cones::ConeSegmentation::blueDefaults()};
+        cones::HsvRange yellowRange{cones::ConeSegmentation::yellowDefaults()};
+        if ((0 != commandlineArguments.count("blue")) && !cones::HsvRange::parse(commandlineArguments["blue"], blueRange)) {
+            std::cerr << argv[0] << ": invalid --blue=" << commandlineArguments["blue"] << std::endl;
+            return retCode;
+        }
+        if ((0 != commandlineArguments.count("yellow")) && !cones::HsvRange::parse(commandlineArguments["yellow"], yellowRange)) {
+            std::cerr << argv[0] << ": invalid --yellow=" << commandlineArguments["yellow"] << std::endl;
+            return retCode;
+        }
+        const cones::ConeSegmentation coneSegmentation{blueRange, yellowRange};
+
+        // The cones are large enough to be found with a fraction of the pixels.
+        const uint32_t LEVEL{(commandlineArguments.count("level") != 0) ? static_cast<uint32_t>(std::stoi(commandlineArguments["level"])) : 1};
+        if (pyramid::ImagePyramid::LEVELS <= LEVEL) {
+            std::cerr << argv[0] << ": invalid --level=" << commandlineArguments["level"] << std::endl;
+            return retCode;
+        }
+        const cv::Size SEGMENTATION_SIZE{pyramid::ImagePyramid::size(regionOfInterest.region().size(), LEVEL)};
+        cv::Mat segmentationMask{regionOfInterest.mask()};
+        if ((0 < LEVEL) && !segmentationMask.empty()) {
+            cv::resize(regionOfInterest.mask(), segmentationMask, SEGMENTATION_SIZE, 0, 0, cv::INTER_NEAREST);
+        }
+        std::clog << argv[0] << ": Segmenting cones at " << SEGMENTATION_SIZE.width << "x" << SEGMENTATION_SIZE.height << " with " << coneSegmentation.toString() << "." << std::endl;
+
+        // Every pixel of a level covers 4^LEVEL pixels of the frame.
+        const uint32_t MIN_AREA{(commandlineArguments.count("minarea") != 0) ? static_cast<uint32_t>(std::max(1, std::stoi(commandlineArguments["minarea"]))) : 32};
+        const uint32_t MIN_AREA_AT_LEVEL{std::max(1u, MIN_AREA >> (2 * LEVEL))};
+        const float SCALE{static_cast<float>(1u << LEVEL)};
+        detection::Camera camera{WIDTH, HEIGHT, 62.2f, 0.1f};
+        if ((0 != commandlineArguments.count("camera")) && !detection::Camera::parse(commandlineArguments["camera"], WIDTH, HEIGHT, camera)) {
+            std::cerr << argv[0] << ": invalid --camera=" << commandlineArguments["camera"] << std::endl;
+            return retCode;
+        }
+        std::clog << argv[0] << ": Detecting cones of at least " << MIN_AREA << " pixels with a camera of " << camera.toString() << "." << std::endl;
+        const uint32_t FULL_SCAN_INTERVAL{(commandlineArguments.count("fullscan") != 0) ? static_cast<uint32_t>(std::max(1, std::stoi(commandlineArguments["fullscan"]))) : 10};
+        // A cone missing in two frames in a row has left the view.
+        tracking::ConeTracker coneTracker{FULL_SCAN_INTERVAL, 2};
+
+        const std::string ESTIMATOR{(commandlineArguments.count("estimator") != 0) ? commandlineArguments["estimator"] : "formula"};
+        if (("formula" != ESTIMATOR) && ("fused" != ESTIMATOR)) {
+            std::cerr << argv[0] << ": invalid --estimator=" << ESTIMATOR << std::endl;
+            return retCode;
+        }
+        const bool FUSED{"fused" == ESTIMATOR};
+        std::clog << argv[0] << ": Estimating the steering with the " << ESTIMATOR << " estimator." << std::endl;
+
+        const uint32_t THREADS{(commandlineArguments.count("threads") != 0) ? static_cast<uint32_t>(std::stoi(commandlineArguments["threads"])) : std::thread::hardware_concurrency()};
+        const uint32_t VISION_WORKERS{(commandlineArguments.count("visionworkers") != 0) ? static_cast<uint32_t>(std::max(1, std::stoi(commandlineArguments["visionworkers"]))) : 1};
+        const uint32_t THREADS_PER_WORKER{std::max(1u, THREADS / VISION_WORKERS)};
+        const uint32_t QUEUE_LENGTH{(commandlineArguments.count("queue") != 0) ? static_cast<uint32_t>(std::max(1, std::stoi(commandlineArguments["queue"]))) : 2};
+        pipeline::DropPolicy dropPolicy{pipeline::DROP_OLDEST};
+        if ((0 != commandlineArguments.count("drop")) && !pipeline::parse(commandlineArguments["drop"], dropPolicy)) {
+            std::cerr << argv[0] << ": invalid --drop=" << commandlineArguments["drop"] << std::endl;
+            return retCode;
+        }
+        // Frames dropped at capture while the committing thread waits for a vision worker; a second at 30 fps.
+        const uint32_t MAX_SKIPPED_FRAMES{32};
+        // 16 rows of 640 BGRA pixels and their masks (50 KB) stay in the L2 cache between the stages.
+        const int BAND_HEIGHT{16};
+        std::clog << argv[0] << ": Running " << VISION_WORKERS << " vision worker(s) on " << THREADS_PER_WORKER << " thread(s) each, " << QUEUE_LENGTH
+                  << " frame(s) queued, dropping the " << ((pipeline::DROP_OLDEST == dropPolicy) ? "oldest" : "newest") << " frames." << std::endl;
+
+        std::unique_ptr<headless::FrameExport> frameExport;
+        if (0 != commandlineArguments.count("export")) {
+            const uint32_t KEEP{(commandlineArguments.count("exportkeep") != 0) ? static_cast<uint32_t>(std::max(1, std::stoi(commandlineArguments["exportkeep"]))) : 1000};
+            frameExport.reset(new headless::FrameExport{commandlineArguments["export"], KEEP});
+            if (!frameExport->valid()) {
+                return retCode;
+            }
+            std::clog << argv[0] << ": Exporting the annotated frames as " << frameExport->toString() << "." << std::endl;
+        }
+        const bool ANNOTATE{VERBOSE || (nullptr != frameExport)};
 
         // Attach to the shared memory.
         std::unique_ptr<cluon::SharedMemory> sharedMemory{new cluon::SharedMemory{NAME}};
@@ -77,96 +230,422 @@ int32_t main(int32_t argc, char **argv) {
                 gsr = cluon::extractMessage<opendlv::proxy::GroundSteeringRequest>(std::move(env));
             };
 
-            auto onAngularVelocityReading = [&avr, &avrMutex](cluon::data::Envelope &&env) {
+            // The fused estimator is updated with every reading as it arrives, at its sample time.
+            estimation::SteeringEstimator steeringEstimator;
+            auto seconds = [](const cluon::data::Envelope &env) { return static_cast<double>(cluon::time::toMicroseconds(env.sampleTimeStamp())) * 1e-6; };
+
+            auto onAngularVelocityReading = [&avr, &avrMutex, &steeringEstimator, seconds, FUSED](cluon::data::Envelope &&env) {
+                const double T{seconds(env)};
                 std::lock_guard<std::mutex> lck(avrMutex);
                 avr = cluon::extractMessage<opendlv::proxy::AngularVelocityReading>(std::move(env));
+                if (FUSED) {
+                    steeringEstimator.angularVelocity(T, avr.angularVelocityZ());
+                }
             };
 
             
             od4.dataTrigger(opendlv::proxy::GroundSteeringRequest::ID(), onGroundSteeringRequest);
             od4.dataTrigger(opendlv::proxy::AngularVelocityReading::ID(), onAngularVelocityReading);
+            if (FUSED) {
+                od4.dataTrigger(opendlv::proxy::AccelerationReading::ID(), [&steeringEstimator, seconds](cluon::data::Envelope &&env) {
+                    const double T{seconds(env)};
+                    const auto MSG{cluon::extractMessage<opendlv::proxy::AccelerationReading>(std::move(env))};
+                    steeringEstimator.acceleration(T, MSG.accelerationX(), MSG.accelerationY(), MSG.accelerationZ());
+                });
+                od4.dataTrigger(opendlv::proxy::MagneticFieldReading::ID(), [&steeringEstimator, seconds](cluon::data::Envelope &&env) {
+                    const double T{seconds(env)};
+                    const auto MSG{cluon::extractMessage<opendlv::proxy::MagneticFieldReading>(std::move(env))};
+                    steeringEstimator.magneticField(T, MSG.magneticFieldX(), MSG.magneticFieldY(), MSG.magneticFieldZ());
+                });
+                od4.dataTrigger(opendlv::proxy::GroundSpeedReading::ID(), [&steeringEstimator, seconds](cluon::data::Envelope &&env) {
+                    const double T{seconds(env)};
+                    steeringEstimator.groundSpeed(T, cluon::extractMessage<opendlv::proxy::GroundSpeedReading>(std::move(env)).groundSpeed());
+                });
+                od4.dataTrigger(opendlv::proxy::PedalPositionReading::ID(), [&steeringEstimator, seconds](cluon::data::Envelope &&env) {
+                    const double T{seconds(env)};
+                    steeringEstimator.pedalPosition(T, cluon::extractMessage<opendlv::proxy::PedalPositionReading>(std::move(env)).position());
+                });
+            }
 
 
-            // Endless loop; end the program by pressing Ctrl-C.
-            while (od4.isRunning()) {
-                // OpenCV data structure to hold an image.
-                cv::Mat img;
-                double angVelZ = 0.0;
-                std::cout << "group_02;";
-                // Wait for a notification of a new frame.
-                sharedMemory->wait();
+            // One frame on its way through the pipeline; committed frames are recycled to reuse their images.
+            struct Frame {
+                uint64_t sequence{0};
+                uint64_t handedOut{0}; // Frames handed to the vision workers before this one.
+                bool dropped{false};   // No vision results; the steering is still committed.
+                bool fullScan{true};
+                std::chrono::steady_clock::time_point wakeup{};
+                cluon::data::TimeStamp timeStamp{};
+                double angVelZ{0.0};
+                float groundSteering{0.0f};
+                cv::Mat img{};
+                // At the resolution of the segmentation level.
+                cv::Mat blueCones{};
+                cv::Mat yellowCones{};
+                std::vector<detection::Blob> blueBlobs{};
+                std::vector<detection::Blob> yellowBlobs{};
 
-                // Lock the shared memory.
-                sharedMemory->lock();
-                {
-                    // Copy the pixels from the shared memory into our own data structure.
-                    cv::Mat wrapped(HEIGHT, WIDTH, CV_8UC4, sharedMemory->data());
-                    img = wrapped.clone();
+                // Results shown with --verbose or exported.
+                float calculatedSteering{0.0f};
+                float dGroundSteering{0.0f};
+                bool calculatedWithinInterval{false};
+                float correctPercentage{0.0f};
+            };
+
+            // The capture thread hands the frames to the vision workers in turn; every worker passes on
+            // each of its frames, processed or dropped, so that taking them from the workers in the same
+            // turn commits them in the order of their sequence numbers. Frames dropped at capture bypass the
+            // workers and are committed once the frames handed out before them are.
+            std::vector<std::unique_ptr<pipeline::SpscQueue<Frame>>> captured, processed;
+            for (uint32_t i{0}; i < VISION_WORKERS; i++) {
+                captured.emplace_back(new pipeline::SpscQueue<Frame>{QUEUE_LENGTH});
+                processed.emplace_back(new pipeline::SpscQueue<Frame>{QUEUE_LENGTH + 1});
+            }
+            pipeline::SpscQueue<Frame> skipped{MAX_SKIPPED_FRAMES};
+            pipeline::SpscQueue<Frame> recycled{VISION_WORKERS * (2 * QUEUE_LENGTH + 1) + 2};
+            std::atomic<bool> running{true};
+            std::atomic<uint64_t> captureDrops{0}, visionDrops{0};
+
+            std::thread capture([&]() {
+                latency::Stopwatch stopwatch;
+                uint64_t sequence{0};
+                uint64_t handedOut{0};
+                uint32_t next{0};
+                Frame frame, skippedFrame;
+                while (running.load() && od4.isRunning()) {
+                    // Wait for a notification of a new frame.
+                    stopwatch.restart();
+                    sharedMemory->wait();
+                    stopwatch.lap(latency::WAIT);
+                    stopwatch.restart();
+                    frame.wakeup = std::chrono::steady_clock::now();
+                    const cluon::data::TimeStamp WAKEUP{cluon::time::now()};
 
-                    angVelZ = avr.angularVelocityZ();
+                    // Lock the shared memory for reading; other readers are not blocked.
+                    // With several slots, copy again if the producer overwrote the frame meanwhile.
+                    for (int attempt{0}; attempt < 3; attempt++) {
+                        sharedMemory->lockShared();
+                        if (0 == attempt) {
+                            stopwatch.lap(latency::LOCK);
+                        }
 
-                    std::cout << cluon::time::toMicroseconds(sharedMemory->getTimeStamp().second) << ";";
+                        // Copy the pixels of the region of interest from the shared memory into our own data structure.
+                        regionOfInterest.copy(sharedMemory->data(), frame.img);
+                        frame.timeStamp = sharedMemory->getTimeStamp().second;
 
-                    
+                        if (sharedMemory->unlockShared()) {
+                            break;
+                        }
+                    }
+                    stopwatch.lap(latency::COPY);
+                    {
+                        std::lock_guard<std::mutex> lck(avrMutex);
+                        frame.angVelZ = avr.angularVelocityZ();
+                    }
+                    {
+                        std::lock_guard<std::mutex> lck(gsrMutex);
+                        frame.groundSteering = gsr.groundSteering();
+                    }
+                    latency::Probes::instance().recordSince(latency::FRAME_AGE, frame.timeStamp, WAKEUP);
+
+                    frame.sequence  = ++sequence;
+                    frame.handedOut = handedOut;
+                    frame.dropped   = false;
+                    if (captured[next]->push(frame)) {
+                        next = (next + 1) % VISION_WORKERS;
+                        handedOut++;
+                        recycled.pop(frame);
+                    } else {
+                        // The worker is behind: only the steering is committed for the new frame, and its images are reused for the next one.
+                        captureDrops++;
+                        skippedFrame.sequence       = frame.sequence;
+                        skippedFrame.handedOut      = handedOut;
+                        skippedFrame.dropped        = true;
+                        skippedFrame.wakeup         = frame.wakeup;
+                        skippedFrame.timeStamp      = frame.timeStamp;
+                        skippedFrame.angVelZ        = frame.angVelZ;
+                        skippedFrame.groundSteering = frame.groundSteering;
+                        while (!skipped.push(skippedFrame) && running.load()) {
+                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                        }
+                    }
                 }
-                
-                sharedMemory->unlock();
+            });
 
-                float groundSteering;
-                {
-                    std::lock_guard<std::mutex> lck(gsrMutex);
-                    groundSteering = gsr.groundSteering();
-                
+            auto vision = [&](uint32_t worker) {
+                tiles::TilePool tilePool{THREADS_PER_WORKER};
+                pyramid::ImagePyramid imagePyramid;
+                detection::BlobLabeling blobLabeling{MIN_AREA_AT_LEVEL};
+                std::vector<cv::Rect> windows;
+                std::vector<detection::Blob> blobs;
+                latency::Stopwatch stopwatch;
+                Frame frame;
+                const cv::Mat *image{nullptr};
+
+                // Stages run per band of rows so that each stage finds the rows of the previous one in the cache.
+                const tiles::TilePool::Stages visionStages{[&](int firstRow, int lastRow, uint32_t) {
+                    // Masked pixels of the region of interest are cleared while segmenting.
+                    coneSegmentation.apply(*image, segmentationMask, frame.blueCones, frame.yellowCones, firstRow, lastRow);
+                }};
+
+                while (running.load()) {
+                    if (!captured[worker]->pop(frame, std::chrono::milliseconds(100))) {
+                        continue;
+                    }
+                    if ((pipeline::DROP_OLDEST == dropPolicy) && (0 < captured[worker]->size())) {
+                        // A newer frame is waiting: skip this one but pass it on to keep the order.
+                        frame.dropped = true;
+                        visionDrops++;
+                    } else {
+                        stopwatch.restart();
+                        imagePyramid.reset(frame.img);
+                        image = &imagePyramid.level(LEVEL);
+                        frame.blueCones.create(image->rows, image->cols, CV_8UC1);
+                        frame.yellowCones.create(image->rows, image->cols, CV_8UC1);
+                        frame.fullScan = !coneTracker.searchWindows(frame.sequence, image->size(), windows);
+                        if (frame.fullScan) {
+                            tilePool.run(image->rows, BAND_HEIGHT, visionStages);
+                        } else {
+                            // Only the windows around the tracked cones are segmented; nothing is found elsewhere.
+                            frame.blueCones.setTo(cv::Scalar(0));
+                            frame.yellowCones.setTo(cv::Scalar(0));
+                            for (const auto &window : windows) {
+                                coneSegmentation.apply(*image, segmentationMask, frame.blueCones, frame.yellowCones, window);
+                            }
+                        }
+                        stopwatch.lap(latency::MASK);
+                        stopwatch.restart();
+                        if (frame.fullScan) {
+                            blobLabeling.detect(frame.blueCones, frame.blueBlobs);
+                            blobLabeling.detect(frame.yellowCones, frame.yellowBlobs);
+                        } else {
+                            frame.blueBlobs.clear();
+                            frame.yellowBlobs.clear();
+                            for (const auto &window : windows) {
+                                blobLabeling.detect(frame.blueCones, window, blobs);
+                                frame.blueBlobs.insert(frame.blueBlobs.end(), blobs.begin(), blobs.end());
+                                blobLabeling.detect(frame.yellowCones, window, blobs);
+                                frame.yellowBlobs.insert(frame.yellowBlobs.end(), blobs.begin(), blobs.end());
+                            }
+                        }
+                        stopwatch.lap(latency::DETECT);
+                    }
+                    // Wait for the committing thread instead of dropping the frame as it holds a place in the order.
+                    while (!processed[worker]->push(frame) && running.load()) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
                 }
+            };
+            std::vector<std::thread> visionWorkers;
+            for (uint32_t i{0}; i < VISION_WORKERS; i++) {
+                visionWorkers.emplace_back(std::thread(vision, i));
+            }
 
-                // Blacking out the horizon and wires of the car
-                cv::rectangle(img, cv::Point(0, 0), cv::Point(640, 0.5 * 480), cv::Scalar(0, 0, 0), cv::FILLED);
-                cv::rectangle(img, cv::Point(160, 390), cv::Point(495, 479), cv::Scalar(0, 0, 0), cv::FILLED);
+            // With --verbose or --export, a thread of its own draws the latest frame at most FPS times per
+            // second so that drawing, waitKey(), and encoding do not delay the frames.
+            pipeline::Mailbox<Frame> visualized;
+            uint64_t visualizationSkips{0};
+            std::thread visualization;
+            if (ANNOTATE) {
+                visualization = std::thread([&]() {
+                    const std::chrono::microseconds PERIOD{1000 * 1000 / FPS};
+                    Frame frame;
+                    cv::Mat blueCones, yellowCones;
+                    while (running.load()) {
+                        if (!visualized.take(frame, std::chrono::milliseconds(100))) {
+                            continue;
+                        }
+                        const auto RENDERED{std::chrono::steady_clock::now()};
+                        // Paint the segmented cones to tune their ranges; the masks are scaled up to the frame.
+                        if (frame.blueCones.size() == frame.img.size()) {
+                            frame.img.setTo(cv::Scalar(255, 0, 0, 255), frame.blueCones);
+                            frame.img.setTo(cv::Scalar(0, 255, 255, 255), frame.yellowCones);
+                        } else if (!frame.blueCones.empty()) {
+                            cv::resize(frame.blueCones, blueCones, frame.img.size(), 0, 0, cv::INTER_NEAREST);
+                            cv::resize(frame.yellowCones, yellowCones, frame.img.size(), 0, 0, cv::INTER_NEAREST);
+                            frame.img.setTo(cv::Scalar(255, 0, 0, 255), blueCones);
+                            frame.img.setTo(cv::Scalar(0, 255, 255, 255), yellowCones);
+                        }
 
-                
-                float calculatedSteering;                
-                
-                if(angVelZ <= 0) {
-                    if(angVelZ<-78) angVelZ = -78;
-
-                    calculatedSteering = (angVelZ - (-78)) / 78 * 0.3 - 0.3;
-                }else if(angVelZ > 0) {
-                    if(angVelZ < 2) 
-                        angVelZ = 1;
-                    calculatedSteering = ((angVelZ - 1)/100)*0.3; 
+                        // Outline the detected cones.
+                        for (const auto *blobs : {&frame.blueBlobs, &frame.yellowBlobs}) {
+                            for (const auto &blob : *blobs) {
+                                const cv::Rect &b = blob.box;
+                                cv::rectangle(frame.img, cv::Rect(static_cast<int>(static_cast<float>(b.x) * SCALE), static_cast<int>(static_cast<float>(b.y) * SCALE),
+                                                                  static_cast<int>(static_cast<float>(b.width) * SCALE), static_cast<int>(static_cast<float>(b.height) * SCALE)),
+                                              cv::Scalar(255, 255, 255), 1);
+                            }
+                        }
+
+                        // Outline the masked rectangles of the region of interest.
+                        for (const auto &mask : regionOfInterest.masks()) {
+                            cv::rectangle(frame.img, mask, cv::Scalar(0, 0, 255), 1);
+                        }
+
+                        // Define the positions for the text
+                        cv::Point angularVelocityPos(10, 30);
+                        cv::Point frameReportPos(10, 70);
+
+                        // Define the font size
+                        double fontSize = 0.6;
+
+                        // Print the angular velocity information
+                        std::string angularVelocityText = "Angular Velocity: " + std::to_string(frame.angVelZ);
+                        cv::putText(frame.img, angularVelocityText, angularVelocityPos, cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+
+                        // Print the frame report information
+                        cv::putText(frame.img, "----------- FRAME REPORT -----------", frameReportPos, cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+                        cv::putText(frame.img, "[GS] Got " + std::to_string(frame.groundSteering) + ". Allowed [" + std::to_string(frame.groundSteering - frame.dGroundSteering) + "," + std::to_string(frame.groundSteering + frame.dGroundSteering) + "]", cv::Point(frameReportPos.x, frameReportPos.y + 30), cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+                        cv::putText(frame.img, "[CS] Got " + std::to_string(frame.calculatedSteering) + ". " + (frame.calculatedWithinInterval ? "[SUCCESS]" : "[FAILURE]"), cv::Point(frameReportPos.x, frameReportPos.y + 60), cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+
+                        cv::putText(frame.img, "[RESULT] Correctly calculated " + std::to_string(frame.correctPercentage) + "% frames", cv::Point(frameReportPos.x, frameReportPos.y + 90), cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+
+                        if (VERBOSE) {
+                            cv::imshow(sharedMemory->name().c_str(), frame.img);
+                            cv::waitKey(1);
+                        }
+                        if (frameExport) {
+                            frameExport->write(frame.img);
+                        }
+
+                        std::this_thread::sleep_until(RENDERED + PERIOD);
+                    }
+                });
+            }
+
+            // This thread commits the frames in order: steering and output.
+            auto lastLatencyPublished{std::chrono::steady_clock::now()};
+            latency::Stopwatch stopwatch;
+            uint64_t committed{0};
+            uint64_t fullScans{0}, windowedScans{0};
+            // The messages about the cones of a frame leave together with one system call.
+            cluon::SendBatch coneMessages{od4};
+            Frame frame, nextProcessed, nextSkipped;
+            bool processedPending{false}, skippedPending{false};
+            while (od4.isRunning()) {
+                // A frame dropped at capture waits until the frames handed to the vision workers before it are committed.
+                skippedPending = skippedPending || skipped.pop(nextSkipped);
+                if (!processedPending && !(skippedPending && (nextSkipped.handedOut <= committed))) {
+                    processedPending = processed[committed % VISION_WORKERS]->pop(nextProcessed, std::chrono::milliseconds(100));
+                    // Frames dropped before the one just taken were queued before it was handed out.
+                    skippedPending = skippedPending || skipped.pop(nextSkipped);
                 }
-                std::cout<< calculatedSteering << std::endl;
-                
+                const bool SKIPPED_AT_CAPTURE{skippedPending && (nextSkipped.handedOut <= committed)};
+                if (SKIPPED_AT_CAPTURE) {
+                    frame          = std::move(nextSkipped);
+                    skippedPending = false;
+                } else if (processedPending) {
+                    frame            = std::move(nextProcessed);
+                    processedPending = false;
+                    committed++;
+                } else {
+                    continue;
+                }
+                stopwatch.restart();
 
-                float dGroundSteering = groundSteering == 0 ? 0.05 : std::abs(0.3 * groundSteering);
-                bool calculatedWithinInterval = std::abs(groundSteering - calculatedSteering) <= dGroundSteering;
+                // Estimator: the steering from the angular velocity at the time of the frame, or fused from
+                // all readings up to now and predicted to the time of the frame.
+                double angVelZ = frame.angVelZ;
+                float groundSteering = frame.groundSteering;
+                const float calculatedSteering{FUSED ? steeringEstimator.steering(static_cast<double>(cluon::time::toMicroseconds(frame.timeStamp)) * 1e-6)
+                                                     : estimation::SteeringEstimator::fromAngularVelocity(angVelZ)};
+                std::cout << "group_02;" << cluon::time::toMicroseconds(frame.timeStamp) << ";" << calculatedSteering << std::endl;
+
+                // Tell the replay that this frame is done so that it can advance to the next one.
+                if (LOCKSTEP) {
+                    cluon::data::PlayerCommand frameProcessed;
+                    frameProcessed.command(cluon::data::PlayerCommand::LOCKSTEP_ACKNOWLEDGE);
+                    od4.send(frameProcessed);
+                }
+                stopwatch.lap(latency::STEERING);
+                latency::Probes::instance().record(latency::END_TO_END, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame.wakeup).count()));
+                latency::Probes::instance().recordSince(latency::FRAME_TO_OUTPUT, frame.timeStamp, cluon::time::now());
+
+                // Direction and distance of the cones seen in this frame, with the ids of their tracks; the
+                // distance is the one of the bottom of a cone on the ground. Dropped frames have no cones.
+                if (!frame.dropped) {
+                    coneTracker.update(frame.sequence, frame.blueBlobs, frame.yellowBlobs);
+                    (frame.fullScan ? fullScans : windowedScans)++;
+                    const cv::Rect &REGION = regionOfInterest.region();
+                    // Nearest blue and yellow cone, as distance and azimuth, for steering between them.
+                    float nearest[2][2]{{0.0f, 0.0f}, {0.0f, 0.0f}};
+                    for (const auto &track : coneTracker.tracks()) {
+                        if (0 < track.misses) {
+                            continue;
+                        }
+                        const float X{static_cast<float>(REGION.x) + (track.x + 0.5f) * SCALE - 0.5f};
+                        const float Y{static_cast<float>(REGION.y) + (track.y + 0.5f) * SCALE - 0.5f};
+                        const float BOTTOM{static_cast<float>(REGION.y) + static_cast<float>(track.box.y + track.box.height) * SCALE};
 
-                // Display image on your screen.
-                if (VERBOSE) {
-                    // Define the positions for the text
-                    cv::Point angularVelocityPos(10, 30);
-                    cv::Point frameReportPos(10, 70);
+                        opendlv::logic::perception::ObjectType objectType;
+                        objectType.objectId(track.id).type(track.type);
+                        coneMessages.add(objectType, frame.timeStamp);
+                        opendlv::logic::perception::ObjectDirection objectDirection;
+                        objectDirection.objectId(track.id).azimuthAngle(camera.azimuth(X)).zenithAngle(camera.zenith(Y));
+                        coneMessages.add(objectDirection, frame.timeStamp);
+                        opendlv::logic::perception::ObjectDistance objectDistance;
+                        objectDistance.objectId(track.id).distance(camera.distance(BOTTOM));
+                        coneMessages.add(objectDistance, frame.timeStamp);
 
-                    // Define the font size
-                    double fontSize = 0.6;
+                        float *n = nearest[(detection::BLUE_CONE == track.type) ? 0 : 1];
+                        if ((0.0f < objectDistance.distance()) && (!(0.0f < n[0]) || (objectDistance.distance() < n[0]))) {
+                            n[0] = objectDistance.distance();
+                            n[1] = objectDirection.azimuthAngle();
+                        }
+                    }
+                    coneMessages.flush();
+                    // Used from the next frame on, as this frame's steering is out already.
+                    if (FUSED && (0.0f < nearest[0][0]) && (0.0f < nearest[1][0])) {
+                        steeringEstimator.cones(static_cast<double>(cluon::time::toMicroseconds(frame.timeStamp)) * 1e-6, 0.5f * (nearest[0][1] + nearest[1][1]),
+                                                0.5f * (nearest[0][0] + nearest[1][0]));
+                    }
+                }
 
-                    // Print the angular velocity information
-                    std::string angularVelocityText = "Angular Velocity: " + std::to_string(angVelZ);
-                    cv::putText(img, angularVelocityText, angularVelocityPos, cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+                if (latency::dumpRequested()) {
+                    std::clog << latency::Probes::instance().report();
+                }
+                if ((0 < PUBLISH_LATENCY.count()) && ((std::chrono::steady_clock::now() - lastLatencyPublished) >= PUBLISH_LATENCY)) {
+                    latency::Probes::instance().publish(od4);
+                    lastLatencyPublished = std::chrono::steady_clock::now();
+                }
+                
 
-                    // Print the frame report information
-                    cv::putText(img, "----------- FRAME REPORT -----------", frameReportPos, cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
-                    cv::putText(img, "[GS] Got " + std::to_string(groundSteering) + ". Allowed [" + std::to_string(groundSteering - dGroundSteering) + "," + std::to_string(groundSteering + dGroundSteering) + "]", cv::Point(frameReportPos.x, frameReportPos.y + 30), cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
-                    cv::putText(img, "[CS] Got " + std::to_string(calculatedSteering) + ". " + (calculatedWithinInterval ? "[SUCCESS]" : "[FAILURE]"), cv::Point(frameReportPos.x, frameReportPos.y + 60), cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+                float dGroundSteering = groundSteering == 0 ? 0.05 : std::abs(0.3 * groundSteering);
+                bool calculatedWithinInterval = std::abs(groundSteering - calculatedSteering) <= dGroundSteering;
 
+                // Hand the frame to the visualization; the one it replaces is reused.
+                if (ANNOTATE) {
                     totalFrames++;
                     correctFrames += calculatedWithinInterval ? 1 : 0;
-                    cv::putText(img, "[RESULT] Correctly calculated " + std::to_string((float)(100 * correctFrames) / (float)totalFrames) + "% frames", cv::Point(frameReportPos.x, frameReportPos.y + 90), cv::FONT_HERSHEY_SIMPLEX, fontSize, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+                    frame.angVelZ                  = angVelZ;
+                    frame.calculatedSteering       = calculatedSteering;
+                    frame.dGroundSteering          = dGroundSteering;
+                    frame.calculatedWithinInterval = calculatedWithinInterval;
+                    frame.correctPercentage        = (float)(100 * correctFrames) / (float)totalFrames;
+                    if (!frame.dropped && visualized.post(frame)) {
+                        visualizationSkips++;
+                    }
+                }
 
-                    cv::imshow(sharedMemory->name().c_str(), img);
-                    cv::waitKey(1);
+                // Frames dropped at capture carry no images to reuse.
+                if (!SKIPPED_AT_CAPTURE) {
+                    recycled.push(frame);
                 }
             }
+
+            running.store(false);
+            for (auto &t : visionWorkers) {
+                t.join();
+            }
+            if (visualization.joinable()) {
+                visualization.join();
+                std::clog << argv[0] << ": Skipped " << visualizationSkips << " frame(s) in the visualization." << std::endl;
+            }
+            // The capture thread ends with the next frame from the shared memory.
+            capture.join();
+            std::clog << argv[0] << ": Scanned " << fullScans << " frame(s) completely and " << windowedScans << " around the tracked cones." << std::endl;
+            std::clog << argv[0] << ": Skipped the vision work of " << captureDrops.load() << " frame(s) at capture and " << visionDrops.load() << " in the vision workers." << std::endl;
+            std::clog << latency::Probes::instance().report();
         }
 
         retCode = 0;
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STEERING_ESTIMATOR_HPP
+#define STEERING_ESTIMATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+
+// Steering estimated from all sensors of the car as their readings arrive:
+//
+// - a Kalman filter over yaw rate and yaw acceleration is updated with the
+//   gyroscope, the rate of change of the magnetic heading once the
+//   magnetometer is calibrated, and the lateral acceleration divided by the
+//   speed,
+// - a Kalman filter over the speed is updated with the ground speed and,
+//   less trusted, with the pedal position,
+// - the steering is the yaw rate, predicted to the time of the frame, mapped
+//   with the calibration of the original formula, and fused with the steering
+//   towards the middle between the nearest blue and yellow cone.
+//
+// Every reading costs a constant number of operations; nothing is recomputed
+// over past readings. The axes follow the recordings: yaw is about Z, and X
+// and Y span the ground plane with Y pointing to the left.
+namespace estimation {
+
+class SteeringEstimator {
+   private:
+    SteeringEstimator(const SteeringEstimator &) = delete;
+    SteeringEstimator(SteeringEstimator &&)      = delete;
+    SteeringEstimator &operator=(const SteeringEstimator &) = delete;
+    SteeringEstimator &operator=(SteeringEstimator &&) = delete;
+
+   public:
+    SteeringEstimator() = default;
+
+    /**
+     * This method maps a yaw rate to a steering angle with the calibration from the recordings.
+     *
+     * @param angularVelocityZ Yaw rate in degrees per second.
+     * @return Steering in radians.
+     */
+    static float fromAngularVelocity(double angularVelocityZ) noexcept {
+        double steering{0.0};
+        if (angularVelocityZ <= 0) {
+            angularVelocityZ = std::max(angularVelocityZ, -78.0);
+            steering         = (angularVelocityZ - (-78)) / 78 * 0.3 - 0.3;
+        } else {
+            // Below 2 degrees per second, the car is going straight.
+            angularVelocityZ = (angularVelocityZ < 2) ? 1 : angularVelocityZ;
+            steering         = ((angularVelocityZ - 1) / 100) * 0.3;
+        }
+        return static_cast<float>(steering);
+    }
+
+    /**
+     * @param t Sample time in seconds.
+     * @param z Yaw rate in degrees per second.
+     */
+    void angularVelocity(double t, float z) noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        // The turn measured by the gyroscope tells when the magnetometer has seen every heading.
+        const double DT{t - m_gyroscopeTime};
+        if ((0 < m_gyroscopeTime) && (0 < DT) && (DT < MAX_INTERVAL)) {
+            m_turned += z * DT;
+        }
+        m_gyroscopeTime = std::max(m_gyroscopeTime, t);
+        predict(t);
+        updateYawRate(z, GYROSCOPE_VARIANCE);
+    }
+
+    /**
+     * This method updates the yaw rate with the rate of change of the heading.
+     * The field of the car itself (hard iron) offsets the readings; its center
+     * is the middle of the smallest and largest readings once the gyroscope
+     * measured a full turn. Until then, the magnetometer is not used.
+     */
+    void magneticField(double t, float x, float y, float) noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        m_magneticMinimum[0] = std::min(m_magneticMinimum[0], static_cast<double>(x));
+        m_magneticMinimum[1] = std::min(m_magneticMinimum[1], static_cast<double>(y));
+        m_magneticMaximum[0] = std::max(m_magneticMaximum[0], static_cast<double>(x));
+        m_magneticMaximum[1] = std::max(m_magneticMaximum[1], static_cast<double>(y));
+        if (std::abs(m_turned) < FULL_TURN) {
+            return;
+        }
+        const double CENTER_X{(m_magneticMinimum[0] + m_magneticMaximum[0]) / 2};
+        const double CENTER_Y{(m_magneticMinimum[1] + m_magneticMaximum[1]) / 2};
+        const double HEADING{std::atan2(y - CENTER_Y, x - CENTER_X)};
+        const double DT{t - m_headingTime};
+        if ((0 < m_headingTime) && (MIN_INTERVAL < DT) && (DT < MAX_INTERVAL)) {
+            const double RATE{wrap(HEADING - m_heading) / DT * DEGREES_PER_RADIAN};
+            if (std::abs(RATE) < MAX_YAW_RATE) {
+                predict(t);
+                updateYawRate(RATE, MAGNETIC_VARIANCE);
+            }
+        }
+        m_heading     = HEADING;
+        m_headingTime = t;
+    }
+
+    /**
+     * This method updates the yaw rate with the centripetal acceleration once the speed is known.
+     *
+     * @param y Lateral acceleration in meters per square second.
+     */
+    void acceleration(double t, float, float y, float) noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        predict(t);
+        if ((m_speedVariance < MAX_SPEED_VARIANCE) && (MIN_SPEED < m_speed)) {
+            updateYawRate(y / m_speed * DEGREES_PER_RADIAN, ACCELERATION_VARIANCE);
+        }
+    }
+
+    /**
+     * @param speed Meters per second.
+     */
+    void groundSpeed(double t, float speed) noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        predict(t);
+        updateSpeed(speed, GROUND_SPEED_VARIANCE);
+    }
+
+    /**
+     * @param position Pedal position from -1 to 1.
+     */
+    void pedalPosition(double t, float position) noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        predict(t);
+        updateSpeed(SPEED_PER_PEDAL_POSITION * position, PEDAL_SPEED_VARIANCE);
+    }
+
+    /**
+     * This method sets the point to steer to, in the middle between the nearest blue and yellow cone.
+     *
+     * @param azimuth Direction in radians, positive to the left.
+     * @param distance Meters.
+     */
+    void cones(double t, float azimuth, float distance) noexcept {
+        if (!(0.0f < distance)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lck(m_mutex);
+        // Pure pursuit: the arc through the point has the curvature 2 sin(azimuth) / distance.
+        m_coneSteering = static_cast<float>(std::atan(2.0 * WHEELBASE * std::sin(azimuth) / distance));
+        m_coneTime     = t;
+    }
+
+    /**
+     * @param t Sample time in seconds of the frame to steer.
+     * @return Steering in radians.
+     */
+    float steering(double t) const noexcept {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        // Without readings for longer, the yaw acceleration is not extrapolated any further.
+        const double DT{std::min(MAX_INTERVAL, std::max(0.0, t - m_time))};
+        const double YAW_RATE{m_yawRate + m_yawAcceleration * DT};
+        const float IMU_STEERING{fromAngularVelocity(YAW_RATE)};
+        if ((0 >= m_coneTime) || (std::abs(t - m_coneTime) > MAX_CONE_AGE)) {
+            return IMU_STEERING;
+        }
+        // Inverse variance weighting; the variance of the yaw rate is carried over with the slope of the calibration.
+        const double SLOPE{0.3 / 78};
+        const double IMU_VARIANCE{predictedYawRateVariance(DT) * SLOPE * SLOPE + CALIBRATION_VARIANCE};
+        const double WEIGHT{CONE_VARIANCE / (CONE_VARIANCE + IMU_VARIANCE)};
+        return static_cast<float>(WEIGHT * IMU_STEERING + (1.0 - WEIGHT) * m_coneSteering);
+    }
+
+   private:
+    // Noise of the measurements as variances, in (degrees per second)^2 for yaw rates, (m/s)^2 for speeds, and rad^2 for steering.
+    static constexpr double GYROSCOPE_VARIANCE{1.0};
+    static constexpr double MAGNETIC_VARIANCE{900.0};
+    static constexpr double ACCELERATION_VARIANCE{400.0};
+    static constexpr double GROUND_SPEED_VARIANCE{0.01};
+    static constexpr double PEDAL_SPEED_VARIANCE{0.25};
+    static constexpr double CALIBRATION_VARIANCE{0.01};
+    static constexpr double CONE_VARIANCE{0.02};
+    // Changes of the yaw acceleration and of the speed per second, as variances.
+    static constexpr double YAW_JERK_VARIANCE{4.0e5};
+    static constexpr double SPEED_CHANGE_VARIANCE{0.5};
+
+    static constexpr double DEGREES_PER_RADIAN{180.0 / M_PI};
+    static constexpr double MAX_YAW_RATE{300.0};
+    static constexpr double FULL_TURN{360.0};
+    static constexpr double MIN_INTERVAL{0.01};
+    static constexpr double MAX_INTERVAL{0.5};
+    static constexpr double MIN_SPEED{0.3};
+    static constexpr double MAX_SPEED_VARIANCE{0.1};
+    static constexpr double SPEED_PER_PEDAL_POSITION{5.0};
+    static constexpr double WHEELBASE{0.12};
+    static constexpr double MAX_CONE_AGE{0.5};
+
+    static double wrap(double angle) noexcept {
+        return std::atan2(std::sin(angle), std::cos(angle));
+    }
+
+    // Readings may arrive slightly out of order; older ones update the state without going back in time.
+    void predict(double t) noexcept {
+        if (0 >= m_time) {
+            m_time = t;
+            return;
+        }
+        const double DT{t - m_time};
+        if (0 >= DT) {
+            return;
+        }
+        m_time = t;
+
+        // Constant yaw acceleration: x = F x, P = F P F' + Q with F = [1 DT; 0 1].
+        m_yawRate += m_yawAcceleration * DT;
+        const double P01{m_yawVariance[1] + DT * m_yawVariance[2]};
+        m_yawVariance[0] = predictedYawRateVariance(DT);
+        m_yawVariance[1] = P01 + YAW_JERK_VARIANCE * DT * DT / 2;
+        m_yawVariance[2] += YAW_JERK_VARIANCE * DT;
+
+        m_speedVariance += SPEED_CHANGE_VARIANCE * DT;
+    }
+
+    // Variance of the yaw rate predicted DT seconds ahead.
+    double predictedYawRateVariance(double DT) const noexcept {
+        return m_yawVariance[0] + 2 * DT * m_yawVariance[1] + DT * DT * m_yawVariance[2] + YAW_JERK_VARIANCE * DT * DT * DT / 3;
+    }
+
+    void updateYawRate(double measurement, double variance) noexcept {
+        const double S{m_yawVariance[0] + variance};
+        const double K0{m_yawVariance[0] / S};
+        const double K1{m_yawVariance[1] / S};
+        const double INNOVATION{measurement - m_yawRate};
+        m_yawRate += K0 * INNOVATION;
+        m_yawAcceleration += K1 * INNOVATION;
+        // P = (I - K H) P with H = [1 0].
+        m_yawVariance[2] -= K1 * m_yawVariance[1];
+        m_yawVariance[1] -= K1 * m_yawVariance[0];
+        m_yawVariance[0] -= K0 * m_yawVariance[0];
+    }
+
+    void updateSpeed(double measurement, double variance) noexcept {
+        const double K{m_speedVariance / (m_speedVariance + variance)};
+        m_speed += K * (measurement - m_speed);
+        m_speedVariance -= K * m_speedVariance;
+    }
+
+   private:
+    mutable std::mutex m_mutex{};
+    double m_time{0.0};
+
+    double m_yawRate{0.0};
+    double m_yawAcceleration{0.0};
+    // Covariance of yaw rate and yaw acceleration: [0] and [2] on the diagonal, [1] off the diagonal.
+    double m_yawVariance[3]{100.0, 0.0, 1.0e4};
+
+    double m_speed{0.0};
+    double m_speedVariance{1.0e3};
+
+    double m_gyroscopeTime{0.0};
+    double m_turned{0.0}; // Degrees, counterclockwise.
+    double m_magneticMinimum[2]{HUGE_VAL, HUGE_VAL};
+    double m_magneticMaximum[2]{-HUGE_VAL, -HUGE_VAL};
+    double m_heading{0.0};
+    double m_headingTime{0.0};
+
+    float m_coneSteering{0.0f};
+    double m_coneTime{0.0};
+};
+
+} // namespace estimation
+
+#endif
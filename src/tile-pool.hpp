@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2023  Group 02
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILE_POOL_HPP
+#define TILE_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent threads that run the per-frame vision stages over bands of rows:
+// all stages of a frame are called for one band before the next band is
+// started, so the rows of a band stay in the cache from one stage to the next.
+namespace tiles {
+
+class TilePool {
+   private:
+    TilePool(const TilePool &) = delete;
+    TilePool(TilePool &&)      = delete;
+    TilePool &operator=(const TilePool &) = delete;
+    TilePool &operator=(TilePool &&) = delete;
+
+   public:
+    /**
+     * Signature of the stages: first row, row after the last row, and index of
+     * the thread (0 is the caller of run()) to select per-thread scratch buffers.
+     */
+    typedef std::function<void(int, int, uint32_t)> Stages;
+
+    /**
+     * Constructor.
+     *
+     * @param threads Number of threads including the caller of run(); 0 for one per core.
+     */
+    explicit TilePool(uint32_t threads) noexcept
+        : m_threads{(0 < threads) ? threads : std::max(1u, std::thread::hardware_concurrency())}
+        , m_queues{new Queue[m_threads]} {
+        try {
+            for (uint32_t i{1}; i < m_threads; i++) {
+                m_workers.emplace_back(std::thread(&TilePool::work, this, i));
+            }
+        } catch (...) {
+            // Run with the threads that could be started.
+            m_threads = static_cast<uint32_t>(m_workers.size()) + 1;
+        }
+    }
+
+    ~TilePool() {
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (auto &t : m_workers) {
+            t.join();
+        }
+    }
+
+    /**
+     * @return Number of threads including the caller of run().
+     */
+    uint32_t threads() const noexcept {
+        return m_threads;
+    }
+
+    /**
+     * This method calls the stages for all bands of rows in [0, rows) and
+     * returns when all bands are done. Every thread starts with a contiguous
+     * share of the bands and steals bands from the others once its share is
+     * done. The stages must not throw.
+     *
+     * @param rows Number of rows of the frame.
+     * @param bandHeight Number of rows per band.
+     * @param stages Stages to run per band.
+     */
+    void run(int rows, int bandHeight, const Stages &stages) noexcept {
+        if ((0 >= rows) || (0 >= bandHeight)) {
+            return;
+        }
+        const int BANDS{(rows + bandHeight - 1) / bandHeight};
+        for (uint32_t i{0}; i < m_threads; i++) {
+            m_queues[i].next.store(static_cast<int>(static_cast<int64_t>(BANDS) * i / m_threads), std::memory_order_relaxed);
+            m_queues[i].end = static_cast<int>(static_cast<int64_t>(BANDS) * (i + 1) / m_threads);
+        }
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            m_stages     = &stages;
+            m_rows       = rows;
+            m_bandHeight = bandHeight;
+            m_pending    = m_threads - 1;
+            m_generation++;
+        }
+        m_start.notify_all();
+
+        runBands(0);
+
+        // The stages are owned by the caller: wait until no thread uses them anymore.
+        std::unique_lock<std::mutex> lck(m_mutex);
+        m_done.wait(lck, [this]() { return 0 == m_pending; });
+        m_stages = nullptr;
+    }
+
+   private:
+    void work(uint32_t thread) noexcept {
+        uint64_t generation{0};
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lck(m_mutex);
+                m_start.wait(lck, [this, &generation]() { return m_stop || (generation != m_generation); });
+                if (m_stop) {
+                    return;
+                }
+                generation = m_generation;
+            }
+            runBands(thread);
+            {
+                std::lock_guard<std::mutex> lck(m_mutex);
+                m_pending--;
+                if (0 == m_pending) {
+                    m_done.notify_one();
+                }
+            }
+        }
+    }
+
+    void runBands(uint32_t thread) noexcept {
+        for (uint32_t i{0}; i < m_threads; i++) {
+            // Own bands first, then the remaining bands of the following threads.
+            Queue &queue = m_queues[(thread + i) % m_threads];
+            for (int band{queue.next.fetch_add(1)}; band < queue.end; band = queue.next.fetch_add(1)) {
+                const int FIRST{band * m_bandHeight};
+                try {
+                    (*m_stages)(FIRST, std::min(m_rows, FIRST + m_bandHeight), thread);
+                } catch (...) {}
+            }
+        }
+    }
+
+   private:
+    // Padded to keep the counters of different threads in different cache lines.
+    struct Queue {
+        std::atomic<int> next{0};
+        int end{0};
+        char padding[56];
+    };
+
+    uint32_t m_threads;
+    std::unique_ptr<Queue[]> m_queues;
+    std::vector<std::thread> m_workers{};
+
+    std::mutex m_mutex{};
+    std::condition_variable m_start{};
+    std::condition_variable m_done{};
+    bool m_stop{false};
+    uint64_t m_generation{0};
+    uint32_t m_pending{0};
+    const Stages *m_stages{nullptr};
+    int m_rows{0};
+    int m_bandHeight{0};
+};
+
+} // namespace tiles
+
+#endif